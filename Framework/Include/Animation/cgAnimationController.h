@@ -28,7 +28,9 @@
 #include <cgBase.h>
 #include <Scripting/cgScriptInterop.h>
 #include <Resources/cgResourceHandles.h>
+#include <Resources/cgAnimationSet.h>
 #include <Animation/cgAnimationTypes.h>
+#include <Math/cgMathTypes.h>
 
 //-----------------------------------------------------------------------------
 // Forward Declaration
@@ -67,6 +69,7 @@ public:
 	// Public Methods
 	//-------------------------------------------------------------------------
     void                            advanceTime         ( cgDouble timeDelta, const TargetMap & targets );
+    void                            invalidateTargets   ( );
     void                            resetTime           ( );
     void                            setTrackLimit       ( cgUInt16 maxTracks );
     bool                            setTrackAnimationSet( cgUInt16 track, const cgAnimationSetHandle & set );
@@ -107,16 +110,27 @@ protected:
 	//-------------------------------------------------------------------------
     struct Track
     {
-        cgAnimationTrackDesc    desc;   // The descriptor that contains all of the track properties.
-        cgAnimationSetHandle    set;    // The animation set currently applied to this track.
+        cgAnimationTrackDesc    desc;           // The descriptor that contains all of the track properties.
+        cgAnimationSetHandle    set;            // The animation set currently applied to this track.
+        cgAnimationSet        * boundSet;       // The animation set against which target bindings were last resolved.
+        cgUInt32                boundRevision;  // Target revision of 'boundSet' at the time bindings were resolved.
+        cgAnimationSet::SampleCursor cursor;    // Key cursors for every target animated by 'boundSet'.
+
+        // Constructor
+        Track() : boundSet( CG_NULL ), boundRevision( 0 ) {}
     
     }; // End struct Track
     CGE_ARRAY_DECLARE(Track, TrackArray)
+    CGE_ARRAY_DECLARE(cgAnimationTarget*, TargetArray)
+    CGE_ARRAY_DECLARE(const cgAnimationSet::TargetData*, TargetDataArray)
+    CGE_ARRAY_DECLARE(cgVector3, VectorArray)
+    CGE_ARRAY_DECLARE(cgQuaternion, QuaternionArray)
 
     //-------------------------------------------------------------------------
 	// Protected Methods
 	//-------------------------------------------------------------------------
     void                updateTargets       ( const TargetMap & targets );
+    void                bindTargets         ( const TargetMap & targets );
 
     //-------------------------------------------------------------------------
 	// Protected Variables
@@ -124,6 +138,19 @@ protected:
     TrackArray      mTracks;            // Vector containing all of the tracks currently set to the controller.
     cgDouble        mPosition;          // Position (in seconds) of the animation playhead.
     cgStringSet     mValidTargetIds;    // List of all currently valid target identifiers for the applied tracks.
+    
+    // Target bindings
+    bool                mTargetsDirty;      // Target bindings must be resolved again before the next update.
+    const TargetMap   * mBoundTargetMap;    // The target map against which bindings were last resolved.
+    size_t              mBoundTargetCount;  // Size of the target map at the time bindings were resolved.
+    TargetArray         mBoundTargets;      // Target instance associated with each bound slot.
+    TargetDataArray     mBoundTargetData;   // Animation set data for each slot / track pair (slot major, CG_NULL if not animated by that track).
+
+    // Pose buffer (one entry per slot / track pair, slot major).
+    VectorArray         mPoseScale;         // Sampled scale.
+    QuaternionArray     mPoseRotation;      // Sampled rotation.
+    VectorArray         mPoseTranslation;   // Sampled translation.
+    cgFloatArray        mPoseWeight;        // Blend weight of each sample (0 if not sampled).
 };
 
 #endif // !_CGE_CGANIMATIONCONTROLLER_H_
\ No newline at end of file
@@ -213,6 +213,7 @@ public:
     bool        deserialize ( cgWorldQuery & channelQuery, bool cloning, cgInt32 & minFrameOut, cgInt32 & maxFrameOut );
     void        clear       ( );
     void        addKey      ( cgInt32 frame, const cgQuaternion & value );
+    cgInt32     findSegment ( cgFloat frame, cgInt32 hint ) const;
     
     //-----------------------------------------------------------------------------
     // Public Inline Methods
@@ -223,6 +224,14 @@ public:
 	// Public Variables
 	//-------------------------------------------------------------------------
     QuaternionKeyArray data;
+
+protected:
+    //-------------------------------------------------------------------------
+	// Protected Static Constants
+	//-------------------------------------------------------------------------
+    // Maximum number of keys a cursor will be stepped before resorting to a
+    // binary search.
+    static const cgInt32 MaxCursorSteps = 4;
 };
 
 //-----------------------------------------------------------------------------
@@ -306,6 +315,7 @@ public:
 	// Public Methods
 	//-------------------------------------------------------------------------
     void                                    evaluate            ( cgDouble position, cgVector3 & p, const cgVector3 & default );
+    void                                    evaluate            ( cgDouble position, cgVector3 & p, const cgVector3 & default, cgInt32 * cursors );
     void                                    addLinearKey        ( cgInt32 frame, const cgVector3 & value );
     const cgFloatCurveAnimationChannel    & getAnimationChannel ( cgUInt32 index ) const;
     cgFloatCurveAnimationChannel          & getAnimationChannel ( cgUInt32 index );
@@ -367,6 +377,7 @@ public:
 	// Public Methods
 	//-------------------------------------------------------------------------
     void                                    evaluate            ( cgDouble position, cgVector3 & s, const cgVector3 & default );
+    void                                    evaluate            ( cgDouble position, cgVector3 & s, const cgVector3 & default, cgInt32 * cursors );
     void                                    addLinearKey        ( cgInt32 frame, const cgVector3 & value );
     const cgFloatCurveAnimationChannel    & getAnimationChannel ( cgUInt32 index ) const;
     cgFloatCurveAnimationChannel          & getAnimationChannel ( cgUInt32 index );
@@ -486,6 +497,7 @@ public:
 	// Public Methods
 	//-------------------------------------------------------------------------
     void                                evaluate            ( cgDouble position, cgQuaternion & q, const cgQuaternion & default );
+    void                                evaluate            ( cgDouble position, cgQuaternion & q, const cgQuaternion & default, cgInt32 & cursor );
     void                                addKey              ( cgInt32 frame, const cgQuaternion & value );
     const cgQuaternionAnimationChannel& getAnimationChannel ( ) const;
     cgQuaternionAnimationChannel      & getAnimationChannel ( );
@@ -74,6 +74,8 @@
 #include <Math\cgQuaternion.h>
 #include <Math\cgRandom.h>
 #include <Math\cgTransform.h>
+#include <Math\cgTransformBatch.h>
+#include <Math\cgTriangleBVH.h>
 #include <Math\cgVector.h>
 
 // Networking
@@ -119,6 +121,7 @@
 #include <Rendering\cgObjectRenderContext.h>
 #include <Rendering\cgObjectRenderQueue.h>
 #include <Rendering\cgParticleEmitter.h>
+#include <Rendering\cgParticleStore.h>
 #include <Rendering\cgRenderDriver.h>
 #include <Rendering\cgRenderingCapabilities.h>
 #include <Rendering\cgRenderingTypes.h>
@@ -180,6 +183,7 @@
 #include <System\cgFileSystem.h>
 #include <System\cgFilterExpression.h>
 #include <System\cgImage.h>
+#include <System\cgJobSystem.h>
 #include <System\cgMessageTypes.h>
 #include <System\cgPoolAllocator.h>
 #include <System\cgProfiler.h>
@@ -190,6 +194,7 @@
 #include <System\cgStringUtility.h>
 #include <System\cgThreading.h>
 #include <System\cgTimer.h>
+#include <System\cgTraceProfiler.h>
 #include <System\cgUID.h>
 #include <System\cgVariant.h>
 #include <System\cgXML.h>
@@ -197,12 +202,14 @@
 // Worlds, Scenes & Objects
 #include <World\cgInterestAreaSet.h>
 #include <World\cgLandscape.h>
+#include <World\cgLandscapeHeightPyramid.h>
 #include <World\cgLandscapeTypes.h>
 #include <World\cgObjectBehavior.h>
 #include <World\cgObjectNode.h>
 #include <World\cgObjectSubElement.h>
 #include <World\cgScene.h>
 #include <World\cgSceneCell.h>
+#include <World\cgSceneSpatialHash.h>
 #include <World\cgSceneController.h>
 #include <World\cgSceneElement.h>
 #include <World\cgSphereTree.h>
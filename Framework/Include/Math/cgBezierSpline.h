@@ -62,6 +62,12 @@ public:
         SplineScaleVariance    = 4,
         SplineOnly             = 5
     };
+    enum LookupTableType
+    {
+        NoLookupTable          = 0,
+        UniformLookupTable     = 1,
+        AdaptiveLookupTable    = 2
+    };
 
     //------------------------------------------------------------------------
     // Public Structures
@@ -96,12 +102,21 @@ public:
     void                    clear               ( );
     cgString                computeHash         ( cgInt16 numSignificantDigits = -1 );
     bool                    sortByX             ( cgUInt32Array * remap = CG_NULL );
+    void                    prepare             ( );
     
     // Sampling methods
     cgVector2               evaluate            ( cgFloat t );
+    void                    evaluate            ( const cgFloat * xs, cgFloat * ys, size_t count, bool approximate = false );
     cgFloat                 evaluateForX        ( cgFloat x, bool approximate = false, cgUInt16 digits = 4 );
     cgFloat                 evaluateForX        ( EvaluateMethod method, cgFloat x, cgFloat rand = 0, bool approximate = false, cgUInt16 digits = 4 );
-    cgVector2               evaluateSegment     ( cgInt32 segment, cgFloat t );
+    cgFloat                 evaluateWithCursor  ( cgFloat x, cgInt32 & segment, bool approximate = false );
+    cgVector2               evaluateSegment     ( cgInt32 segment, cgFloat t ) const;
+
+    // Lookup tables
+    void                    setLookupTable      ( LookupTableType type, cgFloat maximumError = 0.001f, cgUInt32 maximumEntries = 1024 );
+    LookupTableType         getLookupTableType  ( ) const;
+    cgUInt32                getLookupTableSize  ( ) const;
+    cgFloat                 getLookupTableError ( ) const;
 
     // Accessors
     const SplinePointArray& getPoints           ( ) const;
@@ -131,6 +146,20 @@ protected:
     // Protected Methods
     //-------------------------------------------------------------------------
     void                    updateSplineData    ( );
+    cgFloat                 evaluateExact       ( cgFloat x, bool approximate ) const;
+    cgFloat                 evaluateSegmentForX ( cgInt32 segment, cgFloat x, bool approximate ) const;
+    cgInt32                 findSegment         ( cgFloat x, cgInt32 hint ) const;
+    void                    buildLookupTable    ( );
+    void                    refineLookupTable   ( cgFloat x0, cgFloat y0, cgFloat x1, cgFloat y1, cgInt32 depth, cgUInt32 & budget );
+    cgFloat                 measureInterval     ( cgFloat x0, cgFloat y0, cgFloat x1, cgFloat y1, cgFloat * midY ) const;
+    cgFloat                 sampleLookupTable   ( cgFloat x, cgUInt32 & hint ) const;
+
+    //-------------------------------------------------------------------------
+    // Protected Static Constants
+    //-------------------------------------------------------------------------
+    // Maximum number of points a segment cursor will be stepped before
+    // resorting to a binary search.
+    static const cgInt32 MaxCursorSteps = 4;
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -142,6 +171,13 @@ protected:
     cgFloat             mVariance;
     bool                mSplineDirty;
     bool                mComplexSpline;
+    LookupTableType     mTableType;         // Type of lookup table requested.
+    cgFloat             mTableMaxError;     // Maximum permitted lookup table interpolation error.
+    cgUInt32            mTableMaxEntries;   // Maximum number of lookup table entries.
+    cgFloat             mTableError;        // Measured interpolation error of the current lookup table.
+    cgFloat             mTableScale;        // Entries per unit X for uniform tables (0 for adaptive).
+    cgFloatArray        mTableX;            // X location of each lookup table entry.
+    cgFloatArray        mTableY;            // Y value of each lookup table entry.
 };
 
 //-----------------------------------------------------------------------------
@@ -189,7 +225,7 @@ public:
     
     // Sampling methods
     cgVector3               evaluate            ( cgFloat t );
-    cgVector3               evaluateSegment     ( cgInt32 segment, cgFloat t );
+    cgVector3               evaluateSegment     ( cgInt32 segment, cgFloat t ) const;
 
     // Accessors
     const SplinePointArray& getPoints           ( ) const;
@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgMathNative.h                                                     //
+//                                                                           //
+// Desc : Portable, self contained implementation of the core math type      //
+//        operations (matrix, vector, quaternion and plane) used in place of //
+//        D3DX when CGE_NATIVE_MATH is defined.                              //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGMATHNATIVE_H_ )
+#define _CGE_CGMATHNATIVE_H_
+
+//-----------------------------------------------------------------------------
+// cgMathNative Header Includes
+//-----------------------------------------------------------------------------
+#include <cgAPI.h>
+#include <cgBaseTypes.h>
+#include <cgConfig.h>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class cgMatrix;
+class cgVector2;
+class cgVector3;
+class cgVector4;
+class cgQuaternion;
+class cgPlane;
+
+//-----------------------------------------------------------------------------
+// cgMathNative Namespace
+//-----------------------------------------------------------------------------
+// Out-of-line implementations of the non-trivial math type operations. These
+// mirror the behavior (and argument order) of the D3DX functions they replace
+// so that the engine produces the same results regardless of the selected
+// backend. The inline wrappers in cgMatrix.h, cgVector.h, cgQuaternion.h and
+// cgPlane.h forward here when CGE_NATIVE_MATH is defined.
+namespace cgMathNative
+{
+    // Backend information
+    const cgChar        CGE_API* getInstructionSet          ( );
+
+    // Matrix
+    bool                CGE_API  matrixIsIdentity           ( const cgMatrix & m );
+    cgMatrix            CGE_API* matrixMultiply             ( cgMatrix & out, const cgMatrix & m1, const cgMatrix & m2 );
+    cgMatrix            CGE_API* matrixMultiplyArray        ( cgMatrix * out, const cgMatrix * m1, const cgMatrix * m2, size_t count );
+    cgMatrix            CGE_API* matrixInverse              ( cgMatrix & out, cgFloat * determinantOut, const cgMatrix & m );
+    cgMatrix            CGE_API* matrixTranspose            ( cgMatrix & out, const cgMatrix & m );
+    cgFloat             CGE_API  matrixDeterminant          ( const cgMatrix & m );
+    cgMatrix            CGE_API* matrixRotationAxis         ( cgMatrix & out, const cgVector3 & axis, cgFloat radians );
+    cgMatrix            CGE_API* matrixRotationYawPitchRoll ( cgMatrix & out, cgFloat yaw, cgFloat pitch, cgFloat roll );
+    cgMatrix            CGE_API* matrixRotationX            ( cgMatrix & out, cgFloat radians );
+    cgMatrix            CGE_API* matrixRotationY            ( cgMatrix & out, cgFloat radians );
+    cgMatrix            CGE_API* matrixRotationZ            ( cgMatrix & out, cgFloat radians );
+    cgMatrix            CGE_API* matrixRotationQuaternion   ( cgMatrix & out, const cgQuaternion & q );
+    bool                CGE_API  matrixDecompose            ( cgVector3 & outScale, cgQuaternion & outRotation, cgVector3 & outTranslation, const cgMatrix & m );
+    cgMatrix            CGE_API* matrixTransformation       ( cgMatrix & out, const cgVector3 & scalingCenter, const cgQuaternion & scalingRotation, const cgVector3 & scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation );
+    cgMatrix            CGE_API* matrixTransformation2D     ( cgMatrix & out, const cgVector2 & scalingCenter, cgFloat scalingRotation, const cgVector2 & scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation );
+    cgMatrix            CGE_API* matrixAffineTransformation ( cgMatrix & out, cgFloat scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation );
+    cgMatrix            CGE_API* matrixAffineTransformation2D( cgMatrix & out, cgFloat scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation );
+    cgMatrix            CGE_API* matrixLookAt               ( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up, bool rightHanded );
+    cgMatrix            CGE_API* matrixPerspective          ( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip, bool rightHanded );
+    cgMatrix            CGE_API* matrixPerspectiveOffCenter ( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip, bool rightHanded );
+    cgMatrix            CGE_API* matrixPerspectiveFov       ( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip, bool rightHanded );
+    cgMatrix            CGE_API* matrixOrtho                ( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip, bool rightHanded );
+    cgMatrix            CGE_API* matrixOrthoOffCenter       ( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip, bool rightHanded );
+    cgMatrix            CGE_API* matrixShadow               ( cgMatrix & out, const cgVector4 & light, const cgPlane & plane );
+    cgMatrix            CGE_API* matrixReflect              ( cgMatrix & out, const cgPlane & plane );
+
+    // Vector
+    cgVector2           CGE_API* vec2TransformCoord         ( cgVector2 & out, const cgVector2 & v, const cgMatrix & m );
+    cgVector2           CGE_API* vec2TransformNormal        ( cgVector2 & out, const cgVector2 & v, const cgMatrix & m );
+    cgVector4           CGE_API* vec2Transform              ( cgVector4 & out, const cgVector2 & v, const cgMatrix & m );
+    cgVector3           CGE_API* vec3TransformCoord         ( cgVector3 & out, const cgVector3 & v, const cgMatrix & m );
+    cgVector3           CGE_API* vec3TransformNormal        ( cgVector3 & out, const cgVector3 & v, const cgMatrix & m );
+    cgVector4           CGE_API* vec3Transform              ( cgVector4 & out, const cgVector3 & v, const cgMatrix & m );
+    cgVector3           CGE_API* vec3TransformCoordArray    ( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count );
+    cgVector3           CGE_API* vec3TransformNormalArray   ( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count );
+    cgVector4           CGE_API* vec4Cross                  ( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, const cgVector4 & v3 );
+    cgVector4           CGE_API* vec4Transform              ( cgVector4 & out, const cgVector4 & v, const cgMatrix & m );
+    cgVector4           CGE_API* vec4TransformArray         ( cgVector4 * out, cgUInt32 outStride, const cgVector4 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count );
+
+    // Quaternion
+    cgQuaternion        CGE_API* quaternionInverse          ( cgQuaternion & out, const cgQuaternion & q );
+    cgQuaternion        CGE_API* quaternionMultiply         ( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2 );
+    cgQuaternion        CGE_API* quaternionNormalize        ( cgQuaternion & out, const cgQuaternion & q );
+    cgQuaternion        CGE_API* quaternionSlerp            ( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, cgFloat t );
+    cgQuaternion        CGE_API* quaternionSquad            ( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & a, const cgQuaternion & b, const cgQuaternion & c, cgFloat t );
+    void                CGE_API  quaternionSquadSetup       ( cgQuaternion & outA, cgQuaternion & outB, cgQuaternion & outC, const cgQuaternion & q0, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3 );
+    cgQuaternion        CGE_API* quaternionRotationAxis     ( cgQuaternion & out, const cgVector3 & axis, cgFloat radians );
+    cgQuaternion        CGE_API* quaternionRotationYawPitchRoll( cgQuaternion & out, cgFloat yaw, cgFloat pitch, cgFloat roll );
+    cgQuaternion        CGE_API* quaternionRotationMatrix   ( cgQuaternion & out, const cgMatrix & m );
+    void                CGE_API  quaternionToAxisAngle      ( const cgQuaternion & q, cgVector3 & outAxis, cgFloat & outAngle );
+    cgQuaternion        CGE_API* quaternionLn               ( cgQuaternion & out, const cgQuaternion & q );
+    cgQuaternion        CGE_API* quaternionExp              ( cgQuaternion & out, const cgQuaternion & q );
+    cgQuaternion        CGE_API* quaternionBaryCentric      ( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3, cgFloat f, cgFloat g );
+
+    // Plane
+    cgPlane             CGE_API* planeFromPoints            ( cgPlane & out, const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3 );
+    cgPlane             CGE_API* planeNormalize             ( cgPlane & out, const cgPlane & p );
+    cgPlane             CGE_API* planeTransform             ( cgPlane & out, const cgPlane & p, const cgMatrix & m );
+    cgPlane             CGE_API* planeTransformArray        ( cgPlane * out, cgUInt32 outStride, const cgPlane * p, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count );
+    cgVector3           CGE_API* planeIntersectLine         ( cgVector3 & out, const cgPlane & p, const cgVector3 & v1, const cgVector3 & v2 );
+
+}; // End Namespace : cgMathNative
+
+#endif // !_CGE_CGMATHNATIVE_H_
@@ -26,12 +26,18 @@
 //-----------------------------------------------------------------------------
 #include <cgAPI.h>
 #include <cgBaseTypes.h>
+#include <cgConfig.h>
 
+#if defined(CGE_NATIVE_MATH)
+// Portable implementation
+#include <Math/cgMathNative.h>
+#else // CGE_NATIVE_MATH
 // Windows platform includes
 #define WIN32_LEAN_AND_MEAN
 #include <d3d9.h>	// Win8 SDK required
 #include <d3dx9.h>
 #undef WIN32_LEAN_AND_MEAN
+#endif // !CGE_NATIVE_MATH
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -84,6 +90,151 @@ public:
     //-------------------------------------------------------------------------
     // Public Static Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static bool isIdentity( const cgMatrix & m )
+    {
+        return cgMathNative::matrixIsIdentity( m );
+    }
+    inline static cgMatrix * multiply( cgMatrix & out, const cgMatrix & m1, const cgMatrix & m2 )
+    {
+        return cgMathNative::matrixMultiply( out, m1, m2 );
+    }
+    inline static cgMatrix * multiplyArray( cgMatrix * out, const cgMatrix * m1, const cgMatrix * m2, size_t count )
+    {
+        return cgMathNative::matrixMultiplyArray( out, m1, m2, count );
+    }
+    inline static cgMatrix * inverse( cgMatrix & out, const cgMatrix & m )
+    {
+        return cgMathNative::matrixInverse( out, CG_NULL, m );
+    }
+    inline static cgMatrix * inverse( cgMatrix & out, cgFloat & determinantOut, const cgMatrix & m )
+    {
+        return cgMathNative::matrixInverse( out, &determinantOut, m );
+    }
+    inline static cgMatrix * transpose( cgMatrix & out, const cgMatrix & m )
+    {
+        return cgMathNative::matrixTranspose( out, m );
+    }
+    inline static cgMatrix * identity( cgMatrix & out )
+    {
+        out = cgMatrix( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );
+        return &out;
+    }
+    inline static cgMatrix * translation( cgMatrix & out, cgFloat x, cgFloat y, cgFloat z )
+    {
+        out = cgMatrix( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1 );
+        return &out;
+    }
+    inline static cgMatrix * scaling( cgMatrix & out, cgFloat x, cgFloat y, cgFloat z )
+    {
+        out = cgMatrix( x, 0, 0, 0, 0, y, 0, 0, 0, 0, z, 0, 0, 0, 0, 1 );
+        return &out;
+    }
+    inline static cgMatrix * rotationAxis( cgMatrix & out, const cgVector3 & axis, cgFloat radians )
+    {
+        return cgMathNative::matrixRotationAxis( out, axis, radians );
+    }
+    inline static cgMatrix * rotationYawPitchRoll( cgMatrix & out, cgFloat yaw, cgFloat pitch, cgFloat roll )
+    {
+        return cgMathNative::matrixRotationYawPitchRoll( out, yaw, pitch, roll );
+    }
+    inline static cgMatrix * rotationX( cgMatrix & out, cgFloat radians )
+    {
+        return cgMathNative::matrixRotationX( out, radians );
+    }
+    inline static cgMatrix * rotationY( cgMatrix & out, cgFloat radians )
+    {
+        return cgMathNative::matrixRotationY( out, radians );
+    }
+    inline static cgMatrix * rotationZ( cgMatrix & out, cgFloat radians )
+    {
+        return cgMathNative::matrixRotationZ( out, radians );
+    }
+    inline static cgMatrix * rotationQuaternion( cgMatrix & out, const cgQuaternion & q )
+    {
+        return cgMathNative::matrixRotationQuaternion( out, q );
+    }
+    inline static cgFloat determinant( cgMatrix & m )
+    {
+        return cgMathNative::matrixDeterminant( m );
+    }
+    inline static bool decompose( cgVector3 & outScale, cgQuaternion & outRotation, cgVector3 & outTranslation, const cgMatrix & m )
+    {
+        return cgMathNative::matrixDecompose( outScale, outRotation, outTranslation, m );
+    }
+    inline static cgMatrix * transformation( cgMatrix & out, const cgVector3 & scalingCenter, const cgQuaternion & scalingRotation, const cgVector3 & scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation )
+    {
+        return cgMathNative::matrixTransformation( out, scalingCenter, scalingRotation, scaling, rotationCenter, rotation, translation );
+    }
+    inline static cgMatrix * transformation2D( cgMatrix & out, const cgVector2 & scalingCenter, cgFloat scalingRotation, const cgVector2 & scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation )
+    {
+        return cgMathNative::matrixTransformation2D( out, scalingCenter, scalingRotation, scaling, rotationCenter, rotation, translation );
+    }
+    inline static cgMatrix * affineTransformation( cgMatrix & out, float scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation )
+    {
+        return cgMathNative::matrixAffineTransformation( out, scaling, rotationCenter, rotation, translation );
+    }
+    inline static cgMatrix * affineTransformation2D( cgMatrix & out, float scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation )
+    {
+        return cgMathNative::matrixAffineTransformation2D( out, scaling, rotationCenter, rotation, translation );
+    }
+    inline static cgMatrix * lookAtRH( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up )
+    {
+        return cgMathNative::matrixLookAt( out, eye, at, up, true );
+    }
+    inline static cgMatrix * lookAtLH( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up )
+    {
+        return cgMathNative::matrixLookAt( out, eye, at, up, false );
+    }
+    inline static cgMatrix * perspectiveRH( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspective( out, width, height, nearClip, farClip, true );
+    }
+    inline static cgMatrix * perspectiveLH( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspective( out, width, height, nearClip, farClip, false );
+    }
+    inline static cgMatrix * perspectiveOffCenterRH( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspectiveOffCenter( out, left, right, bottom, top, nearClip, farClip, true );
+    }
+    inline static cgMatrix * perspectiveOffCenterLH( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspectiveOffCenter( out, left, right, bottom, top, nearClip, farClip, false );
+    }
+    inline static cgMatrix * perspectiveFovRH( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspectiveFov( out, fovY, aspect, nearClip, farClip, true );
+    }
+    inline static cgMatrix * perspectiveFovLH( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixPerspectiveFov( out, fovY, aspect, nearClip, farClip, false );
+    }
+    inline static cgMatrix * orthoRH( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixOrtho( out, width, height, nearClip, farClip, true );
+    }
+    inline static cgMatrix * orthoLH( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixOrtho( out, width, height, nearClip, farClip, false );
+    }
+    inline static cgMatrix * orthoOffCenterRH( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixOrthoOffCenter( out, left, right, bottom, top, nearClip, farClip, true );
+    }
+    inline static cgMatrix * orthoOffCenterLH( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip )
+    {
+        return cgMathNative::matrixOrthoOffCenter( out, left, right, bottom, top, nearClip, farClip, false );
+    }
+    inline static cgMatrix * shadow( cgMatrix & out, const cgVector4 & light, const cgPlane & plane )
+    {
+        return cgMathNative::matrixShadow( out, light, plane );
+    }
+    inline static cgMatrix * reflect( cgMatrix & out, const cgPlane & plane )
+    {
+        return cgMathNative::matrixReflect( out, plane );
+    }
+#else // CGE_NATIVE_MATH
     inline static bool cgMatrix::isIdentity( const cgMatrix & m )
     {
         return (D3DXMatrixIsIdentity( (D3DXMATRIX*)&m ) == TRUE );
@@ -92,6 +243,12 @@ public:
     {
         return (cgMatrix*)D3DXMatrixMultiply( (D3DXMATRIX*)&out, (D3DXMATRIX*)&m1, (D3DXMATRIX*)&m2 );
     }
+    inline static cgMatrix * cgMatrix::multiplyArray( cgMatrix * out, const cgMatrix * m1, const cgMatrix * m2, size_t count )
+    {
+        for ( size_t i = 0; i < count; ++i )
+            D3DXMatrixMultiply( (D3DXMATRIX*)&out[i], (D3DXMATRIX*)&m1[i], (D3DXMATRIX*)&m2[i] );
+        return out;
+    }
     inline static cgMatrix * cgMatrix::inverse( cgMatrix & out, const cgMatrix & m )
     {
         return (cgMatrix*)D3DXMatrixInverse( (D3DXMATRIX*)&out, CG_NULL, (D3DXMATRIX*)&m );
@@ -220,7 +377,8 @@ public:
     {
         return (cgMatrix*)D3DXMatrixReflect( (D3DXMATRIX*)&out, (D3DXPLANE*)&plane );
     }
-    
+
+#endif // !CGE_NATIVE_MATH    
     //-------------------------------------------------------------------------
     // Public Operators
     //-------------------------------------------------------------------------
@@ -26,12 +26,20 @@
 //-----------------------------------------------------------------------------
 #include <cgAPI.h>
 #include <cgBaseTypes.h>
-
+#include <cgConfig.h>
+
+#if defined(CGE_NATIVE_MATH)
+// Portable implementation
+#include <Math/cgMathNative.h>
+#include <Math/cgVector.h>
+#include <math.h>
+#else // CGE_NATIVE_MATH
 // Windows platform includes
 #define WIN32_LEAN_AND_MEAN
 #include <d3d9.h>	// Win8 SDK required
 #include <d3dx9.h>
 #undef WIN32_LEAN_AND_MEAN
+#endif // !CGE_NATIVE_MATH
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -70,6 +78,50 @@ public:
     //-------------------------------------------------------------------------
     // Public Static Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static cgFloat dot( const cgPlane & p, const cgVector4 & v )
+    {
+        return p.a * v.x + p.b * v.y + p.c * v.z + p.d * v.w;
+    }
+    inline static cgFloat dotCoord( const cgPlane & p, const cgVector3 & v )
+    {
+        return p.a * v.x + p.b * v.y + p.c * v.z + p.d;
+    }
+    inline static cgFloat dotNormal( const cgPlane & p, const cgVector3 & v )
+    {
+        return p.a * v.x + p.b * v.y + p.c * v.z;
+    }
+    inline static cgPlane * fromPointNormal( cgPlane & out, const cgVector3 & point, const cgVector3 & normal )
+    {
+        out = cgPlane( normal.x, normal.y, normal.z, -(point.x * normal.x + point.y * normal.y + point.z * normal.z) );
+        return &out;
+    }
+    inline static cgPlane * fromPoints( cgPlane & out, const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3 )
+    {
+        return cgMathNative::planeFromPoints( out, v1, v2, v3 );
+    }
+    inline static cgPlane * normalize( cgPlane & out, const cgPlane & p )
+    {
+        return cgMathNative::planeNormalize( out, p );
+    }
+    inline static cgPlane * transform( cgPlane & out, const cgPlane & p, const cgMatrix & m )
+    {
+        return cgMathNative::planeTransform( out, p, m );
+    }
+    inline static cgPlane * transformArray( cgPlane planesOut[], cgUInt32 outStride, const cgPlane planesIn[], cgUInt32 inStride, const cgMatrix & m, cgUInt32 planeCount  )
+    {
+        return cgMathNative::planeTransformArray( planesOut, outStride, planesIn, inStride, m, planeCount );
+    }
+    inline static cgPlane * scale( cgPlane & out, const cgPlane & p, cgFloat s )
+    {
+        out = cgPlane( p.a * s, p.b * s, p.c * s, p.d * s );
+        return &out;
+    }
+    inline static cgVector3 * intersectLine( cgVector3 & out, const cgPlane & p, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        return cgMathNative::planeIntersectLine( out, p, v1, v2 );
+    }
+#else // CGE_NATIVE_MATH
     inline static cgFloat dot( const cgPlane & p, const cgVector4 & v )
     {
         return D3DXPlaneDot( (D3DXPLANE*)&p, (D3DXVECTOR4*)&v );
@@ -110,6 +162,7 @@ public:
     {
         return (cgVector3*)D3DXPlaneIntersectLine( (D3DXVECTOR3*)&out, (D3DXPLANE*)&p, (D3DXVECTOR3*)&v1, (D3DXVECTOR3*)&v2 );
     }
+#endif // !CGE_NATIVE_MATH
 
     //-------------------------------------------------------------------------
     // Public Operators
@@ -26,12 +26,19 @@
 //-----------------------------------------------------------------------------
 #include <cgAPI.h>
 #include <cgBaseTypes.h>
+#include <cgConfig.h>
 
+#if defined(CGE_NATIVE_MATH)
+// Portable implementation
+#include <Math/cgMathNative.h>
+#include <math.h>
+#else // CGE_NATIVE_MATH
 // Windows platform includes
 #define WIN32_LEAN_AND_MEAN
 #include <d3d9.h>	// Win8 SDK required
 #include <d3dx9.h>
 #undef WIN32_LEAN_AND_MEAN
+#endif // !CGE_NATIVE_MATH
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -69,6 +76,86 @@ public:
     //-------------------------------------------------------------------------
     // Public Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static cgFloat dot( const cgQuaternion & q1, const cgQuaternion & q2 )
+    {
+        return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+    }
+    inline static cgFloat length( const cgQuaternion & q )
+    {
+        return sqrtf( dot( q, q ) );
+    }
+    inline static cgFloat lengthSq( const cgQuaternion & q )
+    {
+        return dot( q, q );
+    }
+    inline static bool isIdentity( const cgQuaternion & q )
+    {
+        return q.x == 0.0f && q.y == 0.0f && q.z == 0.0f && q.w == 1.0f;
+    }
+    inline static cgQuaternion * identity( cgQuaternion & out )
+    {
+        out = cgQuaternion( 0, 0, 0, 1 );
+        return &out;
+    }
+    inline static cgQuaternion * conjugate( cgQuaternion & out, const cgQuaternion & q )
+    {
+        out = cgQuaternion( -q.x, -q.y, -q.z, q.w );
+        return &out;
+    }
+    inline static cgQuaternion * inverse( cgQuaternion & out, const cgQuaternion & q )
+    {
+        return cgMathNative::quaternionInverse( out, q );
+    }
+    inline static cgQuaternion * multiply( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2 )
+    {
+        return cgMathNative::quaternionMultiply( out, q1, q2 );
+    }
+    inline static cgQuaternion * slerp( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, const cgFloat t )
+    {
+        return cgMathNative::quaternionSlerp( out, q1, q2, t );
+    }
+    inline static cgQuaternion * squad( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & a, const cgQuaternion & b, const cgQuaternion & c, const cgFloat t )
+    {
+        return cgMathNative::quaternionSquad( out, q1, a, b, c, t );
+    }
+    inline static void squadSetup( cgQuaternion & outA, cgQuaternion & outB, cgQuaternion & outC, const cgQuaternion & q0, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3 )
+    {
+        cgMathNative::quaternionSquadSetup( outA, outB, outC, q0, q1, q2, q3 );
+    }
+    inline static cgQuaternion * normalize( cgQuaternion & out, const cgQuaternion & q )
+    {
+        return cgMathNative::quaternionNormalize( out, q );
+    }
+    inline static cgQuaternion * rotationAxis( cgQuaternion & out, const cgVector3 & axis, cgFloat radians )
+    {
+        return cgMathNative::quaternionRotationAxis( out, axis, radians );
+    }
+    inline static cgQuaternion * rotationYawPitchRoll( cgQuaternion & out, cgFloat yaw, cgFloat pitch, cgFloat roll )
+    {
+        return cgMathNative::quaternionRotationYawPitchRoll( out, yaw, pitch, roll );
+    }
+    inline static cgQuaternion * rotationMatrix( cgQuaternion & out, const cgMatrix & m )
+    {
+        return cgMathNative::quaternionRotationMatrix( out, m );
+    }
+    inline static void toAxisAngle( const cgQuaternion & q, cgVector3 & outAxis, cgFloat & outAngle )
+    {
+        cgMathNative::quaternionToAxisAngle( q, outAxis, outAngle );
+    }
+    inline static cgQuaternion * ln( cgQuaternion & out, const cgQuaternion & q )
+    {
+        return cgMathNative::quaternionLn( out, q );
+    }
+    inline static cgQuaternion * exp( cgQuaternion & out, const cgQuaternion & q )
+    {
+        return cgMathNative::quaternionExp( out, q );
+    }
+    inline static cgQuaternion * baryCentric( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3, cgFloat f, cgFloat g )
+    {
+        return cgMathNative::quaternionBaryCentric( out, q1, q2, q3, f, g );
+    }
+#else // CGE_NATIVE_MATH
     inline static cgFloat dot( const cgQuaternion & q1, const cgQuaternion & q2 )
     {
         return D3DXQuaternionDot( (D3DXQUATERNION*)&q1, (D3DXQUATERNION*)&q2 );
@@ -145,7 +232,8 @@ public:
     {
         return (cgQuaternion*)D3DXQuaternionBaryCentric( (D3DXQUATERNION*)&out, (D3DXQUATERNION*)&q1, (D3DXQUATERNION*)&q2, (D3DXQUATERNION*)&q3, f, g );
     }
-    
+
+#endif // !CGE_NATIVE_MATH    
 
     //-------------------------------------------------------------------------
     // Public Operations
@@ -0,0 +1,90 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTransformBatch.h                                                 //
+//                                                                           //
+// Desc : Batched hierarchy transform processing. Computes world space       //
+//        transforms for arrays of parent relative transforms in a single    //
+//        structure of arrays (SoA) pass suitable for SIMD processing.       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGTRANSFORMBATCH_H_ )
+#define _CGE_CGTRANSFORMBATCH_H_
+
+//-----------------------------------------------------------------------------
+// cgTransformBatch Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBaseTypes.h>
+#include <Math/cgTransform.h>
+
+//-----------------------------------------------------------------------------
+// Main class declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgTransformBatch (Class)
+/// <summary>
+/// Computes world space transforms for an entire hierarchy of parent relative
+/// (local) transforms in a single pass. Transforms are stored internally as 
+/// affine 4x3 matrices laid out as a structure of arrays (one stream per 
+/// matrix element) such that consecutive nodes can be processed four (SSE) or
+/// eight (AVX) at a time. Nodes must be added in topologically sorted order
+/// (parents before children). Adding nodes in breadth first order additionally
+/// ensures that siblings are contiguous, allowing the widest possible SIMD
+/// blocks to be used.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgTransformBatch
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors
+	//-------------------------------------------------------------------------
+     cgTransformBatch( );
+    ~cgTransformBatch( );
+
+	//-------------------------------------------------------------------------
+	// Public Constants
+	//-------------------------------------------------------------------------
+    enum { ElementCount = 12 };
+
+	//-------------------------------------------------------------------------
+	// Public Methods
+	//-------------------------------------------------------------------------
+    void                clear               ( );
+    void                reserve             ( cgUInt32 count );
+    cgUInt32            addTransform        ( const cgTransform & localTransform, cgInt32 parentIndex );
+    void                setLocalTransform   ( cgUInt32 index, const cgTransform & localTransform );
+    void                setRootTransform    ( const cgTransform & rootTransform );
+    void                getWorldTransform   ( cgTransform & out, cgUInt32 index ) const;
+    cgInt32             getParent           ( cgUInt32 index ) const;
+    cgUInt32            getCount            ( ) const;
+    void                compute             ( );
+
+	//-------------------------------------------------------------------------
+	// Public Static Functions
+	//-------------------------------------------------------------------------
+    static void         computeHierarchy    ( cgTransform worldTransformsOut[], const cgTransform localTransforms[], const cgInt32 parentIndices[], cgUInt32 count, const cgTransform * rootTransform = CG_NULL );
+
+protected:
+	//-------------------------------------------------------------------------
+	// Protected Variables
+	//-------------------------------------------------------------------------
+    cgFloatArray    mLocal[ElementCount];   // Parent relative transform element streams (row major 4x3).
+    cgFloatArray    mWorld[ElementCount];   // Computed world transform element streams (row major 4x3).
+    cgInt32Array    mParents;               // Index of each node's parent or -1 for nodes attached to the root.
+    cgFloat         mRoot[ElementCount];    // Transform applied to all nodes that have no parent.
+    cgUInt32        mCount;                 // Number of nodes currently in the batch.
+};
+
+#endif // !_CGE_CGTRANSFORMBATCH_H_
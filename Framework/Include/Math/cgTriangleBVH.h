@@ -0,0 +1,105 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTriangleBVH.h                                                    //
+//                                                                           //
+// Desc : Bounding volume hierarchy constructed over a set of indexed        //
+//        triangles using the surface area heuristic (SAH). Provides         //
+//        accelerated single ray and ray packet intersection queries.        //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGTRIANGLEBVH_H_ )
+#define _CGE_CGTRIANGLEBVH_H_
+
+//-----------------------------------------------------------------------------
+// cgTriangleBVH Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBaseTypes.h>
+#include <Math/cgMathTypes.h>
+
+//-----------------------------------------------------------------------------
+// Main class declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgTriangleBVH (Class)
+/// <summary>
+/// Bounding volume hierarchy built over a set of indexed triangles using a
+/// binned surface area heuristic. Triangle positions are copied into the 
+/// hierarchy (in leaf order) at build time such that the source vertex data
+/// is not required during queries. Intersection semantics match those of
+/// 'cgCollision::rayIntersectTriangle()' when used for single sided, 
+/// unrestricted range ray tests with the specified edge tolerance.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgTriangleBVH
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Constants
+    //-------------------------------------------------------------------------
+    enum { MaxPacketSize = 8 };
+
+    //-------------------------------------------------------------------------
+    // Public Typedefs
+    //-------------------------------------------------------------------------
+    /// <summary>Optional callback used to exclude individual faces from a query.</summary>
+    typedef bool (*FaceFilterFunc)( cgUInt32 face, void * context );
+
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors
+	//-------------------------------------------------------------------------
+     cgTriangleBVH( );
+    ~cgTriangleBVH( );
+
+	//-------------------------------------------------------------------------
+	// Public Methods
+	//-------------------------------------------------------------------------
+    bool                build               ( const cgByte * vertices, cgUInt32 vertexStride, cgUInt32 positionOffset, const cgUInt32 * indices, cgUInt32 faceCount, cgFloat tolerance );
+    void                clear               ( );
+    bool                isBuilt             ( ) const;
+    cgUInt32            getNodeCount        ( ) const;
+    cgUInt32            getFaceCount        ( ) const;
+    bool                intersect           ( const cgVector3 & origin, const cgVector3 & direction, cgFloat & distanceOut, cgUInt32 & faceOut, FaceFilterFunc filter = CG_NULL, void * filterContext = CG_NULL ) const;
+    cgUInt32            intersectPacket     ( cgUInt32 rayCount, const cgVector3 origins[], const cgVector3 directions[], cgFloat distancesOut[], cgUInt32 facesOut[], FaceFilterFunc filter = CG_NULL, void * filterContext = CG_NULL ) const;
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Structures
+    //-------------------------------------------------------------------------
+    struct Node
+    {
+        cgFloat     boundsMin[3];   // Minimum extents of this node's bounding box.
+        cgUInt32    first;          // Index of the left child (interior) or first triangle (leaf).
+        cgFloat     boundsMax[3];   // Maximum extents of this node's bounding box.
+        cgUInt32    count;          // Number of triangles in this leaf or 0 for interior nodes.
+    };
+    CGE_ARRAY_DECLARE( Node, NodeArray )
+
+    struct Triangle
+    {
+        cgVector3   v1, v2, v3;     // Triangle vertex positions.
+        cgVector3   normal;         // Pre-computed unit length triangle normal.
+        cgUInt32    face;           // Index of the source face.
+    };
+    CGE_ARRAY_DECLARE( Triangle, TriangleArray )
+
+	//-------------------------------------------------------------------------
+	// Protected Variables
+	//-------------------------------------------------------------------------
+    NodeArray       mNodes;         // Flattened node hierarchy. Children of interior nodes are stored consecutively.
+    TriangleArray   mTriangles;     // Triangle data in leaf order.
+    cgFloat         mTolerance;     // Edge tolerance used when testing triangles and inflating bounds.
+};
+
+#endif // !_CGE_CGTRIANGLEBVH_H_
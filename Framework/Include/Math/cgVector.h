@@ -26,17 +26,25 @@
 //-----------------------------------------------------------------------------
 #include <cgAPI.h>
 #include <cgBaseTypes.h>
+#include <cgConfig.h>
 
+#if defined(CGE_NATIVE_MATH)
+// Portable implementation
+#include <Math/cgMathNative.h>
+#include <math.h>
+#else // CGE_NATIVE_MATH
 // Windows platform includes
 #define WIN32_LEAN_AND_MEAN
 #include <d3d9.h>	// Win8 SDK required
 #include <d3dx9.h>
 #undef WIN32_LEAN_AND_MEAN
+#endif // !CGE_NATIVE_MATH
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
 //-----------------------------------------------------------------------------
 class cgMatrix;
+class cgVector4;
 
 //-----------------------------------------------------------------------------
 // Main class declarations
@@ -69,6 +77,95 @@ public:
     //-------------------------------------------------------------------------
     // Public Static Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static cgFloat dot( const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        return v1.x * v2.x + v1.y * v2.y;
+    }
+    inline static cgFloat ccw( const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        return v1.x * v2.y - v1.y * v2.x;
+    }
+    inline static cgFloat length( const cgVector2 & v )
+    {
+        return sqrtf( dot( v, v ) );
+    }
+    inline static cgFloat lengthSq( const cgVector2 & v )
+    {
+        return dot( v, v );
+    }
+    inline static cgVector2 * normalize( cgVector2 & out, const cgVector2 & v )
+    {
+        const cgFloat l = length( v );
+        if ( l == 0.0f )
+            out = cgVector2( 0, 0 );
+        else
+            out = cgVector2( v.x / l, v.y / l );
+        return &out;
+    }
+    inline static cgVector2 * transformCoord( cgVector2 & out, const cgVector2 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec2TransformCoord( out, v, m );
+    }
+    inline static cgVector2 * transformNormal( cgVector2 & out, const cgVector2 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec2TransformNormal( out, v, m );
+    }
+    inline static cgVector4 * transform( cgVector4 & out, const cgVector2 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec2Transform( out, v, m );
+    }
+    inline static cgVector2 * add( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        out = cgVector2( v1.x + v2.x, v1.y + v2.y );
+        return &out;
+    }
+    inline static cgVector2 * subtract( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        out = cgVector2( v1.x - v2.x, v1.y - v2.y );
+        return &out;
+    }
+    inline static cgVector2 * minimize( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        out = cgVector2( (v1.x < v2.x) ? v1.x : v2.x, (v1.y < v2.y) ? v1.y : v2.y );
+        return &out;
+    }
+    inline static cgVector2 * maximize( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2 )
+    {
+        out = cgVector2( (v1.x > v2.x) ? v1.x : v2.x, (v1.y > v2.y) ? v1.y : v2.y );
+        return &out;
+    }
+    inline static cgVector2 * scale( cgVector2 & out, const cgVector2 & v, cgFloat s )
+    {
+        out = cgVector2( v.x * s, v.y * s );
+        return &out;
+    }
+    inline static cgVector2 * lerp( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2, cgFloat s )
+    {
+        out = cgVector2( v1.x + s * (v2.x - v1.x), v1.y + s * (v2.y - v1.y) );
+        return &out;
+    }
+    inline static cgVector2 * hermite( cgVector2 & out, const cgVector2 & v1, const cgVector2 & t1, const cgVector2 & v2, const cgVector2 & t2, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        const cgFloat h1 = 2.0f * s3 - 3.0f * s2 + 1.0f, h2 = s3 - 2.0f * s2 + s;
+        const cgFloat h3 = -2.0f * s3 + 3.0f * s2, h4 = s3 - s2;
+        out = cgVector2( h1 * v1.x + h2 * t1.x + h3 * v2.x + h4 * t2.x, h1 * v1.y + h2 * t1.y + h3 * v2.y + h4 * t2.y );
+        return &out;
+    }
+    inline static cgVector2 * catmullRom( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2, const cgVector2 & v3, const cgVector2 & v4, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        out = cgVector2( 0.5f * (2.0f * v2.x + (v3.x - v1.x) * s + (2.0f * v1.x - 5.0f * v2.x + 4.0f * v3.x - v4.x) * s2 + (3.0f * v2.x - v1.x - 3.0f * v3.x + v4.x) * s3),
+                         0.5f * (2.0f * v2.y + (v3.y - v1.y) * s + (2.0f * v1.y - 5.0f * v2.y + 4.0f * v3.y - v4.y) * s2 + (3.0f * v2.y - v1.y - 3.0f * v3.y + v4.y) * s3) );
+        return &out;
+    }
+    inline static cgVector2 * baryCentric( cgVector2 & out, const cgVector2 & v1, const cgVector2 & v2, const cgVector2 & v3, cgFloat f, cgFloat g )
+    {
+        out = cgVector2( v1.x + f * (v2.x - v1.x) + g * (v3.x - v1.x), v1.y + f * (v2.y - v1.y) + g * (v3.y - v1.y) );
+        return &out;
+    }
+#else // CGE_NATIVE_MATH
     inline static cgFloat cgVector2::dot( const cgVector2 & v1, const cgVector2 & v2 )
     {
         return D3DXVec2Dot( (D3DXVECTOR2*)&v1, (D3DXVECTOR2*)&v2 );
@@ -137,6 +234,7 @@ public:
     {
         return (cgVector2*)D3DXVec2BaryCentric( (D3DXVECTOR2*)&out, (D3DXVECTOR2*)&v1, (D3DXVECTOR2*)&v2, (D3DXVECTOR2*)&v3, f, g );
     }
+#endif // !CGE_NATIVE_MATH
 
     //-------------------------------------------------------------------------
     // Public Operators
@@ -252,6 +350,109 @@ public:
     //-------------------------------------------------------------------------
     // Public Static Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static cgFloat dot( const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    }
+    inline static cgVector3 * cross( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        out = cgVector3( v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x );
+        return &out;
+    }
+    inline static cgFloat length( const cgVector3 & v )
+    {
+        return sqrtf( dot( v, v ) );
+    }
+    inline static cgFloat lengthSq( const cgVector3 & v )
+    {
+        return dot( v, v );
+    }
+    inline static cgVector3 * normalize( cgVector3 & out, const cgVector3 & v )
+    {
+        const cgFloat l = length( v );
+        if ( l == 0.0f )
+            out = cgVector3( 0, 0, 0 );
+        else
+            out = cgVector3( v.x / l, v.y / l, v.z / l );
+        return &out;
+    }
+    inline static cgVector3 * transformCoord( cgVector3 & out, const cgVector3 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec3TransformCoord( out, v, m );
+    }
+    inline static cgVector3 * transformNormal( cgVector3 & out, const cgVector3 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec3TransformNormal( out, v, m );
+    }
+    inline static cgVector4 * transform( cgVector4 & out, const cgVector3 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec3Transform( out, v, m );
+    }
+    inline static cgVector3 * transformCoordArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return cgMathNative::vec3TransformCoordArray( out, outStride, v, inStride, m, count );
+    }
+    inline static cgVector3 * transformNormalArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return cgMathNative::vec3TransformNormalArray( out, outStride, v, inStride, m, count );
+    }
+    inline static cgVector3 * add( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        out = cgVector3( v1.x + v2.x, v1.y + v2.y, v1.z + v2.z );
+        return &out;
+    }
+    inline static cgVector3 * subtract( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        out = cgVector3( v1.x - v2.x, v1.y - v2.y, v1.z - v2.z );
+        return &out;
+    }
+    inline static cgVector3 * minimize( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        out = cgVector3( (v1.x < v2.x) ? v1.x : v2.x, (v1.y < v2.y) ? v1.y : v2.y, (v1.z < v2.z) ? v1.z : v2.z );
+        return &out;
+    }
+    inline static cgVector3 * maximize( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        out = cgVector3( (v1.x > v2.x) ? v1.x : v2.x, (v1.y > v2.y) ? v1.y : v2.y, (v1.z > v2.z) ? v1.z : v2.z );
+        return &out;
+    }
+    inline static cgVector3 * scale( cgVector3 & out, const cgVector3 & v, cgFloat s )
+    {
+        out = cgVector3( v.x * s, v.y * s, v.z * s );
+        return &out;
+    }
+    inline static cgVector3 * lerp( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2, cgFloat s )
+    {
+        out = cgVector3( v1.x + s * (v2.x - v1.x), v1.y + s * (v2.y - v1.y), v1.z + s * (v2.z - v1.z) );
+        return &out;
+    }
+    inline static cgVector3 * hermite( cgVector3 & out, const cgVector3 & v1, const cgVector3 & t1, const cgVector3 & v2, const cgVector3 & t2, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        const cgFloat h1 = 2.0f * s3 - 3.0f * s2 + 1.0f, h2 = s3 - 2.0f * s2 + s;
+        const cgFloat h3 = -2.0f * s3 + 3.0f * s2, h4 = s3 - s2;
+        out = cgVector3( h1 * v1.x + h2 * t1.x + h3 * v2.x + h4 * t2.x,
+                         h1 * v1.y + h2 * t1.y + h3 * v2.y + h4 * t2.y,
+                         h1 * v1.z + h2 * t1.z + h3 * v2.z + h4 * t2.z );
+        return &out;
+    }
+    inline static cgVector3 * catmullRom( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3, const cgVector3 & v4, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        out = cgVector3( 0.5f * (2.0f * v2.x + (v3.x - v1.x) * s + (2.0f * v1.x - 5.0f * v2.x + 4.0f * v3.x - v4.x) * s2 + (3.0f * v2.x - v1.x - 3.0f * v3.x + v4.x) * s3),
+                         0.5f * (2.0f * v2.y + (v3.y - v1.y) * s + (2.0f * v1.y - 5.0f * v2.y + 4.0f * v3.y - v4.y) * s2 + (3.0f * v2.y - v1.y - 3.0f * v3.y + v4.y) * s3),
+                         0.5f * (2.0f * v2.z + (v3.z - v1.z) * s + (2.0f * v1.z - 5.0f * v2.z + 4.0f * v3.z - v4.z) * s2 + (3.0f * v2.z - v1.z - 3.0f * v3.z + v4.z) * s3) );
+        return &out;
+    }
+    inline static cgVector3 * baryCentric( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3, cgFloat f, cgFloat g )
+    {
+        out = cgVector3( v1.x + f * (v2.x - v1.x) + g * (v3.x - v1.x),
+                         v1.y + f * (v2.y - v1.y) + g * (v3.y - v1.y),
+                         v1.z + f * (v2.z - v1.z) + g * (v3.z - v1.z) );
+        return &out;
+    }
+#else // CGE_NATIVE_MATH
     inline static cgFloat cgVector3::dot( const cgVector3 & v1, const cgVector3 & v2 )
     {
         return D3DXVec3Dot( (D3DXVECTOR3*)&v1, (D3DXVECTOR3*)&v2 );
@@ -284,6 +485,14 @@ public:
     {
         return (cgVector4*)D3DXVec3Transform( (D3DXVECTOR4*)&out, (D3DXVECTOR3*)&v, (D3DXMATRIX*)&m );
     }
+    inline static cgVector3 * cgVector3::transformCoordArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return (cgVector3*)D3DXVec3TransformCoordArray( (D3DXVECTOR3*)out, (UINT)outStride, (const D3DXVECTOR3*)v, (UINT)inStride, (D3DXMATRIX*)&m, (UINT)count );
+    }
+    inline static cgVector3 * cgVector3::transformNormalArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return (cgVector3*)D3DXVec3TransformNormalArray( (D3DXVECTOR3*)out, (UINT)outStride, (const D3DXVECTOR3*)v, (UINT)inStride, (D3DXMATRIX*)&m, (UINT)count );
+    }
     inline static cgVector3 * cgVector3::add( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
     {
         return (cgVector3*)D3DXVec3Add( (D3DXVECTOR3*)&out, (D3DXVECTOR3*)&v1, (D3DXVECTOR3*)&v2 );
@@ -320,6 +529,7 @@ public:
     {
         return (cgVector3*)D3DXVec3BaryCentric( (D3DXVECTOR3*)&out, (D3DXVECTOR3*)&v1, (D3DXVECTOR3*)&v2, (D3DXVECTOR3*)&v3, f, g );
     }
+#endif // !CGE_NATIVE_MATH
 
     //-------------------------------------------------------------------------
     // Public Operators
@@ -444,6 +654,99 @@ public:
     //-------------------------------------------------------------------------
     // Public Static Methods
     //-------------------------------------------------------------------------
+#if defined(CGE_NATIVE_MATH)
+    inline static cgFloat dot( const cgVector4 & v1, const cgVector4 & v2 )
+    {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+    }
+    inline static cgVector4 * cross( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, const cgVector4 & v3 )
+    {
+        return cgMathNative::vec4Cross( out, v1, v2, v3 );
+    }
+    inline static cgFloat length( const cgVector4 & v )
+    {
+        return sqrtf( dot( v, v ) );
+    }
+    inline static cgFloat lengthSq( const cgVector4 & v )
+    {
+        return dot( v, v );
+    }
+    inline static cgVector4 * normalize( cgVector4 & out, const cgVector4 & v )
+    {
+        const cgFloat l = length( v );
+        if ( l == 0.0f )
+            out = cgVector4( 0, 0, 0, 0 );
+        else
+            out = cgVector4( v.x / l, v.y / l, v.z / l, v.w / l );
+        return &out;
+    }
+    inline static cgVector4 * transform( cgVector4 & out, const cgVector4 & v, const cgMatrix & m )
+    {
+        return cgMathNative::vec4Transform( out, v, m );
+    }
+    inline static cgVector4 * transformArray( cgVector4 * out, cgUInt32 outStride, const cgVector4 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return cgMathNative::vec4TransformArray( out, outStride, v, inStride, m, count );
+    }
+    inline static cgVector4 * add( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2 )
+    {
+        out = cgVector4( v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w );
+        return &out;
+    }
+    inline static cgVector4 * subtract( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2 )
+    {
+        out = cgVector4( v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w );
+        return &out;
+    }
+    inline static cgVector4 * minimize( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2 )
+    {
+        out = cgVector4( (v1.x < v2.x) ? v1.x : v2.x, (v1.y < v2.y) ? v1.y : v2.y, (v1.z < v2.z) ? v1.z : v2.z, (v1.w < v2.w) ? v1.w : v2.w );
+        return &out;
+    }
+    inline static cgVector4 * maximize( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2 )
+    {
+        out = cgVector4( (v1.x > v2.x) ? v1.x : v2.x, (v1.y > v2.y) ? v1.y : v2.y, (v1.z > v2.z) ? v1.z : v2.z, (v1.w > v2.w) ? v1.w : v2.w );
+        return &out;
+    }
+    inline static cgVector4 * scale( cgVector4 & out, const cgVector4 & v, cgFloat s )
+    {
+        out = cgVector4( v.x * s, v.y * s, v.z * s, v.w * s );
+        return &out;
+    }
+    inline static cgVector4 * lerp( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, cgFloat s )
+    {
+        out = cgVector4( v1.x + s * (v2.x - v1.x), v1.y + s * (v2.y - v1.y), v1.z + s * (v2.z - v1.z), v1.w + s * (v2.w - v1.w) );
+        return &out;
+    }
+    inline static cgVector4 * hermite( cgVector4 & out, const cgVector4 & v1, const cgVector4 & t1, const cgVector4 & v2, const cgVector4 & t2, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        const cgFloat h1 = 2.0f * s3 - 3.0f * s2 + 1.0f, h2 = s3 - 2.0f * s2 + s;
+        const cgFloat h3 = -2.0f * s3 + 3.0f * s2, h4 = s3 - s2;
+        out = cgVector4( h1 * v1.x + h2 * t1.x + h3 * v2.x + h4 * t2.x,
+                         h1 * v1.y + h2 * t1.y + h3 * v2.y + h4 * t2.y,
+                         h1 * v1.z + h2 * t1.z + h3 * v2.z + h4 * t2.z,
+                         h1 * v1.w + h2 * t1.w + h3 * v2.w + h4 * t2.w );
+        return &out;
+    }
+    inline static cgVector4 * catmullRom( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, const cgVector4 & v3, const cgVector4 & v4, cgFloat s )
+    {
+        const cgFloat s2 = s * s, s3 = s2 * s;
+        out = cgVector4( 0.5f * (2.0f * v2.x + (v3.x - v1.x) * s + (2.0f * v1.x - 5.0f * v2.x + 4.0f * v3.x - v4.x) * s2 + (3.0f * v2.x - v1.x - 3.0f * v3.x + v4.x) * s3),
+                         0.5f * (2.0f * v2.y + (v3.y - v1.y) * s + (2.0f * v1.y - 5.0f * v2.y + 4.0f * v3.y - v4.y) * s2 + (3.0f * v2.y - v1.y - 3.0f * v3.y + v4.y) * s3),
+                         0.5f * (2.0f * v2.z + (v3.z - v1.z) * s + (2.0f * v1.z - 5.0f * v2.z + 4.0f * v3.z - v4.z) * s2 + (3.0f * v2.z - v1.z - 3.0f * v3.z + v4.z) * s3),
+                         0.5f * (2.0f * v2.w + (v3.w - v1.w) * s + (2.0f * v1.w - 5.0f * v2.w + 4.0f * v3.w - v4.w) * s2 + (3.0f * v2.w - v1.w - 3.0f * v3.w + v4.w) * s3) );
+        return &out;
+    }
+    inline static cgVector4 * baryCentric( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, const cgVector4 & v3, cgFloat f, cgFloat g )
+    {
+        out = cgVector4( v1.x + f * (v2.x - v1.x) + g * (v3.x - v1.x),
+                         v1.y + f * (v2.y - v1.y) + g * (v3.y - v1.y),
+                         v1.z + f * (v2.z - v1.z) + g * (v3.z - v1.z),
+                         v1.w + f * (v2.w - v1.w) + g * (v3.w - v1.w) );
+        return &out;
+    }
+#else // CGE_NATIVE_MATH
     inline static cgFloat cgVector4::dot( const cgVector4 & v1, const cgVector4 & v2 )
     {
         return D3DXVec4Dot( (D3DXVECTOR4*)&v1, (D3DXVECTOR4*)&v2 );
@@ -468,6 +771,10 @@ public:
     {
         return (cgVector4*)D3DXVec4Transform( (D3DXVECTOR4*)&out, (D3DXVECTOR4*)&v, (D3DXMATRIX*)&m );
     }
+    inline static cgVector4 * cgVector4::transformArray( cgVector4 * out, cgUInt32 outStride, const cgVector4 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        return (cgVector4*)D3DXVec4TransformArray( (D3DXVECTOR4*)out, (UINT)outStride, (const D3DXVECTOR4*)v, (UINT)inStride, (D3DXMATRIX*)&m, (UINT)count );
+    }
     inline static cgVector4 * cgVector4::add( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2 )
     {
         return (cgVector4*)D3DXVec4Add( (D3DXVECTOR4*)&out, (D3DXVECTOR4*)&v1, (D3DXVECTOR4*)&v2 );
@@ -504,6 +811,7 @@ public:
     {
         return (cgVector4*)D3DXVec4BaryCentric( (D3DXVECTOR4*)&out, (D3DXVECTOR4*)&v1, (D3DXVECTOR4*)&v2, (D3DXVECTOR4*)&v3, f, g );
     }
+#endif // !CGE_NATIVE_MATH
 
     //-------------------------------------------------------------------------
     // Public Operators
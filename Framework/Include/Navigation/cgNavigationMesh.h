@@ -59,6 +59,11 @@ class CGE_API cgNavigationMesh : public cgWorldComponent
     DECLARE_DERIVED_SCRIPTOBJECT( cgNavigationMesh, cgWorldComponent, "NavigationMesh" )
 
 public:
+    //-------------------------------------------------------------------------
+    // Public Typedefs
+    //-------------------------------------------------------------------------
+    typedef void (*BuildProgressFunc)( cgNavigationMesh * navMesh, cgUInt32 tilesProcessed, cgUInt32 tileCount, void * context );
+
     //-------------------------------------------------------------------------
     // Constructors & Destructors
     //-------------------------------------------------------------------------
@@ -71,10 +76,14 @@ public:
     //-------------------------------------------------------------------------
     bool                        build                   ( cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgLandscape * landscape );
     bool                        build                   ( const cgNavigationMeshCreateParams & params, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgLandscape * landscape );
+    bool                        rebuild                 ( const cgBoundingBox & region, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgLandscape * landscape );
     void                        setParameters           ( const cgNavigationMeshCreateParams & params );
     void                        debugDraw               ( cgRenderDriver * driver );
     const cgNavigationMeshCreateParams& getParameters   ( ) const;
     cgUInt32                    getTileCount            ( ) const;
+    void                        setBuildThreadCount     ( cgUInt32 threadCount );
+    cgUInt32                    getBuildThreadCount     ( ) const;
+    void                        setBuildProgressCallback( BuildProgressFunc callback, void * context );
 
     // Internal utilities
     dtNavMesh                 * getInternalMesh         ( );
@@ -109,6 +118,8 @@ protected:
     //-------------------------------------------------------------------------
     void                        prepareQueries          ( );
     bool                        insertComponentData     ( );
+    void                        buildTiles              ( cgInt32 minTileX, cgInt32 minTileZ, cgInt32 maxTileX, cgInt32 maxTileZ, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], const cgBoundingBox meshBounds[], cgLandscape * landscape );
+    bool                        commitTile              ( cgNavigationTile * tile );
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -120,6 +131,9 @@ protected:
     cgInt32                         mTilesY;
     cgInt32                         mTilesZ;
     cgBoundingBox                   mGeomBounds;
+    cgUInt32                        mBuildThreadCount;      // Number of threads used to construct tiles (1 = calling thread only, otherwise job system).
+    BuildProgressFunc               mBuildProgress;         // Optional callback triggered as each tile is processed.
+    void                          * mBuildProgressContext;  // Context passed to the above callback.
 
     //-------------------------------------------------------------------------
     // Protected Static Variables
@@ -127,6 +141,7 @@ protected:
     // Cached database queries.
     static cgWorldQuery mInsertMesh;
     static cgWorldQuery mDeleteTiles;
+    static cgWorldQuery mDeleteTile;
     static cgWorldQuery mUpdateParameters;
     static cgWorldQuery mLoadMesh;
     static cgWorldQuery mLoadTiles;
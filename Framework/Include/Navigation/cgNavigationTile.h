@@ -31,6 +31,7 @@
 // Forward Declarations
 //-----------------------------------------------------------------------------
 class  cgNavigationMesh;
+class  cgMesh;
 class  cgTerrainBlock;
 struct cgNavigationMeshCreateParams;
 struct rcPolyMesh;
@@ -68,8 +69,8 @@ public:
     //-------------------------------------------------------------------------
     cgNavigationMesh  * getNavigationMesh   ( ) const;
     const cgByteArray & getNavigationData   ( ) const;
-    bool                buildTile           ( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[] );
-    bool                buildTile           ( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgUInt32 terrainBlockCount, cgTerrainBlock * blockData[] );
+    bool                buildTile           ( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMesh * meshData[], cgTransform meshTransforms[] );
+    bool                buildTile           ( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMesh * meshData[], cgTransform meshTransforms[], cgUInt32 terrainBlockCount, cgTerrainBlock * blockData[] );
     void                debugDraw           ( cgRenderDriver * driver );
     bool                serialize           ( cgUInt32 parentId, cgWorld * world );
     bool                deserialize         ( cgWorldQuery & tileQuery, bool cloning );
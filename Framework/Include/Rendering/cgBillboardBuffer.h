@@ -55,6 +55,11 @@ class CGE_API cgBillboardBuffer : public cgScriptInterop::DisposableScriptObject
 {
     DECLARE_SCRIPTOBJECT( cgBillboardBuffer, "BillboardBuffer" );
 
+    //-------------------------------------------------------------------------
+    // Friend List
+    //-------------------------------------------------------------------------
+    friend class BillboardSortProbe;    // Depth sort benchmark (Tools/Benchmarks).
+
 public:
     //-------------------------------------------------------------------------
     // Public Typedefs, Structures and Enumerations
@@ -137,9 +142,10 @@ private:
     // Structure used to sort billboards based on depth.
     struct DepthSortInfo
     {
-        cgFloat depth;              // Squared distance from the camera (or just z component when in screen space)
-        cgInt32 billboardId;        // The Id of the billboard in question.
+        cgUInt32 depthKey;          // Squared distance from the camera encoded such that ascending key order is back to front.
+        cgInt32  billboardId;       // The Id of the billboard in question.
     };
+    CGE_ARRAY_DECLARE(DepthSortInfo, DepthSortArray)
 
     // Cached technique handles
     struct Techniques
@@ -157,11 +163,13 @@ private:
     bool                parseAtlas              ( const cgXMLNode & mainNode );
     bool                selectTechnique         ( cgSurfaceShader * shader, bool precise = true );
     bool                restoreBuffers          ( );
+    cgInt32             sortBillboards          ( const cgVector3 & sortOrigin, cgInt32 billboardBegin, cgInt32 billboardCount );
 
     //-------------------------------------------------------------------------
     // Private Static Functions
     //-------------------------------------------------------------------------
-    static cgInt        billboardDepthCompare   ( const void *arg1, const void *arg2 );
+    static DepthSortInfo * radixSortDepth       ( DepthSortInfo * data, DepthSortInfo * scratch, cgUInt32 count );
+    static bool         insertionSortDepth      ( DepthSortInfo * data, cgUInt32 count, cgUInt32 maxMoves );
 
     //-------------------------------------------------------------------------
     // Private Variables
@@ -183,6 +191,12 @@ private:
     cgSampler             * mSampler;               // The object used to bind texture / sampler information to the effect.
     cgVertexFormat        * mVertexFormat;          // Vertex format to assume for this buffer.
     Techniques              mTechniques;            // Cached technique handles.
+    DepthSortArray          mDepthOrder;            // Billboard order produced by the most recent call to renderSorted().
+    DepthSortArray          mDepthScratch;          // Scratch storage used during radix sorting.
+    DepthSortArray          mDepthCandidates;       // Per-billboard depth information used when gathering in the previous order.
+    cgInt32                 mDepthOrderBegin;       // First billboard in the range described by 'mDepthOrder'.
+    cgInt32                 mDepthOrderCount;       // Size of the billboard range described by 'mDepthOrder' (0 if no previous order).
+    cgInt32                 mDepthRetryDelay;       // Number of sorts remaining before reuse of the previous order is attempted again.
 };
 
 //-----------------------------------------------------------------------------
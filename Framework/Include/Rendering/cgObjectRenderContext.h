@@ -98,8 +98,8 @@ protected:
     void            renderDepthSortedBlending       ( );
     void            lightDefault                    ( );
     void            lightDepthSortedBlending        ( );
-    void            insertObjectsByMaterial         ( const cgMaterialHandle & material, const cgObjectNodeList & objects );
-    void            insertObjectsByLightAndMaterial ( cgLightNode * light, const cgMaterialHandle & material, const cgObjectNodeList & objects );
+    void            insertObjectsByMaterial         ( const cgMaterialHandle & material, cgObjectNode * const * objects, size_t objectCount );
+    void            insertObjectsByLightAndMaterial ( cgLightNode * light, const cgMaterialHandle & material, cgObjectNode * const * objects, size_t objectCount );
     void            insertObject                    ( cgObjectNode * object );
     void            insertLight                     ( cgLightNode * light );
 
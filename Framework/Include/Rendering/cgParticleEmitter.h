@@ -26,8 +26,10 @@
 //-----------------------------------------------------------------------------
 #include <cgBase.h>
 #include <Rendering/cgBillboardBuffer.h>
+#include <Rendering/cgParticleStore.h>
 #include <Scripting/cgScriptInterop.h>
 #include <Math/cgBezierSpline.h>
+#include <Math/cgRandom.h>
 
 //-----------------------------------------------------------------------------
 // Global Enumerations
@@ -109,7 +111,9 @@ struct cgParticleEmitterProperties
 //-----------------------------------------------------------------------------
 //  Name : cgParticle (Class)
 /// <summary>
-/// Class for the management of an individual particle.
+/// Render proxy for an individual particle. Simulation state is maintained
+/// by the owning emitter's particle store and written back to the particle
+/// billboard each frame.
 /// Note : Derived from cgBillboard which provides our rendering functionality
 /// </summary>
 //-----------------------------------------------------------------------------
@@ -126,29 +130,6 @@ public:
     //-------------------------------------------------------------------------
              cgParticle( );
     virtual ~cgParticle( );
-
-    //-------------------------------------------------------------------------
-    // Public Methods
-    //-------------------------------------------------------------------------
-    void        setVelocity         ( const cgVector3 & velocity );
-    void        setAngularVelocity  ( cgFloat angularVelocity );
-    void        setMaximumAge       ( cgFloat maximumAge );
-    void        setMass             ( cgFloat mass );
-    cgFloat     getMass             ( ) const { return mMass; }
-    bool        isAlive             ( ) const { return (mAge <= mMaximumAge); }
-
-private:
-    //-------------------------------------------------------------------------
-    // Private Variables
-    //-------------------------------------------------------------------------
-    cgFloat   mMass;              // The mass of this particle.
-    cgVector3 mVelocity;          // Particle's current velocity
-    cgFloat   mAngularVelocity;   // Velocity of particle rotation (degrees/sec)
-    cgFloat   mAge;               // Age of the particle
-    cgFloat   mMaximumAge;        // Maximum age of the particle before it dies
-    // ToDo: 6767 -- Are these necessary any more?
-    cgUInt16  mLastColorKeyIndex; // Cached index for color keyframes
-    cgUInt16  mLastScaleKeyIndex; // Cached index for scale keyframes
 };
 
 //-----------------------------------------------------------------------------
@@ -176,6 +157,7 @@ public:
     bool                                setEmitterProperties    ( const cgParticleEmitterProperties & properties );
     const cgParticleEmitterProperties & getEmitterProperties    ( ) const;
     void                                update                  ( cgFloat timeDelta, const cgVector3 & worldVelocity, bool velocityScale );
+    cgUInt32                            getActiveParticleCount  ( ) const;
     void                                render                  ( cgCameraNode * camera );
     void                                setEmitterMatrix        ( const cgMatrix & matrix );
     const cgMatrix                    & getEmitterMatrix        ( ) const;
@@ -194,11 +176,28 @@ public:
     //-------------------------------------------------------------------------
     virtual void        dispose                 ( bool disposeBase );
 
+    //-------------------------------------------------------------------------
+    // Public Static Functions
+    //-------------------------------------------------------------------------
+    static void         updateEmitters          ( cgParticleEmitter * emitters[], cgUInt32 emitterCount, cgFloat timeDelta, const cgVector3 & worldVelocity, bool velocityScale );
+
 private:
     //-------------------------------------------------------------------------
 	// Private Methods
 	//-------------------------------------------------------------------------
-    bool                onParticleBirth         ( cgParticle * particle );
+    bool                onParticleBirth         ( cgUInt32 index );
+    void                updateParticles         ( cgFloat timeDelta, const cgVector3 & worldVelocity, bool velocityScale );
+    void                emitParticles           ( cgFloat timeDelta, const cgVector3 & worldVelocity, bool velocityScale );
+    void                writeParticle           ( cgUInt32 index );
+    cgFloat             randomFloat             ( cgFloat minimum, cgFloat maximum ) const;
+    void                bakeCurves              ( );
+    void                rebuildFreeList         ( );
+    void                getSimulationParams     ( cgParticleStore::SimulationParams & params, cgFloat timeDelta, const cgVector3 & worldVelocity, bool velocityScale ) const;
+
+    //-------------------------------------------------------------------------
+	// Private Static Functions
+	//-------------------------------------------------------------------------
+    static void         executeUpdates          ( cgUInt32 first, cgUInt32 last, void * context );
 
     //-------------------------------------------------------------------------
 	// Private Variables
@@ -207,11 +206,12 @@ private:
     cgString                    mScriptFile;            // The name of the particle script file.
     cgRenderDriver            * mRenderDriver;          // render used for creating billboard buffers and rendering.
     cgParticleEmitterProperties mProperties;            // Setup information for the emitter (birth rate etc.)
-    cgParticle               ** mParticles;             // Array containing all managed particles.
-    cgParticle               ** mActiveParticles;       // Array containing currently active particles.
-    cgParticle               ** mDeadParticles;         // Array containing inactive particles.
+    cgParticle               ** mParticles;             // Array containing all managed particle billboards.
+    cgParticleStore             mStore;                 // Simulation state for currently active particles (tagged with their index into 'mParticles').
+    cgUInt32Array               mFreeParticles;         // Stack of indices into 'mParticles' that are not currently in use.
+    cgUInt32Array               mExpiredParticles;      // Scratch list of particles that expired during the most recent update.
+    cgUInt32                    mRecycleCursor;         // Active particle to recycle next when all particles are in use.
     cgUInt32                    mMaxParticles;          // Final computed maximum number of simultaneous particles that can be active.
-    cgUInt32                    mActiveParticleCount;   // Number of currently active particles
     cgFloat                     mReleaseCount;          // Keeps track of the amount of particles to release over time
     cgUInt32                    mTotalReleased;         // Total number of particles released so far
     cgFloat                     mTimeElapsed;           // Time elapsed in fire delay mode.
@@ -219,6 +219,7 @@ private:
     cgMatrix                    mTransform;             // The emitter matrix, describes the current position and orientation of the emitter.
     cgVector3                   mGravity;               // Gravity to apply to the particles as required.
     cgVector3                   mGlobalForce;           // Any external/global forces applied to the particles (wind etc).
+    mutable cgRandom::ParkMiller mRandom;               // Generator used for particle birth. Owned by this emitter so that it can be updated on any thread.
 };
 
 #endif // !_CGE_CGPARTICLEEMITTER_H_
\ No newline at end of file
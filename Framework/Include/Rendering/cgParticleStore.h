@@ -0,0 +1,149 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgParticleStore.h                                                  //
+//                                                                           //
+// Desc : Structure of arrays (SoA) storage and simulation kernel for the    //
+//        live particles managed by a particle emitter.                      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGPARTICLESTORE_H_ )
+#define _CGE_CGPARTICLESTORE_H_
+
+//-----------------------------------------------------------------------------
+// cgParticleStore Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBaseTypes.h>
+#include <Math/cgMathTypes.h>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class cgBezierSpline2;
+
+//-----------------------------------------------------------------------------
+// Main class declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgParticleStore (Class)
+/// <summary>
+/// Stores the simulation state of a set of live particles as a structure of
+/// arrays (one stream per attribute) such that the integration, color and
+/// scale evaluation kernel can process four particles at a time (SSE). Live
+/// particles are always tightly packed in the range [0, getCount()); removal
+/// moves the last particle into the vacated slot, so particle indices are not
+/// stable and each particle instead carries a caller supplied tag. Property
+/// curves are baked into fixed size lookup tables ahead of time to avoid 
+/// evaluating splines per particle, per frame.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgParticleStore
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Enumerations
+    //-------------------------------------------------------------------------
+    enum Stream
+    {
+        PositionX = 0,
+        PositionY,
+        PositionZ,
+        VelocityX,
+        VelocityY,
+        VelocityZ,
+        DirectionX,
+        DirectionY,
+        DirectionZ,
+        Rotation,           // Degrees
+        AngularVelocity,    // Degrees per second
+        Age,
+        MaximumAge,
+        InverseMass,        // Zero for massless particles (unaffected by forces)
+        ScaleX,
+        ScaleY,
+        StreamCount
+    };
+    enum Curve
+    {
+        ScaleXCurve = 0,
+        ScaleYCurve,
+        ColorRCurve,
+        ColorGCurve,
+        ColorBCurve,
+        ColorACurve,
+        CurveCount
+    };
+    enum { CurveResolution = 128 };
+
+    //-------------------------------------------------------------------------
+    // Public Structures
+    //-------------------------------------------------------------------------
+    struct CGE_API SimulationParams
+    {
+        cgFloat     timeDelta;              // Time elapsed since the last step.
+        cgVector3   gravity;                // Acceleration applied to all particles with mass.
+        cgVector3   globalForce;            // External force (wind etc.) applied to all particles with mass.
+        cgVector3   worldVelocity;          // Velocity of the observer used to compute direction vectors.
+        cgFloat     airResistance;          // Drag coefficient.
+        bool        velocityScale;          // Stretch particles along the Y axis by their speed?
+        cgFloat     velocityScaleStrength;  // Amount of stretch to apply when velocity scaling.
+    };
+
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors
+	//-------------------------------------------------------------------------
+     cgParticleStore( );
+    ~cgParticleStore( );
+
+	//-------------------------------------------------------------------------
+	// Public Methods
+	//-------------------------------------------------------------------------
+    void                setCapacity         ( cgUInt32 capacity );
+    cgUInt32            getCapacity         ( ) const;
+    cgUInt32            getCount            ( ) const;
+    cgUInt32            add                 ( cgUInt32 tag );
+    void                remove              ( cgUInt32 index );
+    void                clear               ( );
+    cgUInt32            removeExpired       ( cgUInt32Array & tagsOut );
+    void                bakeCurve           ( Curve curve, cgBezierSpline2 & spline );
+    cgFloat             sampleCurve         ( Curve curve, cgFloat t ) const;
+    void                simulate            ( const SimulationParams & params );
+    void                simulate            ( cgUInt32 first, cgUInt32 last, const SimulationParams & params );
+
+    // Stream access
+    cgFloat           * getStream           ( Stream stream ) { return &mStreams[stream].front(); }
+    const cgFloat     * getStream           ( Stream stream ) const { return &mStreams[stream].front(); }
+    cgFloat           & getValue            ( Stream stream, cgUInt32 index ) { return mStreams[stream][index]; }
+    cgFloat             getValue            ( Stream stream, cgUInt32 index ) const { return mStreams[stream][index]; }
+    cgUInt32            getColor            ( cgUInt32 index ) const { return mColors[index]; }
+    cgUInt32            getTag              ( cgUInt32 index ) const { return mTags[index]; }
+
+protected:
+	//-------------------------------------------------------------------------
+	// Protected Static Functions
+	//-------------------------------------------------------------------------
+    static void         executeSimulate     ( cgUInt32 first, cgUInt32 last, void * context );
+
+	//-------------------------------------------------------------------------
+	// Protected Variables
+	//-------------------------------------------------------------------------
+    cgFloatArray    mStreams[StreamCount];                  // Per-attribute particle data streams.
+    cgUInt32Array   mColors;                                // Packed (ARGB) color computed for each particle.
+    cgUInt32Array   mTags;                                  // Caller supplied tag associated with each particle.
+    cgFloat         mCurves[CurveCount][CurveResolution];   // Baked property curve lookup tables.
+    cgUInt32        mCapacity;                              // Maximum number of particles that can be stored.
+    cgUInt32        mCount;                                 // Number of live particles currently stored.
+};
+
+#endif // !_CGE_CGPARTICLESTORE_H_
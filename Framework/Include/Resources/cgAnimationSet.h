@@ -68,15 +68,40 @@ public:
         cgAnimationTargetController   * rotationController;
         cgAnimationTargetController   * translationController;
         cgUInt32                        databaseId;
+        cgUInt32                        index;      // Index of this target's channels within a 'SampleCursor' (assigned by 'prepareKeyStream()').
 
         // Constructor
         TargetData() :
             scaleController( CG_NULL ), rotationController(CG_NULL),
-            translationController(CG_NULL), databaseId(0) {}
+            translationController(CG_NULL), databaseId(0), index(0) {}
 
     };
     CGE_UNORDEREDMAP_DECLARE(cgString, TargetData, TargetDataMap)
 
+    // Key cursors recorded for each target by a 'SampleCursor'.
+    enum CursorChannel
+    {
+        ScaleCursor         = 0,    // Three cursors (X, Y, Z)
+        RotationCursor      = 3,    // One cursor
+        TranslationCursor   = 4,    // Three cursors (X, Y, Z)
+        CursorChannelCount  = 7
+    };
+
+    // Playback state used to sample all targets of the set at monotonically
+    // increasing positions. One should be maintained per playing instance.
+    struct CGE_API SampleCursor
+    {
+        cgDouble        position;   // Periodic frame position at which the cursor was last advanced.
+        cgUInt32        streamKey;  // Next entry in the set's key stream to be consumed.
+        cgUInt32        revision;   // Key stream revision for which the cursor is valid.
+        cgInt32Array    keys;       // Current key for each cursor channel of each target.
+
+        // Constructor
+        SampleCursor() :
+            position( 0 ), streamKey( 0 ), revision( 0xFFFFFFFF ) {}
+
+    };
+
     //-------------------------------------------------------------------------
 	// Constructors & Destructors
 	//-------------------------------------------------------------------------
@@ -104,6 +129,12 @@ public:
     TargetData            * getTargetData       ( const cgString & targetId, bool createTargetData );
     bool                    getSRT              ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, const cgString & targetId, cgInt32 firstFrame, cgInt32 lastFrame, cgVector3 & scale, cgQuaternion & rotation, cgVector3 & translation );
     bool                    getSRT              ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, const cgString & targetId, cgInt32 firstFrame, cgInt32 lastFrame, cgAnimationTarget * defaultsTarget, cgVector3 & scale, cgQuaternion & rotation, cgVector3 & translation );
+    bool                    getSRT              ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, const TargetData & data, cgInt32 firstFrame, cgInt32 lastFrame, cgAnimationTarget * defaultsTarget, cgVector3 & scale, cgQuaternion & rotation, cgVector3 & translation );
+    bool                    getSRT              ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, const TargetData & data, cgInt32 firstFrame, cgInt32 lastFrame, cgAnimationTarget * defaultsTarget, cgInt32 * cursors, cgVector3 & scale, cgQuaternion & rotation, cgVector3 & translation );
+    void                    evaluate            ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, cgInt32 firstFrame, cgInt32 lastFrame, SampleCursor & cursor, cgVector3 * scale, cgQuaternion * rotation, cgVector3 * translation );
+    void                    advanceCursor       ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, cgInt32 firstFrame, cgInt32 lastFrame, SampleCursor & cursor ) const;
+    void                    prepareKeyStream    ( );
+    cgUInt32                getTargetRevision   ( ) const;
     void                    addScaleKey         ( cgInt32 frame, const cgString & targetId, const cgVector3 & scale );
     void                    addRotationKey      ( cgInt32 frame, const cgString & targetId, const cgQuaternion & rotation );
     void                    addTranslationKey   ( cgInt32 frame, const cgString & targetId, const cgVector3 & translation );
@@ -135,11 +166,35 @@ public:
     virtual void            dispose             ( bool disposeBase );
     
 protected:
+    //-------------------------------------------------------------------------
+	// Protected Typdefs, Structures and Enumerations
+	//-------------------------------------------------------------------------
+    // A single entry in the time sorted key stream.
+    struct KeyStreamEntry
+    {
+        cgFloat     frame;      // Frame at which this key is reached.
+        cgUInt32    channel;    // Cursor channel to update (target index * CursorChannelCount + CursorChannel).
+        cgInt32     key;        // Index of the key that begins the segment from this frame onwards.
+
+        // Ordering (keys reached on the same frame are consumed in channel / key order).
+        inline bool operator< ( const KeyStreamEntry & b ) const
+        {
+            if ( frame != b.frame ) return frame < b.frame;
+            if ( channel != b.channel ) return channel < b.channel;
+            return key < b.key;
+        }
+    };
+    CGE_ARRAY_DECLARE(KeyStreamEntry, KeyStreamArray)
+
     //-------------------------------------------------------------------------
     // Protected Methods
     //-------------------------------------------------------------------------
     void                    prepareQueries      ( );
     bool                    serializeSet        ( );
+    cgDouble                computePeriodic     ( cgDouble framePosition, cgAnimationPlaybackMode::Base mode, cgInt32 firstFrame, cgInt32 lastFrame ) const;
+    void                    invalidateKeyStream ( );
+    void                    appendKeyStream     ( cgBezierSpline2 & curve, cgUInt32 channel );
+    void                    appendKeyStream     ( const cgQuaternionAnimationChannel & keys, cgUInt32 channel );
 
     //-------------------------------------------------------------------------
     // Protected Static Constants
@@ -156,6 +211,16 @@ protected:
     cgString            mName;
     /// <summary>A map containing the animation data for a given animation target (by identifier).</summary>
     TargetDataMap       mTargetData;
+    /// <summary>Incremented whenever targets are added / removed or their controllers may have been replaced.</summary>
+    cgUInt32            mTargetRevision;
+    /// <summary>Keys of every cursor channel, sorted by frame, used to advance sample cursors in a single linear pass.</summary>
+    KeyStreamArray      mKeyStream;
+    /// <summary>Incremented whenever the key stream is rebuilt.</summary>
+    cgUInt32            mKeyStreamRevision;
+    /// <summary>Target revision for which the key stream was last built.</summary>
+    cgUInt32            mKeyStreamTargets;
+    /// <summary>Key stream must be rebuilt because keys have been added while serialization was suspended.</summary>
+    bool                mKeyStreamDirty;
     /// <summary>Lowest frame recorded in this animation set.</summary>
     cgInt32             mFirstFrame;
     /// <summary>Highest frame recorded in this animation set.</summary>
@@ -39,6 +39,7 @@ class cgObjectNode;
 class cgRenderDriver;
 class cgResourceManager;
 class cgVertexFormat;
+class cgTriangleBVH;
 
 //-----------------------------------------------------------------------------
 // Globally Unique Type Id(s)
@@ -294,6 +295,7 @@ public:
     bool                    pick                ( const cgVector3 & rayOrigin, const cgVector3 & rayDirection, cgFloat & distanceOut );
     bool                    pick                ( cgCameraNode * camera, const cgSize & viewportSize, const cgTransform & objectTransform, const cgVector3 & rayOrigin, const cgVector3 & rayDirection, cgUInt32 flags, cgFloat wireTolerance, cgFloat & distance );
     bool                    pickFace            ( const cgVector3 & rayOrigin, const cgVector3 & rayDirection, cgVector3 & intersectionOut, cgUInt32 & intersectedFaceOut, cgMaterialHandle & intersectedMaterialOut );
+    cgUInt32                pickPacket          ( cgUInt32 rayCount, const cgVector3 rayOrigins[], const cgVector3 rayDirections[], cgFloat distancesOut[], cgUInt32 intersectedFacesOut[] );
 
     // Material management methods
     void                    setDefaultColor     ( cgUInt32 color );
@@ -436,14 +438,13 @@ protected:
     CGE_MAP_DECLARE  (MeshSubsetKey, MeshSubset*, SubsetKeyMap)
     CGE_ARRAY_DECLARE(MeshSubsetKey, SubsetKeyArray)
 
-    // Simple structure to allow us to leverage the hierarchical properties of a map
-    // to accelerate the weld operation.
-    struct WeldKey
+    // Context passed to the pick tree face filter when testing a single data group.
+    struct PickFilterData
     {
-        cgByte        * vertex;         // Pointer to the vertex for easy access.
-        cgVertexFormat* format;         // Format of the above vertex for easy access.
-        cgFloat         tolerance;      // The tolerance we're using to weld (transport only, these should be the same for every key).
-    };
+        const SubsetKeyArray  * triangleData;   // Material and data group information for each triangle.
+        cgUInt32                dataGroupId;    // The data group being tested.
+    
+    }; // End Struct PickFilterData
 
     // Simple structure to allow us to leverage the hierarchical properties of a map
     // to accelerate the bone index combination process.
@@ -463,7 +464,6 @@ protected:
 	//-------------------------------------------------------------------------
     friend bool CGE_API operator < (const AdjacentEdgeKey & key1, const AdjacentEdgeKey & key2);
     friend bool CGE_API operator < (const MeshSubsetKey & key1, const MeshSubsetKey & key2);
-    friend bool CGE_API operator < (const WeldKey & key1, const WeldKey & key2);
     friend bool CGE_API operator < (const BoneCombinationKey & key1, const BoneCombinationKey & key2);
 
     //-------------------------------------------------------------------------
@@ -475,11 +475,13 @@ protected:
     bool                    generateVertexComponents    ( bool weld );
     bool                    generateVertexNormals       ( cgUInt32 * adjacency, cgUInt32Array * remapArray = CG_NULL );
     bool                    generateVertexTangents      ( );
-    bool                    weldVertices                ( cgUInt32Array * vertexRemap = CG_NULL );
+    bool                    weldVertices                ( cgUInt32Array * vertexRemap = CG_NULL, cgUInt32 threadCount = 0 );
     void                    renderMeshData              ( cgRenderDriver * driver, cgMeshDrawMode::Base mode, const cgMaterialHandle * material, cgUInt32 faceStart, cgUInt32 faceCount, cgUInt32 vertexStart, cgUInt32 vertexCount );
     bool                    restoreBuffers              ( );
     bool                    pickMeshSubset              ( cgUInt32 dataGroupId, cgCameraNode * pCamera, const cgSize & ViewportSize, const cgTransform & ObjectTransform, const cgVector3 & rayOrigin, const cgVector3 & rayDirection, cgUInt32 flags, cgFloat wireTolerance, cgFloat & distanceOut, cgUInt32 & intersectedFaceOut, cgMaterialHandle & intersectedMaterialOut );
     bool                    sortMeshData                ( bool optimize, bool buildHardwareBuffers );
+    cgTriangleBVH         * getPickTree                 ( );
+    void                    releasePickTree             ( );
     
     //-------------------------------------------------------------------------
 	// Protected Static Functions
@@ -487,6 +489,7 @@ protected:
     static void             buildOptimizedIndexBuffer   ( const MeshSubset * subset, cgUInt32 * sourceBuffer, cgUInt32 * destinationBuffer, cgUInt32 minimumVertex, cgUInt32 maximumVertex );
     static cgFloat          findVertexOptimizerScore    ( const OptimizerVertexInfo * vertexInfo );
     static bool             subsetSortPredicate         ( const MeshSubset * lhs, const MeshSubset * rhs );
+    static bool             pickDataGroupFilter         ( cgUInt32 face, void * context );
 
     //-------------------------------------------------------------------------
 	// Protected Variables
@@ -531,6 +534,7 @@ protected:
     cgUInt32                mFaceCount;             // Total number of faces in the prepared mesh.
     cgUInt32                mVertexCount;           // Total number of vertices in the prepared mesh.
     cgMaterialHandleArray   mObjectMaterials;       // Cached array of materials used / retrieved only by the render control batching mechanism (by reference).
+    cgTriangleBVH         * mPickTree;              // Bounding volume hierarchy used to accelerate picking (constructed on demand).
 
     // Mesh data preparation
     cgMeshStatus::Base      mPrepareStatus;         // Preparation status of the mesh (i.e. has it been constructed yet).
@@ -568,7 +572,6 @@ protected:
 //-----------------------------------------------------------------------------
 inline bool CGE_API operator < (const cgMesh::AdjacentEdgeKey & key1, const cgMesh::AdjacentEdgeKey & key2);
 inline bool CGE_API operator < (const cgMesh::MeshSubsetKey & key1, const cgMesh::MeshSubsetKey & key2);
-inline bool CGE_API operator < (const cgMesh::WeldKey & key1, const cgMesh::WeldKey & key2);
 inline bool CGE_API operator < (const cgMesh::BoneCombinationKey & key1, const cgMesh::BoneCombinationKey & key2);
 
 #endif // !_CGE_CGMESH_H_
\ No newline at end of file
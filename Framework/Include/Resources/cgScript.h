@@ -137,6 +137,11 @@ protected:
     //-------------------------------------------------------------------------
     asIScriptContext      * scriptExecute           ( const cgString & declaration, const cgScriptArgument::Array & arguments, bool optional );
     asIScriptContext      * scriptExecute           ( cgScriptFunctionHandle functionHandle, const cgScriptArgument::Array & arguments );
+    void                    computeByteCodeVariant  ( cgUInt32 variantOut[] ) const;
+    void                    computeByteCodeKey      ( const cgUInt32 sourceHash[], const cgUInt32 variantHash[], cgUInt32 keyOut[] ) const;
+    cgString                getByteCodeCacheFile    ( const cgUInt32 variantHash[] ) const;
+    bool                    loadByteCodeCache       ( const cgString & cacheFile, const cgUInt32 key[], bool & moduleReplaced );
+    bool                    writeByteCodeCache      ( const cgString & cacheFile, const cgUInt32 key[] );
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -181,6 +186,8 @@ public:
     cgInt32                 executeMethodInt    ( const cgString & methodName, const cgScriptCompatibleStruct & argumentStruct, bool optional = false, bool * successOut = CG_NULL );
     cgString                executeMethodString ( const cgString & methodName, const cgScriptArgument::Array & arguments, bool optional = false, bool * successOut = CG_NULL );
     cgString                executeMethodString ( const cgString & methodName, const cgScriptCompatibleStruct & argumentStruct, bool optional = false, bool * successOut = CG_NULL );
+    asIScriptContext      * prepareMethod       ( cgScriptFunctionHandle methodHandle, asIScriptContext * context = CG_NULL );
+    void                    executePrepared     ( asIScriptContext * context );
     cgString                getTypeName         ( ) const;
     cgScriptFunctionHandle  getMethodHandle     ( const cgString & declaration );
     void                  * getAddressOfMember  ( const cgString & memberName );
@@ -7,6 +7,7 @@
 #include "Utilities/Profiler.h"
 #include "Utilities/Timer.h"
 #include "Utilities/FilterExpression.h"
+#include "Utilities/JobSystem.h"
 
 // Parent hierarchy
 namespace cgScriptPackages { namespace Core { namespace System {
@@ -21,6 +22,7 @@ namespace Utilities
             DECLARE_PACKAGE_CHILD( Timer )
             DECLARE_PACKAGE_CHILD( Profiler )
             DECLARE_PACKAGE_CHILD( FilterExpression )
+            DECLARE_PACKAGE_CHILD( JobSystem )
         END_SCRIPT_PACKAGE( )
 
         // Member bindings
@@ -59,7 +59,7 @@ namespace FilterExpression
             BINDSUCCESS( engine->registerObjectMethod( "FilterExpression", "bool isCompiled() const", asMETHODPR(cgFilterExpression, isCompiled, () const, bool), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "FilterExpression", "bool compileExpression( const String &in )", asMETHODPR(cgFilterExpression, compileExpression, ( const cgString& ), bool), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "FilterExpression", "bool compileExpression( const String &in, const FilterExpressionIdentifier[] &in )", asMETHODPR(cgFilterExpression, compileExpression, ( const cgString&, const cgFilterExpression::IdentifierArray& ), bool), asCALL_THISCALL) );
-            BINDSUCCESS( engine->registerObjectMethod( "FilterExpression", "bool evalute( uint64 )", asMETHODPR(cgFilterExpression, evaluate, ( cgUInt64 ), bool), asCALL_THISCALL) );            
+            BINDSUCCESS( engine->registerObjectMethod( "FilterExpression", "bool evalute( uint64 )", asMETHODPR(cgFilterExpression, evaluate, ( cgUInt64 ) const, bool), asCALL_THISCALL) );            
         }
 
         //---------------------------------------------------------------------
@@ -0,0 +1,37 @@
+#pragma once
+
+// Required headers
+#include <Scripting/cgScriptPackage.h>
+#include <System/cgJobSystem.h>
+
+// Parent hierarchy
+namespace cgScriptPackages { namespace Core { namespace System { namespace Utilities {
+
+// Package declaration
+namespace JobSystem
+{
+    // Package descriptor
+    class Package : public cgScriptPackage
+    {
+        BEGIN_SCRIPT_PACKAGE( "Core.System.Utilities.JobSystem" )
+        END_SCRIPT_PACKAGE( )
+
+        // Member bindings
+        void bind( cgScriptEngine * engine )
+        {
+            ///////////////////////////////////////////////////////////////////////
+            // Global Utility Functions
+            ///////////////////////////////////////////////////////////////////////
+
+            // Register job system queries. Script functions cannot be submitted as
+            // jobs since the script engine may only be accessed from the main thread.
+            BINDSUCCESS( engine->registerGlobalFunction( "bool isJobSystemInitialized( )", asFUNCTIONPR(cgJobSystem::isInitialized, ( ), bool), asCALL_CDECL) );
+            BINDSUCCESS( engine->registerGlobalFunction( "uint getJobWorkerCount( )", asFUNCTIONPR(cgJobSystem::getWorkerCount, ( ), cgUInt32), asCALL_CDECL) );
+            BINDSUCCESS( engine->registerGlobalFunction( "uint getJobThreadIndex( )", asFUNCTIONPR(cgJobSystem::getThreadIndex, ( ), cgUInt32), asCALL_CDECL) );
+            BINDSUCCESS( engine->registerGlobalFunction( "uint getProcessorCount( )", asFUNCTIONPR(cgJobSystem::getProcessorCount, ( ), cgUInt32), asCALL_CDECL) );
+            BINDSUCCESS( engine->registerGlobalFunction( "bool runPendingJob( )", asFUNCTIONPR(cgJobSystem::runPendingJob, ( ), bool), asCALL_CDECL) );
+        }
+
+    }; // End Class : Package
+
+} } } } } // End Namespace : cgScriptPackages::Core::System::Utilities::JobSystem
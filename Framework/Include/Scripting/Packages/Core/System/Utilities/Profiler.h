@@ -39,6 +39,8 @@ namespace Profiler
             BINDSUCCESS( pEngine->registerObjectProperty( "ProfilerConfig", "bool broadcastData"     , offsetof(cgProfiler::InitConfig,broadcastData) ) );
             BINDSUCCESS( pEngine->registerObjectProperty( "ProfilerConfig", "uint16 broadcastPort"   , offsetof(cgProfiler::InitConfig,broadcastPort) ) );
             BINDSUCCESS( pEngine->registerObjectProperty( "ProfilerConfig", "float broadcastInterval", offsetof(cgProfiler::InitConfig,broadcastInterval) ) );
+            BINDSUCCESS( pEngine->registerObjectProperty( "ProfilerConfig", "bool captureTrace"      , offsetof(cgProfiler::InitConfig,captureTrace) ) );
+            BINDSUCCESS( pEngine->registerObjectProperty( "ProfilerConfig", "uint traceBufferSize"   , offsetof(cgProfiler::InitConfig,traceBufferSize) ) );
 
             ///////////////////////////////////////////////////////////////////////
             // cgProfiler (Class)
@@ -56,6 +58,7 @@ namespace Profiler
             BINDSUCCESS( pEngine->registerObjectMethod( "Profiler", "void endProcess()", asMETHODPR(cgProfiler, endProcess, (), void), asCALL_THISCALL) );
             BINDSUCCESS( pEngine->registerObjectMethod( "Profiler", "void endFrame()", asMETHODPR(cgProfiler, endFrame, (), void), asCALL_THISCALL) );
             BINDSUCCESS( pEngine->registerObjectMethod( "Profiler", "void primitivesDrawn( uint )", asMETHODPR(cgProfiler, primitivesDrawn, (cgUInt32), void), asCALL_THISCALL) );
+            BINDSUCCESS( pEngine->registerObjectMethod( "Profiler", "bool exportTrace( const String &in )", asMETHODPR(cgProfiler, exportTrace, ( const cgString& ), bool), asCALL_THISCALL) );
 
             ///////////////////////////////////////////////////////////////////////
             // Global Utility Functions
@@ -117,6 +117,10 @@ namespace ObjectNode
         BINDSUCCESS( engine->registerObjectMethod(typeName, "bool hasPendingUpdates( ) const", asMETHODPR(type,hasPendingUpdates,( ) const, bool), asCALL_THISCALL) );
         BINDSUCCESS( engine->registerObjectMethod(typeName, "uint getPendingUpdates( ) const", asMETHODPR(type,getPendingUpdates,( ) const, cgUInt32), asCALL_THISCALL) );
         BINDSUCCESS( engine->registerObjectMethod(typeName, "uint getLastDirtyFrame( ) const", asMETHODPR(type,getLastDirtyFrame,( ) const, cgUInt32), asCALL_THISCALL) );
+        BINDSUCCESS( engine->registerObjectMethod(typeName, "void enableBatchTransforms( bool )", asMETHODPR(type,enableBatchTransforms,( bool ), void), asCALL_THISCALL) );
+        BINDSUCCESS( engine->registerObjectMethod(typeName, "bool isBatchTransformsEnabled( ) const", asMETHODPR(type,isBatchTransformsEnabled,( ) const, bool), asCALL_THISCALL) );
+        BINDSUCCESS( engine->registerObjectMethod(typeName, "void setUpdateThreadSafe( bool )", asMETHODPR(type,setUpdateThreadSafe,( bool ), void), asCALL_THISCALL) );
+        BINDSUCCESS( engine->registerObjectMethod(typeName, "bool isUpdateThreadSafe( ) const", asMETHODPR(type,isUpdateThreadSafe,( ) const, bool), asCALL_THISCALL) );
 
         // Relationship Management
         BINDSUCCESS( engine->registerObjectMethod(typeName, "ObjectNode @+ getParent( ) const", asMETHODPR(type,getParent,() const,cgObjectNode*), asCALL_THISCALL) );
@@ -52,6 +52,8 @@ namespace Scene
 			BINDSUCCESS( engine->registerObjectMethod( "Scene", "bool isEventSuppressionEnabled( ) const", asMETHODPR(cgScene,isEventSuppressionEnabled,() const,bool), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "bool isUpdating( ) const", asMETHODPR(cgScene,isUpdating,() const,bool), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "bool isUpdatingEnabled( ) const", asMETHODPR(cgScene,isUpdatingEnabled,() const,bool), asCALL_THISCALL) );
+            BINDSUCCESS( engine->registerObjectMethod( "Scene", "void enableParallelUpdates( bool )", asMETHODPR(cgScene,enableParallelUpdates,( bool ),void), asCALL_THISCALL) );
+            BINDSUCCESS( engine->registerObjectMethod( "Scene", "bool isParallelUpdatesEnabled( ) const", asMETHODPR(cgScene,isParallelUpdatesEnabled,() const,bool), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "void addRootNode( ObjectNode@+ )", asMETHODPR(cgScene,addRootNode,( cgObjectNode* ),void), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "void removeRootNode( ObjectNode@+ )", asMETHODPR(cgScene,removeRootNode,( cgObjectNode* ),void), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "void setObjectUpdateRate( ObjectNode@+, UpdateRate )", asMETHODPR(cgScene,setObjectUpdateRate,( cgObjectNode*, cgUpdateRate::Base ),void), asCALL_THISCALL) );
@@ -77,6 +79,7 @@ namespace Scene
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "ObjectNode@+ getObjectNodeById( uint ) const", asMETHODPR(cgScene,getObjectNodeById,( cgUInt32 ) const, cgObjectNode* ), asCALL_THISCALL) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "void getObjectNodesInBounds( const Vector3 &in, float, array<ObjectNode@>@+ ) const", asFUNCTIONPR(getObjectNodesInBounds,( const cgVector3 &, cgFloat, ScriptArray*, cgScene* ), void), asCALL_CDECL_OBJLAST) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "void getObjectNodesInBounds( const BoundingBox &in, array<ObjectNode@>@+ ) const", asFUNCTIONPR(getObjectNodesInBounds,( const cgBoundingBox &, ScriptArray*, cgScene* ), void), asCALL_CDECL_OBJLAST) );
+            BINDSUCCESS( engine->registerObjectMethod( "Scene", "void getNearestObjectNodes( const Vector3 &in, uint, float, array<ObjectNode@>@+ ) const", asFUNCTIONPR(getNearestObjectNodes,( const cgVector3 &, cgUInt32, cgFloat, ScriptArray*, cgScene* ), void), asCALL_CDECL_OBJLAST) );
             BINDSUCCESS( engine->registerObjectMethod( "Scene", "bool rayCastClosest( const Vector3 &in, const Vector3 &in, SceneRayCastContact &inout )", asMETHODPR(cgScene, rayCastClosest, ( const cgVector3&, const cgVector3&, cgSceneRayCastContact& ), bool), asCALL_THISCALL) );
             // ToDo: bool                rayCast             ( const cgVector3 & from, const cgVector3 & to, bool sortContacts, cgSceneRayCastContact::Array & contacts );
         }
@@ -147,6 +150,23 @@ namespace Scene
                 nodes->setValue( i, &sceneNodes[i] );
         }
 
+        //---------------------------------------------------------------------
+        //  Name : getNearestObjectNodes ()
+        /// <summary>
+        /// Provides an alternative overload for the script accessible
+        /// Scene::getNearestObjectNodes() method that allows the script to
+        /// use a templated array type directly.
+        /// </summary>
+        //---------------------------------------------------------------------
+        static void getNearestObjectNodes( const cgVector3 & center, cgUInt32 count, cgFloat maximumDistance, ScriptArray * nodes, cgScene *thisPointer )
+        {
+            cgObjectNodeArray sceneNodes;
+            thisPointer->getNearestObjectNodes( center, count, maximumDistance, sceneNodes );
+            nodes->resize( sceneNodes.size() );
+            for ( size_t i = 0; i < sceneNodes.size(); ++i )
+                nodes->setValue( i, &sceneNodes[i] );
+        }
+
     }; // End Class : Package
 
 } } } } // End Namespace : cgScriptPackages::Core::World::Scene
@@ -58,6 +58,21 @@ class CGE_API cgScriptEngine
     friend class cgScript;
 
 public:
+    //-------------------------------------------------------------------------
+    // Public Structures
+    //-------------------------------------------------------------------------
+    // Statistics describing the effectiveness of the on-disk bytecode cache.
+    struct CGE_API ByteCodeCacheStats
+    {
+        cgUInt32    hits;       // Scripts that were loaded directly from cached bytecode.
+        cgUInt32    misses;     // Scripts with no cache entry, or an entry whose key did not match.
+        cgUInt32    failures;   // Cache entries that matched but could not be loaded (script was rebuilt).
+        cgUInt32    writes;     // Cache entries written after building a script.
+
+        // Constructor
+        ByteCodeCacheStats() : hits(0), misses(0), failures(0), writes(0) {}
+    };
+
     //-------------------------------------------------------------------------
     // Constructors & Destructors
     //-------------------------------------------------------------------------
@@ -87,6 +102,13 @@ public:
 
     bool                declarePackage              ( cgScriptPackage * package, bool declareChildren );
     bool                bindPackage                 ( const cgString & packageNamespace, bool bindChildren );
+    void                getInterfaceHash            ( cgUInt32 hash[] );
+
+    // Bytecode cache
+    void                enableByteCodeCache         ( bool enable );
+    bool                isByteCodeCacheEnabled      ( ) const;
+    const ByteCodeCacheStats & getByteCodeCacheStats( ) const;
+    void                resetByteCodeCacheStats     ( );
 
 
     // Registration
@@ -133,6 +155,7 @@ protected:
     // Protected Methods
     //-------------------------------------------------------------------------
     void                unbindPackage           ( PackageEntry * entry );
+    void                computeInterfaceHash    ( );
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -147,6 +170,10 @@ protected:
     LoadedScriptSet     mLoadedScripts;         // Scripts currently bound to this engine.
     bool                mVerboseOutput;         // Output compiler failures to log?
     bool                mOutputWarnings;        // Output warnings to log?
+    cgUInt32            mInterfaceHash[5];      // SHA1 hash of the registered application interface (types, functions, properties).
+    bool                mInterfaceHashDirty;    // The registered interface has changed since the hash was last computed.
+    bool                mByteCodeCacheEnabled;  // Load / store compiled script bytecode in the on-disk cache?
+    ByteCodeCacheStats  mByteCodeCacheStats;    // Running bytecode cache statistics.
 
 private:
     //-------------------------------------------------------------------------
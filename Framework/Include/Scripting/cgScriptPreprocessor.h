@@ -26,6 +26,7 @@
 //-----------------------------------------------------------------------------
 #include <cgBase.h>
 #include <Resources/cgScript.h>
+#include <Math/cgChecksum.h>
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -70,6 +71,7 @@ public:
     // Public Methods
     //-------------------------------------------------------------------------
     bool        process         ( cgInputStream stream, const DefinitionMap & defines, cgScript::SourceFileArray & sourceFiles );
+    void        getSourceHash   ( cgUInt32 hash[] ) const;
     
     //-------------------------------------------------------------------------
     // Public Static Methods
@@ -100,6 +102,7 @@ protected:
     void    skipStatement               ( TokenData & t, const std::string & script );
     void    excludeCode                 ( TokenData & t, std::string & script );
     void    overwriteCode               ( std::string & script, size_t start, size_t length );
+    bool    addScriptSection            ( asIScriptModule * module, const cgChar * sectionName, const std::string & code, cgInt lineOffset = 0 );
     
     // Script code parsers
     bool    parsePreprocessorDirective  ( TokenData & t, std::string & script, std::stack<bool> & conditionStack, asIScriptModule * module, const cgString & sectionName, cgScript::SourceFileArray & sourceFiles );
@@ -124,6 +127,8 @@ protected:
     cgScript          * mScript;
     DefinitionMap       mDefinitions;   // Any words/macros defined in the script (#define) or by app.
     bool                mShaderScript;  // Interpret shader replacement sections during pre-processing phase.
+    cgChecksum::SHA1    mSourceChecksum;// Checksum of all processed code added to the module.
+    cgUInt32            mSourceHash[5]; // Final hash of the processed code (valid after a successful call to 'process()').
 
     //-------------------------------------------------------------------------
     // Protected Static Variables
@@ -0,0 +1,164 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgStdThreading.h                                                   //
+//                                                                           //
+// Desc : Portable implementation of the core system threading types         //
+//        (thread, critical section, etc.) built on top of the C++11         //
+//        standard library.                                                  //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGSTDTHREADING_H_ )
+#define _CGE_CGSTDTHREADING_H_
+
+//-----------------------------------------------------------------------------
+// cgStdThreading Header Includes
+//-----------------------------------------------------------------------------
+#include <cgConfig.h>
+#include <System/cgThreading.h>
+
+#if defined(CGE_STD_THREADING)
+
+// Standard library threading includes
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgStdCriticalSection (Class)
+/// <summary>
+/// Portable critical section implementation. As with its Windows(tm)
+/// counterpart, the section may be entered recursively by the owning thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgStdCriticalSection : public cgCriticalSection
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+             cgStdCriticalSection( );
+    virtual ~cgStdCriticalSection( );
+
+    //-------------------------------------------------------------------------
+    // Public Virtual Methods (Overrides cgCriticalSection)
+    //-------------------------------------------------------------------------
+    virtual bool        enter           ( );
+    virtual bool        tryEnter        ( );
+    virtual bool        exit            ( );
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Variables
+    //-------------------------------------------------------------------------
+    std::recursive_mutex    mSection;
+
+}; // End Class cgStdCriticalSection
+
+//-----------------------------------------------------------------------------
+//  Name : cgStdEvent (Class)
+/// <summary>
+/// Portable event implementation.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgStdEvent : public cgEvent
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+             cgStdEvent( );
+             cgStdEvent( bool autoReset );
+    virtual ~cgStdEvent( );
+
+    //-------------------------------------------------------------------------
+    // Public Virtual Methods (Overrides cgEvent)
+    //-------------------------------------------------------------------------
+    virtual bool    hasSignaled    ( );
+    virtual bool    wait           ( cgUInt32 milliseconds );
+    virtual void    signal         ( );
+    virtual void    reset          ( );
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Variables
+    //-------------------------------------------------------------------------
+    std::mutex              mMutex;         // Protects the signaled state.
+    std::condition_variable mCondition;     // Notified whenever the event is signaled.
+    bool                    mSignaled;      // Is the event currently signaled?
+    bool                    mAutoReset;     // Reset automatically once a waiting thread is released?
+
+}; // End Class cgStdEvent
+
+//-----------------------------------------------------------------------------
+//  Name : cgStdThread (Class)
+/// <summary>
+/// Portable thread implementation.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgStdThread : public cgThread
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+             cgStdThread( );
+    virtual ~cgStdThread( );
+
+    //-------------------------------------------------------------------------
+    // Public Virtual Methods (Overrides cgThread)
+    //-------------------------------------------------------------------------
+    virtual void        setPriority         ( cgThreadPriority::Base priority );
+    virtual void        setThreadData       ( cgThreadFunc workFunction, void * context );
+    virtual ThreadState getThreadState      ( ) const;
+    virtual bool        start               ( cgThreadFunc workFunction, void * context );
+    virtual bool        start               ( );
+    virtual void        suspend             ( );
+    virtual void        resume              ( );
+    virtual bool        suspendedWait       ( );
+    virtual void        sleep               ( cgUInt32 milliseconds );
+    virtual void        terminate           ( );
+    virtual void        join                ( );
+    virtual void        signalTerminate     ( );
+    virtual bool        terminateRequested  ( ) const;
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Variables
+    //-------------------------------------------------------------------------
+    std::thread           * mThread;                // Native thread object.
+    cgThreadFunc            mThreadFunction;        // User supplied callback function pointer to execute.
+    void                  * mThreadContext;         // User supplied context data to pass to the thread function.
+    cgThreadPriority::Base  mPriority;              // Selected thread priority (advisory only).
+    std::atomic<bool>       mFinished;              // Has the thread function returned?
+    std::atomic<bool>       mExitRequested;         // Has the thread been asked to exit?
+    std::atomic<bool>       mSuspended;             // Should the thread suspend at its next 'suspendedWait()'?
+    std::mutex              mStateMutex;            // Protects suspension state changes.
+    std::condition_variable mStateCondition;        // Notified when the suspension or exit state changes.
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Static Functions
+    //-------------------------------------------------------------------------
+    static void threadStub( cgStdThread * thread );
+
+}; // End Class cgStdThread
+
+#endif // CGE_STD_THREADING
+
+#endif // !_CGE_CGSTDTHREADING_H_
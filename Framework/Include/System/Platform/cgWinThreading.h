@@ -88,6 +88,7 @@ public:
     // Public Virtual Methods (Overrides cgEvent)
     //-------------------------------------------------------------------------
     virtual bool    hasSignaled    ( );
+    virtual bool    wait           ( cgUInt32 milliseconds );
     virtual void    signal         ( );
     virtual void    reset          ( );
 
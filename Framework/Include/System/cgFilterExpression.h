@@ -69,7 +69,8 @@ public:
     bool            isCompiled          ( ) const;
     bool            compileExpression   ( const cgString & expression );
     bool            compileExpression   ( const cgString & expression, const IdentifierArray & defines );
-    bool            evaluate            ( cgUInt64 value );
+    bool            evaluate            ( cgUInt64 value ) const;
+    void            evaluate            ( const cgUInt64 * values, size_t count, bool * results ) const;
 
     //-------------------------------------------------------------------------
     // Public Virtual Methods (Overrides DisposableScriptObject)
@@ -77,6 +78,12 @@ public:
     virtual void    dispose             ( bool disposeBase );
 
 protected:
+    //-------------------------------------------------------------------------
+	// Protected Constants
+	//-------------------------------------------------------------------------
+    static const size_t MaxStackDepth   = 256;  // Maximum depth of the evaluation register stack.
+    static const size_t BatchSize       = 64;   // Number of values evaluated together in batch mode (one per result bit).
+
     //-------------------------------------------------------------------------
 	// Protected Enumerations
 	//-------------------------------------------------------------------------
@@ -171,11 +178,17 @@ protected:
     bool            tokenizeExpression  ( FilterTokenArray & tokens, const cgString & expression );
     bool            preProcessExpression( FilterTokenArray & tokens, const FilterDefineMap * const defines );
     bool            compileExpression   ( FilterInstructionArray & instructions, const FilterTokenArray & tokens, bool optimize );
+    void            buildClosedForm     ( );
+    cgUInt64        evaluateBlock       ( const cgUInt64 * values, size_t count ) const;
     
     //-------------------------------------------------------------------------
 	// Protected Variables
 	//-------------------------------------------------------------------------
     FilterInstructionArray  mInstructions;    // List of instructions to execute during evaluation.
+    bool                    mClosedForm;      // Expression reduces to a simple mask test (no need to execute instructions).
+    bool                    mClosedFormAny;   // Closed form passes if any tested bit matches (OR), rather than all (AND).
+    cgUInt64                mClosedSetMask;   // Closed form bits that match when set.
+    cgUInt64                mClosedClearMask; // Closed form bits that match when clear.
 };
 
 #endif // !_CGE_CGFILTEREXPRESSION_H_
\ No newline at end of file
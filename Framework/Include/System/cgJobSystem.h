@@ -0,0 +1,144 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgJobSystem.h                                                      //
+//                                                                           //
+// Desc : Fixed size work-stealing job scheduler supporting job counters,    //
+//        dependencies and parallel-for style work distribution.             //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGJOBSYSTEM_H_ )
+#define _CGE_CGJOBSYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// cgJobSystem Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBaseTypes.h>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class cgThread;
+
+//-----------------------------------------------------------------------------
+// Common Global Typedefs
+//-----------------------------------------------------------------------------
+typedef void (*cgJobFunc)( void * context );
+typedef void (*cgParallelForFunc)( cgUInt32 first, cgUInt32 last, void * context );
+
+//-----------------------------------------------------------------------------
+// Common Global Structures
+//-----------------------------------------------------------------------------
+struct CGE_API cgJobDesc
+{
+    cgJobFunc   function;   // Function to execute.
+    void      * context;    // User supplied context passed to the function.
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgJobCounter (Class)
+/// <summary>
+/// Tracks the number of outstanding jobs in a group submitted to the job
+/// system. The counter is incremented when jobs are submitted and decremented
+/// as each completes. Counters can be waited upon, or supplied as a dependency
+/// when submitting further jobs so that those jobs are only queued once the
+/// group has completed. A counter must not be destroyed while it has
+/// outstanding jobs or dependent submissions.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgJobCounter
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+     cgJobCounter( );
+    ~cgJobCounter( );
+
+    //-------------------------------------------------------------------------
+    // Public Methods
+    //-------------------------------------------------------------------------
+    bool        isComplete      ( ) const;
+    cgInt32     getValue        ( ) const;
+
+private:
+    //-------------------------------------------------------------------------
+    // Friend List
+    //-------------------------------------------------------------------------
+    friend class cgJobSystem;
+
+    //-------------------------------------------------------------------------
+    // Private Structures
+    //-------------------------------------------------------------------------
+    struct WaitingJob;
+
+    //-------------------------------------------------------------------------
+    // Private Variables
+    //-------------------------------------------------------------------------
+    volatile cgInt32    mValue;     // Number of jobs still outstanding.
+    WaitingJob        * mWaiting;   // Jobs to queue once this counter reaches zero.
+
+    //-------------------------------------------------------------------------
+    // Private Methods (Not copyable)
+    //-------------------------------------------------------------------------
+    cgJobCounter( const cgJobCounter & );
+    cgJobCounter & operator=( const cgJobCounter & );
+};
+
+//-----------------------------------------------------------------------------
+//  Name : cgJobSystem (Class)
+/// <summary>
+/// Static class that manages a fixed number of worker threads, each of which
+/// owns a local job queue. Jobs submitted from a worker are pushed to, and
+/// popped from the back of, that worker's own queue while idle workers steal
+/// from the front of the queues belonging to other threads. Jobs submitted
+/// from any thread outside of the system are placed into a shared queue.
+/// Waiting on a counter never blocks the caller outright; the calling thread
+/// instead helps to execute outstanding jobs until the counter completes.
+/// If the system has not been initialized, all jobs are executed immediately
+/// on the submitting thread. Jobs should not block on I/O or other external
+/// events since each would stall one of the workers; long running or blocking
+/// work belongs on a dedicated thread (see cgThreadPool::createThread()).
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgJobSystem
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Static Functions
+    //-------------------------------------------------------------------------
+    static bool         initialize          ( cgUInt32 workerCount = 0 );
+    static void         shutdown            ( );
+    static bool         isInitialized       ( );
+    static cgUInt32     getWorkerCount      ( );
+    static cgUInt32     getThreadIndex      ( );
+    static cgUInt32     getProcessorCount   ( );
+    static void         submit              ( cgJobFunc function, void * context, cgJobCounter * counter = CG_NULL, cgJobCounter * dependency = CG_NULL );
+    static void         submit              ( const cgJobDesc jobs[], cgUInt32 jobCount, cgJobCounter * counter = CG_NULL, cgJobCounter * dependency = CG_NULL );
+    static void         wait                ( cgJobCounter * counter );
+    static bool         runPendingJob       ( );
+    static void         parallelFor         ( cgUInt32 count, cgUInt32 grainSize, cgParallelForFunc function, void * context );
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Static Functions
+    //-------------------------------------------------------------------------
+    static void         completeJob         ( cgJobCounter * counter );
+    static cgUInt32     workerThread        ( cgThread * thread, void * context );
+};
+
+#endif // !_CGE_CGJOBSYSTEM_H_
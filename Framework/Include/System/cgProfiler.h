@@ -97,6 +97,10 @@ struct CGE_API cgProfilerStatistics
     cgInt64     lastFrameSample;    
     /// <summary>Internal value for used during the measurement process for any required purpose.</summary>
     cgInt64     sampleData;
+    /// <summary>Persistent name used to identify this process in captured trace data (registered on first use).</summary>
+    const cgChar * traceName;
+    /// <summary>Was a trace scope opened for the current sample (capture may be toggled while it is in progress)?</summary>
+    bool        traceOpen;
 
     /// <summary>Overall range of values seen during the entire application lifetime.</summary>
     Values      overall;
@@ -116,6 +120,8 @@ struct CGE_API cgProfilerStatistics
         parentId        ( -1 ),
         lastFrameSample ( -1 ),
         sampleData      ( 0 ),
+        traceName       ( CG_NULL ),
+        traceOpen       ( false ),
         snapshotTime    ( 0 ) {}
 
 
@@ -151,6 +157,8 @@ public:
         cgUInt16            broadcastPort;      // The port on which to listen if broadcasting profiler data.
         cgFloat             broadcastInterval;  // Interval, in seconds, at which the profiler data will be broadcast.
         bool                outputMarkers;      // Output performance markers to any performance monitoring API (i.e. D3DPERF)
+        bool                captureTrace;       // Record scoped trace data for export via 'exportTrace()' (see cgTraceProfiler).
+        cgUInt32            traceBufferSize;    // Number of trace events retained per thread (0 = default).
         
         // Constructor
         InitConfig()
@@ -160,6 +168,8 @@ public:
             broadcastPort       = 46352;
             broadcastInterval   = 0.25f;
             outputMarkers       = false;
+            captureTrace        = false;
+            traceBufferSize     = 0;
             
         } // End Constructor
     };
@@ -187,6 +197,9 @@ public:
     void                    endProcess          ( );
     void                    endFrame            ( );
     void                    primitivesDrawn     ( cgUInt32 primitiveCount );
+
+    // Trace Capture
+    bool                    exportTrace         ( const cgString & fileName );
     
     //-------------------------------------------------------------------------
     // Public Virtual Methods (Overrides DisposableScriptObject)
@@ -82,6 +82,18 @@ public:
     cgDouble    deliveryTime;           // Time (in seconds) at which the message was delivered.
     bool        delayed;                // The message was delayed prior to sending
     bool        sourceUnregistered;     // Notification that the message source has been / is being unregistered
+    bool        pooledData;             // The guaranteed data is owned by the reference manager's payload pool.
+
+private:
+    //-------------------------------------------------------------------------
+    // Friend List
+    //-------------------------------------------------------------------------
+    friend class cgReferenceManager;
+
+    //-------------------------------------------------------------------------
+    // Private Methods
+    //-------------------------------------------------------------------------
+    void        copyProperties          ( const cgMessage & messageIn );
 };
 
 //-----------------------------------------------------------------------------
@@ -100,6 +112,38 @@ public:
     //-------------------------------------------------------------------------
     static const cgUInt32 InternalRefThreshold = 0x80000000;
 
+    //-------------------------------------------------------------------------
+    // Public Structures
+    //-------------------------------------------------------------------------
+    /// <summary>Describes the state of the delayed message queue and the cost of message dispatch.</summary>
+    struct CGE_API MessageStatistics
+    {
+        /// <summary>Number of delayed messages currently waiting for delivery.</summary>
+        cgUInt32    queueDepth;
+        /// <summary>Largest number of delayed messages that have been waiting for delivery at any one time.</summary>
+        cgUInt32    peakQueueDepth;
+        /// <summary>Number of delayed messages dispatched during the most recent call to processMessages().</summary>
+        cgUInt32    messagesDispatched;
+        /// <summary>Total number of delayed messages dispatched since the application began.</summary>
+        cgUInt32    totalDispatched;
+        /// <summary>Number of message structures currently owned by the message pool (whether in use or free).</summary>
+        cgUInt32    pooledMessages;
+        /// <summary>Time (in seconds) spent dispatching messages during the most recent call to processMessages().</summary>
+        cgDouble    dispatchTime;
+        /// <summary>Largest time (in seconds) spent dispatching messages during any single call to processMessages().</summary>
+        cgDouble    peakDispatchTime;
+
+        // Constructor
+        MessageStatistics( ) :
+            queueDepth        ( 0 ),
+            peakQueueDepth    ( 0 ),
+            messagesDispatched( 0 ),
+            totalDispatched   ( 0 ),
+            pooledMessages    ( 0 ),
+            dispatchTime      ( 0 ),
+            peakDispatchTime  ( 0 ) {}
+    };
+
     //-------------------------------------------------------------------------
     // Public Static Functions
     //-------------------------------------------------------------------------
@@ -121,13 +165,59 @@ public:
     static bool         subscribeToReference    ( cgUInt32 nSubscriber, cgUInt32 referenceId );
     static bool         unsubscribeFromReference( cgUInt32 nSubscriber, cgUInt32 referenceId );
     static void         processMessages         ( cgUInt32 from = 0xFFFFFFFF, bool clearAll = false, bool sendOnClear = true );
+    static const MessageStatistics & getMessageStatistics( );
    
 private:
+    //-------------------------------------------------------------------------
+    // Private Constants
+    //-------------------------------------------------------------------------
+    static const cgUInt32 MessageSlabSize       = 256;      // Number of messages allocated at once by the message pool.
+    static const cgUInt32 PayloadSlabSize       = 16384;    // Size (in bytes) of each block of memory allocated by the payload pool.
+    static const cgUInt32 MinPayloadShift       = 5;        // Smallest payload block is 32 bytes.
+    static const cgUInt32 PayloadClassCount     = 6;        // Largest payload block is 1024 bytes.
+
     //-------------------------------------------------------------------------
     // Private Enumerations
     //-------------------------------------------------------------------------
     enum DestinationType { Individual, Group, Subscribers, All };
 
+    //-------------------------------------------------------------------------
+    // Private Structures
+    //-------------------------------------------------------------------------
+    struct QueuedMessage
+    {
+        cgDouble        deliveryTime;   // Time (in seconds) at which the message should be delivered.
+        cgUInt64        sequence;       // Order in which the message was queued (maintains send order for equal delivery times).
+        DestinationType destination;    // Type of destination to which the message will be issued.
+        cgMessage     * message;        // The pooled copy of the message to deliver.
+    };
+    struct DeliveredBefore
+    {
+        inline bool operator() ( const QueuedMessage & a, const QueuedMessage & b ) const
+        {
+            if ( a.deliveryTime != b.deliveryTime )
+                return a.deliveryTime < b.deliveryTime;
+            return a.sequence < b.sequence;
+        }
+    };
+    struct DeliveredAfter
+    {
+        inline bool operator() ( const QueuedMessage & a, const QueuedMessage & b ) const
+        {
+            return DeliveredBefore()( b, a );
+        }
+    };
+    struct DispatchOrder
+    {
+        // Individual messages first, grouped by target. Broadcasts retain their existing order.
+        inline bool operator() ( const QueuedMessage & a, const QueuedMessage & b ) const
+        {
+            if ( a.destination != Individual || b.destination != Individual )
+                return ( a.destination == Individual && b.destination != Individual );
+            return a.message->toId < b.message->toId;
+        }
+    };
+
     //-------------------------------------------------------------------------
     // Private Typedefs
     //-------------------------------------------------------------------------
@@ -136,13 +226,20 @@ private:
     CGE_UNORDEREDSET_DECLARE(void*, ReferencePtrSet)
     CGE_UNORDEREDMAP_DECLARE(cgUID, ReferenceSet, GroupMap)
     CGE_UNORDEREDMAP_DECLARE(cgUInt32, ReferenceSet, SubscriberMap)
-    CGE_LIST_DECLARE        (cgMessage*, MessageList)
+    CGE_ARRAY_DECLARE       (QueuedMessage, MessageHeap)
+    CGE_ARRAY_DECLARE       (cgMessage*, MessageArray)
+    CGE_ARRAY_DECLARE       (cgByte*, PayloadArray)
     
     //-------------------------------------------------------------------------
     // Private Static Functions
     //-------------------------------------------------------------------------
-    static bool                 queueMessage            ( cgMessage * message, MessageList & messageQueue );
+    static bool                 queueMessage            ( cgMessage * message, DestinationType destination );
     static bool                 issueMessage            ( cgMessage * message, DestinationType destination );
+    static cgMessage          * allocateMessage         ( );
+    static void                 releaseMessage          ( cgMessage * message );
+    static cgByte             * allocatePayload         ( cgUInt32 size );
+    static void                 releasePayload          ( cgByte * data, cgUInt32 size );
+    static void                 releaseMessagePool      ( );
     
     //-------------------------------------------------------------------------
     // Private Static Variables
@@ -150,10 +247,13 @@ private:
     static ReferenceMap         mSerializedReferences;      // List of currently registered 'serialized' reference targets
     static ReferenceMap         mInternalReferences;        // List of currently registered 'internal' reference targets
     static ReferencePtrSet      mValidReferences;           // A set containing pointers to /all/ valid references.
-    static MessageList          mMessageQueue;              // List of messages queued for delayed sending
-    static MessageList          mMessageGroupQueue;         // List of group messages queued for delayed sending
-    static MessageList          mMessageAllQueue;           // List of system wide messages queued for delayed sending
-    static MessageList          mMessageSubscriberQueue;    // List of messages, destined for a particular set of subscribers, queued for delayed sending
+    static MessageHeap          mMessageQueue;              // Heap of messages queued for delayed sending, earliest delivery time first
+    static cgUInt64             mMessageSequence;           // Sequence number to assign to the next queued message
+    static MessageArray         mFreeMessages;              // Pooled message structures available for reuse
+    static MessageArray         mMessageSlabs;              // Blocks of message structures allocated by the message pool
+    static PayloadArray         mFreePayloads[PayloadClassCount]; // Pooled guaranteed data blocks available for reuse (by size class)
+    static PayloadArray         mPayloadSlabs;              // Blocks of memory allocated by the payload pool
+    static MessageStatistics    mMessageStatistics;         // Queue depth and dispatch cost counters
     static GroupMap             mMessagingGroups;           // List of targets categorised by group
     static SubscriberMap        mSubscriberTable;           // List of subscribers for specific targets.
     static SubscriberMap        mSubscribedToTable;         // Reverse of the above table.
@@ -71,6 +71,11 @@ public:
     //-------------------------------------------------------------------------
     static cgCriticalSection * createInstance( );
 
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+    virtual ~cgCriticalSection( ) {}
+
     //-------------------------------------------------------------------------
     // Public Virtual Methods
     //-------------------------------------------------------------------------
@@ -107,6 +112,11 @@ public:
     //-------------------------------------------------------------------------
     static cgThread * createInstance( );
 
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+    virtual ~cgThread( ) {}
+
     //-------------------------------------------------------------------------
     // Public Virtual Methods
     //-------------------------------------------------------------------------
@@ -142,10 +152,16 @@ public:
     //-------------------------------------------------------------------------
     static cgEvent * createInstance( bool autoReset = true );
 
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+    virtual ~cgEvent( ) {}
+
     //-------------------------------------------------------------------------
     // Public Virtual Methods
     //-------------------------------------------------------------------------
     virtual bool hasSignaled    ( ) = 0;
+    virtual bool wait           ( cgUInt32 milliseconds ) = 0;
     virtual void signal         ( ) = 0;
     virtual void reset          ( ) = 0;
 
@@ -157,6 +173,10 @@ public:
 /// Static class through which threads can be managed. While it is possible for
 /// the application to create standalone threads, this thread pool class
 /// provides additional features such as monitoring and completion events.
+/// Each call creates a dedicated thread that may run for as long as it needs
+/// and block freely (on file / network I/O, for instance). Short, non-blocking
+/// units of work should instead be submitted to the cgJobSystem, whose fixed
+/// set of worker threads must not be stalled in this way.
 /// </summary>
 //-----------------------------------------------------------------------------
 class CGE_API cgThreadPool
@@ -0,0 +1,127 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTraceProfiler.h                                                  //
+//                                                                           //
+// Desc : Low overhead hierarchical scope tracing. Each thread records       //
+//        completed scopes into its own ring buffer without locking, and     //
+//        captured data can be exported in the Chrome trace event format for //
+//        inspection in chrome://tracing or Perfetto.                        //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGTRACEPROFILER_H_ )
+#define _CGE_CGTRACEPROFILER_H_
+
+//-----------------------------------------------------------------------------
+// cgTraceProfiler Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBase.h>
+
+//-----------------------------------------------------------------------------
+// Global Macros
+//-----------------------------------------------------------------------------
+// Scope names must be string literals (or otherwise remain valid for the 
+// lifetime of the capture) since only the pointer is recorded. Use
+// 'cgTraceProfiler::registerScope()' to obtain a persistent name for
+// dynamically constructed strings.
+#if defined(CGE_TRACE_PROFILING)
+#define cgTraceScopeJoin2(a,b)  a##b
+#define cgTraceScopeJoin(a,b)   cgTraceScopeJoin2(a,b)
+#define cgTraceScope( name )    cgTraceScopeRecorder cgTraceScopeJoin(_traceScope,__LINE__)( name )
+#else
+#define cgTraceScope( name )
+#endif
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgTraceProfiler (Class)
+/// <summary>
+/// Static trace capture interface. Completed scopes are written into a fixed
+/// size ring buffer owned by the recording thread (the oldest data is 
+/// overwritten once full) and time stamped using the highest resolution 
+/// clock available. Only the pointer to each scope's name is recorded, so
+/// names serve directly as scope identifiers.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgTraceProfiler
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Static Functions
+    //-------------------------------------------------------------------------
+    static bool             initialize          ( cgUInt32 eventsPerThread = 0 );
+    static void             shutdown            ( );
+    static bool             isInitialized       ( );
+    static void             setCapturing        ( bool capture );
+    static void             clear               ( );
+    static void             setThreadName       ( const cgChar * name );
+    static const cgChar   * registerScope       ( const cgString & name );
+    static cgDouble         measureOverhead     ( cgUInt32 iterations );
+    static bool             exportChromeTrace   ( const cgString & fileName );
+
+    // Recording
+    static cgUInt64         getTimestamp        ( );
+    static cgUInt64         getTimestampFrequency( );
+    static void             recordScope         ( const cgChar * name, cgUInt64 start, cgUInt64 end );
+    static void             beginScope          ( const cgChar * name );
+    static void             endScope            ( );
+
+    //-------------------------------------------------------------------------
+    // Public Inline Static Functions
+    //-------------------------------------------------------------------------
+    inline static bool isCapturing( )
+    {
+        return mCapturing;
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Static Variables
+    //-------------------------------------------------------------------------
+    static volatile bool    mCapturing;         // Is trace data currently being recorded?
+};
+
+//-----------------------------------------------------------------------------
+//  Name : cgTraceScopeRecorder (Class)
+/// <summary>
+/// Records the lifetime of a C++ scope with the trace profiler. Generally 
+/// allocated via the 'cgTraceScope()' macro.
+/// </summary>
+//-----------------------------------------------------------------------------
+class cgTraceScopeRecorder
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+    inline cgTraceScopeRecorder( const cgChar * name ) :
+        mName( name ), mStart( cgTraceProfiler::isCapturing() ? cgTraceProfiler::getTimestamp() : 0 ) {}
+    
+    inline ~cgTraceScopeRecorder( )
+    {
+        if ( mStart )
+            cgTraceProfiler::recordScope( mName, mStart, cgTraceProfiler::getTimestamp() );
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Variables
+    //-------------------------------------------------------------------------
+    const cgChar  * mName;      // Name of the scope being recorded.
+    cgUInt64        mStart;     // Time stamp at which the scope was entered (0 if not capturing).
+};
+
+#endif // !_CGE_CGTRACEPROFILER_H_
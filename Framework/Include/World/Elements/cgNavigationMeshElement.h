@@ -89,6 +89,8 @@ public:
     void                        setParameters               ( const cgNavigationMeshCreateParams & params, bool rebuild = false );
     void                        setSandboxRenderMethod      ( SandboxRenderMethod method );
     bool                        buildMesh                   ( );
+    void                        invalidateRegion            ( const cgBoundingBox & region );
+    bool                        rebuildInvalidRegion        ( );
     cgNavigationAgent         * createAgent                 ( const cgNavigationAgentCreateParams & params, const cgVector3 & position );
     const cgNavigationMeshCreateParams& getParameters       ( ) const;
     cgNavigationHandler       * getNavigationHandler        ( ) const;
@@ -129,6 +131,7 @@ protected:
     //-------------------------------------------------------------------------
     void                        prepareQueries              ( );
     bool                        insertComponentData         ( );
+    void                        collectGeometry             ( cgArray<cgMeshHandle> & meshes, cgArray<cgTransform> & transforms );
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -136,6 +139,7 @@ protected:
     SandboxRenderMethod             mSandboxRenderMethod;   // Method used to render when in sandbox mode.
     cgNavigationMesh              * mNavMesh;               // Constructed navigation mesh
     cgNavigationHandler           * mHandler;               // Navigation handler associated with this mesh. Performs agent updates as required.
+    cgBoundingBox                   mInvalidRegion;         // World space region in which static geometry has changed since the last rebuild (unpopulated if none).
     
     //-------------------------------------------------------------------------
     // Protected Static Variables
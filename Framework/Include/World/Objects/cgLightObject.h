@@ -293,6 +293,9 @@ public:
     
     }; // End Struct LightingOpPass
 
+    /// List of shadow generators owned by a light source.
+    CGE_ARRAY_DECLARE( cgShadowGenerator*, ShadowGeneratorArray )
+
     //-------------------------------------------------------------------------
     // Constructors & Destructors
     //-------------------------------------------------------------------------
@@ -321,6 +324,7 @@ public:
     virtual void                    renderShape                 ( cgCameraNode * camera, cgUInt32 subsetId = 0, cgMesh * meshOverride = CG_NULL ); 
 
     virtual void                    computeShadowSets           ( cgCameraNode * camera );
+    virtual void                    collectShadowGenerators     ( ShadowGeneratorArray & generators );
     virtual void                    setRenderOptimizations      ( bool stencilMask = true, bool userClipPlanes = true, bool scissorRect = true );
 
     // Direct lighting
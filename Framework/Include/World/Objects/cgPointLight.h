@@ -188,6 +188,7 @@ public:
     virtual bool                    testObjectShadowVolume  ( cgObjectNode * object, const cgFrustum & viewFrustum );
     
     virtual void                    computeShadowSets       ( cgCameraNode * camera );
+    virtual void                    collectShadowGenerators ( ShadowGeneratorArray & generators );
     virtual void                    computeLevelOfDetail    ( cgCameraNode * camera );
 
     // Direct lighting
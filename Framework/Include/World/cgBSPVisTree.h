@@ -89,6 +89,7 @@ public:
     CGE_ARRAY_DECLARE( cgBSPTreeSubNode, NodeArray );
     CGE_ARRAY_DECLARE( cgVector3, PointArray );
     CGE_ARRAY_DECLARE( Portal, PortalArray );
+    typedef void (*PVSProgressFunc)( cgBSPTree * tree, cgUInt32 portalsProcessed, cgUInt32 portalCount, void * context );
 
     //-------------------------------------------------------------------------
     // Constructors & Destructors
@@ -110,6 +111,8 @@ public:
     const PlaneArray  & getNodePlanes           ( ) const;
     const PortalArray & getPortals              ( ) const;
     const PointArray  & getPortalVertices       ( ) const;
+    void                setPVSProgressCallback  ( PVSProgressFunc callback, void * context );
+    void                cancelPVS               ( );
 
     //-------------------------------------------------------------------------
     // Public Virtual Methods (Overrides DisposableScriptObject)
@@ -137,6 +140,7 @@ protected:
     //-------------------------------------------------------------------------
     static const cgUInt32 LeafNodeBit   = 0x80000000;
     static const cgUInt32 LeafIndexMask = 0x7FFFFFFF;
+    static const cgUInt32 PVSBatchSize  = 64;
 
     //-------------------------------------------------------------------------
     // Protected Enumerations, Structures & Typedefs
@@ -158,19 +162,20 @@ protected:
     {
         // Constructor
         PVSPortalPoints() :
-            vertices(CG_NULL), ownerPortal(CG_NULL), vertexCount(0), ownsVertices(false) {}
+            vertices(CG_NULL), ownerPortal(CG_NULL), vertexCount(0), vertexCapacity(0), ownsVertices(false) {}
 
         // Destructor
         ~PVSPortalPoints()
         {
             if ( ownsVertices )
-                delete vertices;
+                delete []vertices;
         }
 
         // Members
         bool            ownsVertices;
         cgVector3     * vertices;
         cgUInt32        vertexCount;
+        cgUInt32        vertexCapacity;
         PVSPortal     * ownerPortal;
     };
     struct PVSPortal
@@ -211,6 +216,37 @@ protected:
         cgPlane             targetPlane;
     };
     CGE_ARRAY_DECLARE( PVSPortal, PVSPortalArray );
+    CGE_ARRAY_DECLARE( PVSPortalPoints*, PVSPortalPointsArray );
+    struct PVSScratch
+    {
+        // Constructor & Destructor
+        PVSScratch() {}
+        ~PVSScratch()
+        {
+            for ( size_t i = 0; i < freePoints.size(); ++i )
+                delete freePoints[i];
+        }
+
+        // Members
+        cgArray<cgPlaneQuery::Class>    pointLocation;  // Per-vertex classification used during clipping.
+        PointArray                      frontVerts;     // Clipped vertex staging buffer.
+        cgByteArray                     portalVis;      // Portal flags used by the initial portal flood.
+        PVSPortalPointsArray            freePoints;     // Recycled point sets available for reuse.
+
+    private:
+        // Owns the point sets in 'freePoints', so must not be copied.
+        PVSScratch( const PVSScratch & );
+        PVSScratch & operator=( const PVSScratch & );
+    };
+    CGE_ARRAY_DECLARE( PVSScratch*, PVSScratchArray );
+    struct PVSBatchData
+    {
+        cgBSPTree         * tree;
+        PVSPortalArray    * portals;
+        PVSScratchArray   * scratch;
+        const cgUInt32    * order;
+        cgUInt32            first;
+    };
     
     //-------------------------------------------------------------------------
     // Protected Methods
@@ -225,13 +261,14 @@ protected:
     Portal            * generatePortal          ( cgUInt32 nodeIndex, const cgBoundingBox & bounds );
     Portal            * clipPortal              ( cgUInt32 nodeIndex, Portal * portal, LeafOwner ownerNodeSide );
     void                generatePVSPortals      ( PVSPortalArray & portals );
-    void                initialPortalVis        ( PVSPortalArray & portals );
+    bool                initialPortalVis        ( PVSPortalArray & portals, PVSScratchArray & scratch );
+    void                initialPortalVis        ( PVSPortalArray & portals, cgUInt32 portalIndex, PVSScratch & scratch );
     void                portalFlood             ( PVSPortalArray & portals, PVSPortal & sourcePortal, cgByte * portalVis, cgUInt32 leafIndex );
-    void                calculatePortalVis      ( PVSPortalArray & portals );
-    cgUInt32            getNextPVSPortal        ( PVSPortalArray & portals );
-    void                recursePVS              ( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPortal & sourcePortal, PVSData & prevData );
-    PVSPortalPoints   * clipPVSPortalPoints     ( PVSPortalPoints * points, const cgPlane & plane, bool keepOnPlane );
-    PVSPortalPoints   * clipToAntiPenumbra      ( PVSPortalPoints * source, PVSPortalPoints * target, PVSPortalPoints * generator, bool reverseClip );
+    bool                calculatePortalVis      ( PVSPortalArray & portals, PVSScratchArray & scratch );
+    void                calculatePortalVis      ( PVSPortalArray & portals, cgUInt32 portalIndex, PVSScratch & scratch );
+    void                recursePVS              ( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPortal & sourcePortal, PVSData & prevData, PVSScratch & scratch );
+    PVSPortalPoints   * clipPVSPortalPoints     ( PVSPortalPoints * points, const cgPlane & plane, bool keepOnPlane, PVSScratch & scratch );
+    PVSPortalPoints   * clipToAntiPenumbra      ( PVSPortalPoints * source, PVSPortalPoints * target, PVSPortalPoints * generator, bool reverseClip, PVSScratch & scratch );
     cgUInt32            compressLeafSet         ( cgByte masterPVS[], const cgByte visArray[], cgUInt32 writePos );
     cgUInt32            findLeaf                ( cgUInt32 nodeIndex, const cgVector3 & point );
     void                findLeaves              ( cgUInt32 nodeIndex, cgUInt32 * leaves, cgUInt32 & leafCount, const cgBoundingSphere & sphere, cgByte * sourceVis );
@@ -248,7 +285,10 @@ protected:
     //-------------------------------------------------------------------------
     // Protected Static Functions
     //-------------------------------------------------------------------------
-    void                releasePVSPortalPoints  ( PVSPortalPoints * points );
+    static PVSPortalPoints * allocatePVSPortalPoints( PVSScratch & scratch, cgUInt32 vertexCount );
+    static void         releasePVSPortalPoints  ( PVSPortalPoints * points, PVSScratch & scratch );
+    static void         initialPortalVisRange   ( cgUInt32 first, cgUInt32 last, void * context );
+    static void         calculatePortalVisRange ( cgUInt32 first, cgUInt32 last, void * context );
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -271,6 +311,11 @@ protected:
     cgUInt32            mSplitterSample;
     cgFloat             mSplitHeuristic;
 
+    // PVS compilation
+    PVSProgressFunc     mPVSProgress;
+    void              * mPVSProgressContext;
+    volatile bool       mPVSCancelled;
+
 }; // End Class cgBSPTree
 
 //---------------------------------------------------------------------------------
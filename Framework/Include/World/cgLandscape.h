@@ -27,6 +27,7 @@
 #include <World/cgLandscapeTypes.h>
 #include <World/cgWorldQuery.h>
 #include <World/cgSpatialTree.h>
+#include <World/cgLandscapeHeightPyramid.h>
 #include <World/cgWorldComponent.h>
 #include <Resources/cgResourceHandles.h>
 #include <Math/cgLeastSquares.h>
@@ -46,6 +47,9 @@ class cgLandscapeSubNode;
 class cgVertexFormat;
 class cgRigidBody;
 class cgClutterCell;
+class cgThread;
+class cgCriticalSection;
+class cgEvent;
 
 //-----------------------------------------------------------------------------
 // Main Class Declarations
@@ -206,6 +210,12 @@ public:
              cgLandscape( cgScene * scene );
     virtual ~cgLandscape( );
     
+    //-------------------------------------------------------------------------
+    // Public Static Functions
+    //-------------------------------------------------------------------------
+    static void                     setDefaultStreamingConfig( const cgLandscapeStreamingConfig & config );
+    static const cgLandscapeStreamingConfig & getDefaultStreamingConfig( );
+
     //-------------------------------------------------------------------------
     // Public Methods
     //-------------------------------------------------------------------------
@@ -226,6 +236,9 @@ public:
     cgVector3                       getHeightMapNormal      ( cgInt32 x, cgInt32 z ) const;
     bool                            getRayIntersect         ( const cgVector3 & origin, const cgVector3 & velocity, cgFloat & t ) const;
     bool                            getRayIntersect         ( const cgVector3 & origin, const cgVector3 & velocity, cgFloat & t, cgFloat accuracy ) const;
+    bool                            getRayIntersect         ( const cgVector3 & origin, const cgVector3 & velocity, cgLandscapeRayHit & hit ) const;
+    void                            getRayIntersects        ( cgLandscapeRayQuery queries[], cgUInt32 queryCount ) const;
+    cgFloat                         getPlaceholderHeight    ( cgFloat x, cgFloat z ) const;
     const cgBoundingBox           & getBoundingBox          ( ) const;
     bool                            getTerrainBlocks        ( const cgBoundingBox & bounds, TerrainBlockArray & blocksOut ) const;
 
@@ -242,6 +255,14 @@ public:
     void                            updatePaintPreview      ( );
     bool                            getBlendMapPaintData    ( const cgRect & sourceBounds, cgByteArray & data ) const;
 
+    // Block streaming
+    void                            setStreamingConfig      ( const cgLandscapeStreamingConfig & config );
+    const cgLandscapeStreamingConfig & getStreamingConfig   ( ) const;
+    bool                            isStreaming             ( ) const;
+    void                            updateStreaming         ( const cgVector3 & focus );
+    cgLandscapeStreamingStats       getStreamingStats       ( ) const;
+    bool                            hasBlockStandIn         ( cgInt32 blockIndex ) const;
+
     // Properties
     void                            setTerrainDetail        ( cgFloat value );
     const cgInt32Array            & getMipLookUp            ( ) const;
@@ -332,12 +353,79 @@ protected:
     //-------------------------------------------------------------------------
     CGE_ARRAY_DECLARE( ProceduralDrawBatch, ProceduralDrawBatchArray )
     CGE_ARRAY_DECLARE( CullDescriptor, CullDescriptorArray )
+
+    //-------------------------------------------------------------------------
+    // Protected Enumerations
+    //-------------------------------------------------------------------------
+    /// <summary>Residency state of an individual terrain block when streaming.</summary>
+    enum BlockStreamState
+    {
+        /// <summary>Block is not resident (placeholder heights only).</summary>
+        StreamNotResident = 0,
+        /// <summary>Block has been queued for background loading.</summary>
+        StreamPending,
+        /// <summary>Block is fully resident.</summary>
+        StreamResident,
+        /// <summary>Block could not be loaded and will not be requested again.</summary>
+        StreamFailed
+    };
+
+    //-------------------------------------------------------------------------
+    // Protected Structures (Streaming)
+    //-------------------------------------------------------------------------
+    /// <summary>Streaming information maintained for every block in the layout.</summary>
+    struct BlockStreamInfo
+    {
+        /// <summary>Identifier of the block as it exists in the database (0 if there is no block here).</summary>
+        cgUInt32                        blockId;
+        /// <summary>Current residency state of the block.</summary>
+        BlockStreamState                state;
+        /// <summary>Time at which the block was requested.</summary>
+        cgDouble                        requestTime;
+        /// <summary>Spatial tree leaf nodes that fall into this block.</summary>
+        cgArray<cgLandscapeSubNode*>    leafNodes;
+        /// <summary>Coarse (lowest LOD) mesh drawn in place of the block while it is not resident.</summary>
+        cgVertexBufferHandle            standIn;
+    };
+
+    /// <summary>Block load request passed to the streaming thread.</summary>
+    struct BlockStreamRequest
+    {
+        cgInt32                         blockIndex;
+        cgUInt32                        blockId;
+    };
+
+    /// <summary>Block data read from the database by the streaming thread.</summary>
+    struct StreamedBlockData
+    {
+        cgInt32                         blockIndex;
+        cgUInt32                        blockId;
+        bool                            success;
+        cgInt16Array                    heights;
+        cgUInt32Array                   colors;
+        cgFloatArray                    variance;
+    };
+    CGE_ARRAY_DECLARE( BlockStreamInfo, BlockStreamInfoArray )
+    CGE_DEQUE_DECLARE( BlockStreamRequest, BlockStreamRequestQueue )
+    CGE_LIST_DECLARE( StreamedBlockData*, StreamedBlockList )
     
     //-------------------------------------------------------------------------
     // Protected Methods
     //-------------------------------------------------------------------------
     void                        prepareQueries          ( );
     bool                        postInit                ( );
+    void                        buildHeightPyramid      ( );
+    bool                        beginStreaming          ( );
+    void                        endStreaming            ( );
+    bool                        fetchBlockData          ( StreamedBlockData & data );
+    bool                        makeBlockResident       ( const StreamedBlockData & data );
+    void                        evictBlock              ( cgInt32 blockIndex );
+    void                        linkBlockNeighbors      ( cgInt32 blockIndex, bool unlink );
+    void                        refreshBlockBorders     ( cgInt32 blockIndex );
+    cgFloat                     getBlockDistance        ( cgInt32 blockIndex, const cgVector3 & point ) const;
+    cgTerrainBlock            * createBlock             ( cgInt32 blockIndex );
+    bool                        buildBlockStandIn       ( cgInt32 blockIndex );
+    void                        drawBlockStandIn        ( cgRenderDriver * driver, cgInt32 blockIndex );
     bool                        buildMipLookUp          ( );
     bool                        buildLODLevel           ( cgUInt32 mipLevel );
     bool                        updateNormalTexture     ( );
@@ -379,6 +467,8 @@ protected:
     cgVector3                       mScale;
     /// <summary>Locally stored copy of the heightmap (if applicable).</summary>
     cgHeightMap                   * mHeightMap;
+    /// <summary>Min / max height pyramid built over the heightmap for exact ray intersection.</summary>
+    cgLandscapeHeightPyramid        mHeightPyramid;
     /// <summary>Locally stored copy of the color map data (if applicable).</summary>
     cgUInt32Array                   mColorMap;
     /// <summary>Flags from the LandscapeFlags enum specified during load.</summary>
@@ -456,6 +546,30 @@ protected:
     /// <summary>Is occlusion culling currently enabled?</summary>
     bool                            mOcclusionCull;
 
+    // Block Streaming
+    /// <summary>Current block streaming configuration.</summary>
+    cgLandscapeStreamingConfig      mStreamingConfig;
+    /// <summary>Cumulative block streaming telemetry.</summary>
+    cgLandscapeStreamingStats       mStreamingStats;
+    /// <summary>Streaming information for each block in the layout.</summary>
+    BlockStreamInfoArray            mBlockStreamInfo;
+    /// <summary>Background thread responsible for reading block data from the world database.</summary>
+    cgThread                      * mStreamThread;
+    /// <summary>Protects the request and result queues shared with the streaming thread.</summary>
+    cgCriticalSection             * mStreamSection;
+    /// <summary>Signalled in order to wake the streaming thread when new requests are queued.</summary>
+    cgEvent                       * mStreamEvent;
+    /// <summary>Blocks waiting to be read by the streaming thread (nearest first).</summary>
+    BlockStreamRequestQueue         mStreamRequests;
+    /// <summary>Block data read by the streaming thread, waiting to be made resident.</summary>
+    StreamedBlockList               mStreamResults;
+    /// <summary>Number of blocks currently in the 'StreamPending' state.</summary>
+    cgUInt32                        mStreamPendingCount;
+    /// <summary>Block data query used exclusively by the streaming thread.</summary>
+    cgWorldQuery                    mStreamBlockData;
+    /// <summary>Block LOD query used exclusively by the streaming thread.</summary>
+    cgWorldQuery                    mStreamBlockLODs;
+
     // States
     /// <summary>Depth stencil states for terrain depth fill pass.</summary>
     cgDepthStencilStateHandle       mDepthFillDepthState;
@@ -501,8 +615,17 @@ protected:
     static cgWorldQuery     mUpdateProceduralLayer;
     static cgWorldQuery     mLoadLandscape;
     static cgWorldQuery     mLoadTerrainBlocks;
+    static cgWorldQuery     mLoadTerrainBlockIds;
     static cgWorldQuery     mLoadProceduralLayers;
 
+    // Streaming configuration applied to newly constructed landscapes.
+    static cgLandscapeStreamingConfig mDefaultStreamingConfig;
+
+    //-------------------------------------------------------------------------
+    // Protected Static Functions
+    //-------------------------------------------------------------------------
+    static cgUInt32         streamBlocksThread      ( cgThread * thread, void * context );
+
 }; // End Class cgLandscape
 
 //-----------------------------------------------------------------------------
@@ -607,6 +730,19 @@ public:
         cgInt pitchX, pitchY;
     };
 
+    /// <summary>Block data that has already been retrieved from the database.</summary>
+    struct CGE_API BlockData
+    {
+        /// <summary>Identifier of the block as it exists within the database.</summary>
+        cgUInt32            blockId;
+        /// <summary>Height data for the managed area of the block (including border).</summary>
+        const cgInt16     * heightData;
+        /// <summary>Color data for the managed area of the block (or CG_NULL if none).</summary>
+        const cgUInt32    * colorData;
+        /// <summary>Pre-loaded LOD variance values (or CG_NULL to retrieve them from the database).</summary>
+        const cgFloat     * lodVariance;
+    };
+
     /// <summary>Stores information about the piece of terrain to load / manage.</summary>
     // ToDo: 9999 - Even necessary any more now we're using the database?
     struct CGE_API TerrainSection
@@ -630,6 +766,7 @@ public:
     //-------------------------------------------------------------------------
     bool                    importBlock             ( );
     bool                    loadBlock               ( cgWorldQuery & blockQuery );
+    bool                    loadBlock               ( const BlockData & data );
     bool                    dataUpdated             ( );
     void                    calculateLOD            ( cgCameraNode * camera );
     void                    calculateLOD            ( cgCameraNode * camera, cgFloat terrainDetail );
@@ -653,6 +790,7 @@ public:
     bool                    isVisible               ( ) const;
     cgTerrainBlock*         getNeighbor             ( EdgeSide side ) const;
     cgLandscapeTextureData* getTextureData          ( ) const;
+    size_t                  getMemoryUsage          ( ) const;
     void                    setCurrentLOD           ( cgInt32 level );
     void                    setNeighbor             ( EdgeSide side, cgTerrainBlock * block );
     void                    setVisible              ( bool visible );
@@ -667,6 +805,7 @@ protected:
     void            calculateLODVariance    ( );
     void            buildPhysicsBody        ( );
     cgUInt32        getHeightMapIndex       ( cgInt32 x, cgInt32 z ) const;
+    bool            isStandInNeighbor       ( EdgeSide side ) const;
 
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -881,6 +1020,7 @@ public:
     // Properties
     bool                        isPainting          ( ) const;
     bool                        isEmpty             ( ) const;
+    size_t                      getMemoryUsage      ( ) const;
     const cgByteArray         & getPaintData        ( ) const;
     cgRectF                     getBlendMapWorldArea( ) const;
     cgRect                      getBlendMapArea     ( ) const;
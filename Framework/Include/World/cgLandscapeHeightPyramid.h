@@ -0,0 +1,160 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgLandscapeHeightPyramid.h                                         //
+//                                                                           //
+// Desc : Hierarchical min / max height pyramid built over a landscape       //
+//        heightmap, used to compute exact ray / terrain intersections.      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGLANDSCAPEHEIGHTPYRAMID_H_ )
+#define _CGE_CGLANDSCAPEHEIGHTPYRAMID_H_
+
+//-----------------------------------------------------------------------------
+// cgLandscapeHeightPyramid Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBaseTypes.h>
+#include <Math/cgMathTypes.h>
+
+//-----------------------------------------------------------------------------
+// Global Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgLandscapeRayHit (Struct)
+/// <summary>
+/// Describes the exact terrain triangle struck by a ray cast against a
+/// cgLandscapeHeightPyramid.
+/// </summary>
+//-----------------------------------------------------------------------------
+struct CGE_API cgLandscapeRayHit
+{
+    cgFloat     t;          // Distance along the ray, as a multiple of its velocity.
+    cgInt32     cellX;      // Heightmap column of the quad that was struck.
+    cgInt32     cellZ;      // Heightmap row of the quad that was struck.
+    cgInt32     triangle;   // Triangle within the quad (0 = top right half, 1 = bottom left half).
+    cgVector3   normal;     // World space normal of the triangle that was struck.
+};
+
+//-----------------------------------------------------------------------------
+//  Name : cgLandscapeRayQuery (Struct)
+/// <summary>
+/// Describes a single ray to be intersected as part of a batch via
+/// cgLandscapeHeightPyramid::intersectBatch().
+/// </summary>
+//-----------------------------------------------------------------------------
+struct CGE_API cgLandscapeRayQuery
+{
+    cgVector3           origin;     // Origin of the ray.
+    cgVector3           velocity;   // Direction and length of the ray.
+    bool                intersected;// Output: did the ray strike the terrain?
+    cgLandscapeRayHit   hit;        // Output: details of the closest intersection.
+
+    // Constructor
+    cgLandscapeRayQuery() :
+        origin( 0, 0, 0 ), velocity( 0, 0, 0 ), intersected( false ) {}
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgLandscapeHeightPyramid (Class)
+/// <summary>
+/// Stores the minimum and maximum height of successively larger square 
+/// regions of a heightmap (2x2 quads at the finest level, doubling at each 
+/// level above). Rays are intersected by descending the pyramid, only visiting
+/// regions whose height range the ray actually passes through, before testing
+/// the two triangles of each remaining quad exactly. Quads belonging to terrain
+/// blocks that do not exist are excluded. The heightmap referenced during 
+/// 'build()' must remain valid while the pyramid is in use.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgLandscapeHeightPyramid
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+     cgLandscapeHeightPyramid( );
+    ~cgLandscapeHeightPyramid( );
+
+    //-------------------------------------------------------------------------
+    // Public Methods
+    //-------------------------------------------------------------------------
+    void                build               ( const cgInt16 * heights, const cgSize & mapSize, const cgSize & blockSize, const cgByteArray & blockMask );
+    void                update              ( const cgRect & bounds );
+    void                clear               ( );
+    bool                isEmpty             ( ) const;
+    void                setTransform        ( const cgVector3 & offset, const cgVector3 & scale );
+    bool                intersect           ( const cgVector3 & origin, const cgVector3 & velocity, cgFloat & t ) const;
+    bool                intersect           ( const cgVector3 & origin, const cgVector3 & velocity, cgLandscapeRayHit & hit ) const;
+    void                intersectBatch      ( cgLandscapeRayQuery queries[], cgUInt32 queryCount ) const;
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Structures
+    //-------------------------------------------------------------------------
+    struct Range
+    {
+        cgInt16     minimum;
+        cgInt16     maximum;
+    };
+    CGE_ARRAY_DECLARE(Range, RangeArray)
+
+    struct Level
+    {
+        cgInt32     width;      // Number of regions in this level along the heightmap X axis.
+        cgInt32     height;     // Number of regions in this level along the heightmap Z axis.
+        RangeArray  ranges;     // Height range of each region.
+    };
+    CGE_VECTOR_DECLARE(Level, LevelArray)
+
+    // Ray transformed into heightmap grid space (X and Z in quads, Y in world units).
+    struct GridRay
+    {
+        cgFloat     origin[3];
+        cgFloat     direction[3];
+        cgFloat     invDirection[3];
+    };
+
+    //-------------------------------------------------------------------------
+    // Protected Methods
+    //-------------------------------------------------------------------------
+    bool                isCellPresent       ( cgInt32 x, cgInt32 z ) const;
+    Range               getCellRange        ( cgInt32 x, cgInt32 z ) const;
+    void                updateLevel         ( size_t level, cgInt32 minX, cgInt32 minZ, cgInt32 maxX, cgInt32 maxZ );
+    bool                intersectRange      ( const GridRay & ray, const Range & range, cgInt32 minX, cgInt32 minZ, cgInt32 maxX, cgInt32 maxZ, cgFloat maximumT ) const;
+    bool                intersectCell       ( const GridRay & ray, cgInt32 x, cgInt32 z, cgFloat & t, cgInt32 & triangle ) const;
+    cgFloat             getWorldHeight      ( cgInt32 x, cgInt32 z ) const;
+
+    //-------------------------------------------------------------------------
+    // Protected Static Functions
+    //-------------------------------------------------------------------------
+    static void         executeQueries      ( cgUInt32 first, cgUInt32 last, void * context );
+
+    //-------------------------------------------------------------------------
+    // Protected Variables
+    //-------------------------------------------------------------------------
+    const cgInt16     * mHeights;           // The referenced heightmap data.
+    cgSize              mMapSize;           // Dimensions of the heightmap (in vertices).
+    cgSize              mCellCount;         // Number of quads along each axis of the heightmap.
+    cgSize              mBlockCells;        // Number of quads along each axis of a terrain block.
+    cgSize              mBlockLayout;       // Number of terrain blocks along each axis.
+    cgByteArray         mBlockMask;         // Non-zero for each terrain block that exists.
+    LevelArray          mLevels;            // Pyramid levels, finest (2x2 quads) first.
+    cgVector3           mOffset;            // World space offset of the heightmap origin.
+    cgVector3           mScale;             // World space scale of each heightmap quad / height unit.
+};
+
+#endif // !_CGE_CGLANDSCAPEHEIGHTPYRAMID_H_
@@ -111,4 +111,55 @@ struct cgLandscapePaintParams
 
 }; // End Struct : cgLandscapePaintParams
 
+struct cgLandscapeStreamingConfig
+{
+    /// <summary>When enabled, terrain blocks are loaded and evicted on a background thread based on their distance from the streaming focus (usually the active camera). Not available in sandbox mode.</summary>
+    bool                    enabled;
+    /// <summary>Blocks whose (XZ) bounds fall within this distance of the focus point will be made resident.</summary>
+    cgFloat                 residentRadius;
+    /// <summary>Resident blocks whose (XZ) bounds fall further than this distance from the focus point will be evicted. Should be larger than the resident radius to prevent thrashing, and larger than the range over which physics simulation must take place.</summary>
+    cgFloat                 evictRadius;
+    /// <summary>Maximum number of block load requests that can be outstanding on the background thread at any one time.</summary>
+    cgUInt32                maximumPendingLoads;
+    /// <summary>Maximum number of streamed blocks that will be made resident (vertex buffers, physics bodies, textures built) during a single update.</summary>
+    cgUInt32                maximumLoadsPerUpdate;
+
+    // Constructor
+    cgLandscapeStreamingConfig() :
+        enabled( false ), residentRadius( 1500.0f ), evictRadius( 2000.0f ), 
+        maximumPendingLoads( 8 ), maximumLoadsPerUpdate( 2 ) {}
+
+}; // End Struct : cgLandscapeStreamingConfig
+
+struct cgLandscapeStreamingStats
+{
+    /// <summary>Total number of terrain blocks that exist within the landscape.</summary>
+    cgUInt32                totalBlocks;
+    /// <summary>Number of blocks that are currently resident.</summary>
+    cgUInt32                residentBlocks;
+    /// <summary>Number of blocks currently queued for, or undergoing, background loading.</summary>
+    cgUInt32                pendingBlocks;
+    /// <summary>Approximate memory (in bytes) consumed by the vertex and texture data of all resident blocks.</summary>
+    size_t                  residentMemory;
+    /// <summary>Total number of blocks streamed in since the landscape was loaded.</summary>
+    cgUInt32                blocksLoaded;
+    /// <summary>Total number of blocks evicted since the landscape was loaded.</summary>
+    cgUInt32                blocksEvicted;
+    /// <summary>Total number of blocks that could not be streamed in.</summary>
+    cgUInt32                loadFailures;
+    /// <summary>Time (in seconds) between the most recently streamed block being requested and becoming resident.</summary>
+    cgDouble                lastLatency;
+    /// <summary>Average time (in seconds) between a block being requested and becoming resident.</summary>
+    cgDouble                averageLatency;
+    /// <summary>Longest time (in seconds) between a block being requested and becoming resident.</summary>
+    cgDouble                maximumLatency;
+
+    // Constructor
+    cgLandscapeStreamingStats() :
+        totalBlocks( 0 ), residentBlocks( 0 ), pendingBlocks( 0 ), residentMemory( 0 ),
+        blocksLoaded( 0 ), blocksEvicted( 0 ), loadFailures( 0 ),
+        lastLatency( 0 ), averageLatency( 0 ), maximumLatency( 0 ) {}
+
+}; // End Struct : cgLandscapeStreamingStats
+
 #endif // !_CGE_CGLANDSCAPETYPES_H_
\ No newline at end of file
@@ -139,6 +139,8 @@ protected:
     struct CGE_API MethodHandles
     {
         // Public methods
+        cgScriptFunctionHandle  onAttach;
+        cgScriptFunctionHandle  onDetach;
         cgScriptFunctionHandle  onPrePhysicsStep;
         cgScriptFunctionHandle  onPostPhysicsStep;
         cgScriptFunctionHandle  onUpdate;
@@ -157,7 +159,7 @@ protected:
 
         // Constructor
         MethodHandles() :
-            onPrePhysicsStep(CG_NULL), onPostPhysicsStep(CG_NULL), onUpdate(CG_NULL), onMouseMove(CG_NULL),
+            onAttach(CG_NULL), onDetach(CG_NULL), onPrePhysicsStep(CG_NULL), onPostPhysicsStep(CG_NULL), onUpdate(CG_NULL), onMouseMove(CG_NULL),
             onMouseButtonDown(CG_NULL), onMouseButtonUp(CG_NULL), onMouseWheelScroll(CG_NULL), onKeyDown(CG_NULL),
             onKeyUp(CG_NULL), onKeyPressed(CG_NULL), onCollisionBegin(CG_NULL), onCollisionContinue(CG_NULL),
             onCollisionEnd(CG_NULL), hasInputEvents(false), hasPhysicsEvents(false) {}
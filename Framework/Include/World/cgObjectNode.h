@@ -142,6 +142,7 @@ public:
     const cgString                & getObjectClass          ( ) const;
     const cgString                & getRenderClass          ( ) const;
     cgUInt32                        getRenderClassId        ( ) const;
+    cgUInt32                        getVisibilityIndex      ( ) const;
     cgWorldObject                 * getReferencedObject     ( ) const;
     cgPropertyContainer           & getCustomProperties     ( );
     const cgPropertyContainer     & getCustomProperties     ( ) const;
@@ -193,6 +194,10 @@ public:
     bool                            hasPendingUpdates       ( ) const;
     cgUInt32                        getPendingUpdates       ( ) const;
     cgUInt32                        getLastDirtyFrame       ( ) const;
+    void                            enableBatchTransforms   ( bool enable );
+    bool                            isBatchTransformsEnabled( ) const;
+    void                            setUpdateThreadSafe     ( bool threadSafe );
+    bool                            isUpdateThreadSafe      ( ) const;
 
     // Relationship Management
     cgObjectNode                  * getParent               ( ) const;
@@ -467,6 +472,9 @@ protected:
     bool                        shouldSerialize                 ( ) const;
     bool                        serializeUpdateRate             ( );
     bool                        serializeFlags                  ( );
+    bool                        resolveBatchTransforms          ( );
+    bool                        isBatchTransformCompatible      ( ) const;
+    void                        propagateNodeUpdates            ( cgUInt32 deferredUpdates, cgUInt32 childDeferredUpdates );
     
     //-------------------------------------------------------------------------
     // Protected Virtual Methods
@@ -498,6 +506,11 @@ protected:
     cgUInt32                    mLastDirtyFrame;            // The most recent frame on which this node was updated (moved, animated etc.)
     cgUInt32                    mPendingUpdates;            // Describes pending updates such as child hierarchy transformation adjustments.
     cgObjectNode             ** mPendingUpdateFIFO;         // This node's position in the main scene's pending update FIFO buffer.
+    bool                        mBatchTransforms;           // Resolve pending child hierarchy transforms in a single batched pass?
+    bool                        mUpdateThreadSafe;          // Node has declared that its 'update()' method may be called from any thread.
+    cgUInt32                    mParallelUpdateStamp;       // Stamp of the most recent parallel update batch in which this node was updated.
+    cgUInt32                    mUpdateBucketSlot;          // Index of this node within the scene's update bucket for its selected update rate.
+    cgUInt32                    mVisibilityIndex;           // Stable, densely allocated index used by visibility sets to record membership of this node.
     
     // Relationship Management
     cgObjectNodeList            mChildren;                  // List of attached child nodes in the relationship hierarchy.
@@ -597,6 +610,8 @@ private:
     // Private Static Variables
     //-------------------------------------------------------------------------
     static InputChannelLUT  mRegisteredInputChannels;  // Look up table that allows us to retrieve the handle for a registered input channel.                  
+    static cgUInt32Array    mFreeVisibilityIndices;    // Visibility indices released by destroyed nodes, ready to be reused.
+    static cgUInt32         mNextVisibilityIndex;      // The next visibility index to issue when none are available for reuse.
 };
 
 #endif // !_CGE_CGOBJECTNODE_H_
\ No newline at end of file
@@ -58,6 +58,9 @@ class cgLandscape;
 struct cgLandscapeImportParams;
 class cgSphereTree;
 class cgBSPTree;
+class cgCriticalSection;
+class cgSceneSpatialHash;
+struct cgSpatialQuery;
 
 //-----------------------------------------------------------------------------
 // Globally Unique Type Id(s)
@@ -431,6 +434,10 @@ public:
     void                        queueNodeUpdates            ( cgObjectNode * node );
     void                        resolvedNodeUpdates         ( cgObjectNode * node );
     void                        resolvePendingUpdates       ( );
+    void                        enableParallelUpdates       ( bool enabled );
+    bool                        isParallelUpdatesEnabled    ( ) const;
+    bool                        isParallelUpdating          ( ) const;
+    void                        deferNodeUpdates            ( cgObjectNode * node, cgUInt32 deferredUpdates, cgUInt32 childDeferredUpdates );
 
     // Scene Dynamics
     void                        enableDynamics              ( bool enabled );
@@ -458,6 +465,9 @@ public:
     const cgObjectNodeArray   & getObjectNodesByType        ( const cgUID & type ) const;
     void                        getObjectNodesInBounds      ( const cgVector3 & center, cgFloat radius, cgObjectNodeArray & nodesOut ) const;
     void                        getObjectNodesInBounds      ( const cgBoundingBox&, cgObjectNodeArray & nodesOut ) const;
+    void                        getObjectNodesInFrustum     ( const cgFrustum & frustum, cgObjectNodeArray & nodesOut ) const;
+    void                        getNearestObjectNodes       ( const cgVector3 & center, cgUInt32 count, cgFloat maximumDistance, cgObjectNodeArray & nodesOut ) const;
+    void                        queryObjectNodes            ( cgSpatialQuery queries[], cgUInt32 queryCount ) const;
     void                        setObjectUpdateRate         ( cgObjectNode * node, cgUpdateRate::Base rate );
     void                        addController               ( cgSceneController * controller );
     bool                        setActiveCamera             ( cgCameraNode * camera );
@@ -470,6 +480,7 @@ public:
     const cgVector3           & getCellSize                 ( ) const;
     void                        updateObjectOwnership       ( cgObjectNode * node );
     void                        computeVisibility           ( const cgFrustum & frustum, cgVisibilitySet * visibilityData );
+    void                        computeVisibility           ( const cgFrustum ** frustums, cgVisibilitySet ** visibilityData, cgUInt32 count );
     
     // Scene Components
     cgPhysicsWorld            * getPhysicsWorld             ( ) const;
@@ -479,6 +490,7 @@ public:
     cgLandscape               * getLandscape                ( ) const;
     cgLightingManager         * getLightingManager          ( ) const; 
     cgSphereTree              * getSceneTree                ( ) const;
+    cgSceneSpatialHash        * getSpatialHash              ( ) const;
 
     // Scene Rendering
     void                        render                      ( );
@@ -591,13 +603,23 @@ protected:
     // Struct containing a list of nodes to be updated and at what time.
     struct UpdateBucket
     {
-        bool             locked;            // This bucket is currently being processed and should not be modified.
-        cgObjectNodeList nodes;             // List of nodes to be updated at this interval
-        cgDouble         lastUpdateTime;    // The last time at which these objects were updated
-        cgDouble         nextUpdateTime;    // The next time at which these objects are scheduled to be updated
+        bool              locked;           // This bucket is currently being processed and should not be modified.
+        cgObjectNodeArray nodes;            // List of nodes to be updated at this interval (removed nodes leave a NULL slot until the bucket is next compacted).
+        cgUInt32          freeSlots;        // Number of NULL slots awaiting compaction.
+        cgDouble          lastUpdateTime;   // The last time at which these objects were updated
+        cgDouble          nextUpdateTime;   // The next time at which these objects are scheduled to be updated
 
     }; // End Struct UpdateBucket
 
+    // Node update side-effects recorded during a parallel update.
+    struct DeferredNodeUpdate
+    {
+        cgObjectNode  * node;
+        cgUInt32        deferredUpdates;
+        cgUInt32        childDeferredUpdates;
+
+    }; // End Struct DeferredNodeUpdate
+
     struct RayCastFilterData
     {
         cgObjectNode  * node;
@@ -609,6 +631,7 @@ protected:
     //-------------------------------------------------------------------------
     CGE_ARRAY_DECLARE       (cgSceneController*, ControllerArray)
     CGE_ARRAY_DECLARE       (cgVisibilitySet*, VisibilitySetArray)
+    CGE_ARRAY_DECLARE       (DeferredNodeUpdate, DeferredUpdateArray)
     CGE_UNORDEREDMAP_DECLARE(cgUID, cgObjectNodeArray, ObjectNodeTypeMap)
     CGE_UNORDEREDMAP_DECLARE(cgString, cgObjectNode*, ObjectNodeNamedMap)
     CGE_UNORDEREDMAP_DECLARE(cgUID, cgSceneElementArray, SceneElementTypeMap)
@@ -621,6 +644,12 @@ protected:
     cgObjectNode              * loadObjectNode              ( cgUInt32 rootReferenceId, cgUInt32 referenceId, cgWorldQuery * nodeData, cgCloneMethod::Base cloneMethod, cgSceneCell * parentCell, cgObjectNode * parentNode, cgObjectNodeMap & loadedNodes, bool loadChildren );
     bool                        loadSceneElements           ( );
 
+    // Update Process
+    void                        addToUpdateBucket           ( cgObjectNode * node );
+    void                        removeFromUpdateBucket      ( cgObjectNode * node );
+    void                        updateBucket                ( UpdateBucket & bucket, cgFloat timeDelta, bool fullSandbox );
+    void                        flushDeferredUpdates        ( );
+
     // Cell Management
     bool                        loadAllCells                ( );
 
@@ -629,6 +658,7 @@ protected:
     //-------------------------------------------------------------------------
     static bool                 rayCastPreFilter            ( cgPhysicsBody * body, cgPhysicsShape * shape, void * userData );
     static cgFloat              rayCastClosestFilter        ( cgPhysicsBody * body, const cgVector3 & hitNormal, cgInt collisionId, void * userData, cgFloat intersectParam );
+    static void                 updateNodeRange             ( cgUInt32 first, cgUInt32 last, void * context );
     
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -659,6 +689,16 @@ protected:
     bool                    mUpdatingEnabled;
     bool                    mIsUpdating;
 
+    // Parallel Update Processing
+    bool                    mParallelUpdatesEnabled;    // Should nodes that declare themselves thread-safe be updated via the job system?
+    bool                    mIsParallelUpdating;        // Are thread-safe nodes currently being updated in parallel?
+    cgUInt32                mParallelUpdateStamp;       // Identifies the most recent parallel batch (see 'cgObjectNode::mParallelUpdateStamp').
+    cgFloat                 mParallelTimeDelta;         // Time delta supplied to nodes updated in parallel.
+    cgObjectNodeArray       mParallelNodes;             // Nodes to be updated in the current parallel batch.
+    DeferredUpdateArray   * mDeferredUpdates;           // Per-thread deferred node update buffers (indexed by job system thread index).
+    cgUInt32                mDeferredUpdateBuffers;     // Number of per-thread deferred update buffers allocated.
+    cgCriticalSection     * mDeferredUpdateSection;     // Protects the buffer shared by threads outside of the job system.
+
     // Controllers
     ControllerArray         mSceneControllers;          // List of applied scene controllers that may manipulate scene data.
 
@@ -672,6 +712,7 @@ protected:
     // Cell Management
     cgSceneCellMap          mCells;                     // All defined cells, organized by 3D grid reference.
     cgSphereTree          * mSceneTree;                 // Primary scene broadphase tree.
+    cgSceneSpatialHash    * mSpatialHash;               // Hashed grid of node positions used to accelerate spatial queries.
     cgBSPTree             * mStaticVisTree;             // Static visibility tree.
     
     // Dynamics Related
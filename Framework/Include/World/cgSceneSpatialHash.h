@@ -0,0 +1,187 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgSceneSpatialHash.h                                               //
+//                                                                           //
+// Desc : Provides a maintained, hashed uniform grid used to accelerate      //
+//        spatial queries (sphere, box, frustum and k-nearest) against the   //
+//        object nodes that exist within a scene.                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _CGE_CGSCENESPATIALHASH_H_ )
+#define _CGE_CGSCENESPATIALHASH_H_
+
+//-----------------------------------------------------------------------------
+// cgSceneSpatialHash Header Includes
+//-----------------------------------------------------------------------------
+#include <cgBase.h>
+#include <Math/cgMathTypes.h>
+#include <Math/cgBoundingBox.h>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class cgObjectNode;
+class cgFrustum;
+
+//-----------------------------------------------------------------------------
+// Global Enumerations
+//-----------------------------------------------------------------------------
+namespace cgSpatialQueryType
+{
+    enum Base
+    {
+        Sphere = 0,
+        Box,
+        Frustum,
+        Nearest
+    };
+
+} // End Namespace : cgSpatialQueryType
+
+//-----------------------------------------------------------------------------
+// Global Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgSpatialQuery (Struct)
+/// <summary>
+/// Describes a single query to be executed as part of a batch via
+/// cgSceneSpatialHash::queryBatch(). Only the members relevant to the
+/// selected query type need to be populated.
+/// </summary>
+//-----------------------------------------------------------------------------
+struct CGE_API cgSpatialQuery
+{
+    cgSpatialQueryType::Base    type;           // The type of query to execute.
+    cgVector3                   center;         // Sphere / Nearest: center of the search volume.
+    cgFloat                     radius;         // Sphere: query radius. Nearest: maximum search distance (0 = unbounded).
+    cgBoundingBox               bounds;         // Box: query bounds.
+    const cgFrustum           * frustum;        // Frustum: query frustum.
+    cgUInt32                    maximumResults; // Nearest: number of nodes to return.
+    cgObjectNodeArray         * results;        // Output container (cleared before the query runs).
+
+    // Constructor
+    cgSpatialQuery() :
+        type( cgSpatialQueryType::Sphere ), center( 0, 0, 0 ), radius( 0 ),
+        frustum( CG_NULL ), maximumResults( 0 ), results( CG_NULL ) {}
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//  Name : cgSceneSpatialHash (Class)
+/// <summary>
+/// Hashed uniform grid that tracks the world space position of each object
+/// node in a scene. Only occupied grid cells are allocated, and node entries
+/// are stored contiguously per cell so that queries touch a minimal amount
+/// of memory. Queries operate on the positions recorded during the most
+/// recent call to 'update()' for each node.
+/// </summary>
+//-----------------------------------------------------------------------------
+class CGE_API cgSceneSpatialHash
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors
+    //-------------------------------------------------------------------------
+     cgSceneSpatialHash( cgFloat cellSize );
+    ~cgSceneSpatialHash( );
+
+    //-------------------------------------------------------------------------
+    // Public Methods
+    //-------------------------------------------------------------------------
+    void                update              ( cgObjectNode * node, const cgVector3 & position );
+    void                remove              ( cgObjectNode * node );
+    void                clear               ( );
+    bool                contains            ( cgObjectNode * node ) const;
+    void                setCellSize         ( cgFloat cellSize );
+    cgFloat             getCellSize         ( ) const;
+    cgUInt32            getNodeCount        ( ) const;
+    cgUInt32            getCellCount        ( ) const;
+
+    // Queries
+    void                querySphere         ( const cgVector3 & center, cgFloat radius, cgObjectNodeArray & nodesOut ) const;
+    void                queryBox            ( const cgBoundingBox & bounds, cgObjectNodeArray & nodesOut ) const;
+    void                queryFrustum        ( const cgFrustum & frustum, cgObjectNodeArray & nodesOut ) const;
+    void                queryNearest        ( const cgVector3 & center, cgUInt32 count, cgFloat maximumDistance, cgObjectNodeArray & nodesOut ) const;
+    void                queryBatch          ( cgSpatialQuery queries[], cgUInt32 queryCount ) const;
+
+protected:
+    //-------------------------------------------------------------------------
+    // Protected Typedefs, Structures and Enumerations
+    //-------------------------------------------------------------------------
+    struct Entry
+    {
+        cgVector3       position;   // World space position recorded for the node.
+        cgObjectNode  * node;       // The node that this entry describes.
+    };
+    CGE_ARRAY_DECLARE(Entry, EntryArray)
+
+    struct Cell
+    {
+        cgInt32         x, y, z;    // Integer grid location of the cell.
+        EntryArray      entries;    // Contiguous list of nodes in the cell.
+    };
+    CGE_VECTOR_DECLARE(Cell, CellArray)
+    CGE_ARRAY_DECLARE(cgUInt32, CellIndexArray)
+
+    struct Location
+    {
+        cgUInt32        cell;       // Index of the cell containing the node.
+        cgUInt32        entry;      // Index of the node's entry within that cell.
+    };
+    CGE_UNORDEREDMAP_DECLARE(cgUInt64, cgUInt32, CellLUT)
+    CGE_UNORDEREDMAP_DECLARE(cgObjectNode*, Location, NodeLUT)
+
+    struct CellRange
+    {
+        cgInt32         minX, minY, minZ;
+        cgInt32         maxX, maxY, maxZ;
+    };
+    typedef void (*CellVisitor)( const cgSceneSpatialHash * hash, const Cell & cell, void * context );
+
+    //-------------------------------------------------------------------------
+    // Protected Methods
+    //-------------------------------------------------------------------------
+    cgInt32             getGridCoordinate   ( cgFloat value ) const;
+    cgBoundingBox       getCellBounds       ( const Cell & cell ) const;
+    bool                getCellRange        ( const cgBoundingBox & bounds, CellRange & range ) const;
+    const Cell        * findCell            ( cgInt32 x, cgInt32 y, cgInt32 z ) const;
+    void                removeEntry         ( cgUInt32 cellIndex, cgUInt32 entryIndex );
+    void                visitCells          ( const CellRange & range, CellVisitor visitor, void * context ) const;
+
+    //-------------------------------------------------------------------------
+    // Protected Static Functions
+    //-------------------------------------------------------------------------
+    static cgUInt64     makeCellKey         ( cgInt32 x, cgInt32 y, cgInt32 z );
+    static void         executeQueries      ( cgUInt32 first, cgUInt32 last, void * context );
+    static void         sphereVisitor       ( const cgSceneSpatialHash * hash, const Cell & cell, void * context );
+    static void         boxVisitor          ( const cgSceneSpatialHash * hash, const Cell & cell, void * context );
+    static void         frustumVisitor      ( const cgSceneSpatialHash * hash, const Cell & cell, void * context );
+    static void         gatherNearest       ( const Cell & cell, const cgVector3 & center, cgUInt32 count, cgFloat maximumDistanceSq, void * candidateHeap );
+
+    //-------------------------------------------------------------------------
+    // Protected Variables
+    //-------------------------------------------------------------------------
+    cgFloat             mCellSize;          // World space dimensions of each grid cell.
+    cgFloat             mInvCellSize;       // Reciprocal of the cell size.
+    CellArray           mCells;             // Storage for all allocated cells (occupied or free).
+    CellIndexArray      mFreeCells;         // Indices of cells in 'mCells' that are currently unused.
+    CellLUT             mCellLUT;           // Maps packed grid locations to cell indices.
+    NodeLUT             mNodeLUT;           // Maps nodes to their current location in the grid.
+    CellRange           mOccupied;          // Conservative grid range spanned by all occupied cells.
+};
+
+#endif // !_CGE_CGSCENESPATIALHASH_H_
@@ -33,6 +33,8 @@
 //-----------------------------------------------------------------------------
 class cgSphereTreeSubNode;
 class cgBSPTree;
+class cgObjectNode;
+class cgVisibilitySet;
 
 //-----------------------------------------------------------------------------
 // Main Class Declarations
@@ -363,6 +365,25 @@ public:
     //-------------------------------------------------------------------------
     CGE_ARRAY_DECLARE( cgVisibilitySet*, VisibilitySetArray )
 
+    //-------------------------------------------------------------------------
+    // Public Structures
+    //-------------------------------------------------------------------------
+    // Visibility set membership change recorded during a batched traversal
+    // and applied once all views have been processed.
+    struct VisibilityChange
+    {
+        cgObjectNode      * object;
+        cgVisibilitySet   * visibilityData;
+        bool                visible;
+    };
+    CGE_VECTOR_DECLARE( VisibilityChange, VisibilityChangeArray )
+
+    //-------------------------------------------------------------------------
+    // Public Constants
+    //-------------------------------------------------------------------------
+    // Maximum number of views processed by a single shared traversal.
+    static const cgUInt32 MaxBatchViews = 32;
+
     //-------------------------------------------------------------------------
     // Public Enumerations
     //-------------------------------------------------------------------------
@@ -398,6 +419,10 @@ public:
     void                    addRecompute            ( cgSphereTreeSubNode * node );
     void                    process                 ( );
     void                    computeVisibility       ( const cgFrustum & frustum, cgVisibilitySet * visibilityData, cgUInt32 flags );
+    void                    computeVisibility       ( const cgFrustum ** frustums, cgVisibilitySet ** visibilityData, cgUInt32 count );
+    void                    updateLayoutSphere      ( const cgSphereTreeSubNode * node );
+    void                    linkLayoutChild         ( cgSphereTreeSubNode * parent, cgSphereTreeSubNode * child );
+    void                    unlinkLayoutChild       ( cgSphereTreeSubNode * parent, cgSphereTreeSubNode * child );
 
     //-------------------------------------------------------------------------
     // Public Inline Methods
@@ -414,6 +439,10 @@ public:
     {
         return mStaticVisTree;
     }
+    inline void invalidateLayout( )
+    {
+        mLayoutDirty = true;
+    }
     
     //-------------------------------------------------------------------------
     // Public Virtual Methods (Overrides DisposableScriptObject)
@@ -421,10 +450,73 @@ public:
     virtual void            dispose                 ( bool disposeBase );
 
 protected:
+    //-------------------------------------------------------------------------
+    // Protected Typedefs
+    //-------------------------------------------------------------------------
+    CGE_ARRAY_DECLARE( cgSphereTreeSubNode*, SubNodeArray )
+
+    //-------------------------------------------------------------------------
+    // Protected Structures
+    //-------------------------------------------------------------------------
+    // Flattened mirror of the hierarchy used during traversal. The children
+    // of any node are stored contiguously in a power of two sized 'block' of
+    // entries so that their spheres can be classified several at a time, and
+    // so that children can be added or removed without moving other nodes.
+    struct Layout
+    {
+        SubNodeArray    nodes;          // Node referenced by each entry (CG_NULL if unused).
+        cgFloatArray    centerX;        // Sphere center X component (padded).
+        cgFloatArray    centerY;        // Sphere center Y component (padded).
+        cgFloatArray    centerZ;        // Sphere center Z component (padded).
+        cgFloatArray    radius;         // Sphere radius (padded).
+        cgUInt32Array   firstChild;     // Index of the first child entry.
+        cgUInt32Array   childCount;     // Number of contiguous child entries.
+        cgUInt32Array   freeBlocks[24]; // Released child blocks, indexed by size class.
+        cgUInt32        entryCount;     // Number of entries referencing a node.
+        cgUInt32        slotCount;      // Number of entries allocated (excluding padding).
+        cgUInt32        freeSlots;      // Number of entries owned by released blocks.
+
+        Layout() : entryCount(0), slotCount(0), freeSlots(0) {}
+    };
+
+    // Per-view traversal state shared by all nodes visited.
+    struct TraversalData
+    {
+        cgFloat             planes[6][4];
+        cgVisibilitySet   * visibilityData;
+        cgUInt32            setIndex;
+        const cgByte      * sourceLeafVis;
+    };
+
+    // State for a shared, multi-view traversal. Each bit in the view masks
+    // corresponds to an entry in the 'views' array.
+    struct BatchData
+    {
+        cgSphereTree      * tree;
+        TraversalData       views[MaxBatchViews];
+        cgUInt32            viewCount;
+        cgUInt32            chunkCount;
+        cgUInt32            rootTestMask;       // Views for which the root intersects.
+        cgUInt32            rootInsideMask;     // Views for which the root is inside.
+    };
+    CGE_ARRAY_DECLARE( VisibilityChangeArray, VisibilityChangeChunkArray )
+
     //-------------------------------------------------------------------------
     // Protected Methods
     //-------------------------------------------------------------------------
     void                    integrate           ( cgSphereTreeSubNode * node, cgSphereTreeSubNode * superSphere, cgFloat nodeSize );
+    void                    rebuildLayout       ( );
+    cgUInt32                allocateLayoutBlock ( cgUInt32 sizeClass );
+    void                    releaseLayoutBlock  ( cgUInt32 first, cgUInt32 sizeClass );
+    void                    writeLayoutEntry    ( cgUInt32 index, cgSphereTreeSubNode * node );
+    void                    computeChildVisibility( const TraversalData & data, cgUInt32 parentIndex, cgVolumeQuery::Class parentState );
+    void                    computeChildVisibility( const BatchData & data, cgUInt32 first, cgUInt32 last, cgUInt32 testMask, cgUInt32 insideMask, VisibilityChangeArray * changes );
+    bool                    prepareTraversal    ( const cgFrustum & frustum, cgVisibilitySet * visibilityData, TraversalData & data );
+
+    //-------------------------------------------------------------------------
+    // Protected Static Functions
+    //-------------------------------------------------------------------------
+    static void             computeBatchChunks  ( cgUInt32 first, cgUInt32 last, void * context );
     
     //-------------------------------------------------------------------------
     // Protected Variables
@@ -437,6 +529,9 @@ protected:
     cgSphereTreeFIFO            mRecomputeFIFO;
     cgPool<cgSphereTreeSubNode> mNodePool;
     VisibilitySetArray          mSets;
+    Layout                      mLayout;
+    bool                        mLayoutDirty;
+    VisibilityChangeChunkArray  mBatchChanges;      // Per-chunk, per-view changes recorded during batched traversal.
     
 }; // End Class cgSphereTree
 
@@ -454,7 +549,8 @@ public:
     //-------------------------------------------------------------------------
     cgSphereTreeSubNode() :
         mParent(CG_NULL), mChildren(CG_NULL), mNextSibling(CG_NULL), mPreviousSibling(CG_NULL), mUserData(CG_NULL),
-        mFIFO1(CG_NULL), mFIFO2(CG_NULL), mTree(CG_NULL), mFlags(0), mChildCount(0), mBindingDistance(0) {}
+        mFIFO1(CG_NULL), mFIFO2(CG_NULL), mTree(CG_NULL), mFlags(0), mChildCount(0), mBindingDistance(0),
+        mLayoutIndex(cgUInt32(-1)), mLayoutBlock(cgUInt32(-1)), mLayoutBlockClass(0), mLayoutChildCount(0) {}
 
     //-------------------------------------------------------------------------
     // Public Methods
@@ -462,6 +558,7 @@ public:
     bool        recompute           ( cgFloat padding );
     void        invalidateVisibility( );
     void        computeVisibility   ( const cgFrustum & frustum, cgVisibilitySet * visibilityData, cgUInt32 setIndex, cgUInt32 searchFlags, cgVolumeQuery::Class state, cgBSPTree * staticVisTree, cgUInt32 sourceLeaf, const cgByte * sourceLeafVis );
+    cgVolumeQuery::Class updateVisibility( cgVisibilitySet * visibilityData, cgUInt32 setIndex, cgVolumeQuery::Class state, const cgByte * sourceLeafVis, cgSphereTree::VisibilityChangeArray * deferredChanges = CG_NULL );
 
     //-------------------------------------------------------------------------
     // Public Inline Methods
@@ -488,6 +585,10 @@ public:
         mBindingDistance    = 0;
         mChildCount         = 0;
         mLeafCount          = 0;
+        mLayoutIndex        = cgUInt32(-1);
+        mLayoutBlock        = cgUInt32(-1);
+        mLayoutBlockClass   = 0;
+        mLayoutChildCount   = 0;
 
         // Size flag array appropriately.
         mVisFlags.resize( tree->getVisibilitySetCount(), 0 );
@@ -699,6 +800,30 @@ public:
         mParent = parent;
     }
 
+    //-------------------------------------------------------------------------
+    // Name : getLayoutIndex ()
+    /// <summary>
+    /// Retrieve the index of the entry that mirrors this node in the owning
+    /// tree's flattened traversal layout.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    inline cgUInt32 getLayoutIndex( ) const
+    {
+        return mLayoutIndex;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : setLayoutIndex ()
+    /// <summary>
+    /// Update the index of the entry that mirrors this node in the owning
+    /// tree's flattened traversal layout.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    inline void setLayoutIndex( cgUInt32 index )
+    {
+        mLayoutIndex = index;
+    }
+
     //-------------------------------------------------------------------------
     // Name : addChild ()
     /// <summary>
@@ -720,6 +845,7 @@ public:
             firstChild->setPreviousSibling(node);
 
         ++mChildCount;
+        mTree->linkLayoutChild( this, node );
 
         #ifdef _DEBUG
             cgFloat distance = cgVector3::length( this->position - node->position );
@@ -774,6 +900,7 @@ public:
         
         } // End if no previous
         mChildCount--;
+        mTree->unlinkLayoutChild( this, node );
 
         // Remove from hierarchy if there are no longer any children.
         if ( !mChildCount && isFlagSet( cgSphereTree::SuperSphere ) )
@@ -823,6 +950,7 @@ public:
     {
         this->position = newPosition;
         setFlag( cgSphereTree::UpdateLeaves );
+        mTree->updateLayoutSphere( this );
 
         // If we have a parent (meaning we are a valid leaf node) and we have not 
         // already been flagged for re-integration, then.....
@@ -856,6 +984,7 @@ public:
         this->position = newPosition;
         this->radius = newRadius;
         setFlag( cgSphereTree::UpdateLeaves );
+        mTree->updateLayoutSphere( this );
 
         if ( mParent && !isFlagSet( cgSphereTree::Integrate ) )
         {
@@ -895,6 +1024,11 @@ public:
     }
 
 private:
+    //-------------------------------------------------------------------------
+    // Friend List
+    //-------------------------------------------------------------------------
+    friend class cgSphereTree;
+
     //-------------------------------------------------------------------------
     // Private Variables
     //-------------------------------------------------------------------------
@@ -919,6 +1053,11 @@ private:
     cgUInt32                mLeafCount;
     cgUInt32                mLeaves[1000];
 
+    cgUInt32                mLayoutIndex;       // Entry in the tree's flattened traversal layout.
+    cgUInt32                mLayoutBlock;       // First entry of the layout block holding our children.
+    cgUInt32                mLayoutBlockClass;  // Size class of the above block (capacity is 'MinBlockSize << class').
+    cgUInt32                mLayoutChildCount;  // Number of children currently stored in the above block.
+
 }; // End Class cgSphereTreeSubNode
 
 #endif // !_CGE_CGSPHERETREE_H_
\ No newline at end of file
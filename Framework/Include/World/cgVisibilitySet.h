@@ -76,6 +76,29 @@ public:
         MaterialBatchMap    materials;
     };
     CGE_MAP_DECLARE(cgUInt32, RenderClass, RenderClassMap)
+
+    // Flat equivalents of the above, returned by the array accessors. Note:
+    // Node and range pointers reference storage owned by the set and remain
+    // valid only until the set is next modified or cleared.
+    struct MaterialRange
+    {
+        cgUInt32                renderClassId;
+        cgMaterialHandle        material;
+        cgBoundingBox           combinedBounds;
+        cgObjectNode * const  * objectNodes;
+        cgUInt32                objectCount;
+    };
+    CGE_ARRAY_DECLARE(MaterialRange, MaterialRangeArray)
+    struct RenderClassRange
+    {
+        cgUInt32                renderClassId;
+        cgBoundingBox           combinedBounds;
+        cgObjectNode * const  * objectNodes;
+        cgUInt32                objectCount;
+        const MaterialRange   * materials;
+        cgUInt32                materialCount;
+    };
+    CGE_ARRAY_DECLARE(RenderClassRange, RenderClassRangeArray)
     
     //-------------------------------------------------------------------------
 	// Constructors & Destructors
@@ -95,11 +118,12 @@ public:
     bool                        addVisibleObject        ( cgObjectNode * object );
     void                        removeVisibleObject     ( cgObjectNode * object );
     bool                        addVisibleLight         ( cgObjectNode * light );
-    void                        removeVisibleLight      ( cgObjectNode * object );
+    void                        removeVisibleLight      ( cgObjectNode * light );
     bool                        addVisibleMaterial      ( const cgMaterialHandle & material, cgObjectNode * object );
     void                        addVisibleLeaf          ( cgSpatialTreeInstance * tree, cgSpatialTreeLeaf * leaf );
     void                        addVisibleGroup         ( void * context, cgInt32 groupId );
     void                        clearVisibleGroups      ( void * context );
+    bool                        isGroupVisible          ( void * context, cgInt32 groupId ) const;
     bool                        query                   ( cgObjectNode * node ) const;
     void                        setSearchFlags          ( cgUInt32 flags );
     cgObjectNodeList          & getVisibleObjects       ( );
@@ -112,11 +136,22 @@ public:
     const cgInt32Set          & getVisibleGroups        ( void * context ) const;
     RenderClassMap            & getVisibleRenderClasses ( );
     const RenderClassMap      & getVisibleRenderClasses ( ) const;
+    const cgObjectNodeArray   & getVisibleObjectArray   ( ) const;
+    const cgObjectNodeArray   & getVisibleLightArray    ( ) const;
+    const cgSceneLeafArray    & getVisibleLeafArray     ( cgSpatialTreeInstance * tree ) const;
+    const cgInt32Array        & getVisibleGroupArray    ( void * context ) const;
+    const RenderClassRangeArray & getVisibleRenderClassArray( ) const;
+    const RenderClassRange    * getVisibleRenderClass   ( cgUInt32 renderClassId ) const;
     cgFrustum                 & getVolume               ( );
     const cgFrustum           & getVolume               ( ) const;
     cgUInt32                    getSearchFlags          ( ) const;
     bool                        isSetModifiedSince      ( cgUInt32 frame ) const;
 
+    //-------------------------------------------------------------------------
+	// Public Static Functions
+	//-------------------------------------------------------------------------
+    static void                 compute                 ( cgVisibilitySet ** sets, const cgFrustum ** frustums, cgUInt32 count );
+
     //-------------------------------------------------------------------------
     // Public Virtual Methods (Overrides DisposableScriptObject)
     //-------------------------------------------------------------------------
@@ -126,21 +161,123 @@ private:
     //-------------------------------------------------------------------------
 	// Private Structures, Typedefs and Enumerations
 	//-------------------------------------------------------------------------
+    struct Membership
+    {
+        cgUInt32            generation;         // Generation of the set in which this entry was last stamped.
+        cgUInt32            position;           // Position of the node within the matching visible node array.
+        cgUInt32            epoch;              // Epoch in which the node was most recently added (see 'MaterialEntry').
+    };
+    CGE_ARRAY_DECLARE(Membership, MembershipArray)
+    
+    struct TreeLeaves
+    {
+        void              * tree;               // The spatial tree instance to which these leaves belong.
+        cgUInt32            generation;         // Current generation for the leaf stamps below.
+        cgUInt32Array       leafStamps;         // Generation stamp for each leaf, indexed by the leaf index.
+        cgSceneLeafArray    leaves;             // Visible leaves in the order in which they were added.
+    };
+    CGE_ARRAY_DECLARE(TreeLeaves, TreeLeavesArray)
+    
+    struct AssociatedGroups
+    {
+        void              * context;            // The context object with which these groups are associated.
+        cgUInt32            generation;         // Current generation for the group stamps below.
+        cgUInt32Array       groupStamps;        // Generation stamp for each group, indexed by the group identifier.
+        cgInt32Array        groups;             // Visible group identifiers in the order in which they were added.
+    };
+    CGE_ARRAY_DECLARE(AssociatedGroups, AssociatedGroupsArray)
+    
+    CGE_UNORDEREDMAP_DECLARE(void*, cgUInt32, MaterialSlotMap)
+    
+    struct MaterialEntry
+    {
+        cgUInt32            material;           // Index of the material handle in the set's material table.
+        cgObjectNode      * node;               // The object that was registered against this material.
+        cgUInt32            epoch;              // Membership epoch of the object at registration. Entries from earlier memberships are stale.
+    };
+    CGE_ARRAY_DECLARE(MaterialEntry, MaterialEntryArray)
+
+    // Sorting key used to batch material entries. Objects are ordered (and
+    // duplicate registrations identified) by their stable visibility index
+    // rather than by address so that batch order is deterministic.
+    struct BatchKey
+    {
+        cgUInt32            renderClassId;
+        cgUInt32            material;
+        cgUInt32            nodeIndex;          // Visibility index of the node.
+        cgUInt32            entry;              // Index of the material entry that produced this key.
+        bool operator < ( const BatchKey & key ) const
+        {
+            if ( renderClassId != key.renderClassId ) return renderClassId < key.renderClassId;
+            if ( material != key.material ) return material < key.material;
+            return nodeIndex < key.nodeIndex;
+        }
+        bool operator == ( const BatchKey & key ) const
+        {
+            return renderClassId == key.renderClassId && material == key.material && nodeIndex == key.nodeIndex;
+        }
+    };
+    CGE_ARRAY_DECLARE(BatchKey, BatchKeyArray)
+    CGE_ARRAY_DECLARE(cgUInt64, ClassKeyArray)
     CGE_UNORDEREDMAP_DECLARE(void*, cgSceneLeafSet, TreeLeafMap)
     CGE_UNORDEREDMAP_DECLARE(void*, cgInt32Set, AssociatedGroupMap)
 
+    //-------------------------------------------------------------------------
+	// Private Methods
+	//-------------------------------------------------------------------------
+    static bool                 addMember               ( MembershipArray & membership, cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation, cgUInt32 epoch );
+    static bool                 removeMember            ( MembershipArray & membership, cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation );
+    static bool                 isMember                ( const MembershipArray & membership, const cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation );
+    bool                        isCurrentEntry          ( const MaterialEntry & entry ) const;
+    void                        compactMaterialEntries  ( );
+    void                        buildRenderClasses      ( ) const;
+    void                        buildLegacyObjects      ( ) const;
+    void                        buildLegacyLights       ( ) const;
+    void                        buildLegacyLeaves       ( ) const;
+    void                        buildLegacyGroups       ( ) const;
+    void                        buildLegacyRenderClasses( ) const;
+
     //-------------------------------------------------------------------------
 	// Private Variables
 	//-------------------------------------------------------------------------
     cgScene               * mScene;                 // The scene on which the query is to run.
-    TreeLeafMap             mTreeLeaves;            // List of visible spatial tree leaves, grouped by their parent tree.
-    AssociatedGroupMap      mAssociatedGroups;      // List of visible data groups associated with a given context (i.e. blocks in a terrain).
+    TreeLeavesArray         mTreeLeaves;            // List of visible spatial tree leaves, grouped by their parent tree.
+    AssociatedGroupsArray   mAssociatedGroups;      // List of visible data groups associated with a given context (i.e. blocks in a terrain).
     
-    EntryLUT                mObjectNodeLUT;         // Look up table which maps a specific object node pointer to the entry in the main array.
-    cgObjectNodeList        mObjectNodes;           // Array containing a list of all objects visible to this visibility set's parent camera / frustum / bounds.
-    EntryLUT                mLightLUT;              // Look up table which maps a specific light node pointer to the entry in the main array.
-    cgObjectNodeList        mLights;                // Array containing a list of all objects visible to this visibility set's parent camera / frustum / bounds.
-    RenderClassMap          mRenderClasses;         // List of visible materials & objects categorized by render class.
+    cgUInt32                mGeneration;            // Current membership generation. Incremented whenever the set is cleared.
+    cgUInt32                mMembershipEpoch;       // Incremented each time an object is added, such that every membership period is distinct.
+    MembershipArray         mObjectMembership;      // Generation stamped membership of each object, indexed by the node's visibility index.
+    cgObjectNodeArray       mObjectNodes;           // Array containing a list of all objects visible to this visibility set's parent camera / frustum / bounds.
+    MembershipArray         mLightMembership;       // Generation stamped membership of each light, indexed by the node's visibility index.
+    cgObjectNodeArray       mLights;                // Array containing a list of all lights visible to this visibility set's parent camera / frustum / bounds.
+    cgMaterialHandleArray   mMaterials;             // Table of unique materials referenced by the visible objects.
+    MaterialSlotMap         mMaterialSlots;         // Maps a material resource to its entry in the material table.
+    MaterialEntryArray      mMaterialEntries;       // Every material registered against a visible object, in the order in which they were added.
+    size_t                  mMaterialCompactSize;   // Number of material entries at which entries for objects no longer visible will be discarded.
+
+    // Render class index (built on demand).
+    mutable bool                    mRenderClassesDirty;    // The render class index needs to be rebuilt before it is next accessed.
+    mutable RenderClassRangeArray   mRenderClasses;         // List of visible render classes, sorted by identifier.
+    mutable MaterialRangeArray      mMaterialBatches;       // Material batches for all render classes, sorted by render class and then material.
+    mutable cgObjectNodeArray   mClassObjects;          // Visible objects grouped by render class.
+    mutable cgObjectNodeArray   mBatchObjects;          // Visible objects grouped by render class and material.
+    mutable ClassKeyArray       mClassKeys;             // Scratch array used to sort objects by render class.
+    mutable BatchKeyArray       mBatchKeys;             // Scratch array used to sort material entries into batches.
+
+    // List / map based copies of the above returned by the original accessors
+    // (built on demand, and only when the set has been modified since). Each
+    // copy records the value of 'mRevision' at which it was last built.
+    cgUInt32                    mRevision;                      // Incremented whenever the contents of the set change.
+    mutable cgObjectNodeList    mLegacyObjects;                 // Visible objects.
+    mutable cgUInt32            mLegacyObjectsRevision;
+    mutable cgObjectNodeList    mLegacyLights;                  // Visible lights.
+    mutable cgUInt32            mLegacyLightsRevision;
+    mutable TreeLeafMap         mLegacyLeaves;                  // Visible spatial tree leaves, grouped by their parent tree.
+    mutable cgUInt32            mLegacyLeavesRevision;
+    mutable AssociatedGroupMap  mLegacyGroups;                  // Visible data groups, grouped by their associated context.
+    mutable cgUInt32            mLegacyGroupsRevision;
+    mutable RenderClassMap      mLegacyRenderClasses;           // Visible materials & objects categorized by render class.
+    mutable cgUInt32            mLegacyRenderClassesRevision;
 
     cgUInt32                mSearchFlags;           // Combination of cgVisibilitySearchFlags that are used to determine which objects we are interest in for this set.
     cgUInt32                mResultId;              // The unique result identifier used to distinguish between multiple visibility sets.
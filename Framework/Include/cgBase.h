@@ -118,6 +118,7 @@ struct CGEConfig
     bool                highPriority;   // Application process should run with high priority.
     bool                multiThreaded;  // Will the application require multi-threaded access to drivers such as the render driver?
     cgSandboxMode::Base sandboxMode;    // The engine is running in sandbox mode and provides editor-like functionality?
+    cgUInt32            workerThreads;  // Number of job system worker threads to start (0 = one per additional processor).
 
     // Constructor
     CGE_API CGEConfig() :
@@ -130,7 +131,8 @@ struct CGEConfig
 #       endif
         platform( cgPlatform::Windows ), audioAPI( cgAudioAPI::DirectX ), 
         inputAPI( cgInputAPI::DirectX ), networkAPI( cgNetworkAPI::Winsock ),
-        highPriority( true ), multiThreaded(false), sandboxMode(cgSandboxMode::Disabled) {}
+        highPriority( true ), multiThreaded(false), sandboxMode(cgSandboxMode::Disabled),
+        workerThreads(0) {}
 
 }; // End struct CGEConfig
 
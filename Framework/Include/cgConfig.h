@@ -34,6 +34,13 @@
 
 //#define CGE_PROFILEPRIMITIVES
 
+// Compile in support for low overhead scoped trace capture (see cgTraceProfiler).
+// When disabled, all 'cgTraceScope()' instrumentation compiles away entirely.
+// Capture must still be enabled at runtime (via the profiler configuration) 
+// before any data is recorded.
+
+#define CGE_TRACE_PROFILING
+
 //-----------------------------------------------------------------------------
 // API Support
 //-----------------------------------------------------------------------------
@@ -74,6 +81,40 @@
 //#undef CGE_GL_RENDER_SUPPORT
 #endif
 
+//-----------------------------------------------------------------------------
+// Math configuration
+//-----------------------------------------------------------------------------
+
+// Use the engine's own portable implementation of the core math types (cgMatrix,
+// cgVector2/3/4, cgQuaternion and cgPlane) rather than forwarding to D3DX. This
+// is automatically enabled on platforms where D3DX is not available. This can be
+// supplied as a compiler pre-processor definition so the following should be
+// considered more of an 'override' for this.
+
+#if !defined(CGE_NATIVE_MATH)
+//#define CGE_NATIVE_MATH
+#endif
+
+// Instruction set used by the native math implementation. Define one of
+// 'CGE_MATH_SIMD_AVX', 'CGE_MATH_SIMD_SSE2' or 'CGE_MATH_SIMD_SCALAR' to force a
+// specific code path. When none is defined, the best instruction set enabled by
+// the compiler's target architecture options is selected automatically.
+
+//#define CGE_MATH_SIMD_SCALAR
+
+
+//-----------------------------------------------------------------------------
+// Threading configuration
+//-----------------------------------------------------------------------------
+// Use the portable C++11 standard library implementation of the core threading
+// types (cgThread, cgCriticalSection and cgEvent) rather than the native Windows
+// implementation. This is automatically enabled on platforms other than Windows
+// and requires a compiler with C++11 thread support (VC++ 2012 or above). This
+// can be supplied as a compiler pre-processor definition so the following should
+// be considered more of an 'override' for this.
+#if !defined(CGE_STD_THREADING)
+//#define CGE_STD_THREADING
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 // System configuration defines. Do not modify.
@@ -89,6 +130,43 @@
 #define CGE_SCRIPT_JIT_SUPPORTED
 #endif
 
+// D3DX is only available on Windows. Other platforms must use the native math
+// implementation.
+
+#if !defined(_WIN32) && !defined(CGE_NATIVE_MATH)
+#define CGE_NATIVE_MATH
+#endif
+
+// Windows threading primitives are only available on Windows. Other platforms
+// must use the standard library implementation.
+#if !defined(_WIN32) && !defined(CGE_STD_THREADING)
+#define CGE_STD_THREADING
+#endif
+
+// Storage class specifier for thread local variables.
+
+#if defined(_MSC_VER)
+#define CGE_THREAD_LOCAL __declspec(thread)
+#else
+#define CGE_THREAD_LOCAL __thread
+#endif
+
+// Select the native math instruction set based on the compiler's target options
+// unless one was explicitly specified. AVX support implies SSE2 support.
+
+#if !defined(CGE_MATH_SIMD_SCALAR) && !defined(CGE_MATH_SIMD_SSE2) && !defined(CGE_MATH_SIMD_AVX)
+#   if defined(__AVX__)
+#       define CGE_MATH_SIMD_AVX
+#   elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#       define CGE_MATH_SIMD_SSE2
+#   else
+#       define CGE_MATH_SIMD_SCALAR
+#   endif
+#endif
+#if defined(CGE_MATH_SIMD_AVX) && !defined(CGE_MATH_SIMD_SSE2)
+#define CGE_MATH_SIMD_SSE2
+#endif
+
 // Engine versioning information
 #define CGE_ENGINE_VERSION      0
 #define CGE_ENGINE_SUBVERSION   8
@@ -43,7 +43,10 @@
 cgAnimationController::cgAnimationController( ) : cgScriptInterop::DisposableScriptObject( )
 {
     // Set variables to sensible defaults
-    mPosition = 0.0f;
+    mPosition         = 0.0f;
+    mTargetsDirty     = true;
+    mBoundTargetMap   = CG_NULL;
+    mBoundTargetCount = 0;
 
     // By default, we allocate space for one track
     mTracks.resize( 1 );
@@ -73,6 +76,15 @@ void cgAnimationController::dispose( bool bDisposeBase )
     // Clear containers
     mValidTargetIds.clear();
     mTracks.clear(); 
+    mBoundTargets.clear();
+    mBoundTargetData.clear();
+    mPoseScale.clear();
+    mPoseRotation.clear();
+    mPoseTranslation.clear();
+    mPoseWeight.clear();
+    mBoundTargetMap   = CG_NULL;
+    mBoundTargetCount = 0;
+    mTargetsDirty     = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -124,110 +136,196 @@ void cgAnimationController::advanceTime( cgDouble fTimeElapsed, const TargetMap
 //-----------------------------------------------------------------------------
 void cgAnimationController::updateTargets( const TargetMap & Targets )
 {
-    cgFloat fWeightTheta = 0.0f;
-    
-    // Resize vectors to store enough data for each track
-    struct AnimationData
+    const size_t nTrackCount = mTracks.size();
+
+    // Resolve target bindings again if the target map, or the animation sets
+    // (or their contents) applied to any track have changed.
+    if ( &Targets != mBoundTargetMap || Targets.size() != mBoundTargetCount )
+        mTargetsDirty = true;
+    for ( size_t i = 0; i < nTrackCount && !mTargetsDirty; ++i )
     {
-        cgVector3 scale, translation;
-        cgQuaternion rotation;
-    };
-    cgArray<AnimationData> TrackTransforms( mTracks.size() );
-    cgArray<cgFloat> TrackWeights( mTracks.size(), 0.0f );
+        Track & Item = mTracks[i];
+        cgAnimationSet * pSet = Item.set.getResource(true);
+        if ( pSet != Item.boundSet || (pSet && pSet->getTargetRevision() != Item.boundRevision) )
+            mTargetsDirty = true;
+    
+    } // Next track
+    if ( mTargetsDirty )
+        bindTargets( Targets );
 
-    // Iterate through each applied animation target
-    for ( cgStringSet::iterator itTargetId = mValidTargetIds.begin(); itTargetId != mValidTargetIds.end(); ++itTargetId )
+    // Anything to animate?
+    const size_t nSlotCount = mBoundTargets.size();
+    if ( !nSlotCount )
+        return;
+
+    // Sample each track for every bound target into the pose buffer.
+    for ( size_t i = 0; i < nTrackCount; ++i )
     {
-        // Find the matching supplied animation target instance.
-        TargetMap::const_iterator itTarget = Targets.find( *itTargetId );
-        if ( itTarget == Targets.end() )
+        Track & Item = mTracks[i];
+        cgAnimationSet * pSet = Item.boundSet;
+        
+        // Skip if the track is disabled.
+        if ( !Item.desc.enabled || !Item.desc.weight || !pSet )
+        {
+            for ( size_t nSlot = 0, j = i; nSlot < nSlotCount; ++nSlot, j += nTrackCount )
+                mPoseWeight[j] = 0.0f;
             continue;
-        cgAnimationTarget * pTarget = itTarget->second;
         
-        // Reset normalizing "length" value.
-        fWeightTheta = 0.0f;
+        } // End if disabled
 
-        // Iterate through each available track and determine which sets (if any)
-        // contain appropriate animation data for this target.
-        for ( size_t i = 0; i < mTracks.size(); ++i )
+        // Advance the track's key cursors to the new position.
+        const cgDouble fFramePosition = Item.desc.position * (cgDouble)pSet->getFrameRate();
+        pSet->advanceCursor( fFramePosition, Item.desc.playbackMode, Item.desc.firstFrame, Item.desc.lastFrame, Item.cursor );
+
+        // Retrieve track SRT data for each target animated by this set.
+        for ( size_t nSlot = 0, j = i; nSlot < nSlotCount; ++nSlot, j += nTrackCount )
         {
-            Track & Item = mTracks[i];
-            
-            // Skip if the track is disabled.
-            if ( !Item.desc.enabled || !Item.desc.weight || !Item.set.isValid() )
+            const cgAnimationSet::TargetData * pData = mBoundTargetData[j];
+            if ( !pData )
             {
-                TrackWeights[i] = 0.0f;
+                mPoseWeight[j] = 0.0f;
                 continue;
             
-            } // End if disabled
+            } // End if not animated
+            pSet->getSRT( fFramePosition, Item.desc.playbackMode, *pData, Item.desc.firstFrame, Item.desc.lastFrame, mBoundTargets[nSlot],
+                          &Item.cursor.keys[ pData->index * cgAnimationSet::CursorChannelCount ],
+                          mPoseScale[j], mPoseRotation[j], mPoseTranslation[j] );
+            mPoseWeight[j] = Item.desc.weight;
 
-            // Retrieve track SRT data.
-            AnimationData & data = TrackTransforms[i];
-            cgAnimationSet * pSet = Item.set.getResource(true);
-            if ( pSet->getSRT( Item.desc.position * (cgDouble)pSet->getFrameRate(), Item.desc.playbackMode, *itTargetId, 
-                               Item.desc.firstFrame, Item.desc.lastFrame, pTarget, data.scale, data.rotation, data.translation ) )
-            {
-                // Include in final blend.
-                fWeightTheta   += Item.desc.weight;
-                TrackWeights[i] = Item.desc.weight;
+        } // Next target
+
+    } // Next playing track
+
+    // Blend the samples for each target and apply.
+    for ( size_t nSlot = 0, nFirst = 0; nSlot < nSlotCount; ++nSlot, nFirst += nTrackCount )
+    {
+        // Compute normalizing "length" value.
+        cgFloat fWeightTheta = 0.0f;
+        for ( size_t j = nFirst; j < nFirst + nTrackCount; ++j )
+            fWeightTheta += mPoseWeight[j];
+        
+        // Generate the blended transform if any data found
+        if ( fWeightTheta <= CGE_EPSILON )
+            continue;
 
-            } // End if retrieved SRT data
-            else
+        // Normalizing reciprocal
+        fWeightTheta = 1.0f / fWeightTheta;
+
+        // Blend each track.
+        cgVector3 Scale( 0, 0, 0 ), Translation( 0, 0, 0 );
+        cgQuaternion Rotation( 0, 0, 0, 0 );
+        bool firstRotation = true;
+        for ( size_t j = nFirst; j < nFirst + nTrackCount; ++j )
+        {
+            cgFloat fWeight = mPoseWeight[j];
+
+            // Track plays any part?
+            if ( fWeight > CGE_EPSILON )
             {
-                TrackWeights[i] = 0;
+                if ( firstRotation )
+                    Rotation = mPoseRotation[j];
+                else
+                    cgQuaternion::slerp( Rotation, Rotation, mPoseRotation[j], (fWeight * fWeightTheta) );
+                firstRotation = false;
+
+                // Weighted sum.
+                Translation += mPoseTranslation[j] * (fWeight * fWeightTheta);
+                Scale += mPoseScale[j] * (fWeight * fWeightTheta);
+            
+            } // End if applicable
             
-            } // End if no SRT
-
         } // Next playing track
 
-        // Generate the blended transform if any data found
-        if ( fWeightTheta > CGE_EPSILON )
+        // Compose final transform.
+        cgTransform t;
+        t.compose( Scale, cgVector3( 0, 0, 0 ), Rotation, Translation );
+
+        // Apply this to the animation target
+        mBoundTargets[nSlot]->onAnimationTransformUpdated( t );
+
+    } // Next Animation Target
+}
+
+//-----------------------------------------------------------------------------
+//  Name : bindTargets () (Protected)
+/// <summary>
+/// Resolve the identifiers of all targets animated by the applied animation 
+/// sets to integer slots, recording the target instance and the animation
+/// set data for each track. This allows 'updateTargets()' to sample and blend
+/// without looking up any target by identifier. Called automatically whenever
+/// the tracks, their animation sets or the supplied target map change.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationController::bindTargets( const TargetMap & Targets )
+{
+    const size_t nTrackCount = mTracks.size();
+
+    // Build a unique set of targets identifiers from all applied animation sets.
+    mValidTargetIds.clear();
+    for ( size_t i = 0; i < nTrackCount; ++i )
+    {
+        Track & Item = mTracks[i];
+        cgAnimationSet * pSet = Item.set.getResource( true );
+        Item.boundSet      = pSet;
+        Item.boundRevision = (pSet) ? pSet->getTargetRevision() : 0;
+        Item.cursor        = cgAnimationSet::SampleCursor();
+        if ( pSet )
         {
-            // Generate final animation data.
-            AnimationData data;
-            memset( &data, 0, sizeof(AnimationData) );
-            cgMatrix m;
-            memset( &m, 0, sizeof(cgMatrix) );
-            
-            // Normalizing reciprocal
-            fWeightTheta = 1.0f / fWeightTheta;
+            // Get a list of the registered targets and add any unique entries to our 
+            // list of currently *valid* target instance identifiers.
+            cgAnimationSet::TargetDataMap::const_iterator itTarget;
+            const cgAnimationSet::TargetDataMap & TargetData = pSet->getTargetData();
+            for ( itTarget = TargetData.begin(); itTarget != TargetData.end(); ++itTarget )
+                mValidTargetIds.insert( itTarget->first );
 
-            // Blend each track.
-            bool firstRotation = true;
-            for ( size_t i = 0; i < mTracks.size(); ++i )
-            {
-                cgFloat fWeight = TrackWeights[i];
+        } // End if valid set
 
-                // Track plays any part?
-                if ( fWeight > CGE_EPSILON )
-                {
-                    if ( firstRotation )
-                        data.rotation = TrackTransforms[i].rotation;
-                    else
-                        cgQuaternion::slerp( data.rotation, data.rotation, TrackTransforms[i].rotation, (fWeight * fWeightTheta) );
-                    firstRotation = false;
+    } // Next track
 
-                    // NLerp
-                    //cgQuaternion::normalize( data.rotation, data.rotation + (TrackTransforms[i].rotation - data.rotation) * fWeight );
+    // Assign a slot to each valid identifier for which a target instance
+    // was supplied, and record the matching data from each track's set.
+    mBoundTargets.clear();
+    mBoundTargetData.clear();
+    for ( cgStringSet::iterator itTargetId = mValidTargetIds.begin(); itTargetId != mValidTargetIds.end(); ++itTargetId )
+    {
+        TargetMap::const_iterator itTarget = Targets.find( *itTargetId );
+        if ( itTarget == Targets.end() || !itTarget->second )
+            continue;
 
-                    // Weighted sum.
-                    data.translation += TrackTransforms[i].translation * (fWeight * fWeightTheta);
-                    data.scale += TrackTransforms[i].scale * (fWeight * fWeightTheta);
-                
-                } // End if applicable
-                
-            } // Next playing track
+        mBoundTargets.push_back( itTarget->second );
+        for ( size_t i = 0; i < nTrackCount; ++i )
+        {
+            cgAnimationSet * pSet = mTracks[i].boundSet;
+            mBoundTargetData.push_back( (pSet) ? pSet->getTargetData( *itTargetId ) : CG_NULL );
+        
+        } // Next track
 
-            // Compose final transform.
-            cgTransform t;
-            t.compose( data.scale,cgVector3( 0, 0, 0 ), data.rotation, data.translation );
+    } // Next identifier
 
-            // Apply this to the animation target
-            pTarget->onAnimationTransformUpdated( t );
+    // Size the pose buffer.
+    const size_t nSampleCount = mBoundTargetData.size();
+    mPoseScale.resize( nSampleCount );
+    mPoseRotation.resize( nSampleCount );
+    mPoseTranslation.resize( nSampleCount );
+    mPoseWeight.resize( nSampleCount );
 
-        } // End if found data
+    // Bindings are now up to date.
+    mBoundTargetMap   = &Targets;
+    mBoundTargetCount = Targets.size();
+    mTargetsDirty     = false;
+}
 
-    } // Next Animation Target
+//-----------------------------------------------------------------------------
+//  Name : invalidateTargets ()
+/// <summary>
+/// Inform the controller that the contents of the target map supplied to
+/// 'advanceTime()' have changed (targets added, removed or renamed) so that
+/// target bindings will be resolved again during the next update.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationController::invalidateTargets( )
+{
+    mTargetsDirty = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -266,6 +364,7 @@ void cgAnimationController::setTrackLimit( cgUInt16 nMaxTracks )
     if ( nMaxTracks == (cgUInt16)mTracks.size() )
         return;
     mTracks.resize( nMaxTracks );
+    mTargetsDirty = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -397,23 +496,8 @@ bool cgAnimationController::setTrackAnimationSet( cgUInt16 nTrack, const cgAnima
 
     } // End if no set
 
-    // Build a unique set of targets identifiers from all applied animation sets.
-    mValidTargetIds.clear();
-    for ( size_t i = 0; i < mTracks.size(); ++i )
-    {
-        cgAnimationSet * pSet = mTracks[i].set.getResource( true );
-        if ( pSet )
-        {
-            // Get a list of the registered targets and add any unique entries to our 
-            // list of currently *valid* target instance identifiers.
-            cgAnimationSet::TargetDataMap::const_iterator itTarget;
-            const cgAnimationSet::TargetDataMap & TargetData = pSet->getTargetData();
-            for ( itTarget = TargetData.begin(); itTarget != TargetData.end(); ++itTarget )
-                mValidTargetIds.insert( itTarget->first );
-
-        } // End if valid set
-
-    } // Next track
+    // Target bindings must be resolved again.
+    mTargetsDirty = true;
 
     // Success!
     return true;
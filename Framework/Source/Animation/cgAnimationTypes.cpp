@@ -389,6 +389,51 @@ void cgQuaternionAnimationChannel::addKey( cgInt32 frame, const cgQuaternion & q
     dirty = true;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : findSegment ()
+/// <summary>
+/// Locate the index of the key that begins the segment containing the 
+/// specified frame, which must lie between the first and last keys. The 
+/// search begins by stepping from the 'hint' key (if valid) for a small 
+/// number of keys in either direction, before falling back to a binary 
+/// search.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgInt32 cgQuaternionAnimationChannel::findSegment( cgFloat frame, cgInt32 hint ) const
+{
+    cgInt32 last = (cgInt32)data.size() - 1;
+
+    // Step from the hint. Because the frame is known to lie within the 
+    // channel, the cursor can never be stepped beyond the first or last key.
+    if ( hint >= 0 && hint < last )
+    {
+        for ( cgInt32 step = 0; step <= MaxCursorSteps; ++step )
+        {
+            if ( frame < (cgFloat)data[ hint ].frame )
+                --hint;
+            else if ( frame >= (cgFloat)data[ hint + 1 ].frame )
+                ++hint;
+            else
+                return hint;
+
+        } // Next step
+
+    } // End if valid hint
+
+    // Perform a binary search for the correct key.
+    cgInt32 first = 0;
+    while ( (last - first) > 1 )
+    {
+        const cgInt32 center = (first + last) / 2;
+        if ( frame < (cgFloat)data[ center ].frame )
+            last  = center;
+        else
+            first = center;
+
+    } // Next key
+    return first;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : deserialize ()
 /// <summary>
@@ -762,6 +807,30 @@ void cgPositionXYZTargetController::evaluate( cgDouble position, cgVector3 & p,
         p.z = default.z;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : evaluate ()
+/// <summary>
+/// Evaluate and retrieve the control value at the specified position / time
+/// using (and updating) the supplied array of three segment cursors, one for
+/// each channel. See 'cgBezierSpline2::evaluateWithCursor()' for more information.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgPositionXYZTargetController::evaluate( cgDouble position, cgVector3 & p, const cgVector3 & default, cgInt32 * cursors )
+{
+    if ( !mCurves[0].isEmpty() )
+        p.x = mCurves[0].data.evaluateWithCursor( (cgFloat)position, cursors[0], true );
+    else
+        p.x = default.x;
+    if ( !mCurves[1].isEmpty() )
+        p.y = mCurves[1].data.evaluateWithCursor( (cgFloat)position, cursors[1], true );
+    else
+        p.y = default.y;
+    if ( !mCurves[2].isEmpty() )
+        p.z = mCurves[2].data.evaluateWithCursor( (cgFloat)position, cursors[2], true );
+    else
+        p.z = default.z;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : addLinearKey ()
 /// <summary>
@@ -954,6 +1023,30 @@ void cgScaleXYZTargetController::evaluate( cgDouble position, cgVector3 & s, con
         s.z = default.z;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : evaluate ()
+/// <summary>
+/// Evaluate and retrieve the control value at the specified position / time
+/// using (and updating) the supplied array of three segment cursors, one for
+/// each channel. See 'cgBezierSpline2::evaluateWithCursor()' for more information.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScaleXYZTargetController::evaluate( cgDouble position, cgVector3 & s, const cgVector3 & default, cgInt32 * cursors )
+{
+    if ( !mCurves[0].isEmpty() )
+        s.x = mCurves[0].data.evaluateWithCursor( (cgFloat)position, cursors[0], true );
+    else
+        s.x = default.x;
+    if ( !mCurves[1].isEmpty() )
+        s.y = mCurves[1].data.evaluateWithCursor( (cgFloat)position, cursors[1], true );
+    else
+        s.y = default.y;
+    if ( !mCurves[2].isEmpty() )
+        s.z = mCurves[2].data.evaluateWithCursor( (cgFloat)position, cursors[2], true );
+    else
+        s.z = default.z;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : addLinearKey ()
 /// <summary>
@@ -1291,6 +1384,23 @@ bool cgQuaternionTargetController::deserializeChannel( cgWorldQuery & channelQue
 /// </summary>
 //-----------------------------------------------------------------------------
 void cgQuaternionTargetController::evaluate( cgDouble position, cgQuaternion & q, const cgQuaternion & default )
+{
+    cgInt32 nCursor = -1;
+    evaluate( position, q, default, nCursor );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : evaluate ()
+/// <summary>
+/// Evaluate and retrieve the control value at the specified position / time
+/// using (and updating) the supplied key cursor. The cursor records the 
+/// index of the key that begins the segment most recently evaluated and 
+/// allows the correct segment to be located by stepping forward or backward
+/// from it when the position changes only a little between calls. A cursor
+/// value of -1 forces a full search.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgQuaternionTargetController::evaluate( cgDouble position, cgQuaternion & q, const cgQuaternion & default, cgInt32 & cursor )
 {
     if ( mKeyFrames.isEmpty() )
     {
@@ -1305,85 +1415,41 @@ void cgQuaternionTargetController::evaluate( cgDouble position, cgQuaternion & q
     
     } // End if single key
 
-    // Find the correct segment for this X location
-    cgQuaternionAnimationChannel::QuaternionKeyArray & keys = mKeyFrames.data;
-    cgInt32 first  = 0;
-    cgInt32 last   = (cgInt32)keys.size() - 1;
-
-    // Compute boundaries for the two candidate keys
-    cgFloat x         = (cgFloat)position;
-    cgFloat firstKeyX = (cgFloat)keys[ first ].frame;
-    cgFloat lastKeyX  = (cgFloat)keys[ last ].frame;
-
     // Test to see if the position is out of range first of all
-    if ( x <= firstKeyX )
+    const cgQuaternionAnimationChannel::QuaternionKeyArray & keys = mKeyFrames.data;
+    const cgInt32 last = (cgInt32)keys.size() - 1;
+    const cgFloat x    = (cgFloat)position;
+    if ( x <= (cgFloat)keys[ 0 ].frame )
     {
-        q = cgQuaternion(keys[ first ].value);
+        cursor = 0;
+        q = cgQuaternion(keys[ 0 ].value);
         return;
     
     } // End if prior to first key
-    else if ( x >= lastKeyX )
+    else if ( x >= (cgFloat)keys[ last ].frame )
     {
+        cursor = last - 1;
         q = cgQuaternion(keys[ last ].value);
         return;
     
     } // End if after last key
+
+    // Find the correct segment for this X location
+    cursor = mKeyFrames.findSegment( x, cursor );
+    const cgQuaternionAnimationChannel::QuaternionKeyFrame & k1 = keys[cursor];
+    const cgQuaternionAnimationChannel::QuaternionKeyFrame & k2 = keys[cursor+1];
+    cgInt32 segmentDist = k2.frame - k1.frame;
+    if ( segmentDist <= 0 || x == (cgFloat)k1.frame )
+    {
+        q = cgQuaternion( k1.value );
+    
+    } // End if div0 / exact match
     else
     {
-        // Perform a binary search for the correct scale key starting in the middle
-        cgInt32 center = (first + last) / 2;
-        for ( ; ; )
-        {
-            // Have we reached the final two keys?
-            if ( (last - first) < 2 )
-            {
-                const cgQuaternionAnimationChannel::QuaternionKeyFrame & k1 = keys[first];
-                const cgQuaternionAnimationChannel::QuaternionKeyFrame & k2 = keys[last];
-                cgInt32 segmentDist = k2.frame - k1.frame;
-                if ( segmentDist < 0 )
-                {
-                    q = cgQuaternion( k1.value );
-                    return;
-                
-                } // End if div0
-                else
-                {
-                    cgFloat delta = (x - (cgFloat)k1.frame) / (cgFloat)segmentDist;
-                    cgQuaternion::slerp( q, k1.value, k2.value, delta );
-                    return;
-
-                } // End if !div0
-
-            } // End if final key
-            else
-            {
-                // Compute x for the center key
-                firstKeyX = (cgFloat)keys[ center ].frame;
-
-                if ( x < firstKeyX )
-                {
-                    last   = center;
-                    center = (first + last) / 2;
-                
-                } // End if prior to center key
-                else if ( x > firstKeyX )
-                {
-                    first  = center;
-                    center = (first + last) / 2;
-                
-                } // End if after center key
-                else
-                {
-                    q = cgQuaternion( keys[ center ].value );
-                    return;
-
-                } // End if exact match
-
-            } // End if more testing may be necessary
-
-        } // Next Key
-
-    } // End if not out of range
+        cgFloat delta = (x - (cgFloat)k1.frame) / (cgFloat)segmentDist;
+        cgQuaternion::slerp( q, k1.value, k2.value, delta );
+
+    } // End if !div0
 }
 
 //-----------------------------------------------------------------------------
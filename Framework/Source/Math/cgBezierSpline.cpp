@@ -44,7 +44,8 @@
 /// </summary>
 //-----------------------------------------------------------------------------
 cgBezierSpline2::cgBezierSpline2( ) :
-    mRange( 0, 1 ), mVariance(0), mLength(0), mComplexSpline(false)
+    mRange( 0, 1 ), mVariance(0), mLength(0), mComplexSpline(false), mTableType(NoLookupTable), 
+    mTableMaxError(0.001f), mTableMaxEntries(1024), mTableError(0), mTableScale(0)
 {
 	// Default to linear attenuation
     setDescription( LinearDecay );
@@ -57,7 +58,8 @@ cgBezierSpline2::cgBezierSpline2( ) :
 /// </summary>
 //-----------------------------------------------------------------------------
 cgBezierSpline2::cgBezierSpline2( const SplinePointArray & SplinePoints ) :
-    mRange(0,1), mVariance(0), mPoints(SplinePoints), mSplineDirty(true), mLength(0), mComplexSpline(false)    
+    mRange(0,1), mVariance(0), mPoints(SplinePoints), mSplineDirty(true), mLength(0), mComplexSpline(false),
+    mTableType(NoLookupTable), mTableMaxError(0.001f), mTableMaxEntries(1024), mTableError(0), mTableScale(0)
 {
 }
 
@@ -107,6 +109,13 @@ cgBezierSpline2 & cgBezierSpline2::operator=( const cgBezierSpline2 & Spline )
     mComplexSpline    = Spline.mComplexSpline;
     mRange            = Spline.mRange;
     mVariance         = Spline.mVariance;
+    mTableType        = Spline.mTableType;
+    mTableMaxError    = Spline.mTableMaxError;
+    mTableMaxEntries  = Spline.mTableMaxEntries;
+    mTableError       = Spline.mTableError;
+    mTableScale       = Spline.mTableScale;
+    mTableX           = Spline.mTableX;
+    mTableY           = Spline.mTableY;
     
     // Return reference to self in order to allow multiple assignments (i.e. a=b=c)
     return *this;
@@ -166,6 +175,8 @@ void cgBezierSpline2::clear( )
     // Resize array
     mPoints.clear();
     mPointDist.clear();
+    mTableX.clear();
+    mTableY.clear();
     mSplineDirty   = true;
     mComplexSpline = false;
 }
@@ -289,144 +300,226 @@ cgFloat cgBezierSpline2::evaluateForX( EvaluateMethod method, cgFloat x, cgFloat
 // Name : evaluateForX()
 /// <summary>
 /// Resolve the Y axis value for the given X axis distance. Note: This method
-/// will return an invalid result (NaN) if this is a complex spline.
+/// will return an invalid result (NaN) if this is a complex spline. If a 
+/// lookup table has been enabled (see 'setLookupTable()') the result is 
+/// interpolated from the table irrespective of the 'approximate' flag. 
+/// Evaluation is re-entrant and may be performed concurrently from multiple
+/// threads provided that the spline is not modified and has been prepared
+/// (see 'prepare()').
 /// </summary>
 //-----------------------------------------------------------------------------
 cgFloat cgBezierSpline2::evaluateForX( cgFloat x, bool bApproximate /* = false */, cgUInt16 nDigits /* = 4 */ )
 {
-    static SplinePoint pt1, pt2;
-    static cgUInt32 i, nSegment;
-
     // Recompute spline data if required.
     if ( mSplineDirty )
         updateSplineData();
     if ( mLength < CGE_EPSILON )
         return mPoints[0].point.y;
 
-    /*// Find the correct segment for this X location
-    for ( cgUInt32 i = 0; i < mPoints.size() - 1; ++i )
+    // Sample the lookup table if available.
+    if ( !mTableY.empty() )
     {
-        const SplinePoint & ptt1 = mPoints[i];
-        const SplinePoint & ptt2 = mPoints[i+1];
+        cgUInt32 nHint = 0;
+        return sampleLookupTable( x, nHint );
+    
+    } // End if has table
 
-        if ( x >= ptt1.point.x && x <= ptt2.point.x )
-        {
-            if ( bApproximate )
-            {
-                cgFloat fSegmentDist = (ptt2.point.x - ptt1.point.x);
-                if ( fSegmentDist < CGE_EPSILON )
-                    return evaluateSegment( i, 0.0f ).y;
-                else
-                    return evaluateSegment( i, (x - ptt1.point.x) / fSegmentDist ).y;
+    // Evaluate the curve directly.
+    return evaluateExact( x, bApproximate );
+}
 
-            } // End if approximate
-            else
-            {
-                pt1 = ptt1;
-                pt2 = ptt2;
-                nSegment = i;
-                break;
+//-----------------------------------------------------------------------------
+// Name : evaluate()
+/// <summary>
+/// Batch equivalent of 'evaluateForX()'. Resolves the Y axis value for each
+/// of the 'count' X axis values supplied, writing the results to 'ys'. When
+/// a lookup table is in use, supplying the X values in ascending order 
+/// allows each table interval to be located in constant time.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBezierSpline2::evaluate( const cgFloat * xs, cgFloat * ys, size_t nCount, bool bApproximate /* = false */ )
+{
+    // Recompute spline data if required.
+    if ( mSplineDirty )
+        updateSplineData();
+    if ( mLength < CGE_EPSILON )
+    {
+        for ( size_t i = 0; i < nCount; ++i )
+            ys[i] = mPoints[0].point.y;
+        return;
+    
+    } // End if degenerate
 
-            } // End if !approximate
-        
-        } // End if within segment range
+    // Sample the lookup table if available.
+    if ( !mTableY.empty() )
+    {
+        cgUInt32 nHint = 0;
+        for ( size_t i = 0; i < nCount; ++i )
+            ys[i] = sampleLookupTable( xs[i], nHint );
+        return;
     
-    } // Next Segment*/
+    } // End if has table
 
-    // Find the correct segment for this X location
-    cgInt32 nFirst  = 0;
-    cgInt32 nLast   = (cgInt32)mPoints.size() - 1;
+    // Evaluate the curve directly, carrying the segment cursor from one
+    // sample to the next.
+    cgInt32 nSegment = -1;
+    for ( size_t i = 0; i < nCount; ++i )
+        ys[i] = evaluateWithCursor( xs[i], nSegment, bApproximate );
+}
 
-    // Compute boundaries for the two candidate keys
-    cgFloat fFirstKeyX = mPoints[ nFirst ].point.x;
-    cgFloat fLastKeyX  = mPoints[ nLast ].point.x;
+//-----------------------------------------------------------------------------
+// Name : evaluateWithCursor()
+/// <summary>
+/// Resolve the Y axis value for the given X axis distance, using (and 
+/// updating) the supplied segment cursor to locate the relevant segment. 
+/// When successive X values are close together, as is the case during 
+/// playback of an animation curve, the segment can be located by stepping
+/// the cursor forward or backward by a small number of points rather than 
+/// searching the entire spline. A cursor value of -1 (or any other out of
+/// range value) forces a full search. Lookup tables, where enabled, are 
+/// sampled as normal and the cursor is left unaltered.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::evaluateWithCursor( cgFloat x, cgInt32 & nSegment, bool bApproximate /* = false */ )
+{
+    // Recompute spline data if required.
+    if ( mSplineDirty )
+        updateSplineData();
+    if ( mLength < CGE_EPSILON )
+        return mPoints[0].point.y;
+
+    // Sample the lookup table if available.
+    if ( !mTableY.empty() )
+    {
+        cgUInt32 nHint = 0;
+        return sampleLookupTable( x, nHint );
+    
+    } // End if has table
 
     // Test to see if the position is out of range first of all
-    if ( x <= fFirstKeyX )
+    const cgInt32 nLast = (cgInt32)mPoints.size() - 1;
+    if ( x <= mPoints[0].point.x )
     {
-        return mPoints[ nFirst ].point.y;
+        nSegment = 0;
+        return mPoints[0].point.y;
     
     } // End if prior to first key
-    else if ( x >= fLastKeyX )
+    else if ( x >= mPoints[nLast].point.x )
     {
-        return mPoints[ nLast ].point.y;
+        nSegment = nLast - 1;
+        return mPoints[nLast].point.y;
     
     } // End if after last key
-    else
+
+    // Locate the segment starting from the cursor and evaluate.
+    nSegment = findSegment( x, nSegment );
+    return evaluateSegmentForX( nSegment, x, bApproximate );
+}
+
+//-----------------------------------------------------------------------------
+// Name : evaluateExact() (Protected)
+/// <summary>
+/// Evaluate the curve directly (bypassing any lookup table) to resolve the Y
+/// axis value for the given X axis distance. Spline data must be up to date.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::evaluateExact( cgFloat x, bool bApproximate ) const
+{
+    // Test to see if the position is out of range first of all
+    const cgInt32 nLast = (cgInt32)mPoints.size() - 1;
+    if ( x <= mPoints[0].point.x )
+        return mPoints[0].point.y;
+    else if ( x >= mPoints[nLast].point.x )
+        return mPoints[nLast].point.y;
+
+    // Find the correct segment for this X location and evaluate.
+    return evaluateSegmentForX( findSegment( x, -1 ), x, bApproximate );
+}
+
+//-----------------------------------------------------------------------------
+// Name : findSegment() (Protected)
+/// <summary>
+/// Locate the segment containing the specified X axis distance, which must 
+/// lie between the first and last points of the spline. The search begins
+/// by stepping from the 'hint' segment (if valid) for a small number of 
+/// points in either direction, before falling back to a binary search.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgInt32 cgBezierSpline2::findSegment( cgFloat x, cgInt32 nHint ) const
+{
+    cgInt32 nLast = (cgInt32)mPoints.size() - 1;
+
+    // Step from the hint. Because x is known to lie within the spline, the 
+    // cursor can never be stepped beyond the first or last segment.
+    if ( nHint >= 0 && nHint < nLast )
     {
-        // Perform a binary search for the correct key starting in the middle
-        cgInt32 nCenter = (nFirst + nLast) / 2;
-        for ( ; ; )
+        for ( cgInt32 nStep = 0; nStep <= MaxCursorSteps; ++nStep )
         {
-            // Have we reached the final two keys?
-            if ( (nLast - nFirst) < 2 )
-            {
-                const SplinePoint & ptt1 = mPoints[nFirst];
-                const SplinePoint & ptt2 = mPoints[nLast];
-                if ( bApproximate )
-                {
-                    cgFloat fSegmentDist = (ptt2.point.x - ptt1.point.x);
-                    if ( fSegmentDist < CGE_EPSILON )
-                        return ptt1.point.y;
-                    else
-                    {
-                        // Note: Experiments with improving accuracy of the approximate sampling.
-                        /*const double t = (x - ptt1.point.x) / fSegmentDist;                        
-                        const double maxpow=4;
-                        const double s=t*2-1;
-                        const double lerpf=abs(s);
-                        const double finalpow = maxpow+((1-maxpow)*lerpf);
-                        const double f=1-pow(1-lerpf,finalpow);
-                        return evaluateSegment( nFirst, (s>0) ? (f/2)+0.5 : (-f/2)+0.5 ).y;*/
-
-                        return evaluateSegment( nFirst, (x - ptt1.point.x) / fSegmentDist ).y;
-                    }
-
-                } // End if approximate
-                else
-                {
-                    pt1 = ptt1;
-                    pt2 = ptt2;
-                    nSegment = nFirst;
-                    break;
+            if ( x < mPoints[ nHint ].point.x )
+                --nHint;
+            else if ( x >= mPoints[ nHint + 1 ].point.x )
+                ++nHint;
+            else
+                return nHint;
 
-                } // End if !approximate
+        } // Next step
 
-            } // End if final key
-            else
-            {
-                // Comput x for the center key
-                fFirstKeyX = mPoints[ nCenter ].point.x;
+    } // End if valid hint
 
-                if ( x < fFirstKeyX )
-                {
-                    nLast   = nCenter;
-                    nCenter = (nFirst + nLast) / 2;
-                
-                } // End if prior to center key
-                else if ( x > fFirstKeyX )
-                {
-                    nFirst  = nCenter;
-                    nCenter = (nFirst + nLast) / 2;
-                
-                } // End if after center key
-                else
-                {
-                    return mPoints[ nCenter ].point.y;
+    // Perform a binary search for the correct key.
+    cgInt32 nFirst = 0;
+    while ( (nLast - nFirst) > 1 )
+    {
+        const cgInt32 nCenter = (nFirst + nLast) / 2;
+        if ( x < mPoints[ nCenter ].point.x )
+            nLast  = nCenter;
+        else
+            nFirst = nCenter;
+
+    } // Next key
+    return nFirst;
+}
 
-                } // End if exact match
+//-----------------------------------------------------------------------------
+// Name : evaluateSegmentForX() (Protected)
+/// <summary>
+/// Resolve the Y axis value for the given X axis distance, which must lie 
+/// within the specified segment. Spline data must be up to date.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::evaluateSegmentForX( cgInt32 nSegment, cgFloat x, bool bApproximate ) const
+{
+    const SplinePoint * pt1 = &mPoints[nSegment];
+    const SplinePoint * pt2 = &mPoints[nSegment+1];
 
-            } // End if more testing may be necessary
+    // Exact match?
+    if ( x == pt1->point.x )
+        return pt1->point.y;
 
-        } // Next Key
+    if ( bApproximate )
+    {
+        cgFloat fSegmentDist = (pt2->point.x - pt1->point.x);
+        if ( fSegmentDist < CGE_EPSILON )
+            return pt1->point.y;
+        
+        // Note: Experiments with improving accuracy of the approximate sampling.
+        /*const double t = (x - pt1->point.x) / fSegmentDist;                        
+        const double maxpow=4;
+        const double s=t*2-1;
+        const double lerpf=abs(s);
+        const double finalpow = maxpow+((1-maxpow)*lerpf);
+        const double f=1-pow(1-lerpf,finalpow);
+        return evaluateSegment( nSegment, (s>0) ? (f/2)+0.5 : (-f/2)+0.5 ).y;*/
+
+        return evaluateSegment( nSegment, (x - pt1->point.x) / fSegmentDist ).y;
 
-    } // End if not out of range
+    } // End if approximate
 
     // Compute equation coefficients (could be stored, but saves a significant amount of memory this way).
-    const cgDouble d = pt1.point.x - x;
-    const cgDouble c = 3.0 * (pt1.controlPointOut.x - pt1.point.x);
-    const cgDouble b = 3.0 * (pt2.controlPointIn.x - pt1.controlPointOut.x) - c;
-    const cgDouble a = pt2.point.x - pt1.point.x - c - b;
+    const cgDouble d = pt1->point.x - x;
+    const cgDouble c = 3.0 * (pt1->controlPointOut.x - pt1->point.x);
+    const cgDouble b = 3.0 * (pt2->controlPointIn.x - pt1->controlPointOut.x) - c;
+    const cgDouble a = pt2->point.x - pt1->point.x - c - b;
 
     // Solve the cubic equation (or potentially fall back to quadratic if a==0)
     cgInt nRootsFound;
@@ -458,10 +551,8 @@ cgFloat cgBezierSpline2::evaluateForX( cgFloat x, bool bApproximate /* = false *
 //-----------------------------------------------------------------------------
 cgVector2 cgBezierSpline2::evaluate( cgFloat t )
 {
-    static cgFloat      BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
-    static SplinePoint  pt1, pt2;
-    static cgFloat      t2, t3;
-    static cgUInt32     i;
+    static const cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
+    cgUInt32 nSegment = 0;
 
     // Note: While not a perfect method, this gives us the closest approximation of 
     // the original evaluateSegment (and MAX).    
@@ -480,13 +571,12 @@ cgVector2 cgBezierSpline2::evaluate( cgFloat t )
 
     // Find the two bounding points.
     t *= mLength;
-    for ( i = 0; i < mPoints.size() - 1; ++i )
+    for ( cgUInt32 i = 0; i < mPoints.size() - 1; ++i )
     {
         cgFloat fSegmentLength = (mPointDist[i+1] - mPointDist[i]);
         if ( t >= mPointDist[i] && t <= mPointDist[i+1] )
         {
-            pt1 = mPoints[i];
-            pt2 = mPoints[i+1];
+            nSegment = i;
             t -= mPointDist[i];
             if ( fSegmentLength > CGE_EPSILON )
                 t /= fSegmentLength;
@@ -497,7 +587,9 @@ cgVector2 cgBezierSpline2::evaluate( cgFloat t )
     } // Next Segment
 
     // Bezier Evaluate
-    t2 = t*t; t3 = t2*t;
+    const SplinePoint & pt1 = mPoints[nSegment];
+    const SplinePoint & pt2 = mPoints[nSegment+1];
+    const cgFloat t2 = t*t, t3 = t2*t;
     return pt1.point           * (BezierBasis[0][0]*t3 + BezierBasis[1][0]*t2 + BezierBasis[2][0]*t + BezierBasis[3][0]) +
            pt1.controlPointOut * (BezierBasis[0][1]*t3 + BezierBasis[1][1]*t2 + BezierBasis[2][1]*t + BezierBasis[3][1]) + 
            pt2.controlPointIn  * (BezierBasis[0][2]*t3 + BezierBasis[1][2]*t2 + BezierBasis[2][2]*t + BezierBasis[3][2]) + 
@@ -512,17 +604,16 @@ cgVector2 cgBezierSpline2::evaluate( cgFloat t )
 /// segment.
 /// </summary>
 //-----------------------------------------------------------------------------
-cgVector2 cgBezierSpline2::evaluateSegment( cgInt32 nSegment, cgFloat t )
+cgVector2 cgBezierSpline2::evaluateSegment( cgInt32 nSegment, cgFloat t ) const
 {
-    static cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
-    static cgFloat t2, t3;
+    static const cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
 
     // Extract segment points
     const SplinePoint & pt1 = mPoints[nSegment];
     const SplinePoint & pt2 = mPoints[nSegment+1];
     
     // Bezier Evaluate
-    t2 = t*t; t3 = t2*t;
+    const cgFloat t2 = t*t, t3 = t2*t;
     return pt1.point           * (BezierBasis[0][0]*t3 + BezierBasis[1][0]*t2 + BezierBasis[2][0]*t + BezierBasis[3][0]) +
            pt1.controlPointOut * (BezierBasis[0][1]*t3 + BezierBasis[1][1]*t2 + BezierBasis[2][1]*t + BezierBasis[3][1]) + 
            pt2.controlPointIn  * (BezierBasis[0][2]*t3 + BezierBasis[1][2]*t2 + BezierBasis[2][2]*t + BezierBasis[3][2]) + 
@@ -601,6 +692,271 @@ void cgBezierSpline2::updateSplineData()
 
     // Spline data is no longer dirty
     mSplineDirty = false;
+
+    // Rebuild the lookup table if one was requested.
+    buildLookupTable();
+}
+
+//-----------------------------------------------------------------------------
+// Name : prepare ()
+/// <summary>
+/// Ensure that any cached spline data (including the lookup table where 
+/// enabled) is up to date. Once prepared, and for as long as the spline is 
+/// not modified, the spline can be evaluated concurrently from multiple 
+/// threads.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBezierSpline2::prepare( )
+{
+    if ( mSplineDirty )
+        updateSplineData();
+}
+
+//-----------------------------------------------------------------------------
+// Name : setLookupTable ()
+/// <summary>
+/// Enable or disable the use of a precomputed lookup table when evaluating
+/// the spline for X. The table is constructed such that the linearly
+/// interpolated result differs from direct evaluation by no more than the
+/// specified maximum error (as measured at intermediate sample points), 
+/// unless this would require more than the specified number of entries. 
+/// Uniform tables offer constant time lookup, while adaptive tables place 
+/// entries only where the curvature requires them. The table is rebuilt 
+/// automatically whenever the spline is modified. Complex splines cannot be
+/// tabulated and are always evaluated directly.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBezierSpline2::setLookupTable( LookupTableType type, cgFloat maximumError /* = 0.001f */, cgUInt32 maximumEntries /* = 1024 */ )
+{
+    mTableType       = type;
+    mTableMaxError   = maximumError;
+    mTableMaxEntries = max( (cgUInt32)2, maximumEntries );
+    if ( mSplineDirty )
+        updateSplineData();
+    else
+        buildLookupTable();
+}
+
+//-----------------------------------------------------------------------------
+// Name : getLookupTableType ()
+/// <summary>
+/// Retrieve the type of lookup table requested for this spline.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgBezierSpline2::LookupTableType cgBezierSpline2::getLookupTableType( ) const
+{
+    return mTableType;
+}
+
+//-----------------------------------------------------------------------------
+// Name : getLookupTableSize ()
+/// <summary>
+/// Retrieve the number of entries in the current lookup table (zero if the
+/// spline is being evaluated directly).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgBezierSpline2::getLookupTableSize( ) const
+{
+    return (cgUInt32)mTableY.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : getLookupTableError ()
+/// <summary>
+/// Retrieve the maximum error measured between the current lookup table
+/// and direct evaluation of the spline.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::getLookupTableError( ) const
+{
+    return mTableError;
+}
+
+//-----------------------------------------------------------------------------
+// Name : buildLookupTable () (Protected)
+/// <summary>
+/// Construct the lookup table of the requested type. Spline data must be up
+/// to date.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBezierSpline2::buildLookupTable( )
+{
+    mTableX.clear();
+    mTableY.clear();
+    mTableError = 0;
+    mTableScale = 0;
+
+    // Can the spline be tabulated?
+    if ( mTableType == NoLookupTable || mComplexSpline || mLength < CGE_EPSILON || mPoints.size() < 2 )
+        return;
+    const cgFloat fMinX = mPoints.front().point.x;
+    const cgFloat fMaxX = mPoints.back().point.x;
+    if ( fMaxX - fMinX < CGE_EPSILON )
+        return;
+
+    if ( mTableType == UniformLookupTable )
+    {
+        // Double the table resolution until the error is acceptable.
+        for ( cgUInt32 nEntries = min( (cgUInt32)17, mTableMaxEntries ); ; nEntries = min( nEntries * 2 - 1, mTableMaxEntries ) )
+        {
+            mTableX.resize( nEntries );
+            mTableY.resize( nEntries );
+            for ( cgUInt32 i = 0; i < nEntries; ++i )
+            {
+                mTableX[i] = fMinX + (fMaxX - fMinX) * ((cgFloat)i / (cgFloat)(nEntries - 1));
+                mTableY[i] = evaluateExact( mTableX[i], false );
+            
+            } // Next entry
+
+            // Measure the interpolation error.
+            mTableError = 0;
+            for ( cgUInt32 i = 0; i < nEntries - 1; ++i )
+                mTableError = max( mTableError, measureInterval( mTableX[i], mTableY[i], mTableX[i+1], mTableY[i+1], CG_NULL ) );
+            if ( mTableError <= mTableMaxError || nEntries >= mTableMaxEntries )
+                break;
+
+        } // Next resolution
+        mTableScale = (cgFloat)(mTableX.size() - 1) / (fMaxX - fMinX);
+
+    } // End if uniform
+    else
+    {
+        // Each spline segment is refined independently so that table 
+        // entries always coincide with the curve's control points.
+        cgUInt32 nBudget = (mTableMaxEntries > mPoints.size()) ? mTableMaxEntries - (cgUInt32)mPoints.size() : 0;
+        mTableX.push_back( fMinX );
+        mTableY.push_back( evaluateExact( fMinX, false ) );
+        for ( size_t i = 1; i < mPoints.size(); ++i )
+        {
+            const cgFloat x = mPoints[i].point.x;
+            if ( x - mTableX.back() < CGE_EPSILON )
+                continue;
+            refineLookupTable( mTableX.back(), mTableY.back(), x, evaluateExact( x, false ), 0, nBudget );
+
+        } // Next segment
+
+    } // End if adaptive
+
+    // Discard the table if the curve could not be evaluated everywhere.
+    for ( size_t i = 0; i < mTableY.size(); ++i )
+    {
+        if ( _isnan( mTableY[i] ) )
+        {
+            mTableX.clear();
+            mTableY.clear();
+            mTableError = 0;
+            mTableScale = 0;
+            return;
+        
+        } // End if invalid
+    
+    } // Next entry
+}
+
+//-----------------------------------------------------------------------------
+// Name : refineLookupTable () (Protected)
+/// <summary>
+/// Recursively subdivide the specified interval of an adaptive lookup table
+/// until the interpolation error is acceptable (or the entry budget is 
+/// exhausted) and append the resulting entries.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBezierSpline2::refineLookupTable( cgFloat x0, cgFloat y0, cgFloat x1, cgFloat y1, cgInt32 nDepth, cgUInt32 & nBudget )
+{
+    // Maximum subdivision depth for any one segment
+    const cgInt32 MaxDepth = 16;
+
+    cgFloat fMidY;
+    cgFloat fError = measureInterval( x0, y0, x1, y1, &fMidY );
+    if ( !(fError <= mTableMaxError) && nDepth < MaxDepth && nBudget > 0 )
+    {
+        // Each subdivision adds exactly one entry.
+        const cgFloat fMidX = (x0 + x1) * 0.5f;
+        --nBudget;
+        refineLookupTable( x0, y0, fMidX, fMidY, nDepth + 1, nBudget );
+        refineLookupTable( fMidX, fMidY, x1, y1, nDepth + 1, nBudget );
+        return;
+    
+    } // End if subdivide
+
+    // Accept this interval.
+    mTableError = max( mTableError, fError );
+    mTableX.push_back( x1 );
+    mTableY.push_back( y1 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : measureInterval () (Protected)
+/// <summary>
+/// Measure the maximum difference between linear interpolation across the 
+/// specified interval and direct evaluation of the spline, sampled at the
+/// interval's quarter points. Optionally returns the value at the midpoint.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::measureInterval( cgFloat x0, cgFloat y0, cgFloat x1, cgFloat y1, cgFloat * pMidY ) const
+{
+    cgFloat fError = 0;
+    for ( cgInt i = 1; i < 4; ++i )
+    {
+        const cgFloat s = (cgFloat)i * 0.25f;
+        const cgFloat y = evaluateExact( x0 + (x1 - x0) * s, false );
+        const cgFloat e = fabsf( y - (y0 + (y1 - y0) * s) );
+        if ( _isnan( e ) )
+            fError = std::numeric_limits<cgFloat>::infinity();
+        else if ( e > fError )
+            fError = e;
+        if ( i == 2 && pMidY )
+            *pMidY = y;
+    
+    } // Next sample
+    return fError;
+}
+
+//-----------------------------------------------------------------------------
+// Name : sampleLookupTable () (Protected)
+/// <summary>
+/// Linearly interpolate the lookup table at the specified X location. The 
+/// hint records the table interval most recently used; it is checked (along
+/// with the interval that follows) before resorting to a binary search so
+/// that monotonically increasing sample sequences are resolved in constant
+/// time.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgBezierSpline2::sampleLookupTable( cgFloat x, cgUInt32 & nHint ) const
+{
+    const cgUInt32 nLast = (cgUInt32)mTableX.size() - 1;
+    if ( x <= mTableX[0] )
+        return mTableY[0];
+    if ( x >= mTableX[nLast] )
+        return mTableY[nLast];
+
+    // Find the interval containing x.
+    cgUInt32 i;
+    if ( mTableScale > 0 )
+    {
+        i = min( (cgUInt32)((x - mTableX[0]) * mTableScale), nLast - 1 );
+    
+    } // End if uniform
+    else if ( nHint < nLast && x >= mTableX[nHint] && x < mTableX[nHint+1] )
+    {
+        i = nHint;
+    
+    } // End if same interval
+    else if ( nHint + 1 < nLast && x >= mTableX[nHint+1] && x < mTableX[nHint+2] )
+    {
+        i = nHint + 1;
+    
+    } // End if next interval
+    else
+    {
+        i = (cgUInt32)(std::upper_bound( mTableX.begin(), mTableX.end(), x ) - mTableX.begin()) - 1;
+    
+    } // End if search
+    nHint = i;
+
+    // Interpolate
+    const cgFloat s = (x - mTableX[i]) / (mTableX[i+1] - mTableX[i]);
+    return mTableY[i] + (mTableY[i+1] - mTableY[i]) * s;
 }
 
 //-----------------------------------------------------------------------------
@@ -738,6 +1094,8 @@ const cgBezierSpline2::SplinePoint & cgBezierSpline2::getPoint( cgInt32 nIndex )
 //-----------------------------------------------------------------------------
 cgBezierSpline2::SplinePoint & cgBezierSpline2::getPoint( cgInt32 nIndex )
 {
+    // The point may be modified through the returned reference.
+    mSplineDirty = true;
     return mPoints[nIndex];
 }
 
@@ -1129,10 +1487,8 @@ void cgBezierSpline3::clear( )
 //-----------------------------------------------------------------------------
 cgVector3 cgBezierSpline3::evaluate( cgFloat t )
 {
-    static cgFloat      BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
-    static SplinePoint  pt1, pt2;
-    static cgFloat      t2, t3;
-    static cgUInt32     i;
+    static const cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
+    cgUInt32 nSegment = 0;
 
     // Note: While not a perfect method, this gives us the closest approximation of 
     // the original evaluateSegment (and MAX).    
@@ -1151,13 +1507,12 @@ cgVector3 cgBezierSpline3::evaluate( cgFloat t )
 
     // Find the two bounding points.
     t *= mLength;
-    for ( i = 0; i < mPoints.size() - 1; ++i )
+    for ( cgUInt32 i = 0; i < mPoints.size() - 1; ++i )
     {
         cgFloat fSegmentLength = (mPointDist[i+1] - mPointDist[i]);
         if ( t >= mPointDist[i] && t <= mPointDist[i+1] )
         {
-            pt1 = mPoints[i];
-            pt2 = mPoints[i+1];
+            nSegment = i;
             t -= mPointDist[i];
             if ( fSegmentLength > CGE_EPSILON )
                 t /= fSegmentLength;
@@ -1168,7 +1523,9 @@ cgVector3 cgBezierSpline3::evaluate( cgFloat t )
     } // Next Segment
 
     // Bezier Evaluate
-    t2 = t*t; t3 = t2*t;
+    const SplinePoint & pt1 = mPoints[nSegment];
+    const SplinePoint & pt2 = mPoints[nSegment+1];
+    const cgFloat t2 = t*t, t3 = t2*t;
     return pt1.point           * (BezierBasis[0][0]*t3 + BezierBasis[1][0]*t2 + BezierBasis[2][0]*t + BezierBasis[3][0]) +
            pt1.controlPointOut * (BezierBasis[0][1]*t3 + BezierBasis[1][1]*t2 + BezierBasis[2][1]*t + BezierBasis[3][1]) + 
            pt2.controlPointIn  * (BezierBasis[0][2]*t3 + BezierBasis[1][2]*t2 + BezierBasis[2][2]*t + BezierBasis[3][2]) + 
@@ -1183,17 +1540,16 @@ cgVector3 cgBezierSpline3::evaluate( cgFloat t )
 /// segment.
 /// </summary>
 //-----------------------------------------------------------------------------
-cgVector3 cgBezierSpline3::evaluateSegment( cgInt32 nSegment, cgFloat t )
+cgVector3 cgBezierSpline3::evaluateSegment( cgInt32 nSegment, cgFloat t ) const
 {
-    static cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
-    static cgFloat t2, t3;
+    static const cgFloat BezierBasis[4][4] = { {-1,  3, -3, 1}, { 3, -6,  3, 0}, {-3,  3,  0, 0}, { 1,  0,  0, 0}};
 
     // Extract segment points
     const SplinePoint & pt1 = mPoints[nSegment];
     const SplinePoint & pt2 = mPoints[nSegment+1];
     
     // Bezier Evaluate
-    t2 = t*t; t3 = t2*t;
+    const cgFloat t2 = t*t, t3 = t2*t;
     return pt1.point           * (BezierBasis[0][0]*t3 + BezierBasis[1][0]*t2 + BezierBasis[2][0]*t + BezierBasis[3][0]) +
            pt1.controlPointOut * (BezierBasis[0][1]*t3 + BezierBasis[1][1]*t2 + BezierBasis[2][1]*t + BezierBasis[3][1]) + 
            pt2.controlPointIn  * (BezierBasis[0][2]*t3 + BezierBasis[1][2]*t2 + BezierBasis[2][2]*t + BezierBasis[3][2]) + 
@@ -0,0 +1,1375 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgMathNative.cpp                                                   //
+//                                                                           //
+// Desc : Portable, self contained implementation of the core math type      //
+//        operations (matrix, vector, quaternion and plane) used in place of //
+//        D3DX when CGE_NATIVE_MATH is defined.                              //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgMathNative Module Includes
+//-----------------------------------------------------------------------------
+#include <Math/cgMathNative.h>
+#include <Math/cgMathTypes.h>
+#include <math.h>
+#if defined(CGE_MATH_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+// Small helpers used by the native implementation. These deliberately avoid
+// calling back into the public math type wrappers so that this module behaves
+// identically irrespective of the backend the wrappers are configured to use.
+namespace NativeMath
+{
+    inline cgFloat dot3( const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    }
+
+    inline cgFloat dot4( const cgQuaternion & q1, const cgQuaternion & q2 )
+    {
+        return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+    }
+
+    inline void cross3( cgVector3 & out, const cgVector3 & v1, const cgVector3 & v2 )
+    {
+        cgVector3 v( v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x );
+        out = v;
+    }
+
+    inline void normalize3( cgVector3 & out, const cgVector3 & v )
+    {
+        const cgFloat length = sqrtf( dot3( v, v ) );
+        if ( length == 0.0f )
+            out = cgVector3( 0, 0, 0 );
+        else
+            out = cgVector3( v.x / length, v.y / length, v.z / length );
+    }
+
+    inline void identity( cgMatrix & out )
+    {
+        out = cgMatrix( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );
+    }
+
+    inline void translation( cgMatrix & out, cgFloat x, cgFloat y, cgFloat z )
+    {
+        out = cgMatrix( 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1 );
+    }
+
+    // Generic strided row-vector * matrix transform used by the vector 4 and
+    // plane array transforms (both are treated as homogeneous row vectors).
+    void transformArray4( cgFloat * out, cgUInt32 outStride, const cgFloat * in, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+    {
+        cgByte * dst = (cgByte*)out;
+        const cgByte * src = (const cgByte*)in;
+#if defined(CGE_MATH_SIMD_SSE2)
+        const __m128 r0 = _mm_loadu_ps( m.m[0] );
+        const __m128 r1 = _mm_loadu_ps( m.m[1] );
+        const __m128 r2 = _mm_loadu_ps( m.m[2] );
+        const __m128 r3 = _mm_loadu_ps( m.m[3] );
+        for ( cgUInt32 i = 0; i < count; ++i, dst += outStride, src += inStride )
+        {
+            const cgFloat * v = (const cgFloat*)src;
+            __m128 r = _mm_mul_ps( _mm_set1_ps( v[0] ), r0 );
+            r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v[1] ), r1 ) );
+            r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v[2] ), r2 ) );
+            r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( v[3] ), r3 ) );
+            _mm_storeu_ps( (cgFloat*)dst, r );
+        
+        } // Next element
+#else // CGE_MATH_SIMD_SSE2
+        for ( cgUInt32 i = 0; i < count; ++i, dst += outStride, src += inStride )
+        {
+            const cgFloat * v = (const cgFloat*)src;
+            const cgFloat x = v[0], y = v[1], z = v[2], w = v[3];
+            cgFloat * o = (cgFloat*)dst;
+            o[0] = m._11 * x + m._21 * y + m._31 * z + m._41 * w;
+            o[1] = m._12 * x + m._22 * y + m._32 * z + m._42 * w;
+            o[2] = m._13 * x + m._23 * y + m._33 * z + m._43 * w;
+            o[3] = m._14 * x + m._24 * y + m._34 * z + m._44 * w;
+        
+        } // Next element
+#endif // !CGE_MATH_SIMD_SSE2
+    }
+
+}; // End Namespace : NativeMath
+
+///////////////////////////////////////////////////////////////////////////////
+// cgMathNative Backend Information
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : getInstructionSet ()
+/// <summary>
+/// Retrieve the name of the instruction set that the native math
+/// implementation was compiled against (for diagnostic purposes).
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgChar * cgMathNative::getInstructionSet( )
+{
+#if defined(CGE_MATH_SIMD_AVX)
+    return "AVX";
+#elif defined(CGE_MATH_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgMathNative Matrix Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : matrixIsIdentity ()
+/// <summary>
+/// Determine if the specified matrix is exactly identity.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgMathNative::matrixIsIdentity( const cgMatrix & m )
+{
+    return m._11 == 1.0f && m._12 == 0.0f && m._13 == 0.0f && m._14 == 0.0f &&
+           m._21 == 0.0f && m._22 == 1.0f && m._23 == 0.0f && m._24 == 0.0f &&
+           m._31 == 0.0f && m._32 == 0.0f && m._33 == 1.0f && m._34 == 0.0f &&
+           m._41 == 0.0f && m._42 == 0.0f && m._43 == 0.0f && m._44 == 1.0f;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixMultiply ()
+/// <summary>
+/// Compute the product of two matrices (m1 * m2). The output matrix may
+/// safely alias either of the input matrices.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixMultiply( cgMatrix & out, const cgMatrix & m1, const cgMatrix & m2 )
+{
+#if defined(CGE_MATH_SIMD_AVX)
+    // Two rows of 'm1' are processed per instruction against the rows of 'm2'
+    // duplicated into both 128 bit lanes.
+    const __m256 b0 = _mm256_broadcast_ps( (const __m128*)m2.m[0] );
+    const __m256 b1 = _mm256_broadcast_ps( (const __m128*)m2.m[1] );
+    const __m256 b2 = _mm256_broadcast_ps( (const __m128*)m2.m[2] );
+    const __m256 b3 = _mm256_broadcast_ps( (const __m128*)m2.m[3] );
+    const __m256 a01 = _mm256_loadu_ps( m1.m[0] );
+    const __m256 a23 = _mm256_loadu_ps( m1.m[2] );
+    __m256 r01 = _mm256_mul_ps( _mm256_permute_ps( a01, 0x00 ), b0 );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( _mm256_permute_ps( a01, 0x55 ), b1 ) );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( _mm256_permute_ps( a01, 0xAA ), b2 ) );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( _mm256_permute_ps( a01, 0xFF ), b3 ) );
+    __m256 r23 = _mm256_mul_ps( _mm256_permute_ps( a23, 0x00 ), b0 );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( _mm256_permute_ps( a23, 0x55 ), b1 ) );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( _mm256_permute_ps( a23, 0xAA ), b2 ) );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( _mm256_permute_ps( a23, 0xFF ), b3 ) );
+    _mm256_storeu_ps( out.m[0], r01 );
+    _mm256_storeu_ps( out.m[2], r23 );
+
+#elif defined(CGE_MATH_SIMD_SSE2)
+    const __m128 b0 = _mm_loadu_ps( m2.m[0] );
+    const __m128 b1 = _mm_loadu_ps( m2.m[1] );
+    const __m128 b2 = _mm_loadu_ps( m2.m[2] );
+    const __m128 b3 = _mm_loadu_ps( m2.m[3] );
+    __m128 rows[4];
+    for ( cgInt i = 0; i < 4; ++i )
+    {
+        const __m128 a = _mm_loadu_ps( m1.m[i] );
+        __m128 r = _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(0,0,0,0) ), b0 );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(1,1,1,1) ), b1 ) );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(2,2,2,2) ), b2 ) );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(3,3,3,3) ), b3 ) );
+        rows[i] = r;
+    
+    } // Next row
+
+    // Store only once all rows are computed (inputs may alias output).
+    for ( cgInt i = 0; i < 4; ++i )
+        _mm_storeu_ps( out.m[i], rows[i] );
+
+#else // CGE_MATH_SIMD_SSE2
+    cgMatrix r;
+    for ( cgInt i = 0; i < 4; ++i )
+    {
+        for ( cgInt j = 0; j < 4; ++j )
+            r.m[i][j] = m1.m[i][0] * m2.m[0][j] + m1.m[i][1] * m2.m[1][j] + m1.m[i][2] * m2.m[2][j] + m1.m[i][3] * m2.m[3][j];
+    
+    } // Next row
+    out = r;
+
+#endif // !CGE_MATH_SIMD_SSE2
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixMultiplyArray ()
+/// <summary>
+/// Compute the product of each pair of matrices in the supplied arrays such
+/// that out[i] = m1[i] * m2[i].
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixMultiplyArray( cgMatrix * out, const cgMatrix * m1, const cgMatrix * m2, size_t count )
+{
+    for ( size_t i = 0; i < count; ++i )
+        matrixMultiply( out[i], m1[i], m2[i] );
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixInverse ()
+/// <summary>
+/// Compute the inverse of the specified matrix using cofactor expansion.
+/// Returns CG_NULL (leaving 'out' untouched) if the matrix is singular.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixInverse( cgMatrix & out, cgFloat * determinantOut, const cgMatrix & m )
+{
+    const cgFloat * a = &m._11;
+    cgFloat inv[16];
+
+    // 2x2 sub-determinants shared between the cofactors.
+    const cgFloat s0 = a[0] * a[5]  - a[4]  * a[1];
+    const cgFloat s1 = a[0] * a[6]  - a[4]  * a[2];
+    const cgFloat s2 = a[0] * a[7]  - a[4]  * a[3];
+    const cgFloat s3 = a[1] * a[6]  - a[5]  * a[2];
+    const cgFloat s4 = a[1] * a[7]  - a[5]  * a[3];
+    const cgFloat s5 = a[2] * a[7]  - a[6]  * a[3];
+    const cgFloat c5 = a[10] * a[15] - a[14] * a[11];
+    const cgFloat c4 = a[9]  * a[15] - a[13] * a[11];
+    const cgFloat c3 = a[9]  * a[14] - a[13] * a[10];
+    const cgFloat c2 = a[8]  * a[15] - a[12] * a[11];
+    const cgFloat c1 = a[8]  * a[14] - a[12] * a[10];
+    const cgFloat c0 = a[8]  * a[13] - a[12] * a[9];
+
+    // Compute determinant and bail if the matrix is singular.
+    const cgFloat determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if ( determinantOut )
+        *determinantOut = determinant;
+    if ( determinant == 0.0f )
+        return CG_NULL;
+    const cgFloat invDet = 1.0f / determinant;
+
+    // Build the adjugate scaled by the reciprocal determinant.
+    inv[0]  = ( a[5]  * c5 - a[6]  * c4 + a[7]  * c3) * invDet;
+    inv[1]  = (-a[1]  * c5 + a[2]  * c4 - a[3]  * c3) * invDet;
+    inv[2]  = ( a[13] * s5 - a[14] * s4 + a[15] * s3) * invDet;
+    inv[3]  = (-a[9]  * s5 + a[10] * s4 - a[11] * s3) * invDet;
+    inv[4]  = (-a[4]  * c5 + a[6]  * c2 - a[7]  * c1) * invDet;
+    inv[5]  = ( a[0]  * c5 - a[2]  * c2 + a[3]  * c1) * invDet;
+    inv[6]  = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * invDet;
+    inv[7]  = ( a[8]  * s5 - a[10] * s2 + a[11] * s1) * invDet;
+    inv[8]  = ( a[4]  * c4 - a[5]  * c2 + a[7]  * c0) * invDet;
+    inv[9]  = (-a[0]  * c4 + a[1]  * c2 - a[3]  * c0) * invDet;
+    inv[10] = ( a[12] * s4 - a[13] * s2 + a[15] * s0) * invDet;
+    inv[11] = (-a[8]  * s4 + a[9]  * s2 - a[11] * s0) * invDet;
+    inv[12] = (-a[4]  * c3 + a[5]  * c1 - a[6]  * c0) * invDet;
+    inv[13] = ( a[0]  * c3 - a[1]  * c1 + a[2]  * c0) * invDet;
+    inv[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * invDet;
+    inv[15] = ( a[8]  * s3 - a[9]  * s1 + a[10] * s0) * invDet;
+    memcpy( &out._11, inv, sizeof(inv) );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixTranspose ()
+/// <summary>
+/// Compute the transpose of the specified matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixTranspose( cgMatrix & out, const cgMatrix & m )
+{
+#if defined(CGE_MATH_SIMD_SSE2)
+    __m128 r0 = _mm_loadu_ps( m.m[0] );
+    __m128 r1 = _mm_loadu_ps( m.m[1] );
+    __m128 r2 = _mm_loadu_ps( m.m[2] );
+    __m128 r3 = _mm_loadu_ps( m.m[3] );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+    _mm_storeu_ps( out.m[0], r0 );
+    _mm_storeu_ps( out.m[1], r1 );
+    _mm_storeu_ps( out.m[2], r2 );
+    _mm_storeu_ps( out.m[3], r3 );
+#else // CGE_MATH_SIMD_SSE2
+    const cgMatrix r( m._11, m._21, m._31, m._41,
+                      m._12, m._22, m._32, m._42,
+                      m._13, m._23, m._33, m._43,
+                      m._14, m._24, m._34, m._44 );
+    out = r;
+#endif // !CGE_MATH_SIMD_SSE2
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixDeterminant ()
+/// <summary>
+/// Compute the determinant of the specified matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgMathNative::matrixDeterminant( const cgMatrix & m )
+{
+    const cgFloat * a = &m._11;
+    const cgFloat s0 = a[0] * a[5]  - a[4]  * a[1];
+    const cgFloat s1 = a[0] * a[6]  - a[4]  * a[2];
+    const cgFloat s2 = a[0] * a[7]  - a[4]  * a[3];
+    const cgFloat s3 = a[1] * a[6]  - a[5]  * a[2];
+    const cgFloat s4 = a[1] * a[7]  - a[5]  * a[3];
+    const cgFloat s5 = a[2] * a[7]  - a[6]  * a[3];
+    const cgFloat c5 = a[10] * a[15] - a[14] * a[11];
+    const cgFloat c4 = a[9]  * a[15] - a[13] * a[11];
+    const cgFloat c3 = a[9]  * a[14] - a[13] * a[10];
+    const cgFloat c2 = a[8]  * a[15] - a[12] * a[11];
+    const cgFloat c1 = a[8]  * a[14] - a[12] * a[10];
+    const cgFloat c0 = a[8]  * a[13] - a[12] * a[9];
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationAxis ()
+/// <summary>
+/// Build a matrix that rotates around an arbitrary (automatically
+/// normalized) axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationAxis( cgMatrix & out, const cgVector3 & axis, cgFloat radians )
+{
+    cgVector3 v;
+    NativeMath::normalize3( v, axis );
+    const cgFloat s = sinf( radians ), c = cosf( radians ), t = 1.0f - c;
+    out._11 = t * v.x * v.x + c;
+    out._12 = t * v.y * v.x + s * v.z;
+    out._13 = t * v.z * v.x - s * v.y;
+    out._14 = 0.0f;
+    out._21 = t * v.x * v.y - s * v.z;
+    out._22 = t * v.y * v.y + c;
+    out._23 = t * v.z * v.y + s * v.x;
+    out._24 = 0.0f;
+    out._31 = t * v.x * v.z + s * v.y;
+    out._32 = t * v.y * v.z - s * v.x;
+    out._33 = t * v.z * v.z + c;
+    out._34 = 0.0f;
+    out._41 = out._42 = out._43 = 0.0f;
+    out._44 = 1.0f;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationYawPitchRoll ()
+/// <summary>
+/// Build a rotation matrix from yaw (Y), pitch (X) and roll (Z) angles. The
+/// order of transformation is roll first, then pitch, then yaw.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationYawPitchRoll( cgMatrix & out, cgFloat yaw, cgFloat pitch, cgFloat roll )
+{
+    const cgFloat sr = sinf( roll ),  cr = cosf( roll );
+    const cgFloat sp = sinf( pitch ), cp = cosf( pitch );
+    const cgFloat sy = sinf( yaw ),   cy = cosf( yaw );
+    out._11 = sr * sp * sy + cr * cy;
+    out._12 = sr * cp;
+    out._13 = sr * sp * cy - cr * sy;
+    out._14 = 0.0f;
+    out._21 = cr * sp * sy - sr * cy;
+    out._22 = cr * cp;
+    out._23 = cr * sp * cy + sr * sy;
+    out._24 = 0.0f;
+    out._31 = cp * sy;
+    out._32 = -sp;
+    out._33 = cp * cy;
+    out._34 = 0.0f;
+    out._41 = out._42 = out._43 = 0.0f;
+    out._44 = 1.0f;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationX ()
+/// <summary>
+/// Build a matrix that rotates around the X axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationX( cgMatrix & out, cgFloat radians )
+{
+    const cgFloat s = sinf( radians ), c = cosf( radians );
+    out = cgMatrix( 1, 0, 0, 0, 0, c, s, 0, 0, -s, c, 0, 0, 0, 0, 1 );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationY ()
+/// <summary>
+/// Build a matrix that rotates around the Y axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationY( cgMatrix & out, cgFloat radians )
+{
+    const cgFloat s = sinf( radians ), c = cosf( radians );
+    out = cgMatrix( c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0, 0, 0, 0, 1 );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationZ ()
+/// <summary>
+/// Build a matrix that rotates around the Z axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationZ( cgMatrix & out, cgFloat radians )
+{
+    const cgFloat s = sinf( radians ), c = cosf( radians );
+    out = cgMatrix( c, s, 0, 0, -s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixRotationQuaternion ()
+/// <summary>
+/// Build a rotation matrix from the specified (unit length) quaternion.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixRotationQuaternion( cgMatrix & out, const cgQuaternion & q )
+{
+    const cgFloat xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const cgFloat xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const cgFloat xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+    out._11 = 1.0f - 2.0f * (yy + zz);
+    out._12 = 2.0f * (xy + zw);
+    out._13 = 2.0f * (xz - yw);
+    out._14 = 0.0f;
+    out._21 = 2.0f * (xy - zw);
+    out._22 = 1.0f - 2.0f * (xx + zz);
+    out._23 = 2.0f * (yz + xw);
+    out._24 = 0.0f;
+    out._31 = 2.0f * (xz + yw);
+    out._32 = 2.0f * (yz - xw);
+    out._33 = 1.0f - 2.0f * (xx + yy);
+    out._34 = 0.0f;
+    out._41 = out._42 = out._43 = 0.0f;
+    out._44 = 1.0f;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixDecompose ()
+/// <summary>
+/// Decompose an affine matrix into its scale, rotation and translation
+/// components. Returns false if any of the scale components are zero.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgMathNative::matrixDecompose( cgVector3 & outScale, cgQuaternion & outRotation, cgVector3 & outTranslation, const cgMatrix & m )
+{
+    const cgVector3 x( m._11, m._12, m._13 );
+    const cgVector3 y( m._21, m._22, m._23 );
+    const cgVector3 z( m._31, m._32, m._33 );
+    outScale.x = sqrtf( NativeMath::dot3( x, x ) );
+    outScale.y = sqrtf( NativeMath::dot3( y, y ) );
+    outScale.z = sqrtf( NativeMath::dot3( z, z ) );
+    outTranslation.x = m._41;
+    outTranslation.y = m._42;
+    outTranslation.z = m._43;
+    if ( outScale.x == 0.0f || outScale.y == 0.0f || outScale.z == 0.0f )
+        return false;
+
+    // Remove scale and extract the remaining rotation.
+    cgMatrix r( x.x / outScale.x, x.y / outScale.x, x.z / outScale.x, 0,
+                y.x / outScale.y, y.y / outScale.y, y.z / outScale.y, 0,
+                z.x / outScale.z, z.y / outScale.z, z.z / outScale.z, 0,
+                0, 0, 0, 1 );
+    quaternionRotationMatrix( outRotation, r );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixTransformation ()
+/// <summary>
+/// Build a transformation matrix from the specified scaling center,
+/// scaling rotation, scale, rotation center, rotation and translation
+/// components. Computed as:
+/// Msc^-1 * Msr^-1 * Ms * Msr * Msc * Mrc^-1 * Mr * Mrc * Mt
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixTransformation( cgMatrix & out, const cgVector3 & scalingCenter, const cgQuaternion & scalingRotation, const cgVector3 & scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation )
+{
+    cgMatrix m, scalingRot, scalingRotInv, s, r, t;
+    NativeMath::translation( m, -scalingCenter.x, -scalingCenter.y, -scalingCenter.z );
+    matrixRotationQuaternion( scalingRot, scalingRotation );
+    if ( !matrixInverse( scalingRotInv, CG_NULL, scalingRot ) )
+        NativeMath::identity( scalingRotInv );
+    s = cgMatrix( scaling.x, 0, 0, 0, 0, scaling.y, 0, 0, 0, 0, scaling.z, 0, 0, 0, 0, 1 );
+    matrixRotationQuaternion( r, rotation );
+    matrixMultiply( m, m, scalingRotInv );
+    matrixMultiply( m, m, s );
+    matrixMultiply( m, m, scalingRot );
+    NativeMath::translation( t, scalingCenter.x - rotationCenter.x, scalingCenter.y - rotationCenter.y, scalingCenter.z - rotationCenter.z );
+    matrixMultiply( m, m, t );
+    matrixMultiply( m, m, r );
+    NativeMath::translation( t, rotationCenter.x + translation.x, rotationCenter.y + translation.y, rotationCenter.z + translation.z );
+    return matrixMultiply( out, m, t );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixTransformation2D ()
+/// <summary>
+/// Build a transformation matrix in the XY plane. Rotations occur around
+/// the Z axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixTransformation2D( cgMatrix & out, const cgVector2 & scalingCenter, cgFloat scalingRotation, const cgVector2 & scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation )
+{
+    const cgQuaternion scalingRot( 0, 0, sinf( scalingRotation * 0.5f ), cosf( scalingRotation * 0.5f ) );
+    const cgQuaternion rot( 0, 0, sinf( rotation * 0.5f ), cosf( rotation * 0.5f ) );
+    return matrixTransformation( out, cgVector3( scalingCenter.x, scalingCenter.y, 0 ), scalingRot,
+                                 cgVector3( scaling.x, scaling.y, 1 ), cgVector3( rotationCenter.x, rotationCenter.y, 0 ),
+                                 rot, cgVector3( translation.x, translation.y, 0 ) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixAffineTransformation ()
+/// <summary>
+/// Build an affine transformation matrix from a uniform scale, a rotation
+/// around the specified center, and a translation.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixAffineTransformation( cgMatrix & out, cgFloat scaling, const cgVector3 & rotationCenter, const cgQuaternion & rotation, const cgVector3 & translation )
+{
+    cgMatrix r;
+    matrixRotationQuaternion( r, rotation );
+    const cgVector3 & c = rotationCenter;
+    out._11 = scaling * r._11; out._12 = scaling * r._12; out._13 = scaling * r._13; out._14 = 0.0f;
+    out._21 = scaling * r._21; out._22 = scaling * r._22; out._23 = scaling * r._23; out._24 = 0.0f;
+    out._31 = scaling * r._31; out._32 = scaling * r._32; out._33 = scaling * r._33; out._34 = 0.0f;
+    out._41 = c.x * (1.0f - r._11) - c.y * r._21 - c.z * r._31 + translation.x;
+    out._42 = c.y * (1.0f - r._22) - c.x * r._12 - c.z * r._32 + translation.y;
+    out._43 = c.z * (1.0f - r._33) - c.x * r._13 - c.y * r._23 + translation.z;
+    out._44 = 1.0f;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixAffineTransformation2D ()
+/// <summary>
+/// Build an affine transformation matrix in the XY plane from a uniform
+/// scale, a rotation around the specified center, and a translation.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixAffineTransformation2D( cgMatrix & out, cgFloat scaling, const cgVector2 & rotationCenter, cgFloat rotation, const cgVector2 & translation )
+{
+    const cgFloat s = sinf( rotation * 0.5f );
+    const cgFloat c = 1.0f - s * s * 2.0f;
+    const cgFloat t = 2.0f * s * cosf( rotation * 0.5f );
+    NativeMath::identity( out );
+    out._11 = scaling * c;
+    out._12 = scaling * t;
+    out._21 = -scaling * t;
+    out._22 = scaling * c;
+    out._41 = rotationCenter.y * t - rotationCenter.x * c + rotationCenter.x + translation.x;
+    out._42 = -rotationCenter.x * t - rotationCenter.y * c + rotationCenter.y + translation.y;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixLookAt ()
+/// <summary>
+/// Build a left or right handed 'look at' view matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixLookAt( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up, bool rightHanded )
+{
+    cgVector3 z, x, y;
+    NativeMath::normalize3( z, at - eye );
+    NativeMath::cross3( x, up, z );
+    NativeMath::cross3( y, z, x );
+    NativeMath::normalize3( x, x );
+    NativeMath::normalize3( y, y );
+    if ( rightHanded )
+    {
+        x = -x;
+        z = -z;
+    
+    } // End if right handed
+    out._11 = x.x; out._12 = y.x; out._13 = z.x; out._14 = 0.0f;
+    out._21 = x.y; out._22 = y.y; out._23 = z.y; out._24 = 0.0f;
+    out._31 = x.z; out._32 = y.z; out._33 = z.z; out._34 = 0.0f;
+    out._41 = -NativeMath::dot3( x, eye );
+    out._42 = -NativeMath::dot3( y, eye );
+    out._43 = -NativeMath::dot3( z, eye );
+    out._44 = 1.0f;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixPerspective ()
+/// <summary>
+/// Build a left or right handed perspective projection matrix from the
+/// dimensions of the view volume at the near plane.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixPerspective( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+{
+    memset( &out, 0, sizeof(cgMatrix) );
+    out._11 = 2.0f * nearClip / width;
+    out._22 = 2.0f * nearClip / height;
+    out._33 = (rightHanded) ? farClip / (nearClip - farClip) : farClip / (farClip - nearClip);
+    out._34 = (rightHanded) ? -1.0f : 1.0f;
+    out._43 = nearClip * farClip / (nearClip - farClip);
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixPerspectiveOffCenter ()
+/// <summary>
+/// Build a customized left or right handed perspective projection matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixPerspectiveOffCenter( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+{
+    memset( &out, 0, sizeof(cgMatrix) );
+    out._11 = 2.0f * nearClip / (right - left);
+    out._22 = 2.0f * nearClip / (top - bottom);
+    if ( rightHanded )
+    {
+        out._31 = (left + right) / (right - left);
+        out._32 = (top + bottom) / (top - bottom);
+        out._33 = farClip / (nearClip - farClip);
+        out._34 = -1.0f;
+    
+    } // End if right handed
+    else
+    {
+        out._31 = (left + right) / (left - right);
+        out._32 = (top + bottom) / (bottom - top);
+        out._33 = farClip / (farClip - nearClip);
+        out._34 = 1.0f;
+    
+    } // End if left handed
+    out._43 = nearClip * farClip / (nearClip - farClip);
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixPerspectiveFov ()
+/// <summary>
+/// Build a left or right handed perspective projection matrix from a
+/// vertical field of view and aspect ratio.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixPerspectiveFov( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+{
+    const cgFloat yScale = 1.0f / tanf( fovY * 0.5f );
+    memset( &out, 0, sizeof(cgMatrix) );
+    out._11 = yScale / aspect;
+    out._22 = yScale;
+    out._33 = (rightHanded) ? farClip / (nearClip - farClip) : farClip / (farClip - nearClip);
+    out._34 = (rightHanded) ? -1.0f : 1.0f;
+    out._43 = (rightHanded) ? nearClip * farClip / (nearClip - farClip) : -nearClip * farClip / (farClip - nearClip);
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixOrtho ()
+/// <summary>
+/// Build a left or right handed orthographic projection matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixOrtho( cgMatrix & out, cgFloat width, cgFloat height, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+{
+    NativeMath::identity( out );
+    out._11 = 2.0f / width;
+    out._22 = 2.0f / height;
+    out._33 = (rightHanded) ? 1.0f / (nearClip - farClip) : 1.0f / (farClip - nearClip);
+    out._43 = nearClip / (nearClip - farClip);
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixOrthoOffCenter ()
+/// <summary>
+/// Build a customized left or right handed orthographic projection matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixOrthoOffCenter( cgMatrix & out, cgFloat left, cgFloat right, cgFloat bottom, cgFloat top, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+{
+    NativeMath::identity( out );
+    out._11 = 2.0f / (right - left);
+    out._22 = 2.0f / (top - bottom);
+    out._33 = (rightHanded) ? 1.0f / (nearClip - farClip) : 1.0f / (farClip - nearClip);
+    out._41 = (left + right) / (left - right);
+    out._42 = (top + bottom) / (bottom - top);
+    out._43 = nearClip / (nearClip - farClip);
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixShadow ()
+/// <summary>
+/// Build a matrix that flattens geometry onto the specified plane as if
+/// casting a shadow from the specified light (w = 0 for directional).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixShadow( cgMatrix & out, const cgVector4 & light, const cgPlane & plane )
+{
+    cgPlane p;
+    planeNormalize( p, plane );
+    const cgFloat d = p.a * light.x + p.b * light.y + p.c * light.z + p.d * light.w;
+    const cgFloat n[4] = { p.a, p.b, p.c, p.d };
+    const cgFloat l[4] = { light.x, light.y, light.z, light.w };
+    for ( cgInt i = 0; i < 4; ++i )
+    {
+        for ( cgInt j = 0; j < 4; ++j )
+            out.m[i][j] = ((i == j) ? d : 0.0f) - n[i] * l[j];
+    
+    } // Next row
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : matrixReflect ()
+/// <summary>
+/// Build a matrix that reflects geometry about the specified plane.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgMatrix * cgMathNative::matrixReflect( cgMatrix & out, const cgPlane & plane )
+{
+    cgPlane p;
+    planeNormalize( p, plane );
+    out._11 = 1.0f - 2.0f * p.a * p.a; out._12 = -2.0f * p.a * p.b;       out._13 = -2.0f * p.a * p.c;       out._14 = 0.0f;
+    out._21 = -2.0f * p.b * p.a;       out._22 = 1.0f - 2.0f * p.b * p.b; out._23 = -2.0f * p.b * p.c;       out._24 = 0.0f;
+    out._31 = -2.0f * p.c * p.a;       out._32 = -2.0f * p.c * p.b;       out._33 = 1.0f - 2.0f * p.c * p.c; out._34 = 0.0f;
+    out._41 = -2.0f * p.d * p.a;       out._42 = -2.0f * p.d * p.b;       out._43 = -2.0f * p.d * p.c;       out._44 = 1.0f;
+    return &out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgMathNative Vector Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : vec2TransformCoord ()
+/// <summary>
+/// Transform a 2D point by the specified matrix, projecting the result
+/// back into w = 1.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector2 * cgMathNative::vec2TransformCoord( cgVector2 & out, const cgVector2 & v, const cgMatrix & m )
+{
+    const cgFloat w = m._14 * v.x + m._24 * v.y + m._44;
+    const cgFloat x = (m._11 * v.x + m._21 * v.y + m._41) / w;
+    const cgFloat y = (m._12 * v.x + m._22 * v.y + m._42) / w;
+    out.x = x;
+    out.y = y;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec2TransformNormal ()
+/// <summary>
+/// Transform a 2D direction by the specified matrix (translation ignored).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector2 * cgMathNative::vec2TransformNormal( cgVector2 & out, const cgVector2 & v, const cgMatrix & m )
+{
+    const cgFloat x = m._11 * v.x + m._21 * v.y;
+    const cgFloat y = m._12 * v.x + m._22 * v.y;
+    out.x = x;
+    out.y = y;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec2Transform ()
+/// <summary>
+/// Transform a 2D point (z = 0, w = 1) by the specified matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector4 * cgMathNative::vec2Transform( cgVector4 & out, const cgVector2 & v, const cgMatrix & m )
+{
+    const cgVector4 r( m._11 * v.x + m._21 * v.y + m._41,
+                       m._12 * v.x + m._22 * v.y + m._42,
+                       m._13 * v.x + m._23 * v.y + m._43,
+                       m._14 * v.x + m._24 * v.y + m._44 );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec3TransformCoord ()
+/// <summary>
+/// Transform a 3D point by the specified matrix, projecting the result
+/// back into w = 1.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector3 * cgMathNative::vec3TransformCoord( cgVector3 & out, const cgVector3 & v, const cgMatrix & m )
+{
+    const cgFloat w = m._14 * v.x + m._24 * v.y + m._34 * v.z + m._44;
+    const cgVector3 r( (m._11 * v.x + m._21 * v.y + m._31 * v.z + m._41) / w,
+                       (m._12 * v.x + m._22 * v.y + m._32 * v.z + m._42) / w,
+                       (m._13 * v.x + m._23 * v.y + m._33 * v.z + m._43) / w );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec3TransformNormal ()
+/// <summary>
+/// Transform a 3D direction by the specified matrix (translation ignored).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector3 * cgMathNative::vec3TransformNormal( cgVector3 & out, const cgVector3 & v, const cgMatrix & m )
+{
+    const cgVector3 r( m._11 * v.x + m._21 * v.y + m._31 * v.z,
+                       m._12 * v.x + m._22 * v.y + m._32 * v.z,
+                       m._13 * v.x + m._23 * v.y + m._33 * v.z );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec3Transform ()
+/// <summary>
+/// Transform a 3D point (w = 1) by the specified matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector4 * cgMathNative::vec3Transform( cgVector4 & out, const cgVector3 & v, const cgMatrix & m )
+{
+    const cgVector4 r( m._11 * v.x + m._21 * v.y + m._31 * v.z + m._41,
+                       m._12 * v.x + m._22 * v.y + m._32 * v.z + m._42,
+                       m._13 * v.x + m._23 * v.y + m._33 * v.z + m._43,
+                       m._14 * v.x + m._24 * v.y + m._34 * v.z + m._44 );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec3TransformCoordArray ()
+/// <summary>
+/// Transform an array of 3D points by the specified matrix, projecting the
+/// results back into w = 1. Strides are specified in bytes.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector3 * cgMathNative::vec3TransformCoordArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+{
+    cgByte * dst = (cgByte*)out;
+    const cgByte * src = (const cgByte*)v;
+    cgUInt32 i = 0;
+
+#if defined(CGE_MATH_SIMD_AVX)
+    // Two points per iteration, matrix rows duplicated into both lanes.
+    const __m256 r0 = _mm256_broadcast_ps( (const __m128*)m.m[0] );
+    const __m256 r1 = _mm256_broadcast_ps( (const __m128*)m.m[1] );
+    const __m256 r2 = _mm256_broadcast_ps( (const __m128*)m.m[2] );
+    const __m256 r3 = _mm256_broadcast_ps( (const __m128*)m.m[3] );
+    cgFloat result[8];
+    for ( ; i + 1 < count; i += 2 )
+    {
+        const cgVector3 & a = *(const cgVector3*)src;
+        const cgVector3 & b = *(const cgVector3*)(src + inStride);
+        const __m256 x = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_set1_ps( a.x ) ), _mm_set1_ps( b.x ), 1 );
+        const __m256 y = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_set1_ps( a.y ) ), _mm_set1_ps( b.y ), 1 );
+        const __m256 z = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_set1_ps( a.z ) ), _mm_set1_ps( b.z ), 1 );
+        __m256 r = _mm256_add_ps( _mm256_mul_ps( x, r0 ), r3 );
+        r = _mm256_add_ps( r, _mm256_mul_ps( y, r1 ) );
+        r = _mm256_add_ps( r, _mm256_mul_ps( z, r2 ) );
+        r = _mm256_div_ps( r, _mm256_permute_ps( r, 0xFF ) );
+        _mm256_storeu_ps( result, r );
+        cgFloat * o = (cgFloat*)dst;
+        o[0] = result[0]; o[1] = result[1]; o[2] = result[2];
+        o = (cgFloat*)(dst + outStride);
+        o[0] = result[4]; o[1] = result[5]; o[2] = result[6];
+        src += inStride * 2;
+        dst += outStride * 2;
+    
+    } // Next pair
+
+#elif defined(CGE_MATH_SIMD_SSE2)
+    const __m128 r0 = _mm_loadu_ps( m.m[0] );
+    const __m128 r1 = _mm_loadu_ps( m.m[1] );
+    const __m128 r2 = _mm_loadu_ps( m.m[2] );
+    const __m128 r3 = _mm_loadu_ps( m.m[3] );
+    cgFloat result[4];
+    for ( ; i < count; ++i, src += inStride, dst += outStride )
+    {
+        const cgVector3 & a = *(const cgVector3*)src;
+        __m128 r = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( a.x ), r0 ), r3 );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( a.y ), r1 ) );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( a.z ), r2 ) );
+        r = _mm_div_ps( r, _mm_shuffle_ps( r, r, _MM_SHUFFLE(3,3,3,3) ) );
+        _mm_storeu_ps( result, r );
+        cgFloat * o = (cgFloat*)dst;
+        o[0] = result[0]; o[1] = result[1]; o[2] = result[2];
+    
+    } // Next element
+
+#endif // CGE_MATH_SIMD_SSE2
+
+    // Scalar path (and any remainder).
+    for ( ; i < count; ++i, src += inStride, dst += outStride )
+        vec3TransformCoord( *(cgVector3*)dst, *(const cgVector3*)src, m );
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec3TransformNormalArray ()
+/// <summary>
+/// Transform an array of 3D directions by the specified matrix (translation
+/// ignored). Strides are specified in bytes.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector3 * cgMathNative::vec3TransformNormalArray( cgVector3 * out, cgUInt32 outStride, const cgVector3 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+{
+    cgByte * dst = (cgByte*)out;
+    const cgByte * src = (const cgByte*)v;
+    cgUInt32 i = 0;
+
+#if defined(CGE_MATH_SIMD_SSE2)
+    const __m128 r0 = _mm_loadu_ps( m.m[0] );
+    const __m128 r1 = _mm_loadu_ps( m.m[1] );
+    const __m128 r2 = _mm_loadu_ps( m.m[2] );
+    cgFloat result[4];
+    for ( ; i < count; ++i, src += inStride, dst += outStride )
+    {
+        const cgVector3 & a = *(const cgVector3*)src;
+        __m128 r = _mm_mul_ps( _mm_set1_ps( a.x ), r0 );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( a.y ), r1 ) );
+        r = _mm_add_ps( r, _mm_mul_ps( _mm_set1_ps( a.z ), r2 ) );
+        _mm_storeu_ps( result, r );
+        cgFloat * o = (cgFloat*)dst;
+        o[0] = result[0]; o[1] = result[1]; o[2] = result[2];
+    
+    } // Next element
+#endif // CGE_MATH_SIMD_SSE2
+
+    // Scalar path.
+    for ( ; i < count; ++i, src += inStride, dst += outStride )
+        vec3TransformNormal( *(cgVector3*)dst, *(const cgVector3*)src, m );
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec4Cross ()
+/// <summary>
+/// Compute the four dimensional cross product of three vectors.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector4 * cgMathNative::vec4Cross( cgVector4 & out, const cgVector4 & v1, const cgVector4 & v2, const cgVector4 & v3 )
+{
+    const cgVector4 r(
+          v1.y * (v2.z * v3.w - v3.z * v2.w) - v1.z * (v2.y * v3.w - v3.y * v2.w) + v1.w * (v2.y * v3.z - v2.z * v3.y),
+        -(v1.x * (v2.z * v3.w - v3.z * v2.w) - v1.z * (v2.x * v3.w - v3.x * v2.w) + v1.w * (v2.x * v3.z - v3.x * v2.z)),
+          v1.x * (v2.y * v3.w - v3.y * v2.w) - v1.y * (v2.x * v3.w - v3.x * v2.w) + v1.w * (v2.x * v3.y - v3.x * v2.y),
+        -(v1.x * (v2.y * v3.z - v3.y * v2.z) - v1.y * (v2.x * v3.z - v3.x * v2.z) + v1.z * (v2.x * v3.y - v3.x * v2.y)) );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec4Transform ()
+/// <summary>
+/// Transform a 4D vector by the specified matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector4 * cgMathNative::vec4Transform( cgVector4 & out, const cgVector4 & v, const cgMatrix & m )
+{
+    NativeMath::transformArray4( &out.x, 0, &v.x, 0, m, 1 );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : vec4TransformArray ()
+/// <summary>
+/// Transform an array of 4D vectors by the specified matrix. Strides are
+/// specified in bytes.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector4 * cgMathNative::vec4TransformArray( cgVector4 * out, cgUInt32 outStride, const cgVector4 * v, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+{
+    NativeMath::transformArray4( &out->x, outStride, &v->x, inStride, m, count );
+    return out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgMathNative Quaternion Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : quaternionInverse ()
+/// <summary>
+/// Conjugate and re-normalize the specified quaternion.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionInverse( cgQuaternion & out, const cgQuaternion & q )
+{
+    const cgFloat norm = NativeMath::dot4( q, q );
+    out.x = -q.x / norm;
+    out.y = -q.y / norm;
+    out.z = -q.z / norm;
+    out.w =  q.w / norm;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionMultiply ()
+/// <summary>
+/// Compute the product of two quaternions. As with D3DX, the result
+/// represents the rotation q1 followed by the rotation q2 (q2 * q1).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionMultiply( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2 )
+{
+    const cgQuaternion r( q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+                          q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+                          q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+                          q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z );
+    out = r;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionNormalize ()
+/// <summary>
+/// Compute a unit length version of the specified quaternion.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionNormalize( cgQuaternion & out, const cgQuaternion & q )
+{
+    const cgFloat length = sqrtf( NativeMath::dot4( q, q ) );
+    if ( length == 0.0f )
+        out = cgQuaternion( 0, 0, 0, 0 );
+    else
+        out = cgQuaternion( q.x / length, q.y / length, q.z / length, q.w / length );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionSlerp ()
+/// <summary>
+/// Spherically interpolate between two quaternions, taking the shortest
+/// path. Falls back to linear interpolation for nearly parallel inputs.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionSlerp( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, cgFloat t )
+{
+    cgFloat sign = 1.0f, s1 = 1.0f - t, s2 = t;
+    cgFloat cosTheta = NativeMath::dot4( q1, q2 );
+    if ( cosTheta < 0.0f )
+    {
+        sign = -1.0f;
+        cosTheta = -cosTheta;
+    
+    } // End if opposite hemisphere
+    if ( 1.0f - cosTheta > 0.001f )
+    {
+        const cgFloat theta = acosf( cosTheta );
+        const cgFloat sinTheta = sinf( theta );
+        s1 = sinf( theta * s1 ) / sinTheta;
+        s2 = sinf( theta * s2 ) / sinTheta;
+    
+    } // End if not parallel
+    s2 *= sign;
+    out = cgQuaternion( s1 * q1.x + s2 * q2.x, s1 * q1.y + s2 * q2.y, s1 * q1.z + s2 * q2.z, s1 * q1.w + s2 * q2.w );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionSquad ()
+/// <summary>
+/// Spherical quadrangle interpolation using control points generated by
+/// quaternionSquadSetup().
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionSquad( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & a, const cgQuaternion & b, const cgQuaternion & c, cgFloat t )
+{
+    cgQuaternion t1, t2;
+    quaternionSlerp( t1, q1, c, t );
+    quaternionSlerp( t2, a, b, t );
+    return quaternionSlerp( out, t1, t2, 2.0f * t * (1.0f - t) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionSquadSetup ()
+/// <summary>
+/// Generate the control points required for spherical quadrangle
+/// interpolation between q1 and q2.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgMathNative::quaternionSquadSetup( cgQuaternion & outA, cgQuaternion & outB, cgQuaternion & outC, const cgQuaternion & q0, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3 )
+{
+    // Ensure each consecutive pair lies in the same hemisphere.
+    const cgQuaternion p0 = (NativeMath::dot4( q0, q1 ) < 0.0f) ? -q0 : q0;
+    const cgQuaternion p2 = (NativeMath::dot4( q1, q2 ) < 0.0f) ? -q2 : q2;
+    const cgQuaternion p3 = (NativeMath::dot4( p2, q3 ) < 0.0f) ? -q3 : q3;
+    cgQuaternion inv, l1, l2, sum, a;
+
+    // a = q1 * exp( -0.25 * (ln(q1^-1 * q0) + ln(q1^-1 * q2)) )
+    quaternionInverse( inv, q1 );
+    quaternionMultiply( l1, inv, p0 );
+    quaternionLn( l1, l1 );
+    quaternionMultiply( l2, inv, p2 );
+    quaternionLn( l2, l2 );
+    sum = (l1 + l2) * -0.25f;
+    quaternionExp( sum, sum );
+    quaternionMultiply( a, q1, sum );
+
+    // b = q2 * exp( -0.25 * (ln(q2^-1 * q1) + ln(q2^-1 * q3)) )
+    quaternionInverse( inv, p2 );
+    quaternionMultiply( l1, inv, q1 );
+    quaternionLn( l1, l1 );
+    quaternionMultiply( l2, inv, p3 );
+    quaternionLn( l2, l2 );
+    sum = (l1 + l2) * -0.25f;
+    quaternionExp( sum, sum );
+    quaternionMultiply( outB, p2, sum );
+    outA = a;
+    outC = p2;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionRotationAxis ()
+/// <summary>
+/// Build a quaternion that rotates around an arbitrary (automatically
+/// normalized) axis.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionRotationAxis( cgQuaternion & out, const cgVector3 & axis, cgFloat radians )
+{
+    cgVector3 v;
+    NativeMath::normalize3( v, axis );
+    const cgFloat s = sinf( radians * 0.5f );
+    out = cgQuaternion( s * v.x, s * v.y, s * v.z, cosf( radians * 0.5f ) );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionRotationYawPitchRoll ()
+/// <summary>
+/// Build a quaternion from yaw (Y), pitch (X) and roll (Z) angles.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionRotationYawPitchRoll( cgQuaternion & out, cgFloat yaw, cgFloat pitch, cgFloat roll )
+{
+    const cgFloat sy = sinf( yaw * 0.5f ),   cy = cosf( yaw * 0.5f );
+    const cgFloat sp = sinf( pitch * 0.5f ), cp = cosf( pitch * 0.5f );
+    const cgFloat sr = sinf( roll * 0.5f ),  cr = cosf( roll * 0.5f );
+    out.x = sy * cp * sr + cy * sp * cr;
+    out.y = sy * cp * cr - cy * sp * sr;
+    out.z = cy * cp * sr - sy * sp * cr;
+    out.w = cy * cp * cr + sy * sp * sr;
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionRotationMatrix ()
+/// <summary>
+/// Extract the rotation described by the upper 3x3 of the specified
+/// (orthonormal) matrix.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionRotationMatrix( cgQuaternion & out, const cgMatrix & m )
+{
+    const cgFloat trace = m._11 + m._22 + m._33 + 1.0f;
+    if ( trace > 1.0f )
+    {
+        const cgFloat s = 2.0f * sqrtf( trace );
+        out.x = (m._23 - m._32) / s;
+        out.y = (m._31 - m._13) / s;
+        out.z = (m._12 - m._21) / s;
+        out.w = 0.25f * s;
+        return &out;
+    
+    } // End if positive trace
+
+    // Select the largest diagonal component for numerical stability.
+    if ( m._11 >= m._22 && m._11 >= m._33 )
+    {
+        const cgFloat s = 2.0f * sqrtf( 1.0f + m._11 - m._22 - m._33 );
+        out.x = 0.25f * s;
+        out.y = (m._12 + m._21) / s;
+        out.z = (m._13 + m._31) / s;
+        out.w = (m._23 - m._32) / s;
+    
+    } // End if X largest
+    else if ( m._22 >= m._33 )
+    {
+        const cgFloat s = 2.0f * sqrtf( 1.0f + m._22 - m._11 - m._33 );
+        out.x = (m._12 + m._21) / s;
+        out.y = 0.25f * s;
+        out.z = (m._23 + m._32) / s;
+        out.w = (m._31 - m._13) / s;
+    
+    } // End if Y largest
+    else
+    {
+        const cgFloat s = 2.0f * sqrtf( 1.0f + m._33 - m._11 - m._22 );
+        out.x = (m._13 + m._31) / s;
+        out.y = (m._23 + m._32) / s;
+        out.z = 0.25f * s;
+        out.w = (m._12 - m._21) / s;
+    
+    } // End if Z largest
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionToAxisAngle ()
+/// <summary>
+/// Retrieve the (unnormalized) axis and angle of rotation described by the
+/// specified quaternion.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgMathNative::quaternionToAxisAngle( const cgQuaternion & q, cgVector3 & outAxis, cgFloat & outAngle )
+{
+    outAxis.x = q.x;
+    outAxis.y = q.y;
+    outAxis.z = q.z;
+    outAngle  = 2.0f * acosf( q.w );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionLn ()
+/// <summary>
+/// Compute the natural logarithm of the specified unit quaternion.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionLn( cgQuaternion & out, const cgQuaternion & q )
+{
+    const cgFloat t = (q.w >= 1.0f) ? 1.0f : acosf( q.w ) / sqrtf( 1.0f - q.w * q.w );
+    out = cgQuaternion( t * q.x, t * q.y, t * q.z, 0.0f );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionExp ()
+/// <summary>
+/// Compute the exponential of the specified pure quaternion (w ignored).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionExp( cgQuaternion & out, const cgQuaternion & q )
+{
+    const cgFloat norm = sqrtf( q.x * q.x + q.y * q.y + q.z * q.z );
+    if ( norm != 0.0f )
+    {
+        const cgFloat s = sinf( norm ) / norm;
+        out = cgQuaternion( s * q.x, s * q.y, s * q.z, cosf( norm ) );
+    
+    } // End if non-zero
+    else
+    {
+        out = cgQuaternion( q.x, q.y, q.z, 1.0f );
+    
+    } // End if zero
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : quaternionBaryCentric ()
+/// <summary>
+/// Compute a point in barycentric coordinates using spherical
+/// interpolation between the three specified quaternions.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgQuaternion * cgMathNative::quaternionBaryCentric( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, const cgQuaternion & q3, cgFloat f, cgFloat g )
+{
+    const cgFloat fg = f + g;
+    if ( fg == 0.0f )
+    {
+        out = q1;
+        return &out;
+    
+    } // End if degenerate
+    cgQuaternion t1, t2;
+    quaternionSlerp( t1, q1, q2, fg );
+    quaternionSlerp( t2, q1, q3, fg );
+    return quaternionSlerp( out, t1, t2, g / fg );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgMathNative Plane Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : planeFromPoints ()
+/// <summary>
+/// Construct a plane from three points (clockwise winding).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgPlane * cgMathNative::planeFromPoints( cgPlane & out, const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3 )
+{
+    cgVector3 n;
+    NativeMath::cross3( n, v2 - v1, v3 - v1 );
+    NativeMath::normalize3( n, n );
+    out = cgPlane( n.x, n.y, n.z, -NativeMath::dot3( v1, n ) );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : planeNormalize ()
+/// <summary>
+/// Normalize the specified plane such that its normal is unit length.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgPlane * cgMathNative::planeNormalize( cgPlane & out, const cgPlane & p )
+{
+    const cgFloat length = sqrtf( p.a * p.a + p.b * p.b + p.c * p.c );
+    if ( length == 0.0f )
+        out = cgPlane( 0, 0, 0, 0 );
+    else
+        out = cgPlane( p.a / length, p.b / length, p.c / length, p.d / length );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : planeTransform ()
+/// <summary>
+/// Transform the specified plane by a matrix. The matrix should be the
+/// inverse transpose of the desired transformation.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgPlane * cgMathNative::planeTransform( cgPlane & out, const cgPlane & p, const cgMatrix & m )
+{
+    NativeMath::transformArray4( &out.a, 0, &p.a, 0, m, 1 );
+    return &out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : planeTransformArray ()
+/// <summary>
+/// Transform an array of planes by a matrix. The matrix should be the
+/// inverse transpose of the desired transformation. Strides are specified
+/// in bytes.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgPlane * cgMathNative::planeTransformArray( cgPlane * out, cgUInt32 outStride, const cgPlane * p, cgUInt32 inStride, const cgMatrix & m, cgUInt32 count )
+{
+    NativeMath::transformArray4( &out->a, outStride, &p->a, inStride, m, count );
+    return out;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : planeIntersectLine ()
+/// <summary>
+/// Find the intersection between the plane and the infinite line passing
+/// through the two specified points. Returns CG_NULL if the line is
+/// parallel to the plane.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVector3 * cgMathNative::planeIntersectLine( cgVector3 & out, const cgPlane & p, const cgVector3 & v1, const cgVector3 & v2 )
+{
+    const cgVector3 direction = v2 - v1;
+    const cgFloat denominator = p.a * direction.x + p.b * direction.y + p.c * direction.z;
+    if ( denominator == 0.0f )
+        return CG_NULL;
+    const cgFloat t = (p.a * v1.x + p.b * v1.y + p.c * v1.z + p.d) / denominator;
+    out = v1 - direction * t;
+    return &out;
+}
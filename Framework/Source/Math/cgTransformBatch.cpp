@@ -0,0 +1,414 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTransformBatch.cpp                                               //
+//                                                                           //
+// Desc : Batched hierarchy transform processing. Computes world space       //
+//        transforms for arrays of parent relative transforms in a single    //
+//        structure of arrays (SoA) pass suitable for SIMD processing.       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgTransformBatch Module Includes
+//-----------------------------------------------------------------------------
+#include <Math/cgTransformBatch.h>
+#if defined(CGE_MATH_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+// Element streams are stored in row major order for the upper 4x3 portion of
+// the matrix (_11, _12, _13, _21, ... _43). The right hand column of an affine
+// transform is always (0,0,0,1) and is never stored.
+namespace TransformBatch
+{
+    //-------------------------------------------------------------------------
+    // Name : Streams (Struct)
+    // Desc : Raw pointers to each element stream for the kernels below.
+    //-------------------------------------------------------------------------
+    struct Streams
+    {
+        const cgFloat * local[cgTransformBatch::ElementCount];
+        cgFloat       * world[cgTransformBatch::ElementCount];
+        const cgInt32 * parents;
+        const cgFloat * root;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : computeNode()
+    // Desc : Scalar kernel. Computes the world transform for a single node.
+    //-------------------------------------------------------------------------
+    inline void computeNode( const Streams & s, cgUInt32 i )
+    {
+        // Gather parent elements.
+        cgFloat p[cgTransformBatch::ElementCount];
+        const cgInt32 parent = s.parents[i];
+        if ( parent < 0 )
+        {
+            for ( cgInt k = 0; k < cgTransformBatch::ElementCount; ++k )
+                p[k] = s.root[k];
+        
+        } // End if root
+        else
+        {
+            for ( cgInt k = 0; k < cgTransformBatch::ElementCount; ++k )
+                p[k] = s.world[k][parent];
+        
+        } // End if child
+
+        // world = local * parent
+        for ( cgInt r = 0; r < 4; ++r )
+        {
+            const cgFloat l0 = s.local[r*3+0][i];
+            const cgFloat l1 = s.local[r*3+1][i];
+            const cgFloat l2 = s.local[r*3+2][i];
+            const cgFloat w  = (r == 3) ? 1.0f : 0.0f;
+            for ( cgInt c = 0; c < 3; ++c )
+                s.world[r*3+c][i] = l0 * p[c] + l1 * p[3+c] + l2 * p[6+c] + w * p[9+c];
+        
+        } // Next row
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : canVectorize()
+    // Desc : Determine if all of the nodes in the block [i, i + width) have
+    //        parents that were already computed prior to the block itself.
+    //-------------------------------------------------------------------------
+    inline bool canVectorize( const Streams & s, cgUInt32 i, cgUInt32 width )
+    {
+        for ( cgUInt32 j = 0; j < width; ++j )
+        {
+            if ( s.parents[i+j] >= (cgInt32)i )
+                return false;
+        
+        } // Next lane
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : gatherParents()
+    // Desc : Transposes the parent elements referenced by the block
+    //        [i, i + width) into contiguous lanes ready for loading.
+    //-------------------------------------------------------------------------
+    inline void gatherParents( cgFloat * out, const Streams & s, cgUInt32 i, cgUInt32 width )
+    {
+        for ( cgUInt32 j = 0; j < width; ++j )
+        {
+            const cgInt32 parent = s.parents[i+j];
+            for ( cgInt k = 0; k < cgTransformBatch::ElementCount; ++k )
+                out[k * width + j] = (parent < 0) ? s.root[k] : s.world[k][parent];
+        
+        } // Next lane
+    }
+
+#if defined(CGE_MATH_SIMD_AVX)
+    //-------------------------------------------------------------------------
+    // Name : computeBlock8()
+    // Desc : AVX kernel. Computes world transforms for eight nodes at once.
+    //-------------------------------------------------------------------------
+    inline void computeBlock8( const Streams & s, cgUInt32 i )
+    {
+        cgFloat gathered[cgTransformBatch::ElementCount * 8];
+        gatherParents( gathered, s, i, 8 );
+        __m256 p[cgTransformBatch::ElementCount];
+        for ( cgInt k = 0; k < cgTransformBatch::ElementCount; ++k )
+            p[k] = _mm256_loadu_ps( gathered + k * 8 );
+
+        for ( cgInt r = 0; r < 4; ++r )
+        {
+            const __m256 l0 = _mm256_loadu_ps( s.local[r*3+0] + i );
+            const __m256 l1 = _mm256_loadu_ps( s.local[r*3+1] + i );
+            const __m256 l2 = _mm256_loadu_ps( s.local[r*3+2] + i );
+            for ( cgInt c = 0; c < 3; ++c )
+            {
+                __m256 w = _mm256_add_ps( _mm256_mul_ps( l0, p[c] ), _mm256_mul_ps( l1, p[3+c] ) );
+                w = _mm256_add_ps( w, _mm256_mul_ps( l2, p[6+c] ) );
+                if ( r == 3 )
+                    w = _mm256_add_ps( w, p[9+c] );
+                _mm256_storeu_ps( s.world[r*3+c] + i, w );
+            
+            } // Next column
+        
+        } // Next row
+    }
+#endif // CGE_MATH_SIMD_AVX
+
+#if defined(CGE_MATH_SIMD_SSE2)
+    //-------------------------------------------------------------------------
+    // Name : computeBlock4()
+    // Desc : SSE kernel. Computes world transforms for four nodes at once.
+    //-------------------------------------------------------------------------
+    inline void computeBlock4( const Streams & s, cgUInt32 i )
+    {
+        cgFloat gathered[cgTransformBatch::ElementCount * 4];
+        gatherParents( gathered, s, i, 4 );
+        __m128 p[cgTransformBatch::ElementCount];
+        for ( cgInt k = 0; k < cgTransformBatch::ElementCount; ++k )
+            p[k] = _mm_loadu_ps( gathered + k * 4 );
+
+        for ( cgInt r = 0; r < 4; ++r )
+        {
+            const __m128 l0 = _mm_loadu_ps( s.local[r*3+0] + i );
+            const __m128 l1 = _mm_loadu_ps( s.local[r*3+1] + i );
+            const __m128 l2 = _mm_loadu_ps( s.local[r*3+2] + i );
+            for ( cgInt c = 0; c < 3; ++c )
+            {
+                __m128 w = _mm_add_ps( _mm_mul_ps( l0, p[c] ), _mm_mul_ps( l1, p[3+c] ) );
+                w = _mm_add_ps( w, _mm_mul_ps( l2, p[6+c] ) );
+                if ( r == 3 )
+                    w = _mm_add_ps( w, p[9+c] );
+                _mm_storeu_ps( s.world[r*3+c] + i, w );
+            
+            } // Next column
+        
+        } // Next row
+    }
+#endif // CGE_MATH_SIMD_SSE2
+
+}; // End Namespace : TransformBatch
+
+///////////////////////////////////////////////////////////////////////////////
+// cgTransformBatch Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgTransformBatch () (Constructor)
+/// <summary>
+/// Class constructor.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTransformBatch::cgTransformBatch( )
+{
+    // Initialize variables to sensible defaults
+    mCount = 0;
+    setRootTransform( cgTransform::Identity );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgTransformBatch () (Destructor)
+/// <summary>
+/// Clean up any resources being used.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTransformBatch::~cgTransformBatch( )
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear ()
+/// <summary>
+/// Remove all nodes from the batch. Allocated stream memory is retained so 
+/// that the batch can be cheaply re-populated on subsequent frames.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::clear( )
+{
+    for ( cgInt k = 0; k < ElementCount; ++k )
+    {
+        mLocal[k].clear();
+        mWorld[k].clear();
+    
+    } // Next element
+    mParents.clear();
+    mCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : reserve ()
+/// <summary>
+/// Pre-allocate stream memory for the specified number of nodes.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::reserve( cgUInt32 count )
+{
+    for ( cgInt k = 0; k < ElementCount; ++k )
+    {
+        mLocal[k].reserve( count );
+        mWorld[k].reserve( count );
+    
+    } // Next element
+    mParents.reserve( count );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : addTransform ()
+/// <summary>
+/// Append a new node to the batch. The parent index must reference a node
+/// that was previously added to the batch, or be -1 to indicate that the node
+/// is attached directly to the root transform. Returns the index of the new
+/// node.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgTransformBatch::addTransform( const cgTransform & localTransform, cgInt32 parentIndex )
+{
+    cgAssert( parentIndex < (cgInt32)mCount );
+    for ( cgInt k = 0; k < ElementCount; ++k )
+    {
+        mLocal[k].push_back( 0.0f );
+        mWorld[k].push_back( 0.0f );
+    
+    } // Next element
+    mParents.push_back( (parentIndex < 0) ? -1 : parentIndex );
+    setLocalTransform( mCount, localTransform );
+    return mCount++;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setLocalTransform ()
+/// <summary>
+/// Replace the parent relative transform of the specified node.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::setLocalTransform( cgUInt32 index, const cgTransform & localTransform )
+{
+    const cgMatrix & m = localTransform;
+    mLocal[0][index]  = m._11; mLocal[1][index]  = m._12; mLocal[2][index]  = m._13;
+    mLocal[3][index]  = m._21; mLocal[4][index]  = m._22; mLocal[5][index]  = m._23;
+    mLocal[6][index]  = m._31; mLocal[7][index]  = m._32; mLocal[8][index]  = m._33;
+    mLocal[9][index]  = m._41; mLocal[10][index] = m._42; mLocal[11][index] = m._43;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setRootTransform ()
+/// <summary>
+/// Set the transform to which all nodes without a parent are relative.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::setRootTransform( const cgTransform & rootTransform )
+{
+    const cgMatrix & m = rootTransform;
+    mRoot[0] = m._11; mRoot[1]  = m._12; mRoot[2]  = m._13;
+    mRoot[3] = m._21; mRoot[4]  = m._22; mRoot[5]  = m._23;
+    mRoot[6] = m._31; mRoot[7]  = m._32; mRoot[8]  = m._33;
+    mRoot[9] = m._41; mRoot[10] = m._42; mRoot[11] = m._43;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getWorldTransform ()
+/// <summary>
+/// Retrieve the world transform computed for the specified node during the 
+/// most recent call to 'compute()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::getWorldTransform( cgTransform & out, cgUInt32 index ) const
+{
+    cgMatrix m( mWorld[0][index], mWorld[1][index],  mWorld[2][index],  0.0f,
+                mWorld[3][index], mWorld[4][index],  mWorld[5][index],  0.0f,
+                mWorld[6][index], mWorld[7][index],  mWorld[8][index],  0.0f,
+                mWorld[9][index], mWorld[10][index], mWorld[11][index], 1.0f );
+    out = m;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getParent ()
+/// <summary>
+/// Retrieve the index of the parent of the specified node (or -1 if the node
+/// is attached directly to the root transform).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgInt32 cgTransformBatch::getParent( cgUInt32 index ) const
+{
+    return mParents[index];
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCount ()
+/// <summary>
+/// Retrieve the total number of nodes currently in the batch.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgTransformBatch::getCount( ) const
+{
+    return mCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : compute ()
+/// <summary>
+/// Compute the world transforms for all nodes in the batch. Consecutive runs
+/// of nodes whose parents all precede the run are processed using the widest
+/// SIMD path available. Remaining nodes fall back to the scalar kernel.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::compute( )
+{
+    if ( !mCount )
+        return;
+
+    // Collect stream pointers for the kernels.
+    TransformBatch::Streams s;
+    for ( cgInt k = 0; k < ElementCount; ++k )
+    {
+        s.local[k] = &mLocal[k].front();
+        s.world[k] = &mWorld[k].front();
+    
+    } // Next element
+    s.parents = &mParents.front();
+    s.root    = mRoot;
+
+    // Process nodes.
+    cgUInt32 i = 0;
+    while ( i < mCount )
+    {
+#if defined(CGE_MATH_SIMD_AVX)
+        if ( i + 8 <= mCount && TransformBatch::canVectorize( s, i, 8 ) )
+        {
+            TransformBatch::computeBlock8( s, i );
+            i += 8;
+            continue;
+        
+        } // End if 8 wide
+#endif // CGE_MATH_SIMD_AVX
+#if defined(CGE_MATH_SIMD_SSE2)
+        if ( i + 4 <= mCount && TransformBatch::canVectorize( s, i, 4 ) )
+        {
+            TransformBatch::computeBlock4( s, i );
+            i += 4;
+            continue;
+        
+        } // End if 4 wide
+#endif // CGE_MATH_SIMD_SSE2
+        TransformBatch::computeNode( s, i++ );
+
+    } // Next node
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeHierarchy () (Static)
+/// <summary>
+/// Utility function that computes world transforms for an array of parent
+/// relative transforms in one pass. Parent indices must be topologically
+/// sorted (each parent index less than that of the child) with -1 used to 
+/// denote nodes attached to the optional root transform.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTransformBatch::computeHierarchy( cgTransform worldTransformsOut[], const cgTransform localTransforms[], const cgInt32 parentIndices[], cgUInt32 count, const cgTransform * rootTransform /* = CG_NULL */ )
+{
+    cgTransformBatch batch;
+    batch.reserve( count );
+    if ( rootTransform )
+        batch.setRootTransform( *rootTransform );
+    for ( cgUInt32 i = 0; i < count; ++i )
+        batch.addTransform( localTransforms[i], parentIndices[i] );
+    batch.compute();
+    for ( cgUInt32 i = 0; i < count; ++i )
+        batch.getWorldTransform( worldTransformsOut[i], i );
+}
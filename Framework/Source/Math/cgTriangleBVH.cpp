@@ -0,0 +1,724 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTriangleBVH.cpp                                                  //
+//                                                                           //
+// Desc : Bounding volume hierarchy constructed over a set of indexed        //
+//        triangles using the surface area heuristic (SAH). Provides         //
+//        accelerated single ray and ray packet intersection queries.        //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgTriangleBVH Module Includes
+//-----------------------------------------------------------------------------
+#include <Math/cgTriangleBVH.h>
+#include <Math/cgCollision.h>
+#include <algorithm>
+#if defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace TriangleBVH
+{
+    // Construction and traversal parameters.
+    const cgUInt32  BinCount        = 16;   // Number of SAH bins evaluated per axis.
+    const cgUInt32  MinLeafSize     = 2;    // Nodes with this many triangles or fewer are never split.
+    const cgUInt32  MaxLeafSize     = 16;   // Nodes with more triangles than this are always split.
+    const cgUInt32  MaxDepth        = 60;   // Maximum tree depth (bounds the traversal stack).
+    const cgUInt32  StackSize       = 64;   // Traversal stack size (must exceed MaxDepth).
+    const cgFloat   TraversalCost   = 1.0f; // Relative cost of a node traversal step vs. a triangle test.
+
+    //-------------------------------------------------------------------------
+    // Name : Bounds (Struct)
+    // Desc : Lightweight min / max bounds used during construction.
+    //-------------------------------------------------------------------------
+    struct Bounds
+    {
+        cgVector3 min, max;
+
+        inline void reset( )
+        {
+            min = cgVector3(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+            max = cgVector3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+        }
+        inline void grow( const cgVector3 & p )
+        {
+            if ( p.x < min.x ) min.x = p.x; if ( p.x > max.x ) max.x = p.x;
+            if ( p.y < min.y ) min.y = p.y; if ( p.y > max.y ) max.y = p.y;
+            if ( p.z < min.z ) min.z = p.z; if ( p.z > max.z ) max.z = p.z;
+        }
+        inline void grow( const Bounds & b )
+        {
+            // Empty bounds (e.g. an unpopulated SAH bin) contribute nothing.
+            if ( b.min.x > b.max.x )
+                return;
+            grow( b.min );
+            grow( b.max );
+        }
+        inline cgFloat area( ) const
+        {
+            if ( min.x > max.x )
+                return 0.0f;
+            const cgVector3 d = max - min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : CentroidLess (Struct)
+    // Desc : Orders triangle indices by the position of their centroid along
+    //        a single axis (used for median splits).
+    //-------------------------------------------------------------------------
+    struct CentroidLess
+    {
+        const cgVector3 * centroids;
+        cgInt             axis;
+
+        CentroidLess( const cgVector3 * _centroids, cgInt _axis ) :
+            centroids( _centroids ), axis( _axis ) {}
+        inline bool operator()( cgUInt32 a, cgUInt32 b ) const
+        {
+            return centroids[a][axis] < centroids[b][axis];
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : minimumHalfAngleSine()
+    // Desc : Compute sin(a / 2) for the smallest interior angle 'a' of the
+    //        specified triangle.
+    //-------------------------------------------------------------------------
+    inline cgFloat minimumHalfAngleSine( const cgVector3 & v1, const cgVector3 & v2, const cgVector3 & v3 )
+    {
+        cgVector3 e1, e2, e3;
+        cgVector3::normalize( e1, v2 - v1 );
+        cgVector3::normalize( e2, v3 - v2 );
+        cgVector3::normalize( e3, v1 - v3 );
+        
+        // Largest cosine corresponds to the smallest angle.
+        cgFloat maxCos = -cgVector3::dot( e1, e3 );
+        maxCos = std::max<cgFloat>( maxCos, -cgVector3::dot( e2, e1 ) );
+        maxCos = std::max<cgFloat>( maxCos, -cgVector3::dot( e3, e2 ) );
+        return sqrtf( std::max<cgFloat>( 0.0f, (1.0f - maxCos) * 0.5f ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : BuildEntry (Struct)
+    // Desc : Pending node on the construction stack.
+    //-------------------------------------------------------------------------
+    struct BuildEntry
+    {
+        cgUInt32 node;
+        cgUInt32 depth;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : StackEntry (Struct)
+    // Desc : Pending node on the single ray traversal stack.
+    //-------------------------------------------------------------------------
+    struct StackEntry
+    {
+        cgUInt32 node;
+        cgFloat  entry;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : safeInverse()
+    // Desc : Reciprocal of a ray direction component that avoids producing
+    //        infinities (and therefore NaNs in the slab test) for axis
+    //        aligned rays.
+    //-------------------------------------------------------------------------
+    inline cgFloat safeInverse( cgFloat value )
+    {
+        if ( fabsf( value ) < 1e-20f )
+            return (value < 0.0f) ? -1e30f : 1e30f;
+        return 1.0f / value;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : rayBox()
+    // Desc : Slab test between a single ray and a node bounding box. Returns
+    //        the entry distance on success.
+    //-------------------------------------------------------------------------
+    inline bool rayBox( const cgFloat * bMin, const cgFloat * bMax, const cgVector3 & origin, const cgVector3 & inverse, cgFloat closest, cgFloat & entry )
+    {
+        cgFloat t1 = (bMin[0] - origin.x) * inverse.x, t2 = (bMax[0] - origin.x) * inverse.x;
+        cgFloat tMin = std::min<cgFloat>( t1, t2 ), tMax = std::max<cgFloat>( t1, t2 );
+        t1 = (bMin[1] - origin.y) * inverse.y; t2 = (bMax[1] - origin.y) * inverse.y;
+        tMin = std::max<cgFloat>( tMin, std::min<cgFloat>( t1, t2 ) ); tMax = std::min<cgFloat>( tMax, std::max<cgFloat>( t1, t2 ) );
+        t1 = (bMin[2] - origin.z) * inverse.z; t2 = (bMax[2] - origin.z) * inverse.z;
+        tMin = std::max<cgFloat>( tMin, std::min<cgFloat>( t1, t2 ) ); tMax = std::min<cgFloat>( tMax, std::max<cgFloat>( t1, t2 ) );
+        if ( tMax < 0.0f || tMin > tMax || tMin > closest )
+            return false;
+        entry = tMin;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : Packet (Struct)
+    // Desc : Structure of arrays representation of a ray packet.
+    //-------------------------------------------------------------------------
+    struct Packet
+    {
+        cgFloat ox[cgTriangleBVH::MaxPacketSize], oy[cgTriangleBVH::MaxPacketSize], oz[cgTriangleBVH::MaxPacketSize];
+        cgFloat ix[cgTriangleBVH::MaxPacketSize], iy[cgTriangleBVH::MaxPacketSize], iz[cgTriangleBVH::MaxPacketSize];
+        cgFloat closest[cgTriangleBVH::MaxPacketSize];
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : packetBox()
+    // Desc : Slab test between all rays in a packet and a node bounding box.
+    //        Returns a bit mask of the rays that intersect the box.
+    //-------------------------------------------------------------------------
+    inline cgUInt32 packetBox( const cgFloat * bMin, const cgFloat * bMax, const Packet & p )
+    {
+        cgUInt32 mask = 0;
+#if defined(CGE_MATH_SIMD_SSE2)
+        const __m128 minX = _mm_set1_ps( bMin[0] ), minY = _mm_set1_ps( bMin[1] ), minZ = _mm_set1_ps( bMin[2] );
+        const __m128 maxX = _mm_set1_ps( bMax[0] ), maxY = _mm_set1_ps( bMax[1] ), maxZ = _mm_set1_ps( bMax[2] );
+        const __m128 zero = _mm_setzero_ps();
+        for ( cgUInt32 i = 0; i < cgTriangleBVH::MaxPacketSize; i += 4 )
+        {
+            const __m128 ox = _mm_loadu_ps( p.ox + i ), oy = _mm_loadu_ps( p.oy + i ), oz = _mm_loadu_ps( p.oz + i );
+            const __m128 ix = _mm_loadu_ps( p.ix + i ), iy = _mm_loadu_ps( p.iy + i ), iz = _mm_loadu_ps( p.iz + i );
+            __m128 t1 = _mm_mul_ps( _mm_sub_ps( minX, ox ), ix ), t2 = _mm_mul_ps( _mm_sub_ps( maxX, ox ), ix );
+            __m128 tMin = _mm_min_ps( t1, t2 ), tMax = _mm_max_ps( t1, t2 );
+            t1 = _mm_mul_ps( _mm_sub_ps( minY, oy ), iy ); t2 = _mm_mul_ps( _mm_sub_ps( maxY, oy ), iy );
+            tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) ); tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+            t1 = _mm_mul_ps( _mm_sub_ps( minZ, oz ), iz ); t2 = _mm_mul_ps( _mm_sub_ps( maxZ, oz ), iz );
+            tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) ); tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+            __m128 hit = _mm_cmpge_ps( tMax, _mm_max_ps( tMin, zero ) );
+            hit = _mm_and_ps( hit, _mm_cmple_ps( tMin, _mm_loadu_ps( p.closest + i ) ) );
+            mask |= (cgUInt32)_mm_movemask_ps( hit ) << i;
+        
+        } // Next 4 rays
+#else // CGE_MATH_SIMD_SSE2
+        for ( cgUInt32 i = 0; i < cgTriangleBVH::MaxPacketSize; ++i )
+        {
+            cgFloat entry;
+            const cgVector3 origin( p.ox[i], p.oy[i], p.oz[i] ), inverse( p.ix[i], p.iy[i], p.iz[i] );
+            if ( rayBox( bMin, bMax, origin, inverse, p.closest[i], entry ) )
+                mask |= (1 << i);
+        
+        } // Next ray
+#endif // !CGE_MATH_SIMD_SSE2
+        return mask;
+    }
+
+}; // End Namespace : TriangleBVH
+
+///////////////////////////////////////////////////////////////////////////////
+// cgTriangleBVH Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgTriangleBVH () (Constructor)
+/// <summary>
+/// Class constructor.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTriangleBVH::cgTriangleBVH( )
+{
+    // Initialize variables to sensible defaults
+    mTolerance = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgTriangleBVH () (Destructor)
+/// <summary>
+/// Clean up any resources being used.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTriangleBVH::~cgTriangleBVH( )
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear ()
+/// <summary>
+/// Release all hierarchy data.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTriangleBVH::clear( )
+{
+    mNodes.clear();
+    mTriangles.clear();
+    mTolerance = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isBuilt ()
+/// <summary>
+/// Determine if the hierarchy has been successfully constructed.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTriangleBVH::isBuilt( ) const
+{
+    return !mNodes.empty();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getNodeCount ()
+/// <summary>
+/// Retrieve the total number of nodes in the hierarchy.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgTriangleBVH::getNodeCount( ) const
+{
+    return (cgUInt32)mNodes.size();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getFaceCount ()
+/// <summary>
+/// Retrieve the total number of triangles referenced by the hierarchy.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgTriangleBVH::getFaceCount( ) const
+{
+    return (cgUInt32)mTriangles.size();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : build ()
+/// <summary>
+/// Construct the hierarchy for the specified indexed triangle list. The 
+/// tolerance value is used when testing rays against individual triangles
+/// (see 'cgCollision::pointInTriangle()') and triangle bounds are inflated
+/// accordingly to remain conservative.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTriangleBVH::build( const cgByte * vertices, cgUInt32 vertexStride, cgUInt32 positionOffset, const cgUInt32 * indices, cgUInt32 faceCount, cgFloat tolerance )
+{
+    using namespace TriangleBVH;
+
+    // Release previous data.
+    clear();
+    if ( !vertices || !indices || !faceCount )
+        return false;
+    mTolerance = tolerance;
+
+    // Compute bounds and centroids for each triangle.
+    cgArray<Bounds>    faceBounds( faceCount );
+    cgArray<cgVector3> centroids( faceCount );
+    cgUInt32Array      order( faceCount );
+    for ( cgUInt32 i = 0; i < faceCount; ++i )
+    {
+        const cgVector3 & v1 = *(cgVector3*)(vertices + (indices[ i * 3 ] * vertexStride) + positionOffset);
+        const cgVector3 & v2 = *(cgVector3*)(vertices + (indices[ (i * 3) + 1 ] * vertexStride) + positionOffset);
+        const cgVector3 & v3 = *(cgVector3*)(vertices + (indices[ (i * 3) + 2 ] * vertexStride) + positionOffset);
+        faceBounds[i].reset();
+        faceBounds[i].grow( v1 );
+        faceBounds[i].grow( v2 );
+        faceBounds[i].grow( v3 );
+        centroids[i] = (faceBounds[i].min + faceBounds[i].max) * 0.5f;
+
+        // Inflate by the tolerance region. Edge tolerance extends beyond each
+        // vertex by 'tolerance / sin(angle / 2)' so acute triangles require
+        // a larger margin (capped for near degenerate triangles).
+        if ( tolerance > 0.0f )
+        {
+            const cgFloat margin = tolerance / std::max<cgFloat>( minimumHalfAngleSine( v1, v2, v3 ), 0.01f );
+            faceBounds[i].min -= cgVector3( margin, margin, margin );
+            faceBounds[i].max += cgVector3( margin, margin, margin );
+        
+        } // End if tolerance
+        order[i] = i;
+    
+    } // Next face
+
+    // Create the root node and process the construction stack.
+    mNodes.reserve( faceCount * 2 );
+    Node root;
+    root.first = 0;
+    root.count = faceCount;
+    mNodes.push_back( root );
+    cgArray<BuildEntry> stack;
+    BuildEntry rootEntry = { 0, 0 };
+    stack.push_back( rootEntry );
+    while ( !stack.empty() )
+    {
+        const BuildEntry entry = stack.back();
+        stack.pop_back();
+        const cgUInt32 first = mNodes[entry.node].first;
+        const cgUInt32 count = mNodes[entry.node].count;
+
+        // Compute node and centroid bounds.
+        Bounds nodeBounds, centroidBounds;
+        nodeBounds.reset();
+        centroidBounds.reset();
+        for ( cgUInt32 i = first; i < first + count; ++i )
+        {
+            nodeBounds.grow( faceBounds[order[i]] );
+            centroidBounds.grow( centroids[order[i]] );
+        
+        } // Next face
+
+        // Store node bounds.
+        Node & node = mNodes[entry.node];
+        node.boundsMin[0] = nodeBounds.min.x; node.boundsMax[0] = nodeBounds.max.x;
+        node.boundsMin[1] = nodeBounds.min.y; node.boundsMax[1] = nodeBounds.max.y;
+        node.boundsMin[2] = nodeBounds.min.z; node.boundsMax[2] = nodeBounds.max.z;
+
+        // Small enough to become a leaf?
+        if ( count <= MinLeafSize || entry.depth >= MaxDepth )
+            continue;
+
+        // Find the best split using binned SAH.
+        cgInt    bestAxis  = -1;
+        cgUInt32 bestSplit = 0;
+        cgFloat  bestCost  = FLT_MAX;
+        for ( cgInt axis = 0; axis < 3; ++axis )
+        {
+            const cgFloat axisMin = centroidBounds.min[axis];
+            const cgFloat extent  = centroidBounds.max[axis] - axisMin;
+            if ( extent <= 0.0f )
+                continue;
+
+            // Populate bins.
+            Bounds   binBounds[BinCount];
+            cgUInt32 binCounts[BinCount] = { 0 };
+            for ( cgUInt32 b = 0; b < BinCount; ++b )
+                binBounds[b].reset();
+            const cgFloat scale = (cgFloat)BinCount / extent;
+            for ( cgUInt32 i = first; i < first + count; ++i )
+            {
+                cgUInt32 b = (cgUInt32)((centroids[order[i]][axis] - axisMin) * scale);
+                if ( b >= BinCount ) b = BinCount - 1;
+                binBounds[b].grow( faceBounds[order[i]] );
+                binCounts[b]++;
+            
+            } // Next face
+
+            // Sweep from the right to compute suffix areas.
+            cgFloat  rightAreas[BinCount];
+            cgUInt32 rightCounts[BinCount];
+            Bounds   accumulated;
+            accumulated.reset();
+            cgUInt32 accumulatedCount = 0;
+            for ( cgUInt32 b = BinCount - 1; b > 0; --b )
+            {
+                accumulated.grow( binBounds[b] );
+                accumulatedCount += binCounts[b];
+                rightAreas[b]  = accumulated.area();
+                rightCounts[b] = accumulatedCount;
+            
+            } // Next bin
+
+            // Sweep from the left evaluating each candidate plane.
+            accumulated.reset();
+            accumulatedCount = 0;
+            for ( cgUInt32 b = 0; b < BinCount - 1; ++b )
+            {
+                accumulated.grow( binBounds[b] );
+                accumulatedCount += binCounts[b];
+                if ( !accumulatedCount || !rightCounts[b+1] )
+                    continue;
+                const cgFloat cost = accumulated.area() * accumulatedCount + rightAreas[b+1] * rightCounts[b+1];
+                if ( cost < bestCost )
+                {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = b;
+                
+                } // End if better
+            
+            } // Next candidate
+
+        } // Next axis
+
+        // Compare against the cost of leaving this node as a leaf.
+        const cgFloat parentArea = nodeBounds.area();
+        if ( bestAxis >= 0 && parentArea > 0.0f )
+            bestCost = TraversalCost + bestCost / parentArea;
+        const bool preferLeaf = ( bestAxis < 0 || bestCost >= (cgFloat)count );
+        if ( preferLeaf && count <= MaxLeafSize )
+            continue;
+
+        // Partition triangles.
+        cgUInt32 middle;
+        if ( bestAxis >= 0 )
+        {
+            const cgFloat axisMin = centroidBounds.min[bestAxis];
+            const cgFloat scale   = (cgFloat)BinCount / (centroidBounds.max[bestAxis] - axisMin);
+            cgUInt32 * begin = &order[first];
+            cgUInt32 * split = begin;
+            for ( cgUInt32 * it = begin; it != begin + count; ++it )
+            {
+                cgUInt32 b = (cgUInt32)((centroids[*it][bestAxis] - axisMin) * scale);
+                if ( b >= BinCount ) b = BinCount - 1;
+                if ( b <= bestSplit )
+                    std::swap( *it, *split++ );
+            
+            } // Next face
+            middle = (cgUInt32)(split - &order[0]);
+        
+        } // End if SAH split
+        else
+        {
+            // No usable SAH split. Fall back to a median split along the axis
+            // with the largest centroid extent so that the children remain
+            // spatially coherent.
+            const cgVector3 extent = centroidBounds.max - centroidBounds.min;
+            cgInt axis = 0;
+            if ( extent.y > extent[axis] ) axis = 1;
+            if ( extent.z > extent[axis] ) axis = 2;
+            middle = first + count / 2;
+            std::nth_element( &order[first], &order[middle], &order[first] + count, CentroidLess( &centroids[0], axis ) );
+        
+        } // End if no SAH split
+
+        // Create child nodes (stored consecutively).
+        const cgUInt32 leftIndex = (cgUInt32)mNodes.size();
+        Node left, right;
+        left.first  = first;
+        left.count  = middle - first;
+        right.first = middle;
+        right.count = count - left.count;
+        mNodes.push_back( left );
+        mNodes.push_back( right );
+        mNodes[entry.node].first = leftIndex;
+        mNodes[entry.node].count = 0;
+
+        // Process children.
+        BuildEntry leftEntry  = { leftIndex, entry.depth + 1 };
+        BuildEntry rightEntry = { leftIndex + 1, entry.depth + 1 };
+        stack.push_back( rightEntry );
+        stack.push_back( leftEntry );
+
+    } // Next node
+
+    // Copy triangle data in leaf order.
+    mTriangles.resize( faceCount );
+    for ( cgUInt32 i = 0; i < faceCount; ++i )
+    {
+        const cgUInt32 face = order[i];
+        Triangle & triangle = mTriangles[i];
+        triangle.v1   = *(cgVector3*)(vertices + (indices[ face * 3 ] * vertexStride) + positionOffset);
+        triangle.v2   = *(cgVector3*)(vertices + (indices[ (face * 3) + 1 ] * vertexStride) + positionOffset);
+        triangle.v3   = *(cgVector3*)(vertices + (indices[ (face * 3) + 2 ] * vertexStride) + positionOffset);
+        triangle.face = face;
+        cgVector3::cross( triangle.normal, triangle.v2 - triangle.v1, triangle.v3 - triangle.v1 );
+        cgVector3::normalize( triangle.normal, triangle.normal );
+    
+    } // Next face
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersect ()
+/// <summary>
+/// Find the closest front facing triangle intersected by the specified ray.
+/// Distance is returned in units of the (not necessarily normalized) ray 
+/// direction vector.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTriangleBVH::intersect( const cgVector3 & origin, const cgVector3 & direction, cgFloat & distanceOut, cgUInt32 & faceOut, FaceFilterFunc filter /* = CG_NULL */, void * filterContext /* = CG_NULL */ ) const
+{
+    using namespace TriangleBVH;
+    if ( mNodes.empty() )
+        return false;
+
+    // Test against the root.
+    const cgVector3 inverse( safeInverse( direction.x ), safeInverse( direction.y ), safeInverse( direction.z ) );
+    cgFloat closest = FLT_MAX, t;
+    StackEntry stack[StackSize];
+    cgUInt32 stackSize = 0;
+    if ( !rayBox( mNodes[0].boundsMin, mNodes[0].boundsMax, origin, inverse, closest, stack[0].entry ) )
+        return false;
+    stack[stackSize++].node = 0;
+
+    // Traverse.
+    bool hit = false;
+    while ( stackSize )
+    {
+        const StackEntry & entry = stack[--stackSize];
+        if ( entry.entry > closest )
+            continue;
+        const Node & node = mNodes[entry.node];
+        if ( node.count )
+        {
+            // Test leaf triangles.
+            for ( cgUInt32 i = node.first; i < node.first + node.count; ++i )
+            {
+                const Triangle & triangle = mTriangles[i];
+                if ( filter && !filter( triangle.face, filterContext ) )
+                    continue;
+                if ( cgCollision::rayIntersectTriangle( origin, direction, triangle.v1, triangle.v2, triangle.v3, triangle.normal, t, mTolerance, false, false ) && t < closest )
+                {
+                    closest = t;
+                    faceOut = triangle.face;
+                    hit     = true;
+                
+                } // End if closest
+
+            } // Next triangle
+        
+        } // End if leaf
+        else
+        {
+            // Visit the nearest child first.
+            cgFloat leftEntry, rightEntry;
+            const Node & left = mNodes[node.first], & right = mNodes[node.first+1];
+            const bool hitLeft  = rayBox( left.boundsMin, left.boundsMax, origin, inverse, closest, leftEntry );
+            const bool hitRight = rayBox( right.boundsMin, right.boundsMax, origin, inverse, closest, rightEntry );
+            const cgUInt32 children = node.first;
+            if ( hitLeft && hitRight )
+            {
+                const bool leftFirst = (leftEntry <= rightEntry);
+                stack[stackSize].node    = leftFirst ? children + 1 : children;
+                stack[stackSize++].entry = leftFirst ? rightEntry : leftEntry;
+                stack[stackSize].node    = leftFirst ? children : children + 1;
+                stack[stackSize++].entry = leftFirst ? leftEntry : rightEntry;
+            
+            } // End if both
+            else if ( hitLeft )
+            {
+                stack[stackSize].node    = children;
+                stack[stackSize++].entry = leftEntry;
+            
+            } // End if left
+            else if ( hitRight )
+            {
+                stack[stackSize].node    = children + 1;
+                stack[stackSize++].entry = rightEntry;
+            
+            } // End if right
+
+        } // End if interior
+
+    } // Next node
+
+    // Return closest intersection.
+    if ( hit )
+        distanceOut = closest;
+    return hit;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersectPacket ()
+/// <summary>
+/// Find the closest front facing triangle intersected by each ray in a packet
+/// of up to 'MaxPacketSize' rays. Rays are traversed together, testing each
+/// node once for the whole packet, which is most effective for coherent rays
+/// (neighboring pixels, sampling kernels, etc.) Returns a bit mask indicating
+/// which rays intersected the mesh. Distance and face outputs are only written
+/// for rays that hit.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgTriangleBVH::intersectPacket( cgUInt32 rayCount, const cgVector3 origins[], const cgVector3 directions[], cgFloat distancesOut[], cgUInt32 facesOut[], FaceFilterFunc filter /* = CG_NULL */, void * filterContext /* = CG_NULL */ ) const
+{
+    using namespace TriangleBVH;
+    if ( mNodes.empty() || !rayCount )
+        return 0;
+    if ( rayCount > MaxPacketSize )
+        rayCount = MaxPacketSize;
+
+    // Build the packet. Unused lanes are disabled by giving them a negative
+    // closest distance which can never pass the slab test.
+    Packet packet;
+    for ( cgUInt32 i = 0; i < MaxPacketSize; ++i )
+    {
+        const bool active = (i < rayCount);
+        packet.ox[i] = active ? origins[i].x : 0.0f;
+        packet.oy[i] = active ? origins[i].y : 0.0f;
+        packet.oz[i] = active ? origins[i].z : 0.0f;
+        packet.ix[i] = active ? safeInverse( directions[i].x ) : 1.0f;
+        packet.iy[i] = active ? safeInverse( directions[i].y ) : 1.0f;
+        packet.iz[i] = active ? safeInverse( directions[i].z ) : 1.0f;
+        packet.closest[i] = active ? FLT_MAX : -FLT_MAX;
+    
+    } // Next ray
+
+    // Determine the child visit order from the first ray's direction.
+    const cgVector3 & leadDirection = directions[0];
+
+    // Traverse.
+    cgUInt32 stack[StackSize], stackSize = 0, hitMask = 0;
+    stack[stackSize++] = 0;
+    while ( stackSize )
+    {
+        const Node & node = mNodes[stack[--stackSize]];
+        const cgUInt32 mask = packetBox( node.boundsMin, node.boundsMax, packet );
+        if ( !mask )
+            continue;
+
+        if ( node.count )
+        {
+            // Test leaf triangles against each active ray.
+            cgFloat t;
+            for ( cgUInt32 i = node.first; i < node.first + node.count; ++i )
+            {
+                const Triangle & triangle = mTriangles[i];
+                if ( filter && !filter( triangle.face, filterContext ) )
+                    continue;
+                for ( cgUInt32 r = 0; r < rayCount; ++r )
+                {
+                    if ( !(mask & (1 << r)) )
+                        continue;
+                    if ( cgCollision::rayIntersectTriangle( origins[r], directions[r], triangle.v1, triangle.v2, triangle.v3, triangle.normal, t, mTolerance, false, false ) && t < packet.closest[r] )
+                    {
+                        packet.closest[r] = t;
+                        facesOut[r]       = triangle.face;
+                        hitMask          |= (1 << r);
+                    
+                    } // End if closest
+
+                } // Next ray
+
+            } // Next triangle
+        
+        } // End if leaf
+        else
+        {
+            // Push the far child first, choosing based on the lead ray 
+            // direction along the axis of greatest child separation.
+            const Node & left = mNodes[node.first], & right = mNodes[node.first+1];
+            cgInt axis = 0;
+            cgFloat bestSeparation = -1.0f;
+            for ( cgInt a = 0; a < 3; ++a )
+            {
+                const cgFloat separation = fabsf( (right.boundsMin[a] + right.boundsMax[a]) - (left.boundsMin[a] + left.boundsMax[a]) );
+                if ( separation > bestSeparation )
+                {
+                    bestSeparation = separation;
+                    axis = a;
+                
+                } // End if better
+            
+            } // Next axis
+            const bool rightIsFar = ((right.boundsMin[axis] + right.boundsMax[axis]) > (left.boundsMin[axis] + left.boundsMax[axis])) == (leadDirection[axis] >= 0.0f);
+            stack[stackSize++] = rightIsFar ? node.first + 1 : node.first;
+            stack[stackSize++] = rightIsFar ? node.first : node.first + 1;
+
+        } // End if interior
+
+    } // Next node
+
+    // Output distances for those rays that hit.
+    for ( cgUInt32 r = 0; r < rayCount; ++r )
+    {
+        if ( hitMask & (1 << r) )
+            distancesOut[r] = packet.closest[r];
+    
+    } // Next ray
+    return hitMask;
+}
@@ -32,6 +32,7 @@
 #include <Resources/cgMesh.h>
 #include <Math/cgMathUtility.h>
 #include <System/cgStringUtility.h>
+#include <System/cgJobSystem.h>
 #include "../../Lib/Detour/Include/DetourNavMesh.h"
 #include "../../Lib/Recast/Include/Recast.h"
 
@@ -41,9 +42,68 @@
 cgWorldQuery cgNavigationMesh::mInsertMesh;
 cgWorldQuery cgNavigationMesh::mUpdateParameters;
 cgWorldQuery cgNavigationMesh::mDeleteTiles;
+cgWorldQuery cgNavigationMesh::mDeleteTile;
 cgWorldQuery cgNavigationMesh::mLoadMesh;
 cgWorldQuery cgNavigationMesh::mLoadTiles;
 
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+// Support for the (optionally parallel) navigation tile build.
+namespace NavigationBuild
+{
+    // Describes a single tile that is to be constructed.
+    struct TileJob
+    {
+        cgInt32                         x, z;       // Location of the tile in the tile grid.
+        cgBoundingBox                   bounds;     // World space bounds of the tile.
+        cgArray<cgMesh*>                meshes;     // Meshes (resolved by the calling thread) that intersect the (expanded) tile.
+        cgArray<cgTransform>            transforms; // World transforms for the above meshes.
+        cgLandscape::TerrainBlockArray  blocks;     // Terrain blocks that intersect the (expanded) tile.
+        cgNavigationTile              * tile;       // Constructed tile (or CG_NULL on failure).
+        const cgNavigationMeshCreateParams* params; // Parameters to build with.
+        cgNavigationMesh              * navMesh;    // Navigation mesh that will own the tile.
+        cgJobCounter                    counter;    // Completes once the tile has been built.
+    };
+    CGE_ARRAY_DECLARE( TileJob*, TileJobArray )
+
+    //-------------------------------------------------------------------------
+    //  Name : runJob ()
+    /// <summary>
+    /// Construct the navigation data for the specified tile job. On failure,
+    /// or if no data was generated, the job's tile is set to CG_NULL.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void runJob( const cgNavigationMeshCreateParams & params, TileJob & job, cgNavigationMesh * navMesh )
+    {
+        cgNavigationTile * tile = new cgNavigationTile( job.x, 0, job.z, navMesh );
+        if ( !tile->buildTile( params, job.bounds, (cgUInt32)job.meshes.size(), (job.meshes.empty()) ? CG_NULL : &job.meshes.front(), 
+                               (job.transforms.empty()) ? CG_NULL : &job.transforms.front(),
+                               (cgUInt32)job.blocks.size(), (job.blocks.empty()) ? CG_NULL : &job.blocks.front() ) ||
+             tile->getNavigationData().empty() )
+        {
+            // Nothing was generated (ToDo: print warning on failure?)
+            tile->scriptSafeDispose();
+            tile = CG_NULL;
+
+        } // End if failed
+        job.tile = tile;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : tileJob ()
+    /// <summary>
+    /// Job system entry point used to build a single tile.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void tileJob( void * context )
+    {
+        TileJob * job = (TileJob*)context;
+        runJob( *job->params, *job, job->navMesh );
+    }
+
+}; // End namespace NavigationBuild
+
 ///////////////////////////////////////////////////////////////////////////////
 // cgNavigationMesh Members
 ///////////////////////////////////////////////////////////////////////////////
@@ -61,6 +121,9 @@ cgNavigationMesh::cgNavigationMesh( ) : cgWorldComponent( cgReferenceManager::ge
     mTilesY = 0;
     mTilesZ = 0;
     mGeomBounds.reset();
+    mBuildThreadCount     = 0;
+    mBuildProgress        = CG_NULL;
+    mBuildProgressContext = CG_NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -77,6 +140,9 @@ cgNavigationMesh::cgNavigationMesh( cgUInt32 referenceId, cgWorld * world ) : cg
     mTilesY = 0;
     mTilesZ = 0;
     mGeomBounds.reset();
+    mBuildThreadCount     = 0;
+    mBuildProgress        = CG_NULL;
+    mBuildProgressContext = CG_NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -463,6 +529,8 @@ void cgNavigationMesh::prepareQueries()
             mUpdateParameters.prepare( mWorld, _T("UPDATE 'DataSources::NavigationMesh' SET Flags=?1, TilesX=?2, TilesY=?3, TilesZ=?4, BoundsMinX=?5, BoundsMinY=?6, BoundsMinZ=?7, BoundsMaxX=?8, BoundsMaxY=?9, BoundsMaxZ=?10, CellSize=?11, CellHeight=?12, TileCells=?13, AgentRadius=?14, AgentHeight=?15, AgentMaximumSlope=?16, AgentMaximumStepHeight=?17, EdgeMaximumLength=?18, EdgeMaximumError=?19, RegionMinimumSize=?20, RegionMergedSize=?21, VerticesPerPoly=?22, DetailSampleDistance=?23, DetailSampleMaximumError=?24  WHERE RefId=?25"), true );
         if ( !mDeleteTiles.isPrepared( mWorld ) )
             mDeleteTiles.prepare( mWorld, _T("DELETE FROM 'DataSources::NavigationMesh::Tiles' WHERE DataSourceId=?1"), true );
+        if ( !mDeleteTile.isPrepared( mWorld ) )
+            mDeleteTile.prepare( mWorld, _T("DELETE FROM 'DataSources::NavigationMesh::Tiles' WHERE TileId=?1"), true );
     
     } // End if sandbox
 
@@ -641,118 +709,365 @@ bool cgNavigationMesh::build( const cgNavigationMeshCreateParams & params, cgUIn
 	
     } // End if failed
 
-    // Generate all potential cells.
-    cgBoundingBox tileBounds;
-    for ( cgInt z = 0; z < tilesZ; ++z)
+    // Construct all tiles.
+    buildTiles( 0, 0, tilesX - 1, tilesZ - 1, meshCount, meshData, meshTransforms, (meshCount) ? &meshBounds[0] : CG_NULL, landscape );
+
+    // Save changes.
+    if ( transactionBegun )
+        mWorld->commitTransaction( _T("NavigationMesh::build") );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : rebuild ()
+/// <summary>
+/// Reconstruct only those navigation tiles that could be affected by a change
+/// to the geometry within the specified world space region (i.e. when an 
+/// object is moved or the landscape is modified). The supplied geometry should
+/// include everything that overlaps the region. Tiles remain live in the 
+/// existing navigation mesh until their replacements are available, and the
+/// navigation mesh itself is not reallocated such that any active agents can
+/// continue to navigate. Note: The extents of the tile grid are established
+/// during a full build and any geometry that falls outside of it is ignored.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgNavigationMesh::rebuild( const cgBoundingBox & region, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgLandscape * landscape )
+{
+    // A full build must have been performed (or loaded) first.
+    if ( !mMesh || mTilesX <= 0 || mTilesZ <= 0 )
+    {
+        cgAppLog::write( cgAppLog::Warning, _T("Unable to rebuild region of navigation mesh data source '0x%x' before it has been fully built.\n"), mReferenceId );
+        return false;
+    
+    } // End if not built
+
+    // Compute the range of tiles affected. Tiles are constructed with a border 
+    // of 'agentRadius + (3*cellsize)' so any tile whose inflated bounds intersect
+    // the region must be rebuilt.
+    const dtNavMeshParams * dtparams = mMesh->getParams();
+    const cgFloat tileSize   = dtparams->tileWidth;
+    const cgFloat tileBorder = (ceilf(mParams.agentRadius / mParams.cellSize) + 3) * mParams.cellSize;
+    const cgInt32 minTileX   = max( 0, (cgInt32)floorf( (region.min.x - tileBorder - dtparams->orig[0]) / tileSize ) );
+    const cgInt32 maxTileX   = min( mTilesX - 1, (cgInt32)floorf( (region.max.x + tileBorder - dtparams->orig[0]) / tileSize ) );
+    const cgInt32 minTileZ   = max( 0, (cgInt32)floorf( (region.min.z - tileBorder - dtparams->orig[2]) / tileSize ) );
+    const cgInt32 maxTileZ   = min( mTilesZ - 1, (cgInt32)floorf( (region.max.z + tileBorder - dtparams->orig[2]) / tileSize ) );
+    if ( minTileX > maxTileX || minTileZ > maxTileZ )
+        return true;
+
+    cgAppLog::write( cgAppLog::Info | cgAppLog::Debug, _T("Rebuilding navigation tiles <%i,%i> to <%i,%i> based on geometry collected from %i available meshes.\n"), minTileX, minTileZ, maxTileX, maxTileZ, meshCount );
+
+    // Compute the world space bounding boxes of the supplied meshes.
+    cgArray<cgBoundingBox> meshBounds( meshCount );
+    for ( cgUInt32 i = 0; i < meshCount; ++i )
+    {
+        if ( !meshData[i].isValid() )
+            continue;
+        meshBounds[i] = meshData[i]->getBoundingBox();
+        meshBounds[i].transform( meshTransforms[i] );
+    
+    } // Next mesh
+
+    // If we need to serialize, open a new transaction.
+    bool transactionBegun = false;
+    if ( shouldSerialize() )
+    {
+        prepareQueries();
+        mWorld->beginTransaction( _T("NavigationMesh::rebuild") );
+        transactionBegun = true;
+    
+    } // End if serialize
+
+    // Detach existing tiles in the affected range. Their data remains in
+    // the navigation mesh until it is replaced (or the rebuild completes).
+    TileArray retiredTiles, activeTiles;
+    activeTiles.reserve( mTiles.size() );
+    for ( size_t i = 0; i < mTiles.size(); ++i )
+    {
+        cgNavigationTile * tile = mTiles[i];
+        if ( tile->mTileX >= minTileX && tile->mTileX <= maxTileX &&
+             tile->mTileZ >= minTileZ && tile->mTileZ <= maxTileZ )
+            retiredTiles.push_back( tile );
+        else
+            activeTiles.push_back( tile );
+    
+    } // Next tile
+    mTiles = activeTiles;
+
+    // Construct the replacement tiles. Each is swapped into the navigation
+    // mesh as soon as it becomes available.
+    buildTiles( minTileX, minTileZ, maxTileX, maxTileZ, meshCount, meshData, meshTransforms, (meshCount) ? &meshBounds[0] : CG_NULL, landscape );
+
+    // Release the retired tiles.
+    for ( size_t i = 0; i < retiredTiles.size(); ++i )
+    {
+        cgNavigationTile * tile = retiredTiles[i];
+
+        // If the tile was not replaced, it is still referenced by the
+        // navigation mesh and must be removed.
+        const dtMeshTile * meshTile = mMesh->getTileAt( tile->mTileX, tile->mTileZ, 0 );
+        if ( meshTile && !tile->mNavData.empty() && meshTile->data == &tile->mNavData.front() )
+            mMesh->removeTile( mMesh->getTileRef( meshTile ), 0, 0 );
+
+        // Remove the database entry.
+        if ( transactionBegun && tile->mDatabaseId )
+        {
+            mDeleteTile.bindParameter( 1, tile->mDatabaseId );
+            if ( !mDeleteTile.step( true ) )
+            {
+                cgString error;
+                mDeleteTile.getLastError( error );
+                cgAppLog::write( cgAppLog::Error, _T("Failed to remove prior tile data <%i,%i,%i> for navigation mesh data source '0x%x'. Error: %s\n"), tile->mTileX, tile->mTileY, tile->mTileZ, mReferenceId, error.c_str() );
+            
+            } // End if failed
+
+        } // End if serialized
+        tile->scriptSafeDispose();
+    
+    } // Next tile
+
+    // Save changes.
+    if ( transactionBegun )
+        mWorld->commitTransaction( _T("NavigationMesh::rebuild") );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildTiles () (Protected)
+/// <summary>
+/// Construct (or reconstruct) all tiles within the specified inclusive range
+/// of the tile grid using the supplied geometry and commit them to the 
+/// navigation mesh. Tiles are built on the job system (or on the calling
+/// thread alone as configured via 'setBuildThreadCount()') but are always 
+/// committed in row-major order from the calling thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgNavigationMesh::buildTiles( cgInt32 minTileX, cgInt32 minTileZ, cgInt32 maxTileX, cgInt32 maxTileZ, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], const cgBoundingBox meshBounds[], cgLandscape * landscape )
+{
+    // Build a simple spatial index that maps each tile to the meshes that
+    // fall within its bounding box, inflated by at least 'agentRadius + 
+    // (3*cellsize)' to ensure that the mesh builder knows that the geometry
+    // continues off the edge of the tile. Mesh indices are stored in 
+    // ascending order for each tile.
+    const dtNavMeshParams * dtparams = mMesh->getParams();
+    const cgFloat tileSize = dtparams->tileWidth;
+    const cgVector3 origin( dtparams->orig[0], dtparams->orig[1], dtparams->orig[2] );
+    const cgFloat tileBorder = (ceilf(mParams.agentRadius / mParams.cellSize) + 3) * mParams.cellSize;
+    const cgInt32 tilesX = (maxTileX - minTileX) + 1;
+    const cgInt32 tilesZ = (maxTileZ - minTileZ) + 1;
+    const cgUInt32 tileCount = (cgUInt32)(tilesX * tilesZ);
+
+    // Resolve all referenced mesh data up front on this thread since tiles
+    // may be constructed outside of the main thread. The caller's handles
+    // keep the resources alive for the duration of the build.
+    cgArray<cgMesh*> meshes( meshCount, (cgMesh*)CG_NULL );
+    for ( cgUInt32 i = 0; i < meshCount; ++i )
+    {
+        if ( meshData[i].isValid() )
+            meshes[i] = meshData[i].getResource(true);
+    
+    } // Next mesh
+
+    cgUInt32Array tileMeshStart( tileCount + 1, 0 ), tileMeshIndices;
+    cgArray<cgInt32> meshTileRanges( meshCount * 4 );
+    for ( cgInt pass = 0; pass < 2; ++pass )
+    {
+        for ( cgUInt32 i = 0; i < meshCount; ++i )
+        {
+            if ( !meshes[i] )
+                continue;
+
+            // Compute the range of tiles covered by this mesh on the first pass.
+            cgInt32 * range = &meshTileRanges[i*4];
+            if ( pass == 0 )
+            {
+                const cgBoundingBox & bounds = meshBounds[i];
+                range[0] = max( 0, (cgInt32)floorf( (bounds.min.x - tileBorder - origin.x) / tileSize ) - minTileX );
+                range[1] = min( tilesX - 1, (cgInt32)floorf( (bounds.max.x + tileBorder - origin.x) / tileSize ) - minTileX );
+                range[2] = max( 0, (cgInt32)floorf( (bounds.min.z - tileBorder - origin.z) / tileSize ) - minTileZ );
+                range[3] = min( tilesZ - 1, (cgInt32)floorf( (bounds.max.z + tileBorder - origin.z) / tileSize ) - minTileZ );
+            
+            } // End if first pass
+
+            // Count (first pass) or store (second pass) the mesh in each tile.
+            for ( cgInt32 z = range[2]; z <= range[3]; ++z )
+            {
+                for ( cgInt32 x = range[0]; x <= range[1]; ++x )
+                {
+                    if ( pass == 0 )
+                        tileMeshStart[ z * tilesX + x + 1 ]++;
+                    else
+                        tileMeshIndices[ tileMeshStart[ z * tilesX + x ]++ ] = i;
+                
+                } // Next column
+            
+            } // Next row
+
+        } // Next mesh
+
+        // Convert counts into offsets after the first pass, and restore them
+        // after the second pass (which advanced each offset by its count).
+        if ( pass == 0 )
+        {
+            for ( cgUInt32 i = 0; i < tileCount; ++i )
+                tileMeshStart[i+1] += tileMeshStart[i];
+            tileMeshIndices.resize( tileMeshStart[tileCount] );
+        
+        } // End if first pass
+        else
+        {
+            for ( cgUInt32 i = tileCount; i > 0; --i )
+                tileMeshStart[i] = tileMeshStart[i-1];
+            tileMeshStart[0] = 0;
+
+        } // End if second pass
+
+    } // Next pass
+
+    // Generate a job for every potential tile that contains geometry.
+    NavigationBuild::TileJobArray jobs;
+    for ( cgInt z = minTileZ; z <= maxTileZ; ++z)
 	{
-		for ( cgInt x = 0; x < tilesX; ++x)
+		for ( cgInt x = minTileX; x <= maxTileX; ++x)
 		{
-            // Remove previous tile data at this location
-            mMesh->removeTile( mMesh->getTileRefAt(x,z,0), 0, 0 );
-
             // Compute the bounding box of this tile.
-            tileBounds.min.x = geomBounds.min.x + x * tileSize;
-            tileBounds.min.y = geomBounds.min.y;
-            tileBounds.min.z = geomBounds.min.z + z * tileSize;
-
-            tileBounds.max.x = geomBounds.min.x + (x+1) * tileSize;
-            tileBounds.max.y = geomBounds.max.y;
-            tileBounds.max.z = geomBounds.min.z + (z+1) * tileSize;
-
-            // Get all meshes that fall within the bounding box of this tile, but
-            // make sure it is inflated by at least 'agentRadius + (3*cellsize)'
-            // to ensure that the mesh builder knows that the geometry continues
-            // off the edge of the tile.
+            cgBoundingBox tileBounds;
+            tileBounds.min.x = origin.x + x * tileSize;
+            tileBounds.min.y = mGeomBounds.min.y;
+            tileBounds.min.z = origin.z + z * tileSize;
+
+            tileBounds.max.x = origin.x + (x+1) * tileSize;
+            tileBounds.max.y = mGeomBounds.max.y;
+            tileBounds.max.z = origin.z + (z+1) * tileSize;
+
+            // Get all meshes that fall within the expanded bounding box of this tile.
+            NavigationBuild::TileJob * job = new NavigationBuild::TileJob();
             cgBoundingBox expandedTileBounds = tileBounds;
-            expandedTileBounds.inflate( (ceilf(mParams.agentRadius / mParams.cellSize) + 3) * mParams.cellSize );
-            cgArray<cgMeshHandle> intersectedMeshes;
-            cgArray<cgTransform> intersectedTransforms;
-            for ( cgUInt32 i = 0; i < meshCount; ++i )
+            expandedTileBounds.inflate( tileBorder );
+            const cgUInt32 tileIndex = (cgUInt32)((z - minTileZ) * tilesX + (x - minTileX));
+            for ( cgUInt32 i = tileMeshStart[tileIndex]; i < tileMeshStart[tileIndex+1]; ++i )
             {
-                if ( expandedTileBounds.intersect( meshBounds[i] ) )
+                const cgUInt32 mesh = tileMeshIndices[i];
+                if ( expandedTileBounds.intersect( meshBounds[mesh] ) )
                 {
-                    // Reserve space for all meshes the first time we find one.
-                    if ( intersectedMeshes.capacity() == 0 )
-                    {
-                        intersectedMeshes.reserve( meshCount );
-                        intersectedTransforms.reserve( meshCount );
-                    
-                    } // End if first discovered mesh?
-
-                    // Add this mesh to the intersected list.
-                    intersectedMeshes.push_back( meshData[i] );
-                    intersectedTransforms.push_back( meshTransforms[i] );
+                    job->meshes.push_back( meshes[mesh] );
+                    job->transforms.push_back( meshTransforms[mesh] );
                 
                 } // End if intersects
             
             } // Next mesh
 
             // Get landscape terrain blocks if any.
-            cgLandscape::TerrainBlockArray intersectedTerrainBlocks;
             if ( landscape )
-                landscape->getTerrainBlocks( expandedTileBounds, intersectedTerrainBlocks );
+                landscape->getTerrainBlocks( expandedTileBounds, job->blocks );
 
             // Anything discovered?
-            if ( intersectedMeshes.empty() && intersectedTerrainBlocks.empty() )
-                continue;
-
-            // Allocate a new navigation tile.
-            cgNavigationTile * tile = new cgNavigationTile( x, 0, z, this );
-            if ( !tile->buildTile( mParams, tileBounds, (cgUInt32)intersectedMeshes.size(), (intersectedMeshes.empty()) ? CG_NULL : &intersectedMeshes.front(), 
-                                  (intersectedTransforms.empty()) ? CG_NULL : &intersectedTransforms.front(),
-                                  (cgUInt32)intersectedTerrainBlocks.size(), (intersectedTerrainBlocks.empty()) ? CG_NULL : &intersectedTerrainBlocks.front() ) )
-            {
-                // ToDo: print warning?
-                tile->scriptSafeDispose();
-                continue;
-
-            } // End if failed
-
-            // Get the generated tile data.
-            const cgByteArray & navData = tile->getNavigationData();
-            if ( navData.empty() )
+            if ( job->meshes.empty() && job->blocks.empty() )
             {
-                // Nothing was generated.
-                tile->scriptSafeDispose();
+                delete job;
                 continue;
             
-            } // End if no data
-
-            // Add new tile data.
-            dtTileRef tileRef;
-            dtStatus status = mMesh->addTile( (cgByte*)&navData.front(), (cgInt)navData.size(), 0, 0, &tileRef );
-			if ( dtStatusFailed(status) )
-            {
-                cgAppLog::write( cgAppLog::Warning, _T("Failed to add navigation tile to the mesh at <%d,%d,%d>.\n"), x, 0, z );
-                tile->scriptSafeDispose();
-                continue;
-			
-			} // End if failed
-
-            // Attempt to serialize.
-            if ( shouldSerialize() )
-            {
-                if ( !tile->serialize( mReferenceId, mWorld ) )
-                {
-                    tile->scriptSafeDispose();
-                    continue;
-                
-                } // End if failed
+            } // End if nothing
             
-            } // End if failed
-
-            // Store reference to the tile.
-            mTiles.push_back( tile );
+            // Queue the job.
+            job->x        = x;
+            job->z        = z;
+            job->bounds   = tileBounds;
+            job->tile     = CG_NULL;
+            job->params   = &mParams;
+            job->navMesh  = this;
+            jobs.push_back( job );
 		
         } // Next column
 	
     } // Next row
 
-    // Save changes.
-    if ( transactionBegun )
-        mWorld->commitTransaction( _T("NavigationMesh::build") );
+    // Build the tiles. Irrespective of the number of threads used, tiles
+    // are always committed to the navigation mesh (and database) from this
+    // thread in the same order to guarantee deterministic output.
+    const cgUInt32 jobCount = (cgUInt32)jobs.size();
+    if ( mBuildThreadCount == 1 || jobCount <= 1 )
+    {
+        for ( cgUInt32 i = 0; i < jobCount; ++i )
+        {
+            NavigationBuild::runJob( mParams, *jobs[i], this );
+            commitTile( jobs[i]->tile );
+            if ( mBuildProgress )
+                mBuildProgress( this, i + 1, jobCount, mBuildProgressContext );
+        
+        } // Next job
+    
+    } // End if serial
+    else
+    {
+        // Submit every tile, each signaling its own counter on completion.
+        for ( cgUInt32 i = 0; i < jobCount; ++i )
+            cgJobSystem::submit( NavigationBuild::tileJob, jobs[i], &jobs[i]->counter );
+
+        // Commit each tile in order as soon as it completes. Waiting on a
+        // counter executes outstanding tile jobs on this thread rather than
+        // blocking, so the calling thread participates in the build.
+        for ( cgUInt32 i = 0; i < jobCount; ++i )
+        {
+            cgJobSystem::wait( &jobs[i]->counter );
+            commitTile( jobs[i]->tile );
+            if ( mBuildProgress )
+                mBuildProgress( this, i + 1, jobCount, mBuildProgressContext );
+        
+        } // Next job
+    
+    } // End if parallel
 
-    // Success!
+    // Release jobs.
+    for ( cgUInt32 i = 0; i < jobCount; ++i )
+        delete jobs[i];
+}
+
+//-----------------------------------------------------------------------------
+//  Name : commitTile () (Protected)
+/// <summary>
+/// Add the data for a newly constructed tile to the navigation mesh and 
+/// serialize it as necessary. The tile is released on failure. Passing a 
+/// CG_NULL tile is a no-op.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgNavigationMesh::commitTile( cgNavigationTile * tile )
+{
+    if ( !tile )
+        return false;
+
+    // Remove previous tile data at this location
+    mMesh->removeTile( mMesh->getTileRefAt( tile->mTileX, tile->mTileZ, 0 ), 0, 0 );
+
+    // Add new tile data.
+    const cgByteArray & navData = tile->getNavigationData();
+    dtTileRef tileRef;
+    dtStatus status = mMesh->addTile( (cgByte*)&navData.front(), (cgInt)navData.size(), 0, 0, &tileRef );
+	if ( dtStatusFailed(status) )
+    {
+        cgAppLog::write( cgAppLog::Warning, _T("Failed to add navigation tile to the mesh at <%d,%d,%d>.\n"), tile->mTileX, 0, tile->mTileZ );
+        tile->scriptSafeDispose();
+        return false;
+	
+	} // End if failed
+
+    // Attempt to serialize.
+    if ( shouldSerialize() )
+    {
+        if ( !tile->serialize( mReferenceId, mWorld ) )
+        {
+            tile->scriptSafeDispose();
+            return false;
+        
+        } // End if failed
+    
+    } // End if failed
+
+    // Store reference to the tile.
+    mTiles.push_back( tile );
     return true;
 }
 
@@ -869,4 +1184,45 @@ const cgNavigationMeshCreateParams & cgNavigationMesh::getParameters() const
 cgUInt32 cgNavigationMesh::getTileCount( ) const
 {
     return (cgUInt32)mTiles.size();
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setBuildThreadCount()
+/// <summary>
+/// Set the number of threads that should be used to construct navigation
+/// tiles during a build. A value of 1 will build all tiles on the calling
+/// thread. Any other value distributes the tiles over the engine job system,
+/// whose worker count is fixed at startup ('CGEConfig::workerThreads'). The
+/// generated data is identical in all cases.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgNavigationMesh::setBuildThreadCount( cgUInt32 threadCount )
+{
+    mBuildThreadCount = threadCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getBuildThreadCount()
+/// <summary>
+/// Retrieve the number of threads that should be used to construct navigation
+/// tiles during a build (1 = calling thread only, otherwise job system).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgNavigationMesh::getBuildThreadCount( ) const
+{
+    return mBuildThreadCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setBuildProgressCallback()
+/// <summary>
+/// Set the function that will be called each time a tile has been processed
+/// during a build. The callback is always triggered from the thread that
+/// called 'build()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgNavigationMesh::setBuildProgressCallback( BuildProgressFunc callback, void * context )
+{
+    mBuildProgress        = callback;
+    mBuildProgressContext = context;
+}
@@ -106,7 +106,7 @@ void cgNavigationTile::dispose( bool disposeBase )
 /// and construction parameters.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[] )
+bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMesh * meshData[], cgTransform meshTransforms[] )
 {
     return buildTile( params, tileBounds, meshCount, meshData, meshTransforms, 0, CG_NULL );
 }
@@ -115,10 +115,11 @@ bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, c
 //  Name : buildTile ()
 /// <summary>
 /// Construct the navigation data for this tile based on the supplied geometry
-/// and construction parameters.
+/// and construction parameters. Mesh resources must already have been
+/// resolved by the caller since tiles may be built on a worker thread.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMeshHandle meshData[], cgTransform meshTransforms[], cgUInt32 terrainBlockCount, cgTerrainBlock * blockData[] )
+bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, const cgBoundingBox & tileBounds, cgUInt32 meshCount, cgMesh * meshData[], cgTransform meshTransforms[], cgUInt32 terrainBlockCount, cgTerrainBlock * blockData[] )
 {
     // Deriving configuration values - http://digestingduck.blogspot.fi/2009/08/recast-settings-uncovered.html
     
@@ -130,7 +131,7 @@ bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, c
     cgInt totalVertices = 0, totalTriangles = 0;
     for ( cgUInt32 i = 0; i < meshCount; ++i )
     {
-        cgMesh * mesh = meshData[i].getResource(true);
+        cgMesh * mesh = meshData[i];
         totalVertices  += (cgInt)mesh->getVertexCount();
         totalTriangles += (cgInt)mesh->getFaceCount();
 
@@ -155,7 +156,7 @@ bool cgNavigationTile::buildTile( const cgNavigationMeshCreateParams & params, c
     totalVertices = totalTriangles = 0;
     for ( cgUInt32 i = 0; i < meshCount; ++i )
     {
-        cgMesh * mesh = meshData[i].getResource(true);
+        cgMesh * mesh = meshData[i];
         
         // Copy vertex positions (transformed).
         cgInt    meshVertexCount  = mesh->getVertexCount();
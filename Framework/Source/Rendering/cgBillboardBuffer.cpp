@@ -36,6 +36,56 @@
 #include <Resources/cgSurfaceShader.h>
 #include <World/Objects/cgCameraObject.h>
 #include <System/cgXML.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace BillboardSort
+{
+    // Radix digit configuration (three passes of 11 bits covers 32 bit keys).
+    const cgUInt32 RadixBits    = 11;
+    const cgUInt32 RadixBuckets = 1 << RadixBits;
+    const cgUInt32 RadixMask    = RadixBuckets - 1;
+    const cgUInt32 RadixPasses  = 3;
+
+    // Ranges smaller than this are always insertion sorted.
+    const cgUInt32 MinRadixCount = 64;
+
+    // Number of sorts to skip order reuse after a failed repair.
+    const cgInt32 RetryDelay = 8;
+
+    //-------------------------------------------------------------------------
+    // Name : DepthKeyLess (Struct)
+    // Desc : Orders depth sort entries by ascending key (back to front).
+    //-------------------------------------------------------------------------
+    struct DepthKeyLess
+    {
+        template <class _Entry>
+        bool operator()( const _Entry & a, const _Entry & b ) const
+        {
+            return a.depthKey < b.depthKey;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : depthKey()
+    // Desc : Encode the specified (squared) distance as an unsigned integer
+    //        key whose ascending order is the descending order of the
+    //        original floating point value (furthest first).
+    //-------------------------------------------------------------------------
+    inline cgUInt32 depthKey( cgFloat depth )
+    {
+        cgUInt32 bits;
+        memcpy( &bits, &depth, sizeof(cgUInt32) );
+        
+        // Flip the sign bit of positive values and all bits of negative values
+        // to produce a key that sorts in ascending float order, then invert it.
+        bits ^= (cgUInt32)((cgInt32)bits >> 31) | 0x80000000;
+        return ~bits;
+    }
+
+} // End Namespace : BillboardSort
 
 ///////////////////////////////////////////////////////////////////////////////
 // cgBillboardBuffer Members
@@ -55,6 +105,9 @@ cgBillboardBuffer::cgBillboardBuffer( )
     mBufferDirty      = false;
     mSampler          = CG_NULL;
     mVertexFormat     = CG_NULL;
+    mDepthOrderBegin  = 0;
+    mDepthOrderCount  = 0;
+    mDepthRetryDelay  = 0;
     
     // Clear structures
     memset( &mTechniques, 0, sizeof(Techniques) );
@@ -130,6 +183,12 @@ void cgBillboardBuffer::clear( bool destroyBillboards )
     // Clear containers
     mFrameGroups.clear();
     mFrameGroupNames.clear();
+    mDepthOrder.clear();
+    mDepthScratch.clear();
+    mDepthCandidates.clear();
+    mDepthOrderBegin  = 0;
+    mDepthOrderCount  = 0;
+    mDepthRetryDelay  = 0;
 
 }
 
@@ -711,19 +770,244 @@ void cgBillboardBuffer::render( cgInt32 billboardBegin /* = 0 */, cgInt32 billbo
 }
 
 //-----------------------------------------------------------------------------
-//  Name : billboardDepthCompare () (Private, Static)
+//  Name : radixSortDepth () (Private, Static)
+/// <summary>
+/// Sort the first 'count' entries of the depth list into ascending key order
+/// (back to front) using a stable least significant digit radix sort. Passes
+/// for which every key shares the same digit are skipped. The scratch buffer
+/// must be able to hold 'count' entries. Returns whichever of the two buffers
+/// holds the sorted result.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgBillboardBuffer::DepthSortInfo * cgBillboardBuffer::radixSortDepth( DepthSortInfo * data, DepthSortInfo * scratch, cgUInt32 count )
+{
+    using namespace BillboardSort;
+
+    // Small lists are cheaper to insertion sort.
+    if ( count < MinRadixCount )
+    {
+        insertionSortDepth( data, count, 0xFFFFFFFF );
+        return data;
+    
+    } // End if small
+
+    // Build histograms for all digits in a single pass.
+    cgUInt32 histogram[RadixPasses][RadixBuckets];
+    memset( histogram, 0, sizeof(histogram) );
+    for ( cgUInt32 i = 0; i < count; ++i )
+    {
+        const cgUInt32 key = data[i].depthKey;
+        ++histogram[0][key & RadixMask];
+        ++histogram[1][(key >> RadixBits) & RadixMask];
+        ++histogram[2][key >> (RadixBits * 2)];
+    
+    } // Next entry
+
+    // Scatter by each digit in turn.
+    for ( cgUInt32 pass = 0; pass < RadixPasses; ++pass )
+    {
+        cgUInt32 * offsets = histogram[pass];
+        const cgUInt32 shift = pass * RadixBits;
+
+        // Skip this digit if all keys share the same value.
+        if ( offsets[(data[0].depthKey >> shift) & RadixMask] == count )
+            continue;
+
+        // Convert counts into starting offsets.
+        cgUInt32 total = 0;
+        for ( cgUInt32 b = 0; b < RadixBuckets; ++b )
+        {
+            const cgUInt32 bucketCount = offsets[b];
+            offsets[b] = total;
+            total += bucketCount;
+        
+        } // Next bucket
+
+        // Scatter into the scratch buffer and swap.
+        for ( cgUInt32 i = 0; i < count; ++i )
+            scratch[ offsets[(data[i].depthKey >> shift) & RadixMask]++ ] = data[i];
+        std::swap( data, scratch );
+
+    } // Next pass
+    return data;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : insertionSortDepth () (Private, Static)
+/// <summary>
+/// Sort the depth list into ascending key order (back to front) using an
+/// insertion sort. This is efficient when the list is already almost in order,
+/// as it is when last frame's order is reused. If more than 'maxMoves' 
+/// entries would need to be shifted, the sort gives up and returns false. 
+/// The list remains a valid permutation in either case.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgBillboardBuffer::insertionSortDepth( DepthSortInfo * data, cgUInt32 count, cgUInt32 maxMoves )
+{
+    cgUInt32 moves = 0;
+    for ( cgUInt32 i = 1; i < count; ++i )
+    {
+        const DepthSortInfo entry = data[i];
+        if ( data[i-1].depthKey <= entry.depthKey )
+            continue;
+
+        // Shift larger keys up until the insertion point is found.
+        cgUInt32 j = i;
+        do
+        {
+            data[j] = data[j-1];
+            --j;
+        
+        } while ( j > 0 && data[j-1].depthKey > entry.depthKey );
+        data[j] = entry;
+
+        // Abort if the list is too far out of order.
+        moves += i - j;
+        if ( moves > maxMoves )
+            return false;
+    
+    } // Next entry
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : sortBillboards () (Private)
 /// <summary>
-/// qsort compatible comparison function to dest the depth
+/// Build the list of visible billboards in the specified (already validated)
+/// range, ordered back to front by their squared distance from the sort
+/// origin, and store it in 'mDepthOrder'. If the same range was sorted last
+/// time, the previous order is reused and repaired where possible. Returns
+/// the number of billboards in the sorted list.
 /// </summary>
 //-----------------------------------------------------------------------------
-int cgBillboardBuffer::billboardDepthCompare( const void *arg1, const void *arg2 )
+cgInt32 cgBillboardBuffer::sortBillboards( const cgVector3 & sortOrigin, cgInt32 billboardBegin, cgInt32 billboardCount )
 {
-   // (Note: swapped compare order because we want those furthest away first)
-   if ( ((DepthSortInfo*)arg1)->depth > ((DepthSortInfo*)arg2)->depth )
-       return -1;
-   if ( ((DepthSortInfo*)arg1)->depth < ((DepthSortInfo*)arg2)->depth )
-       return 1;
-   return 0;
+    // Build list of billboard depth info to be sorted. If the same range was 
+    // sorted last time, the previous order is likely to be almost correct (the
+    // camera and billboards rarely move far between frames), so the billboards
+    // are gathered in that order ready to be repaired.
+    cgInt32 finalCount = 0, reusedCount = 0;
+    bool coherent = (mDepthOrderBegin == billboardBegin && mDepthOrderCount == billboardCount);
+    if ( coherent && mDepthRetryDelay > 0 )
+    {
+        // Recent repair attempt failed. Sort from scratch for now.
+        --mDepthRetryDelay;
+        coherent = false;
+    
+    } // End if waiting
+    if ( coherent )
+    {
+        // Compute depth information for every billboard in the range, in 
+        // billboard order. Invisible billboards are marked with an Id of -1.
+        mDepthCandidates.resize( billboardCount );
+        for ( cgInt32 i = 0; i < billboardCount; ++i )
+        {
+            cgBillboard * billboard = mBillboards[ billboardBegin + i ];
+            DepthSortInfo & candidate = mDepthCandidates[i];
+            if ( !billboard || !billboard->getVisible() )
+            {
+                candidate.billboardId = -1;
+                continue;
+            
+            } // End if invisible
+            candidate.billboardId = billboardBegin + i;
+            candidate.depthKey    = BillboardSort::depthKey( cgVector3::lengthSq( billboard->getPosition() - sortOrigin ) );
+
+        } // Next Billboard
+
+        // Gather visible billboards in their previous order, compacting the
+        // list in place (the write position never overtakes the read position).
+        // Gathered candidates are marked to prevent them being appended below.
+        const cgInt32 previousCount = (cgInt32)mDepthOrder.size();
+        for ( cgInt32 i = 0; i < previousCount; ++i )
+        {
+            DepthSortInfo & candidate = mDepthCandidates[ mDepthOrder[i].billboardId - billboardBegin ];
+            if ( candidate.billboardId < 0 )
+                continue;
+            mDepthOrder[ finalCount++ ] = candidate;
+            candidate.billboardId = -1;
+
+        } // Next previous entry
+        reusedCount = finalCount;
+
+        // Append any billboards that became visible since the last sort.
+        mDepthOrder.resize( billboardCount );
+        for ( cgInt32 i = 0; i < billboardCount; ++i )
+        {
+            if ( mDepthCandidates[i].billboardId >= 0 )
+                mDepthOrder[ finalCount++ ] = mDepthCandidates[i];
+
+        } // Next Billboard
+    
+    } // End if coherent
+    else
+    {
+        mDepthOrder.resize( billboardCount );
+        for ( cgInt32 i = billboardBegin; i < billboardBegin + billboardCount; ++i )
+        {
+            cgBillboard * billboard = mBillboards[i];
+            
+            // Skip invalid or invisible billboards
+            if ( !billboard || !billboard->getVisible() )
+                continue;
+
+            // Valid billboard!
+            mDepthOrder[ finalCount ].billboardId = i;
+            mDepthOrder[ finalCount ].depthKey = BillboardSort::depthKey( cgVector3::lengthSq( billboard->getPosition() - sortOrigin ) );
+            finalCount++;
+
+        } // Next Billboard
+
+    } // End if !coherent
+
+    // Record the range this order describes.
+    mDepthOrder.resize( finalCount );
+    mDepthOrderBegin = billboardBegin;
+    mDepthOrderCount = billboardCount;
+
+    // If nothing made it this far, return (paranoia)
+    if ( !finalCount )
+        return 0;
+
+    // Sort the depth list.
+    mDepthScratch.resize( finalCount );
+    if ( coherent )
+    {
+        // Repair the previous order with an insertion sort. If too many entries 
+        // have to move (the camera or billboards moved significantly) give up 
+        // and stop trying for a few frames.
+        if ( insertionSortDepth( &mDepthOrder[0], reusedCount, reusedCount ) )
+        {
+            // Sort any newly visible billboards separately and merge them in.
+            if ( reusedCount < finalCount )
+            {
+                const cgInt32 appendedCount = finalCount - reusedCount;
+                DepthSortInfo * appended = &mDepthOrder[reusedCount];
+                DepthSortInfo * sorted   = radixSortDepth( appended, &mDepthScratch[0], appendedCount );
+                if ( sorted != appended )
+                    memcpy( appended, sorted, appendedCount * sizeof(DepthSortInfo) );
+                std::merge( mDepthOrder.begin(), mDepthOrder.begin() + reusedCount, mDepthOrder.begin() + reusedCount, 
+                            mDepthOrder.end(), mDepthScratch.begin(), BillboardSort::DepthKeyLess() );
+                mDepthOrder.swap( mDepthScratch );
+
+            } // End if appended
+
+        } // End if repaired
+        else
+        {
+            mDepthRetryDelay = BillboardSort::RetryDelay;
+            coherent = false;
+
+        } // End if failed
+
+    } // End if coherent
+    if ( !coherent )
+    {
+        if ( radixSortDepth( &mDepthOrder[0], &mDepthScratch[0], finalCount ) != &mDepthOrder[0] )
+            mDepthOrder.swap( mDepthScratch );
+
+    } // End if !coherent
+    return finalCount;
 }
 
 //-----------------------------------------------------------------------------
@@ -785,44 +1069,18 @@ void cgBillboardBuffer::renderSorted( cgCameraNode * camera, cgMatrix * localTra
         
     } // End if LocalBillboards
 
-    // Build list of billboard depth info to be sorted.
-    cgInt32 finalCount = 0;
-    DepthSortInfo * depthInfo = new DepthSortInfo[ billboardCount ];
-    for ( cgInt32 i = billboardBegin; i < billboardBegin + billboardCount; ++i )
-    {
-        cgBillboard * billboard = mBillboards[i];
-        
-        // Skip invalid or invisible billboards
-        if ( !billboard || !billboard->getVisible() )
-            continue;
-
-        // Valid billboard!
-        depthInfo[ finalCount ].billboardId = i;
-        depthInfo[ finalCount ].depth = cgVector3::lengthSq( billboard->getPosition() - sortOrigin );
-        finalCount++;
-
-    } // Next Billboard
-
-    // If nothing made it this far, return (paranoia)
+    // Sort the visible billboards back to front.
+    const cgInt32 finalCount = sortBillboards( sortOrigin, billboardBegin, billboardCount );
     if ( !finalCount )
-    {
-        delete []depthInfo;
         return;
-    
-    } // End if no data
 
-    // Sort the depth list
-    qsort( (void*)depthInfo, (size_t)finalCount, sizeof(DepthSortInfo), billboardDepthCompare );
+    const DepthSortInfo * depthInfo = &mDepthOrder[0];
 
     // Lock the index buffer
     cgUInt32 * indices;
     if ( !(indices = (cgUInt32*)mResources->lockIndexBuffer( mSortedIndices, 0, 0, cgLockFlags::WriteOnly | cgLockFlags::Discard )) )
-    {
-        delete []depthInfo;
         return;
 
-    } // End if failed to lock
-
     // Populate the index buffer
     cgUInt32 minVertex  = INT_MAX, maxVertex = 0;
     for ( cgInt32 i = 0; i < finalCount; ++i )
@@ -847,9 +1105,8 @@ void cgBillboardBuffer::renderSorted( cgCameraNode * camera, cgMatrix * localTra
         
     } // Next Billboard
 
-    // Unlock buffer and clean up
+    // Unlock buffer
     mResources->unlockIndexBuffer( mSortedIndices );
-    delete []depthInfo;
 
     // Apply the texture to the effect.
     mSampler->apply();
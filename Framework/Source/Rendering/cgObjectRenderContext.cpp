@@ -117,7 +117,7 @@ void cgObjectRenderContext::insertLight( cgLightNode * light )
 /// Insert the specified list of objects into the relevant material category.
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgObjectRenderContext::insertObjectsByMaterial( const cgMaterialHandle & material, const cgObjectNodeList & objects )
+void cgObjectRenderContext::insertObjectsByMaterial( const cgMaterialHandle & material, cgObjectNode * const * objects, size_t objectCount )
 {
     size_t batch = 0;
 
@@ -139,8 +139,7 @@ void cgObjectRenderContext::insertObjectsByMaterial( const cgMaterialHandle & ma
         
     // Insert these objects into the node array for this material.
     cgObjectNodeArray & nodes = mRenderBatches[batch];
-    nodes.reserve( nodes.size() + objects.size() );
-    nodes.insert( nodes.end(), objects.begin(), objects.end() );
+    nodes.insert( nodes.end(), objects, objects + objectCount );
 }
 
 //-----------------------------------------------------------------------------
@@ -150,7 +149,7 @@ void cgObjectRenderContext::insertObjectsByMaterial( const cgMaterialHandle & ma
 /// category.
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgObjectRenderContext::insertObjectsByLightAndMaterial( cgLightNode * light, const cgMaterialHandle & material, const cgObjectNodeList & objects )
+void cgObjectRenderContext::insertObjectsByLightAndMaterial( cgLightNode * light, const cgMaterialHandle & material, cgObjectNode * const * objects, size_t objectCount )
 {
     size_t batch = 0;
 
@@ -183,8 +182,7 @@ void cgObjectRenderContext::insertObjectsByLightAndMaterial( cgLightNode * light
         
     // Insert these objects into the node array for this material.
     cgObjectNodeArray & nodes = mRenderBatches[batch];
-    nodes.reserve( nodes.size() + objects.size() );
-    nodes.insert( nodes.end(), objects.begin(), objects.end() );
+    nodes.insert( nodes.end(), objects, objects + objectCount );
 }
 
 //-----------------------------------------------------------------------------
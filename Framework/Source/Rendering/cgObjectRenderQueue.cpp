@@ -328,9 +328,8 @@ void cgObjectRenderQueue::renderClass( const cgString & className, cgQueueMateri
 void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialHandler::Base materialHandler, cgQueueLightingHandler::Base lightingHandler, const cgString& callback )
 {
     // Find the referenced render class from the main visibility set.
-    cgVisibilitySet::RenderClassMap & renderClasses = mCurrentVisibilitySet->getVisibleRenderClasses();
-    cgVisibilitySet::RenderClassMap::iterator itClass = renderClasses.find( classId );
-    if ( itClass == renderClasses.end() )
+    const cgVisibilitySet::RenderClassRange * renderClass = mCurrentVisibilitySet->getVisibleRenderClass( classId );
+    if ( !renderClass )
         return;
 
     // Get the most recent queue render context (if any).
@@ -361,11 +360,10 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
     if ( lightingHandler == cgQueueLightingHandler::None )
     {
         // Process the visible materials in this render class.
-        cgVisibilitySet::MaterialBatchMap & materials = itClass->second.materials;
-        cgVisibilitySet::MaterialBatchMap::iterator itMaterial = materials.begin();
-        for ( ; itMaterial != materials.end(); ++itMaterial )
+        for ( cgUInt32 i = 0; i < renderClass->materialCount; ++i )
         {
-            const cgMaterialHandle & material = itMaterial->first;
+            const cgVisibilitySet::MaterialRange & batch = renderClass->materials[i];
+            const cgMaterialHandle & material = batch.material;
 
             // Skip materials that don't match any currently defined material filter.
             // *Always* include the 'null' material type.
@@ -378,7 +376,7 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
 
             // We've found the objects that belong to the referenced class. Add these 
             // objects to the appropriate context.
-            context->insertObjectsByMaterial( itMaterial->first, itMaterial->second.objectNodes );
+            context->insertObjectsByMaterial( material, batch.objectNodes, batch.objectCount );
             
         } // Next material
 
@@ -386,8 +384,9 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
     else if ( lightingHandler == cgQueueLightingHandler::Default )
     {
         // Process the lights in the visibility set.
-        cgObjectNodeList::iterator itLight;
-        cgObjectNodeList & visibleLights = mCurrentVisibilitySet->getVisibleLights();
+        cgObjectNodeArray outputNodes;
+        cgObjectNodeArray::const_iterator itLight;
+        const cgObjectNodeArray & visibleLights = mCurrentVisibilitySet->getVisibleLightArray();
         context->mLights.reserve( context->mLights.size() + visibleLights.size() );
         for ( itLight = visibleLights.begin(); itLight != visibleLights.end(); ++itLight )
         {
@@ -395,19 +394,18 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
 
             // Immediately reject all visible nodes with this render class if their
             // combined bounding box does not intersect the light's volume.
-            if ( !light->boundsInVolume( itClass->second.combinedBounds ) )
+            if ( !light->boundsInVolume( renderClass->combinedBounds ) )
                 continue;
 
             // Process the visible objects in this render class.
-            cgVisibilitySet::MaterialBatchMap & materials = itClass->second.materials;
-            cgVisibilitySet::MaterialBatchMap::iterator itMaterial = materials.begin();
-            for ( ; itMaterial != materials.end(); ++itMaterial )
+            for ( cgUInt32 i = 0; i < renderClass->materialCount; ++i )
             {
-                const cgMaterialHandle & material = itMaterial->first;
+                const cgVisibilitySet::MaterialRange & batch = renderClass->materials[i];
+                const cgMaterialHandle & material = batch.material;
 
                 // Immediately reject all visible nodes with this material if their
                 // combined bounding box does not intersect the light's volume.
-                if ( !light->boundsInVolume( itMaterial->second.combinedBounds ) )
+                if ( !light->boundsInVolume( batch.combinedBounds ) )
                     continue;
 
                 // Skip materials that don't match any currently defined material filter.
@@ -420,20 +418,18 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
                 } // End if filtering
 
                 // Build a list of all nodes which intersect the light source volume.
-                cgObjectNodeList outputNodes;
-                cgObjectNodeList::const_iterator itObject;
-                const cgObjectNodeList & inputNodes = itMaterial->second.objectNodes;
-                for ( itObject = inputNodes.begin(); itObject != inputNodes.end(); ++itObject )
+                outputNodes.clear();
+                for ( cgUInt32 j = 0; j < batch.objectCount; ++j )
                 {
-                    if ( light->boundsInVolume( (*itObject)->getBoundingBox() ) )
-                        outputNodes.push_back( (*itObject) );
+                    if ( light->boundsInVolume( batch.objectNodes[j]->getBoundingBox() ) )
+                        outputNodes.push_back( batch.objectNodes[j] );
 
                 } // Next input node
 
                 // We've found the objects that belong to the referenced class. Add these 
                 // objects to the appropriate context.
                 if ( !outputNodes.empty() )
-                    context->insertObjectsByLightAndMaterial( light, itMaterial->first, outputNodes );
+                    context->insertObjectsByLightAndMaterial( light, material, &outputNodes.front(), outputNodes.size() );
                 
             } // Next material
 
@@ -454,25 +450,22 @@ void cgObjectRenderQueue::renderClassDefault( cgUInt32 classId, cgQueueMaterialH
 void cgObjectRenderQueue::renderClassDepthSortedBlending( cgUInt32 classId, cgQueueMaterialHandler::Base materialHandler, cgQueueLightingHandler::Base lightingHandler, const cgString& callback )
 {
     // Get list of visible lights in case we need it.
-    cgObjectNodeList & visibleLights = mCurrentVisibilitySet->getVisibleLights();
+    const cgObjectNodeArray & visibleLights = mCurrentVisibilitySet->getVisibleLightArray();
 
     // Find the referenced render class from the main visibility set.
-    cgVisibilitySet::RenderClassMap & renderClasses = mCurrentVisibilitySet->getVisibleRenderClasses();
-    cgVisibilitySet::RenderClassMap::iterator itClass = renderClasses.find( classId );
-    if ( itClass == renderClasses.end() )
+    const cgVisibilitySet::RenderClassRange * renderClass = mCurrentVisibilitySet->getVisibleRenderClass( classId );
+    if ( !renderClass )
         return;
 
     // Process the visible objects in this render class.
-    cgObjectNodeList::const_iterator itObject;
     cgVector3 sortOrigin = mCurrentVisibilitySet->getVolume().position;
-    cgObjectNodeList & objectNodes = itClass->second.objectNodes;
-    for ( itObject = objectNodes.begin(); itObject != objectNodes.end(); ++itObject )
+    for ( cgUInt32 i = 0; i < renderClass->objectCount; ++i )
     {
         // Create a new rendering context
         cgObjectRenderContext * context = new cgObjectRenderContext( this, materialHandler, lightingHandler, callback );
 
         // Render with this object 
-        cgObjectNode * objectNode = (*itObject);
+        cgObjectNode * objectNode = renderClass->objectNodes[i];
         context->insertObject( objectNode );
 
         // Compute distance for sorting based on the closest point on its bounding box
@@ -489,14 +482,14 @@ void cgObjectRenderQueue::renderClassDepthSortedBlending( cgUInt32 classId, cgQu
             context->mLights.reserve( context->mLights.size() + visibleLights.size() );
             
             // Process for each light.
-            cgObjectNodeList::const_iterator itLight;
+            cgObjectNodeArray::const_iterator itLight;
             for ( itLight = visibleLights.begin(); itLight != visibleLights.end(); ++itLight )
             {
                 cgLightNode * light = (cgLightNode*)(*itLight);
 
                 // Immediately reject this light source if it doesn't even intersect the 
                 // combined bounding box of the render class.
-                if ( !light->boundsInVolume( itClass->second.combinedBounds ) )
+                if ( !light->boundsInVolume( renderClass->combinedBounds ) )
                     continue;
 
                 // Also reject the light source if it doesn't intersect the node's bounds.
@@ -30,6 +30,23 @@
 #include <Resources/cgSurfaceShader.h>
 #include <Math/cgMathUtility.h>
 #include <System/cgStringUtility.h>
+#include <System/cgJobSystem.h>
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace ParticleEmitter
+{
+    // Data passed to the emitter update jobs.
+    struct UpdateData
+    {
+        cgParticleEmitter  ** emitters;
+        cgFloat               timeDelta;
+        cgVector3             worldVelocity;
+        bool                  velocityScale;
+    };
+
+} // End Namespace : ParticleEmitter
 
 ///////////////////////////////////////////////////////////////////////////////
 // cgParticle Member Functions
@@ -42,14 +59,6 @@
 //-----------------------------------------------------------------------------
 cgParticle::cgParticle( )
 {
-    // Initialize members with sensible defaults
-    mVelocity           = cgVector3( 0.0f, 0.0f, 0.0f );
-    mAngularVelocity      = 0.0f;
-    mAge                  = 0.0f;
-    mMaximumAge           = 0.0f;
-    mLastColorKeyIndex    = 0;
-    mLastScaleKeyIndex    = 0;
-
     // Unlike billboards, particles should not be visible by default
     setVisible( false );
 }
@@ -64,51 +73,6 @@ cgParticle::~cgParticle()
 {
 }
 
-//-----------------------------------------------------------------------------
-//  Name : setVelocity ()
-/// <summary>
-/// Set the velocity of the particle
-/// </summary>
-//-----------------------------------------------------------------------------
-void cgParticle::setVelocity( const cgVector3 & vecVelocity )
-{
-    mVelocity = vecVelocity;
-}
-
-//-----------------------------------------------------------------------------
-//  Name : setAngularVelocity ()
-/// <summary>
-/// Set the angular / rotation velocity of the particle in degrees per
-/// second.
-/// </summary>
-//-----------------------------------------------------------------------------
-void cgParticle::setAngularVelocity( cgFloat fAngularVelocity )
-{
-    mAngularVelocity = fAngularVelocity;
-}
-
-//-----------------------------------------------------------------------------
-//  Name : setMaximumAge ()
-/// <summary>
-/// Set the life span of the particle
-/// </summary>
-//-----------------------------------------------------------------------------
-void cgParticle::setMaximumAge( cgFloat fMaximumAge )
-{
-    mMaximumAge = fMaximumAge;
-}
-
-//-----------------------------------------------------------------------------
-//  Name : setMass ()
-/// <summary>
-/// Set the mass of the particle
-/// </summary>
-//-----------------------------------------------------------------------------
-void cgParticle::setMass( cgFloat fMass )
-{
-    mMass = fMass;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 // cgParticleEmitter Member Functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -118,20 +82,22 @@ void cgParticle::setMass( cgFloat fMass )
 /// cgParticleEmitter Class Constructor
 /// </summary>
 //-----------------------------------------------------------------------------
-cgParticleEmitter::cgParticleEmitter()
+cgParticleEmitter::cgParticleEmitter() : mRandom( false )
 {
     // Set variables to sensible defaults
     mRenderDriver        = CG_NULL;
     mParticles           = CG_NULL;
-    mActiveParticles     = CG_NULL;
-    mDeadParticles       = CG_NULL;
-    mActiveParticleCount = 0;
+    mRecycleCursor       = 0;
     mReleaseCount        = 0;
     mBillboardBuffer     = CG_NULL;
     mGravity             = cgVector3( 0.0f, 0.0f, 0.0f );
     mGlobalForce         = cgVector3( 0.0f, 0.0f, 0.0f );
     mTotalReleased       = 0;
     mEnabled             = true;
+
+    // Seed this emitter's generator from the runtime generator on the
+    // constructing thread (Park and Miller seeds lie in [1, 2^31 - 2]).
+    mRandom.setSeed( ((((cgUInt32)rand() << 15) ^ (cgUInt32)rand()) % 2147483646u) + 1 );
     
     // Clear necessary structure elements
     cgMatrix::identity( mTransform );
@@ -166,20 +132,17 @@ void cgParticleEmitter::dispose( bool bDisposeBase )
     // Release allocated memory
     if ( mParticles != CG_NULL )
         delete []mParticles;
-    if ( mActiveParticles != CG_NULL )
-        delete []mActiveParticles;
-    if ( mDeadParticles != CG_NULL )
-        delete []mDeadParticles;
     if ( mBillboardBuffer )
         delete mBillboardBuffer;
 
     // Clear variables
     mScriptFile.clear();
+    mStore.clear();
+    mFreeParticles.clear();
+    mExpiredParticles.clear();
     mRenderDriver        = CG_NULL;
     mParticles           = CG_NULL;
-    mActiveParticles     = CG_NULL;
-    mDeadParticles       = CG_NULL;
-    mActiveParticleCount = 0;
+    mRecycleCursor       = 0;
     mBillboardBuffer     = CG_NULL;
     mEnabled             = true;
     
@@ -249,8 +212,8 @@ bool cgParticleEmitter::initialize( cgInputStream ScriptStream, const cgParticle
     // Allocate billboard items.
     mBillboardBuffer = new cgBillboardBuffer();
     mParticles       = new cgParticle*[ mMaxParticles ];
-    mActiveParticles = new cgParticle*[ mMaxParticles ];
-    mDeadParticles   = new cgParticle*[ mMaxParticles ];
+    mStore.setCapacity( mMaxParticles );
+    bakeCurves();
 
     // Does the billboard buffer need to support sorting?
     cgUInt32 nFlags = 0;
@@ -295,17 +258,12 @@ bool cgParticleEmitter::initialize( cgInputStream ScriptStream, const cgParticle
         mParticles[i] = new cgParticle();
         mBillboardBuffer->addBillboard( mParticles[i] );
         mParticles[i]->update();
-
-        // All particles are "dead" to begin with
-        mDeadParticles[i] = mParticles[i];
-
-        // Force the particle's age to be greater than its maximum age 
-        // so that anyone who calls 'isAlive()' on the particle after this
-        // point will know that it's dead.
-        mParticles[i]->mAge = mParticles[i]->mMaximumAge + 1;
         
     } // Next particle
 
+    // All particles are "dead" to begin with
+    rebuildFreeList();
+
     // TODO: Initial Particle Release
 
     // Finish building
@@ -320,243 +278,295 @@ bool cgParticleEmitter::initialize( cgInputStream ScriptStream, const cgParticle
 //-----------------------------------------------------------------------------
 void cgParticleEmitter::update( cgFloat fTimeElapsed, const cgVector3 & vecWorldVelocity, bool bVelocityScale )
 {
-    cgInt32     i, nCount       = 0;
-    cgParticle* pParticle       = CG_NULL;
-    bool        bActiveParticle = false;
-    cgFloat     fParticleAge, fSpeed, fVelocity;
-    cgVector3   vecTractive, vecDrag, vecAccel, vecAxis;
-
     // Not initialized yet?
     if ( !mBillboardBuffer )
         return;
 
-    // Loop through all active particles
-    for ( i = 0; i < (signed)mActiveParticleCount; ++i )
-    {
-        // Retrieve particle
-        pParticle = mActiveParticles[i];
-
-        // Update particle age
-        pParticle->mAge += fTimeElapsed;
-
-        // Compute the age of the particle as a scalar value between 0 and 1
-        fParticleAge = (pParticle->mAge / pParticle->mMaximumAge);
-
-        // Is this particle past it's lifespan?
-        if ( !pParticle->isAlive() )
-        {
-            // Flag as dead, and remove from active particles list
-            pParticle->setVisible( false );
-            if ( i < (signed)mActiveParticleCount - 1 )
-                memmove( &mActiveParticles[i], &mActiveParticles[i+1], ((mActiveParticleCount - 1) - i) * sizeof(cgParticle*) );
-            mActiveParticleCount--;
-
-            // Add to the end of the dead particles list
-            mDeadParticles[ (mMaxParticles - 1) - mActiveParticleCount ] = pParticle;
-
-            // Update to allow it to be removed from consideration
-            pParticle->update();
-
-            // This particle was removed, re-test this slot in the active particle list
-            i--;
+    // Step the existing particles, then release new ones.
+    updateParticles( fTimeElapsed, vecWorldVelocity, bVelocityScale );
+    emitParticles( fTimeElapsed, vecWorldVelocity, bVelocityScale );
+}
 
-            // Skip rest of calculation
-            continue;
+//-----------------------------------------------------------------------------
+//  Name : updateEmitters () (Static)
+/// <summary>
+/// Update a set of particle emitters at once. Each emitter is simulated and
+/// releases new particles on any available job system worker thread.
+/// Equivalent to calling 'update()' for each emitter. Null entries in the
+/// array are skipped.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::updateEmitters( cgParticleEmitter * ppEmitters[], cgUInt32 nEmitterCount, cgFloat fTimeElapsed, const cgVector3 & vecWorldVelocity, bool bVelocityScale )
+{
+    ParticleEmitter::UpdateData Data;
+    Data.emitters      = ppEmitters;
+    Data.timeDelta     = fTimeElapsed;
+    Data.worldVelocity = vecWorldVelocity;
+    Data.velocityScale = bVelocityScale;
+    cgJobSystem::parallelFor( nEmitterCount, 1, executeUpdates, &Data );
+}
 
-        } // End if kill particle
+//-----------------------------------------------------------------------------
+//  Name : executeUpdates () (Private, Static)
+/// <summary>
+/// Job system callback that updates the specified range of emitters. Particle
+/// birth draws only from each emitter's own generator, so the particles
+/// released do not depend on the thread on which an emitter is updated.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::executeUpdates( cgUInt32 nFirst, cgUInt32 nLast, void * pContext )
+{
+    ParticleEmitter::UpdateData * pData = (ParticleEmitter::UpdateData*)pContext;
+    for ( cgUInt32 i = nFirst; i < nLast; ++i )
+    {
+        cgParticleEmitter * pEmitter = pData->emitters[i];
+        if ( pEmitter )
+            pEmitter->update( pData->timeDelta, pData->worldVelocity, pData->velocityScale );
+    
+    } // Next emitter
+}
 
-        // Update velocity if particle has a mass
-        if ( pParticle->mMass > 0.0f )
-        {
-            fSpeed      = cgVector3::length( pParticle->mVelocity );
-            vecTractive = (mGlobalForce + (mGravity * pParticle->getMass()));
-            vecDrag     = -mProperties.airResistance * (pParticle->mVelocity * fSpeed);
-            vecAccel    = (vecTractive + vecDrag) / pParticle->mMass;
-            pParticle->mVelocity += vecAccel * fTimeElapsed;
+//-----------------------------------------------------------------------------
+//  Name : updateParticles () (Private)
+/// <summary>
+/// Step the simulation for all active particles, retire those that have
+/// exceeded their lifespan and write the results back to the particle
+/// billboards. Only touches data owned by this emitter such that separate 
+/// emitters can be updated concurrently.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::updateParticles( cgFloat fTimeElapsed, const cgVector3 & vecWorldVelocity, bool bVelocityScale )
+{
+    if ( !mStore.getCount() )
+        return;
 
-        } // End if has mass
-        
-        // Update angles and positions
-        pParticle->setPosition( pParticle->getPosition() + (pParticle->mVelocity * fTimeElapsed) );
-        pParticle->mRotation += pParticle->mAngularVelocity * fTimeElapsed;
-
-        // Update the optional direction vector that can be used to lock 
-        // the billboard to a specific axis. This vector is based on the
-        // specified world velocity (i.e. camera moving through the world)
-        // relative to the particle's position and velocity.
-        vecAxis = pParticle->mVelocity - vecWorldVelocity;
-        fVelocity = cgVector3::length( vecAxis );
-        if ( fVelocity > 0 )
-        {
-            vecAxis /= fVelocity;
-            pParticle->setDirection( vecAxis );
-        
-        } // End if
-
-        // ******************************************************************
-        // * COLOR CURVES
-        // ******************************************************************
-        const bool bApproximateSample = true;
-        cgColorValue NewColor;
-        NewColor.r = mProperties.colorRCurve.evaluateForX( fParticleAge, bApproximateSample );
-        NewColor.g = mProperties.colorGCurve.evaluateForX( fParticleAge, bApproximateSample );
-        NewColor.b = mProperties.colorBCurve.evaluateForX( fParticleAge, bApproximateSample );
-        NewColor.a = mProperties.colorACurve.evaluateForX( fParticleAge, bApproximateSample );
-        pParticle->setColor( NewColor );
-        pParticle->setHDRScale( mProperties.hdrScale );
+    // Integrate and evaluate color / scale curves for all active particles.
+    cgParticleStore::SimulationParams Params;
+    getSimulationParams( Params, fTimeElapsed, vecWorldVelocity, bVelocityScale );
+    mStore.simulate( Params );
 
-        // ******************************************************************
-        // * SCALE CURVES
-        // ******************************************************************
-        pParticle->mScale.x = mProperties.scaleXCurve.evaluateForX( fParticleAge, bApproximateSample );
-        pParticle->mScale.y = mProperties.scaleYCurve.evaluateForX( fParticleAge, bApproximateSample );
+    // Remove any particles that are past their lifespan.
+    mExpiredParticles.clear();
+    mStore.removeExpired( mExpiredParticles );
+    for ( size_t i = 0; i < mExpiredParticles.size(); ++i )
+    {
+        // Flag as dead and update to allow it to be removed from consideration
+        cgParticle * pParticle = mParticles[ mExpiredParticles[i] ];
+        pParticle->setVisible( false );
+        pParticle->update();
+        mFreeParticles.push_back( mExpiredParticles[i] );
 
-        // Multiply scale by velocity if requested
-        if ( bVelocityScale )
-            pParticle->mScale.y *= 1.0f + (fVelocity - 1.0f) * mProperties.velocityScaleStrength;
+    } // Next expired particle
 
-        // Update the underlying billboard
-        pParticle->update();
+    // Update the underlying billboards
+    for ( cgUInt32 i = 0; i < mStore.getCount(); ++i )
+        writeParticle( i );
+}
 
-    } // Next Active Particle
+//-----------------------------------------------------------------------------
+//  Name : emitParticles () (Private)
+/// <summary>
+/// Release any new particles that are due based on the emitter's birth 
+/// frequency or fire delay.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::emitParticles( cgFloat fTimeElapsed, const cgVector3 & vecWorldVelocity, bool bVelocityScale )
+{
+    cgInt32 i, nCount = 0;
 
     // Have we RELEASED all of the required particles (not including those still active)?
     if ( particlesSpent( false ) )
         return;
 
     // Is emission enabled?
-    if ( mEnabled )
+    if ( !mEnabled )
+        return;
+
+    // Determine how many new particles to release in this frame
+    if ( mProperties.fireAmount == 0 )
+    {
+        // Calculate how many new particles to fire based on frequency.
+        mReleaseCount += (mProperties.birthFrequency * fTimeElapsed);
+        nCount = (cgInt32)mReleaseCount;
+        mReleaseCount -= (cgFloat)nCount;
+
+    } // End if frequency mode
+    else
     {
-        // Determine how many new particles to release in this frame
-        if ( mProperties.fireAmount == 0 )
+        // Calculate how many particles to fire based on fire delay
+        nCount = 0;
+        mTimeElapsed += fTimeElapsed;
+        if ( mTimeElapsed >= mProperties.fireDelay )
         {
-            // Calculate how many new particles to fire based on frequency.
-            mReleaseCount += (mProperties.birthFrequency * fTimeElapsed);
-            nCount = (cgInt32)mReleaseCount;
-            mReleaseCount -= (cgFloat)nCount;
+            nCount = mProperties.fireAmount;
+            mTimeElapsed -= mProperties.fireDelay;
+        
+        } // End if we've reached our release delay
+    
+    } // End if fire delay mode
 
-        } // End if frequency mode
-        else
+    // New particles are evaluated at birth without advancing the simulation.
+    cgParticleStore::SimulationParams Params;
+    getSimulationParams( Params, 0.0f, vecWorldVelocity, bVelocityScale );
+
+    // Fire the specified number of particles
+    for ( i = 0; i < nCount; ++i )
+    {
+        cgUInt32 nParticle;
+        bool     bActiveParticle;
+
+        // No spare particles?
+        if ( mFreeParticles.empty() )
         {
-            // Calculate how many particles to fire based on fire delay
-            nCount = 0;
-            mTimeElapsed += fTimeElapsed;
-            if ( mTimeElapsed >= mProperties.fireDelay )
-            {
-                nCount = mProperties.fireAmount;
-                mTimeElapsed -= mProperties.fireDelay;
-            
-            } // End if we've reached our release delay
+            // Recycle an active particle. Removal reorders the active 
+            // particles so their age order is not preserved; simply cycle
+            // through them instead.
+            if ( mRecycleCursor >= mStore.getCount() )
+                mRecycleCursor = 0;
+            nParticle       = mStore.getTag( mRecycleCursor );
+            bActiveParticle = true;
+            mStore.remove( mRecycleCursor++ );
         
-        } // End if fire delay mode
+        } // End if using active particle
+        else
+        {
+            // Pull one from the end of the free list
+            nParticle       = mFreeParticles.back();
+            bActiveParticle = false;
+            mFreeParticles.pop_back();
+
+        } // End if using dead particle
+
+        // Reset this particle
+        cgParticle * pParticle = mParticles[ nParticle ];
+        cgUInt32 nIndex = mStore.add( nParticle );
+        cgFloat fBaseScale = randomFloat( mProperties.baseScale.min, mProperties.baseScale.max );
+        pParticle->setSize( mProperties.baseSize.width * fBaseScale, mProperties.baseSize.height * fBaseScale );
+        pParticle->setHDRScale( mProperties.hdrScale );
 
-        // Fire the specified number of particles
-        for ( i = 0; i < nCount; ++i )
+        // Trigger the birth event
+        if ( onParticleBirth( nIndex ) == false )
         {
-            // No spare particles?
-            if ( mActiveParticleCount == mMaxParticles )
+            // Return to the free list.
+            mStore.remove( nIndex );
+            mFreeParticles.push_back( nParticle );
+            if ( bActiveParticle == true )
             {
-                // TODO : Find the OLDEST particle
+                // Flag as dead and update to allow it to be removed from consideration
+                pParticle->setVisible( false );
+                pParticle->update();
 
-                // Pull one from the beginning of the active list (/generally/ these are the oldest particles)
-                bActiveParticle = true;
-                pParticle       = mActiveParticles[0];
-            
-            } // End if using active particle
-            else
-            {
-                // Pull one from the end of the dead list
-                bActiveParticle = false;
-                pParticle       = mDeadParticles[ (mMaxParticles - 1) - mActiveParticleCount ];
-
-            } // End if using dead particle
-
-            // Reset this particle
-            cgFloat fBaseScale = cgMathUtility::randomFloat( mProperties.baseScale.min, mProperties.baseScale.max );
-            pParticle->setSize( mProperties.baseSize.width * fBaseScale, mProperties.baseSize.height * fBaseScale );
-            pParticle->setPosition( 0, 0, 0 );
-            pParticle->mAge               = 0.0f;
-            pParticle->mRotation          = 0.0f;
-            pParticle->mAngularVelocity   = 0.0f;
-            pParticle->mVelocity        = cgVector3( 0, 0, 0 );
-            pParticle->mLastColorKeyIndex = 0;
-            pParticle->mLastScaleKeyIndex = 0;
-
-            // Calculate initial scale
-            pParticle->setScale( mProperties.scaleXCurve.evaluateForX(0,true), mProperties.scaleXCurve.evaluateForX(0,true) );
-            
-            // Calculate initial color
-            cgColorValue NewColor;
-            NewColor.r = mProperties.colorRCurve.evaluateForX( 0, true );
-            NewColor.g = mProperties.colorGCurve.evaluateForX( 0, true );
-            NewColor.b = mProperties.colorBCurve.evaluateForX( 0, true );
-            NewColor.a = mProperties.colorACurve.evaluateForX( 0, true );
-            pParticle->setColor( NewColor );
-            pParticle->setHDRScale( mProperties.hdrScale );
-
-            // Trigger the birth event
-            if ( onParticleBirth( pParticle ) == false )
-            {
-                if ( bActiveParticle == true )
-                {
-                    // Flag as dead, and remove from active particles list
-                    pParticle->setVisible( false );
-                    if ( i < (signed)mActiveParticleCount - 1 )
-                        memmove( &mActiveParticles[i], &mActiveParticles[i+1], ((mActiveParticleCount - 1) - i) * sizeof(cgParticle*) );
-                    mActiveParticleCount--;
+            } // End if particle was an active one
 
-                    // Add to the end of the dead particles list
-                    mDeadParticles[ (mMaxParticles - 1) - mActiveParticleCount ] = pParticle;
+            // Skip the creation
+            continue;
 
-                    // Update to allow it to be removed from consideration
-                    pParticle->update();
+        } // End if cancelled the creation
 
-                } // End if particle was an active one
+        // A new particle was released
+        mTotalReleased++;
 
-                // Force the particle's age to be greater than its maximum age 
-                // so that anyone who calls 'isAlive()' on the particle after this
-                // point will know that it's dead.
-                pParticle->mAge = pParticle->mMaximumAge + 1;
+        // Compute the initial direction, color and scale.
+        mStore.simulate( nIndex, nIndex + 1, Params );
+        
+        // Set as visible and update the newly created particle
+        pParticle->setVisible( true );
+        writeParticle( nIndex );
+    
+    } // Next new particle
+}
 
-                // Skip the creation
-                continue;
+//-----------------------------------------------------------------------------
+//  Name : writeParticle () (Private)
+/// <summary>
+/// Copy the current simulation state of the specified active particle to
+/// its billboard and update the billboard buffer.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::writeParticle( cgUInt32 nIndex )
+{
+    const cgParticleStore & Store = mStore;
+    cgParticle * pParticle = mParticles[ Store.getTag( nIndex ) ];
+    pParticle->mPosition.x  = Store.getValue( cgParticleStore::PositionX, nIndex );
+    pParticle->mPosition.y  = Store.getValue( cgParticleStore::PositionY, nIndex );
+    pParticle->mPosition.z  = Store.getValue( cgParticleStore::PositionZ, nIndex );
+    pParticle->mDirection.x = Store.getValue( cgParticleStore::DirectionX, nIndex );
+    pParticle->mDirection.y = Store.getValue( cgParticleStore::DirectionY, nIndex );
+    pParticle->mDirection.z = Store.getValue( cgParticleStore::DirectionZ, nIndex );
+    pParticle->mScale.x     = Store.getValue( cgParticleStore::ScaleX, nIndex );
+    pParticle->mScale.y     = Store.getValue( cgParticleStore::ScaleY, nIndex );
+    pParticle->mRotation    = Store.getValue( cgParticleStore::Rotation, nIndex );
+    pParticle->mColor       = Store.getColor( nIndex );
+    pParticle->update();
+}
 
-            } // End if cancelled the creation
+//-----------------------------------------------------------------------------
+//  Name : getSimulationParams () (Private)
+/// <summary>
+/// Populate the particle store simulation parameters for this emitter.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::getSimulationParams( cgParticleStore::SimulationParams & Params, cgFloat fTimeElapsed, const cgVector3 & vecWorldVelocity, bool bVelocityScale ) const
+{
+    Params.timeDelta             = fTimeElapsed;
+    Params.gravity               = mGravity;
+    Params.globalForce           = mGlobalForce;
+    Params.worldVelocity         = vecWorldVelocity;
+    Params.airResistance         = mProperties.airResistance;
+    Params.velocityScale         = bVelocityScale;
+    Params.velocityScaleStrength = mProperties.velocityScaleStrength;
+}
 
-            // A new particle was released
-            mTotalReleased++;
-            
-            // Update the optional direction vector that can be used to lock 
-            // the billboard to a specific axis. This vector is based on the
-            // specified world velocity (i.e. camera moving through the world)
-            // relative to the particle's position and velocity.
-            vecAxis = pParticle->mVelocity - vecWorldVelocity;
-            fVelocity = cgVector3::length( vecAxis );
-            if ( fVelocity > 0 )
-            {
-                vecAxis /= fVelocity;
-                pParticle->setDirection( vecAxis );
-            
-            } // End if
+//-----------------------------------------------------------------------------
+//  Name : bakeCurves () (Private)
+/// <summary>
+/// Bake the color and scale property curves into the lookup tables sampled
+/// by the particle store. Must be called whenever the curves are altered.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::bakeCurves( )
+{
+    mStore.bakeCurve( cgParticleStore::ScaleXCurve, mProperties.scaleXCurve );
+    mStore.bakeCurve( cgParticleStore::ScaleYCurve, mProperties.scaleYCurve );
+    mStore.bakeCurve( cgParticleStore::ColorRCurve, mProperties.colorRCurve );
+    mStore.bakeCurve( cgParticleStore::ColorGCurve, mProperties.colorGCurve );
+    mStore.bakeCurve( cgParticleStore::ColorBCurve, mProperties.colorBCurve );
+    mStore.bakeCurve( cgParticleStore::ColorACurve, mProperties.colorACurve );
+}
 
-            // Multiply scale by velocity if requested
-            if ( bVelocityScale )
-                pParticle->mScale.y *= 1.0f + (fVelocity - 1.0f) * mProperties.velocityScaleStrength;
-            
-            // Set as visible and add to active list if it wasn't already
-            if ( bActiveParticle == false )
-            {
-                pParticle->setVisible( true );
-                mActiveParticles[ mActiveParticleCount++ ] = pParticle;
-            
-            } // End if not from active list
+//-----------------------------------------------------------------------------
+//  Name : rebuildFreeList () (Private)
+/// <summary>
+/// Rebuild the list of particle billboards that are not currently in use by
+/// an active particle.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleEmitter::rebuildFreeList( )
+{
+    cgByteArray Used( mMaxParticles, 0 );
+    for ( cgUInt32 i = 0; i < mStore.getCount(); ++i )
+        Used[ mStore.getTag( i ) ] = 1;
 
-            // Update the newly created particle
-            pParticle->update();
-        
-        } // Next new particle
+    // Lowest indices are popped from the back of the list first.
+    mFreeParticles.clear();
+    for ( cgUInt32 i = mMaxParticles; i > 0; --i )
+    {
+        if ( !Used[i-1] )
+            mFreeParticles.push_back( i - 1 );
+    
+    } // Next particle
+    mRecycleCursor = 0;
+}
 
-    } // End if emission enabled
+//-----------------------------------------------------------------------------
+//  Name : getActiveParticleCount ()
+/// <summary>
+/// Retrieve the number of particles that are currently alive.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgParticleEmitter::getActiveParticleCount( ) const
+{
+    return mStore.getCount();
 }
 
 //-----------------------------------------------------------------------------
@@ -697,8 +707,8 @@ cgVector3 cgParticleEmitter::generateConeDirection( cgFloat fInnerAngle, cgFloat
     fOuterAngle *= 0.5f;
 
     // Generate Azimuth / Polar angles
-    cgFloat fAzimuth = (cgFloat)rand() / (cgFloat)RAND_MAX;
-    cgFloat fPolar   = (cgFloat)rand() / (cgFloat)RAND_MAX;
+    cgFloat fAzimuth = randomFloat( 0.0f, 1.0f );
+    cgFloat fPolar   = randomFloat( 0.0f, 1.0f );
     fAzimuth = fInnerAngle + ((fOuterAngle - fInnerAngle) * fAzimuth);
     fPolar   = 360.0f * fPolar;
 
@@ -728,10 +738,10 @@ cgVector3 cgParticleEmitter::generateOrigin( cgFloat fDeadZoneRadius, cgFloat fE
         return (localSpace) ? cgVector3(0,0,0) : getEmitterPosition();
 
     // Pick a random point along the emitters radius
-    cgFloat fLength = fDeadZoneRadius + (((cgFloat)rand() / (cgFloat)RAND_MAX) * (fEmissionRadius - fDeadZoneRadius));
+    cgFloat fLength = randomFloat( fDeadZoneRadius, fEmissionRadius );
 
     // A Polar angle
-    cgFloat fPolar  = ((cgFloat)rand() / (cgFloat)RAND_MAX) * 360.0f;
+    cgFloat fPolar  = randomFloat( 0.0f, 360.0f );
 
     // Generate the initial position pushed out relative to the origin (in emitter space)
     cgVector3 vecPosition = cgVector3( 0.0f, fLength, 0.0f );
@@ -749,20 +759,33 @@ cgVector3 cgParticleEmitter::generateOrigin( cgFloat fDeadZoneRadius, cgFloat fE
     return vecPosition;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : randomFloat () (Private)
+/// <summary>
+/// Retrieve the next value from this emitter's own random number generator,
+/// scaled into the specified range.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgParticleEmitter::randomFloat( cgFloat fMinimum, cgFloat fMaximum ) const
+{
+    return (cgFloat)mRandom.next( fMinimum, fMaximum );
+}
+
 //-----------------------------------------------------------------------------
 //  Name : onParticleBirth () (Private)
 /// <summary>
-/// Execute the particle creation process for this particle.
+/// Execute the particle creation process for the newly added particle at
+/// the specified index in the particle store.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgParticleEmitter::onParticleBirth( cgParticle * pParticle )
+bool cgParticleEmitter::onParticleBirth( cgUInt32 nIndex )
 {
     // Compute initial random properties
-    cgFloat fSpeed           = cgMathUtility::randomFloat( mProperties.speed.min, mProperties.speed.max );
-    cgFloat fAngularVelocity = cgMathUtility::randomFloat( mProperties.angularSpeed.min, mProperties.angularSpeed.max );
+    cgFloat fSpeed           = randomFloat( mProperties.speed.min, mProperties.speed.max );
+    cgFloat fAngularVelocity = randomFloat( mProperties.angularSpeed.min, mProperties.angularSpeed.max );
     cgFloat fInitialRotation = 0.0f;
-    cgFloat fMass            = cgMathUtility::randomFloat( mProperties.mass.min, mProperties.mass.max );
-    cgFloat fLifetime        = cgMathUtility::randomFloat( mProperties.lifetime.max, mProperties.lifetime.min );
+    cgFloat fMass            = randomFloat( mProperties.mass.min, mProperties.mass.max );
+    cgFloat fLifetime        = randomFloat( mProperties.lifetime.max, mProperties.lifetime.min );
 
     // Compute initial velocity
     cgVector3 Velocity = generateConeDirection( mProperties.innerCone, mProperties.outerCone ) * fSpeed;
@@ -770,17 +793,21 @@ bool cgParticleEmitter::onParticleBirth( cgParticle * pParticle )
     // Compute initial particle origin.
     cgVector3 Origin = generateOrigin( mProperties.deadZoneRadius, mProperties.emissionRadius );
 
-    // Set particle properties
-    pParticle->setMass( fMass );
-    pParticle->setPosition( Origin );
-    pParticle->setAngularVelocity( fAngularVelocity );
-    pParticle->setRotation( fInitialRotation );
-    pParticle->setVelocity( Velocity );
-    pParticle->setMaximumAge( fLifetime );
-
     // Randomize initial angle?
     if ( mProperties.randomizeRotation )
-        pParticle->setRotation( cgMathUtility::randomFloat( 0.0f, 360.0f ) );
+        fInitialRotation = randomFloat( 0.0f, 360.0f );
+
+    // Set particle properties
+    mStore.getValue( cgParticleStore::InverseMass, nIndex )     = (fMass > 0.0f) ? 1.0f / fMass : 0.0f;
+    mStore.getValue( cgParticleStore::PositionX, nIndex )       = Origin.x;
+    mStore.getValue( cgParticleStore::PositionY, nIndex )       = Origin.y;
+    mStore.getValue( cgParticleStore::PositionZ, nIndex )       = Origin.z;
+    mStore.getValue( cgParticleStore::AngularVelocity, nIndex ) = fAngularVelocity;
+    mStore.getValue( cgParticleStore::Rotation, nIndex )        = fInitialRotation;
+    mStore.getValue( cgParticleStore::VelocityX, nIndex )       = Velocity.x;
+    mStore.getValue( cgParticleStore::VelocityY, nIndex )       = Velocity.y;
+    mStore.getValue( cgParticleStore::VelocityZ, nIndex )       = Velocity.z;
+    mStore.getValue( cgParticleStore::MaximumAge, nIndex )      = fLifetime;
 
     // Allow to live
     return true;
@@ -820,7 +847,7 @@ void cgParticleEmitter::setGlobalForce( const cgVector3 & vForce )
 //-----------------------------------------------------------------------------
 bool cgParticleEmitter::particlesSpent( bool bIncludeAlive /* = true */ )
 {
-    if ( bIncludeAlive && mActiveParticleCount != 0 )
+    if ( bIncludeAlive && mStore.getCount() != 0 )
         return false;
 
     // Fired enough particles?
@@ -944,27 +971,25 @@ bool cgParticleEmitter::setEmitterProperties( const cgParticleEmitterProperties
     // we also need to resize our internal particle containers.
     if ( mMaxParticles != nNewMaxParticles )
     {
-        // Allocate new containers for the particles.
-        cgParticle ** ppNewParticles       = new cgParticle*[ nNewMaxParticles ];
-        cgParticle ** ppNewActiveParticles = new cgParticle*[ nNewMaxParticles ];
-        cgParticle ** ppNewDeadParticles   = new cgParticle*[ nNewMaxParticles ];
+        // Allocate a new container for the particles.
+        cgParticle ** ppNewParticles = new cgParticle*[ nNewMaxParticles ];
 
         // Copy contents of old array, and delete any particles that 
         // are no longer valid or allocate the additional required.
         if ( nNewMaxParticles < mMaxParticles )
         {
-            mActiveParticleCount = 0;
-            
-            // Copy as many particles as we need.
-            for ( cgUInt32 i = 0, nDeadParticles = 0; i < nNewMaxParticles; ++i )
+            // Discard any active particles whose billboards are to be released.
+            for ( cgUInt32 i = 0; i < mStore.getCount(); )
             {
-                ppNewParticles[i] = mParticles[i];
-                if ( ppNewParticles[i]->isAlive() )
-                    ppNewActiveParticles[mActiveParticleCount++] = ppNewParticles[i];
+                if ( mStore.getTag( i ) >= nNewMaxParticles )
+                    mStore.remove( i );
                 else
-                    ppNewDeadParticles[ nDeadParticles++ ] = ppNewParticles[i];
+                    ++i;
+            
+            } // Next active particle
 
-            } // Next particle                    
+            // Copy as many particles as we need.
+            memcpy( ppNewParticles, mParticles, nNewMaxParticles * sizeof(cgParticle*) );
 
             // Release any remaining.
             for ( cgUInt32 i = nNewMaxParticles; i < mMaxParticles; ++i )
@@ -975,35 +1000,21 @@ bool cgParticleEmitter::setEmitterProperties( const cgParticleEmitterProperties
         {
             // Copy all existing particles
             memcpy( ppNewParticles, mParticles, mMaxParticles * sizeof(cgParticle*) );
-            memcpy( ppNewActiveParticles, mActiveParticles, mMaxParticles * sizeof(cgParticle*) );
-            memcpy( ppNewDeadParticles, mDeadParticles, mMaxParticles * sizeof(cgParticle*) );
 
             // Allocate any new particles that may be required.
-            cgUInt32 nFirstDead = mMaxParticles - mActiveParticleCount;
             for ( cgUInt32 i = mMaxParticles; i < nNewMaxParticles; ++i )
-            {
                 ppNewParticles[i] = new cgParticle();
 
-                // All new particles are "dead" to begin with
-                ppNewDeadParticles[ nFirstDead + (i - mMaxParticles) ] = ppNewParticles[i];
-
-                // Force the particle's age to be greater than its maximum age 
-                // so that anyone who calls 'isAlive()' on the particle after this
-                // point will know that it's dead.
-                ppNewParticles[i]->mAge = ppNewParticles[i]->mMaximumAge + 1;
-
-            } // Next new
-
         } // End if new > old
 
         // Swap containers.
         delete []mParticles;
-        delete []mActiveParticles;
-        delete []mDeadParticles;
         mParticles = ppNewParticles;
-        mActiveParticles = ppNewActiveParticles;
-        mDeadParticles = ppNewDeadParticles;
         mMaxParticles = nNewMaxParticles;
+        mStore.setCapacity( mMaxParticles );
+
+        // Any particles not currently active are available for use.
+        rebuildFreeList();
 
     } // End if max particles changed
 
@@ -1022,6 +1033,7 @@ bool cgParticleEmitter::setEmitterProperties( const cgParticleEmitterProperties
 
     // Swap emission properties with new details.
     mProperties = Properties;
+    bakeCurves();
 
     // Success!
     return true;
@@ -1037,4 +1049,4 @@ bool cgParticleEmitter::setEmitterProperties( const cgParticleEmitterProperties
 const cgParticleEmitterProperties & cgParticleEmitter::getEmitterProperties( ) const
 {
     return mProperties;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,508 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgParticleStore.cpp                                                //
+//                                                                           //
+// Desc : Structure of arrays (SoA) storage and simulation kernel for the    //
+//        live particles managed by a particle emitter.                      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgParticleStore Module Includes
+//-----------------------------------------------------------------------------
+#include <Rendering/cgParticleStore.h>
+#include <Math/cgBezierSpline.h>
+#include <System/cgJobSystem.h>
+#if defined(CGE_MATH_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace ParticleStore
+{
+    // Number of particles simulated by each job when the store is large 
+    // enough to be split across the job system (multiple of four).
+    const cgUInt32 SimulateGrainSize = 2048;
+
+    // Largest valid lower index into a baked curve table.
+    const cgInt32 LastCurveSegment = cgParticleStore::CurveResolution - 2;
+
+    //-------------------------------------------------------------------------
+    // Name : Streams (Struct)
+    // Desc : Raw pointers to each stream / table for the kernels below.
+    //-------------------------------------------------------------------------
+    struct Streams
+    {
+        cgFloat       * data[cgParticleStore::StreamCount];
+        cgUInt32      * colors;
+        const cgFloat * curves[cgParticleStore::CurveCount];
+    };
+
+    // Data passed to the simulation jobs.
+    struct BatchData
+    {
+        cgParticleStore                         * store;
+        const cgParticleStore::SimulationParams * params;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : sampleTable()
+    // Desc : Linearly interpolate a baked curve table at the specified 
+    //        (normalized) position. Out of range and NaN inputs are clamped.
+    //-------------------------------------------------------------------------
+    inline cgFloat sampleTable( const cgFloat * table, cgFloat t )
+    {
+        if ( !(t > 0.0f) )
+            t = 0.0f;
+        else if ( t > 1.0f )
+            t = 1.0f;
+        const cgFloat f = t * (cgFloat)(cgParticleStore::CurveResolution - 1);
+        cgInt32 i = (cgInt32)f;
+        if ( i > LastCurveSegment )
+            i = LastCurveSegment;
+        return table[i] + (table[i+1] - table[i]) * (f - (cgFloat)i);
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : packChannel()
+    // Desc : Convert a color channel into its 8 bit representation using the
+    //        same rounding as cgColorValue's cgUInt32 conversion.
+    //-------------------------------------------------------------------------
+    inline cgUInt32 packChannel( cgFloat value, cgInt shift )
+    {
+        value *= 255.0f;
+        if ( !(value > 0.0f) )
+            value = 0.0f;
+        else if ( value > 255.0f )
+            value = 255.0f;
+        return ((cgUInt32)value) << shift;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : simulateParticle()
+    // Desc : Scalar kernel. Steps the simulation for a single particle.
+    //-------------------------------------------------------------------------
+    inline void simulateParticle( const Streams & s, cgUInt32 i, const cgParticleStore::SimulationParams & p )
+    {
+        cgFloat * const * d = s.data;
+        const cgFloat dt = p.timeDelta;
+        const cgFloat age = d[cgParticleStore::Age][i] + dt;
+        d[cgParticleStore::Age][i] = age;
+
+        // Update velocity if particle has a mass
+        cgFloat vx = d[cgParticleStore::VelocityX][i];
+        cgFloat vy = d[cgParticleStore::VelocityY][i];
+        cgFloat vz = d[cgParticleStore::VelocityZ][i];
+        const cgFloat inverseMass = d[cgParticleStore::InverseMass][i];
+        if ( inverseMass > 0.0f )
+        {
+            const cgFloat drag = p.airResistance * sqrtf( vx * vx + vy * vy + vz * vz );
+            vx += ((p.globalForce.x - drag * vx) * inverseMass + p.gravity.x) * dt;
+            vy += ((p.globalForce.y - drag * vy) * inverseMass + p.gravity.y) * dt;
+            vz += ((p.globalForce.z - drag * vz) * inverseMass + p.gravity.z) * dt;
+            d[cgParticleStore::VelocityX][i] = vx;
+            d[cgParticleStore::VelocityY][i] = vy;
+            d[cgParticleStore::VelocityZ][i] = vz;
+        
+        } // End if has mass
+
+        // Update angles and positions
+        d[cgParticleStore::PositionX][i] += vx * dt;
+        d[cgParticleStore::PositionY][i] += vy * dt;
+        d[cgParticleStore::PositionZ][i] += vz * dt;
+        d[cgParticleStore::Rotation][i]  += d[cgParticleStore::AngularVelocity][i] * dt;
+
+        // Direction relative to the observer's world velocity.
+        const cgFloat ax = vx - p.worldVelocity.x;
+        const cgFloat ay = vy - p.worldVelocity.y;
+        const cgFloat az = vz - p.worldVelocity.z;
+        const cgFloat speed = sqrtf( ax * ax + ay * ay + az * az );
+        if ( speed > 0.0f )
+        {
+            d[cgParticleStore::DirectionX][i] = ax / speed;
+            d[cgParticleStore::DirectionY][i] = ay / speed;
+            d[cgParticleStore::DirectionZ][i] = az / speed;
+        
+        } // End if moving
+
+        // Evaluate property curves
+        const cgFloat t = age / d[cgParticleStore::MaximumAge][i];
+        s.colors[i] = packChannel( sampleTable( s.curves[cgParticleStore::ColorACurve], t ), 24 ) |
+                      packChannel( sampleTable( s.curves[cgParticleStore::ColorRCurve], t ), 16 ) |
+                      packChannel( sampleTable( s.curves[cgParticleStore::ColorGCurve], t ), 8 ) |
+                      packChannel( sampleTable( s.curves[cgParticleStore::ColorBCurve], t ), 0 );
+        cgFloat scaleY = sampleTable( s.curves[cgParticleStore::ScaleYCurve], t );
+        if ( p.velocityScale )
+            scaleY *= 1.0f + (speed - 1.0f) * p.velocityScaleStrength;
+        d[cgParticleStore::ScaleX][i] = sampleTable( s.curves[cgParticleStore::ScaleXCurve], t );
+        d[cgParticleStore::ScaleY][i] = scaleY;
+    }
+
+#if defined(CGE_MATH_SIMD_SSE2)
+    //-------------------------------------------------------------------------
+    // Name : select4()
+    // Desc : Per lane selection; returns 'a' where the mask is set, 'b' 
+    //        otherwise.
+    //-------------------------------------------------------------------------
+    inline __m128 select4( __m128 mask, __m128 a, __m128 b )
+    {
+        return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : sampleTable4()
+    // Desc : Sample a baked curve table for four particles. Table lookups are
+    //        gathered individually, interpolation is performed in parallel.
+    //-------------------------------------------------------------------------
+    inline __m128 sampleTable4( const cgFloat * table, const cgInt32 index[4], __m128 weight )
+    {
+        const __m128 a = _mm_setr_ps( table[index[0]], table[index[1]], table[index[2]], table[index[3]] );
+        const __m128 b = _mm_setr_ps( table[index[0]+1], table[index[1]+1], table[index[2]+1], table[index[3]+1] );
+        return _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), weight ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : packChannel4()
+    // Desc : Convert four color channel values into shifted 8 bit integers.
+    //-------------------------------------------------------------------------
+    inline __m128i packChannel4( __m128 value, cgInt shift )
+    {
+        // Note: _mm_max_ps returns its second operand for NaN inputs.
+        value = _mm_min_ps( _mm_max_ps( _mm_mul_ps( value, _mm_set1_ps( 255.0f ) ), _mm_setzero_ps() ), _mm_set1_ps( 255.0f ) );
+        return _mm_sll_epi32( _mm_cvttps_epi32( value ), _mm_cvtsi32_si128( shift ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : simulateBlock4()
+    // Desc : SSE kernel. Steps the simulation for four particles at once.
+    //-------------------------------------------------------------------------
+    inline void simulateBlock4( const Streams & s, cgUInt32 i, const cgParticleStore::SimulationParams & p )
+    {
+        cgFloat * const * d = s.data;
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 dt   = _mm_set1_ps( p.timeDelta );
+        const __m128 age  = _mm_add_ps( _mm_loadu_ps( d[cgParticleStore::Age] + i ), dt );
+        _mm_storeu_ps( d[cgParticleStore::Age] + i, age );
+
+        // Update velocity for any particles that have a mass. Massless
+        // particles receive zero acceleration.
+        __m128 vx = _mm_loadu_ps( d[cgParticleStore::VelocityX] + i );
+        __m128 vy = _mm_loadu_ps( d[cgParticleStore::VelocityY] + i );
+        __m128 vz = _mm_loadu_ps( d[cgParticleStore::VelocityZ] + i );
+        const __m128 inverseMass = _mm_loadu_ps( d[cgParticleStore::InverseMass] + i );
+        const __m128 hasMass     = _mm_cmpgt_ps( inverseMass, zero );
+        const __m128 drag        = _mm_mul_ps( _mm_set1_ps( p.airResistance ), 
+            _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ), _mm_mul_ps( vz, vz ) ) ) );
+        __m128 ax = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( p.globalForce.x ), _mm_mul_ps( drag, vx ) ), inverseMass ), _mm_set1_ps( p.gravity.x ) );
+        __m128 ay = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( p.globalForce.y ), _mm_mul_ps( drag, vy ) ), inverseMass ), _mm_set1_ps( p.gravity.y ) );
+        __m128 az = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( p.globalForce.z ), _mm_mul_ps( drag, vz ) ), inverseMass ), _mm_set1_ps( p.gravity.z ) );
+        vx = _mm_add_ps( vx, _mm_and_ps( hasMass, _mm_mul_ps( ax, dt ) ) );
+        vy = _mm_add_ps( vy, _mm_and_ps( hasMass, _mm_mul_ps( ay, dt ) ) );
+        vz = _mm_add_ps( vz, _mm_and_ps( hasMass, _mm_mul_ps( az, dt ) ) );
+        _mm_storeu_ps( d[cgParticleStore::VelocityX] + i, vx );
+        _mm_storeu_ps( d[cgParticleStore::VelocityY] + i, vy );
+        _mm_storeu_ps( d[cgParticleStore::VelocityZ] + i, vz );
+
+        // Update angles and positions
+        _mm_storeu_ps( d[cgParticleStore::PositionX] + i, _mm_add_ps( _mm_loadu_ps( d[cgParticleStore::PositionX] + i ), _mm_mul_ps( vx, dt ) ) );
+        _mm_storeu_ps( d[cgParticleStore::PositionY] + i, _mm_add_ps( _mm_loadu_ps( d[cgParticleStore::PositionY] + i ), _mm_mul_ps( vy, dt ) ) );
+        _mm_storeu_ps( d[cgParticleStore::PositionZ] + i, _mm_add_ps( _mm_loadu_ps( d[cgParticleStore::PositionZ] + i ), _mm_mul_ps( vz, dt ) ) );
+        _mm_storeu_ps( d[cgParticleStore::Rotation] + i, _mm_add_ps( _mm_loadu_ps( d[cgParticleStore::Rotation] + i ), 
+                                                          _mm_mul_ps( _mm_loadu_ps( d[cgParticleStore::AngularVelocity] + i ), dt ) ) );
+
+        // Direction relative to the observer's world velocity. Stationary
+        // particles retain their previous direction.
+        ax = _mm_sub_ps( vx, _mm_set1_ps( p.worldVelocity.x ) );
+        ay = _mm_sub_ps( vy, _mm_set1_ps( p.worldVelocity.y ) );
+        az = _mm_sub_ps( vz, _mm_set1_ps( p.worldVelocity.z ) );
+        const __m128 speed  = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax, ax ), _mm_mul_ps( ay, ay ) ), _mm_mul_ps( az, az ) ) );
+        const __m128 moving = _mm_cmpgt_ps( speed, zero );
+        _mm_storeu_ps( d[cgParticleStore::DirectionX] + i, select4( moving, _mm_div_ps( ax, speed ), _mm_loadu_ps( d[cgParticleStore::DirectionX] + i ) ) );
+        _mm_storeu_ps( d[cgParticleStore::DirectionY] + i, select4( moving, _mm_div_ps( ay, speed ), _mm_loadu_ps( d[cgParticleStore::DirectionY] + i ) ) );
+        _mm_storeu_ps( d[cgParticleStore::DirectionZ] + i, select4( moving, _mm_div_ps( az, speed ), _mm_loadu_ps( d[cgParticleStore::DirectionZ] + i ) ) );
+
+        // Compute curve table indices and interpolation weights.
+        __m128 t = _mm_div_ps( age, _mm_loadu_ps( d[cgParticleStore::MaximumAge] + i ) );
+        t = _mm_min_ps( _mm_max_ps( t, zero ), _mm_set1_ps( 1.0f ) );
+        const __m128  f     = _mm_mul_ps( t, _mm_set1_ps( (cgFloat)(cgParticleStore::CurveResolution - 1) ) );
+        const __m128i index = _mm_cvttps_epi32( _mm_min_ps( f, _mm_set1_ps( (cgFloat)LastCurveSegment ) ) );
+        const __m128  weight = _mm_sub_ps( f, _mm_cvtepi32_ps( index ) );
+        cgInt32 indices[4];
+        _mm_storeu_si128( (__m128i*)indices, index );
+
+        // Evaluate property curves
+        __m128i color = packChannel4( sampleTable4( s.curves[cgParticleStore::ColorACurve], indices, weight ), 24 );
+        color = _mm_or_si128( color, packChannel4( sampleTable4( s.curves[cgParticleStore::ColorRCurve], indices, weight ), 16 ) );
+        color = _mm_or_si128( color, packChannel4( sampleTable4( s.curves[cgParticleStore::ColorGCurve], indices, weight ), 8 ) );
+        color = _mm_or_si128( color, packChannel4( sampleTable4( s.curves[cgParticleStore::ColorBCurve], indices, weight ), 0 ) );
+        _mm_storeu_si128( (__m128i*)(s.colors + i), color );
+        __m128 scaleY = sampleTable4( s.curves[cgParticleStore::ScaleYCurve], indices, weight );
+        if ( p.velocityScale )
+            scaleY = _mm_mul_ps( scaleY, _mm_add_ps( _mm_set1_ps( 1.0f ), _mm_mul_ps( _mm_sub_ps( speed, _mm_set1_ps( 1.0f ) ), _mm_set1_ps( p.velocityScaleStrength ) ) ) );
+        _mm_storeu_ps( d[cgParticleStore::ScaleX] + i, sampleTable4( s.curves[cgParticleStore::ScaleXCurve], indices, weight ) );
+        _mm_storeu_ps( d[cgParticleStore::ScaleY] + i, scaleY );
+    }
+#endif // CGE_MATH_SIMD_SSE2
+
+}; // End Namespace : ParticleStore
+
+///////////////////////////////////////////////////////////////////////////////
+// cgParticleStore Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgParticleStore () (Constructor)
+/// <summary>
+/// Class constructor.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgParticleStore::cgParticleStore( )
+{
+    // Initialize variables to sensible defaults
+    mCapacity = 0;
+    mCount    = 0;
+    for ( cgInt c = 0; c < CurveCount; ++c )
+    {
+        for ( cgInt i = 0; i < CurveResolution; ++i )
+            mCurves[c][i] = 1.0f;
+    
+    } // Next curve
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgParticleStore () (Destructor)
+/// <summary>
+/// Clean up any resources being used.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgParticleStore::~cgParticleStore( )
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setCapacity ()
+/// <summary>
+/// Set the maximum number of particles that can be stored. If the capacity 
+/// is reduced below the current number of live particles, those beyond the
+/// new capacity are discarded.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::setCapacity( cgUInt32 capacity )
+{
+    for ( cgInt k = 0; k < StreamCount; ++k )
+        mStreams[k].resize( capacity, 0.0f );
+    mColors.resize( capacity, 0 );
+    mTags.resize( capacity, 0 );
+    mCapacity = capacity;
+    if ( mCount > capacity )
+        mCount = capacity;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCapacity ()
+/// <summary>
+/// Retrieve the maximum number of particles that can be stored.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgParticleStore::getCapacity( ) const
+{
+    return mCapacity;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCount ()
+/// <summary>
+/// Retrieve the number of live particles currently stored.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgParticleStore::getCount( ) const
+{
+    return mCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : add ()
+/// <summary>
+/// Append a new particle with the specified tag and return its index. All
+/// streams are reset to zero other than the scale (one) and color (white). 
+/// The store must not already be at capacity.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgParticleStore::add( cgUInt32 tag )
+{
+    cgAssert( mCount < mCapacity );
+    const cgUInt32 index = mCount++;
+    for ( cgInt k = 0; k < StreamCount; ++k )
+        mStreams[k][index] = 0.0f;
+    mStreams[ScaleX][index] = 1.0f;
+    mStreams[ScaleY][index] = 1.0f;
+    mColors[index] = 0xFFFFFFFF;
+    mTags[index]   = tag;
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : remove ()
+/// <summary>
+/// Remove the particle at the specified index by moving the last live 
+/// particle into its slot. Indices obtained prior to this call that refer to
+/// the last particle are invalidated.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::remove( cgUInt32 index )
+{
+    cgAssert( index < mCount );
+    const cgUInt32 last = --mCount;
+    if ( index == last )
+        return;
+    for ( cgInt k = 0; k < StreamCount; ++k )
+        mStreams[k][index] = mStreams[k][last];
+    mColors[index] = mColors[last];
+    mTags[index]   = mTags[last];
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear ()
+/// <summary>
+/// Remove all live particles. Stream memory is retained.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::clear( )
+{
+    mCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : removeExpired ()
+/// <summary>
+/// Remove all particles whose age exceeds their maximum age. The tags of the
+/// removed particles are appended to the supplied array. Returns the number
+/// of particles that were removed.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgParticleStore::removeExpired( cgUInt32Array & tagsOut )
+{
+    cgUInt32 removed = 0;
+    for ( cgUInt32 i = 0; i < mCount; )
+    {
+        if ( mStreams[Age][i] > mStreams[MaximumAge][i] )
+        {
+            // Swap in the last particle and re-test this slot.
+            tagsOut.push_back( mTags[i] );
+            remove( i );
+            ++removed;
+        
+        } // End if expired
+        else
+            ++i;
+    
+    } // Next particle
+    return removed;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : bakeCurve ()
+/// <summary>
+/// Evaluate the specified spline at regular intervals over the normalized 
+/// particle lifetime [0, 1] and store the results in the lookup table that
+/// is sampled for the specified curve during simulation.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::bakeCurve( Curve curve, cgBezierSpline2 & spline )
+{
+    cgFloat positions[CurveResolution];
+    for ( cgInt i = 0; i < CurveResolution; ++i )
+        positions[i] = (cgFloat)i / (cgFloat)(CurveResolution - 1);
+    spline.evaluate( positions, mCurves[curve], CurveResolution );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : sampleCurve ()
+/// <summary>
+/// Sample the baked lookup table for the specified curve at the normalized
+/// position 't' using linear interpolation.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgParticleStore::sampleCurve( Curve curve, cgFloat t ) const
+{
+    return ParticleStore::sampleTable( mCurves[curve], t );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : simulate ()
+/// <summary>
+/// Step the simulation for all live particles. Large stores are split into
+/// ranges that are distributed across any available job system worker 
+/// threads.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::simulate( const SimulationParams & params )
+{
+    ParticleStore::BatchData data;
+    data.store  = this;
+    data.params = &params;
+    cgJobSystem::parallelFor( mCount, ParticleStore::SimulateGrainSize, executeSimulate, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : simulate ()
+/// <summary>
+/// Step the simulation for the particles in the range [first, last) on the
+/// calling thread. Integrates velocity, position and rotation, computes the
+/// direction relative to the supplied world velocity and evaluates the baked
+/// color and scale curves at each particle's normalized age. Ages are 
+/// advanced but expired particles are not removed; see 'removeExpired()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::simulate( cgUInt32 first, cgUInt32 last, const SimulationParams & params )
+{
+    if ( first >= last )
+        return;
+
+    // Collect stream pointers for the kernels.
+    ParticleStore::Streams s;
+    for ( cgInt k = 0; k < StreamCount; ++k )
+        s.data[k] = &mStreams[k].front();
+    for ( cgInt c = 0; c < CurveCount; ++c )
+        s.curves[c] = mCurves[c];
+    s.colors = &mColors.front();
+
+    // Process particles.
+    cgUInt32 i = first;
+#if defined(CGE_MATH_SIMD_SSE2)
+    for ( ; i + 4 <= last; i += 4 )
+        ParticleStore::simulateBlock4( s, i, params );
+#endif // CGE_MATH_SIMD_SSE2
+    for ( ; i < last; ++i )
+        ParticleStore::simulateParticle( s, i, params );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : executeSimulate () (Protected, Static)
+/// <summary>
+/// Job system callback that simulates the specified range of particles.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgParticleStore::executeSimulate( cgUInt32 first, cgUInt32 last, void * context )
+{
+    ParticleStore::BatchData * data = (ParticleStore::BatchData*)context;
+    data->store->simulate( first, last, *data->params );
+}
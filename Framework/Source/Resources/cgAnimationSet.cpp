@@ -31,6 +31,7 @@
 #include <System/cgExceptions.h>
 #include <Math/cgMathTypes.h>
 #include <Math/cgEulerAngles.h>
+#include <algorithm>
 
 //-----------------------------------------------------------------------------
 // Static Member Definitions
@@ -60,6 +61,10 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld ) : cgWo
     mFirstFrame         = INT_MAX;
     mLastFrame         = INT_MIN;
     mFramesPerSecond  = 30.0f;
+    mTargetRevision   = 0;
+    mKeyStreamRevision = 0;
+    mKeyStreamTargets = 0;
+    mKeyStreamDirty   = false;
 
     // Loading and serialization
     mSourceRefId      = 0;
@@ -86,6 +91,10 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgFloat
     mFirstFrame         = INT_MAX;
     mLastFrame         = INT_MIN;
     mFramesPerSecond  = fFrameRate;
+    mTargetRevision   = 0;
+    mKeyStreamRevision = 0;
+    mKeyStreamTargets = 0;
+    mKeyStreamDirty   = false;
 
     // Loading and serialization
     mSourceRefId      = 0;
@@ -112,6 +121,10 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgAnima
     mFirstFrame       = pInit->mFirstFrame;
     mLastFrame        = pInit->mLastFrame;
     mFramesPerSecond  = pInit->mFramesPerSecond;
+    mTargetRevision   = 0;
+    mKeyStreamRevision = 0;
+    mKeyStreamTargets = 0;
+    mKeyStreamDirty   = true;
 
     // ToDo: Perform deep clone!
     mTargetData       = pInit->mTargetData;
@@ -127,6 +140,9 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgAnima
     mResourceLoaded   = false; // Note: Important that the set is not classed as loaded since its data may need to be serialized.
     mResourceLost     = false;
     mCanEvict         = (isInternalReference() == false);
+
+    // Build the key stream for the duplicated data.
+    prepareKeyStream();
 }
 
 //-----------------------------------------------------------------------------
@@ -141,6 +157,10 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgAnima
     mFirstFrame       = 0;
     mLastFrame        = (frameRange.max - frameRange.min);
     mFramesPerSecond  = pInit->mFramesPerSecond;
+    mTargetRevision   = 0;
+    mKeyStreamRevision = 0;
+    mKeyStreamTargets = 0;
+    mKeyStreamDirty   = true;
 
     // Duplicate target data within specified frame ranges.
     TargetDataMap::const_iterator itTarget;
@@ -176,6 +196,9 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgAnima
     mResourceLoaded   = false; // Note: Important that the set is not classed as loaded since its data may need to be serialized.
     mResourceLost     = false;
     mCanEvict         = (isInternalReference() == false);
+
+    // Build the key stream for the duplicated data.
+    prepareKeyStream();
 }
 
 //-----------------------------------------------------------------------------
@@ -190,6 +213,10 @@ cgAnimationSet::cgAnimationSet( cgUInt32 nReferenceId, cgWorld * pWorld, cgUInt3
     mFirstFrame       = INT_MAX;
     mLastFrame        = INT_MIN;
     mFramesPerSecond  = 30.0f;
+    mTargetRevision   = 0;
+    mKeyStreamRevision = 0;
+    mKeyStreamTargets = 0;
+    mKeyStreamDirty   = false;
     
     // Loading and serialization
     mSourceRefId      = nSourceRefId;
@@ -379,6 +406,8 @@ bool cgAnimationSet::unloadResource( )
 
     } // Next Target
     mTargetData.clear();
+    mTargetRevision++;
+    prepareKeyStream();
 
     // Clear variables
     mName.clear();
@@ -509,12 +538,16 @@ bool cgAnimationSet::loadSet( cgUInt32 nSourceRefId, cgResourceManager * pManage
 
             // Associate data with the target.
             mTargetData[ strTargetId ] = Data;
+            mTargetRevision++;
 
         } // Next Target Row
 
         // We're done with the target data.
         mLoadTargetData.reset();
 
+        // Build the key stream for the loaded data.
+        prepareKeyStream();
+
         // Force serialization of all data next time 'serializeSet()' is called
         // if it was necessary for us to clone the animation set data.
         if ( bCloneData )
@@ -784,6 +817,9 @@ bool cgAnimationSet::resumeSerialization( bool bFlush /* = true */ )
     if ( !mSuspendSerialization ) 
         return true;
 
+    // Rebuild the key stream deferred while suspended.
+    prepareKeyStream();
+
     // Flush on request.
     if ( bFlush )
     {
@@ -876,6 +912,20 @@ const cgAnimationSet::TargetDataMap & cgAnimationSet::getTargetData() const
     return mTargetData;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getTargetRevision ()
+/// <summary>
+/// Retrieve a counter that is incremented whenever targets are added to or
+/// removed from this set, or their controllers may have been replaced. Any
+/// cached references to the set's target data should be refreshed when this
+/// value changes.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgAnimationSet::getTargetRevision( ) const
+{
+    return mTargetRevision;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : getTargetData ()
 /// <summary>
@@ -922,8 +972,12 @@ cgAnimationSet::TargetData * cgAnimationSet::getTargetData( const cgString & tar
     {
         if ( !createTargetData )
             return CG_NULL;
-        else
-            return &mTargetData.insert( TargetDataMap::value_type( targetId, TargetData() ) ).first->second;
+        
+        // Target list has changed.
+        TargetData * pData = &mTargetData.insert( TargetDataMap::value_type( targetId, TargetData() ) ).first->second;
+        mTargetRevision++;
+        invalidateKeyStream();
+        return pData;
     
     } // End if not found
     
@@ -1205,6 +1259,12 @@ void cgAnimationSet::targetDataUpdated( bool recomputeRange )
 
     } // End if recompute range
 
+    // Controllers may have been replaced.
+    mTargetRevision++;
+
+    // Key stream must be rebuilt.
+    invalidateKeyStream();
+
     // Mark target data as dirty.
     mDBDirtyFlags |= TargetDataDirty;
     
@@ -1222,7 +1282,7 @@ void cgAnimationSet::targetDataUpdated( bool recomputeRange )
 void cgAnimationSet::addScaleKey( cgInt32 nFrame, const cgString & strTargetId, const cgVector3 & Scale )
 {
     // If there is no scale controller, assign the default.
-    TargetData & Data = mTargetData[ strTargetId ];
+    TargetData & Data = *getTargetData( strTargetId, true );
     if ( !Data.scaleController )
         Data.scaleController = new cgScaleXYZTargetController();
 
@@ -1252,6 +1312,9 @@ void cgAnimationSet::addScaleKey( cgInt32 nFrame, const cgString & strTargetId,
     if ( nFrame > mLastFrame )
         mLastFrame = nFrame;
 
+    // Key stream must be rebuilt.
+    invalidateKeyStream();
+
     // Mark target data as dirty.
     mDBDirtyFlags |= TargetDataDirty;
     
@@ -1269,7 +1332,7 @@ void cgAnimationSet::addScaleKey( cgInt32 nFrame, const cgString & strTargetId,
 void cgAnimationSet::addRotationKey( cgInt32 nFrame, const cgString & strTargetId, const cgQuaternion & Rotation )
 {
     // If there is no rotation controller, assign the default.
-    TargetData & Data = mTargetData[ strTargetId ];
+    TargetData & Data = *getTargetData( strTargetId, true );
     if ( !Data.rotationController )
         Data.rotationController = new cgQuaternionTargetController();
 
@@ -1293,6 +1356,9 @@ void cgAnimationSet::addRotationKey( cgInt32 nFrame, const cgString & strTargetI
     if ( nFrame > mLastFrame )
         mLastFrame = nFrame;
 
+    // Key stream must be rebuilt.
+    invalidateKeyStream();
+
     // Mark target data as dirty.
     mDBDirtyFlags |= TargetDataDirty;
     
@@ -1310,7 +1376,7 @@ void cgAnimationSet::addRotationKey( cgInt32 nFrame, const cgString & strTargetI
 void cgAnimationSet::addTranslationKey( cgInt32 nFrame, const cgString & strTargetId, const cgVector3 & Translation )
 {
     // If there is no translation controller, assign the default.
-    TargetData & Data = mTargetData[ strTargetId ];
+    TargetData & Data = *getTargetData( strTargetId, true );
     if ( !Data.translationController )
         Data.translationController = new cgPositionXYZTargetController();
 
@@ -1330,6 +1396,9 @@ void cgAnimationSet::addTranslationKey( cgInt32 nFrame, const cgString & strTarg
     if ( nFrame > mLastFrame )
         mLastFrame = nFrame;
 
+    // Key stream must be rebuilt.
+    invalidateKeyStream();
+
     // Mark target data as dirty.
     mDBDirtyFlags |= TargetDataDirty;
     
@@ -1451,10 +1520,6 @@ bool cgAnimationSet::getSRT( cgDouble framePosition, cgAnimationPlaybackMode::Ba
 //-----------------------------------------------------------------------------
 bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, const cgString & strTargetId, cgInt32 nMinFrame, cgInt32 nMaxFrame, cgAnimationTarget * pDefaultsTarget, cgVector3 & Scale, cgQuaternion & Rotation, cgVector3 & Translation )
 {
-    cgVector3 DefaultScale( 1, 1, 1 ), DefaultTranslation( 0, 0, 0 );
-    cgQuaternion DefaultRotation( 0, 0, 0, 1 );
-    bool bDefaultsDecomposed = false;
-
     // Any target matching this identifier?
     TargetDataMap::iterator itTargetData = mTargetData.find( strTargetId );
     if ( itTargetData == mTargetData.end() )
@@ -1469,32 +1534,51 @@ bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::B
     
     } // End if no matching target
 
-    // Cache reference for easy access
-    TargetData & Data = itTargetData->second;
+    // Evaluate the target's controllers.
+    return getSRT( fFramePosition, mode, itTargetData->second, nMinFrame, nMaxFrame, pDefaultsTarget, Scale, Rotation, Translation );
+}
 
-    // Compute the minimum and maximum period for this animation set.
-    // It isn't necessarily the case that the set starts on frame 0.
-    cgDouble fMinPeriod = (nMinFrame == 0x7FFFFFFF) ? (cgDouble)mFirstFrame : (cgDouble)nMinFrame;
-    cgDouble fMaxPeriod = (nMaxFrame == 0x7FFFFFFF) ? (cgDouble)mLastFrame : (cgDouble)nMaxFrame;
+//-----------------------------------------------------------------------------
+//  Name : getSRT ()
+/// <summary>
+/// Retrieve the scale, rotation and translation values described by the 
+/// specified target data (previously retrieved from this set with a call to
+/// 'getTargetData()') at the specified position (in frames). This allows
+/// callers that sample the same targets repeatedly to avoid looking them up
+/// by identifier each time.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, const TargetData & Data, cgInt32 nMinFrame, cgInt32 nMaxFrame, cgAnimationTarget * pDefaultsTarget, cgVector3 & Scale, cgQuaternion & Rotation, cgVector3 & Translation )
+{
+    return getSRT( fFramePosition, mode, Data, nMinFrame, nMaxFrame, pDefaultsTarget, CG_NULL, Scale, Rotation, Translation );
+}
 
-    // Map the specified frame position into the "periodic" for this animation set.
-    cgDouble fPeriodic = 0.0f;
-    switch ( mode )
-    {
-        case cgAnimationPlaybackMode::Loop:
-            if ( fFramePosition > 0 )
-                fPeriodic = fMinPeriod + fmod( fFramePosition, (fMaxPeriod - fMinPeriod) );
-            else
-                fPeriodic = fMinPeriod + ((fMaxPeriod - fMinPeriod) + fmod( fFramePosition, (fMaxPeriod - fMinPeriod) ));
-            break;
+//-----------------------------------------------------------------------------
+//  Name : getSRT ()
+/// <summary>
+/// Retrieve the scale, rotation and translation values described by the 
+/// specified target data at the specified position (in frames) using (and
+/// updating) the supplied array of 'CursorChannelCount' key cursors. When a
+/// target is sampled repeatedly at nearby positions, the cursors allow each
+/// channel's keys to be located without searching. Cursors should be 
+/// initialized to -1 prior to the first call, or can be maintained for all
+/// targets in the set by a 'SampleCursor' (see 'advanceCursor()'). A value
+/// of CG_NULL can be supplied if no cursors are available.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, const TargetData & Data, cgInt32 nMinFrame, cgInt32 nMaxFrame, cgAnimationTarget * pDefaultsTarget, cgInt32 * pCursors, cgVector3 & Scale, cgQuaternion & Rotation, cgVector3 & Translation )
+{
+    cgVector3 DefaultScale( 1, 1, 1 ), DefaultTranslation( 0, 0, 0 );
+    cgQuaternion DefaultRotation( 0, 0, 0, 1 );
+    bool bDefaultsDecomposed = false;
 
-        case cgAnimationPlaybackMode::PlayOnce:
-            fPeriodic = fMinPeriod + fFramePosition;
-            fPeriodic = max( fMinPeriod, fPeriodic );
-            fPeriodic = min( fMaxPeriod, fPeriodic );
-            break;
-    
-    } // End switch playback mode
+    // Search all channels from scratch if no cursors were supplied.
+    cgInt32 pLocalCursors[CursorChannelCount] = { -1, -1, -1, -1, -1, -1, -1 };
+    if ( !pCursors )
+        pCursors = pLocalCursors;
+
+    // Map the specified frame position into the "periodic" for this animation set.
+    const cgDouble fPeriodic = computePeriodic( fFramePosition, mode, nMinFrame, nMaxFrame );
 
     // Evaluate scale
     bool bUseDefaultTransform = true;
@@ -1521,7 +1605,7 @@ bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::B
                         
                     } // End if any of the channels are empty.
 
-                    ((cgScaleXYZTargetController*)Data.scaleController)->evaluate( fPeriodic, Scale, DefaultScale );
+                    ((cgScaleXYZTargetController*)Data.scaleController)->evaluate( fPeriodic, Scale, DefaultScale, pCursors + ScaleCursor );
                     bUseDefaultTransform = false;
                 
                 } // End if !empty
@@ -1605,7 +1689,7 @@ bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::B
                 
                 if ( !((cgQuaternionTargetController*)Data.rotationController)->isEmpty() )
                 {
-                    ((cgQuaternionTargetController*)Data.rotationController)->evaluate( fPeriodic, Rotation, DefaultRotation );
+                    ((cgQuaternionTargetController*)Data.rotationController)->evaluate( fPeriodic, Rotation, DefaultRotation, pCursors[RotationCursor] );
                     bUseDefaultTransform = false;
                 
                 } // End if !empty
@@ -1656,7 +1740,7 @@ bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::B
                         
                     } // End if any of the channels are empty.
 
-                    ((cgPositionXYZTargetController*)Data.translationController)->evaluate( fPeriodic, Translation, DefaultTranslation );
+                    ((cgPositionXYZTargetController*)Data.translationController)->evaluate( fPeriodic, Translation, DefaultTranslation, pCursors + TranslationCursor );
                     bUseDefaultTransform = false;
                 
                 } // End if !empty
@@ -1685,4 +1769,235 @@ bool cgAnimationSet::getSRT( cgDouble fFramePosition, cgAnimationPlaybackMode::B
 
     // Success!
     return true;
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+//  Name : evaluate ()
+/// <summary>
+/// Retrieve the scale, rotation and translation values for every target in 
+/// the set at the specified position (in frames). The supplied cursor is 
+/// first advanced to the new position in a single pass over the set's key 
+/// stream (see 'advanceCursor()'), after which each channel is sampled 
+/// without searching. Output arrays must contain an entry for each target 
+/// and are indexed by 'TargetData::index'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::evaluate( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, cgInt32 nMinFrame, cgInt32 nMaxFrame, SampleCursor & Cursor, cgVector3 * pScale, cgQuaternion * pRotation, cgVector3 * pTranslation )
+{
+    advanceCursor( fFramePosition, mode, nMinFrame, nMaxFrame, Cursor );
+    
+    // Sample each target.
+    TargetDataMap::const_iterator itTarget;
+    for ( itTarget = mTargetData.begin(); itTarget != mTargetData.end(); ++itTarget )
+    {
+        const TargetData & Data = itTarget->second;
+        const cgUInt32 nIndex = Data.index;
+        getSRT( fFramePosition, mode, Data, nMinFrame, nMaxFrame, CG_NULL, &Cursor.keys[ nIndex * CursorChannelCount ],
+                pScale[nIndex], pRotation[nIndex], pTranslation[nIndex] );
+    
+    } // Next target
+}
+
+//-----------------------------------------------------------------------------
+//  Name : advanceCursor ()
+/// <summary>
+/// Update the key cursors for every channel of every target in the set to 
+/// reflect the specified position (in frames). Keys reached since the 
+/// cursor was last advanced are consumed from the time sorted key stream in
+/// a single linear pass. Should the position move backwards (i.e. when a 
+/// looping animation wraps) the cursor is reset and the stream consumed 
+/// again from the beginning. The resulting cursors for a target can be 
+/// supplied to 'getSRT()' at offset 'TargetData::index * CursorChannelCount'.
+/// The set is not modified, so any number of threads may advance their own
+/// cursors against the same set concurrently.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::advanceCursor( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, cgInt32 nMinFrame, cgInt32 nMaxFrame, SampleCursor & Cursor ) const
+{
+    // Reset the cursor if it was advanced against a prior key stream, or
+    // the position has moved backwards.
+    const cgDouble fPeriodic = computePeriodic( fFramePosition, mode, nMinFrame, nMaxFrame );
+    const size_t nChannelCount = mTargetData.size() * CursorChannelCount;
+    if ( Cursor.revision != mKeyStreamRevision || Cursor.keys.size() != nChannelCount || fPeriodic < Cursor.position )
+    {
+        Cursor.keys.clear();
+        Cursor.keys.resize( nChannelCount, 0 );
+        Cursor.streamKey = 0;
+        Cursor.revision  = mKeyStreamRevision;
+    
+    } // End if reset
+
+    // The key stream is out of date only while keys are being added with
+    // serialization suspended. Cursors are merely hints to 'getSRT()' so
+    // the cursor is left at its reset state until the stream is rebuilt.
+    Cursor.position = fPeriodic;
+    if ( mKeyStreamDirty || mKeyStreamTargets != mTargetRevision )
+        return;
+
+    // Consume all keys reached by the new position.
+    const cgFloat x = (cgFloat)fPeriodic;
+    const cgUInt32 nStreamSize = (cgUInt32)mKeyStream.size();
+    cgUInt32 nKey = Cursor.streamKey;
+    for ( ; nKey < nStreamSize && mKeyStream[nKey].frame <= x; ++nKey )
+        Cursor.keys[ mKeyStream[nKey].channel ] = mKeyStream[nKey].key;
+    Cursor.streamKey = nKey;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : prepareKeyStream ()
+/// <summary>
+/// Ensure that the time sorted stream of keys used to advance sample cursors
+/// (along with any cached curve data) is up to date. This is performed 
+/// automatically whenever the set is loaded or its keys or targets change
+/// (see 'invalidateKeyStream()'), so that sampling never modifies the set.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::prepareKeyStream( )
+{
+    // Anything changed since the stream was built?
+    if ( !mKeyStreamDirty && mKeyStreamTargets == mTargetRevision )
+        return;
+
+    // Gather keys from each supported controller, assigning each target 
+    // its index into the sample cursor.
+    mKeyStream.clear();
+    cgUInt32 nIndex = 0;
+    TargetDataMap::iterator itTarget;
+    for ( itTarget = mTargetData.begin(); itTarget != mTargetData.end(); ++itTarget, ++nIndex )
+    {
+        TargetData & Data = itTarget->second;
+        const cgUInt32 nFirstChannel = nIndex * CursorChannelCount;
+        Data.index = nIndex;
+
+        // Scale
+        if ( Data.scaleController && Data.scaleController->getControllerType() == cgAnimationTargetControllerType::ScaleXYZ )
+        {
+            cgScaleXYZTargetController * pController = (cgScaleXYZTargetController*)Data.scaleController;
+            for ( cgUInt32 i = 0; i < 3; ++i )
+                appendKeyStream( pController->getAnimationChannel(i).data, nFirstChannel + ScaleCursor + i );
+        
+        } // End if ScaleXYZ
+
+        // Rotation
+        if ( Data.rotationController && Data.rotationController->getControllerType() == cgAnimationTargetControllerType::Quaternion )
+        {
+            cgQuaternionTargetController * pController = (cgQuaternionTargetController*)Data.rotationController;
+            appendKeyStream( pController->getAnimationChannel(), nFirstChannel + RotationCursor );
+        
+        } // End if Quaternion
+
+        // Translation
+        if ( Data.translationController && Data.translationController->getControllerType() == cgAnimationTargetControllerType::PositionXYZ )
+        {
+            cgPositionXYZTargetController * pController = (cgPositionXYZTargetController*)Data.translationController;
+            for ( cgUInt32 i = 0; i < 3; ++i )
+                appendKeyStream( pController->getAnimationChannel(i).data, nFirstChannel + TranslationCursor + i );
+        
+        } // End if PositionXYZ
+
+    } // Next target
+
+    // Sort into playback order.
+    std::sort( mKeyStream.begin(), mKeyStream.end() );
+
+    // Stream is up to date. Any existing sample cursors are now invalid.
+    mKeyStreamDirty   = false;
+    mKeyStreamTargets = mTargetRevision;
+    mKeyStreamRevision++;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : invalidateKeyStream () (Protected)
+/// <summary>
+/// Called whenever keys or targets have been added or replaced. The key 
+/// stream is rebuilt immediately unless serialization is suspended, in 
+/// which case the rebuild is deferred until 'resumeSerialization()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::invalidateKeyStream( )
+{
+    mKeyStreamDirty = true;
+    if ( !mSuspendSerialization )
+        prepareKeyStream();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : appendKeyStream () (Protected)
+/// <summary>
+/// Append an entry to the key stream for each point at which the segment
+/// cursor for the specified curve channel should advance.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::appendKeyStream( cgBezierSpline2 & Curve, cgUInt32 nChannel )
+{
+    // Curve data must be up to date before it can be sampled concurrently.
+    Curve.prepare();
+
+    // The segment beginning at the last point is never entered.
+    const cgBezierSpline2::SplinePointArray & Points = Curve.getPoints();
+    for ( cgInt32 i = 1; i < (cgInt32)Points.size() - 1; ++i )
+    {
+        KeyStreamEntry Entry;
+        Entry.frame   = Points[i].point.x;
+        Entry.channel = nChannel;
+        Entry.key     = i;
+        mKeyStream.push_back( Entry );
+    
+    } // Next point
+}
+
+//-----------------------------------------------------------------------------
+//  Name : appendKeyStream () (Protected)
+/// <summary>
+/// Append an entry to the key stream for each key at which the cursor for
+/// the specified quaternion channel should advance.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgAnimationSet::appendKeyStream( const cgQuaternionAnimationChannel & Keys, cgUInt32 nChannel )
+{
+    // The segment beginning at the last key is never entered.
+    for ( cgInt32 i = 1; i < (cgInt32)Keys.data.size() - 1; ++i )
+    {
+        KeyStreamEntry Entry;
+        Entry.frame   = (cgFloat)Keys.data[i].frame;
+        Entry.channel = nChannel;
+        Entry.key     = i;
+        mKeyStream.push_back( Entry );
+    
+    } // Next key
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computePeriodic () (Protected)
+/// <summary>
+/// Map the specified frame position into the "periodic" for this animation
+/// set based on the playback mode and frame limits.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgDouble cgAnimationSet::computePeriodic( cgDouble fFramePosition, cgAnimationPlaybackMode::Base mode, cgInt32 nMinFrame, cgInt32 nMaxFrame ) const
+{
+    // Compute the minimum and maximum period for this animation set.
+    // It isn't necessarily the case that the set starts on frame 0.
+    cgDouble fMinPeriod = (nMinFrame == 0x7FFFFFFF) ? (cgDouble)mFirstFrame : (cgDouble)nMinFrame;
+    cgDouble fMaxPeriod = (nMaxFrame == 0x7FFFFFFF) ? (cgDouble)mLastFrame : (cgDouble)nMaxFrame;
+
+    // Map the specified frame position into the "periodic" for this animation set.
+    cgDouble fPeriodic = 0.0f;
+    switch ( mode )
+    {
+        case cgAnimationPlaybackMode::Loop:
+            if ( fFramePosition > 0 )
+                fPeriodic = fMinPeriod + fmod( fFramePosition, (fMaxPeriod - fMinPeriod) );
+            else
+                fPeriodic = fMinPeriod + ((fMaxPeriod - fMinPeriod) + fmod( fFramePosition, (fMaxPeriod - fMinPeriod) ));
+            break;
+
+        case cgAnimationPlaybackMode::PlayOnce:
+            fPeriodic = fMinPeriod + fFramePosition;
+            fPeriodic = max( fMinPeriod, fPeriodic );
+            fPeriodic = min( fMaxPeriod, fPeriodic );
+            break;
+    
+    } // End switch playback mode
+    return fPeriodic;
+}
@@ -36,11 +36,13 @@
 #include <Rendering/cgRenderingCapabilities.h>
 #include <System/cgStringUtility.h>
 #include <System/cgExceptions.h>
+#include <System/cgJobSystem.h>
 #include <World/Objects/cgCameraObject.h>
 #include <World/cgObjectNode.h>
 #include <World/cgWorldQuery.h>
 #include <Math/cgMathUtility.h>
 #include <Math/cgCollision.h>
+#include <Math/cgTriangleBVH.h>
 #include <unordered_map>
 
 // ToDo: 9999 - If any vertex format (including that specified to prepareMesh() and setVertexSource())
@@ -82,6 +84,246 @@ namespace MeshOptimizer
 
 }; // End namespace MeshOptimizer
 
+// Spatial hash grid used to accelerate vertex welding.
+namespace MeshWeld
+{
+    const cgUInt32 ParallelThreshold  = 65536;       // Vertex count above which matching is automatically multi-threaded.
+    const cgUInt32 InvalidIndex       = 0xFFFFFFFF;
+    const cgFloat  CellLimit          = 1073741824.0f; // Clamp for quantized coordinates (2^30).
+
+    // Quantized grid coordinates of a single vertex position.
+    struct Cell
+    {
+        cgInt32 x, y, z;
+    };
+
+    // State shared by every range of the candidate matching pass.
+    struct Grid
+    {
+        cgByte        * vertices;       // Source vertex data.
+        cgVertexFormat* format;         // Format of the above vertices.
+        cgUInt32        stride;         // Size of a single vertex in bytes.
+        cgFloat         tolerance;      // Tolerance used to compare vertex components.
+        cgInt           keyOffset;      // Offset of the element used to assign grid cells (-1 if none).
+        cgUInt32        keyType;        // Declarator type of the above element.
+        Cell          * cells;          // Grid cell occupied by each vertex.
+        cgUInt32      * heads;          // Hash table of cells; stores the lowest vertex index in each occupied cell.
+        cgUInt32      * next;           // Next (ascending) vertex index within the same cell.
+        cgUInt32        tableMask;      // Hash table size - 1.
+        cgUInt32      * representatives;// Lowest matching vertex index for each vertex (output).
+    };
+
+    //-------------------------------------------------------------------------
+    //  Name : hashCell ()
+    /// <summary>
+    /// Compute the hash table slot in which the specified cell should be
+    /// searched for first.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    inline cgUInt32 hashCell( const Cell & cell, cgUInt32 tableMask )
+    {
+        return (((cgUInt32)cell.x * 73856093u) ^ ((cgUInt32)cell.y * 19349663u) ^ ((cgUInt32)cell.z * 83492791u)) & tableMask;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : quantize ()
+    /// <summary>
+    /// Convert a world space coordinate into a (clamped) grid coordinate.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    inline cgInt32 quantize( cgFloat value, cgFloat invCellSize )
+    {
+        cgFloat cell = floorf( value * invCellSize );
+        if ( !(cell > -CellLimit) )
+            cell = -CellLimit;
+        else if ( cell > CellLimit )
+            cell = CellLimit;
+        return (cgInt32)cell;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : selectKeyElement ()
+    /// <summary>
+    /// Select the vertex element whose components are used to assign grid
+    /// cells. This is the position if available, otherwise the first floating
+    /// point or color element (all of which are compared against the weld
+    /// tolerance by 'cgVertexFormat::compareVertices()').
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void selectKeyElement( Grid & grid )
+    {
+        grid.keyOffset = -1;
+        grid.keyType   = D3DDECLTYPE_UNUSED;
+        const D3DVERTEXELEMENT9 * pElement = grid.format->getElement( D3DDECLUSAGE_POSITION );
+        if ( !pElement )
+        {
+            const D3DVERTEXELEMENT9 * pElements = grid.format->getDeclarator();
+            for ( cgUInt16 i = 0; i < grid.format->getElementCount() && !pElement; ++i )
+            {
+                switch ( pElements[i].Type )
+                {
+                    case D3DDECLTYPE_FLOAT1:
+                    case D3DDECLTYPE_FLOAT2:
+                    case D3DDECLTYPE_FLOAT3:
+                    case D3DDECLTYPE_FLOAT4:
+                    case D3DDECLTYPE_UBYTE4N:
+                    case D3DDECLTYPE_D3DCOLOR:
+                        pElement = &pElements[i];
+                        break;
+                
+                } // End switch type
+
+            } // Next element
+        
+        } // End if no position
+        if ( pElement )
+        {
+            grid.keyOffset = pElement->Offset;
+            grid.keyType   = pElement->Type;
+        
+        } // End if found
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : computeCell ()
+    /// <summary>
+    /// Compute the grid cell in which the specified vertex resides, using up
+    /// to three components of the selected key element.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void computeCell( const Grid & grid, const cgByte * vertex, Cell & cell )
+    {
+        const cgFloat invCellSize = 1.0f / grid.tolerance;
+        cell.x = cell.y = cell.z = 0;
+        if ( grid.keyOffset < 0 )
+            return;
+        const cgFloat * components = (const cgFloat*)(vertex + grid.keyOffset);
+        switch ( grid.keyType )
+        {
+            case D3DDECLTYPE_FLOAT4:
+            case D3DDECLTYPE_FLOAT3:
+                cell.z = quantize( components[2], invCellSize );
+                // Drop through
+            case D3DDECLTYPE_FLOAT2:
+                cell.y = quantize( components[1], invCellSize );
+                // Drop through
+            case D3DDECLTYPE_FLOAT1:
+                cell.x = quantize( components[0], invCellSize );
+                break;
+
+            case D3DDECLTYPE_UBYTE4N:
+            case D3DDECLTYPE_D3DCOLOR:
+            {
+                const cgColorValue color( *((const cgUInt32*)components) );
+                cell.x = quantize( color.r, invCellSize );
+                cell.y = quantize( color.g, invCellSize );
+                cell.z = quantize( color.b, invCellSize );
+                break;
+            
+            } // End case color
+
+        } // End switch type
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : findCell ()
+    /// <summary>
+    /// Retrieve the lowest vertex index stored in the specified cell, or
+    /// InvalidIndex if the cell is not occupied.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    inline cgUInt32 findCell( const Grid & grid, const Cell & cell )
+    {
+        for ( cgUInt32 slot = hashCell( cell, grid.tableMask ); ; slot = (slot + 1) & grid.tableMask )
+        {
+            const cgUInt32 head = grid.heads[slot];
+            if ( head == InvalidIndex )
+                return InvalidIndex;
+            const Cell & other = grid.cells[head];
+            if ( other.x == cell.x && other.y == cell.y && other.z == cell.z )
+                return head;
+        
+        } // Next slot
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : matchVertex ()
+    /// <summary>
+    /// Find the lowest indexed vertex in the surrounding 3x3x3 block of cells
+    /// that is equal to the specified vertex within the grid tolerance. When
+    /// 'keptOnly' is set, only vertices that have already been resolved as
+    /// representatives of their own are considered.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    cgUInt32 matchVertex( const Grid & grid, cgUInt32 i, bool keptOnly )
+    {
+        cgByte * vertex = grid.vertices + i * grid.stride;
+        const Cell & center = grid.cells[i];
+        cgUInt32 best = i;
+        
+        // Probe all neighboring cells.
+        Cell cell;
+        for ( cgInt32 z = -1; z <= 1; ++z )
+        {
+            cell.z = center.z + z;
+            for ( cgInt32 y = -1; y <= 1; ++y )
+            {
+                cell.y = center.y + y;
+                for ( cgInt32 x = -1; x <= 1; ++x )
+                {
+                    cell.x = center.x + x;
+
+                    // Chains are sorted, so stop as soon as we reach a
+                    // vertex that could not improve on the current best.
+                    for ( cgUInt32 j = findCell( grid, cell ); j < best; j = grid.next[j] )
+                    {
+                        if ( keptOnly && grid.representatives[j] != j )
+                            continue;
+                        if ( cgVertexFormat::compareVertices( vertex, grid.vertices + j * grid.stride, grid.format, grid.tolerance ) == 0 )
+                        {
+                            best = j;
+                            break;
+                        
+                        } // End if match
+                    
+                    } // Next candidate
+                
+                } // Next x
+            
+            } // Next y
+        
+        } // Next z
+        return best;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : matchVertices ()
+    /// <summary>
+    /// For each vertex in the specified range, find the lowest indexed vertex
+    /// that is equal to it within the grid tolerance (irrespective of whether
+    /// that vertex is itself collapsed). Each vertex is written independently
+    /// so that ranges can be processed in parallel with identical results.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void matchVertices( Grid & grid, cgUInt32 first, cgUInt32 last )
+    {
+        for ( cgUInt32 i = first; i < last; ++i )
+            grid.representatives[i] = matchVertex( grid, i, false );
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : matchRange ()
+    /// <summary>
+    /// Job system entry point for the parallel candidate matching pass.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void matchRange( cgUInt32 first, cgUInt32 last, void * context )
+    {
+        matchVertices( *(Grid*)context, first, last );
+    }
+
+}; // End namespace MeshWeld
+
 ///////////////////////////////////////////////////////////////////////////////
 // cgMesh Member Definitions
 ///////////////////////////////////////////////////////////////////////////////
@@ -112,6 +354,7 @@ cgMesh::cgMesh( cgUInt32 nReferenceId, cgWorld * pWorld ) : cgWorldResourceCompo
     mSystemVB                     = CG_NULL;
     mVertexFormat                 = CG_NULL;
     mSystemIB                     = CG_NULL;
+    mPickTree                     = CG_NULL;
     mSkinBindData                 = CG_NULL;
     mFinalizeMesh                 = true;
     mForceTangentGen              = false;
@@ -148,6 +391,7 @@ cgMesh::cgMesh( cgUInt32 nReferenceId, cgWorld * pWorld, cgMesh * pInit ) : cgWo
     mSystemVB             = CG_NULL;
     mSystemIB             = CG_NULL;
     mSkinBindData         = CG_NULL;
+    mPickTree             = CG_NULL;
 
     // Loading and serialization
     mSourceRefId          = 0;
@@ -335,6 +579,7 @@ cgMesh::cgMesh( cgUInt32 nReferenceId, cgWorld * pWorld, cgUInt32 nSourceRefId,
     mSystemVB                     = CG_NULL;
     mVertexFormat                 = CG_NULL;
     mSystemIB                     = CG_NULL;
+    mPickTree                     = CG_NULL;
     mSkinBindData                 = CG_NULL;
     mFinalizeMesh                 = bFinalizeMesh;
     mForceTangentGen              = false;
@@ -611,6 +856,7 @@ bool cgMesh::unloadResource( )
     if ( mSystemIB != CG_NULL )
         delete []mSystemIB;
     mTriangleData.clear();
+    releasePickTree();
 
     // Release resources
     mHardwareVB.close();
@@ -1986,6 +2232,7 @@ void cgMesh::prepareMesh( cgVertexFormat * pVertexFormat, bool bRollBackPrepare
         delete []mSystemVB;
         mSystemVB    = CG_NULL;
         mVertexCount = 0;
+        releasePickTree();
 
         // Iterate through each subset and extract triangle data.
         SubsetArray::iterator itSubset;
@@ -4330,6 +4577,9 @@ bool cgMesh::sortMeshData( bool bOptimize, bool bBuildHardwareBuffers )
     mMaterials.clear();
     mSubsetLookup.clear();
 
+    // Face order may change, so any existing pick tree is no longer valid.
+    releasePickTree();
+
     // Our first job is to collate all the various subsets and also
     // to determine how many triangles should exist in each.
     for ( i = 0; i < mFaceCount; ++i )
@@ -5293,65 +5543,128 @@ bool cgMesh::generateAdjacency( cgUInt32Array & adjacency )
 //-----------------------------------------------------------------------------
 //  Name : weldVertices ()
 /// <summary>
-/// Weld all of the vertices together that can be combined.
+/// Weld all of the vertices together that can be combined. Vertices are
+/// bucketed into a spatial hash grid whose cells match the weld tolerance
+/// such that only the vertices in neighboring cells need to be compared.
+/// Each vertex collapses to the lowest indexed vertex that matches it and
+/// that was itself kept, such that chains of nearby vertices can never pull
+/// together vertices that lie further apart than the tolerance. Cells are
+/// assigned from the vertex position or, if the format has none, from the
+/// first floating point or color element. Optionally, the matching pass can
+/// be split into the specified number of ranges and distributed over the job
+/// system (0 selects automatically based on the vertex count, 1 runs entirely
+/// on the calling thread). The result is identical irrespective of the number
+/// of threads used.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgMesh::weldVertices( cgUInt32Array * pVertexRemap /* = CG_NULL */ )
+bool cgMesh::weldVertices( cgUInt32Array * pVertexRemap /* = CG_NULL */, cgUInt32 nThreadCount /* = 0 */ )
 {
-    WeldKey Key;
-    std::map< WeldKey, cgUInt32 > VertexTree;
-    std::map< WeldKey, cgUInt32 >::const_iterator itKey;
-    cgByteArray NewVertexData, NewVertexFlags;
-    cgUInt32 nNewVertexCount = 0;
+    const cgUInt32 nVertexCount  = mPrepareData.vertexCount;
+    const cgUInt32 nVertexStride = mVertexFormat->getStride();
 
-    // Allocate enough space to build the remap array for the existing vertices
-    if ( pVertexRemap )
-        pVertexRemap->resize( mPrepareData.vertexCount );
-    cgUInt32 * pCollapseMap = new cgUInt32[ mPrepareData.vertexCount ];
+    // Nothing to do?
+    if ( nVertexCount < 2 )
+    {
+        if ( pVertexRemap )
+            pVertexRemap->clear();
+        return true;
+    
+    } // End if nothing to do
 
-    // Retrieve useful data offset information.
-    cgInt nVertexStride = (cgInt)mVertexFormat->getStride();
+    // Compute the grid cell in which each vertex resides.
+    MeshWeld::Grid Grid;
+    cgByte * pVertices   = &mPrepareData.vertexData[0];
+    Grid.vertices        = pVertices;
+    Grid.format          = mVertexFormat;
+    Grid.stride          = nVertexStride;
+    Grid.tolerance       = CGE_EPSILON_1MM;
+    Grid.cells           = new MeshWeld::Cell[ nVertexCount ];
+    Grid.next            = new cgUInt32[ nVertexCount ];
+    Grid.representatives = new cgUInt32[ nVertexCount ];
+    MeshWeld::selectKeyElement( Grid );
+    for ( cgUInt32 i = 0; i < nVertexCount; ++i )
+        MeshWeld::computeCell( Grid, pVertices + i * nVertexStride, Grid.cells[i] );
+
+    // Build the open addressed cell hash table (at least twice the vertex count
+    // to keep probe sequences short). Vertices are inserted in reverse order so
+    // that the chain for each cell is sorted by ascending vertex index.
+    cgUInt32 nTableSize = 1;
+    while ( nTableSize < nVertexCount * 2 )
+        nTableSize <<= 1;
+    Grid.tableMask = nTableSize - 1;
+    Grid.heads     = new cgUInt32[ nTableSize ];
+    memset( Grid.heads, 0xFF, nTableSize * sizeof(cgUInt32) );
+    for ( cgUInt32 i = nVertexCount; i-- > 0; )
+    {
+        const MeshWeld::Cell & Cell = Grid.cells[i];
+        cgUInt32 nSlot = MeshWeld::hashCell( Cell, Grid.tableMask );
+        for ( ; Grid.heads[nSlot] != MeshWeld::InvalidIndex; nSlot = (nSlot + 1) & Grid.tableMask )
+        {
+            const MeshWeld::Cell & Other = Grid.cells[Grid.heads[nSlot]];
+            if ( Other.x == Cell.x && Other.y == Cell.y && Other.z == Cell.z )
+                break;
+        
+        } // Next slot
+        Grid.next[i] = Grid.heads[nSlot];
+        Grid.heads[nSlot] = i;
 
-    // For each vertex to be welded.
-    for ( cgUInt32 i = 0; i < mPrepareData.vertexCount; ++i )
-    {
-        // Build a new key structure for inserting
-        Key.vertex  = (&mPrepareData.vertexData[0]) + (i * nVertexStride);
-        Key.format  = mVertexFormat;
-        Key.tolerance = CGE_EPSILON_1MM;
+    } // Next vertex
+
+    // Find the lowest indexed matching vertex for every vertex. Large meshes
+    // are split automatically over the job system; an explicit thread count 
+    // instead selects the number of equally sized ranges to distribute.
+    if ( nThreadCount == 0 && nVertexCount >= MeshWeld::ParallelThreshold )
+        cgJobSystem::parallelFor( nVertexCount, 0, MeshWeld::matchRange, &Grid );
+    else if ( nThreadCount > 1 )
+        cgJobSystem::parallelFor( nVertexCount, (nVertexCount + nThreadCount - 1) / nThreadCount, MeshWeld::matchRange, &Grid );
+    else
+        MeshWeld::matchVertices( Grid, 0, nVertexCount );
 
-        // Does a vertex with matching details already exist in the tree.
-        itKey = VertexTree.find( Key );
-        if ( itKey == VertexTree.end() )
+    // Resolve representatives and assign new indices in a single forward
+    // pass. Representatives always precede the vertices that collapse into
+    // them, so every lower indexed vertex has already been resolved. If the
+    // lowest match was itself collapsed, the vertex is matched again against
+    // kept vertices only (the lowest kept match can only be the same or later).
+    cgUInt32 nNewVertexCount = 0;
+    cgUInt32 * pCollapseMap = new cgUInt32[ nVertexCount ];
+    if ( pVertexRemap )
+        pVertexRemap->resize( nVertexCount );
+    for ( cgUInt32 i = 0; i < nVertexCount; ++i )
+    {
+        cgUInt32 nRepresentative = Grid.representatives[i];
+        if ( nRepresentative != i && Grid.representatives[nRepresentative] != nRepresentative )
+        {
+            nRepresentative = MeshWeld::matchVertex( Grid, i, true );
+            Grid.representatives[i] = nRepresentative;
+        
+        } // End if matched a collapsed vertex
+        if ( nRepresentative == i )
         {
-            // No matching vertex. Insert into the tree (value = NEW index of vertex).
-            VertexTree[Key] = nNewVertexCount;
             pCollapseMap[i] = nNewVertexCount;
             if ( pVertexRemap )
                 (*pVertexRemap)[i] = nNewVertexCount;
-            
-            // Store the vertex in the new buffer
-            NewVertexData.resize( (nNewVertexCount + 1) * nVertexStride );
-            memcpy( &NewVertexData[ nNewVertexCount * nVertexStride], Key.vertex, nVertexStride );
-            NewVertexFlags.push_back( mPrepareData.vertexFlags[i] );
             nNewVertexCount++;
-            
-        } // End if no matching vertex
+        
+        } // End if kept
         else
         {
-            // A vertex already existed at this location.
-            // Just mark the 'collapsed' index for this vertex in the remap array.
-            pCollapseMap[i] = itKey->second;
+            pCollapseMap[i] = pCollapseMap[nRepresentative];
             if ( pVertexRemap )
                 (*pVertexRemap)[i] = 0xFFFFFFFF;
+        
+        } // End if collapsed
 
-        } // End if vertex already existed
+    } // Next vertex
 
-    } // Next Vertex
+    // Clean up the grid.
+    delete []Grid.cells;
+    delete []Grid.heads;
+    delete []Grid.next;
 
     // If nothing was welded, just bail
-    if ( mPrepareData.vertexCount == nNewVertexCount )
+    if ( nVertexCount == nNewVertexCount )
     {
+        delete []Grid.representatives;
         delete []pCollapseMap;
         if ( pVertexRemap )
             pVertexRemap->clear();
@@ -5359,13 +5672,21 @@ bool cgMesh::weldVertices( cgUInt32Array * pVertexRemap /* = CG_NULL */ )
     
     } // End if nothing to do
 
-    // Otherwise, replace the old preparation vertices and remap
-    mPrepareData.vertexData.clear();
-    mPrepareData.vertexData.resize( NewVertexData.size() );
-    memcpy( &mPrepareData.vertexData[0], &NewVertexData[0], NewVertexData.size() );
-    mPrepareData.vertexFlags.clear();
-    mPrepareData.vertexFlags.resize( NewVertexFlags.size() );
-    memcpy( &mPrepareData.vertexFlags[0], &NewVertexFlags[0], NewVertexFlags.size() );
+    // Otherwise, compact the kept vertices in place. New indices are never
+    // greater than the original so data is only ever moved toward the front
+    // and the buffers are simply truncated afterwards.
+    for ( cgUInt32 i = 0; i < nVertexCount; ++i )
+    {
+        const cgUInt32 nNewIndex = pCollapseMap[i];
+        if ( Grid.representatives[i] != i || nNewIndex == i )
+            continue;
+        memcpy( pVertices + nNewIndex * nVertexStride, pVertices + i * nVertexStride, nVertexStride );
+        mPrepareData.vertexFlags[nNewIndex] = mPrepareData.vertexFlags[i];
+    
+    } // Next vertex
+    delete []Grid.representatives;
+    mPrepareData.vertexData.resize( nNewVertexCount * nVertexStride );
+    mPrepareData.vertexFlags.resize( nNewVertexCount );
     mPrepareData.vertexCount = nNewVertexCount;
     
     // Now remap all the triangle indices
@@ -6435,6 +6756,30 @@ bool cgMesh::pickFace( const cgVector3 & vOrigin, const cgVector3 & vDir, cgVect
     return true;
 }
 
+//-----------------------------------------------------------------------------
+// Name : pickPacket ( )
+/// <summary>
+/// Test a packet of up to 'cgTriangleBVH::MaxPacketSize' object space rays
+/// against the mesh data at once. Coherent rays (i.e. neighboring pixels or
+/// sampling kernels) share the majority of their hierarchy traversal making
+/// this cheaper than individual calls to pick(). Returns a bit mask in which
+/// each set bit indicates that the corresponding ray intersected the mesh.
+/// Distance and face outputs are only written for rays that hit.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgMesh::pickPacket( cgUInt32 nRayCount, const cgVector3 pOrigins[], const cgVector3 pDirections[], cgFloat pDistances[], cgUInt32 pFaces[] )
+{
+    // Mesh must be prepared for picking to be supported.
+    if ( mPrepareStatus != cgMeshStatus::Prepared )
+        return 0;
+
+    // Test the packet against the pick tree.
+    cgTriangleBVH * pTree = getPickTree();
+    if ( !pTree )
+        return 0;
+    return pTree->intersectPacket( nRayCount, pOrigins, pDirections, pDistances, pFaces );
+}
+
 //-----------------------------------------------------------------------------
 // Name : pickMeshSubset ( ) (Protected)
 /// <summary>
@@ -6463,76 +6808,24 @@ bool cgMesh::pickMeshSubset( cgUInt32 nDataGroupId, cgCameraNode * pCamera, cons
     // Wireframe or solid picking?
 	if ( !(nFlags & cgPickingFlags::Wireframe) )
     {
-        // Solid picking. Test for intersection against our internal mesh representation
+        // Solid picking. Test for intersection against the bounding volume
+        // hierarchy constructed over our internal mesh representation.
+        cgTriangleBVH * pTree = getPickTree();
+        if ( !pTree )
+            return false;
         if ( nDataGroupId == 0xFFFFFFFF )
         {
-            // Test every triangle for intersection.
-            cgUInt32 nFaceCount = getFaceCount();
-            for ( cgUInt32 nTestFace = 0; nTestFace < nFaceCount; ++nTestFace )
-            {
-                // Get vertex position data.
-                const cgVector3 & v1 = *(cgVector3*)(mSystemVB + (mSystemIB[ nTestFace * 3 ] * nVertexStride) + nPositionOffset);
-                const cgVector3 & v2 = *(cgVector3*)(mSystemVB + (mSystemIB[ (nTestFace * 3) + 1 ] * nVertexStride) + nPositionOffset);
-                const cgVector3 & v3 = *(cgVector3*)(mSystemVB + (mSystemIB[ (nTestFace * 3) + 2 ] * nVertexStride) + nPositionOffset);
-
-                // Ray intersects this triangle? (Skip if the triangle faces away from the ray direction.)
-                if ( cgCollision::rayIntersectTriangle( vOrigin, vDir, v1, v2, v3, t, CGE_EPSILON_1MM, false, false ) == true )
-                {
-                    // Closest hit so far?
-                    if ( t < fClosestDistance )
-                    {
-                        fClosestDistance = t;
-                        nClosestFace     = nTestFace;
-                        bHit             = true;
-                    
-                    } // End if closest
-
-                } // End if intersected
-
-            } // Next Face
-
-            // Find the material assigned to the closest intersected face.
-            if ( bHit == true )
-                hClosestMaterial = mTriangleData[nClosestFace].material;
+            // Test all triangles.
+            bHit = pTree->intersect( vOrigin, vDir, fClosestDistance, nClosestFace );
         
         } // End if no subset
         else
         {
-            // Get the list of all subsets associated with this data group
-            for ( size_t i = 0; i < mMeshSubsets.size(); ++i )
-            {
-                MeshSubset * pSubset = mMeshSubsets[i];
-                if ( pSubset->dataGroupId != nDataGroupId )
-                    continue;
-
-                // Test subset triangles for intersection.
-                cgUInt32 nFaceStart = pSubset->faceStart;
-                cgUInt32 nFaceEnd   = (pSubset->faceStart + pSubset->faceCount) - 1;
-                for ( cgUInt32 nTestFace = pSubset->faceStart; nTestFace <= nFaceEnd; ++nTestFace )
-                {
-                    // Get vertex position data.
-                    const cgVector3 & v1 = *(cgVector3*)(mSystemVB + (mSystemIB[ nTestFace * 3 ] * nVertexStride) + nPositionOffset);
-                    const cgVector3 & v2 = *(cgVector3*)(mSystemVB + (mSystemIB[ (nTestFace * 3) + 1 ] * nVertexStride) + nPositionOffset);
-                    const cgVector3 & v3 = *(cgVector3*)(mSystemVB + (mSystemIB[ (nTestFace * 3) + 2 ] * nVertexStride) + nPositionOffset);
-
-                    // Ray intersects this triangle? (Skip if the triangle faces away from the ray direction.)
-                    if ( cgCollision::rayIntersectTriangle( vOrigin, vDir, v1, v2, v3, t, CGE_EPSILON_1MM, false, false ) == true )
-                    {
-                        // Closest hit so far?
-                        if ( t < fClosestDistance )
-                        {
-                            fClosestDistance = t;
-                            nClosestFace     = nTestFace;
-                            hClosestMaterial = pSubset->material;
-                            bHit             = true;
-                        
-                        } // End if closest
-
-                    } // End if intersected
-
-                } // Next Face
-
-            } // Next Subset
+            // Test only those triangles that belong to the specified data group.
+            PickFilterData Filter;
+            Filter.triangleData = &mTriangleData;
+            Filter.dataGroupId  = nDataGroupId;
+            bHit = pTree->intersect( vOrigin, vDir, fClosestDistance, nClosestFace, pickDataGroupFilter, &Filter );
 
         } // End if subset test
             
@@ -6543,7 +6836,7 @@ bool cgMesh::pickMeshSubset( cgUInt32 nDataGroupId, cgCameraNode * pCamera, cons
         // Return relevant information.
         fDistance = fClosestDistance;
         nFace     = nClosestFace;
-        hMaterial = hClosestMaterial;
+        hMaterial = mTriangleData[nClosestFace].material;
 	    return true;
 
     } // End if solid picking
@@ -6771,6 +7064,65 @@ const cgMesh::MeshSubset * cgMesh::getSubset( const cgMaterialHandle & material,
     return itSubset->second;
 }
 
+//-----------------------------------------------------------------------------
+// Name : getPickTree ( ) (Protected)
+/// <summary>
+/// Retrieve the bounding volume hierarchy used to accelerate picking, 
+/// constructing it first if it does not yet exist (or has been invalidated
+/// by a modification to the mesh data).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTriangleBVH * cgMesh::getPickTree( )
+{
+    // Already constructed?
+    if ( mPickTree )
+        return mPickTree;
+
+    // Mesh must be prepared, and contain 3D position data.
+    if ( mPrepareStatus != cgMeshStatus::Prepared || !mSystemVB || !mSystemIB || !mVertexFormat )
+        return CG_NULL;
+    cgInt32 nPositionOffset = mVertexFormat->getElementOffset( D3DDECLUSAGE_POSITION );
+    if ( nPositionOffset < 0 )
+        return CG_NULL;
+
+    // Build the hierarchy using the same edge tolerance previously
+    // used when testing each triangle.
+    mPickTree = new cgTriangleBVH();
+    if ( !mPickTree->build( mSystemVB, mVertexFormat->getStride(), (cgUInt32)nPositionOffset, mSystemIB, getFaceCount(), CGE_EPSILON_1MM ) )
+    {
+        delete mPickTree;
+        mPickTree = CG_NULL;
+    
+    } // End if failed
+    return mPickTree;
+}
+
+//-----------------------------------------------------------------------------
+// Name : releasePickTree ( ) (Protected)
+/// <summary>
+/// Destroy the picking hierarchy. It will be reconstructed on demand the next
+/// time the mesh is picked.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgMesh::releasePickTree( )
+{
+    delete mPickTree;
+    mPickTree = CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : pickDataGroupFilter ( ) (Protected, Static)
+/// <summary>
+/// Face filter used by pickMeshSubset() in order to restrict the pick tree
+/// query to those triangles that belong to a single data group.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgMesh::pickDataGroupFilter( cgUInt32 nFace, void * pContext )
+{
+    const PickFilterData * pData = (const PickFilterData*)pContext;
+    return ((*pData->triangleData)[nFace].dataGroupId == pData->dataGroupId);
+}
+
 //-----------------------------------------------------------------------------
 //  Name : setDefaultColor ()
 /// <summary>
@@ -6972,6 +7324,9 @@ bool cgMesh::scaleMeshData( cgFloat fScale )
     // Scale the object space axis aligned bounding box accordingly.
     mBoundingBox *= fScale;
 
+    // Pick tree must be reconstructed to match.
+    releasePickTree();
+
     // Apply scale to skin binding pose matrices (translation)
     if ( mSkinBindData )
     {
@@ -7603,21 +7958,6 @@ bool operator < (const cgMesh::MeshSubsetKey& Key1, const cgMesh::MeshSubsetKey&
     return false;
 }
 
-//-----------------------------------------------------------------------------
-//  Name : operator < () (WeldKey&, WeldKey&)
-/// <summary>
-/// Perform less than comparison on the WeldKey structure.
-/// </summary>
-//-----------------------------------------------------------------------------
-bool operator < (const cgMesh::WeldKey& Key1, const cgMesh::WeldKey& Key2)
-{
-    int nDifference = cgVertexFormat::compareVertices( Key1.vertex, Key2.vertex, Key1.format, Key1.tolerance );
-    if ( nDifference != 0 ) return (nDifference < 0);
-
-    // Exactly equal
-    return false;
-}
-
 //-----------------------------------------------------------------------------
 //  Name : operator < () (BoneCombinationKey&, BoneCombinationKey&)
 /// <summary>
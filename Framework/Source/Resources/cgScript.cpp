@@ -29,6 +29,8 @@
 #include <Scripting/cgScriptEngine.h>
 #include <Scripting/cgScriptPreprocessor.h>
 #include <System/cgStringUtility.h>
+#include <Math/cgChecksum.h>
+#include <algorithm>
 
 // Angelscript.
 #include <angelscript.h>
@@ -38,6 +40,88 @@
 //-----------------------------------------------------------------------------
 using namespace cgScriptInterop::Exceptions;
 
+//-----------------------------------------------------------------------------
+// Module Local Classes
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Bytecode cache file header (CGEASC) and version (1.0.0).
+    const cgChar    ByteCodeCacheHeader[]   = { 'C', 'G', 'E', 'A', 'S', 'C' };
+    const cgUInt32  ByteCodeCacheVersion    = 0x01000000;
+
+    // Orders script definitions by name when hashing.
+    typedef std::pair<const std::string, std::string> DefinitionEntry;
+    bool definitionNameLess( const DefinitionEntry * a, const DefinitionEntry * b )
+    {
+        return a->first < b->first;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : ByteCodeReader (Class)
+    /// <summary>
+    /// Allows angelscript to read compiled bytecode from an open input stream.
+    /// Reads are restricted to the specified payload length; any attempt to
+    /// read beyond it (i.e. truncated file) zero fills the output and flags
+    /// the stream as failed.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    class ByteCodeReader : public asIBinaryStream
+    {
+    public:
+        ByteCodeReader( cgInputStream & stream, size_t length ) : 
+            mStream( stream ), mRemaining( length ), mFailed( false ) {}
+
+        void Read( void * ptr, asUINT size )
+        {
+            size_t amountRead = 0;
+            if ( !mFailed && size <= mRemaining )
+                amountRead = mStream.read( ptr, size );
+            if ( amountRead < size )
+            {
+                memset( (cgByte*)ptr + amountRead, 0, size - amountRead );
+                mFailed    = true;
+                mRemaining = 0;
+                return;
+            
+            } // End if short read
+            mRemaining -= size;
+        }
+        void Write( const void * ptr, asUINT size ) {}
+        bool isFailed( ) const { return mFailed; }
+
+    private:
+        cgInputStream & mStream;
+        size_t          mRemaining;
+        bool            mFailed;
+    };
+
+    //-------------------------------------------------------------------------
+    //  Name : ByteCodeWriter (Class)
+    /// <summary>
+    /// Allows angelscript to write compiled bytecode into a memory buffer.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    class ByteCodeWriter : public asIBinaryStream
+    {
+    public:
+        ByteCodeWriter( cgByteArray & data ) : mData( data ) {}
+
+        void Read( void * ptr, asUINT size ) {}
+        void Write( const void * ptr, asUINT size )
+        {
+            if ( !size )
+                return;
+            size_t offset = mData.size();
+            mData.resize( offset + size );
+            memcpy( &mData[offset], ptr, size );
+        }
+
+    private:
+        cgByteArray   & mData;
+    };
+
+} // End Unnamed Namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // cgScript Member Functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -234,9 +318,48 @@ bool cgScript::loadResource( )
     mFailedState = true;
     if ( Preprocessor.process( mInputStream, mDefinitions, mSourceFiles ) )
     {
+        // Compute the key that identifies the compiled form of this script
+        // and attempt to load matching bytecode from the on-disk cache.
+        cgUInt32 cacheKey[5];
+        cgString cacheFile;
+        bool     cacheLoaded = false;
+        if ( mScriptEngine->isByteCodeCacheEnabled() )
+        {
+            cgUInt32 sourceHash[5], variantHash[5];
+            Preprocessor.getSourceHash( sourceHash );
+            computeByteCodeVariant( variantHash );
+            computeByteCodeKey( sourceHash, variantHash, cacheKey );
+            cacheFile = getByteCodeCacheFile( variantHash );
+
+            bool moduleReplaced = false;
+            cacheLoaded = loadByteCodeCache( cacheFile, cacheKey, moduleReplaced );
+            if ( cacheLoaded )
+            {
+                // Bytecode was loaded into a new module.
+                pModule = pInternalEngine->GetModule( strModuleName, asGM_ONLY_IF_EXISTS );
+            
+            } // End if loaded
+            else if ( moduleReplaced )
+            {
+                // The cached bytecode was rejected after the pre-processed code
+                // had been discarded. Process the script again before building.
+                pModule = pInternalEngine->GetModule( strModuleName, asGM_ALWAYS_CREATE );
+                cgScriptPreprocessor Reprocessor( this );
+                if ( !Reprocessor.process( mInputStream, mDefinitions, mSourceFiles ) )
+                {
+                    cgAppLog::write( cgAppLog::Error, _T("An error occured while attempting to re-process script '%s'.\n"), getResourceName().c_str() );
+                    return false;
+                
+                } // End if failed
+            
+            } // End if replaced
+        
+        } // End if cache enabled
+
 	    // Attempt to build the script
-        cgAppLog::write( cgAppLog::Debug, _T("Building script '%s'.\n"), getResourceName().c_str() );
-        if ( pModule->Build() < 0 )
+        if ( !cacheLoaded )
+            cgAppLog::write( cgAppLog::Debug, _T("Building script '%s'.\n"), getResourceName().c_str() );
+        if ( !cacheLoaded && pModule->Build() < 0 )
         {
             cgAppLog::write( cgAppLog::Error, _T("An error occured while attempting to build script '%s'.\n"), getResourceName().c_str() );
             
@@ -256,6 +379,10 @@ bool cgScript::loadResource( )
         
         } // End if failed to build
 
+        // Store the newly compiled bytecode in the cache.
+        if ( !cacheLoaded && !cacheFile.empty() && writeByteCodeCache( cacheFile, cacheKey ) )
+            mScriptEngine->mByteCodeCacheStats.writes++;
+
         // Bind any imports.
         pModule->BindAllImportedFunctions();
 
@@ -285,6 +412,193 @@ bool cgScript::loadResource( )
     return false;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : computeByteCodeVariant () (Protected)
+/// <summary>
+/// Compute a hash of everything other than the script code itself that 
+/// affects its compiled form; any application defined macros, the "this" 
+/// type and the interface currently registered with the script engine.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScript::computeByteCodeVariant( cgUInt32 variantOut[] ) const
+{
+    STRING_CONVERT;
+    cgChecksum::SHA1 checksum;
+    checksum.beginMessage();
+
+    // Definitions are unordered, so sort by name first.
+    std::vector<const DefinitionEntry*> definitions;
+    definitions.reserve( mDefinitions.size() );
+    for ( DefinitionMap::const_iterator itDefinition = mDefinitions.begin(); itDefinition != mDefinitions.end(); ++itDefinition )
+        definitions.push_back( &(*itDefinition) );
+    std::sort( definitions.begin(), definitions.end(), definitionNameLess );
+    for ( size_t i = 0; i < definitions.size(); ++i )
+    {
+        const std::string & name  = definitions[i]->first;
+        const std::string & value = definitions[i]->second;
+        checksum.messageData( name.c_str(), name.size() + 1 );
+        checksum.messageData( value.c_str(), value.size() + 1 );
+    
+    } // Next definition
+
+    // "this" type.
+    const cgChar * thisType = stringConvertT2CA( mThisTypeName.c_str() );
+    checksum.messageData( thisType, strlen(thisType) + 1 );
+
+    // Registered interface.
+    cgUInt32 interfaceHash[5];
+    mScriptEngine->getInterfaceHash( interfaceHash );
+    checksum.messageData( interfaceHash, sizeof(interfaceHash) );
+    
+    checksum.endMessage();
+    checksum.getHash( variantOut );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeByteCodeKey () (Protected)
+/// <summary>
+/// Compute the key used to determine whether cached bytecode can be used in
+/// place of compiling this script. This combines the hash of the final 
+/// pre-processed script code with the variant hash computed by
+/// 'computeByteCodeVariant()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScript::computeByteCodeKey( const cgUInt32 sourceHash[], const cgUInt32 variantHash[], cgUInt32 keyOut[] ) const
+{
+    cgChecksum::SHA1 checksum;
+    checksum.beginMessage();
+    checksum.messageData( sourceHash, 5 * sizeof(cgUInt32) );
+    checksum.messageData( variantHash, 5 * sizeof(cgUInt32) );
+    checksum.endMessage();
+    checksum.getHash( keyOut );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getByteCodeCacheFile () (Protected)
+/// <summary>
+/// Retrieve the (resolved) name of the file in the on-disk bytecode cache
+/// used to store the compiled form of this script variant.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgString cgScript::getByteCodeCacheFile( const cgUInt32 variantHash[] ) const
+{
+    // Each variant of a script resource (see 'computeByteCodeVariant()') has 
+    // its own cache entry, named by a hash of the resource name and variant,
+    // so that loading the same script with different definitions, "this" type
+    // or interface does not evict the others. The entry is replaced whenever
+    // the script code changes and its key no longer matches.
+    const cgString & resourceName = getResourceName();
+    cgChecksum::SHA1 checksum;
+    checksum.beginMessage();
+    checksum.messageData( resourceName.c_str(), resourceName.size() * sizeof(cgTChar) );
+    checksum.messageData( variantHash, 5 * sizeof(cgUInt32) );
+    checksum.endMessage();
+    cgUInt32 entryHash[5];
+    checksum.getHash( entryHash );
+    cgString cacheFile = cgString::format( _T("sys://Cache/Scripts/%08x%08x%08x%08x%08x.asc"), entryHash[0], entryHash[1], entryHash[2], entryHash[3], entryHash[4] );
+    return cgFileSystem::resolveFileLocation( cacheFile );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : loadByteCodeCache () (Protected)
+/// <summary>
+/// Attempt to load this script's module from the on-disk bytecode cache. 
+/// Fails if no entry exists, or if the key stored in the entry does not match
+/// the key supplied. If the entry matched but could not be loaded, the 
+/// 'moduleReplaced' output is set to indicate that any code previously added
+/// to the module has been discarded.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScript::loadByteCodeCache( const cgString & cacheFile, const cgUInt32 key[], bool & moduleReplaced )
+{
+    STRING_CONVERT;
+    cgScriptEngine::ByteCodeCacheStats & stats = mScriptEngine->mByteCodeCacheStats;
+    moduleReplaced = false;
+
+    // Open the cache entry (if any).
+    cgInputStream stream( cacheFile );
+    if ( !cgFileSystem::fileExists( cacheFile ) || !stream.open() )
+    {
+        stats.misses++;
+        return false;
+    
+    } // End if no entry
+
+    // Validate the header, version and key.
+    cgChar   header[6];
+    cgUInt32 version = 0, storedKey[5], length = 0;
+    if ( stream.read( header, 6 ) != 6 || memcmp( header, ByteCodeCacheHeader, 6 ) != 0 ||
+         stream.read( &version, 4 ) != 4 || version != ByteCodeCacheVersion ||
+         stream.read( storedKey, 20 ) != 20 || memcmp( storedKey, key, 20 ) != 0 ||
+         stream.read( &length, 4 ) != 4 || !length )
+    {
+        stream.close();
+        stats.misses++;
+        return false;
+    
+    } // End if mismatch
+
+    // Load the bytecode into a new module (discards the pre-processed code).
+    const cgChar * moduleName = stringConvertT2CA( getResourceName().c_str() );
+    asIScriptModule * module = mScriptEngine->getInternalEngine()->GetModule( moduleName, asGM_ALWAYS_CREATE );
+    moduleReplaced = true;
+    ByteCodeReader reader( stream, length );
+    cgInt result = module->LoadByteCode( &reader );
+    stream.close();
+    if ( result < 0 || reader.isFailed() )
+    {
+        cgAppLog::write( cgAppLog::Warning, _T("Cached bytecode for script '%s' could not be loaded and will be discarded. The script will be rebuilt.\n"), getResourceName().c_str() );
+        stats.failures++;
+        return false;
+    
+    } // End if failed
+
+    // Success!
+    cgAppLog::write( cgAppLog::Debug, _T("Loaded script '%s' from bytecode cache.\n"), getResourceName().c_str() );
+    stats.hits++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : writeByteCodeCache () (Protected)
+/// <summary>
+/// Store the compiled bytecode for this script's module in the on-disk 
+/// bytecode cache, along with the key that describes it.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScript::writeByteCodeCache( const cgString & cacheFile, const cgUInt32 key[] )
+{
+    STRING_CONVERT;
+
+    // Serialize the module into memory first.
+    const cgChar * moduleName = stringConvertT2CA( getResourceName().c_str() );
+    asIScriptModule * module = mScriptEngine->getInternalEngine()->GetModule( moduleName, asGM_ONLY_IF_EXISTS );
+    cgByteArray byteCode;
+    ByteCodeWriter writer( byteCode );
+    if ( !module || module->SaveByteCode( &writer ) < 0 || byteCode.empty() )
+        return false;
+
+    // Make sure the cache directory exists.
+    cgString cacheDirectory = cgFileSystem::getDirectoryName( cacheFile );
+    if ( !cgFileSystem::directoryExists( cacheDirectory ) )
+        cgFileSystem::createDirectory( cacheDirectory );
+
+    // Write the entry.
+    std::ofstream stream;
+    stream.open( stringConvertT2CA(cacheFile.c_str()), std::ios::out | std::ios::trunc | std::ios::binary );
+    if ( !stream.good() )
+        return false;
+    cgUInt32 length = (cgUInt32)byteCode.size();
+    stream.write( ByteCodeCacheHeader, 6 );
+    stream.write( (const char*)&ByteCodeCacheVersion, 4 );
+    stream.write( (char*)key, 20 );
+    stream.write( (char*)&length, 4 );
+    stream.write( (char*)&byteCode[0], length );
+    bool success = stream.good();
+    stream.close();
+    return success;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : unloadResource ()
 /// <summary>
@@ -1572,14 +1886,8 @@ void cgScriptObject::buildMethodDeclaration( const cgString & strReturnType, con
 //-----------------------------------------------------------------------------
 asIScriptContext * cgScriptObject::scriptExecute( cgScriptFunctionHandle pMethodHandle, const cgScriptArgument::Array & Arguments )
 {
-    // Get an idle context for execution
-    cgScriptEngine   * pEngine = mScript->getScriptEngine();
-    asIScriptContext * pInternalContext = pEngine->getIdleExecuteContext();
-
-    // Prepare for execution
-    pInternalContext->SetUserData( mScript );
-    pInternalContext->Prepare( (asIScriptFunction*)pMethodHandle );
-    pInternalContext->SetObject( mObject );
+    // Get an idle context and prepare it for execution
+    asIScriptContext * pInternalContext = prepareMethod( pMethodHandle );
 
     // Build all arguments that are required
     cgInt nNumArgs = (cgInt)Arguments.size();
@@ -1629,28 +1937,65 @@ asIScriptContext * cgScriptObject::scriptExecute( cgScriptFunctionHandle pMethod
     } // Next Argument
     
     // Execute the function
-    cgInt nResult = pInternalContext->Execute();
+    executePrepared( pInternalContext );
+
+    // Return the context we used.
+    return pInternalContext;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : prepareMethod ()
+/// <summary>
+/// Prepare an execution context ready to call the specified method on this
+/// object. If no context is supplied, an idle context is retrieved from the
+/// script engine's pool. The caller can then set each argument directly via
+/// the context's 'SetArg*()' methods before calling 'executePrepared()'.
+/// Supplying the context used for a previous call allows it to be reused
+/// for a sequence of calls (preparing the same method again is cheap).
+/// </summary>
+//-----------------------------------------------------------------------------
+asIScriptContext * cgScriptObject::prepareMethod( cgScriptFunctionHandle pMethodHandle, asIScriptContext * pContext /* = CG_NULL */ )
+{
+    // Get an idle context for execution if none was supplied.
+    if ( !pContext )
+        pContext = mScript->getScriptEngine()->getIdleExecuteContext();
+
+    // Prepare for execution
+    pContext->SetUserData( mScript );
+    pContext->Prepare( (asIScriptFunction*)pMethodHandle );
+    pContext->SetObject( mObject );
+    return pContext;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : executePrepared ()
+/// <summary>
+/// Execute a method call previously set up with 'prepareMethod()'.
+/// Note : May throw a 'cgScriptInterop::Exceptions::ExecuteException' struct.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptObject::executePrepared( asIScriptContext * pContext )
+{
+    // Execute the function
+    cgInt nResult = pContext->Execute();
     
     // An error occured?
     if ( nResult == asEXECUTION_EXCEPTION )
     {
-        asIScriptFunction * pFunction = pInternalContext->GetExceptionFunction();
+        asIScriptFunction * pFunction = pContext->GetExceptionFunction();
         if ( !pFunction )
-            throw ExecuteException( pInternalContext->GetExceptionString(), mScript->getResourceName(), pInternalContext->GetExceptionLineNumber() );
+            throw ExecuteException( pContext->GetExceptionString(), mScript->getResourceName(), pContext->GetExceptionLineNumber() );
         else
         {
             STRING_CONVERT;
             const cgChar * sectionName = pFunction->GetScriptSectionName();
-            throw ExecuteException( pInternalContext->GetExceptionString(), (sectionName) ? stringConvertA2CT(sectionName) : _T("[System]"), pInternalContext->GetExceptionLineNumber() );
+            throw ExecuteException( pContext->GetExceptionString(), (sectionName) ? stringConvertA2CT(sectionName) : _T("[System]"), pContext->GetExceptionLineNumber() );
         
         } // End if has function
     
     } // End if exception
     else if ( nResult == asERROR )
         throw ExecuteException( "The script method failed to execute due to previous errors. Check method call declaration.", mScript->getResourceName(), 0 );
-
-    // Return the context we used.
-    return pInternalContext;
 }
 
 //-----------------------------------------------------------------------------
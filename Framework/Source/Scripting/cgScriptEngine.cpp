@@ -32,6 +32,7 @@
 #include <Resources/cgResourceManager.h>
 #include <Resources/cgScript.h>
 #include <System/cgStringUtility.h>
+#include <Math/cgChecksum.h>
 
 // Angelscript
 #include <angelscript.h>
@@ -42,6 +43,27 @@
 //-----------------------------------------------------------------------------
 cgScriptEngine * cgScriptEngine::mSingleton = CG_NULL;
 
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Add a (possibly NULL) string, including its terminator, to the checksum.
+    void hashString( cgChecksum::SHA1 & checksum, const cgChar * value )
+    {
+        if ( !value )
+            value = "";
+        checksum.messageData( value, strlen( value ) + 1 );
+    }
+
+    // Add a 32 bit value to the checksum.
+    void hashValue( cgChecksum::SHA1 & checksum, cgUInt32 value )
+    {
+        checksum.messageData( &value, sizeof(cgUInt32) );
+    }
+
+} // End Unnamed Namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // cgScriptEngine Member Functions
 ///////////////////////////////////////////////////////////////////////////////
@@ -58,6 +80,9 @@ cgScriptEngine::cgScriptEngine()
     mJITEngine      = CG_NULL;
     mVerboseOutput  = true;
     mOutputWarnings = true;
+    mInterfaceHashDirty     = true;
+    mByteCodeCacheEnabled   = true;
+    memset( mInterfaceHash, 0, sizeof(mInterfaceHash) );
 }
 
 //-----------------------------------------------------------------------------
@@ -227,6 +252,9 @@ bool cgScriptEngine::initialize( )
     // Set the compilation error message callback.
     mEngine->SetMessageCallback( asFUNCTION(cgScriptEngine::messageCallback), this, asCALL_CDECL );
 
+    // The registered interface is about to change.
+    mInterfaceHashDirty = true;
+
     // Allow unsafe references (disables the need for in/out/inout keywords)
     mEngine->SetEngineProperty(asEP_ALLOW_UNSAFE_REFERENCES, true );
 
@@ -299,6 +327,9 @@ bool cgScriptEngine::declarePackage( cgScriptPackage * pPackage, bool bDeclareCh
     //const cgChar * lpszConfigGroup = StringConvertT2CA( strNamespace.c_str() );
     //mEngine->BeginConfigGroup( lpszConfigGroup );
 
+    // The registered interface is about to change.
+    mInterfaceHashDirty = true;
+
     try
     {
         // Allow package to declare.
@@ -405,6 +436,9 @@ bool cgScriptEngine::bindPackage( const cgString & strPackageNamespace, bool bBi
     //const cgChar * lpszConfigGroup = StringConvertT2CA( strPackageNamespace.c_str() );
     //mEngine->BeginConfigGroup( lpszConfigGroup );
 
+    // The registered interface is about to change.
+    mInterfaceHashDirty = true;
+
     try
     {
         // Allow package to bind.
@@ -475,6 +509,180 @@ void cgScriptEngine::unbindPackage( PackageEntry * pEntry )
     pEntry->package = CG_NULL;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getInterfaceHash ()
+/// <summary>
+/// Retrieve a SHA1 hash that uniquely describes the application interface
+/// (object types, methods, properties, global functions, enumerations, etc.)
+/// currently registered with the script engine. Compiled bytecode is only
+/// valid for use with an interface that has a matching hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptEngine::getInterfaceHash( cgUInt32 hash[] )
+{
+    if ( mInterfaceHashDirty )
+        computeInterfaceHash();
+    memcpy( hash, mInterfaceHash, sizeof(mInterfaceHash) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeInterfaceHash () (Protected)
+/// <summary>
+/// Enumerate the interface currently registered with the internal engine and
+/// compute its hash (see 'getInterfaceHash()').
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptEngine::computeInterfaceHash( )
+{
+    cgChecksum::SHA1 checksum;
+    checksum.beginMessage();
+
+    // Include the script library version and target pointer size.
+    hashString( checksum, ANGELSCRIPT_VERSION_STRING );
+    hashValue( checksum, (cgUInt32)sizeof(void*) );
+    
+    if ( mEngine )
+    {
+        // Registered object types and their members.
+        const asUINT typeCount = mEngine->GetObjectTypeCount();
+        for ( asUINT i = 0; i < typeCount; ++i )
+        {
+            asIObjectType * type = mEngine->GetObjectTypeByIndex( i );
+            hashString( checksum, type->GetNamespace() );
+            hashString( checksum, type->GetName() );
+            hashValue( checksum, (cgUInt32)type->GetFlags() );
+            hashValue( checksum, (cgUInt32)type->GetSize() );
+            for ( asUINT j = 0; j < type->GetFactoryCount(); ++j )
+                hashString( checksum, type->GetFactoryByIndex( j )->GetDeclaration( true, true ) );
+            for ( asUINT j = 0; j < type->GetBehaviourCount(); ++j )
+            {
+                asEBehaviours behavior;
+                asIScriptFunction * function = type->GetBehaviourByIndex( j, &behavior );
+                hashValue( checksum, (cgUInt32)behavior );
+                hashString( checksum, function->GetDeclaration( true, true ) );
+            
+            } // Next behavior
+            for ( asUINT j = 0; j < type->GetMethodCount(); ++j )
+                hashString( checksum, type->GetMethodByIndex( j )->GetDeclaration( true, true ) );
+            for ( asUINT j = 0; j < type->GetPropertyCount(); ++j )
+            {
+                cgInt offset = 0;
+                type->GetProperty( j, CG_NULL, CG_NULL, CG_NULL, &offset );
+                hashString( checksum, type->GetPropertyDeclaration( j, true ) );
+                hashValue( checksum, (cgUInt32)offset );
+            
+            } // Next property
+        
+        } // Next type
+
+        // Global functions and function definitions.
+        const asUINT functionCount = mEngine->GetGlobalFunctionCount();
+        for ( asUINT i = 0; i < functionCount; ++i )
+            hashString( checksum, mEngine->GetGlobalFunctionByIndex( i )->GetDeclaration( true, true ) );
+        const asUINT funcdefCount = mEngine->GetFuncdefCount();
+        for ( asUINT i = 0; i < funcdefCount; ++i )
+            hashString( checksum, mEngine->GetFuncdefByIndex( i )->GetDeclaration( true, true ) );
+
+        // Global properties.
+        const asUINT propertyCount = mEngine->GetGlobalPropertyCount();
+        for ( asUINT i = 0; i < propertyCount; ++i )
+        {
+            const cgChar * name = CG_NULL, * nameSpace = CG_NULL;
+            cgInt typeId = 0;
+            bool isConst = false;
+            mEngine->GetGlobalPropertyByIndex( i, &name, &nameSpace, &typeId, &isConst );
+            hashString( checksum, nameSpace );
+            hashString( checksum, name );
+            hashString( checksum, mEngine->GetTypeDeclaration( typeId, true ) );
+            hashValue( checksum, isConst ? 1 : 0 );
+        
+        } // Next property
+
+        // Enumerations and their values.
+        const asUINT enumCount = mEngine->GetEnumCount();
+        for ( asUINT i = 0; i < enumCount; ++i )
+        {
+            const cgChar * nameSpace = CG_NULL;
+            cgInt typeId = 0;
+            hashString( checksum, mEngine->GetEnumByIndex( i, &typeId, &nameSpace ) );
+            hashString( checksum, nameSpace );
+            const cgInt valueCount = mEngine->GetEnumValueCount( typeId );
+            for ( cgInt j = 0; j < valueCount; ++j )
+            {
+                cgInt value = 0;
+                hashString( checksum, mEngine->GetEnumValueByIndex( typeId, (asUINT)j, &value ) );
+                hashValue( checksum, (cgUInt32)value );
+            
+            } // Next value
+        
+        } // Next enumeration
+
+        // Type definitions.
+        const asUINT typedefCount = mEngine->GetTypedefCount();
+        for ( asUINT i = 0; i < typedefCount; ++i )
+        {
+            const cgChar * nameSpace = CG_NULL;
+            cgInt typeId = 0;
+            hashString( checksum, mEngine->GetTypedefByIndex( i, &typeId, &nameSpace ) );
+            hashString( checksum, nameSpace );
+            hashString( checksum, mEngine->GetTypeDeclaration( typeId, true ) );
+        
+        } // Next typedef
+    
+    } // End if initialized
+
+    checksum.endMessage();
+    checksum.getHash( mInterfaceHash );
+    mInterfaceHashDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : enableByteCodeCache ()
+/// <summary>
+/// Enable / disable the loading and storing of compiled script bytecode in
+/// the on-disk cache (enabled by default).
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptEngine::enableByteCodeCache( bool enable )
+{
+    mByteCodeCacheEnabled = enable;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isByteCodeCacheEnabled ()
+/// <summary>
+/// Determine if compiled script bytecode will be loaded from / stored in the
+/// on-disk cache.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScriptEngine::isByteCodeCacheEnabled( ) const
+{
+    return mByteCodeCacheEnabled;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getByteCodeCacheStats ()
+/// <summary>
+/// Retrieve the statistics collected for the on-disk bytecode cache since the
+/// engine was created (or the statistics were last reset).
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgScriptEngine::ByteCodeCacheStats & cgScriptEngine::getByteCodeCacheStats( ) const
+{
+    return mByteCodeCacheStats;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : resetByteCodeCacheStats ()
+/// <summary>
+/// Reset the statistics collected for the on-disk bytecode cache.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptEngine::resetByteCodeCacheStats( )
+{
+    mByteCodeCacheStats = ByteCodeCacheStats();
+}
+
 //-----------------------------------------------------------------------------
 //  Name : isLibraryLinked ()
 /// <summary>
@@ -733,6 +941,7 @@ cgInt cgScriptEngine::setDefaultNamespace( const cgChar * lpszNamespaceNames )
 cgInt cgScriptEngine::registerObjectMethod( const cgChar * lpszObject, const cgChar * lpszDecl, const asSFuncPtr & FunctionPointer, cgUInt32 nCallingConvention )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterObjectMethod( lpszObject, lpszDecl, FunctionPointer, (asDWORD)nCallingConvention );
 }
 
@@ -745,6 +954,7 @@ cgInt cgScriptEngine::registerObjectMethod( const cgChar * lpszObject, const cgC
 cgInt cgScriptEngine::registerObjectProperty( const cgChar * lpszObject, const cgChar * lpszDecl, cgInt nByteOffset )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterObjectProperty( lpszObject, lpszDecl, nByteOffset );
 }
 
@@ -757,6 +967,7 @@ cgInt cgScriptEngine::registerObjectProperty( const cgChar * lpszObject, const c
 cgInt cgScriptEngine::registerObjectType( const cgChar * lpszObject, cgInt nByteSize, cgUInt32 nFlags )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterObjectType( lpszObject, nByteSize, (asDWORD)nFlags );
 }
 
@@ -769,6 +980,7 @@ cgInt cgScriptEngine::registerObjectType( const cgChar * lpszObject, cgInt nByte
 cgInt cgScriptEngine::registerObjectBehavior( const cgChar * lpszObject, asEBehaviours Behavior, const cgChar * lpszDecl, const asSFuncPtr & FunctionPointer, cgUInt32 nCallingConvention )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterObjectBehaviour( lpszObject, Behavior, lpszDecl, FunctionPointer, (asDWORD)nCallingConvention );
 }
 
@@ -781,6 +993,7 @@ cgInt cgScriptEngine::registerObjectBehavior( const cgChar * lpszObject, asEBeha
 cgInt cgScriptEngine::registerInterface( const cgChar * lpszName )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterInterface( lpszName );
 }
 
@@ -793,6 +1006,7 @@ cgInt cgScriptEngine::registerInterface( const cgChar * lpszName )
 cgInt cgScriptEngine::registerInterfaceMethod( const cgChar * lpszInterface, const cgChar * lpszDecl )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterInterfaceMethod( lpszInterface, lpszDecl );
 }
 
@@ -805,6 +1019,7 @@ cgInt cgScriptEngine::registerInterfaceMethod( const cgChar * lpszInterface, con
 cgInt cgScriptEngine::registerStringFactory( const cgChar * lpszDataType, const asSFuncPtr & FactoryFunctionPointer, cgUInt32 nCallingConvention )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterStringFactory( lpszDataType, FactoryFunctionPointer, (asDWORD)nCallingConvention  );
 }
 
@@ -817,6 +1032,7 @@ cgInt cgScriptEngine::registerStringFactory( const cgChar * lpszDataType, const
 cgInt cgScriptEngine::registerGlobalFunction( const cgChar * lpszDecl, const asSFuncPtr & FunctionPointer, cgUInt32 nCallingConvention )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterGlobalFunction( lpszDecl, FunctionPointer, (asDWORD)nCallingConvention  );
 }
 
@@ -829,6 +1045,7 @@ cgInt cgScriptEngine::registerGlobalFunction( const cgChar * lpszDecl, const asS
 cgInt cgScriptEngine::registerGlobalProperty( const cgChar * lpszDecl, void * value )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterGlobalProperty( lpszDecl, value  );
 }
 
@@ -841,6 +1058,7 @@ cgInt cgScriptEngine::registerGlobalProperty( const cgChar * lpszDecl, void * va
 cgInt cgScriptEngine::registerEnum( const cgChar * lpszName )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterEnum( lpszName );
 }
 
@@ -853,5 +1071,6 @@ cgInt cgScriptEngine::registerEnum( const cgChar * lpszName )
 cgInt cgScriptEngine::registerEnumValue( const cgChar * lpszDataType, const cgChar * lpszValueName, cgInt nValue )
 {
     cgAssertEx( mEngine != CG_NULL, "Ensure that the scripting engine has been initialized before beginning binding types." );
+    mInterfaceHashDirty = true;
     return mEngine->RegisterEnumValue( lpszDataType, lpszValueName, nValue );
 }
\ No newline at end of file
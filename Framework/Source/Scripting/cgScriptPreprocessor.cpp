@@ -64,6 +64,7 @@ cgScriptPreprocessor::cgScriptPreprocessor( cgScript * pScript )
     // Initialize variables to sensible defaults
     mScript       = pScript;
     mShaderScript = pScript->queryReferenceType( RTID_SurfaceShaderScriptResource );
+    memset( mSourceHash, 0, sizeof(mSourceHash) );
 }
 
 //-----------------------------------------------------------------------------
@@ -137,6 +138,7 @@ bool cgScriptPreprocessor::process( cgInputStream Stream, const DefinitionMap &
     // Load the top level script.
     aSourceFiles.clear();
     mDefinitions = Defines;
+    mSourceChecksum.beginMessage();
     if ( !loadScriptSection( pModule, Stream, aSourceFiles, false ) )
     {
         if ( mEngine->Release() == 0 )
@@ -154,7 +156,7 @@ bool cgScriptPreprocessor::process( cgInputStream Stream, const DefinitionMap &
     {
         std::string strThisType = stringConvertT2CA( mScript->getThisType().c_str() );
         std::string strThisCode = strThisType + "@ this; void __GlobalSetThis(" + strThisType + "@ o){ @this = o; }";
-        pModule->AddScriptSection( "__ThisAccessor", strThisCode.c_str(), strThisCode.size(), 0 );
+        addScriptSection( pModule, "__ThisAccessor", strThisCode, 0 );
     
     } // End if requested "this"
 
@@ -169,7 +171,7 @@ bool cgScriptPreprocessor::process( cgInputStream Stream, const DefinitionMap &
             std::string strShaderGlobals = "String __shx, __shi, __sho, __shg, __cbr, __sbr;SystemExports @ System;\n";
             strShaderGlobals.append( "String __shsyscmnvs(){ return System.SystemCommon(0);}\n" );
             strShaderGlobals.append( "String __shsyscmnps(){ return System.SystemCommon(1);}\n" );
-            pModule->AddScriptSection( "__ShaderScriptGlobals", strShaderGlobals.c_str(), strShaderGlobals.size(), 0 );
+            addScriptSection( pModule, "__ShaderScriptGlobals", strShaderGlobals, 0 );
             if ( !loadScriptSection( pModule, SysDefStream, aSourceFiles, false ) )
             {
                 if ( mEngine->Release() == 0 )
@@ -186,10 +188,42 @@ bool cgScriptPreprocessor::process( cgInputStream Stream, const DefinitionMap &
     if ( mEngine->Release() == 0 )
         mEngine = CG_NULL;
 
+    // Record the final hash of the code that was generated.
+    mSourceChecksum.endMessage();
+    mSourceChecksum.getHash( mSourceHash );
+
     // Success!
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getSourceHash()
+/// <summary>
+/// Retrieve the SHA1 hash of the final processed code (including section 
+/// names) that was added to the script module by the most recent successful
+/// call to 'process()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScriptPreprocessor::getSourceHash( cgUInt32 hash[] ) const
+{
+    memcpy( hash, mSourceHash, sizeof(mSourceHash) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : addScriptSection () (Protected)
+/// <summary>
+/// Add the specified processed code to the module, and include it in the 
+/// running checksum of the generated code.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScriptPreprocessor::addScriptSection( asIScriptModule * pModule, const cgChar * strSectionName, const std::string & strCode, cgInt nLineOffset /* = 0 */ )
+{
+    mSourceChecksum.messageData( strSectionName, strlen( strSectionName ) + 1 );
+    if ( !strCode.empty() )
+        mSourceChecksum.messageData( strCode.c_str(), strCode.size() );
+    return ( pModule->AddScriptSection( strSectionName, strCode.c_str(), strCode.size(), nLineOffset ) >= 0 );
+}
+
 //-----------------------------------------------------------------------------
 //  Name : loadScriptSection () (Protected)
 /// <summary>
@@ -1789,7 +1823,7 @@ bool cgScriptPreprocessor::processScriptSection( asIScriptModule * pModule, cons
 
     // Add the current code to the module.
     mEngine->SetEngineProperty( asEP_COPY_SCRIPT_SECTIONS, true );
-    if ( pModule->AddScriptSection( stringConvertT2CA(strSectionName.c_str()), strScript.c_str(), strScript.size() ) < 0 )
+    if ( !addScriptSection( pModule, stringConvertT2CA(strSectionName.c_str()), strScript ) )
     {
         cgAppLog::write( cgAppLog::Error, _T("An error occured while attempting to add code to script '%s'.\n"), mScript->getResourceName().c_str() );
         return false;
@@ -0,0 +1,476 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgStdThreading.cpp                                                 //
+//                                                                           //
+// Desc : Portable implementation of the core system threading types         //
+//        (thread, critical section, etc.) built on top of the C++11         //
+//        standard library.                                                  //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgStdThreading Module Includes
+//-----------------------------------------------------------------------------
+#include <System/Platform/cgStdThreading.h>
+
+#if defined(CGE_STD_THREADING)
+
+#include <chrono>
+
+///////////////////////////////////////////////////////////////////////////////
+// cgStdCriticalSection Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgStdCriticalSection () (Constructor)
+/// <summary>
+/// cgStdCriticalSection Class Constructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdCriticalSection::cgStdCriticalSection()
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgStdCriticalSection () (Destructor)
+/// <summary>
+/// cgStdCriticalSection Class Destructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdCriticalSection::~cgStdCriticalSection()
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : enter () (Virtual)
+/// <summary>
+/// Enter / lock the critical section in order to protect a certain
+/// block of code / data.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdCriticalSection::enter( )
+{
+    mSection.lock();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : tryEnter () (Virtual)
+/// <summary>
+/// Attempt to enter / lock the critical section in order to protect a certain
+/// block of code / data without blocking. If the section is already locked,
+/// this method returns immediately.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdCriticalSection::tryEnter( )
+{
+    return mSection.try_lock();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : exit () (Virtual)
+/// <summary>
+/// Exit / unlock the critical section in order to release a certain
+/// block of code / data.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdCriticalSection::exit( )
+{
+    mSection.unlock();
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgStdThread Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgStdThread () (Constructor)
+/// <summary>
+/// cgStdThread Class Constructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdThread::cgStdThread() :
+    mFinished( false ), mExitRequested( false ), mSuspended( false )
+{
+    // Initialize variables to sensible defaults.
+    mThread         = CG_NULL;
+    mThreadFunction = CG_NULL;
+    mThreadContext  = CG_NULL;
+    mPriority       = cgThreadPriority::Normal;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgStdThread () (Destructor)
+/// <summary>
+/// cgStdThread Class Destructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdThread::~cgStdThread()
+{
+    // Terminate any running thread and wait for it to stop.
+    terminate();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setPriority () (Virtual)
+/// <summary>
+/// Alter the priority of the running thread, or a thread due to be started.
+/// The standard library provides no portable means to alter thread priority
+/// so the value is simply recorded.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::setPriority( cgThreadPriority::Base priority )
+{
+    mPriority = priority;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setThreadData () (Virtual)
+/// <summary>
+/// Set the thread function and context to use when the thread is 
+/// next started.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::setThreadData( cgThreadFunc function, void * context )
+{
+    mThreadFunction = function;
+    mThreadContext  = context;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getThreadState () (Virtual)
+/// <summary>
+/// Retrieve the current state of this thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgThread::ThreadState cgStdThread::getThreadState( ) const
+{
+    // Not started yet?
+    if ( mThread == CG_NULL )
+        return Stopped;
+
+    // Thread is active?
+    if ( mFinished )
+        return Finished;
+    return ( mSuspended ) ? Suspended : Running;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : start () (Virtual)
+/// <summary>
+/// Start a new thread and execute the specified function asynchronously.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdThread::start( cgThreadFunc function, void * context )
+{
+    // Stop any currently executing thread.
+    terminate();
+
+    // Store callback and context for execution.
+    mThreadFunction = function;
+    mThreadContext  = context;
+
+    // Start new thread
+    return start( );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : start () (Virtual)
+/// <summary>
+/// Start a new thread and execute the supplied function asynchronously.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdThread::start( )
+{
+    // Stop any currently executing thread.
+    terminate();
+
+    // Reset state.
+    mFinished      = false;
+    mExitRequested = false;
+    mSuspended     = false;
+
+    // Create a new thread.
+    try
+    {
+        mThread = new std::thread( threadStub, this );
+    
+    } // End try
+
+    catch ( ... )
+    {
+        mThread = CG_NULL;
+        return false;
+    
+    } // End catch
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : suspend () (Virtual)
+/// <summary>
+/// Signal the thread that it should suspend its operations.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::suspend( )
+{
+    std::lock_guard<std::mutex> lock( mStateMutex );
+    mSuspended = true;
+    mStateCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Name : resume() (Virtual)
+/// <summary>Resume execution of the thread.</summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::resume( )
+{
+    std::lock_guard<std::mutex> lock( mStateMutex );
+    mSuspended = false;
+    mStateCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Name : join()
+/// <summary>Wait for execution of the thread to complete.</summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::join( )
+{
+    if ( mThread != CG_NULL && mThread->joinable() )
+        mThread->join();
+}
+
+//-----------------------------------------------------------------------------
+// Name : suspendedWait() (Virtual)
+/// <summary>
+/// Call this method within the code being executed by the thread in order to 
+/// wait if the thread is suspended.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdThread::suspendedWait( )
+{
+    if ( !mSuspended )
+        return false;
+
+    // Burn time until we are resumed or asked to exit.
+    std::unique_lock<std::mutex> lock( mStateMutex );
+    while ( mSuspended && !mExitRequested )
+        mStateCondition.wait( lock );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : threadStub () (Private Static)
+/// <summary>
+/// Thread entry point providing a wrapper around the user supplied callback
+/// data.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::threadStub( cgStdThread * thread )
+{
+    // Call the user suppliead thread callback function.
+    cgThreadFunc function = thread->mThreadFunction;
+    if ( function != CG_NULL )
+        function( thread, thread->mThreadContext );
+    thread->mFinished = true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : terminate () (Virtual)
+/// <summary>
+/// Stop any currently executing thread and block until it exits.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::terminate( )
+{
+    if ( mThread != CG_NULL )
+    {
+        // Issue quit message and wait for thread to exit.
+        signalTerminate();
+        join( );
+        delete mThread;
+    
+    } // End if started
+
+    // Clean up
+    mThread = CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : sleep () (Virtual)
+/// <summary>
+/// Sleep the calling thread for the specified number of milliseconds.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::sleep( cgUInt32 milliseconds )
+{
+    std::this_thread::sleep_for( std::chrono::milliseconds( milliseconds ) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : signalTerminate () (Virtual)
+/// <summary>
+/// Simply sends the signal for the thread to exit but does not wait for it
+/// to do so.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdThread::signalTerminate( )
+{
+    // Issue quit message if thread is running.
+    if ( mThread != CG_NULL )
+    {
+        std::lock_guard<std::mutex> lock( mStateMutex );
+        mExitRequested = true;
+        mStateCondition.notify_all();
+    
+    } // End if running
+}
+
+//-----------------------------------------------------------------------------
+//  Name : terminateRequested () (Virtual)
+/// <summary>
+/// Determine if someone has requested that the thread be shut down.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdThread::terminateRequested( ) const
+{
+    // Always assume we are waiting for an exit if the thread is dead.
+    if ( mThread == CG_NULL )
+        return true;
+    return mExitRequested;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgStdEvent Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgStdEvent () (Constructor)
+/// <summary>
+/// cgStdEvent Class Constructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdEvent::cgStdEvent( )
+{
+    // Initialize variables to sensible defaults.
+    mSignaled  = false;
+    mAutoReset = true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : cgStdEvent () (Constructor)
+/// <summary>
+/// cgStdEvent Class Constructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdEvent::cgStdEvent( bool autoReset )
+{
+    // Initialize variables to sensible defaults.
+    mSignaled  = false;
+    mAutoReset = autoReset;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgStdEvent () (Destructor)
+/// <summary>
+/// cgStdEvent Class Destructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgStdEvent::~cgStdEvent()
+{
+}
+
+//-----------------------------------------------------------------------------
+//  Name : hasSignaled () (Virtual)
+/// <summary>
+/// Determine if the event is currently in a signaled state. As with a zero 
+/// timeout wait on a native event, an auto-reset event is reset by this call
+/// if it was signaled.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdEvent::hasSignaled( )
+{
+    return wait( 0 );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : wait () (Virtual)
+/// <summary>
+/// Block the calling thread until the event is signaled or the specified
+/// number of milliseconds elapses. Returns true if the event was signaled.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgStdEvent::wait( cgUInt32 milliseconds )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    if ( !mSignaled && milliseconds > 0 )
+    {
+        if ( milliseconds == 0xFFFFFFFF )
+        {
+            while ( !mSignaled )
+                mCondition.wait( lock );
+        
+        } // End if infinite
+        else
+        {
+            std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds( milliseconds );
+            while ( !mSignaled )
+            {
+                if ( mCondition.wait_until( lock, until ) == std::cv_status::timeout )
+                    break;
+            
+            } // Next wake
+        
+        } // End if timed
+
+    } // End if wait
+
+    // Signaled?
+    const bool signaled = mSignaled;
+    if ( signaled && mAutoReset )
+        mSignaled = false;
+    return signaled;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : signal () (Virtual)
+/// <summary>
+/// Set / signal the event.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdEvent::signal( )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mSignaled = true;
+    if ( mAutoReset )
+        mCondition.notify_one();
+    else
+        mCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : reset () (Virtual)
+/// <summary>
+/// Reset the event / signal.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgStdEvent::reset( )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mSignaled = false;
+}
+
+#endif // CGE_STD_THREADING
@@ -469,6 +469,19 @@ bool cgWinEvent::hasSignaled( )
     return ( nResult == WAIT_OBJECT_0 );
 }
 
+//-----------------------------------------------------------------------------
+//  Name : wait () (Virtual)
+/// <summary>
+/// Block the calling thread until the event is signaled or the specified
+/// number of milliseconds elapses. Returns true if the event was signaled.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgWinEvent::wait( cgUInt32 nMilliseconds )
+{
+    cgUInt32 nResult = ::WaitForSingleObject( mEvent, nMilliseconds );
+    return ( nResult == WAIT_OBJECT_0 );
+}
+
 //-----------------------------------------------------------------------------
 //  Name : signal () (Virtual)
 /// <summary>
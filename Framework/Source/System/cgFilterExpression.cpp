@@ -27,6 +27,122 @@
 // cgFilterExpression Module Includes
 //-----------------------------------------------------------------------------
 #include <System/cgFilterExpression.h>
+#if defined(CGE_MATH_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace FilterExpression
+{
+    //-------------------------------------------------------------------------
+    // Name : isSingleBit()
+    // Desc : Determine if exactly one bit is set in the specified value.
+    //-------------------------------------------------------------------------
+    inline bool isSingleBit( cgUInt64 bits )
+    {
+        return ( bits != 0 && (bits & (bits - 1)) == 0 );
+    }
+
+#if defined(CGE_MATH_SIMD_SSE2)
+    //-------------------------------------------------------------------------
+    // Name : broadcast()
+    // Desc : Replicate a 64 bit value into both lanes of an SSE2 register.
+    //-------------------------------------------------------------------------
+    inline __m128i broadcast( cgUInt64 value )
+    {
+        const int lo = (int)(value & 0xFFFFFFFF), hi = (int)(value >> 32);
+        return _mm_set_epi32( hi, lo, hi, lo );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : zeroLanes()
+    // Desc : Returns a two bit mask, with each bit set if the corresponding
+    //        64 bit lane of the supplied register is zero.
+    //-------------------------------------------------------------------------
+    inline cgUInt32 zeroLanes( __m128i x )
+    {
+        __m128i e = _mm_cmpeq_epi32( x, _mm_setzero_si128() );
+        e = _mm_and_si128( e, _mm_shuffle_epi32( e, _MM_SHUFFLE(2,3,0,1) ) );
+        return (cgUInt32)_mm_movemask_pd( _mm_castsi128_pd( e ) );
+    }
+#endif // CGE_MATH_SIMD_SSE2
+
+    //-------------------------------------------------------------------------
+    // Name : allSetMask()
+    // Desc : Build a mask with one bit per value, set if all of the specified
+    //        bits are set in that value (at most 64 values).
+    //-------------------------------------------------------------------------
+    inline cgUInt64 allSetMask( const cgUInt64 * values, size_t count, cgUInt64 bits )
+    {
+        cgUInt64 mask = 0;
+        size_t i = 0;
+#if defined(CGE_MATH_SIMD_SSE2)
+        const __m128i b = broadcast( bits );
+        for ( ; i + 2 <= count; i += 2 )
+        {
+            const __m128i v = _mm_loadu_si128( (const __m128i*)(values + i) );
+            mask |= (cgUInt64)zeroLanes( _mm_andnot_si128( v, b ) ) << i;
+        
+        } // Next pair
+#endif // CGE_MATH_SIMD_SSE2
+        for ( ; i < count; ++i )
+            mask |= (cgUInt64)((values[i] & bits) == bits) << i;
+        return mask;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : anySetMask()
+    // Desc : Build a mask with one bit per value, set if any of the specified
+    //        bits are set in that value (at most 64 values).
+    //-------------------------------------------------------------------------
+    inline cgUInt64 anySetMask( const cgUInt64 * values, size_t count, cgUInt64 bits )
+    {
+        cgUInt64 mask = 0;
+        size_t i = 0;
+#if defined(CGE_MATH_SIMD_SSE2)
+        const __m128i b = broadcast( bits );
+        for ( ; i + 2 <= count; i += 2 )
+        {
+            const __m128i v = _mm_loadu_si128( (const __m128i*)(values + i) );
+            mask |= (cgUInt64)(~zeroLanes( _mm_and_si128( v, b ) ) & 3) << i;
+        
+        } // Next pair
+#endif // CGE_MATH_SIMD_SSE2
+        for ( ; i < count; ++i )
+            mask |= (cgUInt64)((values[i] & bits) != 0) << i;
+        return mask;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : evaluateClosedForm()
+    // Desc : Evaluate a closed form expression for an array of values. A 
+    //        value matches either when any selected bit matches (anyMatch), 
+    //        or when no selected bit fails to match.
+    //-------------------------------------------------------------------------
+    inline void evaluateClosedForm( const cgUInt64 * values, size_t count, bool * results, cgUInt64 setMask, cgUInt64 clearMask, bool anyMatch )
+    {
+        size_t i = 0;
+#if defined(CGE_MATH_SIMD_SSE2)
+        const __m128i s = broadcast( setMask ), c = broadcast( clearMask );
+        const cgUInt32 invert = (anyMatch) ? 3 : 0;
+        for ( ; i + 2 <= count; i += 2 )
+        {
+            const __m128i v = _mm_loadu_si128( (const __m128i*)(values + i) );
+            const cgUInt32 pass = zeroLanes( _mm_or_si128( _mm_and_si128( v, s ), _mm_andnot_si128( v, c ) ) ) ^ invert;
+            results[i]   = (pass & 1) != 0;
+            results[i+1] = (pass & 2) != 0;
+        
+        } // Next pair
+#endif // CGE_MATH_SIMD_SSE2
+        for ( ; i < count; ++i )
+            results[i] = (((values[i] & setMask) | (~values[i] & clearMask)) != 0) == anyMatch;
+    }
+
+}; // End Namespace : FilterExpression
 
 //-----------------------------------------------------------------------------
 //  Name : cgFilterExpression () (Constructor)
@@ -36,6 +152,11 @@
 //-----------------------------------------------------------------------------
 cgFilterExpression::cgFilterExpression()
 {
+    // Initialize variables to sensible defaults
+    mClosedForm      = false;
+    mClosedFormAny   = false;
+    mClosedSetMask   = 0;
+    mClosedClearMask = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -46,7 +167,11 @@ cgFilterExpression::cgFilterExpression()
 //-----------------------------------------------------------------------------
 cgFilterExpression::cgFilterExpression( const cgFilterExpression * pInit )
 {
-    mInstructions = pInit->mInstructions;
+    mInstructions    = pInit->mInstructions;
+    mClosedForm      = pInit->mClosedForm;
+    mClosedFormAny   = pInit->mClosedFormAny;
+    mClosedSetMask   = pInit->mClosedSetMask;
+    mClosedClearMask = pInit->mClosedClearMask;
 }
 
 //-----------------------------------------------------------------------------
@@ -94,6 +219,7 @@ void cgFilterExpression::dispose( bool bDisposeBase )
 {
     // Clear out compiled instructions.
     mInstructions.clear();
+    mClosedForm = false;
 
     // Dispose of base class
     if ( bDisposeBase == true )
@@ -130,10 +256,15 @@ bool cgFilterExpression::compileExpression( const cgString & strExpression )
          !compileExpression( mInstructions, aTokens, true ) )
     {
         cgAppLog::write( cgAppLog::Error, _T("Failed to compile filter expression '%s'. See previous errors for more information.\n"), strExpression.c_str() );
+        mInstructions.clear();
+        buildClosedForm();
         return false;
     
     } // End if failed
 
+    // Reduce to a simple mask test where possible.
+    buildClosedForm();
+
     // Success!
     return true;
 }
@@ -164,10 +295,15 @@ bool cgFilterExpression::compileExpression( const cgString & strExpression, cons
          !compileExpression( mInstructions, aTokens, true ) )
     {
         cgAppLog::write( cgAppLog::Error, _T("Failed to compile filter expression '%s'. See previous errors for more information.\n"), strExpression.c_str() );
+        mInstructions.clear();
+        buildClosedForm();
         return false;
     
     } // End if failed
 
+    // Reduce to a simple mask test where possible.
+    buildClosedForm();
+
     // Success!
     return true;
 }
@@ -176,20 +312,25 @@ bool cgFilterExpression::compileExpression( const cgString & strExpression, cons
 //  Name : evaluate () 
 /// <summary>
 /// Execute the compiled expression in order to evaluate the bits of the 
-/// specified value.
+/// specified value. This method is re-entrant, and may be called from 
+/// multiple threads simultaneously.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgFilterExpression::evaluate( cgUInt64 Value )
+bool cgFilterExpression::evaluate( cgUInt64 Value ) const
 {
-    static int Result;
-    static int TempRegisters[256];
-    static const FilterInstruction * pc, * pce;
-    static int * r;   
-
     // Automatically matches if there is nothing to compare.
     if ( mInstructions.empty() )
         return true;
 
+    // Simple mask expressions need not execute the instructions.
+    if ( mClosedForm )
+        return ((((Value & mClosedSetMask) | (~Value & mClosedClearMask)) != 0) == mClosedFormAny);
+
+    int Result = 0;
+    int TempRegisters[MaxStackDepth];
+    const FilterInstruction * pc, * pce;
+    int * r;
+
     // Initialize first result register.
     TempRegisters[0] = 1;
 
@@ -323,6 +464,139 @@ bool cgFilterExpression::evaluate( cgUInt64 Value )
     return (*r != 0);
 }
 
+//-----------------------------------------------------------------------------
+//  Name : evaluate () 
+/// <summary>
+/// Execute the compiled expression in order to evaluate the bits of each of
+/// the specified values, writing the result for each value into the
+/// corresponding entry of the 'results' array. This method is re-entrant, 
+/// and may be called from multiple threads simultaneously.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgFilterExpression::evaluate( const cgUInt64 * Values, size_t nCount, bool * pResults ) const
+{
+    // Automatically matches if there is nothing to compare.
+    if ( mInstructions.empty() )
+    {
+        for ( size_t i = 0; i < nCount; ++i )
+            pResults[i] = true;
+        return;
+    
+    } // End if no instructions
+
+    // Simple mask expressions need not execute the instructions.
+    if ( mClosedForm )
+    {
+        FilterExpression::evaluateClosedForm( Values, nCount, pResults, mClosedSetMask, mClosedClearMask, mClosedFormAny );
+        return;
+    
+    } // End if closed form
+
+    // Execute the instructions for blocks of values at a time.
+    for ( size_t i = 0; i < nCount; i += BatchSize )
+    {
+        const size_t nBlockSize = ( nCount - i < BatchSize ) ? nCount - i : BatchSize;
+        const cgUInt64 Block = evaluateBlock( Values + i, nBlockSize );
+        for ( size_t j = 0; j < nBlockSize; ++j )
+            pResults[i + j] = ((Block >> j) & 1) != 0;
+    
+    } // Next block
+}
+
+//-----------------------------------------------------------------------------
+//  Name : evaluateBlock () (Protected)
+/// <summary>
+/// Execute the compiled expression for up to 'BatchSize' values at once. 
+/// Each register holds one result bit per value, so every instruction is 
+/// applied to the entire block, and early outs are taken only when the
+/// current result is zero for all values. Returns a mask containing the final
+/// result for each value.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt64 cgFilterExpression::evaluateBlock( const cgUInt64 * Values, size_t nCount ) const
+{
+    using namespace FilterExpression;
+    const cgUInt64 LaneMask = ( nCount >= 64 ) ? ~(cgUInt64)0 : (((cgUInt64)1 << nCount) - 1);
+    cgUInt64 Result = 0;
+    cgUInt64 TempRegisters[MaxStackDepth];
+
+    // Initialize first result register.
+    TempRegisters[0] = LaneMask;
+
+    // Process instructions.
+    cgUInt64 * r = TempRegisters;
+    const FilterInstruction * pc = &mInstructions.front();
+    const FilterInstruction * pce = pc + mInstructions.size();
+    while ( pc != pce )
+    {
+        switch ( pc->opCode )
+        {
+            case OpSet:
+            case OpSetJz:
+                *r = allSetMask( Values, nCount, pc->bits );
+                break;
+            case OpRSet:
+            case OpRSetJz:
+                *r = Result;
+                break;
+            case OpNSet:
+            case OpNSetJz:
+                *r = ~allSetMask( Values, nCount, pc->bits );
+                break;
+            case OpRNSet:
+            case OpRNSetJz:
+                *r = ~Result;
+                break;
+            case OpAnd:
+            case OpAndJz:
+                *r &= allSetMask( Values, nCount, pc->bits );
+                break;
+            case OpRAnd:
+            case OpRAndJz:
+                *r &= Result;
+                break;
+            case OpNAnd:
+            case OpNAndJz:
+                *r &= ~allSetMask( Values, nCount, pc->bits );
+                break;
+            case OpRNAnd:
+            case OpRNAndJz:
+                *r &= ~Result;
+                break;
+            case OpOr:
+                *r |= anySetMask( Values, nCount, pc->bits );
+                break;
+            case OpROr:
+                *r |= Result;
+                break;
+            case OpNOr:
+                *r |= ~anySetMask( Values, nCount, pc->bits );
+                break;
+            case OpRNOr:
+                *r |= ~Result;
+                break;
+            case OpPush:
+                *++r = LaneMask;
+                break;
+            case OpPop:
+                Result = *r--;
+                break;
+
+        } // End Switch opCode
+
+        // Early out if the result is zero for every value.
+        if ( pc->opCode >= OpSetJz && pc->opCode <= OpRNAndJz && !(*r & LaneMask) )
+            pc += pc->jumpCount;
+
+        // Move to next instruction
+        ++pc;
+
+    } // Next Instruction
+
+    // Return the final result.
+    return (*r & LaneMask);
+}
+
 //-----------------------------------------------------------------------------
 //  Name : tokenizeExpression () (Protected)
 /// <summary>
@@ -566,9 +840,6 @@ bool cgFilterExpression::compileExpression( FilterInstructionArray & Instruction
     // ToDo: Move optimization of AND->AND and SET->AND into the optimizing pass
     // to reduce complexity of token processing?
 
-    // ToDo: Stack must not get larger than 256 (maximum size of temporary result
-    // stack within the evaluation function)
-
     // Process tokens
     for ( size_t i = 0; i < Tokens.size(); ++i )
     {
@@ -818,6 +1089,21 @@ bool cgFilterExpression::compileExpression( FilterInstructionArray & Instruction
     Instructions.insert( Instructions.end(), pInstructions->begin(), pInstructions->end() );
     delete pInstructions;
 
+    // The register stack used during evaluation is of a fixed size.
+    size_t nDepth = 0;
+    for ( size_t i = 0; i < Instructions.size(); ++i )
+    {
+        if ( Instructions[i].opCode == OpPush && ++nDepth >= MaxStackDepth )
+        {
+            cgAppLog::write( cgAppLog::Error, _T("Filter expression exceeds the maximum nesting depth of %i.\n"), (cgInt)MaxStackDepth - 1 );
+            return false;
+        
+        } // End if too deep
+        else if ( Instructions[i].opCode == OpPop )
+            --nDepth;
+
+    } // Next instruction
+
     // Perform some optimizations?
     if ( bOptimize )
     {
@@ -923,4 +1209,95 @@ bool cgFilterExpression::compileExpression( FilterInstructionArray & Instruction
 
     // Success!
     return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildClosedForm () (Protected)
+/// <summary>
+/// Determine if the compiled instructions describe a pure conjunction (AND) or
+/// disjunction (OR) of simple bit tests. If so, the expression is reduced to a
+/// single pair of masks that can be tested directly during evaluation without
+/// the need to execute the instructions.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgFilterExpression::buildClosedForm( )
+{
+    using namespace FilterExpression;
+    mClosedForm      = false;
+    mClosedFormAny   = false;
+    mClosedSetMask   = 0;
+    mClosedClearMask = 0;
+    if ( mInstructions.empty() )
+        return;
+
+    // A conjunction fails if any 'set' bit is set, or any 'clear' bit is clear.
+    // A disjunction passes if any 'set' bit is set, or any 'clear' bit is clear.
+    // Inverted and multiple bit tests can only be merged in some cases.
+    bool bAll = true, bAny = true;
+    cgUInt64 AllSetMask = 0, AllClearMask = 0, AnySetMask = 0, AnyClearMask = 0;
+    for ( size_t i = 0; i < mInstructions.size() && (bAll || bAny); ++i )
+    {
+        const FilterInstruction & Instruction = mInstructions[i];
+        const cgUInt64 Bits = Instruction.bits;
+        switch ( Instruction.opCode )
+        {
+            case OpSet:
+            case OpSetJz:
+                bAll &= (i == 0);
+                bAny &= (i == 0) && isSingleBit( Bits );
+                AllClearMask |= Bits;
+                AnySetMask   |= Bits;
+                break;
+            case OpNSet:
+            case OpNSetJz:
+                bAll &= (i == 0) && isSingleBit( Bits );
+                bAny &= (i == 0) && isSingleBit( Bits );
+                AllSetMask   |= Bits;
+                AnyClearMask |= Bits;
+                break;
+            case OpAnd:
+            case OpAndJz:
+                bAny = false;
+                AllClearMask |= Bits;
+                break;
+            case OpNAnd:
+            case OpNAndJz:
+                bAny = false;
+                bAll &= isSingleBit( Bits );
+                AllSetMask |= Bits;
+                break;
+            case OpOr:
+                bAll = false;
+                AnySetMask |= Bits;
+                break;
+            case OpNOr:
+                bAll = false;
+                bAny &= isSingleBit( Bits );
+                AnyClearMask |= Bits;
+                break;
+            default:
+                bAll = false;
+                bAny = false;
+                break;
+
+        } // End switch opCode
+
+    } // Next instruction
+
+    // Select the closed form (if any).
+    if ( bAll )
+    {
+        mClosedForm      = true;
+        mClosedSetMask   = AllSetMask;
+        mClosedClearMask = AllClearMask;
+    
+    } // End if conjunction
+    else if ( bAny )
+    {
+        mClosedForm      = true;
+        mClosedFormAny   = true;
+        mClosedSetMask   = AnySetMask;
+        mClosedClearMask = AnyClearMask;
+    
+    } // End if disjunction
 }
\ No newline at end of file
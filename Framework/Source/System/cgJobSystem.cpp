@@ -0,0 +1,711 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgJobSystem.cpp                                                    //
+//                                                                           //
+// Desc : Fixed size work-stealing job scheduler supporting job counters,    //
+//        dependencies and parallel-for style work distribution.             //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgJobSystem Module Includes
+//-----------------------------------------------------------------------------
+#include <System/cgJobSystem.h>
+#include <System/cgThreading.h>
+#include <System/cgTraceProfiler.h>
+#if defined(CGE_STD_THREADING)
+#include <thread>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace JobSystem
+{
+    //-------------------------------------------------------------------------
+    // Local Module Level Constants
+    //-------------------------------------------------------------------------
+    const cgUInt32 MaxWorkers       = 64;   // Upper limit on the number of worker threads.
+    const cgUInt32 IdleTimeout      = 100;  // Maximum time (ms) an idle worker sleeps before re-checking state.
+    const cgUInt32 ChunksPerThread  = 4;    // Automatic 'parallelFor()' grain targets this many chunks per thread.
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Structures
+    //-------------------------------------------------------------------------
+    struct Job
+    {
+        cgJobFunc       function;
+        void          * context;
+        cgJobCounter  * counter;
+    };
+    CGE_DEQUE_DECLARE( Job, JobQueue )
+
+    // Queue (and its lock) owned by each participating thread. Slot 0 is
+    // shared by all threads not owned by the job system.
+    struct WorkerQueue
+    {
+        cgCriticalSection * section;
+        JobQueue            jobs;
+    };
+
+    // Context for a single 'parallelFor()' range.
+    struct ForRange
+    {
+        cgParallelForFunc   function;
+        void              * context;
+        cgUInt32            first;
+        cgUInt32            last;
+    };
+    CGE_ARRAY_DECLARE( ForRange, ForRangeArray )
+    CGE_ARRAY_DECLARE( cgJobDesc, JobDescArray )
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Variables
+    //-------------------------------------------------------------------------
+    cgUInt32            workerCount     = 0;        // Number of worker threads (excluding external threads).
+    WorkerQueue       * queues          = CG_NULL;  // Job queues. Index 0 is the shared external queue.
+    cgThread         ** workers         = CG_NULL;  // Worker threads (index 0 unused).
+    cgEvent           * wakeEvent       = CG_NULL;  // Signaled whenever work is available for idle workers.
+    cgCriticalSection * dependencyLock  = CG_NULL;  // Protects counter completion and waiting lists.
+    volatile cgInt32    pendingJobs     = 0;        // Number of jobs currently queued across all threads.
+    bool                initialized     = false;
+    CGE_THREAD_LOCAL cgUInt32 threadIndex = 0;      // Job system index of the calling thread (0 = external).
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Functions
+    //-------------------------------------------------------------------------
+    inline cgInt32 atomicIncrement( volatile cgInt32 * value, cgInt32 amount )
+    {
+#if defined(_WIN32)
+        return ::InterlockedExchangeAdd( (volatile LONG*)value, amount ) + amount;
+#else
+        return __sync_add_and_fetch( value, amount );
+#endif
+    }
+
+    inline bool atomicCompareExchange( volatile cgInt32 * value, cgInt32 exchange, cgInt32 comparand )
+    {
+#if defined(_WIN32)
+        return ( ::InterlockedCompareExchange( (volatile LONG*)value, exchange, comparand ) == comparand );
+#else
+        return __sync_bool_compare_and_swap( value, comparand, exchange );
+#endif
+    }
+
+    inline void yieldThread( )
+    {
+#if defined(CGE_STD_THREADING)
+        std::this_thread::yield();
+#else
+        ::SwitchToThread();
+#endif
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : pushJobs ()
+    /// <summary>
+    /// Push the specified jobs onto the back of the calling thread's queue
+    /// and wake idle workers.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void pushJobs( const Job jobs[], cgUInt32 jobCount )
+    {
+        WorkerQueue & queue = queues[threadIndex];
+        queue.section->enter();
+        for ( cgUInt32 i = 0; i < jobCount; ++i )
+            queue.jobs.push_back( jobs[i] );
+        queue.section->exit();
+        atomicIncrement( &pendingJobs, (cgInt32)jobCount );
+        wakeEvent->signal();
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : acquireJob ()
+    /// <summary>
+    /// Retrieve the next job to execute on the calling thread. The thread's
+    /// own queue is consulted first (most recently pushed job first) before
+    /// an attempt is made to steal the oldest job from any other queue.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    bool acquireJob( Job & job )
+    {
+        if ( pendingJobs <= 0 )
+            return false;
+
+        // Pop from the back of our own queue.
+        const cgUInt32 index = threadIndex;
+        WorkerQueue & local = queues[index];
+        local.section->enter();
+        if ( !local.jobs.empty() )
+        {
+            job = local.jobs.back();
+            local.jobs.pop_back();
+            local.section->exit();
+            atomicIncrement( &pendingJobs, -1 );
+            return true;
+        
+        } // End if local work
+        local.section->exit();
+
+        // Steal from the front of the other queues.
+        const cgUInt32 queueCount = workerCount + 1;
+        for ( cgUInt32 i = 1; i < queueCount; ++i )
+        {
+            WorkerQueue & victim = queues[(index + i) % queueCount];
+            if ( !victim.section->tryEnter() )
+                continue;
+            if ( !victim.jobs.empty() )
+            {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                victim.section->exit();
+                atomicIncrement( &pendingJobs, -1 );
+                return true;
+            
+            } // End if has work
+            victim.section->exit();
+
+        } // Next queue
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //  Name : runRange ()
+    /// <summary>
+    /// Job function used to execute a single 'parallelFor()' range.
+    /// </summary>
+    //-------------------------------------------------------------------------
+    void runRange( void * context )
+    {
+        const ForRange * range = (const ForRange*)context;
+        range->function( range->first, range->last, range->context );
+    }
+
+}; // End namespace JobSystem
+
+///////////////////////////////////////////////////////////////////////////////
+// cgJobCounter Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+// Private Structures
+//-----------------------------------------------------------------------------
+struct cgJobCounter::WaitingJob
+{
+    JobSystem::Job  job;
+    WaitingJob    * next;
+};
+
+//-----------------------------------------------------------------------------
+//  Name : cgJobCounter () (Constructor)
+/// <summary>
+/// cgJobCounter Class Constructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgJobCounter::cgJobCounter( )
+{
+    // Initialize variables to sensible defaults.
+    mValue   = 0;
+    mWaiting = CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgJobCounter () (Destructor)
+/// <summary>
+/// cgJobCounter Class Destructor
+/// </summary>
+//-----------------------------------------------------------------------------
+cgJobCounter::~cgJobCounter( )
+{
+    // Any jobs still waiting on this counter can never be released. Discard
+    // them (the counter should have been waited upon first).
+    while ( mWaiting )
+    {
+        WaitingJob * next = mWaiting->next;
+        delete mWaiting;
+        mWaiting = next;
+    
+    } // Next waiting job
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isComplete ()
+/// <summary>
+/// Determine if all jobs associated with this counter have completed.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgJobCounter::isComplete( ) const
+{
+    return (mValue == 0);
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getValue ()
+/// <summary>
+/// Retrieve the number of jobs associated with this counter that are yet to
+/// complete.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgInt32 cgJobCounter::getValue( ) const
+{
+    return mValue;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cgJobSystem Member Definitions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : initialize () (Static)
+/// <summary>
+/// Start the job system with the specified number of worker threads. A value
+/// of zero selects one worker for each logical processor other than the
+/// one on which the calling thread executes.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgJobSystem::initialize( cgUInt32 workerCount /* = 0 */ )
+{
+    using namespace JobSystem;
+
+    // Already running?
+    if ( initialized )
+        return true;
+
+    // Select worker count.
+    if ( workerCount == 0 )
+        workerCount = max( (cgUInt32)1, getProcessorCount() - 1 );
+    workerCount = min( workerCount, MaxWorkers );
+
+    // Allocate shared state.
+    JobSystem::workerCount  = workerCount;
+    JobSystem::pendingJobs  = 0;
+    JobSystem::threadIndex  = 0;
+    queues          = new WorkerQueue[ workerCount + 1 ];
+    workers         = new cgThread*[ workerCount + 1 ];
+    wakeEvent       = cgEvent::createInstance( true );
+    dependencyLock  = cgCriticalSection::createInstance();
+    for ( cgUInt32 i = 0; i <= workerCount; ++i )
+    {
+        queues[i].section = cgCriticalSection::createInstance();
+        workers[i] = CG_NULL;
+    
+    } // Next queue
+    initialized = true;
+
+    // Start the workers.
+    for ( cgUInt32 i = 1; i <= workerCount; ++i )
+    {
+        workers[i] = cgThread::createInstance();
+        if ( !workers[i]->start( workerThread, (void*)(size_t)i ) )
+        {
+            shutdown();
+            return false;
+        
+        } // End if failed
+    
+    } // Next worker
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : shutdown () (Static)
+/// <summary>
+/// Stop all worker threads and release the job system. Any jobs that are
+/// still queued are executed on the calling thread before returning.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::shutdown( )
+{
+    using namespace JobSystem;
+    if ( !initialized )
+        return;
+
+    // Drain remaining work while workers are still available to help.
+    while ( runPendingJob() ) {}
+
+    // Stop the workers.
+    for ( cgUInt32 i = 1; i <= workerCount; ++i )
+    {
+        if ( workers[i] )
+            workers[i]->signalTerminate();
+    
+    } // Next worker
+    wakeEvent->signal();
+    for ( cgUInt32 i = 1; i <= workerCount; ++i )
+    {
+        if ( workers[i] )
+        {
+            workers[i]->terminate();
+            delete workers[i];
+        
+        } // End if valid
+    
+    } // Next worker
+
+    // Any stragglers queued by the final jobs are executed inline.
+    while ( runPendingJob() ) {}
+
+    // Release shared state.
+    for ( cgUInt32 i = 0; i <= workerCount; ++i )
+        delete queues[i].section;
+    delete []queues;
+    delete []workers;
+    delete wakeEvent;
+    delete dependencyLock;
+    queues          = CG_NULL;
+    workers         = CG_NULL;
+    wakeEvent       = CG_NULL;
+    dependencyLock  = CG_NULL;
+    workerCount     = 0;
+    pendingJobs     = 0;
+    initialized     = false;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isInitialized () (Static)
+/// <summary>
+/// Determine if the job system worker threads are running.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgJobSystem::isInitialized( )
+{
+    return JobSystem::initialized;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getWorkerCount () (Static)
+/// <summary>
+/// Retrieve the number of worker threads owned by the job system.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgJobSystem::getWorkerCount( )
+{
+    return JobSystem::workerCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getThreadIndex () (Static)
+/// <summary>
+/// Retrieve the job system index of the calling thread. Worker threads are
+/// numbered from 1 to 'getWorkerCount()' inclusive, and any thread not owned
+/// by the job system (including the main thread) reports an index of 0.
+/// Useful for selecting per-thread scratch data within a job.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgJobSystem::getThreadIndex( )
+{
+    return JobSystem::threadIndex;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getProcessorCount () (Static)
+/// <summary>
+/// Retrieve the number of logical processors available to the process.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgJobSystem::getProcessorCount( )
+{
+#if defined(CGE_STD_THREADING)
+    return max( (cgUInt32)1, (cgUInt32)std::thread::hardware_concurrency() );
+#else
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return max( (cgUInt32)1, (cgUInt32)info.dwNumberOfProcessors );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//  Name : submit () (Static)
+/// <summary>
+/// Submit a single job for execution. See 'submit( const cgJobDesc[], ...)'
+/// for details.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::submit( cgJobFunc function, void * context, cgJobCounter * counter /* = CG_NULL */, cgJobCounter * dependency /* = CG_NULL */ )
+{
+    cgJobDesc desc;
+    desc.function = function;
+    desc.context  = context;
+    submit( &desc, 1, counter, dependency );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : submit () (Static)
+/// <summary>
+/// Submit a group of jobs for execution. If a counter is supplied, it is
+/// incremented by the number of jobs submitted and decremented as each job
+/// completes. If a dependency counter is supplied, the jobs are only queued
+/// once all jobs associated with that counter have completed.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::submit( const cgJobDesc jobs[], cgUInt32 jobCount, cgJobCounter * counter /* = CG_NULL */, cgJobCounter * dependency /* = CG_NULL */ )
+{
+    using namespace JobSystem;
+    if ( !jobCount )
+        return;
+
+    // Account for the new jobs before they can possibly complete.
+    if ( counter )
+        atomicIncrement( &counter->mValue, (cgInt32)jobCount );
+
+    // Execute immediately if the system is not running.
+    if ( !initialized )
+    {
+        if ( dependency )
+            wait( dependency );
+        for ( cgUInt32 i = 0; i < jobCount; ++i )
+        {
+            jobs[i].function( jobs[i].context );
+            if ( counter )
+                atomicIncrement( &counter->mValue, -1 );
+        
+        } // Next job
+        return;
+    
+    } // End if inline
+
+    // Defer until the dependency completes?
+    if ( dependency )
+    {
+        dependencyLock->enter();
+        if ( dependency->mValue > 0 )
+        {
+            for ( cgUInt32 i = 0; i < jobCount; ++i )
+            {
+                cgJobCounter::WaitingJob * waiting = new cgJobCounter::WaitingJob();
+                waiting->job.function = jobs[i].function;
+                waiting->job.context  = jobs[i].context;
+                waiting->job.counter  = counter;
+                waiting->next         = dependency->mWaiting;
+                dependency->mWaiting  = waiting;
+            
+            } // Next job
+            dependencyLock->exit();
+            return;
+        
+        } // End if outstanding
+        dependencyLock->exit();
+    
+    } // End if dependency
+
+    // Queue the jobs.
+    const cgUInt32 BatchSize = 32;
+    Job batch[BatchSize];
+    for ( cgUInt32 i = 0; i < jobCount; i += BatchSize )
+    {
+        cgUInt32 count = min( BatchSize, jobCount - i );
+        for ( cgUInt32 j = 0; j < count; ++j )
+        {
+            batch[j].function = jobs[i+j].function;
+            batch[j].context  = jobs[i+j].context;
+            batch[j].counter  = counter;
+        
+        } // Next job
+        pushJobs( batch, count );
+    
+    } // Next batch
+}
+
+//-----------------------------------------------------------------------------
+//  Name : runPendingJob () (Static)
+/// <summary>
+/// Execute a single queued job on the calling thread if one is available.
+/// Returns true if a job was executed.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgJobSystem::runPendingJob( )
+{
+    using namespace JobSystem;
+    if ( !initialized )
+        return false;
+    Job job;
+    if ( !acquireJob( job ) )
+        return false;
+    job.function( job.context );
+    completeJob( job.counter );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : wait () (Static)
+/// <summary>
+/// Wait for all jobs associated with the specified counter to complete. The
+/// calling thread executes outstanding jobs while it waits, so it is safe to
+/// wait from within a job.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::wait( cgJobCounter * counter )
+{
+    if ( !counter )
+        return;
+    while ( !counter->isComplete() )
+    {
+        if ( !runPendingJob() )
+            JobSystem::yieldThread();
+    
+    } // Next attempt
+}
+
+//-----------------------------------------------------------------------------
+//  Name : parallelFor () (Static)
+/// <summary>
+/// Execute the specified function over the range [0, count) by splitting it
+/// into sub-ranges of at most 'grainSize' elements, distributed over all
+/// available threads. The function receives the half-open range [first, last)
+/// to process. A grain size of zero selects a size automatically. This method
+/// does not return until the entire range has been processed.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::parallelFor( cgUInt32 count, cgUInt32 grainSize, cgParallelForFunc function, void * context )
+{
+    using namespace JobSystem;
+    if ( !count )
+        return;
+
+    // Select the grain size.
+    const cgUInt32 threadCount = JobSystem::workerCount + 1;
+    if ( grainSize == 0 )
+        grainSize = max( (cgUInt32)1, count / (threadCount * ChunksPerThread) );
+
+    // Run inline if there is nothing to distribute.
+    if ( !initialized || count <= grainSize )
+    {
+        function( 0, count, context );
+        return;
+    
+    } // End if inline
+
+    // Build the ranges.
+    const cgUInt32 rangeCount = (count + grainSize - 1) / grainSize;
+    ForRangeArray ranges( rangeCount );
+    JobDescArray jobs( rangeCount );
+    for ( cgUInt32 i = 0; i < rangeCount; ++i )
+    {
+        ForRange & range = ranges[i];
+        range.function  = function;
+        range.context   = context;
+        range.first     = i * grainSize;
+        range.last      = min( count, range.first + grainSize );
+        jobs[i].function = runRange;
+        jobs[i].context  = &range;
+    
+    } // Next range
+
+    // Execute and wait.
+    cgJobCounter counter;
+    submit( &jobs.front(), rangeCount, &counter );
+    wait( &counter );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : completeJob () (Private, Static)
+/// <summary>
+/// Decrement the counter associated with a job that has just completed. If
+/// the counter reaches zero, any jobs waiting on it are released for
+/// execution.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgJobSystem::completeJob( cgJobCounter * counter )
+{
+    using namespace JobSystem;
+    if ( !counter )
+        return;
+
+    // Decrement the counter. The final decrement is performed under the
+    // dependency lock so that it is atomic with respect to the release of
+    // waiting jobs. The counter must not be touched once it reaches zero
+    // as its owner is then free to destroy it.
+    for ( ;; )
+    {
+        cgInt32 value = counter->mValue;
+        if ( value > 1 )
+        {
+            if ( atomicCompareExchange( &counter->mValue, value - 1, value ) )
+                return;
+            continue;
+        
+        } // End if not final
+
+        dependencyLock->enter();
+        cgJobCounter::WaitingJob * waiting = counter->mWaiting;
+        counter->mWaiting = CG_NULL;
+        if ( !atomicCompareExchange( &counter->mValue, 0, 1 ) )
+        {
+            // Value changed (further jobs were added); restore and retry.
+            counter->mWaiting = waiting;
+            dependencyLock->exit();
+            continue;
+        
+        } // End if changed
+        dependencyLock->exit();
+
+        // Queue any jobs that were waiting on this counter.
+        while ( waiting )
+        {
+            cgJobCounter::WaitingJob * next = waiting->next;
+            pushJobs( &waiting->job, 1 );
+            delete waiting;
+            waiting = next;
+        
+        } // Next waiting job
+        return;
+
+    } // Next attempt
+}
+
+//-----------------------------------------------------------------------------
+//  Name : workerThread () (Private, Static)
+/// <summary>
+/// Entry point for each worker thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgJobSystem::workerThread( cgThread * thread, void * context )
+{
+    using namespace JobSystem;
+    threadIndex = (cgUInt32)(size_t)context;
+
+    // Identify this worker in any captured trace.
+    cgChar threadName[32];
+    sprintf( threadName, "Job Worker %u", threadIndex );
+    cgTraceProfiler::setThreadName( threadName );
+
+    while ( !thread->terminateRequested() )
+    {
+        Job job;
+        if ( acquireJob( job ) )
+        {
+            // Wake another worker if further work remains.
+            if ( pendingJobs > 0 )
+                wakeEvent->signal();
+            cgTraceScope( "Job" );
+            job.function( job.context );
+            completeJob( job.counter );
+        
+        } // End if job
+        else
+        {
+            wakeEvent->wait( IdleTimeout );
+        
+        } // End if idle
+
+    } // Next job
+
+    // Pass the wake signal along so that other exiting workers notice.
+    wakeEvent->signal();
+    return 0;
+}
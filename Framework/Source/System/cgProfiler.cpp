@@ -28,6 +28,7 @@
 //-----------------------------------------------------------------------------
 #include <System/cgProfiler.h>
 #include <System/cgStringUtility.h>
+#include <System/cgTraceProfiler.h>
 #include <Network/cgBroadcast.h>
 
 // Windows platform includes
@@ -85,6 +86,9 @@ void cgProfiler::dispose( bool bDisposeBase )
     // Reset variables
     mNextStatId = 0x100;
 
+    // Release any captured trace data.
+    cgTraceProfiler::shutdown();
+
     // Shut down broadcast server and disconnect all clients if allocated.
     if ( mBroadcastServer )
         mBroadcastServer->scriptSafeDispose();
@@ -151,6 +155,8 @@ bool cgProfiler::loadConfig( const cgString & strFileName )
     mConfig.broadcastPort     = GetPrivateProfileInt( _T("Profiler"), _T("BroadcastPort"), 46352, strResolvedFile.c_str() );
     mConfig.broadcastInterval = cgStringUtility::getPrivateProfileFloat( _T("Profiler"), _T("BroadcastInterval"), 0.25f, strResolvedFile.c_str() );
     mConfig.outputMarkers     = GetPrivateProfileInt( _T("Profiler"), _T("OutputMarkers"), 0, strResolvedFile.c_str() ) > 0;
+    mConfig.captureTrace      = GetPrivateProfileInt( _T("Profiler"), _T("CaptureTrace"), 0, strResolvedFile.c_str() ) > 0;
+    mConfig.traceBufferSize   = GetPrivateProfileInt( _T("Profiler"), _T("TraceBufferSize"), 0, strResolvedFile.c_str() );
     
     // Success!!
     return true;
@@ -181,6 +187,8 @@ bool cgProfiler::saveConfig( const cgString & strFileName )
     cgStringUtility::writePrivateProfileIntEx( strSection, _T("BroadcastPort"), mConfig.broadcastPort, strResolvedFile.c_str() );
     cgStringUtility::writePrivateProfileFloat( strSection, _T("BroadcastInterval"), mConfig.broadcastInterval, strResolvedFile.c_str() );
     cgStringUtility::writePrivateProfileIntEx( strSection, _T("OutputMarkers"), mConfig.outputMarkers, strResolvedFile.c_str() );
+    cgStringUtility::writePrivateProfileIntEx( strSection, _T("CaptureTrace"), mConfig.captureTrace, strResolvedFile.c_str() );
+    cgStringUtility::writePrivateProfileIntEx( strSection, _T("TraceBufferSize"), mConfig.traceBufferSize, strResolvedFile.c_str() );
     
     // Success!!
     return true;
@@ -224,6 +232,18 @@ bool cgProfiler::initialize( )
 
     } // End if broadcast
 
+    // Scoped trace capture enabled?
+    if ( mConfig.enabled && mConfig.captureTrace )
+    {
+        if ( cgTraceProfiler::initialize( mConfig.traceBufferSize ) )
+        {
+            cgTraceProfiler::setThreadName( "Main" );
+            cgTraceProfiler::setCapturing( true );
+        
+        } // End if success
+
+    } // End if trace
+
     // Success!
     return true;
 }
@@ -246,6 +266,11 @@ void cgProfiler::beginFrame( )
     // Reset geometry statistics for this new frame.
     mPrimitiveStats.sampleData = 0;
 
+    // Record the frame in any captured trace.
+    mFrameStats.traceOpen = mConfig.enabled && cgTraceProfiler::isCapturing();
+    if ( mFrameStats.traceOpen )
+        cgTraceProfiler::beginScope( "Frame" );
+
     // Record the initial time for the start of the frame (in performance 
     // counter cycles). We do this at the very end in order to ensure 
     // minimal superfluous overhead is included in the timing.
@@ -293,6 +318,16 @@ void cgProfiler::beginProcess( const cgString & Process )
     // Record it as in-progress.
     mCurrentProcesses.push( pProcess );
 
+    // Open the process scope in any captured trace.
+    pProcess->traceOpen = cgTraceProfiler::isCapturing();
+    if ( pProcess->traceOpen )
+    {
+        if ( !pProcess->traceName )
+            pProcess->traceName = cgTraceProfiler::registerScope( Process );
+        cgTraceProfiler::beginScope( pProcess->traceName );
+    
+    } // End if capturing
+
     // Record the initial time for the start of the frame (in performance 
     // counter cycles). We do this at the very end in order to ensure 
     // minimal superfluous overhead is included in the timing.
@@ -377,6 +412,16 @@ void cgProfiler::beginProcess( const cgString & Process, bool bAsRoot )
     // Record it as in-progress.
     mCurrentProcesses.push( pProcess );
 
+    // Open the process scope in any captured trace.
+    pProcess->traceOpen = cgTraceProfiler::isCapturing();
+    if ( pProcess->traceOpen )
+    {
+        if ( !pProcess->traceName )
+            pProcess->traceName = cgTraceProfiler::registerScope( Process );
+        cgTraceProfiler::beginScope( pProcess->traceName );
+    
+    } // End if capturing
+
     // Record the initial time for the start of the frame (in performance 
     // counter cycles). We do this at the very end in order to ensure 
     // minimal superfluous overhead is included in the timing.
@@ -442,6 +487,13 @@ void cgProfiler::endProcess( )
     if ( mCurrentProcesses.empty() )
         return;    
 
+    // Close the process scope in any captured trace (only if one was
+    // opened when the process began).
+    cgProfilerStatistics * pProcess = mCurrentProcesses.top();
+    if ( pProcess->traceOpen )
+        cgTraceProfiler::endScope();
+    pProcess->traceOpen = false;
+
     // Output performance marker if enabled.
     if ( mConfig.outputMarkers )
     {
@@ -471,9 +523,8 @@ void cgProfiler::endProcess( )
     
     } // End if outputMarkers
 
-    // Retrieve the process currently being sampled and then
-    // mark it as sampled (includes removal from the process stack).
-    cgProfilerStatistics * pProcess = mCurrentProcesses.top();
+    // Mark the process currently being sampled as complete
+    // (includes removal from the process stack).
     pProcess->lastFrameSample = mFrameStats.overall.sampleCount;
     mCurrentProcesses.pop();
 
@@ -532,6 +583,12 @@ void cgProfiler::endFrame( )
     if ( !mFrameBegun )
         return;
 
+    // Close the frame in any captured trace (only if one was opened
+    // when the frame began).
+    if ( mFrameStats.traceOpen )
+        cgTraceProfiler::endScope();
+    mFrameStats.traceOpen = false;
+
     // A new frame has been (entirely) sampled.
     ++mFrameStats.lastFrameSample;
 
@@ -692,4 +749,16 @@ void cgProfiler::primitivesDrawn( cgUInt32 nPrimitiveCount )
 {
     if ( mFrameBegun )
         mPrimitiveStats.sampleData += nPrimitiveCount;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : exportTrace()
+/// <summary>
+/// Export all scoped trace data captured so far to the specified file in the
+/// Chrome trace event format (see cgTraceProfiler::exportChromeTrace()).
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgProfiler::exportTrace( const cgString & fileName )
+{
+    return cgTraceProfiler::exportChromeTrace( fileName );
 }
\ No newline at end of file
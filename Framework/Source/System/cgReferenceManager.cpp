@@ -28,6 +28,7 @@
 //-----------------------------------------------------------------------------
 #include <System/cgReferenceManager.h>
 #include <System/cgReference.h>
+#include <algorithm>
 
 //-----------------------------------------------------------------------------
 // Static Member Variable Definitions
@@ -35,10 +36,13 @@
 cgReferenceManager::ReferenceMap    cgReferenceManager::mInternalReferences;
 cgReferenceManager::ReferenceMap    cgReferenceManager::mSerializedReferences;
 cgReferenceManager::ReferencePtrSet cgReferenceManager::mValidReferences;
-cgReferenceManager::MessageList     cgReferenceManager::mMessageQueue;
-cgReferenceManager::MessageList     cgReferenceManager::mMessageGroupQueue;
-cgReferenceManager::MessageList     cgReferenceManager::mMessageSubscriberQueue;
-cgReferenceManager::MessageList     cgReferenceManager::mMessageAllQueue;
+cgReferenceManager::MessageHeap     cgReferenceManager::mMessageQueue;
+cgUInt64                            cgReferenceManager::mMessageSequence          = 0;
+cgReferenceManager::MessageArray    cgReferenceManager::mFreeMessages;
+cgReferenceManager::MessageArray    cgReferenceManager::mMessageSlabs;
+cgReferenceManager::PayloadArray    cgReferenceManager::mFreePayloads[cgReferenceManager::PayloadClassCount];
+cgReferenceManager::PayloadArray    cgReferenceManager::mPayloadSlabs;
+cgReferenceManager::MessageStatistics cgReferenceManager::mMessageStatistics;
 cgReferenceManager::GroupMap        cgReferenceManager::mMessagingGroups;
 cgReferenceManager::SubscriberMap   cgReferenceManager::mSubscriberTable;
 cgReferenceManager::SubscriberMap   cgReferenceManager::mSubscribedToTable;
@@ -64,6 +68,9 @@ void cgReferenceManager::shutdown( bool bFlushMessages /* = false */ )
     // Delete all active messages (and send if flushing)
     processMessages( 0xFFFFFFFF, true, bFlushMessages );
 
+    // Release pooled message memory.
+    releaseMessagePool();
+
     // Clear target lists
     mSerializedReferences.clear();
     mInternalReferences.clear();
@@ -308,7 +315,7 @@ bool cgReferenceManager::sendMessageTo( cgUInt32 nFrom, cgUInt32 nTo, cgMessage
         pMessage->deliveryTime = pMessage->sendTime + fSendDelay;
 
         // Queue up the message
-        queueMessage( pMessage, mMessageQueue );
+        queueMessage( pMessage, Individual );
 
     } // End if delayed send
     
@@ -350,7 +357,7 @@ bool cgReferenceManager::sendMessageToSubscribers( cgUInt32 nFrom, cgMessage * p
         pMessage->deliveryTime = pMessage->sendTime + fSendDelay;
 
         // Queue up the message
-        queueMessage( pMessage, mMessageSubscriberQueue );
+        queueMessage( pMessage, Subscribers );
 
     } // End if delayed send
 
@@ -391,7 +398,7 @@ bool cgReferenceManager::sendMessageToAll( cgUInt32 nFrom, cgMessage * pMessage,
         pMessage->deliveryTime = pMessage->sendTime + fSendDelay;
 
         // Queue up the message
-        queueMessage( pMessage, mMessageAllQueue );
+        queueMessage( pMessage, All );
 
     } // End if delayed send
 
@@ -439,7 +446,7 @@ bool cgReferenceManager::sendMessageToGroup( cgUInt32 nFrom, const cgUID & Group
             pMessage->deliveryTime = pMessage->sendTime + fSendDelay;
 
             // Queue up the message
-            queueMessage( pMessage, mMessageGroupQueue );
+            queueMessage( pMessage, Group );
 
         } // End if delayed send
 
@@ -585,110 +592,78 @@ bool cgReferenceManager::unsubscribeFromReference( cgUInt32 nSubscriber, cgUInt3
 //  Name : processMessages () (Static)
 /// <summary>
 /// Allow the reference system to process any outstanding / queued
-/// reference target messages.
+/// reference target messages. Messages are dispatched in order of delivery 
+/// time, except that messages destined for individual references are issued
+/// first and grouped by target (maintaining the delivery order of the 
+/// messages received by each target).
 /// </summary>
 //-----------------------------------------------------------------------------
 void cgReferenceManager::processMessages( cgUInt32 nFrom /* = 0xFFFFFFFF */, bool bClearAll /* = false */, bool bSendOnClear /* = true */ )
 {
-    MessageList::iterator itMessage;
     cgDouble fCurrentTime = mTimer.getTime( true );
 
-    // Loop through individual messages
-    for ( itMessage = mMessageQueue.begin(); itMessage != mMessageQueue.end(); )
+    // Collect the messages that should be dispatched.
+    MessageHeap Batch;
+    if ( nFrom == 0xFFFFFFFF && bClearAll == true )
     {
-        cgMessage * pMessage = *itMessage;
-        if ( pMessage == CG_NULL )
-        {
-            ++itMessage;
-            continue;
-        
-        } // End if invalid
+        // Everything is to be dispatched.
+        Batch.swap( mMessageQueue );
 
-        // Not time to send message yet?
-        if ( bClearAll == false && pMessage->deliveryTime > fCurrentTime )
-            break;
-
-        // Limiting to a particular source target?
-        if ( nFrom != 0xFFFFFFFF && nFrom != pMessage->fromId )
+    } // End if clear all
+    else if ( nFrom == 0xFFFFFFFF )
+    {
+        // Pop messages from the heap until we reach one that is not yet due.
+        while ( !mMessageQueue.empty() && mMessageQueue.front().deliveryTime <= fCurrentTime )
         {
-            ++itMessage;
-            continue;
+            std::pop_heap( mMessageQueue.begin(), mMessageQueue.end(), DeliveredAfter() );
+            Batch.push_back( mMessageQueue.back() );
+            mMessageQueue.pop_back();
         
-        } // End if no match
-
-        // Is the source being unregistered?
-        if ( bClearAll == true )
-            pMessage->sourceUnregistered = true;
-
-        // Send the message!
-        if ( bClearAll == false || bSendOnClear == true )
-            issueMessage( pMessage, Individual );
-        delete pMessage;
-
-        // Erase this message from the list
-        mMessageQueue.erase( itMessage++ );
-    
-    } // Next Individual Message
+        } // Next due message
 
-    // Loop through group messages
-    for ( itMessage = mMessageGroupQueue.begin(); itMessage != mMessageGroupQueue.end(); )
+    } // End if due messages
+    else
     {
-        cgMessage * pMessage = *itMessage;
-        if ( pMessage == CG_NULL )
+        // Limiting to a particular source target. Extract any matching 
+        // messages, and rebuild the heap from those that remain.
+        size_t nKept = 0;
+        for ( size_t i = 0; i < mMessageQueue.size(); ++i )
         {
-            ++itMessage;
-            continue;
+            const QueuedMessage & Item = mMessageQueue[i];
+            if ( Item.message->fromId == nFrom && (bClearAll == true || Item.deliveryTime <= fCurrentTime) )
+                Batch.push_back( Item );
+            else
+                mMessageQueue[nKept++] = Item;
         
-        } // End if invalid
-
-        // Not time to send message yet?
-        if ( bClearAll == false && pMessage->deliveryTime > fCurrentTime )
-            break;
-
-        // Limiting to a particular source target?
-        if ( nFrom != 0xFFFFFFFF && nFrom != pMessage->fromId )
+        } // Next message
+        if ( !Batch.empty() )
         {
-            ++itMessage;
-            continue;
+            mMessageQueue.resize( nKept );
+            std::make_heap( mMessageQueue.begin(), mMessageQueue.end(), DeliveredAfter() );
         
-        } // End if no match
-
-        // Is the source being unregistered?
-        if ( bClearAll == true )
-            pMessage->sourceUnregistered = true;
+        } // End if extracted
 
-        // Send the message!
-        if ( bClearAll == false || bSendOnClear == true )
-            issueMessage( pMessage, Group );
-        delete pMessage;
+    } // End if limited to source
+    mMessageStatistics.queueDepth = (cgUInt32)mMessageQueue.size();
 
-        // Erase this message from the list
-        mMessageGroupQueue.erase( itMessage++ );
-
-    } // Next Group Message
-
-    // Loop through subscriber wide messages
-    for ( itMessage = mMessageSubscriberQueue.begin(); itMessage != mMessageSubscriberQueue.end(); )
+    // Anything to do?
+    if ( Batch.empty() )
     {
-        cgMessage * pMessage = *itMessage;
-        if ( pMessage == CG_NULL )
-        {
-            ++itMessage;
-            continue;
-        
-        } // End if invalid
+        mMessageStatistics.messagesDispatched = 0;
+        mMessageStatistics.dispatchTime       = 0;
+        return;
+    
+    } // End if nothing to do
 
-        // Not time to send message yet?
-        if ( bClearAll == false && pMessage->deliveryTime > fCurrentTime )
-            break;
+    // Sort into delivery order, then group individual messages by target.
+    std::sort( Batch.begin(), Batch.end(), DeliveredBefore() );
+    std::stable_sort( Batch.begin(), Batch.end(), DispatchOrder() );
 
-        // Limiting to a particular source target?
-        if ( nFrom != 0xFFFFFFFF && nFrom != pMessage->fromId )
-        {
-            ++itMessage;
-            continue;
-        
-        } // End if no match
+    // Dispatch the messages.
+    cgInt64 nDispatchBegin = mTimer.getPerfomanceCounter( true );
+    for ( size_t i = 0; i < Batch.size(); ++i )
+    {
+        cgMessage * pMessage = Batch[i].message;
 
         // Is the source being unregistered?
         if ( bClearAll == true )
@@ -696,87 +671,205 @@ void cgReferenceManager::processMessages( cgUInt32 nFrom /* = 0xFFFFFFFF */, boo
 
         // Send the message!
         if ( bClearAll == false || bSendOnClear == true )
-            issueMessage( pMessage, Subscribers );
-        delete pMessage;
-
-        // Erase this message from the list
-        mMessageSubscriberQueue.erase( itMessage++ );
+            issueMessage( pMessage, Batch[i].destination );
+        releaseMessage( pMessage );
+
+    } // Next message
+
+    // Record statistics.
+    cgDouble fDispatchTime = mTimer.measurePeriod( nDispatchBegin, mTimer.getPerfomanceCounter( true ) );
+    mMessageStatistics.messagesDispatched = (cgUInt32)Batch.size();
+    mMessageStatistics.totalDispatched   += (cgUInt32)Batch.size();
+    mMessageStatistics.dispatchTime       = fDispatchTime;
+    if ( fDispatchTime > mMessageStatistics.peakDispatchTime )
+        mMessageStatistics.peakDispatchTime = fDispatchTime;
+}
 
-    } // Next Subscribers Message
+//-----------------------------------------------------------------------------
+//  Name : getMessageStatistics () (Static)
+/// <summary>
+/// Retrieve the current delayed message queue depth and dispatch cost
+/// counters.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgReferenceManager::MessageStatistics & cgReferenceManager::getMessageStatistics( )
+{
+    mMessageStatistics.queueDepth = (cgUInt32)mMessageQueue.size();
+    return mMessageStatistics;
+}
 
-    // Loop through system wide messages
-    for ( itMessage = mMessageAllQueue.begin(); itMessage != mMessageAllQueue.end(); )
+//-----------------------------------------------------------------------------
+//  Name : queueMessage () (Static, Private)
+/// <summary>
+/// Queue up a pooled copy of the specified message in order of delivery
+/// time for optimal processing.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgReferenceManager::queueMessage( cgMessage * pMessage, DestinationType Destination )
+{
+    // Must be queued! Copy data structure (ensures that it doesn't go 
+    // out of scope from caller). Guaranteed data is duplicated into pooled
+    // memory where it is small enough to do so.
+    cgMessage * pNewMessage = allocateMessage();
+    pNewMessage->copyProperties( *pMessage );
+    if ( pMessage->guaranteedData == true )
     {
-        cgMessage * pMessage = *itMessage;
-        if ( pMessage == CG_NULL )
+        cgByte * pData = allocatePayload( pMessage->dataSize );
+        if ( pData != CG_NULL )
         {
-            ++itMessage;
-            continue;
+            memcpy( pData, pMessage->messageData, pMessage->dataSize );
+            pNewMessage->messageData    = pData;
+            pNewMessage->dataSize       = pMessage->dataSize;
+            pNewMessage->guaranteedData = true;
+            pNewMessage->pooledData     = true;
         
-        } // End if invalid
-
-        // Not time to send message yet?
-        if ( bClearAll == false && pMessage->deliveryTime > fCurrentTime )
-            break;
-
-        // Limiting to a particular source target?
-        if ( nFrom != 0xFFFFFFFF && nFrom != pMessage->fromId )
+        } // End if pooled
+        else
         {
-            ++itMessage;
-            continue;
+            pNewMessage->SetGuaranteedData( pMessage->messageData, pMessage->dataSize );
         
-        } // End if no match
+        } // End if too large
+    
+    } // End if guaranteed
+    else
+    {
+        pNewMessage->messageData = pMessage->messageData;
+        pNewMessage->dataSize    = pMessage->dataSize;
 
-        // Is the source being unregistered?
-        if ( bClearAll == true )
-            pMessage->sourceUnregistered = true;
+    } // End if not guaranteed
 
-        // Send the message!
-        if ( bClearAll == false || bSendOnClear == true )
-            issueMessage( pMessage, All );
-        delete pMessage;
+    // Insert into the message heap.
+    QueuedMessage Item;
+    Item.deliveryTime = pMessage->deliveryTime;
+    Item.sequence     = mMessageSequence++;
+    Item.destination  = Destination;
+    Item.message      = pNewMessage;
+    mMessageQueue.push_back( Item );
+    std::push_heap( mMessageQueue.begin(), mMessageQueue.end(), DeliveredAfter() );
 
-        // Erase this message from the list
-        mMessageAllQueue.erase( itMessage++ );
+    // Record statistics.
+    mMessageStatistics.queueDepth = (cgUInt32)mMessageQueue.size();
+    if ( mMessageStatistics.queueDepth > mMessageStatistics.peakQueueDepth )
+        mMessageStatistics.peakQueueDepth = mMessageStatistics.queueDepth;
 
-    } // Next System Message
+    // Success!
+    return true;
 }
 
 //-----------------------------------------------------------------------------
-//  Name : queueMessage () (Static, Private)
+//  Name : allocateMessage () (Static, Private)
 /// <summary>
-/// Queue up the specified message to the correct list and in the
-/// correct order for optimal processing.
+/// Retrieve an unused message structure from the message pool, allocating
+/// a new block of messages if none remain.
 /// </summary>
 //-----------------------------------------------------------------------------
-bool cgReferenceManager::queueMessage( cgMessage * pMessage, MessageList & MessageQueue )
+cgMessage * cgReferenceManager::allocateMessage( )
 {
-    MessageList::iterator itMessage;
-
-    // Must be queued!
-    cgMessage * pNewMessage = new cgMessage();
+    if ( mFreeMessages.empty() )
+    {
+        cgMessage * pSlab = new cgMessage[ MessageSlabSize ];
+        mMessageSlabs.push_back( pSlab );
+        mFreeMessages.reserve( mFreeMessages.size() + MessageSlabSize );
+        for ( cgUInt32 i = MessageSlabSize; i > 0; --i )
+            mFreeMessages.push_back( &pSlab[i-1] );
+        mMessageStatistics.pooledMessages += MessageSlabSize;
+    
+    } // End if exhausted
+    cgMessage * pMessage = mFreeMessages.back();
+    mFreeMessages.pop_back();
+    return pMessage;
+}
 
-    // Copy data structure (ensures that it doesn't go out of scope from caller)
-    *pNewMessage = *pMessage;
+//-----------------------------------------------------------------------------
+//  Name : releaseMessage () (Static, Private)
+/// <summary>
+/// Release the data associated with the specified message, and return it to
+/// the message pool for reuse.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgReferenceManager::releaseMessage( cgMessage * pMessage )
+{
+    if ( pMessage->messageData != CG_NULL && pMessage->pooledData == true )
+        releasePayload( (cgByte*)pMessage->messageData, pMessage->dataSize );
+    else if ( pMessage->messageData != CG_NULL && pMessage->guaranteedData == true )
+        delete [](cgByte*)pMessage->messageData;
+    pMessage->messageData    = CG_NULL;
+    pMessage->dataSize       = 0;
+    pMessage->guaranteedData = false;
+    pMessage->pooledData     = false;
+    mFreeMessages.push_back( pMessage );
+}
 
-    // Find the correct slot in the message queue for this item
-    for ( itMessage = MessageQueue.begin(); itMessage != MessageQueue.end(); ++itMessage )
+//-----------------------------------------------------------------------------
+//  Name : allocatePayload () (Static, Private)
+/// <summary>
+/// Retrieve a block of pooled memory large enough to contain guaranteed
+/// message data of the specified size. Returns CG_NULL if the data is too
+/// large to be pooled.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgByte * cgReferenceManager::allocatePayload( cgUInt32 nSize )
+{
+    // Select the size class.
+    cgUInt32 nClass = 0;
+    while ( nClass < PayloadClassCount && (1u << (MinPayloadShift + nClass)) < nSize )
+        ++nClass;
+    if ( nSize == 0 || nClass == PayloadClassCount )
+        return CG_NULL;
+
+    // Allocate a new block of memory for this class if none remain.
+    PayloadArray & Free = mFreePayloads[nClass];
+    if ( Free.empty() )
     {
-        cgMessage * pItem = *itMessage;
-        if (!pItem)
-            continue;
-
-        // Should we insert here?
-        if ( pItem->deliveryTime > pMessage->deliveryTime )
-            break;
+        const cgUInt32 nBlockSize = 1u << (MinPayloadShift + nClass);
+        cgByte * pSlab = new cgByte[ PayloadSlabSize ];
+        mPayloadSlabs.push_back( pSlab );
+        for ( cgUInt32 nOffset = PayloadSlabSize; nOffset >= nBlockSize; nOffset -= nBlockSize )
+            Free.push_back( pSlab + nOffset - nBlockSize );
+    
+    } // End if exhausted
+    cgByte * pData = Free.back();
+    Free.pop_back();
+    return pData;
+}
 
-    } // Next Message
+//-----------------------------------------------------------------------------
+//  Name : releasePayload () (Static, Private)
+/// <summary>
+/// Return a block of memory retrieved via allocatePayload() to the pool.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgReferenceManager::releasePayload( cgByte * pData, cgUInt32 nSize )
+{
+    cgUInt32 nClass = 0;
+    while ( (1u << (MinPayloadShift + nClass)) < nSize )
+        ++nClass;
+    mFreePayloads[nClass].push_back( pData );
+}
 
-    // Insert into the message queue
-    MessageQueue.insert( itMessage, pNewMessage );
+//-----------------------------------------------------------------------------
+//  Name : releaseMessagePool () (Static, Private)
+/// <summary>
+/// Release all memory allocated by the message and payload pools. This 
+/// should only be called once all queued messages have been released.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgReferenceManager::releaseMessagePool( )
+{
+    // Messages still waiting for delivery refer to pooled memory.
+    if ( !mMessageQueue.empty() )
+        return;
 
-    // Success!
-    return true;
+    for ( size_t i = 0; i < mMessageSlabs.size(); ++i )
+        delete []mMessageSlabs[i];
+    for ( size_t i = 0; i < mPayloadSlabs.size(); ++i )
+        delete []mPayloadSlabs[i];
+    for ( cgUInt32 i = 0; i < PayloadClassCount; ++i )
+        mFreePayloads[i].clear();
+    mMessageSlabs.clear();
+    mPayloadSlabs.clear();
+    mFreeMessages.clear();
+    mMessageStatistics.pooledMessages = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -945,8 +1038,9 @@ cgMessage::cgMessage()
     toId                = 0;
     sendTime            = 0.0f;
     deliveryTime        = 0.0f;
-    delayed             = 0.0f;
+    delayed             = false;
     sourceUnregistered  = false;
+    pooledData          = false;
 
     // Clear structures
     memset( &groupToId, 0, sizeof(cgUID) );
@@ -960,8 +1054,8 @@ cgMessage::cgMessage()
 //-----------------------------------------------------------------------------
 cgMessage::~cgMessage()
 {
-    // Release allocated memory
-    if ( messageData != CG_NULL && guaranteedData == true )
+    // Release allocated memory (pooled data is owned by the reference manager).
+    if ( messageData != CG_NULL && guaranteedData == true && pooledData == false )
         delete [](cgByte*)messageData;
 
     // Clear variables
@@ -978,11 +1072,12 @@ cgMessage::~cgMessage()
 //-----------------------------------------------------------------------------
 void cgMessage::SetGuaranteedData( void * pDataIn, cgUInt32 nSizeIn )
 {
-    // Release any previous
-    if ( messageData != CG_NULL && guaranteedData == true )
+    // Release any previous (pooled data is owned by the reference manager).
+    if ( messageData != CG_NULL && guaranteedData == true && pooledData == false )
         delete[] (cgByte*)messageData;
     messageData    = CG_NULL;
     guaranteedData = false;
+    pooledData     = false;
 
     // Any data passed
     if ( pDataIn && nSizeIn )
@@ -1011,11 +1106,12 @@ cgMessage & cgMessage::operator = ( const cgMessage & MessageIn )
     if ( &MessageIn == this )
         return (*this);
 
-    // Release any previous
-    if ( messageData != CG_NULL && guaranteedData == true )
+    // Release any previous (pooled data is owned by the reference manager).
+    if ( messageData != CG_NULL && guaranteedData == true && pooledData == false )
         delete[] (cgByte*)messageData;
     messageData    = CG_NULL;
     guaranteedData = false;
+    pooledData     = false;
 
     // Duplicate any data.
     if ( MessageIn.guaranteedData == true )
@@ -1031,6 +1127,19 @@ cgMessage & cgMessage::operator = ( const cgMessage & MessageIn )
     } // End if not guaranteed
 
     // Copy remaining data
+    copyProperties( MessageIn );
+    return *this;
+
+}
+
+//-----------------------------------------------------------------------------
+//  Name : copyProperties () (Private)
+/// <summary>
+/// Duplicate all message properties with the exception of the message data.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgMessage::copyProperties( const cgMessage & MessageIn )
+{
     messageId          = MessageIn.messageId;
     messageContext     = MessageIn.messageContext;
     fromId             = MessageIn.fromId;
@@ -1040,6 +1149,4 @@ cgMessage & cgMessage::operator = ( const cgMessage & MessageIn )
     delayed            = MessageIn.delayed;
     sourceUnregistered = MessageIn.sourceUnregistered;
     groupToId          = MessageIn.groupToId;
-    return *this;
-
 }
\ No newline at end of file
@@ -27,8 +27,12 @@
 // cgThreading Module Includes
 //-----------------------------------------------------------------------------
 #include <System/cgThreading.h>
-#include <System/Platform/cgWinThreading.h>
 #include <cgBase.h>
+#if defined(CGE_STD_THREADING)
+#include <System/Platform/cgStdThreading.h>
+#else
+#include <System/Platform/cgWinThreading.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Static Member Definitions
@@ -48,6 +52,10 @@ cgCriticalSection         * cgThreadPool::mListSection = CG_NULL;
 //-----------------------------------------------------------------------------
 cgCriticalSection * cgCriticalSection::createInstance()
 {
+#if defined(CGE_STD_THREADING)
+    // Portable implementation selected for all platforms.
+    return new cgStdCriticalSection();
+#else
     // Determine which type we should create.
     const CGEConfig & Config = cgGetEngineConfig();
     switch ( Config.platform )
@@ -57,6 +65,7 @@ cgCriticalSection * cgCriticalSection::createInstance()
     
     } // End Switch platform
     return CG_NULL;
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -70,6 +79,10 @@ cgCriticalSection * cgCriticalSection::createInstance()
 //-----------------------------------------------------------------------------
 cgThread * cgThread ::createInstance()
 {
+#if defined(CGE_STD_THREADING)
+    // Portable implementation selected for all platforms.
+    return new cgStdThread();
+#else
     // Determine which type we should create.
     const CGEConfig & Config = cgGetEngineConfig();
     switch ( Config.platform )
@@ -79,6 +92,7 @@ cgThread * cgThread ::createInstance()
     
     } // End Switch platform
     return CG_NULL;
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -92,6 +106,10 @@ cgThread * cgThread ::createInstance()
 //-----------------------------------------------------------------------------
 cgEvent * cgEvent::createInstance( bool bAutoReset /* = true */ )
 {
+#if defined(CGE_STD_THREADING)
+    // Portable implementation selected for all platforms.
+    return new cgStdEvent( bAutoReset );
+#else
     // Determine which type we should create.
     const CGEConfig & Config = cgGetEngineConfig();
     switch ( Config.platform )
@@ -101,6 +119,7 @@ cgEvent * cgEvent::createInstance( bool bAutoReset /* = true */ )
     
     } // End Switch platform
     return CG_NULL;
+#endif
 }
     
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,536 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgTraceProfiler.cpp                                                //
+//                                                                           //
+// Desc : Low overhead hierarchical scope tracing. Each thread records       //
+//        completed scopes into its own ring buffer without locking, and     //
+//        captured data can be exported in the Chrome trace event format for //
+//        inspection in chrome://tracing or Perfetto.                        //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgTraceProfiler Module Includes
+//-----------------------------------------------------------------------------
+#include <System/cgTraceProfiler.h>
+#include <System/cgThreading.h>
+#include <stdio.h>
+
+// Platform includes
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#undef WIN32_LEAN_AND_MEAN
+#else
+#include <chrono>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define CGE_TRACE_USE_TSC
+#endif
+#endif
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+volatile bool cgTraceProfiler::mCapturing = false;
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace TraceProfiler
+{
+    //-------------------------------------------------------------------------
+    // Local Module Level Constants
+    //-------------------------------------------------------------------------
+    const cgUInt32 DefaultEventsPerThread   = 65536;
+    const cgUInt32 MaxScopeDepth            = 64;
+    const cgUInt32 MaxThreadNameLength      = 64;
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Structures
+    //-------------------------------------------------------------------------
+    // A single completed scope.
+    struct Event
+    {
+        const cgChar      * name;
+        cgUInt64            start;
+        cgUInt64            end;
+    };
+
+    // Per-thread event storage. Only the owning thread writes to the buffer.
+    struct ThreadBuffer
+    {
+        cgUInt32            threadId;                       // Sequential identifier reported in the trace.
+        cgChar              name[MaxThreadNameLength];      // Display name for the thread.
+        Event             * events;                         // Ring buffer of completed scopes.
+        cgUInt32            mask;                           // Ring buffer capacity - 1 (capacity is a power of two).
+        volatile cgUInt32   written;                        // Total number of events written to the buffer.
+        cgUInt32            depth;                          // Depth of the explicit begin / end scope stack.
+        const cgChar      * scopeNames[MaxScopeDepth];      // Names of the currently open explicit scopes.
+        cgUInt64            scopeStarts[MaxScopeDepth];     // Start times of the currently open explicit scopes.
+    };
+    CGE_VECTOR_DECLARE(ThreadBuffer*, ThreadBufferArray)
+    CGE_MAP_DECLARE(cgString, cgChar*, ScopeNameMap)
+
+    // Owns the registered scope names. These are retained for the lifetime of
+    // the process since callers are permitted to cache the returned pointers.
+    struct ScopeNameTable
+    {
+        ScopeNameMap names;
+        ~ScopeNameTable( )
+        {
+            for ( ScopeNameMap::iterator itName = names.begin(); itName != names.end(); ++itName )
+                delete []itName->second;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Variables
+    //-------------------------------------------------------------------------
+    cgCriticalSection * lock            = CG_NULL;  // Protects the buffer list and scope name table.
+    ThreadBufferArray   buffers;                    // Buffers for every thread that has recorded data.
+    ScopeNameTable      scopeNames;                 // Registered dynamic scope names.
+    cgUInt32            eventsPerThread = 0;        // Capacity of each thread's ring buffer.
+    cgUInt32            generation      = 0;        // Incremented on each initialization to invalidate stale thread buffers.
+    cgUInt64            captureStart    = 0;        // Events beginning before this time stamp are not exported.
+    cgUInt64            frequency       = 1;        // Number of time stamp ticks per second.
+    bool                initialized     = false;
+    CGE_THREAD_LOCAL ThreadBuffer * threadBuffer     = CG_NULL;
+    CGE_THREAD_LOCAL cgUInt32       threadGeneration = 0;
+    CGE_THREAD_LOCAL cgChar         threadName[MaxThreadNameLength];
+
+    //-------------------------------------------------------------------------
+    // Local Module Level Functions
+    //-------------------------------------------------------------------------
+    // Retrieve (allocating if necessary) the calling thread's buffer.
+    ThreadBuffer * getThreadBuffer( )
+    {
+        if ( threadBuffer && threadGeneration == generation )
+            return threadBuffer;
+        if ( !initialized )
+            return CG_NULL;
+
+        // First use on this thread. Allocate a new buffer.
+        ThreadBuffer * buffer = new ThreadBuffer();
+        buffer->events  = new Event[eventsPerThread];
+        buffer->mask    = eventsPerThread - 1;
+        buffer->written = 0;
+        buffer->depth   = 0;
+        lock->enter();
+        buffer->threadId = (cgUInt32)buffers.size() + 1;
+        if ( threadName[0] )
+            strcpy( buffer->name, threadName );
+        else
+            sprintf( buffer->name, "Thread %u", buffer->threadId );
+        buffers.push_back( buffer );
+        lock->exit();
+        threadBuffer     = buffer;
+        threadGeneration = generation;
+        return buffer;
+    }
+
+    // Write a string to the output file as a quoted / escaped JSON string.
+    void writeString( FILE * file, const cgChar * value )
+    {
+        fputc( '"', file );
+        for ( ; *value; ++value )
+        {
+            const cgChar c = *value;
+            if ( c == '"' || c == '\\' )
+                fprintf( file, "\\%c", c );
+            else if ( (unsigned char)c < 0x20 )
+                fprintf( file, "\\u%04x", (cgUInt32)(unsigned char)c );
+            else
+                fputc( c, file );
+        
+        } // Next character
+        fputc( '"', file );
+    }
+
+} // End Namespace : TraceProfiler
+
+///////////////////////////////////////////////////////////////////////////////
+// cgTraceProfiler Member Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : initialize () (Static)
+/// <summary>
+/// Prepare the trace profiler for capturing. Each recording thread will be
+/// allocated a ring buffer capable of storing the specified number of 
+/// completed scopes (rounded up to the next power of two). Specify 0 to use 
+/// the default capacity. Capture remains disabled until 'setCapturing()' is
+/// called.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTraceProfiler::initialize( cgUInt32 eventsPerThread /* = 0 */ )
+{
+    using namespace TraceProfiler;
+    if ( initialized )
+        return true;
+
+    // Round the capacity up to a power of two.
+    if ( !eventsPerThread )
+        eventsPerThread = DefaultEventsPerThread;
+    TraceProfiler::eventsPerThread = 1;
+    while ( TraceProfiler::eventsPerThread < eventsPerThread && TraceProfiler::eventsPerThread < 0x80000000 )
+        TraceProfiler::eventsPerThread <<= 1;
+
+    // Determine the time stamp resolution.
+#if defined(_WIN32)
+    LARGE_INTEGER counterFrequency;
+    QueryPerformanceFrequency( &counterFrequency );
+    frequency = (cgUInt64)counterFrequency.QuadPart;
+#elif defined(CGE_TRACE_USE_TSC)
+    // Calibrate the time stamp counter against the monotonic system clock.
+    const std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+    const cgUInt64 counterStart = __rdtsc();
+    std::chrono::steady_clock::duration elapsed;
+    do
+    {
+        elapsed = std::chrono::steady_clock::now() - clockStart;
+    
+    } while ( elapsed < std::chrono::milliseconds( 20 ) );
+    const cgUInt64 counterElapsed = __rdtsc() - counterStart;
+    const cgInt64  elapsedNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count();
+    frequency = (cgUInt64)((cgDouble)counterElapsed * 1000000000.0 / (cgDouble)elapsedNanoseconds);
+#else
+    frequency = 1000000000;
+#endif
+
+    // Prepare for recording.
+    lock         = cgCriticalSection::createInstance();
+    captureStart = getTimestamp();
+    initialized  = true;
+    ++generation;
+
+    // Report the cost of recording a single scope on this system.
+    const cgDouble overhead = measureOverhead( 10000 );
+    cgAppLog::write( cgAppLog::Debug | cgAppLog::Info, _T("Trace profiler initialized with capacity for %u events per thread. Measured overhead is %.1fns per scope.\n"), TraceProfiler::eventsPerThread, overhead );
+    clear();
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : shutdown () (Static)
+/// <summary>
+/// Release all captured data. Any thread that may be recording must be idle 
+/// (or capture disabled) prior to calling this method.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::shutdown( )
+{
+    using namespace TraceProfiler;
+    if ( !initialized )
+        return;
+
+    // Stop recording and release all thread buffers.
+    mCapturing  = false;
+    initialized = false;
+    for ( size_t i = 0; i < buffers.size(); ++i )
+    {
+        delete []buffers[i]->events;
+        delete buffers[i];
+    
+    } // Next buffer
+    buffers.clear();
+    delete lock;
+    lock = CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isInitialized () (Static)
+/// <summary>
+/// Determine if the trace profiler has been initialized.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTraceProfiler::isInitialized( )
+{
+    return TraceProfiler::initialized;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setCapturing () (Static)
+/// <summary>
+/// Enable or disable the recording of trace data.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::setCapturing( bool capture )
+{
+    mCapturing = (capture && TraceProfiler::initialized);
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear () (Static)
+/// <summary>
+/// Discard all data captured so far. Only events that begin after this call
+/// will be exported.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::clear( )
+{
+    TraceProfiler::captureStart = getTimestamp();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setThreadName () (Static)
+/// <summary>
+/// Set the name by which the calling thread will be identified in any 
+/// exported trace. This may be called before the trace profiler has been
+/// initialized.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::setThreadName( const cgChar * name )
+{
+    using namespace TraceProfiler;
+    if ( !name )
+        return;
+    strncpy( threadName, name, MaxThreadNameLength - 1 );
+    threadName[MaxThreadNameLength - 1] = '\0';
+
+    // Update the existing buffer if one is already allocated.
+    ThreadBuffer * buffer = getThreadBuffer();
+    if ( buffer )
+        strcpy( buffer->name, threadName );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : registerScope () (Static)
+/// <summary>
+/// Retrieve a persistent scope name matching the specified string that can
+/// be supplied to any of the recording methods. The returned pointer remains
+/// valid for the lifetime of the application, so callers should cache it
+/// rather than registering the same name repeatedly.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgChar * cgTraceProfiler::registerScope( const cgString & name )
+{
+    using namespace TraceProfiler;
+    if ( !initialized )
+        return "";
+
+    lock->enter();
+    cgChar *& scopeName = scopeNames.names[name];
+    if ( !scopeName )
+    {
+        STRING_CONVERT;
+        const cgChar * convertedName = stringConvertT2CA( name.c_str() );
+        scopeName = new cgChar[strlen( convertedName ) + 1];
+        strcpy( scopeName, convertedName );
+    
+    } // End if new name
+    const cgChar * result = scopeName;
+    lock->exit();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getTimestamp () (Static)
+/// <summary>
+/// Retrieve the current value of the high resolution clock used to time
+/// stamp recorded scopes (see getTimestampFrequency()).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt64 cgTraceProfiler::getTimestamp( )
+{
+#if defined(_WIN32)
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter( &counter );
+    return (cgUInt64)counter.QuadPart;
+#elif defined(CGE_TRACE_USE_TSC)
+    return (cgUInt64)__rdtsc();
+#else
+    return (cgUInt64)std::chrono::duration_cast<std::chrono::nanoseconds>( 
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getTimestampFrequency () (Static)
+/// <summary>
+/// Retrieve the number of time stamp ticks per second.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt64 cgTraceProfiler::getTimestampFrequency( )
+{
+    return TraceProfiler::frequency;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : recordScope () (Static)
+/// <summary>
+/// Record a completed scope for the calling thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::recordScope( const cgChar * name, cgUInt64 start, cgUInt64 end )
+{
+    TraceProfiler::ThreadBuffer * buffer = TraceProfiler::getThreadBuffer();
+    if ( !buffer )
+        return;
+
+    // Write the event before publishing the new count so that the exporter
+    // never observes a partially written entry.
+    const cgUInt32 index = buffer->written;
+    TraceProfiler::Event & event = buffer->events[index & buffer->mask];
+    event.name  = name;
+    event.start = start;
+    event.end   = end;
+    buffer->written = index + 1;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : beginScope () (Static)
+/// <summary>
+/// Open a scope on the calling thread that will be recorded on the matching
+/// call to 'endScope()'. Useful where the scope cannot be expressed as a 
+/// C++ block (see cgTraceScope()).
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::beginScope( const cgChar * name )
+{
+    if ( !mCapturing )
+        return;
+    TraceProfiler::ThreadBuffer * buffer = TraceProfiler::getThreadBuffer();
+    if ( !buffer )
+        return;
+    if ( buffer->depth < TraceProfiler::MaxScopeDepth )
+    {
+        buffer->scopeNames[buffer->depth]  = name;
+        buffer->scopeStarts[buffer->depth] = getTimestamp();
+    
+    } // End if space
+    ++buffer->depth;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : endScope () (Static)
+/// <summary>
+/// Close the scope most recently opened on the calling thread with 
+/// 'beginScope()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgTraceProfiler::endScope( )
+{
+    const cgUInt64 end = getTimestamp();
+    TraceProfiler::ThreadBuffer * buffer = TraceProfiler::threadBuffer;
+    if ( !buffer || TraceProfiler::threadGeneration != TraceProfiler::generation || !buffer->depth )
+        return;
+    --buffer->depth;
+    if ( buffer->depth < TraceProfiler::MaxScopeDepth )
+        recordScope( buffer->scopeNames[buffer->depth], buffer->scopeStarts[buffer->depth], end );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : measureOverhead () (Static)
+/// <summary>
+/// Measure the average cost, in nanoseconds, of recording a single scope on
+/// the calling thread. Data recorded during the measurement is discarded, 
+/// though it may displace the oldest data in the calling thread's buffer.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgDouble cgTraceProfiler::measureOverhead( cgUInt32 iterations )
+{
+    TraceProfiler::ThreadBuffer * buffer = TraceProfiler::getThreadBuffer();
+    if ( !buffer || !iterations )
+        return 0;
+
+    // Record the requested number of empty scopes.
+    const bool     wasCapturing = mCapturing;
+    const cgUInt32 written      = buffer->written;
+    mCapturing = true;
+    const cgUInt64 start = getTimestamp();
+    for ( cgUInt32 i = 0; i < iterations; ++i )
+    {
+        cgTraceScopeRecorder scope( "cgTraceProfiler::measureOverhead" );
+    
+    } // Next iteration
+    const cgUInt64 end = getTimestamp();
+    mCapturing = wasCapturing;
+
+    // Discard the measurement data.
+    buffer->written = written;
+    return ((cgDouble)(end - start) * 1000000000.0 / (cgDouble)TraceProfiler::frequency) / (cgDouble)iterations;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : exportChromeTrace () (Static)
+/// <summary>
+/// Write all data captured since the most recent call to 'clear()' to the
+/// specified file using the Chrome trace event (JSON) format. This file can
+/// be loaded directly into chrome://tracing or the Perfetto UI. Scopes that
+/// are still being recorded by other threads while exporting may be omitted.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTraceProfiler::exportChromeTrace( const cgString & fileName )
+{
+    using namespace TraceProfiler;
+    if ( !initialized )
+        return false;
+
+    // Open the output file.
+    STRING_CONVERT;
+    FILE * file = fopen( stringConvertT2CA( fileName.c_str() ), "wb" );
+    if ( !file )
+    {
+        cgAppLog::write( cgAppLog::Debug | cgAppLog::Error, _T("Failed to open '%s' for writing while exporting profiler trace data.\n"), fileName.c_str() );
+        return false;
+    
+    } // End if failed
+
+    // Time stamps are exported in microseconds relative to the capture start.
+    const cgUInt64 baseTime       = captureStart;
+    const cgDouble toMicroseconds = 1000000.0 / (cgDouble)frequency;
+    fprintf( file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" );
+    fprintf( file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Carbon\"}}" );
+
+    lock->enter();
+    for ( size_t i = 0; i < buffers.size(); ++i )
+    {
+        const ThreadBuffer * buffer = buffers[i];
+
+        // Thread name metadata.
+        fprintf( file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->threadId );
+        writeString( file, buffer->name );
+        fprintf( file, "}}" );
+
+        // Completed scopes (oldest first).
+        const cgUInt32 written  = buffer->written;
+        const cgUInt32 capacity = buffer->mask + 1;
+        const cgUInt32 count    = (written < capacity) ? written : capacity;
+        for ( cgUInt32 j = written - count; j != written; ++j )
+        {
+            const Event & event = buffer->events[j & buffer->mask];
+            if ( event.start < baseTime || event.end < event.start )
+                continue;
+            fprintf( file, ",\n{\"name\":" );
+            writeString( file, event.name ? event.name : "" );
+            fprintf( file, ",\"cat\":\"cge\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->threadId,
+                     (cgDouble)(event.start - baseTime) * toMicroseconds, (cgDouble)(event.end - event.start) * toMicroseconds );
+        
+        } // Next event
+
+    } // Next buffer
+    lock->exit();
+
+    // Done.
+    fprintf( file, "\n]}\n" );
+    const bool success = (ferror( file ) == 0);
+    fclose( file );
+    return success;
+}
@@ -54,6 +54,7 @@ cgNavigationMeshElement::cgNavigationMeshElement( cgUInt32 referenceId, cgScene
     mNavMesh                = CG_NULL;
     mHandler                = CG_NULL;
     mSandboxRenderMethod    = ShowAll;
+    mInvalidRegion.reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -93,6 +94,7 @@ void cgNavigationMeshElement::dispose( bool disposeBase )
     mNavMesh                = CG_NULL;
     mHandler                = CG_NULL;
     mSandboxRenderMethod    = ShowAll;
+    mInvalidRegion.reset();
     
     // Dispose base class if requested.
     if ( disposeBase == true )
@@ -152,15 +154,93 @@ bool cgNavigationMeshElement::buildMesh( )
     if ( !mNavMesh )
         return false;
 
-    // Release any previous navigation handler.
+    // Release any previous navigation handler. A full build also
+    // supersedes any pending partial rebuild.
     if ( mHandler )
         mHandler->scriptSafeDispose();
     mHandler = CG_NULL;
+    mInvalidRegion.reset();
 
     // Get a list of all static meshes currently defined 
     // in the scene.
     cgArray<cgMeshHandle> meshes;
     cgArray<cgTransform>  transforms;
+    collectGeometry( meshes, transforms );
+
+    // Build the navigation mesh
+    if ( !meshes.empty() || mParentScene->getLandscape() )
+    {
+        // Build a new navigation mesh.
+        if ( !mNavMesh->build( (cgUInt32)meshes.size(), (meshes.empty()) ? CG_NULL : &meshes.front(), 
+                               (transforms.empty()) ? CG_NULL : &transforms.front(), mParentScene->getLandscape() ) )
+            return false;
+
+        // Create a new handler for this navigation mesh.
+        mHandler = new cgNavigationHandler();
+        mHandler->initialize( mNavMesh, 256 ); // ToDo: configurable
+
+        // Success!
+        return true;
+
+    } // End if has meshes
+
+    // Nothing to do. This is not an error.
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : invalidateRegion()
+/// <summary>
+/// Notify the navigation mesh that static geometry within the specified world
+/// space region has changed (i.e. a collidable mesh was moved, or the 
+/// landscape height map was modified). Affected tiles are not rebuilt 
+/// immediately; regions are accumulated until the next call to 
+/// 'rebuildInvalidRegion()' (once per scene update) such that repeated edits
+/// do not each trigger a rebuild. Ignored if the mesh has not yet been built.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgNavigationMeshElement::invalidateRegion( const cgBoundingBox & region )
+{
+    if ( !mHandler || !region.isPopulated() )
+        return;
+    mInvalidRegion.addPoint( region.min );
+    mInvalidRegion.addPoint( region.max );
+}
+
+//-----------------------------------------------------------------------------
+// Name : rebuildInvalidRegion()
+/// <summary>
+/// Reconstruct any navigation tiles affected by changes to static geometry
+/// reported via 'invalidateRegion()' since the last rebuild.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgNavigationMeshElement::rebuildInvalidRegion( )
+{
+    // Anything to do?
+    if ( !mInvalidRegion.isPopulated() )
+        return true;
+    const cgBoundingBox region = mInvalidRegion;
+    mInvalidRegion.reset();
+    if ( !mNavMesh || !mHandler )
+        return false;
+
+    // Rebuild the affected tiles from the current scene geometry.
+    cgArray<cgMeshHandle> meshes;
+    cgArray<cgTransform>  transforms;
+    collectGeometry( meshes, transforms );
+    return mNavMesh->rebuild( region, (cgUInt32)meshes.size(), (meshes.empty()) ? CG_NULL : &meshes.front(), 
+                              (transforms.empty()) ? CG_NULL : &transforms.front(), mParentScene->getLandscape() );
+}
+
+//-----------------------------------------------------------------------------
+// Name : collectGeometry() (Protected)
+/// <summary>
+/// Retrieve the mesh data and world transforms of all static collidable 
+/// meshes in the scene from which navigation data should be constructed.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgNavigationMeshElement::collectGeometry( cgArray<cgMeshHandle> & meshes, cgArray<cgTransform> & transforms )
+{
     cgObjectNodeMap::const_iterator itNode;
     const cgObjectNodeMap & nodes = mParentScene->getObjectNodes();
     for ( itNode = nodes.begin(); itNode != nodes.end(); ++itNode )
@@ -182,26 +262,6 @@ bool cgNavigationMeshElement::buildMesh( )
         transforms.push_back( node->getWorldTransform(false) );
     
     } // Next object node
-
-    // Build the navigation mesh
-    if ( !meshes.empty() || mParentScene->getLandscape() )
-    {
-        // Build a new navigation mesh.
-        if ( !mNavMesh->build( (cgUInt32)meshes.size(), (meshes.empty()) ? CG_NULL : &meshes.front(), 
-                               (transforms.empty()) ? CG_NULL : &transforms.front(), mParentScene->getLandscape() ) )
-            return false;
-
-        // Create a new handler for this navigation mesh.
-        mHandler = new cgNavigationHandler();
-        mHandler->initialize( mNavMesh, 256 ); // ToDo: configurable
-
-        // Success!
-        return true;
-
-    } // End if has meshes
-
-    // Nothing to do. This is not an error.
-    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -33,6 +33,7 @@
 #include <World/Objects/cgLightObject.h>
 #include <World/Objects/cgMeshObject.h>
 #include <World/cgScene.h>
+#include <World/cgVisibilitySet.h>
 #include <Resources/cgResourceManager.h>
 #include <Resources/cgScript.h>
 #include <Rendering/cgRenderDriver.h>
@@ -460,8 +461,35 @@ void cgLightingManager::processShadowMaps( cgCameraNode * pCamera, bool bReassig
     // Update list of objects that need to cast and/or receive shadows 
     // based on both the light's and camera's visibility sets.
     cgVisibilitySet  * pSet          = pCamera->getVisibilitySet();
-    cgObjectNodeList & VisibleLights = pSet->getVisibleLights();
-    cgObjectNodeList::const_iterator itLight;
+    const cgObjectNodeArray & VisibleLights = pSet->getVisibleLightArray();
+    cgObjectNodeArray::const_iterator itLight;
+
+    // Compute the visibility sets for all shadow frustums as a single batch
+    // so that the scene is traversed only once (and in parallel) for every
+    // light. The requests made by each light below will reuse these results.
+    cgLightNode::ShadowGeneratorArray Generators;
+    for ( itLight = VisibleLights.begin(); itLight != VisibleLights.end(); ++itLight )
+        ((cgLightNode*)(*itLight))->collectShadowGenerators( Generators );
+    if ( !Generators.empty() )
+    {
+        cgArray<cgVisibilitySet*> FrustumSets;
+        cgArray<const cgFrustum*> Frustums;
+        for ( size_t i = 0; i < Generators.size(); ++i )
+        {
+            cgCameraNode * pFrustumCamera = Generators[i]->getCamera();
+            if ( pFrustumCamera )
+            {
+                FrustumSets.push_back( pFrustumCamera->getVisibilitySet() );
+                Frustums.push_back( &pFrustumCamera->getFrustum() );
+            
+            } // End if valid
+        
+        } // Next generator
+        if ( !FrustumSets.empty() )
+            cgVisibilitySet::compute( &FrustumSets.front(), &Frustums.front(), (cgUInt32)FrustumSets.size() );
+    
+    } // End if any shadow frustums
+
     for ( itLight = VisibleLights.begin(); itLight != VisibleLights.end(); ++itLight )
     {
         cgLightNode * pLight = (cgLightNode*)(*itLight);
@@ -773,9 +801,9 @@ void cgLightingManager::processLights( const cgRenderTargetHandle& hLightingBuff
     // Our first job is to categorize lights into appropriate sets such
     // as dynamic, static, etc. This allows us to process the required light
     // types in order.
-    cgObjectNodeList::const_iterator itLight;
+    cgObjectNodeArray::const_iterator itLight;
     cgVisibilitySet * pSet = pCamera->getVisibilitySet();
-    cgObjectNodeList & VisibleLights = pSet->getVisibleLights();
+    const cgObjectNodeArray & VisibleLights = pSet->getVisibleLightArray();
     std::list<cgLightNode*> ShadowCastingLights, NonShadowCastingLights;
 	for ( itLight = VisibleLights.begin(); itLight != VisibleLights.end(); ++itLight )
 	{
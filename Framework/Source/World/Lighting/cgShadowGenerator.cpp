@@ -1008,8 +1008,8 @@ bool cgShadowGenerator::computeVisibilitySet( cgCameraNode * pSceneCamera, bool
     // or moved recently such that it now exists in the new view?
     if ( !mRegenerate )
     {
-        cgObjectNodeList::const_iterator itObject;
-        const cgObjectNodeList & Objects = pFrustumVis->getVisibleObjects();
+        cgObjectNodeArray::const_iterator itObject;
+        const cgObjectNodeArray & Objects = pFrustumVis->getVisibleObjectArray();
 		for ( itObject = Objects.begin(); itObject != Objects.end(); ++itObject )
         {
             // If the object is dirty, we must regenerate!
@@ -2761,8 +2761,8 @@ bool cgReflectanceGenerator::computeVisibilitySet( cgCameraNode * pSceneCamera,
     else
     {
         // The light source wasn't altered in any way, check shadow casting objects.
-        cgObjectNodeList::const_iterator itObject;
-        const cgObjectNodeList & Objects = pFrustumVis->getVisibleObjects();
+        cgObjectNodeArray::const_iterator itObject;
+        const cgObjectNodeArray & Objects = pFrustumVis->getVisibleObjectArray();
         for ( itObject = Objects.begin(); itObject != Objects.end(); ++itObject )
         {
             // If the object was deleted, or has been altered (moved, animated etc.)
@@ -2856,8 +2856,8 @@ bool cgReflectanceGenerator::computeVisibilitySet( cgCameraNode * pSceneCamera,
     // or moved recently such that it now exists in the new view?
     if ( !mRegenerate )
     {
-        cgObjectNodeList::const_iterator itObject;
-        const cgObjectNodeList & Objects = pFrustumVis->getVisibleObjects();
+        cgObjectNodeArray::const_iterator itObject;
+        const cgObjectNodeArray & Objects = pFrustumVis->getVisibleObjectArray();
         for ( itObject = Objects.begin(); itObject != Objects.end(); ++itObject )
         {
             // If the object is dirty, we must regenerate!
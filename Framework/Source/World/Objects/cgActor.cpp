@@ -762,6 +762,8 @@ cgUInt32 cgActorNode::onGroupRefAdded( cgObjectNode * node )
     {
         // Add to the map.
         mTargets[ node->getInstanceIdentifier() ] = node;
+        if ( mController )
+            mController->invalidateTargets();
 
         // Listen for changes to the instance identifier.
         node->registerEventListener( static_cast<cgObjectNodeEventListener*>(this) );
@@ -788,6 +790,8 @@ cgUInt32 cgActorNode::onGroupRefRemoved( cgObjectNode * node )
     {
         // Remove from the map.
         mTargets.erase( itTarget );
+        if ( mController )
+            mController->invalidateTargets();
 
         // We no longer want to listen for changes to the instance identifier.
         node->unregisterEventListener( static_cast<cgObjectNodeEventListener*>(this) );
@@ -816,6 +820,8 @@ void cgActorNode::onInstanceIdentifierChange( cgObjectNodeNameChangeEventArgs *
     {
         // Remove old entry.
         mTargets.erase( itTarget );
+        if ( mController )
+            mController->invalidateTargets();
 
         // Are we free to associate this node with the new name?
         itTarget = mTargets.find( e->node->getInstanceIdentifier() );
@@ -910,6 +916,7 @@ cgInt32 cgActorNode::playAnimationSet( const cgString & trackName, const cgStrin
 cgAnimationSetHandle cgActorNode::generateActorSnapshot( )
 {
     cgAnimationSet * animationSet = new cgAnimationSet( cgReferenceManager::generateInternalRefId(), CG_NULL );
+    animationSet->suspendSerialization();
     TargetMap::const_iterator itTarget;
     for ( itTarget = mTargets.begin(); itTarget != mTargets.end(); ++itTarget )
     {
@@ -926,6 +933,7 @@ cgAnimationSetHandle cgActorNode::generateActorSnapshot( )
         animationSet->addMatrixKey( 1, itTarget->first, t );
     
     } // Next target
+    animationSet->resumeSerialization();
 
     // Add to resource manager.
     cgAnimationSetHandle handle;
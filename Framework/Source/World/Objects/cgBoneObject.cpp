@@ -685,6 +685,10 @@ cgBoneNode::cgBoneNode( cgUInt32 referenceId, cgScene * scene ) : cgObjectNode(
     // Default the node color
     mColor                = 0xFFAEBACB;
     mCollisionEnabled     = false;
+
+    // Bone hierarchies are typically animated as a whole, so resolve
+    // their transforms in a single batched pass by default.
+    mBatchTransforms      = true;
 }
 
 //-----------------------------------------------------------------------------
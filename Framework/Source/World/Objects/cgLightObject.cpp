@@ -3173,6 +3173,19 @@ void cgLightNode::computeShadowSets( cgCameraNode * pCamera )
 {
 }
 
+//-----------------------------------------------------------------------------
+//  Name : collectShadowGenerators( ) (Virtual)
+/// <summary>
+/// Append the shadow generators whose visibility sets will be computed
+/// during the next call to computeShadowSets() to the specified list. This
+/// allows the caller to compute the visibility for many light sources as a
+/// single batch ahead of time.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLightNode::collectShadowGenerators( ShadowGeneratorArray & generators )
+{
+}
+
 //-----------------------------------------------------------------------------
 //  Name : registerVisibility () (Virtual)
 /// <summary>
@@ -30,6 +30,7 @@
 #include <World/cgScene.h>
 #include <World/cgSphereTree.h>
 #include <World/Objects/Elements/cgHullCollisionShapeElement.h>
+#include <World/Elements/cgNavigationMeshElement.h>
 #include <Rendering/cgRenderDriver.h>
 #include <Rendering/cgVertexFormats.h>
 #include <Resources/cgResourceManager.h>
@@ -1575,11 +1576,39 @@ bool cgMeshNode::registerVisibility( cgVisibilitySet * pSet )
 //-----------------------------------------------------------------------------
 bool cgMeshNode::setCellTransform( const cgTransform & Transform, cgTransformSource::Base Source /* = cgTransformSource::Standard */ )
 {
+    // Static collidable meshes contribute to any navigation meshes in the
+    // scene. If there are any, record where we were before moving.
+    const cgSceneElementArray * navigationElements = CG_NULL;
+    cgBoundingBox previousBounds;
+    if ( mParentScene && (mPhysicsModel == cgPhysicsModel::CollisionOnly || mPhysicsModel == cgPhysicsModel::RigidStatic) )
+    {
+        navigationElements = &mParentScene->getSceneElementsByType( RTID_NavigationMeshElement );
+        if ( navigationElements->empty() )
+            navigationElements = CG_NULL;
+        else
+            previousBounds = getBoundingBox();
+
+    } // End if static collidable
+
     // Call base class implementation first. This ensures that
     // all of our internal data is up-to-date.
     if ( !cgObjectNode::setCellTransform( Transform, Source ) )
         return false;
 
+    // Navigation tiles covering both the old and new locations must be rebuilt.
+    if ( navigationElements )
+    {
+        const cgBoundingBox & currentBounds = getBoundingBox();
+        for ( size_t i = 0; i < navigationElements->size(); ++i )
+        {
+            cgNavigationMeshElement * element = (cgNavigationMeshElement*)(*navigationElements)[i];
+            element->invalidateRegion( previousBounds );
+            element->invalidateRegion( currentBounds );
+        
+        } // Next element
+
+    } // End if navigation
+
     // If physics body update was requested, and we're in collision only
     // mode, we must take special action to apply any scale / shear to the
     // user mesh collision shape (since the physics engine will not consider
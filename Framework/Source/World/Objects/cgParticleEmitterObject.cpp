@@ -3002,6 +3002,11 @@ cgParticleEmitterNode::cgParticleEmitterNode( cgUInt32 nReferenceId, cgScene * p
     // Default update rate to 'always' by default.
     mUpdateRate = cgUpdateRate::Always;
 
+    // Emitters only simulate their own particles during update (drawing from
+    // their own random number generators) and can therefore be updated in
+    // parallel with other thread-safe nodes.
+    mUpdateThreadSafe = true;
+
     // Automaticaly assign to the 'Effects' render class.
     mRenderClassId = pScene->getRenderClassId( _T("Effects") );
 
@@ -3382,15 +3387,22 @@ void cgParticleEmitterNode::update( cgFloat fElapsedTime )
     // to update / move, etc.
     cgObjectNode::update( fElapsedTime );
 
-    // Now allow the emitters to update.
-    bool destroyEmitter = (cgGetSandboxMode() != cgSandboxMode::Enabled);
+    // Now allow the emitters to update (layers are simulated in parallel).
     for ( size_t i = 0; i < mEmitters.size(); ++i )
     {
         if ( mEmitters[i] )
-        {
             mEmitters[i]->setEmitterMatrix( getWorldTransform(false) );
-            mEmitters[i]->update( fElapsedTime, cgVector3(0,0,0), true );
+    
+    } // Next emitter
+    if ( !mEmitters.empty() )
+        cgParticleEmitter::updateEmitters( &mEmitters.front(), (cgUInt32)mEmitters.size(), fElapsedTime, cgVector3(0,0,0), true );
 
+    // Determine if the emitters are now spent.
+    bool destroyEmitter = (cgGetSandboxMode() != cgSandboxMode::Enabled);
+    for ( size_t i = 0; i < mEmitters.size(); ++i )
+    {
+        if ( mEmitters[i] )
+        {
             // Destroy the emitter when all particles are spent (except in sandbox mode).
             if ( !getMaximumParticles(i) || !mEmitters[i]->particlesSpent( true ) )
                 destroyEmitter = false;    
@@ -3401,9 +3413,17 @@ void cgParticleEmitterNode::update( cgFloat fElapsedTime )
     
     } // Next emitter
 
-    // Clean up the emitter?
+    // Clean up the emitter? Unloading releases render resources, which is not
+    // permitted during a parallel update. In this case, opt out of parallel
+    // updates so that the emitter is cleaned up on the next (serial) update.
     if ( !mEmitters.empty() && destroyEmitter )
-        unload();
+    {
+        if ( mParentScene && mParentScene->isParallelUpdating() )
+            setUpdateThreadSafe( false );
+        else
+            unload();
+    
+    } // End if spent
 }
 
 //-----------------------------------------------------------------------------
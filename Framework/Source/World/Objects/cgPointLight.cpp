@@ -1235,6 +1235,25 @@ void cgPointLightNode::computeShadowSets( cgCameraNode * pCamera )
     } // End if shadow caster
 }
 
+//-----------------------------------------------------------------------------
+//  Name : collectShadowGenerators( ) (Virtual)
+/// <summary>
+/// Append the shadow generators whose visibility sets will be computed
+/// during the next call to computeShadowSets() to the specified list.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgPointLightNode::collectShadowGenerators( ShadowGeneratorArray & generators )
+{
+    if ( !isShadowSource() )
+        return;
+    for ( cgInt i = 0; i < 6; ++i )
+    {
+        if ( mFrustums[i] )
+            generators.push_back( mFrustums[i] );
+    
+    } // Next frustum
+}
+
 //-----------------------------------------------------------------------------
 //  Name : computeLevelOfDetail () (Virtual)
 /// <summary>
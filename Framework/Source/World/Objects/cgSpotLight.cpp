@@ -1851,6 +1851,19 @@ void cgSpotLightNode::computeShadowSets( cgCameraNode * pCamera )
     } // End if shadow caster
 }
 
+//-----------------------------------------------------------------------------
+//  Name : collectShadowGenerators( ) (Virtual)
+/// <summary>
+/// Append the shadow generators whose visibility sets will be computed
+/// during the next call to computeShadowSets() to the specified list.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSpotLightNode::collectShadowGenerators( ShadowGeneratorArray & generators )
+{
+    if ( isShadowSource() && mShadowFrustum )
+        generators.push_back( mShadowFrustum );
+}
+
 //-----------------------------------------------------------------------------
 //  Name : computeLevelOfDetail () (Virtual)
 /// <summary>
@@ -31,6 +31,8 @@
 #include <Math/cgCollision.h>
 #include <Math/cgMathUtility.h>
 #include <Math/cgBoundingSphere.h>
+#include <System/cgJobSystem.h>
+#include <algorithm>
 
 ///////////////////////////////////////////////////////////////////////////////
 // cgBSPTree Member Definitions
@@ -45,6 +47,9 @@ cgBSPTree::cgBSPTree( )
     mSplitterSample = 120;
     mSplitHeuristic = 2.0f;
     mInputWindings  = CG_NULL;
+    mPVSProgress        = CG_NULL;
+    mPVSProgressContext = CG_NULL;
+    mPVSCancelled       = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -151,6 +156,33 @@ const cgBSPTree::PointArray & cgBSPTree::getPortalVertices( ) const
     return mPortalVertices;
 }
 
+//-----------------------------------------------------------------------------
+// Name : setPVSProgressCallback ()
+/// <summary>
+/// Set the function that should be called periodically during PVS
+/// compilation in order to report the number of portals processed so far.
+/// The callback is always issued on the thread that called compilePVS().
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBSPTree::setPVSProgressCallback( PVSProgressFunc callback, void * context )
+{
+    mPVSProgress        = callback;
+    mPVSProgressContext = context;
+}
+
+//-----------------------------------------------------------------------------
+// Name : cancelPVS ()
+/// <summary>
+/// Request that any PVS compilation currently in progress be abandoned at the
+/// next opportunity. May be called from any thread (including from within
+/// the progress callback) and causes compilePVS() to return false.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBSPTree::cancelPVS( )
+{
+    mPVSCancelled = true;
+}
+
 //-----------------------------------------------------------------------------
 // Name : releaseWindings ( ) (Protected)
 /// <summary>
@@ -471,6 +503,7 @@ bool cgBSPTree::isVolumeVisible( cgUInt32 nodeIndex, cgByte * leafVisData, const
 bool cgBSPTree::compilePVS( )
 {
     size_t totalVertices = 0;
+    mPVSCancelled = false;
 
     // ToDo: Modify winding to just store the points. InputVertices array gets out of hand during portal generation.
 
@@ -535,15 +568,24 @@ bool cgBSPTree::compilePVS( )
     mPVSBytesPerSet = (mLeaves.size() + 7) / 8;
 	mPVSBytesPerSet = (mPVSBytesPerSet * 3 + 3) & 0xFFFFFFFC;
 
+    // Allocate scratch memory for every thread that may take part.
+    PVSScratchArray scratch( cgJobSystem::getWorkerCount() + 1 );
+    for ( size_t i = 0; i < scratch.size(); ++i )
+        scratch[i] = new PVSScratch();
+
     // Retrieve all of our one way portals
     PVSPortalArray portals;
 	generatePVSPortals( portals );
     
-    // Calculate initial portal visibility
-    initialPortalVis( portals );
-    
-    // Perform actual full PVS calculation
-    calculatePortalVis( portals );
+    // Calculate initial portal visibility, followed by the actual full
+    // PVS calculation.
+    const bool success = initialPortalVis( portals, scratch ) && calculatePortalVis( portals, scratch );
+
+    // Release scratch memory.
+    for ( size_t i = 0; i < scratch.size(); ++i )
+        delete scratch[i];
+    if ( !success )
+        return false;
 
     // Just use possible vis.
     /*for ( size_t i = 0; i < portals.size(); ++i )
@@ -658,70 +700,97 @@ cgUInt32 cgBSPTree::compressLeafSet( cgByte masterPVS[], const cgByte visArray[]
 // Name : calculatePortalVis() (Protected)
 /// <summary>
 /// Top level PVS calculation function which starts the recursion for each 
-/// portal.
+/// portal. Portals are processed in order of complexity so that the least
+/// complex portals are completed first, and their final visibility can be used
+/// by the early out system in recursePVS to help speed things up. Each batch
+/// of portals is distributed across any available job system worker threads.
+/// Portals in a batch only rely on the final visibility of earlier batches, 
+/// so the result is identical irrespective of the number of threads.
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgBSPTree::calculatePortalVis( PVSPortalArray & portals )
+bool cgBSPTree::calculatePortalVis( PVSPortalArray & portals, PVSScratchArray & scratch )
 {
-    PVSData data;
+    // Sort portals by complexity, retaining index order for equal complexity.
+    const cgUInt32 portalCount = (cgUInt32)portals.size();
+    cgArray<cgUInt64> sortKeys( portalCount );
+    for ( cgUInt32 i = 0; i < portalCount; ++i )
+        sortKeys[i] = (((cgUInt64)portals[i].possibleVisCount) << 32) | i;
+    std::sort( sortKeys.begin(), sortKeys.end() );
+    cgUInt32Array order( portalCount );
+    for ( cgUInt32 i = 0; i < portalCount; ++i )
+        order[i] = (cgUInt32)(sortKeys[i] & 0xFFFFFFFF);
 
     // Lets process those portal bad boys!! ;)
-    for ( cgUInt32 i = getNextPVSPortal( portals ); i != cgUInt32(-1); i = getNextPVSPortal( portals ) )
+    PVSBatchData data;
+    data.tree    = this;
+    data.portals = &portals;
+    data.scratch = &scratch;
+    data.order   = (portalCount) ? &order[0] : CG_NULL;
+    for ( cgUInt32 first = 0; first < portalCount; first += PVSBatchSize )
     {
-        PVSPortal & portal = portals[i];
-
-        // Fill our our initial data structure
-        data.sourcePoints = portal.points;
-        data.visBits      = portal.possibleVis;
-        data.targetPlane  = getPVSPortalPlane( portal );
-	    
-        // Allocate the portal's actual visibility array
-        portal.actualVis.resize( mPVSBytesPerSet, 0 );
-        
-        // Step in and begin processing this portal
-        recursePVS( portals, portal.leaf, portal, data );
-        
-        // We've finished processing this portal
-        portal.status = Processed;
+        // Abort if requested.
+        if ( mPVSCancelled )
+            return false;
 
-    } // Next portal
+        // Process the batch. Portal complexity varies wildly, so
+        // hand out one portal at a time.
+        cgUInt32 count = portalCount - first;
+        if ( count > PVSBatchSize )
+            count = PVSBatchSize;
+        data.first = first;
+        cgJobSystem::parallelFor( count, 1, calculatePortalVisRange, &data );
+
+        // We've finished processing these portals, their actual 
+        // visibility can now be used by subsequent batches.
+        for ( cgUInt32 i = first; i < first + count; ++i )
+            portals[order[i]].status = Processed;
+
+        // Report progress.
+        if ( mPVSProgress )
+            mPVSProgress( this, first + count, portalCount, mPVSProgressContext );
+
+    } // Next batch
+
+    // Success?
+    return !mPVSCancelled;
 }
 
 //-----------------------------------------------------------------------------
-// Name : getNextPVSPortal() (Protected)
+// Name : calculatePortalVisRange() (Protected, Static)
 /// <summary>
-/// Function that returns the next portal in order of complexity. This ensures
-/// that all the least complex portals are processed first so that these 
-/// portal's vis info can be used in the early out system in recursePVS to help 
-/// speed things up.
+/// Job system callback that computes the final visibility for the specified
+/// range of the current portal batch.
 /// </summary>
 //-----------------------------------------------------------------------------
-cgUInt32 cgBSPTree::getNextPVSPortal( PVSPortalArray & portals )
+void cgBSPTree::calculatePortalVisRange( cgUInt32 first, cgUInt32 last, void * context )
 {
-    // ToDo: optimize by having dedicated unprocessed list separate from processed.
-    cgUInt32 portalIndex = cgUInt32(-1), minVis = 9999999;
-	
-    // Loop through all portals
-	for ( size_t i = 0; i < portals.size(); ++i ) 
-    {
-        // If this portal's complexity is the lowest and it has 
-        // not already been processed then we could use it.
-        const PVSPortal & portal = portals[i];
-		if ( portal.status == Unprocessed && portal.possibleVisCount < minVis ) 
-        {
-			minVis = portal.possibleVisCount;
-			portalIndex = i;
-
-		} // End if less complex
-
-	} // Next portal
+    PVSBatchData * data = (PVSBatchData*)context;
+    PVSScratch & scratch = *(*data->scratch)[ cgJobSystem::getThreadIndex() ];
+    for ( cgUInt32 i = first; i < last && !data->tree->mPVSCancelled; ++i )
+        data->tree->calculatePortalVis( *data->portals, data->order[ data->first + i ], scratch );
+}
 
-	// Set the status flag of the selected portal to 'being worked on'.
-    if ( portalIndex != cgUInt32(-1) )
-        portals[portalIndex].status = Processing;
+//-----------------------------------------------------------------------------
+// Name : calculatePortalVis() (Protected)
+/// <summary>
+/// Compute the final visibility for the specified portal.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBSPTree::calculatePortalVis( PVSPortalArray & portals, cgUInt32 portalIndex, PVSScratch & scratch )
+{
+    PVSData data;
+    PVSPortal & portal = portals[portalIndex];
 
-    // Return the next portal
-	return portalIndex;
+    // Fill our our initial data structure
+    data.sourcePoints = portal.points;
+    data.visBits      = portal.possibleVis;
+    data.targetPlane  = getPVSPortalPlane( portal );
+    
+    // Allocate the portal's actual visibility array
+    portal.actualVis.resize( mPVSBytesPerSet, 0 );
+    
+    // Step in and begin processing this portal
+    recursePVS( portals, portal.leaf, portal, data, scratch );
 }
 
 //-----------------------------------------------------------------------------
@@ -730,7 +799,7 @@ cgUInt32 cgBSPTree::getNextPVSPortal( PVSPortalArray & portals )
 /// TODO
 /// </summary>
 //-----------------------------------------------------------------------------
-cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * points, const cgPlane & plane, bool keepOnPlane )
+cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * points, const cgPlane & plane, bool keepOnPlane, PVSScratch & scratch )
 {
     switch ( cgCollision::polyClassifyPlane( points->vertices, points->vertexCount, sizeof(cgVector3), (cgVector3&)plane, plane.d, CGE_EPSILON_1MM ) )
     {
@@ -745,7 +814,7 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * p
 
         case cgPlaneQuery::Spanning:
         {
-            static cgArray<cgPlaneQuery::Class> pointLocation;
+            cgArray<cgPlaneQuery::Class> & pointLocation = scratch.pointLocation;
             if ( pointLocation.size() < points->vertexCount )
             {
                 pointLocation.clear();
@@ -777,7 +846,7 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * p
 	        } // Next Vertex
 
             // Allocate space for split winding fragments
-            static PointArray frontVerts;
+            PointArray & frontVerts = scratch.frontVerts;
             if ( frontVerts.size() < (points->vertexCount + 1) )
             {
                 frontVerts.clear();
@@ -814,10 +883,7 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * p
             } // Next Vertex
 
             // Build the new points and return them.
-            PVSPortalPoints * frontSplit = new PVSPortalPoints();
-            frontSplit->ownsVertices    = true;
-            frontSplit->vertexCount     = frontCount;
-            frontSplit->vertices        = new cgVector3[ frontCount ];
+            PVSPortalPoints * frontSplit = allocatePVSPortalPoints( scratch, frontCount );
             memcpy( frontSplit->vertices, &frontVerts[0], frontCount * sizeof(cgVector3) );
             return frontSplit;
 
@@ -834,7 +900,7 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipPVSPortalPoints( PVSPortalPoints * p
 /// PVS recursion function, steps through the portals and calcs true visibility
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPortal & sourcePortal, PVSData & prevData )
+void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPortal & sourcePortal, PVSData & prevData, PVSScratch & scratch )
 {
     // Mark this leaf as visible.
     setPVSBit( &sourcePortal.actualVis[0], leafIndex );
@@ -897,9 +963,9 @@ void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPor
              continue;
 
         // Clip the generator portal to the source. If none remains, continue.
-        PVSPortalPoints * generatorPoints = clipPVSPortalPoints( generatorPortal.points, sourcePlane, false );
+        PVSPortalPoints * generatorPoints = clipPVSPortalPoints( generatorPortal.points, sourcePlane, false, scratch );
         if ( generatorPoints != generatorPortal.points ) 
-            releasePVSPortalPoints( generatorPortal.points );
+            releasePVSPortalPoints( generatorPortal.points, scratch );
         if ( !generatorPoints )
             continue;
 
@@ -908,74 +974,68 @@ void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPor
         {
             data.sourcePoints = prevData.sourcePoints;
             data.targetPoints = generatorPoints;
-            recursePVS( portals, generatorPortal.leaf, sourcePortal, data );
-            releasePVSPortalPoints( generatorPoints );
+            recursePVS( portals, generatorPortal.leaf, sourcePortal, data, scratch );
+            releasePVSPortalPoints( generatorPoints, scratch );
             continue;
 
         } // End if Previous Points
 
         // Clip the generator portal to the previous target. If none remains, continue.
-        PVSPortalPoints * newPoints = clipPVSPortalPoints( generatorPoints, prevData.targetPlane, false );
+        PVSPortalPoints * newPoints = clipPVSPortalPoints( generatorPoints, prevData.targetPlane, false, scratch );
         if ( newPoints != generatorPoints ) 
-            releasePVSPortalPoints( generatorPoints );
+            releasePVSPortalPoints( generatorPoints, scratch );
         generatorPoints = newPoints;
         if ( !generatorPoints )
             continue;
 
         // Make a copy of the source portals points
-        PVSPortalPoints * sourcePoints = new PVSPortalPoints();
+        PVSPortalPoints * sourcePoints = allocatePVSPortalPoints( scratch, (prevData.sourcePoints) ? prevData.sourcePoints->vertexCount : 0 );
         if ( prevData.sourcePoints )
-        {
-            sourcePoints->ownsVertices = true;
-            sourcePoints->vertexCount = prevData.sourcePoints->vertexCount;
-            sourcePoints->vertices = new cgVector3[ sourcePoints->vertexCount ];
             memcpy( sourcePoints->vertices, prevData.sourcePoints->vertices, sourcePoints->vertexCount * sizeof(cgVector3) );
-        
-        } // End if deep copy
 
         // Clip the source portal
-        newPoints = clipPVSPortalPoints( sourcePoints, reverseGenPlane, false );
+        newPoints = clipPVSPortalPoints( sourcePoints, reverseGenPlane, false, scratch );
         if ( newPoints != sourcePoints )
-            releasePVSPortalPoints( sourcePoints );
+            releasePVSPortalPoints( sourcePoints, scratch );
         sourcePoints = newPoints;
 
         // If none remains, continue to the next portal
         if ( !sourcePoints)
         {
-            releasePVSPortalPoints( generatorPoints );
+            releasePVSPortalPoints( generatorPoints, scratch );
             continue;
         
         } // End if no source
 
         // Lets go Clipping :)
-        generatorPoints = clipToAntiPenumbra( sourcePoints, prevData.targetPoints, generatorPoints, false ); 
+        generatorPoints = clipToAntiPenumbra( sourcePoints, prevData.targetPoints, generatorPoints, false, scratch ); 
         if ( !generatorPoints )
         {
-            releasePVSPortalPoints( sourcePoints );
+            releasePVSPortalPoints( sourcePoints, scratch );
             continue;
         
         } // End if exhausted
         
-        generatorPoints = clipToAntiPenumbra( prevData.targetPoints, sourcePoints, generatorPoints, true ); 
+        generatorPoints = clipToAntiPenumbra( prevData.targetPoints, sourcePoints, generatorPoints, true, scratch ); 
         if ( !generatorPoints )
         {
-            releasePVSPortalPoints( sourcePoints );
+            releasePVSPortalPoints( sourcePoints, scratch );
             continue;
         
         } // End if exhausted
         
-        sourcePoints = clipToAntiPenumbra( generatorPoints, prevData.targetPoints, sourcePoints, false ); 
+        sourcePoints = clipToAntiPenumbra( generatorPoints, prevData.targetPoints, sourcePoints, false, scratch ); 
         if ( !sourcePoints )
         {
-            releasePVSPortalPoints( generatorPoints );
+            releasePVSPortalPoints( generatorPoints, scratch );
             continue;
         
         } // End if exhausted
         
-        sourcePoints = clipToAntiPenumbra( prevData.targetPoints, generatorPoints, sourcePoints, true ); 
+        sourcePoints = clipToAntiPenumbra( prevData.targetPoints, generatorPoints, sourcePoints, true, scratch ); 
         if ( !sourcePoints )
         {
-            releasePVSPortalPoints( generatorPoints );
+            releasePVSPortalPoints( generatorPoints, scratch );
             continue;
         
         } // End if exhausted
@@ -985,11 +1045,11 @@ void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPor
         data.targetPoints = generatorPoints;
 
         // Flow through it for real
-        recursePVS( portals, generatorPortal.leaf, sourcePortal, data );
+        recursePVS( portals, generatorPortal.leaf, sourcePortal, data, scratch );
 
         // Clean up
-        releasePVSPortalPoints( sourcePoints );
-        releasePVSPortalPoints( generatorPoints );
+        releasePVSPortalPoints( sourcePoints, scratch );
+        releasePVSPortalPoints( generatorPoints, scratch );
 
     } // Next portal
 }
@@ -1000,7 +1060,7 @@ void cgBSPTree::recursePVS( PVSPortalArray & portals, cgUInt32 leafIndex, PVSPor
 /// Clips the portals to one another using the generated anti-penumbra.
 /// </summary>
 //-------------------------------------------------------------------------------------
-cgBSPTree::PVSPortalPoints * cgBSPTree::clipToAntiPenumbra( PVSPortalPoints * source, PVSPortalPoints * target, PVSPortalPoints * generator, bool reverseClip )
+cgBSPTree::PVSPortalPoints * cgBSPTree::clipToAntiPenumbra( PVSPortalPoints * source, PVSPortalPoints * target, PVSPortalPoints * generator, bool reverseClip, PVSScratch & scratch )
 {
     cgPlane plane;
 
@@ -1104,9 +1164,9 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipToAntiPenumbra( PVSPortalPoints * so
                 plane = -plane;
 
             // Clip the target by the separating plane
-            PVSPortalPoints * newPoints = clipPVSPortalPoints( generator, plane, false );
+            PVSPortalPoints * newPoints = clipPVSPortalPoints( generator, plane, false, scratch );
             if ( newPoints != generator )
-                releasePVSPortalPoints( generator );
+                releasePVSPortalPoints( generator, scratch );
             generator = newPoints;
 
             // Target is not visible ?
@@ -1121,17 +1181,55 @@ cgBSPTree::PVSPortalPoints * cgBSPTree::clipToAntiPenumbra( PVSPortalPoints * so
     return generator;
 }
 
+//-----------------------------------------------------------------------------
+// Name : allocatePVSPortalPoints() (Static, Protected)
+/// <summary>
+/// Allocate a set of portal points with room for at least the specified 
+/// number of vertices, recycling those previously released to the supplied
+/// per-thread scratch data where possible.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgBSPTree::PVSPortalPoints * cgBSPTree::allocatePVSPortalPoints( PVSScratch & scratch, cgUInt32 vertexCount )
+{
+    PVSPortalPoints * points;
+    if ( !scratch.freePoints.empty() )
+    {
+        points = scratch.freePoints.back();
+        scratch.freePoints.pop_back();
+    
+    } // End if recycle
+    else
+    {
+        points = new PVSPortalPoints();
+    
+    } // End if allocate
+
+    // Grow the vertex buffer if it is too small.
+    if ( points->vertexCapacity < vertexCount )
+    {
+        if ( points->ownsVertices )
+            delete []points->vertices;
+        points->vertices        = new cgVector3[ vertexCount ];
+        points->vertexCapacity  = vertexCount;
+        points->ownsVertices    = true;
+    
+    } // End if too small
+    points->vertexCount = vertexCount;
+    return points;
+}
+
 //-----------------------------------------------------------------------------
 // Name : releasePVSPortalPoints() (Static, Protected)
 /// <summary>
 /// Releases a set of portal points only if it is not owned by a physical 
-/// portal.
+/// portal. Released points are returned to the per-thread scratch data for
+/// reuse rather than being destroyed.
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgBSPTree::releasePVSPortalPoints( PVSPortalPoints * points )
+void cgBSPTree::releasePVSPortalPoints( PVSPortalPoints * points, PVSScratch & scratch )
 {
     if ( points && !points->ownerPortal )
-        delete points;
+        scratch.freePoints.push_back( points );
 }
 
 //-----------------------------------------------------------------------------
@@ -1180,74 +1278,107 @@ void cgBSPTree::generatePVSPortals( PVSPortalArray & portals )
 // Name : initialPortalVis () (Protected)
 /// <summary>
 /// Performs the first set of visibility calculations between portals. This is 
-/// essentially a pre-process to speed up the main PVS processing.
+/// essentially a pre-process to speed up the main PVS processing. Each portal
+/// is independent of all others, so the work is distributed across any 
+/// available job system worker threads.
 /// </summary>
 //-----------------------------------------------------------------------------
-void cgBSPTree::initialPortalVis( PVSPortalArray & portals )
+bool cgBSPTree::initialPortalVis( PVSPortalArray & portals, PVSScratchArray & scratch )
+{
+    PVSBatchData data;
+    data.tree    = this;
+    data.portals = &portals;
+    data.scratch = &scratch;
+    data.order   = CG_NULL;
+    data.first   = 0;
+    cgJobSystem::parallelFor( (cgUInt32)portals.size(), 0, initialPortalVisRange, &data );
+    return !mPVSCancelled;
+}
+
+//-----------------------------------------------------------------------------
+// Name : initialPortalVisRange () (Protected, Static)
+/// <summary>
+/// Job system callback that computes the initial visibility for the 
+/// specified range of portals.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBSPTree::initialPortalVisRange( cgUInt32 first, cgUInt32 last, void * context )
+{
+    PVSBatchData * data = (PVSBatchData*)context;
+    PVSScratch & scratch = *(*data->scratch)[ cgJobSystem::getThreadIndex() ];
+    for ( cgUInt32 i = first; i < last && !data->tree->mPVSCancelled; ++i )
+        data->tree->initialPortalVis( *data->portals, i, scratch );
+}
+
+//-----------------------------------------------------------------------------
+// Name : initialPortalVis () (Protected)
+/// <summary>
+/// Compute the initial (possible) visibility for the specified portal.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgBSPTree::initialPortalVis( PVSPortalArray & portals, cgUInt32 portalIndex, PVSScratch & scratch )
 {
     // Allocate temporary visibility buffer
-    cgByteArray portalVis( portals.size() );
+    cgByteArray & portalVis = scratch.portalVis;
+    if ( portalVis.size() < portals.size() )
+        portalVis.resize( portals.size() );
+
+    // Check portal visibility against every other portal
+    const size_t p1 = portalIndex;
+    PVSPortal & portal1 = portals[p1];
+    const cgPlane plane1 = getPVSPortalPlane( portal1 );
 
-    // Loop through the portal array allocating and checking 
-    // portal visibility against every other portal
-    for ( size_t p1 = 0; p1 < portals.size(); ++p1 ) 
+    // Allocate memory for portal visibility info
+    portal1.possibleVis.resize( mPVSBytesPerSet, 0 );
+    
+    // Clear temporary buffer
+    memset( &portalVis[0], 0, portals.size() );
+    
+    // For this portal, loop through all other portals
+    for ( size_t p2 = 0; p2 < portals.size(); ++p2 ) 
     {
-        PVSPortal & portal1 = portals[p1];
-        const cgPlane plane1 = getPVSPortalPlane( portal1 );
+        // Don't test against self
+        if ( p2 == p1 )
+            continue;
 
-        // Allocate memory for portal visibility info
-        portal1.possibleVis.resize( mPVSBytesPerSet, 0 );
+        // Test to see if any of p2's points are in front of p1's plane
+        size_t i;
+        PVSPortal & portal2 = portals[p2];
+        const cgPlane plane2 = getPVSPortalPlane( portal2 );
+        for ( i = 0; i < portal2.points->vertexCount; ++i ) 
+        {
+            if ( cgCollision::pointClassifyPlane( portal2.points->vertices[i], (cgVector3&)plane1, plane1.d, CGE_EPSILON_1MM ) == cgPlaneQuery::Front ) 
+                break;
         
-        // Clear temporary buffer
-        memset( &portalVis[0], 0, portals.size() );
+        } // Next vertex
+
+        // If the loop reached the end, there were no points in front so continue
+        if ( i == portal2.points->vertexCount )
+            continue;
         
-        // For this portal, loop through all other portals
-        for ( size_t p2 = 0; p2 < portals.size(); ++p2 ) 
+        // Test to see if any of p1's portal points are behind p2's plane.
+        for ( i = 0; i < portal1.points->vertexCount; ++i ) 
         {
-            // Don't test against self
-            if ( p2 == p1 )
-                continue;
-
-            // Test to see if any of p2's points are in front of p1's plane
-            size_t i;
-            PVSPortal & portal2 = portals[p2];
-            const cgPlane plane2 = getPVSPortalPlane( portal2 );
-            for ( i = 0; i < portal2.points->vertexCount; ++i ) 
-            {
-                if ( cgCollision::pointClassifyPlane( portal2.points->vertices[i], (cgVector3&)plane1, plane1.d, CGE_EPSILON_1MM ) == cgPlaneQuery::Front ) 
-                    break;
-            
-            } // Next vertex
-
-            // If the loop reached the end, there were no points in front so continue
-            if ( i == portal2.points->vertexCount )
-                continue;
-            
-            // Test to see if any of p1's portal points are behind p2's plane.
-            for ( i = 0; i < portal1.points->vertexCount; ++i ) 
-            {
-                if ( cgCollision::pointClassifyPlane( portal1.points->vertices[i], (cgVector3&)plane2, plane2.d, CGE_EPSILON_1MM ) == cgPlaneQuery::Back )
-                    break;
-            
-            } // Next Portal Vertex
-
-            // If the loop reached the end, there were no points in front so continue
-            if ( i == portal1.points->vertexCount )
-                continue;
+            if ( cgCollision::pointClassifyPlane( portal1.points->vertices[i], (cgVector3&)plane2, plane2.d, CGE_EPSILON_1MM ) == cgPlaneQuery::Back )
+                break;
+        
+        } // Next Portal Vertex
 
-            // Fill out the temporary portal visibility array
-            portalVis[p2] = 1;		
+        // If the loop reached the end, there were no points in front so continue
+        if ( i == portal1.points->vertexCount )
+            continue;
 
-        } // Next Portal 2
+        // Fill out the temporary portal visibility array
+        portalVis[p2] = 1;		
 
-        // Now flood through all the portals which are visible
-        // from the source portal through into the neighbour leaf
-        // and flag any leaves which are visible (the leaves which
-        // remain set to 0 can never possibly be seen from this portal)
-        portal1.possibleVisCount = 0;
-        portalFlood( portals, portal1, &portalVis[0], portal1.leaf );
+    } // Next Portal 2
 
-    } // Next portal
+    // Now flood through all the portals which are visible
+    // from the source portal through into the neighbour leaf
+    // and flag any leaves which are visible (the leaves which
+    // remain set to 0 can never possibly be seen from this portal)
+    portal1.possibleVisCount = 0;
+    portalFlood( portals, portal1, &portalVis[0], portal1.leaf );
 }
 
 //-----------------------------------------------------------------------------
@@ -28,6 +28,7 @@
 #include <World/cgLandscape.h>
 #include <World/cgScene.h>
 #include <World/Objects/cgCameraObject.h>
+#include <World/Elements/cgNavigationMeshElement.h>
 #include <Resources/cgResourceManager.h>
 #include <Resources/cgLandscapeLayerMaterial.h>
 #include <Resources/cgHeightMap.h>
@@ -46,6 +47,9 @@
 #include <Math/cgCollision.h>
 #include <Math/cgMathUtility.h>
 #include <System/cgImage.h>
+#include <System/cgThreading.h>
+#include <System/cgTimer.h>
+#include <System/cgTraceProfiler.h>
 
 //-----------------------------------------------------------------------------
 // Module Local Structures
@@ -90,7 +94,9 @@ cgWorldQuery cgLandscape::mDeleteProceduralLayers;
 cgWorldQuery cgLandscape::mUpdateProceduralLayer;
 cgWorldQuery cgLandscape::mLoadLandscape;
 cgWorldQuery cgLandscape::mLoadTerrainBlocks;
+cgWorldQuery cgLandscape::mLoadTerrainBlockIds;
 cgWorldQuery cgLandscape::mLoadProceduralLayers;
+cgLandscapeStreamingConfig cgLandscape::mDefaultStreamingConfig;
 cgWorldQuery cgTerrainBlock::mInsertBlock;
 cgWorldQuery cgTerrainBlock::mInsertBlockLOD;
 cgWorldQuery cgTerrainBlock::mUpdateBlockHeights;
@@ -149,6 +155,11 @@ cgLandscape::cgLandscape( cgScene * pScene ) : cgSpatialTree( )
     mNextOcclusionTest  = 0;
     mOcclusionCull      = true;
     mIsPainting         = false;
+    mStreamingConfig    = mDefaultStreamingConfig;
+    mStreamThread       = CG_NULL;
+    mStreamSection      = CG_NULL;
+    mStreamEvent        = CG_NULL;
+    mStreamPendingCount = 0;
 
     // Clear arrays
     memset( mLayerColorSamplers, 0, 4 * sizeof(cgSampler*) );
@@ -195,6 +206,11 @@ cgLandscape::~cgLandscape()
 //-----------------------------------------------------------------------------
 void cgLandscape::dispose( bool bDisposeBase )
 {
+    // Shut down the block streaming thread (if running).
+    endStreaming();
+    mBlockStreamInfo.clear();
+    mStreamingStats = cgLandscapeStreamingStats();
+
     // Destroy any active terrain blocks.
     for ( size_t i = 0; i < mTerrainBlocks.size(); ++i )
         delete mTerrainBlocks[i];
@@ -222,6 +238,7 @@ void cgLandscape::dispose( bool bDisposeBase )
     mMipLookUp.clear();
 
     // Destroy any resident heightmap data
+    mHeightPyramid.clear();
     delete mHeightMap;
     mHeightMap = CG_NULL;
 
@@ -356,7 +373,17 @@ bool cgLandscape::load( cgUInt32 nLandscapeId )
     setDimensions( mDimensions, false );
 
     // Allocate enough space for every terrain block instance
+    BlockStreamInfo DefaultInfo;
+    DefaultInfo.blockId     = 0;
+    DefaultInfo.state       = StreamNotResident;
+    DefaultInfo.requestTime = 0;
     mTerrainBlocks.resize( mBlockLayout.width * mBlockLayout.height, CG_NULL );
+    mBlockStreamInfo.resize( mBlockLayout.width * mBlockLayout.height, DefaultInfo );
+
+    // Blocks will be streamed in on demand if requested (never in sandbox mode).
+    if ( cgGetSandboxMode() == cgSandboxMode::Enabled )
+        mStreamingConfig.enabled = false;
+    bool bStreaming = mStreamingConfig.enabled;
 
     // Calculate the total number of LOD levels that can be generated from the specified block sizes
     nTemp = min( mBlockSize.width, mBlockSize.height ) - 1;
@@ -389,49 +416,47 @@ bool cgLandscape::load( cgUInt32 nLandscapeId )
     mHeightMap = new cgHeightMap( MapSize );
     mColorMap.resize( MapSize.width * MapSize.height, 0xFFFFFFFF );
 
-    // Load terrain blocks
-    mLoadTerrainBlocks.bindParameter( 1, nLandscapeId );
-    if ( !mLoadTerrainBlocks.step( ) )
+    // Load terrain blocks. When streaming, only the identifiers of the blocks
+    // that exist are read here and their data is loaded later on demand.
+    cgWorldQuery & BlockQuery = (bStreaming) ? mLoadTerrainBlockIds : mLoadTerrainBlocks;
+    BlockQuery.bindParameter( 1, nLandscapeId );
+    if ( !BlockQuery.step( ) )
     {
         // Log any error.
         cgString strError;
-        if ( !mLoadTerrainBlocks.getLastError( strError ) )
+        if ( !BlockQuery.getLastError( strError ) )
             cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve block data for landscape '0x%x'. World database has potentially become corrupt.\n"), nLandscapeId );
         else
             cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve block data for landscape '0x%x'. Error: %s\n"), nLandscapeId, strError.c_str() );
 
         // Release any pending read operation.
-        mLoadTerrainBlocks.reset();
+        BlockQuery.reset();
         return false;
     
     } // End if failed
 
     // Process terrain block data.
-    for ( ; mLoadTerrainBlocks.nextRow(); )
+    for ( ; BlockQuery.nextRow(); )
     {
         cgInt32 nBlockIndex = 0;
-        if ( !mLoadTerrainBlocks.getColumn( _T("BlockIndex"), nBlockIndex ) )
+        if ( !BlockQuery.getColumn( _T("BlockIndex"), nBlockIndex ) )
             continue;
-        
-        // Compute the location of this block based on its index.
-        cgInt32 x = nBlockIndex % mBlockLayout.width;
-        cgInt32 z = nBlockIndex / mBlockLayout.width;
-
-        // Construct terrain block initialization information.
-        cgTerrainBlock::TerrainSection Section;
-        Section.heightMapBuffer = &mHeightMap->getImageData()[0];
-        Section.blockBounds.left     = x * (mBlockSize.width - 1);
-        Section.blockBounds.top      = z * (mBlockSize.height - 1);
-        Section.blockBounds.right    = ((x + 1) * (mBlockSize.width - 1)) + 1;
-        Section.blockBounds.bottom   = ((z + 1) * (mBlockSize.height - 1)) + 1;
-        Section.blockBounds.pitchX   = MapSize.width;
-        Section.blockBounds.pitchY   = MapSize.height;
 
+        // Just record the existence of the block if it is to be streamed.
+        if ( bStreaming )
+        {
+            BlockQuery.getColumn( _T("BlockId"), mBlockStreamInfo[ nBlockIndex ].blockId );
+            continue;
+        
+        } // End if streaming
+        
         // Create the block
-        cgTerrainBlock * pBlock = new cgTerrainBlock( this, nBlockIndex, Section );
-        if ( !pBlock->loadBlock( mLoadTerrainBlocks ) )
+        cgTerrainBlock * pBlock = createBlock( nBlockIndex );
+        if ( !pBlock->loadBlock( BlockQuery ) )
         {
-            cgAppLog::write( cgAppLog::Debug | cgAppLog::Warning, _T("Failed to load terrain block at location %i, %i.\n"), x, z );
+            cgAppLog::write( cgAppLog::Debug | cgAppLog::Warning, _T("Failed to load terrain block at location %i, %i.\n"), 
+                             nBlockIndex % mBlockLayout.width, nBlockIndex / mBlockLayout.width );
+            delete pBlock;
             continue;
         
         } // End if failed
@@ -445,11 +470,22 @@ bool cgLandscape::load( cgUInt32 nLandscapeId )
 
         // Store terrain block in main array
         mTerrainBlocks[ nBlockIndex ] = pBlock;
+        mBlockStreamInfo[ nBlockIndex ].blockId = pBlock->getDatabaseId();
+        mBlockStreamInfo[ nBlockIndex ].state   = StreamResident;
 
     } // Next Block
 
     // We're done with the block read query.
-    mLoadTerrainBlocks.reset();
+    BlockQuery.reset();
+
+    // The actual height range of non-resident blocks is unknown, so the landscape 
+    // bounds must conservatively cover the full range of representable heights.
+    if ( bStreaming )
+    {
+        mBounds.min = cgVector3( mOffset.x, mOffset.y + (cgFloat)cgHeightMap::MinCellHeight * mScale.y, mOffset.z - mDimensions.z );
+        mBounds.max = cgVector3( mOffset.x + mDimensions.x, mOffset.y + (cgFloat)cgHeightMap::MaxCellHeight * mScale.y, mOffset.z );
+    
+    } // End if streaming
 
     // Finally, set the terrain block neighbor information for LOD testing etc.
     for ( z = 0; z < mBlockLayout.height; ++z )
@@ -526,6 +562,9 @@ bool cgLandscape::load( cgUInt32 nLandscapeId )
     // We're done with the layer read query.
     mLoadProceduralLayers.reset();
 
+    // Build the height pyramid used for ray intersection.
+    buildHeightPyramid();
+
     // Perform post initialization tasks
     if ( !postInit() )
         return false;
@@ -533,6 +572,22 @@ bool cgLandscape::load( cgUInt32 nLandscapeId )
     // Generate initial normal map data.
     updateNormalTexture();
 
+    // Build the stand-in meshes drawn for each block until it is streamed in.
+    if ( bStreaming )
+    {
+        for ( size_t i = 0; i < mBlockStreamInfo.size(); ++i )
+        {
+            if ( mBlockStreamInfo[i].blockId != 0 )
+                buildBlockStandIn( (cgInt32)i );
+        
+        } // Next block
+
+    } // End if streaming
+
+    // Start streaming blocks in as required.
+    if ( bStreaming && !beginStreaming() )
+        return false;
+
     // Load success!
     mLandscapeId = nLandscapeId;
     return true;
@@ -598,6 +653,8 @@ void cgLandscape::prepareQueries()
         mLoadLandscape.prepare( pWorld, _T("SELECT * FROM 'Landscapes' WHERE LandscapeId=?1"), true );
     if ( !mLoadTerrainBlocks.isPrepared( pWorld ) )
         mLoadTerrainBlocks.prepare( pWorld, _T("SELECT * FROM 'Landscapes::Blocks' WHERE LandscapeId=?1"), true );
+    if ( !mLoadTerrainBlockIds.isPrepared( pWorld ) )
+        mLoadTerrainBlockIds.prepare( pWorld, _T("SELECT BlockId, BlockIndex FROM 'Landscapes::Blocks' WHERE LandscapeId=?1"), true );
     if ( !mLoadProceduralLayers.isPrepared( pWorld ) )
         mLoadProceduralLayers.prepare( pWorld, _T("SELECT * FROM 'Landscapes::ProceduralLayers' WHERE LandscapeId=?1 ORDER BY LayerIndex ASC"), true );
 }
@@ -801,7 +858,12 @@ bool cgLandscape::import( const cgLandscapeImportParams & Params )
     } // End if serialize
 
     // Allocate enough space for every terrain block instance
+    BlockStreamInfo DefaultInfo;
+    DefaultInfo.blockId     = 0;
+    DefaultInfo.state       = StreamNotResident;
+    DefaultInfo.requestTime = 0;
     mTerrainBlocks.resize( mBlockLayout.width * mBlockLayout.height, CG_NULL );
+    mBlockStreamInfo.resize( mBlockLayout.width * mBlockLayout.height, DefaultInfo );
     
     // Calculate the total number of LOD levels that can be generated from the specified block sizes
     nTemp = min( mBlockSize.width, mBlockSize.height ) - 1;
@@ -871,6 +933,8 @@ bool cgLandscape::import( const cgLandscapeImportParams & Params )
 
             // Store terrain block in main array
             mTerrainBlocks[ x + z * mBlockLayout.width ] = pBlock;
+            mBlockStreamInfo[ x + z * mBlockLayout.width ].blockId = pBlock->getDatabaseId();
+            mBlockStreamInfo[ x + z * mBlockLayout.width ].state   = StreamResident;
 
         } // Next Column
 
@@ -898,6 +962,9 @@ bool cgLandscape::import( const cgLandscapeImportParams & Params )
 
     } // Next Row
 
+    // Build the height pyramid used for ray intersection.
+    buildHeightPyramid();
+
     // Perform post initialization tasks
     if ( !postInit() )
     {
@@ -1529,9 +1596,9 @@ bool cgLandscape::buildTree( cgUInt32 nLevel, cgLandscapeSubNode * pNode, const
         if ( vBlock.x >= 0 && vBlock.x <= mBlockLayout.width &&
              vBlock.y >= 0 && vBlock.y <= mBlockLayout.height )
         {
-            // Terrain block actually exists here?
+            // Terrain block actually exists here (even if not currently resident)?
             nDataGroupId = (cgInt32)vBlock.x + (cgInt32)vBlock.y * mBlockLayout.width;
-            if ( mTerrainBlocks[nDataGroupId] == CG_NULL )
+            if ( mTerrainBlocks[nDataGroupId] == CG_NULL && mBlockStreamInfo[nDataGroupId].blockId == 0 )
                 nDataGroupId = -1;
 
         } // End if within bounds
@@ -1551,9 +1618,16 @@ bool cgLandscape::buildTree( cgUInt32 nLevel, cgLandscapeSubNode * pNode, const
         // Notify the node that it has been fully constructed
         pNode->nodeConstructed();
 
-        // Store the connection between the terrain block and the leaf
+        // Store the connection between the terrain block and the leaf. This
+        // is also retained separately so that it can be restored whenever a
+        // streamed block becomes resident.
         if ( nDataGroupId >= 0 )
-            mTerrainBlocks[nDataGroupId]->mLeafNodes.push_back( pNode );
+        {
+            mBlockStreamInfo[nDataGroupId].leafNodes.push_back( pNode );
+            if ( mTerrainBlocks[nDataGroupId] != CG_NULL )
+                mTerrainBlocks[nDataGroupId]->mLeafNodes.push_back( pNode );
+        
+        } // End if has block
         
         // We have reached a leaf, so we can stop compiling this tree branch
         return true;
@@ -1772,6 +1846,7 @@ bool cgLandscape::setDimensions( const cgVector3 & Dimensions, bool bRebuildTerr
     mScale.x = Dimensions.x / (cgFloat)(HeightMapSize.width-1);
     mScale.y = Dimensions.y / (cgFloat)(cgHeightMap::MaxCellHeight - cgHeightMap::MinCellHeight);
     mScale.z = Dimensions.z / (cgFloat)(HeightMapSize.height-1);
+    mHeightPyramid.setTransform( mOffset, mScale );
 
     // Rebuild all the terrain blocks?
     if ( bRebuildTerrain && !mTerrainBlocks.empty() )
@@ -1921,6 +1996,31 @@ bool cgLandscape::updateNormalTexture( cgRect rcUpdate )
     return true;
 }
 
+//-----------------------------------------------------------------------------
+// Name : buildHeightPyramid () (Protected)
+/// <summary>
+/// (Re)build the min / max height pyramid used to compute exact ray 
+/// intersections with the terrain. Only those areas of the heightmap 
+/// covered by existing terrain blocks are considered.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::buildHeightPyramid( )
+{
+    mHeightPyramid.clear();
+    if ( mHeightMap == CG_NULL || mHeightMap->getImageData().empty() )
+        return;
+
+    // Record which terrain blocks exist. Blocks that are not currently resident
+    // are included so that their placeholder heights can be intersected.
+    cgByteArray aBlockMask( mBlockLayout.width * mBlockLayout.height, 0 );
+    for ( size_t i = 0; i < aBlockMask.size() && i < mTerrainBlocks.size(); ++i )
+        aBlockMask[i] = (mTerrainBlocks[i] != CG_NULL || mBlockStreamInfo[i].blockId != 0) ? 1 : 0;
+
+    // Build the pyramid.
+    mHeightPyramid.setTransform( mOffset, mScale );
+    mHeightPyramid.build( &mHeightMap->getImageData()[0], mHeightMap->getSize(), mBlockSize, aBlockMask );
+}
+
 //-----------------------------------------------------------------------------
 // Name : buildMipLookUp () (Protected)
 /// <summary>
@@ -2403,7 +2503,7 @@ bool cgLandscape::renderPass( cgLandscapeRenderMethod::Base Pass, cgCameraNode *
     pDriver->setWorldTransform( CG_NULL );
 
     // Retrieve list of visible terrain blocks.
-    cgInt32Set & VisibleBlocks = pVisData->getVisibleGroups(this);
+    const cgInt32Array & VisibleBlocks = pVisData->getVisibleGroupArray(this);
 
     // Retrieve shader constant buffers ready for population.
     cgSurfaceShader * pShader = mLandscapeShader.getResource(true);
@@ -2504,11 +2604,17 @@ bool cgLandscape::renderPass( cgLandscapeRenderMethod::Base Pass, cgCameraNode *
         // Render entire (visible) terrain.
         if ( VisibleBlocks.empty() == false )
         {
-            cgInt32Set::const_iterator itGroup;
+            cgInt32Array::const_iterator itGroup;
             for ( itGroup = VisibleBlocks.begin(); itGroup != VisibleBlocks.end(); ++itGroup )
             {
                 cgTerrainBlock * pBlock = mTerrainBlocks[*itGroup];
-                if ( pBlock == CG_NULL ) continue;
+                if ( pBlock == CG_NULL )
+                {
+                    // Not resident, draw the coarse stand-in (if any) instead.
+                    drawBlockStandIn( pDriver, *itGroup );
+                    continue;
+                
+                } // End if not resident
             
                 // Just render the block
                 pBlock->draw( pDriver, cgTerrainBlock::Simple );
@@ -2532,7 +2638,7 @@ bool cgLandscape::renderPass( cgLandscapeRenderMethod::Base Pass, cgCameraNode *
         // Render each visible block using its paint map.
         if ( !VisibleBlocks.empty() )
         {
-            cgInt32Set::const_iterator itGroup;
+            cgInt32Array::const_iterator itGroup;
             for ( itGroup = VisibleBlocks.begin(); itGroup != VisibleBlocks.end(); ++itGroup )
             {
                 cgTerrainBlock * pBlock = mTerrainBlocks[*itGroup];
@@ -2699,7 +2805,7 @@ bool cgLandscape::renderPass( cgLandscapeRenderMethod::Base Pass, cgCameraNode *
                     if ( pBlock == CG_NULL ) continue;
 
                     // Skip if block is not visible
-                    if ( VisibleBlocks.find( pBlock->getBlockIndex() ) == VisibleBlocks.end() )
+                    if ( !pVisData->isGroupVisible( this, (cgInt32)pBlock->getBlockIndex() ) )
                         continue;
                     
                     // Render the block
@@ -2749,7 +2855,7 @@ bool cgLandscape::renderPass( cgLandscapeRenderMethod::Base Pass, cgCameraNode *
         // Render each visible block using its paint map.
         if ( !VisibleBlocks.empty() )
         {
-            cgInt32Set::const_iterator itGroup;
+            cgInt32Array::const_iterator itGroup;
             for ( itGroup = VisibleBlocks.begin(); itGroup != VisibleBlocks.end(); ++itGroup )
             {
                 cgTerrainBlock * pBlock = mTerrainBlocks[*itGroup];
@@ -2914,9 +3020,33 @@ bool cgLandscape::heightMapUpdated( const cgRect &rcUpdate )
     // Update the normal map
     updateNormalTexture( rcUpdate );
 
+    // Update the ray intersection height pyramid.
+    mHeightPyramid.update( rcUpdate );
+
     // Re-generate procedural rendering batches.
     batchProceduralDraws( );
 
+    // Navigation tiles covering the updated region of the height map must be
+    // rebuilt (padded by one sample to include the adjoining quads).
+    if ( mParentScene )
+    {
+        const cgSceneElementArray & elements = mParentScene->getSceneElementsByType( RTID_NavigationMeshElement );
+        if ( !elements.empty() )
+        {
+            cgBoundingBox region;
+            region.min.x = mOffset.x + (cgFloat)(rcUpdate.left - 1) * mScale.x;
+            region.max.x = mOffset.x + (cgFloat)(rcUpdate.right + 1) * mScale.x;
+            region.min.y = mBounds.min.y;
+            region.max.y = mBounds.max.y;
+            region.min.z = mOffset.z - (cgFloat)(rcUpdate.bottom + 1) * mScale.z;
+            region.max.z = mOffset.z - (cgFloat)(rcUpdate.top - 1) * mScale.z;
+            for ( size_t i = 0; i < elements.size(); ++i )
+                ((cgNavigationMeshElement*)elements[i])->invalidateRegion( region );
+        
+        } // End if has navigation
+
+    } // End if has scene
+
     // ToDo: Update the occlusion data as necessary.
 
     // Success!
@@ -2946,18 +3076,84 @@ cgFloat cgLandscape::getTerrainHeight( cgFloat fX, cgFloat fZ, bool bAccountForL
     if ( nBlockY < 0 || nBlockY >= mBlockLayout.height ) return 0.0f;
 
     // Retrieve the terrain block at this location
-    cgTerrainBlock * pBlock = mTerrainBlocks[ nBlockX + nBlockY * mBlockLayout.width ];
+    cgInt nBlockIndex = nBlockX + nBlockY * mBlockLayout.width;
+    cgTerrainBlock * pBlock = mTerrainBlocks[ nBlockIndex ];
     if ( pBlock == CG_NULL )
+    {
+        // Blocks that exist but are not currently resident (streaming) report
+        // their placeholder height instead.
+        if ( mBlockStreamInfo[ nBlockIndex ].blockId != 0 )
+            return getPlaceholderHeight( fX, fZ );
         return 0.0f;
+    
+    } // End if not resident
 
     // Retrieve height from the block
     return pBlock->getTerrainHeight( fX, fZ, bAccountForLOD );
 }
 
+//-----------------------------------------------------------------------------
+// Name : getPlaceholderHeight ()
+/// <summary>
+/// Retrieve the height of the terrain at the specified location directly from
+/// the landscape heightmap. For blocks that are not currently resident, this 
+/// describes the last known height data for that block (or a flat surface if
+/// the block has never been loaded). As with the block level height queries,
+/// the landscape's vertical offset is not included.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgLandscape::getPlaceholderHeight( cgFloat fX, cgFloat fZ ) const
+{
+    if ( mHeightMap == CG_NULL || mHeightMap->getImageData().empty() )
+        return 0.0f;
+    const cgSize & MapSize = mHeightMap->getSize();
+
+    // Convert to heightmap space.
+    fX =  (fX - mOffset.x) / mScale.x;
+    fZ = -(fZ - mOffset.z) / mScale.z;
+
+    // Make sure we are not out of bounds
+    if ( fX < 0 || fZ < 0 || fX >= (cgFloat)(MapSize.width - 1) || fZ >= (cgFloat)(MapSize.height - 1) )
+        return 0.0f;
+
+    // Calculate the remainder (percent across quad)
+    cgInt32 iX = (cgInt32)fX;
+    cgInt32 iZ = (cgInt32)fZ;
+    cgFloat fPercentX = fX - (cgFloat)iX;
+    cgFloat fPercentZ = fZ - (cgFloat)iZ;
+
+    // Retrieve the height of each point in the dividing edge
+    const cgInt16 * pHeights = &mHeightMap->getImageData()[ iX + iZ * MapSize.width ];
+    cgFloat fTopLeft     = (cgFloat)pHeights[0] * mScale.y;
+    cgFloat fBottomRight = (cgFloat)pHeights[MapSize.width + 1] * mScale.y;
+    cgFloat fTopRight, fBottomLeft;
+
+    // Which triangle of the quad are we in ?
+    if ( fPercentX < fPercentZ )
+    {
+        fBottomLeft = (cgFloat)pHeights[MapSize.width] * mScale.y;
+        fTopRight   = fTopLeft + (fBottomRight - fBottomLeft);
+    
+    } // End if left Triangle
+    else
+    {
+        fTopRight   = (cgFloat)pHeights[1] * mScale.y;
+        fBottomLeft = fTopLeft + (fBottomRight - fTopRight);
+
+    } // End if Right Triangle
+    
+    // Interpolate across the top and bottom edges, and then between them.
+    cgFloat fTopHeight    = fTopLeft    + ((fTopRight - fTopLeft) * fPercentX );
+    cgFloat fBottomHeight = fBottomLeft + ((fBottomRight - fBottomLeft) * fPercentX );
+    return fTopHeight + ((fBottomHeight - fTopHeight) * fPercentZ );
+}
+
 //-----------------------------------------------------------------------------
 // Name : getRayIntersect ()
 /// <summary>
-/// Retrieve the 'time' at which a ray intersects the terrain (if at all).
+/// Retrieve the 'time' at which a ray intersects the terrain (if at all). The
+/// result is exact with respect to the full detail terrain triangulation, so
+/// the 'accuracy' parameter is retained only for backwards compatibility.
 /// </summary>
 //-----------------------------------------------------------------------------
 bool cgLandscape::getRayIntersect( const cgVector3 & vecOrigin, const cgVector3 & vecVelocity, cgFloat & t ) const
@@ -2966,97 +3162,818 @@ bool cgLandscape::getRayIntersect( const cgVector3 & vecOrigin, const cgVector3
 }
 bool cgLandscape::getRayIntersect( const cgVector3 & vecOrigin, const cgVector3 & vecVelocity, cgFloat & t, cgFloat fAccuracy ) const
 {
-    cgVector3       vecRayStart, vecRayEnd, vecRayDir, vecPos, vecPosAdd;
-    bool            bSourceInBounds, bDestInBounds, bFound;
-    cgFloat         fOffset, fDelta, fRecipRayLen;
-    cgBoundingBox   BlockBounds;
-    cgInt32         nStepCount, i, j;
+    // Initialize t value (maintains prior behavior for callers that ignore the result)
+    t = 1.0f;
+    return mHeightPyramid.intersect( vecOrigin, vecVelocity, t );
+}
+bool cgLandscape::getRayIntersect( const cgVector3 & vecOrigin, const cgVector3 & vecVelocity, cgLandscapeRayHit & Hit ) const
+{
+    return mHeightPyramid.intersect( vecOrigin, vecVelocity, Hit );
+}
+
+//-----------------------------------------------------------------------------
+// Name : getRayIntersects ()
+/// <summary>
+/// Intersect a batch of rays with the terrain at once (i.e. for line of sight
+/// tests). Queries are distributed across any available job system worker
+/// threads. The heightmap must not be modified while the batch executes.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::getRayIntersects( cgLandscapeRayQuery Queries[], cgUInt32 nQueryCount ) const
+{
+    mHeightPyramid.intersectBatch( Queries, nQueryCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : setDefaultStreamingConfig () (Static)
+/// <summary>
+/// Set the block streaming configuration that will be applied to any
+/// landscape constructed from this point onwards.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::setDefaultStreamingConfig( const cgLandscapeStreamingConfig & Config )
+{
+    mDefaultStreamingConfig = Config;
+}
+
+//-----------------------------------------------------------------------------
+// Name : getDefaultStreamingConfig () (Static)
+/// <summary>
+/// Retrieve the block streaming configuration that will be applied to any
+/// newly constructed landscape.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgLandscapeStreamingConfig & cgLandscape::getDefaultStreamingConfig( )
+{
+    return mDefaultStreamingConfig;
+}
+
+//-----------------------------------------------------------------------------
+// Name : setStreamingConfig ()
+/// <summary>
+/// Configure on-demand block streaming for this landscape. When streaming is
+/// disabled on a landscape that is currently streaming, all remaining blocks
+/// are loaded immediately. Streaming is never enabled in sandbox mode.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::setStreamingConfig( const cgLandscapeStreamingConfig & Config )
+{
+    mStreamingConfig = Config;
+    if ( cgGetSandboxMode() == cgSandboxMode::Enabled )
+        mStreamingConfig.enabled = false;
+
+    // Nothing else to do if the landscape has not yet been loaded.
+    if ( mBlockStreamInfo.empty() )
+        return;
+
+    // Start streaming if required.
+    if ( mStreamingConfig.enabled )
+    {
+        beginStreaming();
+        return;
+    
+    } // End if enabled
+
+    // Stop streaming and make all remaining blocks resident.
+    bool bWasStreaming = isStreaming();
+    endStreaming();
+    if ( !bWasStreaming )
+        return;
+    for ( size_t i = 0; i < mBlockStreamInfo.size(); ++i )
+    {
+        BlockStreamInfo & Info = mBlockStreamInfo[i];
+        if ( mTerrainBlocks[i] != CG_NULL || Info.blockId == 0 || Info.state == StreamFailed )
+            continue;
+
+        // Load the block.
+        StreamedBlockData Data;
+        Data.blockIndex = (cgInt32)i;
+        Data.blockId    = Info.blockId;
+        Data.success    = fetchBlockData( Data );
+        if ( !Data.success || !makeBlockResident( Data ) )
+        {
+            cgAppLog::write( cgAppLog::Warning, _T("Failed to load terrain block %i in landscape '0x%x'.\n"), (cgInt32)i, mLandscapeId );
+            Info.state = StreamFailed;
+            mStreamingStats.loadFailures++;
+            continue;
+        
+        } // End if failed
+        Info.state = StreamResident;
+        mStreamingStats.blocksLoaded++;
+
+    } // Next block
+
+    // Re-generate procedural rendering batches.
+    batchProceduralDraws( );
+}
+
+//-----------------------------------------------------------------------------
+// Name : getStreamingConfig ()
+/// <summary>
+/// Retrieve the current block streaming configuration for this landscape.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgLandscapeStreamingConfig & cgLandscape::getStreamingConfig( ) const
+{
+    return mStreamingConfig;
+}
+
+//-----------------------------------------------------------------------------
+// Name : isStreaming ()
+/// <summary>
+/// Determine if terrain blocks are currently being streamed on demand.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::isStreaming( ) const
+{
+    return (mStreamThread != CG_NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Name : getStreamingStats ()
+/// <summary>
+/// Retrieve the current block streaming telemetry for this landscape. The
+/// resident memory value describes the vertex and texture data owned by the
+/// resident blocks; the shared heightmap is always resident and not included.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgLandscapeStreamingStats cgLandscape::getStreamingStats( ) const
+{
+    cgLandscapeStreamingStats Stats = mStreamingStats;
+    for ( size_t i = 0; i < mTerrainBlocks.size(); ++i )
+    {
+        cgTerrainBlock * pBlock = mTerrainBlocks[i];
+        if ( pBlock != CG_NULL )
+        {
+            Stats.totalBlocks++;
+            Stats.residentBlocks++;
+            Stats.residentMemory += pBlock->getMemoryUsage();
+        
+        } // End if resident
+        else if ( mBlockStreamInfo[i].blockId != 0 )
+        {
+            Stats.totalBlocks++;
+        
+        } // End if not resident
 
-    // Cache the length of the incoming ray as an optimization.
-    fRecipRayLen = cgVector3::length( vecVelocity );
-    if ( fRecipRayLen < CGE_EPSILON )
+    } // Next block
+    Stats.pendingBlocks = mStreamPendingCount;
+    return Stats;
+}
+
+//-----------------------------------------------------------------------------
+// Name : hasBlockStandIn ()
+/// <summary>
+/// Determine if the specified block is not resident and its coarse stand-in
+/// mesh is being drawn in its place.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::hasBlockStandIn( cgInt32 nBlockIndex ) const
+{
+    if ( nBlockIndex < 0 || nBlockIndex >= (cgInt32)mBlockStreamInfo.size() )
         return false;
-    fRecipRayLen = 1.0f / fRecipRayLen;
+    return ( mTerrainBlocks[ nBlockIndex ] == CG_NULL && mBlockStreamInfo[ nBlockIndex ].standIn.isValid() );
+}
 
-    // Initialize t value (important for 'closest point' matching)
-    t = 1.0f;
+//-----------------------------------------------------------------------------
+// Name : updateStreaming ()
+/// <summary>
+/// Called once per frame (usually with the position of the active camera) in
+/// order to make resident any blocks streamed in by the background thread,
+/// evict any blocks outside of the configured residency ring and request
+/// those blocks that have come into range.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::updateStreaming( const cgVector3 & vecFocus )
+{
+    // Validate requirements
+    if ( !isStreaming() )
+        return;
+
+    // Retrieve any blocks that have finished loading (up to the configured limit)
+    // and cancel any outstanding requests that have since moved out of range.
+    StreamedBlockList CompletedBlocks;
+    cgUInt32 nMaxLoads = max( 1u, mStreamingConfig.maximumLoadsPerUpdate );
+    mStreamSection->enter();
+    for ( cgUInt32 i = 0; i < nMaxLoads && !mStreamResults.empty(); ++i )
+    {
+        CompletedBlocks.push_back( mStreamResults.front() );
+        mStreamResults.pop_front();
     
-    // Loop through each block and test to see if the ray intersects its bounding box
-    for ( i = 0; i < mBlockLayout.width * mBlockLayout.height; ++i )
+    } // Next result
+    for ( BlockStreamRequestQueue::iterator itRequest = mStreamRequests.begin(); itRequest != mStreamRequests.end(); )
     {
-        cgTerrainBlock * pBlock = mTerrainBlocks[ i ];
-        if ( pBlock == CG_NULL ) continue;
+        if ( getBlockDistance( itRequest->blockIndex, vecFocus ) > mStreamingConfig.evictRadius )
+        {
+            mBlockStreamInfo[ itRequest->blockIndex ].state = StreamNotResident;
+            mStreamPendingCount--;
+            itRequest = mStreamRequests.erase( itRequest );
+        
+        } // End if out of range
+        else
+            ++itRequest;
+
+    } // Next request
+    mStreamSection->exit();
 
-        // Retrieve the bounding box for this block
-        BlockBounds = pBlock->getBoundingBox();
+    // Make the retrieved blocks resident.
+    bool bBlocksChanged = false;
+    cgTimer * pTimer = cgTimer::getInstance();
+    StreamedBlockList::iterator itData;
+    for ( itData = CompletedBlocks.begin(); itData != CompletedBlocks.end(); ++itData )
+    {
+        StreamedBlockData * pData = *itData;
+        BlockStreamInfo & Info = mBlockStreamInfo[ pData->blockIndex ];
+        mStreamPendingCount--;
 
-        // Add a tolerance to ensure that we don't miss the terrain.
-        cgFloat fAdjust = (1.0f / fAccuracy) * 2.0f;
-        BlockBounds.min.y -= fAdjust;
-        BlockBounds.max.y += fAdjust;
+        if ( pData->success && getBlockDistance( pData->blockIndex, vecFocus ) > mStreamingConfig.evictRadius )
+        {
+            // Moved out of range while loading.
+            Info.state = StreamNotResident;
         
-        // Skip if there is no intersection at all
-        if ( BlockBounds.intersect( vecOrigin, vecVelocity, fDelta ) == false )
-            continue;
+        } // End if out of range
+        else if ( pData->success && makeBlockResident( *pData ) )
+        {
+            Info.state = StreamResident;
+            bBlocksChanged = true;
+
+            // Update latency telemetry.
+            cgDouble fLatency = pTimer->getTime( true ) - Info.requestTime;
+            mStreamingStats.blocksLoaded++;
+            mStreamingStats.lastLatency     = fLatency;
+            mStreamingStats.maximumLatency  = max( mStreamingStats.maximumLatency, fLatency );
+            mStreamingStats.averageLatency += (fLatency - mStreamingStats.averageLatency) / (cgDouble)mStreamingStats.blocksLoaded;
+        
+        } // End if loaded
+        else
+        {
+            // Never request this block again.
+            cgAppLog::write( cgAppLog::Warning, _T("Failed to stream terrain block %i in landscape '0x%x'.\n"), pData->blockIndex, mLandscapeId );
+            Info.state = StreamFailed;
+            mStreamingStats.loadFailures++;
+        
+        } // End if failed
+        delete pData;
 
-        // Store copy of ray start and end point so we can update them
-        vecRayStart = vecOrigin; 
-        vecRayEnd   = vecOrigin + vecVelocity;
+    } // Next block
 
-        // Correct the ray if either point is outside the terrain bounds
-        bSourceInBounds = BlockBounds.containsPoint( vecRayStart );
-        bDestInBounds   = BlockBounds.containsPoint( vecRayEnd );
+    // Evict resident blocks that have moved out of range.
+    for ( size_t i = 0; i < mTerrainBlocks.size(); ++i )
+    {
+        if ( mTerrainBlocks[i] != CG_NULL && getBlockDistance( (cgInt32)i, vecFocus ) > mStreamingConfig.evictRadius )
+        {
+            evictBlock( (cgInt32)i );
+            bBlocksChanged = true;
+
+        } // End if out of range
+
+    } // Next block
+
+    // Collect those non-resident blocks within the residency ring that should be 
+    // requested. Only the area of the layout surrounding the focus is searched.
+    if ( mStreamPendingCount < mStreamingConfig.maximumPendingLoads )
+    {
+        cgFloat fRadius      = mStreamingConfig.residentRadius;
+        cgFloat fBlockWidth  = (cgFloat)(mBlockSize.width - 1) * mScale.x;
+        cgFloat fBlockDepth  = (cgFloat)(mBlockSize.height - 1) * mScale.z;
+        cgFloat fMaxX        = (cgFloat)(mBlockLayout.width - 1);
+        cgFloat fMaxZ        = (cgFloat)(mBlockLayout.height - 1);
+        cgInt32 nStartX      = (cgInt32)min( fMaxX, max( 0.0f, floorf( ((vecFocus.x - fRadius) - mOffset.x) / fBlockWidth ) ) );
+        cgInt32 nEndX        = (cgInt32)min( fMaxX, max( 0.0f, floorf( ((vecFocus.x + fRadius) - mOffset.x) / fBlockWidth ) ) );
+        cgInt32 nStartZ      = (cgInt32)min( fMaxZ, max( 0.0f, floorf( (mOffset.z - (vecFocus.z + fRadius)) / fBlockDepth ) ) );
+        cgInt32 nEndZ        = (cgInt32)min( fMaxZ, max( 0.0f, floorf( (mOffset.z - (vecFocus.z - fRadius)) / fBlockDepth ) ) );
+        
+        // Sort keys contain the distance (upper 32 bits) and block index (lower 32 bits).
+        cgArray<cgUInt64> aRequestKeys;
+        for ( cgInt32 z = nStartZ; z <= nEndZ; ++z )
+        {
+            for ( cgInt32 x = nStartX; x <= nEndX; ++x )
+            {
+                cgInt32 nBlockIndex = x + z * mBlockLayout.width;
+                const BlockStreamInfo & Info = mBlockStreamInfo[ nBlockIndex ];
+                if ( Info.blockId == 0 || Info.state != StreamNotResident )
+                    continue;
+                cgFloat fDistance = getBlockDistance( nBlockIndex, vecFocus );
+                if ( fDistance <= fRadius )
+                    aRequestKeys.push_back( (((cgUInt64)fDistance) << 32) | (cgUInt32)nBlockIndex );
+
+            } // Next Column
 
-        // If either points are ourside the bounding box, lets correct them
-        if ( bSourceInBounds == false )
+        } // Next Row
+
+        // Queue up the nearest blocks first.
+        if ( !aRequestKeys.empty() )
         {
-            // Calculate the new ray starting point (we've already done the actual intersection 
-            // test above as our early out, so there is no need to do this one again)
-            vecRayStart = vecOrigin + (vecVelocity * fDelta);
+            std::sort( aRequestKeys.begin(), aRequestKeys.end() );
+            cgDouble fRequestTime = pTimer->getTime( true );
+            mStreamSection->enter();
+            for ( size_t i = 0; i < aRequestKeys.size() && mStreamPendingCount < mStreamingConfig.maximumPendingLoads; ++i )
+            {
+                BlockStreamRequest Request;
+                Request.blockIndex = (cgInt32)(aRequestKeys[i] & 0xFFFFFFFF);
+                Request.blockId    = mBlockStreamInfo[ Request.blockIndex ].blockId;
+                mStreamRequests.push_back( Request );
+                mBlockStreamInfo[ Request.blockIndex ].state       = StreamPending;
+                mBlockStreamInfo[ Request.blockIndex ].requestTime = fRequestTime;
+                mStreamPendingCount++;
+
+            } // Next request
+            mStreamSection->exit();
+            
+            // Wake the streaming thread.
+            mStreamEvent->signal();
+
+        } // End if any requests
 
-        } // End if source outside bounds ?
+    } // End if space for requests
+
+    // Re-generate procedural rendering batches if the resident set changed.
+    if ( bBlocksChanged )
+        batchProceduralDraws( );
+}
 
-        if ( bDestInBounds == false )
+//-----------------------------------------------------------------------------
+// Name : beginStreaming () (Protected)
+/// <summary>
+/// Start the background thread responsible for reading terrain block data
+/// from the world database.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::beginStreaming( )
+{
+    // Already streaming?
+    if ( mStreamThread != CG_NULL )
+        return true;
+
+    // Prepare the queries used exclusively by the streaming thread.
+    cgWorld * pWorld = mParentScene->getParentWorld();
+    if ( !mStreamBlockData.isPrepared( pWorld ) )
+        mStreamBlockData.prepare( pWorld, _T("SELECT HeightData, ColorData FROM 'Landscapes::Blocks' WHERE BlockId=?1"), true );
+    if ( !mStreamBlockLODs.isPrepared( pWorld ) )
+        mStreamBlockLODs.prepare( pWorld, _T("SELECT LevelIndex, Variance FROM 'Landscapes::BlockLOD' WHERE BlockId=?1"), true );
+    if ( !mStreamBlockData.isPrepared( pWorld ) || !mStreamBlockLODs.isPrepared( pWorld ) )
+    {
+        cgAppLog::write( cgAppLog::Error, _T("Failed to prepare block streaming queries for landscape '0x%x'.\n"), mLandscapeId );
+        return false;
+    
+    } // End if failed
+
+    // Start the streaming thread.
+    mStreamSection = cgCriticalSection::createInstance();
+    mStreamEvent   = cgEvent::createInstance( true );
+    mStreamThread  = cgThread::createInstance();
+    if ( !mStreamThread->start( streamBlocksThread, this ) )
+    {
+        cgAppLog::write( cgAppLog::Error, _T("Failed to start block streaming thread for landscape '0x%x'.\n"), mLandscapeId );
+        delete mStreamThread;
+        mStreamThread = CG_NULL;
+        endStreaming();
+        return false;
+    
+    } // End if failed
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : endStreaming () (Protected)
+/// <summary>
+/// Stop the background streaming thread and discard any outstanding requests
+/// or results. Resident blocks are left untouched.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::endStreaming( )
+{
+    // Stop the thread.
+    if ( mStreamThread != CG_NULL )
+    {
+        mStreamThread->signalTerminate();
+        mStreamEvent->signal();
+        mStreamThread->terminate();
+        delete mStreamThread;
+        mStreamThread = CG_NULL;
+    
+    } // End if running
+
+    // Discard outstanding requests and results.
+    StreamedBlockList::iterator itData;
+    for ( itData = mStreamResults.begin(); itData != mStreamResults.end(); ++itData )
+        delete *itData;
+    mStreamResults.clear();
+    mStreamRequests.clear();
+    for ( size_t i = 0; i < mBlockStreamInfo.size(); ++i )
+    {
+        if ( mBlockStreamInfo[i].state == StreamPending )
+            mBlockStreamInfo[i].state = StreamNotResident;
+    
+    } // Next block
+    mStreamPendingCount = 0;
+
+    // Release synchronization objects.
+    delete mStreamSection;
+    delete mStreamEvent;
+    mStreamSection = CG_NULL;
+    mStreamEvent   = CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : streamBlocksThread () (Protected, Static)
+/// <summary>
+/// Entry point for the block streaming thread. Services queued block requests
+/// by reading their data from the world database and handing the result back
+/// to the main thread via updateStreaming().
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgLandscape::streamBlocksThread( cgThread * pThread, void * pContext )
+{
+    cgLandscape * pLandscape = (cgLandscape*)pContext;
+    cgTraceProfiler::setThreadName( "Landscape Streaming" );
+
+    while ( !pThread->terminateRequested() )
+    {
+        // Retrieve the next outstanding request.
+        BlockStreamRequest Request;
+        bool bHasRequest = false;
+        pLandscape->mStreamSection->enter();
+        if ( !pLandscape->mStreamRequests.empty() )
+        {
+            Request = pLandscape->mStreamRequests.front();
+            pLandscape->mStreamRequests.pop_front();
+            bHasRequest = true;
+        
+        } // End if any requests
+        pLandscape->mStreamSection->exit();
+
+        // Wait for more work if there was nothing to do.
+        if ( !bHasRequest )
         {
-            // Get the bounding box intersection point
-            if ( BlockBounds.intersect( vecRayEnd, (vecRayStart - vecRayEnd), fDelta ) == false )
+            pLandscape->mStreamEvent->wait( 100 );
+            continue;
+        
+        } // End if idle
+
+        // Read the block data and pass it back to the main thread.
+        StreamedBlockData * pData = new StreamedBlockData();
+        pData->blockIndex = Request.blockIndex;
+        pData->blockId    = Request.blockId;
+        pData->success    = pLandscape->fetchBlockData( *pData );
+        pLandscape->mStreamSection->enter();
+        pLandscape->mStreamResults.push_back( pData );
+        pLandscape->mStreamSection->exit();
+
+    } // Next request
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : fetchBlockData () (Protected)
+/// <summary>
+/// Read the height, color and LOD variance data for the specified block from
+/// the world database. Called by the streaming thread, so must not touch any 
+/// state other than the dedicated streaming queries.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::fetchBlockData( StreamedBlockData & Data )
+{
+    // Retrieve the height and color data.
+    mStreamBlockData.bindParameter( 1, Data.blockId );
+    if ( !mStreamBlockData.step() || !mStreamBlockData.nextRow() )
+    {
+        mStreamBlockData.reset();
+        return false;
+    
+    } // End if failed
+    cgUInt32 nHeightMapSize = 0, nColorMapSize = 0;
+    cgInt16  * pHeightData = CG_NULL;
+    cgUInt32 * pColorData  = CG_NULL;
+    mStreamBlockData.getColumn( _T("HeightData"), (void**)&pHeightData, nHeightMapSize );
+    mStreamBlockData.getColumn( _T("ColorData"), (void**)&pColorData, nColorMapSize );
+    if ( pHeightData == CG_NULL || nHeightMapSize < sizeof(cgInt16) )
+    {
+        mStreamBlockData.reset();
+        return false;
+    
+    } // End if no data
+    Data.heights.resize( nHeightMapSize / sizeof(cgInt16) );
+    memcpy( &Data.heights[0], pHeightData, Data.heights.size() * sizeof(cgInt16) );
+    if ( pColorData != CG_NULL && nColorMapSize >= sizeof(cgUInt32) )
+    {
+        Data.colors.resize( nColorMapSize / sizeof(cgUInt32) );
+        memcpy( &Data.colors[0], pColorData, Data.colors.size() * sizeof(cgUInt32) );
+    
+    } // End if has color data
+    mStreamBlockData.reset();
+
+    // Retrieve the LOD variance values.
+    Data.variance.resize( MaxLandscapeLOD, 0.0f );
+    mStreamBlockLODs.bindParameter( 1, Data.blockId );
+    if ( !mStreamBlockLODs.step() )
+    {
+        mStreamBlockLODs.reset();
+        return false;
+    
+    } // End if failed
+    for ( ; mStreamBlockLODs.nextRow(); )
+    {
+        cgInt32 nLODIndex = 0;
+        mStreamBlockLODs.getColumn( _T("LevelIndex"), nLODIndex );
+        if ( nLODIndex >= 0 && nLODIndex < MaxLandscapeLOD )
+            mStreamBlockLODs.getColumn( _T("Variance"), Data.variance[nLODIndex] );
+
+    } // Next LOD
+    mStreamBlockLODs.reset();
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : makeBlockResident () (Protected)
+/// <summary>
+/// Construct the terrain block described by the streamed data, connect it to
+/// its neighbors and to the spatial tree, and refresh any landscape level
+/// data that depends on its heights.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::makeBlockResident( const StreamedBlockData & Data )
+{
+    // Construct the block.
+    cgTerrainBlock::BlockData BlockData;
+    BlockData.blockId     = Data.blockId;
+    BlockData.heightData  = &Data.heights[0];
+    BlockData.colorData   = (Data.colors.empty()) ? CG_NULL : &Data.colors[0];
+    BlockData.lodVariance = &Data.variance[0];
+    cgTerrainBlock * pBlock = createBlock( Data.blockIndex );
+    if ( !pBlock->loadBlock( BlockData ) )
+    {
+        delete pBlock;
+        return false;
+    
+    } // End if failed
+    mTerrainBlocks[ Data.blockIndex ] = pBlock;
+    linkBlockNeighbors( Data.blockIndex, false );
+
+    // Reconnect the spatial tree leaves and recompute their occlusion data 
+    // now that the real heights are available.
+    BlockStreamInfo & Info = mBlockStreamInfo[ Data.blockIndex ];
+    Info.standIn.close();
+    pBlock->mLeafNodes = Info.leafNodes;
+    for ( size_t i = 0; i < Info.leafNodes.size(); ++i )
+        Info.leafNodes[i]->updateOcclusionData( true );
+
+    // Refresh the normal texture and ray intersection data in the area 
+    // managed by this block (including its border).
+    cgSize  MapSize = getHeightMapSize();
+    cgInt32 x = Data.blockIndex % mBlockLayout.width;
+    cgInt32 z = Data.blockIndex / mBlockLayout.width;
+    cgRect  rcUpdate( x * (mBlockSize.width - 1) - 1, z * (mBlockSize.height - 1) - 1,
+                      ((x + 1) * (mBlockSize.width - 1)) + 2, ((z + 1) * (mBlockSize.height - 1)) + 2 );
+    rcUpdate = cgRect::intersect( rcUpdate, cgRect( 0, 0, MapSize.width, MapSize.height ) );
+    updateNormalTexture( rcUpdate );
+    mHeightPyramid.update( rcUpdate );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : evictBlock () (Protected)
+/// <summary>
+/// Destroy the specified resident block. Its height data remains in the 
+/// landscape heightmap where it serves as the placeholder for height and ray
+/// queries, and as the source for the stand-in mesh that is drawn in its
+/// place, until the block is streamed back in.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::evictBlock( cgInt32 nBlockIndex )
+{
+    cgTerrainBlock * pBlock = mTerrainBlocks[ nBlockIndex ];
+    if ( pBlock == CG_NULL )
+        return;
+
+    // Disconnect and destroy.
+    linkBlockNeighbors( nBlockIndex, true );
+    delete pBlock;
+    mTerrainBlocks[ nBlockIndex ] = CG_NULL;
+    mBlockStreamInfo[ nBlockIndex ].state = StreamNotResident;
+    mStreamingStats.blocksEvicted++;
+    buildBlockStandIn( nBlockIndex );
+}
+
+//-----------------------------------------------------------------------------
+// Name : linkBlockNeighbors () (Protected)
+/// <summary>
+/// Connect (or disconnect) the specified block and its immediate neighbors
+/// for the purposes of LOD stitching. The border vertices of any resident
+/// neighbors are also refreshed (see 'refreshBlockBorders()').
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::linkBlockNeighbors( cgInt32 nBlockIndex, bool bUnlink )
+{
+    // Neighbor offsets in cgTerrainBlock::EdgeSide order (North, East, South, West).
+    static const cgInt32 Offsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+    cgTerrainBlock * pBlock = mTerrainBlocks[ nBlockIndex ];
+    cgInt32 x = nBlockIndex % mBlockLayout.width;
+    cgInt32 z = nBlockIndex / mBlockLayout.width;
+    for ( cgInt32 i = 0; i < 4; ++i )
+    {
+        cgInt32 nX = x + Offsets[i][0];
+        cgInt32 nZ = z + Offsets[i][1];
+        if ( nX < 0 || nZ < 0 || nX >= mBlockLayout.width || nZ >= mBlockLayout.height )
+            continue;
+
+        // Update both sides of the connection.
+        cgTerrainBlock * pNeighbor = mTerrainBlocks[ nX + nZ * mBlockLayout.width ];
+        if ( pBlock != CG_NULL )
+            pBlock->setNeighbor( (cgTerrainBlock::EdgeSide)i, (bUnlink) ? CG_NULL : pNeighbor );
+        if ( pNeighbor != CG_NULL )
+            pNeighbor->setNeighbor( (cgTerrainBlock::EdgeSide)((i + 2) % 4), (bUnlink) ? CG_NULL : pBlock );
+
+    } // Next side
+
+    // Neighbors must reflect the block's heights before they are next drawn.
+    refreshBlockBorders( nBlockIndex );
+}
+
+//-----------------------------------------------------------------------------
+// Name : refreshBlockBorders () (Protected)
+/// <summary>
+/// A block shares its edge vertices with its neighbors, and manages a one
+/// pixel border of the heightmap beyond them that is used when computing
+/// normals. Whenever a block is streamed in (replacing the placeholder
+/// heights in that area) or evicted, the vertex positions and normals along
+/// the borders of all eight surrounding resident blocks are recomputed here
+/// to prevent cracks and lighting seams.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::refreshBlockBorders( cgInt32 nBlockIndex )
+{
+    cgInt32 x = nBlockIndex % mBlockLayout.width;
+    cgInt32 z = nBlockIndex / mBlockLayout.width;
+    for ( cgInt32 nZ = z - 1; nZ <= z + 1; ++nZ )
+    {
+        for ( cgInt32 nX = x - 1; nX <= x + 1; ++nX )
+        {
+            if ( nX < 0 || nZ < 0 || nX >= mBlockLayout.width || nZ >= mBlockLayout.height || (nX == x && nZ == z) )
                 continue;
-            vecRayEnd = vecRayEnd + ((vecRayStart - vecRayEnd) * fDelta );
 
-        } // End if dest outside bounds ?
+            // Rebuild the neighbor's vertex data from the shared heightmap.
+            cgTerrainBlock * pNeighbor = mTerrainBlocks[ nX + nZ * mBlockLayout.width ];
+            if ( pNeighbor != CG_NULL )
+                pNeighbor->updateVertexBuffer( mMipLookUp );
 
-        // Cache values ready to start the process
-        vecPos       = vecRayStart;
-        vecRayDir    = (vecRayEnd - vecRayStart);
-	    fOffset      = 1.0f / ( cgVector3::length( vecRayDir ) * fAccuracy );
-	    vecPosAdd    = vecRayDir * fOffset;
-        nStepCount   = (cgInt32)(1.0f / fOffset);
+        } // Next column
 
-        // Itterate across the terrain
-        bFound = false;
-	    for ( j = 0; j < nStepCount && bFound == false; ++j ) 
+    } // Next row
+}
+
+//-----------------------------------------------------------------------------
+// Name : getBlockDistance () (Protected)
+/// <summary>
+/// Compute the distance between the specified point and the closest point
+/// on the specified block's rectangle (on the XZ plane).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgLandscape::getBlockDistance( cgInt32 nBlockIndex, const cgVector3 & vecPoint ) const
+{
+    cgFloat fBlockWidth = (cgFloat)(mBlockSize.width - 1) * mScale.x;
+    cgFloat fBlockDepth = (cgFloat)(mBlockSize.height - 1) * mScale.z;
+    cgFloat fMinX = mOffset.x + (cgFloat)(nBlockIndex % mBlockLayout.width) * fBlockWidth;
+    cgFloat fMaxZ = mOffset.z - (cgFloat)(nBlockIndex / mBlockLayout.width) * fBlockDepth;
+    cgFloat fDX   = max( 0.0f, max( fMinX - vecPoint.x, vecPoint.x - (fMinX + fBlockWidth) ) );
+    cgFloat fDZ   = max( 0.0f, max( (fMaxZ - fBlockDepth) - vecPoint.z, vecPoint.z - fMaxZ ) );
+    return sqrtf( fDX * fDX + fDZ * fDZ );
+}
+
+//-----------------------------------------------------------------------------
+// Name : createBlock () (Protected)
+/// <summary>
+/// Allocate a new (unloaded) terrain block for the specified location in the
+/// block layout.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgTerrainBlock * cgLandscape::createBlock( cgInt32 nBlockIndex )
+{
+    // Compute the location of this block based on its index.
+    cgSize  MapSize = getHeightMapSize();
+    cgInt32 x = nBlockIndex % mBlockLayout.width;
+    cgInt32 z = nBlockIndex / mBlockLayout.width;
+
+    // Construct terrain block initialization information.
+    cgTerrainBlock::TerrainSection Section;
+    Section.heightMapBuffer = &mHeightMap->getImageData()[0];
+    Section.blockBounds.left     = x * (mBlockSize.width - 1);
+    Section.blockBounds.top      = z * (mBlockSize.height - 1);
+    Section.blockBounds.right    = ((x + 1) * (mBlockSize.width - 1)) + 1;
+    Section.blockBounds.bottom   = ((z + 1) * (mBlockSize.height - 1)) + 1;
+    Section.blockBounds.pitchX   = MapSize.width;
+    Section.blockBounds.pitchY   = MapSize.height;
+    return new cgTerrainBlock( this, nBlockIndex, Section );
+}
+
+//-----------------------------------------------------------------------------
+// Name : buildBlockStandIn () (Protected)
+/// <summary>
+/// Build the coarse mesh that is drawn in place of the specified block while
+/// it is not resident. Only the vertices used by the lowest level of detail
+/// are generated (from the placeholder heights in the landscape heightmap),
+/// in the same order that they occupy at the start of a full block vertex 
+/// buffer so that the shared index buffer for that level can be used.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscape::buildBlockStandIn( cgInt32 nBlockIndex )
+{
+    BlockStreamInfo & Info = mBlockStreamInfo[ nBlockIndex ];
+    Info.standIn.close();
+
+    // Validate requirements
+    if ( mLODData.empty() || mHeightMap == CG_NULL || mHeightMap->getImageData().empty() )
+        return false;
+
+    // Compute the area of the heightmap managed by this block and the 
+    // vertex spacing at the lowest level of detail.
+    cgSize  MapSize  = getHeightMapSize();
+    cgInt32 nLOD     = (cgInt32)mLODData.size() - 1;
+    cgInt32 nStep    = 1 << nLOD;
+    cgInt32 nLeft    = (nBlockIndex % mBlockLayout.width) * (mBlockSize.width - 1);
+    cgInt32 nTop     = (nBlockIndex / mBlockLayout.width) * (mBlockSize.height - 1);
+    cgInt32 nColumns = ((mBlockSize.width - 1) >> nLOD) + 1;
+    cgInt32 nRows    = ((mBlockSize.height - 1) >> nLOD) + 1;
+
+    // Generate the vertices. The lowest LOD entries in the mip look up table
+    // (see 'buildMipLookUp()') are simply numbered row by row.
+    const cgInt16 * pHeightMap = &mHeightMap->getImageData()[0];
+    cgArray<cgTerrainVertex> Vertices( nColumns * nRows );
+    for ( cgInt32 z = 0, nVertex = 0; z < nRows; ++z )
+    {
+        for ( cgInt32 x = 0; x < nColumns; ++x, ++nVertex )
         {
-		    // Does this point dip under the terrain ?
-            if ( vecPos.y < pBlock->getTerrainHeight( vecPos.x, vecPos.z ) )
-            {
-                // Calculate the time value and store if it is closer
-                fDelta = cgVector3::length( vecPos - vecOrigin ) * fRecipRayLen;
-                if ( fDelta < t ) t = fDelta;
-                
-                // Bail from this loop and keep searching blocks
-                bFound = true;
+            cgInt32 nX = nLeft + x * nStep;
+            cgInt32 nZ = nTop + z * nStep;
+            cgInt32 nHMIndex = nX + nZ * MapSize.width;
+            cgTerrainVertex & v = Vertices[nVertex];
+            v.position.x =  (cgFloat)nX * mScale.x;
+            v.position.y =  (cgFloat)pHeightMap[ nHMIndex ] * mScale.y;
+            v.position.z = -(cgFloat)nZ * mScale.z;
+            v.position  += mOffset;
+            v.color      = (mColorMap.empty()) ? 0xFFFFFFFF : mColorMap[ nHMIndex ];
+            v.normal     = getHeightMapNormal( nX, nZ );
 
-            } // End if falls under terrain
+        } // Next Column
 
-            // Move to next point
-		    vecPos += vecPosAdd;
+    } // Next Row
 
-	    } // Next point along ray
+    // Allocate and populate the vertex buffer.
+    cgResourceManager * pResources = mParentScene->getResourceManager();
+    cgUInt32 nBufferLength = (cgUInt32)Vertices.size() * sizeof(cgTerrainVertex);
+    pResources->createVertexBuffer( &Info.standIn, nBufferLength, cgBufferUsage::WriteOnly, mVertexFormat, cgMemoryPool::Managed, cgDebugSource() );
+    cgVertexBuffer * pBuffer = Info.standIn.getResource( true );
+    if ( !pBuffer || !pBuffer->updateBuffer( 0, 0, &Vertices.front() ) )
+    {
+        cgAppLog::write( cgAppLog::Error, _T("Failed to build stand-in vertex buffer for terrain block %i.\n"), nBlockIndex );
+        Info.standIn.close();
+        return false;
+    
+    } // End if failed
 
-    } // Next Block
+    // Success!
+    return true;
+}
 
-    // Intersection found?
-    return (t < 1.0f);
+//-----------------------------------------------------------------------------
+// Name : drawBlockStandIn () (Protected)
+/// <summary>
+/// Draw the coarse stand-in mesh for the specified non-resident block (if 
+/// any) at the lowest level of detail. Resident neighbors stitch their own
+/// edges down to this level (see 'cgTerrainBlock::draw()'), so the stand-in
+/// itself always connects at its own level.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscape::drawBlockStandIn( cgRenderDriver * pDriver, cgInt32 nBlockIndex )
+{
+    const BlockStreamInfo & Info = mBlockStreamInfo[ nBlockIndex ];
+    if ( !Info.standIn.isValid() || mLODData.empty() )
+        return;
+
+    // Setup streams ready for rendering (vertex format set by caller).
+    cgInt32 nLOD = (cgInt32)mLODData.size() - 1;
+    cgTerrainLOD * pLODData = mLODData[ nLOD ];
+    cgInt32 nVertexCount = (((mBlockSize.width - 1) >> nLOD) + 1) * (((mBlockSize.height - 1) >> nLOD) + 1);
+    pDriver->setStreamSource( 0, Info.standIn );
+    pDriver->setIndices( pLODData->indexBuffer );
+
+    // Render the interior followed by each connecting edge piece.
+    if ( pLODData->interiorPrimitiveCount > 0 )
+        pDriver->drawIndexedPrimitive( cgPrimitiveType::TriangleList, 0, 0, nVertexCount, 0, pLODData->interiorPrimitiveCount );
+    for ( cgInt32 i = 0; i < 4; ++i )
+    {
+        const cgTerrainLOD::BlockSkirt::LODLevel & LODConnect = pLODData->skirts[i].levels[0];
+        if ( LODConnect.primitiveCount > 0 )
+            pDriver->drawIndexedPrimitive( cgPrimitiveType::TriangleList, 0, 0, nVertexCount, LODConnect.indexStart, LODConnect.primitiveCount );
+
+    } // Next edge
 }
 
 //-----------------------------------------------------------------------------
@@ -4954,9 +5871,32 @@ bool cgTerrainBlock::importBlock( )
 /// </summary>
 //-----------------------------------------------------------------------------
 bool cgTerrainBlock::loadBlock( cgWorldQuery & BlockQuery )
+{
+    BlockData Data;
+    cgUInt32 nHeightMapSize = 0, nColorMapSize = 0;
+    Data.blockId     = 0;
+    Data.heightData  = CG_NULL;
+    Data.colorData   = CG_NULL;
+    Data.lodVariance = CG_NULL;
+
+    // Retrieve block properties and data from the database.
+    BlockQuery.getColumn( _T("BlockId"), Data.blockId );
+    BlockQuery.getColumn( _T("HeightData"), (void**)&Data.heightData, nHeightMapSize );
+    BlockQuery.getColumn( _T("ColorData"), (void**)&Data.colorData, nColorMapSize );
+    return loadBlock( Data );
+}
+
+//-----------------------------------------------------------------------------
+// Name : loadBlock ()
+/// <summary>
+/// Load the terrain block using data that has already been retrieved from the
+/// database (i.e. by the landscape's block streaming thread).
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTerrainBlock::loadBlock( const BlockData & Data )
 {
     // Retrieve base block properties.
-    BlockQuery.getColumn( _T("BlockId"), mBlockId );
+    mBlockId = Data.blockId;
 
     // Calculate the intersection of the terrain total rectangle and the specified
     // rectangle to ensure that we are not attempting to read out of bounds.
@@ -5045,15 +5985,9 @@ bool cgTerrainBlock::loadBlock( cgWorldQuery & BlockQuery )
         // Our active rectangle is the same as that passed in (we're simply referencing the full heightmap)
         mActiveHeightMapBounds = mSection.blockBounds;
 
-        // Retrieve the height data from the database.
-        cgUInt32 nHeightMapSize = 0;
-        cgInt16 * pHeightData = CG_NULL;
-        BlockQuery.getColumn( _T("HeightData"), (void**)&pHeightData, nHeightMapSize );
-        
-        // Retrieve the color data from the database
-        cgUInt32 nColorMapSize = 0;
-        cgUInt32 * pColorData = CG_NULL;
-        BlockQuery.getColumn( _T("ColorData"), (void**)&pColorData, nColorMapSize );
+        // Source height and color data.
+        const cgInt16  * pHeightData = Data.heightData;
+        const cgUInt32 * pColorData  = Data.colorData;
 
         // ToDo: 9999 - Can optimize by block copying a row at a time
         //       in the full height map case, or storing the entire
@@ -5103,36 +6037,45 @@ bool cgTerrainBlock::loadBlock( cgWorldQuery & BlockQuery )
     if ( buildVertexBuffer( mParent->getMipLookUp() ) == false )
         return false;
 
-    // Load the LOD variance values.
-    prepareQueries();
+    // Load the LOD variance values (unless they were supplied).
     mVarianceCount = mParent->getLODData().size() - 1;
-    mLoadBlockLODs.bindParameter( 1, mBlockId );
-    if ( mLoadBlockLODs.step() == false )
+    if ( Data.lodVariance != CG_NULL )
     {
-        // Log any error.
-        cgString strError;
-        if ( mLoadBlockLODs.getLastError( strError ) == false )
-            cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve LOD data for block %i in landscape '0x%x'. World database has potentially become corrupt.\n"), mBlockIndex, mParent->getDatabaseId() );
-        else
-            cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve LOD data for block %i in landscape '0x%x'. Error: %s\n"), mBlockIndex, mParent->getDatabaseId(), strError.c_str() );
-
-        // Release any pending read operation.
-        mLoadBlockLODs.reset();
-        return false;
+        memcpy( mLODVariance, Data.lodVariance, cgLandscape::MaxLandscapeLOD * sizeof(cgFloat) );
     
-    } // End if failed
-
-    // Process LOD data.
-    for ( ; mLoadBlockLODs.nextRow(); )
+    } // End if supplied
+    else
     {
-        cgInt32 nLODIndex = 0;
-        mLoadBlockLODs.getColumn( _T("LevelIndex"), nLODIndex );
-        mLoadBlockLODs.getColumn( _T("Variance"), mLODVariance[nLODIndex] );
+        prepareQueries();
+        mLoadBlockLODs.bindParameter( 1, mBlockId );
+        if ( mLoadBlockLODs.step() == false )
+        {
+            // Log any error.
+            cgString strError;
+            if ( mLoadBlockLODs.getLastError( strError ) == false )
+                cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve LOD data for block %i in landscape '0x%x'. World database has potentially become corrupt.\n"), mBlockIndex, mParent->getDatabaseId() );
+            else
+                cgAppLog::write( cgAppLog::Error, _T("Failed to retrieve LOD data for block %i in landscape '0x%x'. Error: %s\n"), mBlockIndex, mParent->getDatabaseId(), strError.c_str() );
+
+            // Release any pending read operation.
+            mLoadBlockLODs.reset();
+            return false;
         
-    } // Next Block
+        } // End if failed
 
-    // We're done with the LOD read query.
-    mLoadBlockLODs.reset();
+        // Process LOD data.
+        for ( ; mLoadBlockLODs.nextRow(); )
+        {
+            cgInt32 nLODIndex = 0;
+            mLoadBlockLODs.getColumn( _T("LevelIndex"), nLODIndex );
+            mLoadBlockLODs.getColumn( _T("Variance"), mLODVariance[nLODIndex] );
+            
+        } // Next Block
+
+        // We're done with the LOD read query.
+        mLoadBlockLODs.reset();
+
+    } // End if query
 
     // Generate physics body for this block.
     buildPhysicsBody();
@@ -5617,6 +6560,8 @@ void cgTerrainBlock::draw( cgRenderDriver * pDriver, RenderMode Mode )
             // (remember that a higher LOD has a smaller index value, which is why we use 'max' here rather than 'min')
             if ( pNeighbor )
                 nNeighborLOD = max( mCurrentLOD, pNeighbor->getCurrentLOD() );
+            else if ( isStandInNeighbor( (EdgeSide)i ) )
+                nNeighborLOD = (cgInt32)mParent->getLODData().size() - 1;
             
             // Finally, transform this value into a valid index for our skirt data array
             nNeighborLOD = nNeighborLOD - mCurrentLOD;
@@ -5981,6 +6926,25 @@ cgTerrainBlock * cgTerrainBlock::getNeighbor( EdgeSide index ) const
     return mNeighbors[ (cgInt)index ];
 }
 
+//-----------------------------------------------------------------------------
+// Name : isStandInNeighbor( ) (Protected)
+/// <summary>
+/// Determine if the block adjacent to the specified edge is not resident and
+/// is currently represented by its lowest LOD stand-in mesh.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgTerrainBlock::isStandInNeighbor( EdgeSide index ) const
+{
+    // Neighbor offsets in EdgeSide order (North, East, South, West).
+    static const cgInt32 Offsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+    const cgSize & Layout = mParent->getBlockLayout();
+    cgInt32 nX = (cgInt32)(mBlockIndex % Layout.width) + Offsets[index][0];
+    cgInt32 nZ = (cgInt32)(mBlockIndex / Layout.width) + Offsets[index][1];
+    if ( nX < 0 || nZ < 0 || nX >= Layout.width || nZ >= Layout.height )
+        return false;
+    return mParent->hasBlockStandIn( nX + nZ * Layout.width );
+}
+
 //-----------------------------------------------------------------------------
 // Name : setNeighbor( )
 /// <summary>
@@ -6005,6 +6969,21 @@ cgLandscapeTextureData * cgTerrainBlock::getTextureData( ) const
     return mTextureData;
 }
 
+//-----------------------------------------------------------------------------
+// Name : getMemoryUsage ()
+/// <summary>
+/// Retrieve the approximate amount of memory (in bytes) consumed by the 
+/// vertex and texture data owned by this block.
+/// </summary>
+//-----------------------------------------------------------------------------
+size_t cgTerrainBlock::getMemoryUsage( ) const
+{
+    size_t nSize = (size_t)mActiveHeightMapBounds.width() * (size_t)mActiveHeightMapBounds.height() * sizeof(cgTerrainVertex);
+    if ( mTextureData != CG_NULL )
+        nSize += mTextureData->getMemoryUsage();
+    return nSize;
+}
+
 //-----------------------------------------------------------------------------
 // Name : getBlockIndex ()
 /// <summary>
@@ -8767,6 +9746,22 @@ bool cgLandscapeTextureData::isEmpty( ) const
     return mRenderBatches.empty();
 }
 
+//-----------------------------------------------------------------------------
+// Name : getMemoryUsage( )
+/// <summary>
+/// Retrieve the approximate amount of memory (in bytes) consumed by the layer
+/// blend maps and their combined textures.
+/// </summary>
+//-----------------------------------------------------------------------------
+size_t cgLandscapeTextureData::getMemoryUsage( ) const
+{
+    size_t nSize = 0;
+    for ( size_t i = 0; i < mLayers.size(); ++i )
+        nSize += mLayers[i]->blendMap.size() + mLayers[i]->blendMapPaint.size();
+    nSize += mCombinedBlendMaps.size() * (size_t)(mBlendMapSize.width * mBlendMapSize.height * 4);
+    return nSize;
+}
+
 //-----------------------------------------------------------------------------
 // Name : getPaintData ( )
 /// <summary>
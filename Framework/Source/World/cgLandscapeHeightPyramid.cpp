@@ -0,0 +1,581 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgLandscapeHeightPyramid.cpp                                       //
+//                                                                           //
+// Desc : Hierarchical min / max height pyramid built over a landscape       //
+//        heightmap, used to compute exact ray / terrain intersections.      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgLandscapeHeightPyramid Module Includes
+//-----------------------------------------------------------------------------
+#include <World/cgLandscapeHeightPyramid.h>
+#include <System/cgJobSystem.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace LandscapeHeightPyramid
+{
+    // Maximum number of pending regions during traversal (three siblings
+    // can remain pending at each level, plus the four being pushed).
+    const cgInt32 MaxStackSize = 3 * 32 + 4;
+
+    // Tolerance applied to barycentric coordinates to prevent rays slipping
+    // through the shared edges of adjacent triangles.
+    const cgFloat EdgeTolerance = 1e-5f;
+
+    // Data passed to the batch query jobs.
+    struct BatchData
+    {
+        const cgLandscapeHeightPyramid * pyramid;
+        cgLandscapeRayQuery            * queries;
+    };
+
+    // A region awaiting traversal.
+    struct StackEntry
+    {
+        cgInt32 level;
+        cgInt32 x;
+        cgInt32 z;
+    };
+
+    // Merge the specified height range into another.
+    inline void mergeRange( cgInt16 & minimum, cgInt16 & maximum, cgInt16 otherMin, cgInt16 otherMax )
+    {
+        if ( otherMin < minimum ) minimum = otherMin;
+        if ( otherMax > maximum ) maximum = otherMax;
+    }
+
+} // End Namespace : LandscapeHeightPyramid
+
+///////////////////////////////////////////////////////////////////////////////
+// cgLandscapeHeightPyramid Member Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgLandscapeHeightPyramid () (Constructor)
+/// <summary>
+/// Constructor for this class.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgLandscapeHeightPyramid::cgLandscapeHeightPyramid( )
+{
+    // Initialize variables to sensible defaults
+    mHeights    = CG_NULL;
+    mMapSize    = cgSize( 0, 0 );
+    mCellCount  = cgSize( 0, 0 );
+    mBlockCells = cgSize( 0, 0 );
+    mBlockLayout= cgSize( 0, 0 );
+    mOffset     = cgVector3( 0, 0, 0 );
+    mScale      = cgVector3( 1, 1, 1 );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgLandscapeHeightPyramid () (Destructor)
+/// <summary>
+/// Destructor for this class.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgLandscapeHeightPyramid::~cgLandscapeHeightPyramid( )
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear ()
+/// <summary>
+/// Release all pyramid data.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::clear( )
+{
+    mHeights    = CG_NULL;
+    mMapSize    = cgSize( 0, 0 );
+    mCellCount  = cgSize( 0, 0 );
+    mLevels.clear();
+    mBlockMask.clear();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isEmpty ()
+/// <summary>
+/// Determine if the pyramid currently contains any data.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscapeHeightPyramid::isEmpty( ) const
+{
+    return mLevels.empty();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setTransform ()
+/// <summary>
+/// Set the world space offset of the heightmap origin, and the scale applied
+/// to each heightmap quad (X and Z) and height unit (Y). This is consistent
+/// with the transformation applied to the landscape's rendered geometry.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::setTransform( const cgVector3 & offset, const cgVector3 & scale )
+{
+    mOffset = offset;
+    mScale  = scale;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : build ()
+/// <summary>
+/// Construct the pyramid over the specified heightmap. The block mask should
+/// contain one entry for each terrain block (in row major order) that is 
+/// non-zero wherever the block exists.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::build( const cgInt16 * heights, const cgSize & mapSize, const cgSize & blockSize, const cgByteArray & blockMask )
+{
+    clear();
+    if ( !heights || mapSize.width < 2 || mapSize.height < 2 || blockSize.width < 2 || blockSize.height < 2 )
+        return;
+
+    // Record heightmap properties.
+    mHeights        = heights;
+    mMapSize        = mapSize;
+    mCellCount      = cgSize( mapSize.width - 1, mapSize.height - 1 );
+    mBlockCells     = cgSize( blockSize.width - 1, blockSize.height - 1 );
+    mBlockLayout    = cgSize( (mCellCount.width + mBlockCells.width - 1) / mBlockCells.width, (mCellCount.height + mBlockCells.height - 1) / mBlockCells.height );
+    mBlockMask      = blockMask;
+    mBlockMask.resize( mBlockLayout.width * mBlockLayout.height, 0 );
+
+    // Allocate levels until a single region covers the entire heightmap.
+    cgInt32 width = mCellCount.width, height = mCellCount.height;
+    do
+    {
+        width  = (width + 1) / 2;
+        height = (height + 1) / 2;
+        mLevels.resize( mLevels.size() + 1 );
+        Level & level = mLevels.back();
+        level.width  = width;
+        level.height = height;
+        level.ranges.resize( width * height );
+    
+    } while ( width > 1 || height > 1 );
+
+    // Populate, finest level first.
+    for ( size_t i = 0; i < mLevels.size(); ++i )
+        updateLevel( i, 0, 0, mLevels[i].width - 1, mLevels[i].height - 1 );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : update ()
+/// <summary>
+/// Recompute the pyramid for the specified area of the heightmap (in 
+/// heightmap vertices) after its data has been altered.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::update( const cgRect & bounds )
+{
+    if ( mLevels.empty() )
+        return;
+
+    // Any quad that references an altered vertex must be updated.
+    cgInt32 minX = std::max<cgInt32>( 0, bounds.left - 1 );
+    cgInt32 minZ = std::max<cgInt32>( 0, bounds.top - 1 );
+    cgInt32 maxX = std::min<cgInt32>( mCellCount.width - 1, bounds.right );
+    cgInt32 maxZ = std::min<cgInt32>( mCellCount.height - 1, bounds.bottom );
+    if ( minX > maxX || minZ > maxZ )
+        return;
+
+    // Propagate up through each level.
+    for ( size_t i = 0; i < mLevels.size(); ++i )
+    {
+        minX >>= 1; minZ >>= 1;
+        maxX >>= 1; maxZ >>= 1;
+        updateLevel( i, minX, minZ, maxX, maxZ );
+    
+    } // Next level
+}
+
+//-----------------------------------------------------------------------------
+//  Name : updateLevel () (Protected)
+/// <summary>
+/// Recompute the height range of the specified regions (inclusive) within the
+/// given level from the level (or heightmap quads) below.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::updateLevel( size_t levelIndex, cgInt32 minX, cgInt32 minZ, cgInt32 maxX, cgInt32 maxZ )
+{
+    using namespace LandscapeHeightPyramid;
+    Level & level = mLevels[levelIndex];
+    const cgInt32 childWidth  = (levelIndex == 0) ? mCellCount.width  : mLevels[levelIndex-1].width;
+    const cgInt32 childHeight = (levelIndex == 0) ? mCellCount.height : mLevels[levelIndex-1].height;
+    for ( cgInt32 z = minZ; z <= maxZ; ++z )
+    {
+        for ( cgInt32 x = minX; x <= maxX; ++x )
+        {
+            // Start with an empty range.
+            Range range;
+            range.minimum = 32767;
+            range.maximum = -32768;
+            
+            // Merge the (up to) four children.
+            const cgInt32 childMaxX = std::min<cgInt32>( x * 2 + 1, childWidth - 1 );
+            const cgInt32 childMaxZ = std::min<cgInt32>( z * 2 + 1, childHeight - 1 );
+            for ( cgInt32 cz = z * 2; cz <= childMaxZ; ++cz )
+            {
+                for ( cgInt32 cx = x * 2; cx <= childMaxX; ++cx )
+                {
+                    const Range child = (levelIndex == 0) ? getCellRange( cx, cz ) : mLevels[levelIndex-1].ranges[cx + cz * childWidth];
+                    mergeRange( range.minimum, range.maximum, child.minimum, child.maximum );
+                
+                } // Next child column
+            
+            } // Next child row
+            level.ranges[x + z * level.width] = range;
+        
+        } // Next column
+    
+    } // Next row
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isCellPresent () (Protected)
+/// <summary>
+/// Determine if the specified heightmap quad belongs to a terrain block that
+/// exists.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscapeHeightPyramid::isCellPresent( cgInt32 x, cgInt32 z ) const
+{
+    const cgInt32 blockX = x / mBlockCells.width;
+    const cgInt32 blockZ = z / mBlockCells.height;
+    return ( mBlockMask[ blockX + blockZ * mBlockLayout.width ] != 0 );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCellRange () (Protected)
+/// <summary>
+/// Compute the height range of the specified heightmap quad (empty if the
+/// quad does not belong to an existing terrain block).
+/// </summary>
+//-----------------------------------------------------------------------------
+cgLandscapeHeightPyramid::Range cgLandscapeHeightPyramid::getCellRange( cgInt32 x, cgInt32 z ) const
+{
+    Range range;
+    range.minimum = 32767;
+    range.maximum = -32768;
+    if ( !isCellPresent( x, z ) )
+        return range;
+
+    const cgInt16 * row0 = mHeights + x + z * mMapSize.width;
+    const cgInt16 * row1 = row0 + mMapSize.width;
+    range.minimum = std::min( std::min( row0[0], row0[1] ), std::min( row1[0], row1[1] ) );
+    range.maximum = std::max( std::max( row0[0], row0[1] ), std::max( row1[0], row1[1] ) );
+    return range;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getWorldHeight () (Protected)
+/// <summary>
+/// Retrieve the world space height of the specified heightmap vertex.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgLandscapeHeightPyramid::getWorldHeight( cgInt32 x, cgInt32 z ) const
+{
+    return (cgFloat)mHeights[ x + z * mMapSize.width ] * mScale.y + mOffset.y;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersect ()
+/// <summary>
+/// Compute the closest point at which the specified ray intersects the 
+/// terrain, if at all. The ray extends from the origin to (origin + 
+/// velocity), and 't' is returned as a multiple of the velocity in the range
+/// [0, 1]. The result is exact with respect to the triangulation of the 
+/// heightmap used by the landscape.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscapeHeightPyramid::intersect( const cgVector3 & origin, const cgVector3 & velocity, cgFloat & t ) const
+{
+    cgLandscapeRayHit hit;
+    if ( !intersect( origin, velocity, hit ) )
+        return false;
+    t = hit.t;
+    return true;
+}
+bool cgLandscapeHeightPyramid::intersect( const cgVector3 & origin, const cgVector3 & velocity, cgLandscapeRayHit & hit ) const
+{
+    using namespace LandscapeHeightPyramid;
+    if ( mLevels.empty() || mScale.x == 0 || mScale.z == 0 )
+        return false;
+
+    // Transform the ray into heightmap grid space. Since this is an affine
+    // transformation, distances along the ray ('t') remain unchanged.
+    GridRay ray;
+    ray.origin[0]    =  (origin.x - mOffset.x) / mScale.x;
+    ray.origin[1]    =  origin.y;
+    ray.origin[2]    = -(origin.z - mOffset.z) / mScale.z;
+    ray.direction[0] =  velocity.x / mScale.x;
+    ray.direction[1] =  velocity.y;
+    ray.direction[2] = -velocity.z / mScale.z;
+    for ( cgInt32 i = 0; i < 3; ++i )
+        ray.invDirection[i] = (fabsf( ray.direction[i] ) > CGE_EPSILON_1UM) ? 1.0f / ray.direction[i] : 0.0f;
+
+    // Determine the order in which child regions should be visited such that
+    // those closest to the ray origin are processed first.
+    const cgInt32 nearX = (ray.direction[0] >= 0) ? 0 : 1;
+    const cgInt32 nearZ = (ray.direction[2] >= 0) ? 0 : 1;
+
+    // Traverse from the single region at the top of the pyramid.
+    StackEntry stack[MaxStackSize];
+    cgInt32 stackSize = 0;
+    stack[stackSize].level = (cgInt32)mLevels.size() - 1;
+    stack[stackSize].x     = 0;
+    stack[stackSize].z     = 0;
+    ++stackSize;
+    
+    cgFloat closestT = 1.0f;
+    bool    found    = false;
+    while ( stackSize > 0 )
+    {
+        const StackEntry entry = stack[--stackSize];
+        const Level    & level = mLevels[entry.level];
+        const cgInt32    span  = 2 << entry.level;
+
+        // Skip this region if the ray does not pass through its bounds
+        // (or any closer than the current closest intersection).
+        const cgInt32 minX = entry.x * span, maxX = std::min<cgInt32>( minX + span, mCellCount.width );
+        const cgInt32 minZ = entry.z * span, maxZ = std::min<cgInt32>( minZ + span, mCellCount.height );
+        if ( !intersectRange( ray, level.ranges[entry.x + entry.z * level.width], minX, minZ, maxX, maxZ, closestT ) )
+            continue;
+
+        // At the finest level, test the quads directly.
+        if ( entry.level == 0 )
+        {
+            for ( cgInt32 z = minZ; z < maxZ; ++z )
+            {
+                for ( cgInt32 x = minX; x < maxX; ++x )
+                {
+                    cgFloat cellT;
+                    cgInt32 triangle;
+                    if ( intersectCell( ray, x, z, cellT, triangle ) && cellT <= closestT )
+                    {
+                        closestT     = cellT;
+                        hit.cellX    = x;
+                        hit.cellZ    = z;
+                        hit.triangle = triangle;
+                        found        = true;
+                    
+                    } // End if closer
+                
+                } // Next column
+            
+            } // Next row
+            continue;
+        
+        } // End if finest
+
+        // Push the children (furthest first so that the nearest is popped first).
+        const Level & childLevel = mLevels[entry.level - 1];
+        for ( cgInt32 i = 3; i >= 0; --i )
+        {
+            const cgInt32 childX = entry.x * 2 + ((i & 1) ^ nearX);
+            const cgInt32 childZ = entry.z * 2 + (((i >> 1) & 1) ^ nearZ);
+            if ( childX >= childLevel.width || childZ >= childLevel.height )
+                continue;
+            stack[stackSize].level = entry.level - 1;
+            stack[stackSize].x     = childX;
+            stack[stackSize].z     = childZ;
+            ++stackSize;
+        
+        } // Next child
+
+    } // Next region
+
+    if ( !found )
+        return false;
+
+    // Compute the world space normal of the triangle that was struck.
+    const cgInt32 x = hit.cellX, z = hit.cellZ;
+    cgVector3 v0( mOffset.x + (cgFloat)x * mScale.x, getWorldHeight( x, z ), mOffset.z - (cgFloat)z * mScale.z );
+    cgVector3 v1, v2;
+    if ( hit.triangle == 0 )
+    {
+        v1 = cgVector3( v0.x + mScale.x, getWorldHeight( x + 1, z ), v0.z );
+        v2 = cgVector3( v0.x + mScale.x, getWorldHeight( x + 1, z + 1 ), v0.z - mScale.z );
+    
+    } // End if top right
+    else
+    {
+        v1 = cgVector3( v0.x + mScale.x, getWorldHeight( x + 1, z + 1 ), v0.z - mScale.z );
+        v2 = cgVector3( v0.x, getWorldHeight( x, z + 1 ), v0.z - mScale.z );
+    
+    } // End if bottom left
+    cgVector3::cross( hit.normal, v2 - v0, v1 - v0 );
+    cgVector3::normalize( hit.normal, hit.normal );
+    if ( hit.normal.y < 0 )
+        hit.normal = -hit.normal;
+    hit.t = closestT;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersectBatch ()
+/// <summary>
+/// Intersect a batch of rays at once (i.e. line of sight tests for many
+/// agents). Queries are distributed across any available job system worker
+/// threads. The pyramid must not be modified while the batch executes.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::intersectBatch( cgLandscapeRayQuery queries[], cgUInt32 queryCount ) const
+{
+    LandscapeHeightPyramid::BatchData data;
+    data.pyramid = this;
+    data.queries = queries;
+    cgJobSystem::parallelFor( queryCount, 0, executeQueries, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : executeQueries () (Protected, Static)
+/// <summary>
+/// Job system callback that executes the specified range of batch queries.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgLandscapeHeightPyramid::executeQueries( cgUInt32 first, cgUInt32 last, void * context )
+{
+    LandscapeHeightPyramid::BatchData * data = (LandscapeHeightPyramid::BatchData*)context;
+    for ( cgUInt32 i = first; i < last; ++i )
+    {
+        cgLandscapeRayQuery & query = data->queries[i];
+        query.intersected = data->pyramid->intersect( query.origin, query.velocity, query.hit );
+    
+    } // Next query
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersectRange () (Protected)
+/// <summary>
+/// Determine if the grid space ray passes through the box described by the
+/// specified quad range (exclusive maximum) and height range, within the 
+/// interval [0, maximumT].
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscapeHeightPyramid::intersectRange( const GridRay & ray, const Range & range, cgInt32 minX, cgInt32 minZ, cgInt32 maxX, cgInt32 maxZ, cgFloat maximumT ) const
+{
+    // Empty regions are never intersected.
+    if ( range.minimum > range.maximum )
+        return false;
+
+    // Build the box.
+    cgFloat boxMin[3], boxMax[3];
+    boxMin[0] = (cgFloat)minX;
+    boxMax[0] = (cgFloat)maxX;
+    boxMin[1] = (cgFloat)range.minimum * mScale.y + mOffset.y;
+    boxMax[1] = (cgFloat)range.maximum * mScale.y + mOffset.y;
+    boxMin[2] = (cgFloat)minZ;
+    boxMax[2] = (cgFloat)maxZ;
+    if ( boxMin[1] > boxMax[1] )
+        std::swap( boxMin[1], boxMax[1] );
+
+    // Slab test.
+    cgFloat tMin = 0.0f, tMax = maximumT;
+    for ( cgInt32 i = 0; i < 3; ++i )
+    {
+        if ( ray.invDirection[i] == 0.0f )
+        {
+            // Ray is parallel to this slab.
+            if ( ray.origin[i] < boxMin[i] || ray.origin[i] > boxMax[i] )
+                return false;
+        
+        } // End if parallel
+        else
+        {
+            cgFloat t1 = (boxMin[i] - ray.origin[i]) * ray.invDirection[i];
+            cgFloat t2 = (boxMax[i] - ray.origin[i]) * ray.invDirection[i];
+            if ( t1 > t2 )
+                std::swap( t1, t2 );
+            if ( t1 > tMin ) tMin = t1;
+            if ( t2 < tMax ) tMax = t2;
+            if ( tMin > tMax )
+                return false;
+        
+        } // End if crosses slab
+    
+    } // Next axis
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : intersectCell () (Protected)
+/// <summary>
+/// Intersect the grid space ray with the two triangles of the specified 
+/// heightmap quad, returning the closest intersection (if any). Triangles 
+/// are split along the top left to bottom right diagonal, matching the
+/// triangulation used by 'cgTerrainBlock::getTerrainHeight()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgLandscapeHeightPyramid::intersectCell( const GridRay & ray, cgInt32 x, cgInt32 z, cgFloat & t, cgInt32 & triangle ) const
+{
+    using namespace LandscapeHeightPyramid;
+    if ( !isCellPresent( x, z ) )
+        return false;
+
+    // Corner positions in grid space (top left, top right, bottom left, bottom right).
+    const cgFloat fx = (cgFloat)x, fz = (cgFloat)z;
+    const cgFloat corners[4][3] = 
+    {
+        { fx,        getWorldHeight( x,     z     ), fz        },
+        { fx + 1.0f, getWorldHeight( x + 1, z     ), fz        },
+        { fx,        getWorldHeight( x,     z + 1 ), fz + 1.0f },
+        { fx + 1.0f, getWorldHeight( x + 1, z + 1 ), fz + 1.0f }
+    };
+    static const cgInt32 triangles[2][3] = { { 0, 1, 3 }, { 0, 3, 2 } };
+
+    bool found = false;
+    for ( cgInt32 i = 0; i < 2; ++i )
+    {
+        const cgFloat * v0 = corners[triangles[i][0]];
+        const cgFloat * v1 = corners[triangles[i][1]];
+        const cgFloat * v2 = corners[triangles[i][2]];
+        const cgFloat e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+        const cgFloat e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+        const cgFloat * d   = ray.direction;
+
+        // Moller-Trumbore (two sided).
+        const cgFloat p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        const cgFloat det  = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if ( fabsf( det ) < 1e-12f )
+            continue;
+        const cgFloat invDet = 1.0f / det;
+        const cgFloat s[3]   = { ray.origin[0] - v0[0], ray.origin[1] - v0[1], ray.origin[2] - v0[2] };
+        const cgFloat u      = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+        if ( u < -EdgeTolerance || u > 1.0f + EdgeTolerance )
+            continue;
+        const cgFloat q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        const cgFloat v    = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+        if ( v < -EdgeTolerance || u + v > 1.0f + EdgeTolerance )
+            continue;
+        const cgFloat triangleT = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+        if ( triangleT < 0.0f || (found && triangleT >= t) )
+            continue;
+        t        = triangleT;
+        triangle = i;
+        found    = true;
+    
+    } // Next triangle
+    return found;
+}
@@ -31,6 +31,7 @@
 #include <Resources/cgResourceManager.h>
 #include <Resources/cgScript.h>
 #include <System/cgMessageTypes.h>
+#include <Scripting/cgScriptEngine.h>
 
 //-----------------------------------------------------------------------------
 // Static member definitions.
@@ -396,14 +397,13 @@ void cgObjectBehavior::setUserId( cgUInt32 identifier )
 void cgObjectBehavior::onDetach( cgObjectNode * pNode )
 {
     // Notify the script that we're detaching
-    if ( mScriptObject && cgGetSandboxMode() != cgSandboxMode::Enabled )
+    if ( mScriptObject && mScriptMethods.onDetach && cgGetSandboxMode() != cgSandboxMode::Enabled )
     {
-        // ToDo: Cache onDetach script methods.
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Object, _T("ObjectNode@+"), pNode ) );
-            mScriptObject->executeMethodVoid( _T("onDetach"), ScriptArgs, true );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onDetach );
+            context->SetArgObject( 0, pNode );
+            mScriptObject->executePrepared( context );
 
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -426,14 +426,13 @@ void cgObjectBehavior::onDetach( cgObjectNode * pNode )
 void cgObjectBehavior::onAttach( cgObjectNode * pNode )
 {
     // Notify the script that we're attaching
-    if ( mScriptObject && cgGetSandboxMode() != cgSandboxMode::Enabled )
+    if ( mScriptObject && mScriptMethods.onAttach && cgGetSandboxMode() != cgSandboxMode::Enabled )
     {
-        // ToDo: Cache onAttach script methods.
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Object, _T("ObjectNode@+"), pNode ) );
-            mScriptObject->executeMethodVoid( _T("onAttach"), ScriptArgs, true );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onAttach );
+            context->SetArgObject( 0, pNode );
+            mScriptObject->executePrepared( context );
 
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -576,6 +575,8 @@ bool cgObjectBehavior::bindToScript( cgScriptInterop::Utils::ObjectSerializer *
         // Collect handles to any supplied update methods.
         if ( mScriptObject )
         {
+            mScriptMethods.onAttach            = mScriptObject->getMethodHandle( _T("void onAttach(ObjectNode@+)") );
+            mScriptMethods.onDetach            = mScriptObject->getMethodHandle( _T("void onDetach(ObjectNode@+)") );
             mScriptMethods.onUpdate            = mScriptObject->getMethodHandle( _T("void onUpdate(float)") );
             mScriptMethods.onPrePhysicsStep    = mScriptObject->getMethodHandle( _T("void onPrePhysicsStep(float)") );
             mScriptMethods.onPostPhysicsStep   = mScriptObject->getMethodHandle( _T("void onPostPhysicsStep(float)") );
@@ -626,10 +627,10 @@ void cgObjectBehavior::onMouseMove( const cgPoint & Position, const cgPointF & O
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, _T("const Point &"), (void*)&Position ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, _T("const Vector2 &"), (void*)&Offset ) );
-            mScriptObject->executeMethod( mScriptMethods.onMouseMove, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onMouseMove );
+            context->SetArgAddress( 0, (void*)&Position );
+            context->SetArgAddress( 1, (void*)&Offset );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -655,10 +656,10 @@ void cgObjectBehavior::onMouseButtonDown( cgInt32 nButtons, const cgPoint & Posi
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nButtons ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, _T("const Point &"), (void*)&Position ) );
-            mScriptObject->executeMethod( mScriptMethods.onMouseButtonDown, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onMouseButtonDown );
+            context->SetArgDWord( 0, (asDWORD)nButtons );
+            context->SetArgAddress( 1, (void*)&Position );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -684,10 +685,10 @@ void cgObjectBehavior::onMouseButtonUp( cgInt32 nButtons, const cgPoint & Positi
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nButtons ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, _T("const Point &"), (void*)&Position ) );
-            mScriptObject->executeMethod( mScriptMethods.onMouseButtonUp, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onMouseButtonUp );
+            context->SetArgDWord( 0, (asDWORD)nButtons );
+            context->SetArgAddress( 1, (void*)&Position );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -713,10 +714,10 @@ void cgObjectBehavior::onMouseWheelScroll( cgInt32 nDelta, const cgPoint & Posit
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nDelta ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, _T("const Point &"), (void*)&Position ) );
-            mScriptObject->executeMethod( mScriptMethods.onMouseWheelScroll, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onMouseWheelScroll );
+            context->SetArgDWord( 0, (asDWORD)nDelta );
+            context->SetArgAddress( 1, (void*)&Position );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -742,10 +743,10 @@ void cgObjectBehavior::onKeyDown( cgInt32 nKeyCode, cgUInt32 nModifiers )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nKeyCode ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("uint"), &nModifiers ) );
-            mScriptObject->executeMethod( mScriptMethods.onKeyDown, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onKeyDown );
+            context->SetArgDWord( 0, (asDWORD)nKeyCode );
+            context->SetArgDWord( 1, (asDWORD)nModifiers );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -771,10 +772,10 @@ void cgObjectBehavior::onKeyUp( cgInt32 nKeyCode, cgUInt32 nModifiers )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nKeyCode ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("uint"), &nModifiers ) );
-            mScriptObject->executeMethod( mScriptMethods.onKeyUp, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onKeyUp );
+            context->SetArgDWord( 0, (asDWORD)nKeyCode );
+            context->SetArgDWord( 1, (asDWORD)nModifiers );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -801,10 +802,10 @@ void cgObjectBehavior::onKeyPressed( cgInt32 nKeyCode, cgUInt32 nModifiers )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("int"), &nKeyCode ) );
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::DWord, _T("uint"), &nModifiers ) );
-            mScriptObject->executeMethod( mScriptMethods.onKeyPressed, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onKeyPressed );
+            context->SetArgDWord( 0, (asDWORD)nKeyCode );
+            context->SetArgDWord( 1, (asDWORD)nModifiers );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -831,10 +832,9 @@ void cgObjectBehavior::onPrePhysicsStep( cgPhysicsWorld * sender, cgPhysicsWorld
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("float");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Float, strArgType, &e->step ) );
-            mScriptObject->executeMethod( mScriptMethods.onPrePhysicsStep, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onPrePhysicsStep );
+            context->SetArgFloat( 0, e->step );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -861,10 +861,9 @@ void cgObjectBehavior::onPostPhysicsStep( cgPhysicsWorld * sender, cgPhysicsWorl
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("float");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Float, strArgType, &e->step ) );
-            mScriptObject->executeMethod( mScriptMethods.onPostPhysicsStep, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onPostPhysicsStep );
+            context->SetArgFloat( 0, e->step );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -890,10 +889,9 @@ void cgObjectBehavior::onUpdate( cgFloat fElapsedTime )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("float");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Float, strArgType, &fElapsedTime ) );
-            mScriptObject->executeMethod( mScriptMethods.onUpdate, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onUpdate );
+            context->SetArgFloat( 0, fElapsedTime );
+            mScriptObject->executePrepared( context );
         
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -920,10 +918,9 @@ void cgObjectBehavior::onCollisionBegin( const cgNodeCollision * collision )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("const NodeCollision &");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, strArgType, collision ) );
-            mScriptObject->executeMethod( mScriptMethods.onCollisionBegin, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onCollisionBegin );
+            context->SetArgAddress( 0, (void*)collision );
+            mScriptObject->executePrepared( context );
 
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -950,10 +947,9 @@ void cgObjectBehavior::onCollisionContinue( const cgNodeCollision * collision )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("const NodeCollision &");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, strArgType, collision ) );
-            mScriptObject->executeMethod( mScriptMethods.onCollisionContinue, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onCollisionContinue );
+            context->SetArgAddress( 0, (void*)collision );
+            mScriptObject->executePrepared( context );
 
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -980,10 +976,9 @@ void cgObjectBehavior::onCollisionEnd( const cgNodeCollision * collision )
     {
         try
         {
-            cgScriptArgument::Array ScriptArgs;
-            static const cgString strArgType = _T("const NodeCollision &");
-            ScriptArgs.push_back( cgScriptArgument( cgScriptArgumentType::Address, strArgType, collision ) );
-            mScriptObject->executeMethod( mScriptMethods.onCollisionEnd, ScriptArgs );
+            asIScriptContext * context = mScriptObject->prepareMethod( mScriptMethods.onCollisionEnd );
+            context->SetArgAddress( 0, (void*)collision );
+            mScriptObject->executePrepared( context );
 
         } // End try to execute
         catch ( cgScriptInterop::Exceptions::ExecuteException & e )
@@ -34,6 +34,7 @@
 #include <World/cgScene.h>
 #include <World/cgVisibilitySet.h>
 #include <World/cgSphereTree.h>
+#include <World/cgSceneSpatialHash.h>
 #include <World/Objects/cgGroupObject.h>
 #include <World/Objects/cgTargetObject.h>
 #include <World/Elements/cgNavigationMeshElement.h>
@@ -48,6 +49,7 @@
 #include <System/cgExceptions.h>
 #include <System/cgMessageTypes.h>
 #include <Math/cgMathUtility.h>
+#include <Math/cgTransformBatch.h>
 
 // Auto-create initial physics shape.
 #include <World/Objects/Elements/cgBoxCollisionShapeElement.h>
@@ -64,6 +66,8 @@
 // Static member definitions.
 //-----------------------------------------------------------------------------
 cgObjectNode::InputChannelLUT   cgObjectNode::mRegisteredInputChannels;
+cgUInt32Array                   cgObjectNode::mFreeVisibilityIndices;
+cgUInt32                        cgObjectNode::mNextVisibilityIndex = 0;
 cgWorldQuery                    cgObjectNode::mNodeInsert;
 cgWorldQuery                    cgObjectNode::mNodeDelete;
 cgWorldQuery                    cgObjectNode::mNodeUpdateCell;
@@ -123,6 +127,21 @@ cgObjectNode::cgObjectNode( cgUInt32 referenceId, cgScene * scene ) : cgAnimatio
     mRenderClassId      = 1;        // Automatically assign to the 'default' render class.
     mCustomProperties   = new cgPropertyContainer();
     mPendingUpdateFIFO  = CG_NULL;
+    mBatchTransforms    = false;
+    mUpdateThreadSafe   = false;
+    mParallelUpdateStamp= 0;
+    mUpdateBucketSlot   = 0xFFFFFFFF;
+
+    // Issue a visibility index (reuse a released index where possible
+    // in order to keep the visibility set membership arrays compact).
+    if ( !mFreeVisibilityIndices.empty() )
+    {
+        mVisibilityIndex = mFreeVisibilityIndices.back();
+        mFreeVisibilityIndices.pop_back();
+    
+    } // End if reuse
+    else
+        mVisibilityIndex = mNextVisibilityIndex++;
 
     // Setup default flags.
     mFlags              = cgObjectNodeFlags::Visible;
@@ -173,6 +192,21 @@ cgObjectNode::cgObjectNode( cgUInt32 referenceId, cgScene * scene, cgObjectNode
     mPhysicsBody        = CG_NULL;
     mNavigationAgent    = CG_NULL;
     mRenderClassId      = init->mRenderClassId;
+    mBatchTransforms    = init->mBatchTransforms;
+    mUpdateThreadSafe   = init->mUpdateThreadSafe;
+    mParallelUpdateStamp= 0;
+    mUpdateBucketSlot   = 0xFFFFFFFF;
+
+    // Issue a visibility index (reuse a released index where possible
+    // in order to keep the visibility set membership arrays compact).
+    if ( !mFreeVisibilityIndices.empty() )
+    {
+        mVisibilityIndex = mFreeVisibilityIndices.back();
+        mFreeVisibilityIndices.pop_back();
+    
+    } // End if reuse
+    else
+        mVisibilityIndex = mNextVisibilityIndex++;
 
     // Duplicate flags that are important to us.
     mFlags              = 0;
@@ -243,6 +277,9 @@ cgObjectNode::~cgObjectNode()
     if ( mCustomProperties )
         mCustomProperties->scriptSafeDispose();
     mCustomProperties = CG_NULL;
+
+    // Our visibility index can now be reused.
+    mFreeVisibilityIndices.push_back( mVisibilityIndex );
 }
 
 //-----------------------------------------------------------------------------
@@ -288,6 +325,10 @@ void cgObjectNode::dispose( bool disposeBase )
     if ( mSceneTreeNode )
         mParentScene->getSceneTree()->removeSphere( mSceneTreeNode );
 
+    // And from the scene's spatial hash
+    if ( mParentScene && mParentScene->getSpatialHash() )
+        mParentScene->getSpatialHash()->remove( this );
+
     // ToDo: 9999 - Detaching silently may not be a good idea. Hinge joint as an example?
     // Silently detach all children from this object.
     cgObjectNodeList::iterator itChild;
@@ -415,6 +456,12 @@ void cgObjectNode::unload( bool unloadChildren )
 //  Name : update ()
 /// <summary>
 /// Base update process simply calls the behavior update functions.
+/// Note : Behaviors are deliberately updated here, via their virtual
+/// 'onUpdate()' method and in load order, rather than being collected across
+/// the scene and grouped by script type. Behavior scripts routinely read and
+/// modify the state of their own and other nodes, so they must run as part of
+/// their node's update in order to respect the ordering imposed by the scene
+/// update buckets and by derived classes that extend this method.
 /// </summary>
 //-----------------------------------------------------------------------------
 void cgObjectNode::update( cgFloat timeDelta )
@@ -972,6 +1019,19 @@ cgUInt32 cgObjectNode::getRenderClassId( ) const
     return mRenderClassId;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getVisibilityIndex()
+/// <summary>
+/// Retrieve the stable index that visibility sets use to record membership
+/// of this node. Indices are densely allocated and are reused once the node
+/// to which they were issued has been destroyed.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgObjectNode::getVisibilityIndex( ) const
+{
+    return mVisibilityIndex;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : queryReferenceType () (Virtual)
 /// <summary>
@@ -4994,6 +5054,70 @@ cgUInt32 cgObjectNode::getLastDirtyFrame( ) const
     return mLastDirtyFrame;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : enableBatchTransforms ()
+/// <summary>
+/// When enabled, any pending transform updates for this node and its child
+/// hierarchy will be resolved together in a single batched pass (see 
+/// cgTransformBatch) rather than one node at a time. This is most beneficial
+/// for large hierarchies that are animated as a whole such as skeletons.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgObjectNode::enableBatchTransforms( bool enable )
+{
+    mBatchTransforms = enable;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isBatchTransformsEnabled ()
+/// <summary>
+/// Determine if pending transform updates for this node and its child 
+/// hierarchy will be resolved together in a single batched pass.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgObjectNode::isBatchTransformsEnabled( ) const
+{
+    return mBatchTransforms;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setUpdateThreadSafe ()
+/// <summary>
+/// Declare that this node's 'update()' method may safely be executed on any
+/// thread, concurrently with the update of other thread-safe nodes. When 
+/// parallel updates are enabled for the parent scene, such nodes are
+/// distributed over the job system's worker threads. During this time, the
+/// node must only modify its own state; any deferred updates it triggers 
+/// that affect other nodes (child hierarchy, owner group, pending update 
+/// queue, ownership status) are automatically recorded and applied by the
+/// scene once all threads have completed. Pending transforms are resolved
+/// before the batch starts, so querying the node's own world transform is
+/// safe unless the node both moves itself and has an ancestor that is also
+/// updated concurrently. Nodes with attached behaviors are always updated 
+/// serially. Nodes that create or destroy other nodes, write to the world
+/// database, or call into the physics, audio or rendering systems during
+/// update must not be marked as thread-safe. A node may clear its own flag
+/// from within a parallel update in order to be updated serially from the
+/// next frame onward.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgObjectNode::setUpdateThreadSafe( bool threadSafe )
+{
+    mUpdateThreadSafe = threadSafe;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isUpdateThreadSafe ()
+/// <summary>
+/// Determine if this node has declared that its 'update()' method may be
+/// executed on any thread.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgObjectNode::isUpdateThreadSafe( ) const
+{
+    return mUpdateThreadSafe;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : resolvePendingUpdates ()
 /// <summary>
@@ -5083,11 +5207,17 @@ void cgObjectNode::onResolvePendingUpdates( cgUInt32 updates )
         // of whether or not the adjustment was due to a dynamics update, the physics body of 
         // any child object will be forcibly updated to match the new child transform. We 
         // acknowledge that this is not a valid  dynamics update but have no choice but to obey it.
-        mPendingUpdates &= ~cgDeferredUpdateFlags::Transforms;
-        if ( mParentNode )
-            setCellTransform( mLocalTransform * mParentNode->getCellTransform(), cgTransformSource::TransformResolve );
-        else
-            setCellTransform( mLocalTransform, cgTransformSource::TransformResolve );
+        // If batching was requested, attempt to resolve the transforms of this
+        // node and its entire pending child hierarchy in one pass.
+        if ( !mBatchTransforms || mChildren.empty() || !resolveBatchTransforms() )
+        {
+            mPendingUpdates &= ~cgDeferredUpdateFlags::Transforms;
+            if ( mParentNode )
+                setCellTransform( mLocalTransform * mParentNode->getCellTransform(), cgTransformSource::TransformResolve );
+            else
+                setCellTransform( mLocalTransform, cgTransformSource::TransformResolve );
+        
+        } // End if !batched
 
     } // End if update transform
 
@@ -5108,13 +5238,113 @@ void cgObjectNode::onResolvePendingUpdates( cgUInt32 updates )
     // not be referenced.
     if ( updates & cgDeferredUpdateFlags::OwnershipStatus )
     {
-        mPendingUpdates &= ~cgDeferredUpdateFlags::OwnershipStatus;
-        if ( mParentScene && mReferenceId )
-            mParentScene->updateObjectOwnership( this );
+        // Ownership updates modify shared scene structures and cannot be 
+        // processed during a parallel update. Leave the update pending and
+        // allow the scene to queue it for later resolution.
+        if ( mParentScene && mParentScene->isParallelUpdating() )
+        {
+            mParentScene->deferNodeUpdates( this, 0, 0 );
+        
+        } // End if parallel
+        else
+        {
+            mPendingUpdates &= ~cgDeferredUpdateFlags::OwnershipStatus;
+            if ( mParentScene && mReferenceId )
+                mParentScene->updateObjectOwnership( this );
+
+        } // End if serial
 
     } // End if update ownership
 }
 
+//-----------------------------------------------------------------------------
+//  Name : resolveBatchTransforms () (Protected)
+/// <summary>
+/// Resolve the pending transform updates for this node and all of its 
+/// descendants that are also awaiting transform resolution. Parent relative
+/// transforms are gathered (breadth first) into a cgTransformBatch and their
+/// final cell transforms computed in a single pass before being applied in
+/// hierarchy order. Returns false if this node cannot act as the root of a
+/// batch, in which case the caller should fall back to the standard path.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgObjectNode::resolveBatchTransforms( )
+{
+    // The batch relies on the cell transform of each node being exactly the
+    // product of its local transform and its parent's cell transform. If this
+    // node may alter its incoming transform, it cannot root a batch.
+    if ( !isBatchTransformCompatible() )
+        return false;
+
+    // Collect this node and all descendants awaiting transform resolution in
+    // breadth first order so that siblings are stored contiguously. Children
+    // of nodes that may alter their incoming transform are not included and
+    // will be resolved individually later.
+    cgObjectNodeArray nodes;
+    cgTransformBatch batch;
+    nodes.push_back( this );
+    batch.addTransform( mLocalTransform, -1 );
+    for ( size_t i = 0; i < nodes.size(); ++i )
+    {
+        cgObjectNode * node = nodes[i];
+        if ( i > 0 && !node->isBatchTransformCompatible() )
+            continue;
+
+        cgObjectNodeList::iterator itChild;
+        for ( itChild = node->mChildren.begin(); itChild != node->mChildren.end(); ++itChild )
+        {
+            cgObjectNode * child = *itChild;
+            if ( child->mPendingUpdates & cgDeferredUpdateFlags::Transforms )
+            {
+                nodes.push_back( child );
+                batch.addTransform( child->mLocalTransform, (cgInt32)i );
+            
+            } // End if pending
+        
+        } // Next child
+
+    } // Next node
+
+    // Compute all cell transforms relative to our parent.
+    if ( mParentNode )
+        batch.setRootTransform( mParentNode->getCellTransform() );
+    batch.compute();
+
+    // Apply the results in hierarchy order.
+    cgTransform cellTransform;
+    for ( size_t i = 0; i < nodes.size(); ++i )
+    {
+        cgObjectNode * node = nodes[i];
+        batch.getWorldTransform( cellTransform, (cgUInt32)i );
+        node->mPendingUpdates &= ~cgDeferredUpdateFlags::Transforms;
+        node->setCellTransform( cellTransform, cgTransformSource::TransformResolve );
+
+        // Descendant may now have been fully resolved.
+        if ( i > 0 && !node->mPendingUpdates && mParentScene )
+            mParentScene->resolvedNodeUpdates( node );
+    
+    } // Next node
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isBatchTransformCompatible () (Protected)
+/// <summary>
+/// Determine if the cell transform of this node will always be an exact copy
+/// of any transform supplied to 'setCellTransform()' during a transform 
+/// resolve. This is required in order for children to be processed as part
+/// of the same batch.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgObjectNode::isBatchTransformCompatible( ) const
+{
+    if ( mTargetNode || !canRotate() )
+        return false;
+    return (mTransformMethod == cgTransformMethod::Standard || mTransformMethod == cgTransformMethod::NoChildUpdate);
+}
+
 //-----------------------------------------------------------------------------
 //  Name : onAnimationTransformUpdated () (Virtual)
 /// <summary>
@@ -5176,6 +5406,17 @@ void cgObjectNode::nodeUpdated( cgUInt32 deferredUpdates, cgUInt32 childDeferred
     // Update local update tracking member.
     cgUInt32 oldUpdates = mPendingUpdates;
     mPendingUpdates |= deferredUpdates;
+
+    // During a parallel scene update, only state local to this node may be
+    // modified. The remainder is recorded by the scene and applied via
+    // 'propagateNodeUpdates()' once all threads have completed.
+    if ( mParentScene && mParentScene->isParallelUpdating() )
+    {
+        if ( mPendingUpdates != oldUpdates || childDeferredUpdates )
+            mParentScene->deferNodeUpdates( this, deferredUpdates, childDeferredUpdates );
+        return;
+    
+    } // End if parallel
     
     // Any updates supplied?
     if ( mPendingUpdates != oldUpdates )
@@ -5207,6 +5448,40 @@ void cgObjectNode::nodeUpdated( cgUInt32 deferredUpdates, cgUInt32 childDeferred
     } // End if queue children
 }
 
+//-----------------------------------------------------------------------------
+//  Name : propagateNodeUpdates () (Protected)
+/// <summary>
+/// Called by the parent scene once a parallel update has completed in order
+/// to apply the portion of a prior 'nodeUpdated()' call that could not be
+/// processed at the time (pending update queue insertion, owner group and
+/// child hierarchy notification).
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgObjectNode::propagateNodeUpdates( cgUInt32 deferredUpdates, cgUInt32 childDeferredUpdates )
+{
+    // Queue the node if it still has outstanding updates and is not
+    // already waiting in the scene's pending update queue.
+    if ( mParentScene && mPendingUpdates && !mPendingUpdateFIFO )
+        mParentScene->queueNodeUpdates( this );
+
+    // Trigger updates to bounding box of any owner group.
+    if ( mOwnerGroup && (deferredUpdates & cgDeferredUpdateFlags::BoundingBox) && 
+        !(mOwnerGroup->getPendingUpdates() & cgDeferredUpdateFlags::BoundingBox) )
+    {
+        cgUInt32 groupUpdates = cgDeferredUpdateFlags::BoundingBox | cgDeferredUpdateFlags::OwnershipStatus;
+        mOwnerGroup->nodeUpdated( groupUpdates, 0 );
+
+    } // End if group
+    
+    // Flood changes through the child hierarchy.
+    if ( childDeferredUpdates && !mChildren.empty())
+    {
+        for ( cgObjectNodeList::iterator itNode = mChildren.begin(); itNode != mChildren.end(); ++itNode )
+            (*itNode)->nodeUpdated( childDeferredUpdates, childDeferredUpdates );
+
+    } // End if queue children
+}
+
 //-----------------------------------------------------------------------------
 //  Name : registerVisibility () (Virtual)
 /// <summary>
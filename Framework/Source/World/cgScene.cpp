@@ -34,6 +34,7 @@
 #include <World/cgLandscape.h>
 #include <World/cgSceneElement.h>
 #include <World/cgSphereTree.h>
+#include <World/cgSceneSpatialHash.h>
 #include <World/cgBSPVisTree.h>
 #include <World/Lighting/cgLightingManager.h>
 #include <World/Objects/cgCameraObject.h>
@@ -57,6 +58,8 @@
 #include <System/cgMessageTypes.h>
 #include <System/cgExceptions.h>
 #include <System/cgProfiler.h>
+#include <System/cgThreading.h>
+#include <System/cgJobSystem.h>
 #include <Scripting/cgScriptEngine.h>
 #include <Math/cgMathUtility.h>
 #include <algorithm>
@@ -132,9 +135,17 @@ cgScene::cgScene( cgWorld * world, const cgSceneDescriptor * description )  : cg
     mActiveObjectElementType    = cgUID::Empty;
     mOnSceneRenderMethod        = CG_NULL;
     mSceneTree                  = CG_NULL;
+    mSpatialHash                = CG_NULL;
     mStaticVisTree              = CG_NULL;
     mIsUpdating                 = false;
 	mSuppressEvents				= false;
+    mParallelUpdatesEnabled     = true;
+    mIsParallelUpdating         = false;
+    mParallelUpdateStamp        = 0;
+    mParallelTimeDelta          = 0.0f;
+    mDeferredUpdates            = CG_NULL;
+    mDeferredUpdateBuffers      = 0;
+    mDeferredUpdateSection      = cgCriticalSection::createInstance();
 
     // Allocate the lighting manager on the heap
     mLightingManager            = new cgLightingManager( this );
@@ -149,6 +160,7 @@ cgScene::cgScene( cgWorld * world, const cgSceneDescriptor * description )  : cg
         mUpdateBuckets[i].lastUpdateTime = -1.0f;
         mUpdateBuckets[i].nextUpdateTime = -1.0f;
         mUpdateBuckets[i].locked         = false;
+        mUpdateBuckets[i].freeSlots      = 0;
     
     } // Next interval
 
@@ -174,6 +186,9 @@ cgScene::~cgScene()
         mLightingManager->scriptSafeDispose();
     mLightingManager = CG_NULL;
 
+    // Destroy constructor allocated synchronization objects.
+    delete mDeferredUpdateSection;
+    mDeferredUpdateSection = CG_NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -225,10 +240,17 @@ void cgScene::dispose( bool disposeBase )
         mUpdateBuckets[i].lastUpdateTime = -1.0f;
         mUpdateBuckets[i].nextUpdateTime = -1.0f;
         mUpdateBuckets[i].locked         = false;
+        mUpdateBuckets[i].freeSlots      = 0;
         mUpdateBuckets[i].nodes.clear();
     
     } // Next interval
 
+    // Release parallel update buffers.
+    delete []mDeferredUpdates;
+    mDeferredUpdates        = CG_NULL;
+    mDeferredUpdateBuffers  = 0;
+    mParallelNodes.clear();
+
     // Destroy any active landscape.
     if ( mLandscape )
         mLandscape->scriptSafeDispose();
@@ -276,9 +298,11 @@ void cgScene::dispose( bool disposeBase )
         mSceneTree->scriptSafeDispose();
     if ( mStaticVisTree )
         mStaticVisTree->scriptSafeDispose();
+    delete mSpatialHash;
 
     // Clear variables
     mSceneTree                  = CG_NULL;
+    mSpatialHash                = CG_NULL;
     mStaticVisTree              = CG_NULL;
     mPhysicsWorld               = CG_NULL;
     mActiveCamera               = CG_NULL;
@@ -541,6 +565,23 @@ bool cgScene::load( )
     mStaticVisTree = new cgBSPTree();
     mSceneTree = new cgSphereTree( 10000, 5, 0.6f, mStaticVisTree ); // TODO: Tailor sizes.
 
+    // Size the spatial hash cells from the scene's own cell layout (a quarter
+    // of the larger horizontal cell dimension) so that query spheres of
+    // typical gameplay radii touch only a handful of cells. Fall back to a
+    // fraction of the overall scene extent when no valid cell dimensions were
+    // described. Applications can override this at any time via
+    // 'getSpatialHash()->setCellSize()'.
+    cgFloat hashCellSize = max( mSceneDescriptor.cellDimensions.x, mSceneDescriptor.cellDimensions.z ) * 0.25f;
+    if ( hashCellSize <= CGE_EPSILON )
+    {
+        const cgVector3 sceneExtents = mSceneDescriptor.sceneBounds.getExtents();
+        hashCellSize = max( sceneExtents.x, sceneExtents.z ) / 32.0f;
+    
+    } // End if no cell dimensions
+    if ( hashCellSize <= CGE_EPSILON )
+        hashCellSize = 16.0f;
+    mSpatialHash = new cgSceneSpatialHash( hashCellSize );
+
     // Re-add any orphan visibility sets to the scene tree that may exist (during reloading).
     for ( size_t i = 0; i < mOrphanVisSets.size(); ++i )
         mSceneTree->addVisibilitySet( mOrphanVisSets[i] );
@@ -1284,6 +1325,11 @@ void cgScene::updateObjectOwnership( cgObjectNode * node )
         
         } // End if already in tree
     }
+
+    // Record the node's new position in the spatial hash used to
+    // accelerate proximity queries.
+    if ( mSpatialHash )
+        mSpatialHash->update( node, node->getPosition( false ) );
 }
 
 //-----------------------------------------------------------------------------
@@ -1323,6 +1369,27 @@ void cgScene::computeVisibility( const cgFrustum & frustum, cgVisibilitySet * vi
         mLandscape->computeVisibility( frustum, visibilityData, visibilityData->getSearchFlags(), CG_NULL );
 }
 
+//-----------------------------------------------------------------------------
+//  Name : computeVisibility ()
+/// <summary>
+/// Populate several visibility sets at once, each based on its matching
+/// frustum. The scene tree is walked only once for all views, with the work
+/// distributed across the job system.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::computeVisibility( const cgFrustum ** frustums, cgVisibilitySet ** visibilityData, cgUInt32 count )
+{
+    mSceneTree->computeVisibility( frustums, visibilityData, count );
+    
+    // Now request that all spatial trees compute their respective visibility.
+    if ( mLandscape )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+            mLandscape->computeVisibility( *frustums[i], visibilityData[i], visibilityData[i]->getSearchFlags(), CG_NULL );
+    
+    } // End if has landscape
+}
+
 //-----------------------------------------------------------------------------
 // Name : loadObjectNode() (Protected, Recursive)
 /// <summary>
@@ -1446,9 +1513,7 @@ cgObjectNode * cgScene::loadObjectNode( cgUInt32 rootReferenceId, cgUInt32 refer
     } // End if no parent
 
     // Add the node to the relevant update bucket if required
-    cgUpdateRate::Base updateRate = newNode->getUpdateRate();
-    if ( updateRate != cgUpdateRate::Never )
-        mUpdateBuckets[ updateRate ].nodes.push_back( newNode );
+    addToUpdateBucket( newNode );
 
     // If it was requested that we load children, do so now.
     if ( loadChildren )
@@ -1710,21 +1775,8 @@ void cgScene::unloadObjectNode( cgObjectNode * node, bool unloadChildren )
     if ( itNode != nodes.end() )
         nodes.erase( itNode );
 
-    // Remove the object from the appropriate update bucket if it is not locked.
-    cgObjectNodeList * bucket = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-    for ( cgObjectNodeList::iterator itBucketNode = bucket->begin(); itBucketNode != bucket->end(); ++itBucketNode )
-    {
-        if ( *itBucketNode == node )
-        {
-            if ( mUpdateBuckets[ node->mUpdateRate ].locked )
-                *itBucketNode = CG_NULL;
-            else
-                bucket->erase( itBucketNode );
-            break;
-        
-        } // End if matches
-
-    } // Next Node
+    // Remove the object from the appropriate update bucket.
+    removeFromUpdateBucket( node );
 
     // If this node exists at the root level in the hierarchy,
     // remove it from the root node list first of all.
@@ -1810,21 +1862,8 @@ void cgScene::unloadObjectNodes( cgObjectNodeMap & nodes )
 
         } // End if sandbox
 
-        // Remove the object from the appropriate update bucket if it is not locked.
-        cgObjectNodeList * bucket = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-        for ( cgObjectNodeList::iterator itBucketNode = bucket->begin(); itBucketNode != bucket->end(); ++itBucketNode )
-        {
-            if ( *itBucketNode == node )
-            {
-                if ( mUpdateBuckets[ node->mUpdateRate ].locked )
-                    *itBucketNode = CG_NULL;
-                else
-                    bucket->erase( itBucketNode );
-                break;
-            
-            } // End if matches
-
-        } // Next Node
+        // Remove the object from the appropriate update bucket.
+        removeFromUpdateBucket( node );
 
         // If this node exists at the root level in the hierarchy,
         // remove it from the root node list first of all.
@@ -2085,9 +2124,7 @@ cgObjectNode * cgScene::createObjectNode( bool internalNode, const cgUID & objec
         mRootNodes[ newNode->getReferenceId() ] = newNode;
 
     // Add the node to the relevant update bucket if required
-    cgUpdateRate::Base updateRate = newNode->getUpdateRate();
-    if ( updateRate != cgUpdateRate::Never )
-        mUpdateBuckets[ updateRate ].nodes.push_back( newNode );
+    addToUpdateBucket( newNode );
     
     // Automatically resolve any information which was not initially computed.
     newNode->resolvePendingUpdates( cgDeferredUpdateFlags::All );
@@ -2162,6 +2199,18 @@ cgSphereTree * cgScene::getSceneTree( ) const
     return mSceneTree;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getSpatialHash ()
+/// <summary>
+/// Retrieve the hashed grid that tracks the position of every object node
+/// in the scene, used to accelerate proximity queries.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgSceneSpatialHash * cgScene::getSpatialHash( ) const
+{
+    return mSpatialHash;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : getLightingManager ()
 /// <summary>
@@ -2331,32 +2380,14 @@ void cgScene::setObjectUpdateRate( cgObjectNode * node, cgUpdateRate::Base rate
         return;
 
     // First remove the object from its old list.
-    cgObjectNodeList::iterator itNode;
-    cgObjectNodeList * bucket = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-    for ( itNode = bucket->begin(); itNode != bucket->end(); ++itNode )
-    {
-        if ( *itNode == node )
-        {
-            if ( mUpdateBuckets[ node->mUpdateRate ].locked )
-                *itNode = CG_NULL;
-            else
-                bucket->erase( itNode );
-            break;
-        
-        } // End if matches
-    } // Next Node
+    removeFromUpdateBucket( node );
     
     // Update the node's internal rate record
     node->mUpdateRate = rate;
     node->serializeUpdateRate();
 
     // Add the node to the new update list if required
-    if ( rate != cgUpdateRate::Never )
-    {
-        bucket = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-        bucket->push_back( node );
-    
-    } // End if not the 'never' interval
+    addToUpdateBucket( node );
 }
 
 //-----------------------------------------------------------------------------
@@ -2420,41 +2451,10 @@ const cgObjectNodeArray & cgScene::getObjectNodesByType( const cgUID & type ) co
 //-----------------------------------------------------------------------------
 void cgScene::getObjectNodesInBounds( const cgVector3 & center, cgFloat radius, cgObjectNodeArray & nodesOut ) const
 {
-    // Clear output container first.
-    nodesOut.clear();
-
-    // Generate a broadphase bounding box for the volume
-    cgFloat radiusSq = (radius * radius);
-    cgBoundingBox broadBounds( center - cgVector3(radius, radius, radius), center + cgVector3(radius,radius,radius) );
-    broadBounds.inflate( 0.1f );
-
-    // Iterate through active cells.
-    cgSceneCellMap::const_iterator itCell;
-    for ( itCell = mCells.begin(); itCell != mCells.end(); ++itCell )
-    {
-        cgSceneCell * cell = itCell->second;
-
-        // Get the bounding box of the cell and test to see if the
-        // supplied bounds intersects with it in some way.
-        cgBoundingBox cellBounds = cell->getBoundingBox();
-        if ( cellBounds.intersect( broadBounds ) )
-        {
-            const cgObjectNodeSet & nodes = cell->getNodes();
-
-            // Iterate through the nodes in this cell and perform 
-            // actual test to see if the origin is within the sphere.
-            cgObjectNodeSet::const_iterator itNode;
-            for ( itNode = nodes.begin(); itNode != nodes.end(); ++itNode )
-            {
-                cgObjectNode * node = *itNode;
-                if ( cgVector3::lengthSq( node->getPosition() - center ) <= radiusSq )
-                    nodesOut.push_back( node );
-
-            } // Next node
-
-        } // End if intersecting
-
-    } // Next cell
+    if ( mSpatialHash )
+        mSpatialHash->querySphere( center, radius, nodesOut );
+    else
+        nodesOut.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -2466,40 +2466,67 @@ void cgScene::getObjectNodesInBounds( const cgVector3 & center, cgFloat radius,
 //-----------------------------------------------------------------------------
 void cgScene::getObjectNodesInBounds( const cgBoundingBox& bounds, cgObjectNodeArray & nodesOut ) const
 {
-    // Clear output container first.
-    nodesOut.clear();
+    if ( mSpatialHash )
+        mSpatialHash->queryBox( bounds, nodesOut );
+    else
+        nodesOut.clear();
+}
 
-    // Generate a broadphase bounding box for the volume.
-    cgBoundingBox broadBounds = bounds;
-    broadBounds.inflate( 0.1f );
+//-----------------------------------------------------------------------------
+//  Name : getObjectNodesInFrustum ()
+/// <summary>
+/// Populate the specified container with references to all allocated scene 
+/// object nodes whose origin falls within the specified frustum.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::getObjectNodesInFrustum( const cgFrustum & frustum, cgObjectNodeArray & nodesOut ) const
+{
+    if ( mSpatialHash )
+        mSpatialHash->queryFrustum( frustum, nodesOut );
+    else
+        nodesOut.clear();
+}
 
-    // Iterate through active cells.
-    cgSceneCellMap::const_iterator itCell;
-    for ( itCell = mCells.begin(); itCell != mCells.end(); ++itCell )
-    {
-        cgSceneCell * cell = itCell->second;
+//-----------------------------------------------------------------------------
+//  Name : getNearestObjectNodes ()
+/// <summary>
+/// Populate the specified container with references to (at most) the 
+/// specified number of object nodes closest to the supplied point, sorted
+/// by increasing distance. A maximum distance of 0 means unbounded.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::getNearestObjectNodes( const cgVector3 & center, cgUInt32 count, cgFloat maximumDistance, cgObjectNodeArray & nodesOut ) const
+{
+    if ( mSpatialHash )
+        mSpatialHash->queryNearest( center, count, maximumDistance, nodesOut );
+    else
+        nodesOut.clear();
+}
 
-        // Get the bounding box of the cell and test to see if the
-        // supplied bounds intersects with it in some way.
-        cgBoundingBox cellBounds = cell->getBoundingBox();
-        if ( cellBounds.intersect( broadBounds ) )
+//-----------------------------------------------------------------------------
+//  Name : queryObjectNodes ()
+/// <summary>
+/// Execute a batch of spatial queries against the scene's object nodes,
+/// distributing them across any available job system worker threads.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::queryObjectNodes( cgSpatialQuery queries[], cgUInt32 queryCount ) const
+{
+    if ( mSpatialHash )
+    {
+        mSpatialHash->queryBatch( queries, queryCount );
+    
+    } // End if valid
+    else
+    {
+        for ( cgUInt32 i = 0; i < queryCount; ++i )
         {
-            const cgObjectNodeSet & nodes = cell->getNodes();
-
-            // Iterate through the nodes in this cell and perform 
-            // actual test to see if the origin is within the box.
-            cgObjectNodeSet::const_iterator itNode;
-            for ( itNode = nodes.begin(); itNode != nodes.end(); ++itNode )
-            {
-                cgObjectNode * node = *itNode;
-                if ( bounds.containsPoint( node->getPosition() ) )
-                    nodesOut.push_back( node );
-
-            } // Next node
-
-        } // End if intersecting
-
-    } // Next cell
+            if ( queries[i].results )
+                queries[i].results->clear();
+        
+        } // Next query
+    
+    } // End if no hash
 }
 
 //-----------------------------------------------------------------------------
@@ -2863,30 +2890,7 @@ void cgScene::update( )
         mPhysicsWorld->update( (cgFloat)timeDelta );
 
     // Allow scene nodes to update. First iterate through the 'Always Update' list.
-    cgObjectNodeList::iterator itNode;
-    mUpdateBuckets[ cgUpdateRate::Always ].locked = true;
-    cgObjectNodeList * bucketNodes = &mUpdateBuckets[ cgUpdateRate::Always ].nodes;
-    for ( itNode = bucketNodes->begin(); itNode != bucketNodes->end(); )
-    {
-        cgObjectNode * node = *itNode;
-
-        // Remove the item from the list if it is NULL
-        if ( !node )
-        {
-            itNode = bucketNodes->erase( itNode );
-        
-        } // End if invalid
-        else
-        {
-            // Trigger the node's update process
-            if ( mUpdatingEnabled || (fullSandbox && node->allowSandboxUpdate()) )
-                node->update( (cgFloat)timeDelta );
-            ++itNode;
-
-        } // End if valid
-
-    } // Next scene node
-    mUpdateBuckets[ cgUpdateRate::Always ].locked = false;
+    updateBucket( mUpdateBuckets[ cgUpdateRate::Always ], (cgFloat)timeDelta, fullSandbox );
 
     // Now iterate through all other update rate buckets
     for ( cgUInt32 i = cgUpdateRate::FPS1; i < cgUpdateRate::Count; ++i )
@@ -2907,29 +2911,7 @@ void cgScene::update( )
             // Step through the list and update unless updates are disabled.
             // Still allow schedule / housekeeping to update so that times don't
             // get wildly out of control.
-            bucket->locked = true;
-            cgObjectNodeList * bucketNodes = &bucket->nodes;
-            for ( itNode = bucketNodes->begin(); itNode != bucketNodes->end(); )
-            {
-                cgObjectNode * node = *itNode;
-
-                // Remove the item from the list if it is NULL
-                if ( !node )
-                {
-                    itNode = bucketNodes->erase( itNode );
-                
-                } // End if invalid
-                else
-                {
-                    // Trigger the node's update process
-                    if ( mUpdatingEnabled || (fullSandbox && node->allowSandboxUpdate()) )
-                        node->update( finalDelta );
-                    ++itNode;
-                
-                } // End if valid
-
-            } // Next scene object
-            bucket->locked = false;
+            updateBucket( *bucket, finalDelta, fullSandbox );
             
             // Just for housekeeping purposes, record the last time an update was run
             bucket->lastUpdateTime = currentTime;
@@ -2982,12 +2964,27 @@ void cgScene::update( )
     if ( mActiveCamera && audioDriver )
         audioDriver->set3DListenerTransform( mActiveCamera->getWorldTransform() );
 
+    // Stream landscape blocks in / out around the active camera.
+    if ( mLandscape && mActiveCamera )
+        mLandscape->updateStreaming( mActiveCamera->getPosition() );
+
     // Updating is complete.
     mIsUpdating = false;
 
     // Resolve any deferred node updates.
     resolvePendingUpdates();
 
+    // Rebuild any navigation tiles invalidated by changes to static
+    // geometry (moved meshes, landscape edits) during this update.
+    SceneElementTypeMap::iterator itElement = mElementTypes.find( RTID_NavigationMeshElement );
+    if ( itElement != mElementTypes.end() )
+    {
+        cgSceneElementArray & elements = itElement->second;
+        for ( size_t i = 0; i < elements.size(); ++i )
+            static_cast<cgNavigationMeshElement*>(elements[i])->rebuildInvalidRegion();
+    
+    } // End if has navigation
+
     // Allow scene tree to resolve.
     mSceneTree->process();
 
@@ -2995,6 +2992,269 @@ void cgScene::update( )
     profiler->endProcess( );
 }
 
+//-----------------------------------------------------------------------------
+//  Name : updateBucket () (Protected)
+/// <summary>
+/// Trigger the update process for all nodes in the specified update rate 
+/// bucket. If parallel updates are enabled, nodes that have declared 
+/// themselves thread-safe are first updated concurrently via the job system
+/// before all remaining nodes are updated serially in their original order.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::updateBucket( UpdateBucket & bucket, cgFloat timeDelta, bool fullSandbox )
+{
+    cgObjectNodeArray & nodes = bucket.nodes;
+
+    // Compact the bucket if any nodes were removed since it was last
+    // processed (retaining the original update order).
+    if ( bucket.freeSlots )
+    {
+        size_t count = 0;
+        for ( size_t i = 0; i < nodes.size(); ++i )
+        {
+            cgObjectNode * node = nodes[i];
+            if ( node )
+            {
+                node->mUpdateBucketSlot = (cgUInt32)count;
+                nodes[count++] = node;
+            
+            } // End if valid
+        
+        } // Next node
+        nodes.resize( count );
+        bucket.freeSlots = 0;
+    
+    } // End if compact
+
+    // Nothing to do?
+    if ( nodes.empty() )
+        return;
+
+    // Bucket may not be compacted while we process it.
+    bucket.locked = true;
+
+    // Update all thread-safe nodes in parallel first if enabled. Nodes with
+    // attached behaviors are always updated serially since behaviors may
+    // execute script code.
+    cgUInt32 batchStamp = 0;
+    const bool parallel = ( mParallelUpdatesEnabled && cgJobSystem::getWorkerCount() > 0 );
+    if ( parallel )
+    {
+        mParallelNodes.clear();
+        for ( size_t i = 0; i < nodes.size(); ++i )
+        {
+            cgObjectNode * node = nodes[i];
+            if ( node && node->mUpdateThreadSafe && node->mBehaviors.empty() && 
+                (mUpdatingEnabled || (fullSandbox && node->allowSandboxUpdate())) )
+                mParallelNodes.push_back( node );
+        
+        } // Next node
+
+        if ( !mParallelNodes.empty() )
+        {
+            // Tag every node in the batch so that the serial pass can skip 
+            // exactly those nodes that were updated here (irrespective of 
+            // any flags they change during their update). Pending transforms
+            // are also resolved up front so that nodes querying their world
+            // transform do not resolve shared ancestors concurrently.
+            if ( ++mParallelUpdateStamp == 0 )
+                mParallelUpdateStamp = 1;
+            batchStamp = mParallelUpdateStamp;
+            for ( size_t i = 0; i < mParallelNodes.size(); ++i )
+            {
+                mParallelNodes[i]->mParallelUpdateStamp = batchStamp;
+                mParallelNodes[i]->resolvePendingUpdates( cgDeferredUpdateFlags::Transforms );
+            
+            } // Next node
+
+            // Allocate a deferred update buffer for each thread that may participate.
+            const cgUInt32 bufferCount = cgJobSystem::getWorkerCount() + 1;
+            if ( mDeferredUpdateBuffers != bufferCount )
+            {
+                delete []mDeferredUpdates;
+                mDeferredUpdates       = new DeferredUpdateArray[ bufferCount ];
+                mDeferredUpdateBuffers = bufferCount;
+            
+            } // End if reallocate
+
+            // Distribute node updates over all available threads.
+            mParallelTimeDelta  = timeDelta;
+            mIsParallelUpdating = true;
+            cgJobSystem::parallelFor( (cgUInt32)mParallelNodes.size(), 0, updateNodeRange, this );
+            mIsParallelUpdating = false;
+            mParallelNodes.clear();
+
+            // Apply any side effects recorded during the parallel update.
+            flushDeferredUpdates();
+
+        } // End if any
+    
+    } // End if parallel
+
+    // Update remaining nodes. New nodes may be added to the bucket during 
+    // this process, so the size must be re-evaluated on each iteration.
+    for ( size_t i = 0; i < nodes.size(); ++i )
+    {
+        cgObjectNode * node = nodes[i];
+        if ( !node )
+            continue;
+
+        // Skip nodes that were already updated in parallel.
+        if ( batchStamp && node->mParallelUpdateStamp == batchStamp )
+            continue;
+
+        // Trigger the node's update process
+        if ( mUpdatingEnabled || (fullSandbox && node->allowSandboxUpdate()) )
+            node->update( timeDelta );
+    
+    } // Next node
+    bucket.locked = false;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : updateNodeRange () (Protected, Static)
+/// <summary>
+/// Job system callback used to update a range of thread-safe nodes during a
+/// parallel update.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::updateNodeRange( cgUInt32 first, cgUInt32 last, void * context )
+{
+    cgScene * scene = (cgScene*)context;
+    for ( cgUInt32 i = first; i < last; ++i )
+        scene->mParallelNodes[i]->update( scene->mParallelTimeDelta );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : flushDeferredUpdates () (Protected)
+/// <summary>
+/// Apply all node updates that were deferred during the most recent parallel
+/// update (see 'deferNodeUpdates()').
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::flushDeferredUpdates( )
+{
+    for ( cgUInt32 i = 0; i < mDeferredUpdateBuffers; ++i )
+    {
+        DeferredUpdateArray & updates = mDeferredUpdates[i];
+        for ( size_t j = 0; j < updates.size(); ++j )
+        {
+            const DeferredNodeUpdate & update = updates[j];
+            update.node->propagateNodeUpdates( update.deferredUpdates, update.childDeferredUpdates );
+        
+        } // Next update
+        updates.clear();
+    
+    } // Next buffer
+}
+
+//-----------------------------------------------------------------------------
+//  Name : deferNodeUpdates ()
+/// <summary>
+/// Called by a node during a parallel update in order to record update side
+/// effects that cannot be safely applied until all threads have completed.
+/// Each thread records into its own buffer, and all buffers are applied 
+/// before the scene resolves its pending node updates.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::deferNodeUpdates( cgObjectNode * node, cgUInt32 deferredUpdates, cgUInt32 childDeferredUpdates )
+{
+    DeferredNodeUpdate update;
+    update.node                 = node;
+    update.deferredUpdates      = deferredUpdates;
+    update.childDeferredUpdates = childDeferredUpdates;
+
+    // Threads not owned by the job system share the first buffer.
+    const cgUInt32 threadIndex = cgJobSystem::getThreadIndex();
+    cgAssert( threadIndex < mDeferredUpdateBuffers );
+    if ( threadIndex == 0 )
+    {
+        mDeferredUpdateSection->enter();
+        mDeferredUpdates[0].push_back( update );
+        mDeferredUpdateSection->exit();
+    
+    } // End if shared
+    else
+    {
+        mDeferredUpdates[threadIndex].push_back( update );
+    
+    } // End if worker
+}
+
+//-----------------------------------------------------------------------------
+//  Name : addToUpdateBucket () (Protected)
+/// <summary>
+/// Add the node to the update bucket that matches its selected update rate.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::addToUpdateBucket( cgObjectNode * node )
+{
+    if ( node->mUpdateRate == cgUpdateRate::Never )
+        return;
+    cgObjectNodeArray & nodes = mUpdateBuckets[ node->mUpdateRate ].nodes;
+    node->mUpdateBucketSlot = (cgUInt32)nodes.size();
+    nodes.push_back( node );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : removeFromUpdateBucket () (Protected)
+/// <summary>
+/// Remove the node from the update bucket that matches its selected update
+/// rate. The node's slot is simply cleared, and the bucket will be compacted
+/// the next time it is processed.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::removeFromUpdateBucket( cgObjectNode * node )
+{
+    if ( node->mUpdateRate == cgUpdateRate::Never )
+        return;
+    UpdateBucket & bucket = mUpdateBuckets[ node->mUpdateRate ];
+    const cgUInt32 slot = node->mUpdateBucketSlot;
+    if ( slot < bucket.nodes.size() && bucket.nodes[slot] == node )
+    {
+        bucket.nodes[slot] = CG_NULL;
+        ++bucket.freeSlots;
+    
+    } // End if found
+    node->mUpdateBucketSlot = 0xFFFFFFFF;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : enableParallelUpdates ()
+/// <summary>
+/// Enable or disable the parallel update of scene nodes (enabled by default).
+/// When enabled, nodes that have declared themselves thread-safe (see 
+/// 'cgObjectNode::setUpdateThreadSafe()') are updated concurrently using the
+/// job system worker threads.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgScene::enableParallelUpdates( bool enabled )
+{
+    mParallelUpdatesEnabled = enabled;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isParallelUpdatesEnabled ()
+/// <summary>
+/// Determine if the parallel update of thread-safe scene nodes is enabled.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScene::isParallelUpdatesEnabled( ) const
+{
+    return mParallelUpdatesEnabled;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isParallelUpdating ()
+/// <summary>
+/// Determine if thread-safe nodes are currently being updated in parallel.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgScene::isParallelUpdating( ) const
+{
+    return mIsParallelUpdating;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : resolvePendingUpdates ()
 /// <summary>
@@ -3142,10 +3402,10 @@ void cgScene::render( )
 
     // Compute level of detail settings for each visible object.
     //profiler->beginProcess( _T("LoD Computation") );
-    cgObjectNodeList::const_iterator itObject;
+    cgObjectNodeArray::const_iterator itObject;
     cgVisibilitySet * visibilityData = mActiveCamera->getVisibilitySet();
-    cgObjectNodeList & visibleLights = visibilityData->getVisibleLights();
-    cgObjectNodeList & visibleObjects = visibilityData->getVisibleObjects();
+    const cgObjectNodeArray & visibleLights = visibilityData->getVisibleLightArray();
+    const cgObjectNodeArray & visibleObjects = visibilityData->getVisibleObjectArray();
     for ( itObject = visibleObjects.begin(); itObject != visibleObjects.end(); ++itObject )
         (*itObject)->computeLevelOfDetail( mActiveCamera );
     for ( itObject = visibleLights.begin(); itObject != visibleLights.end(); ++itObject )
@@ -3226,10 +3486,10 @@ void cgScene::sandboxRender( cgUInt32 flags, const cgPlane & gridPlane )
     beginRenderPass( _T("Sandbox") );
 
     // Visit each node and ask them to draw.
-    cgObjectNodeList::iterator itObject;
+    cgObjectNodeArray::const_iterator itObject;
     cgVisibilitySet * visibilityData = mActiveCamera->getVisibilitySet();
-    cgObjectNodeList & visibleObjects = visibilityData->getVisibleObjects();
-    cgObjectNodeList & visibleLights  = visibilityData->getVisibleLights();
+    const cgObjectNodeArray & visibleObjects = visibilityData->getVisibleObjectArray();
+    const cgObjectNodeArray & visibleLights  = visibilityData->getVisibleLightArray();
     for ( itObject = visibleObjects.begin(); itObject != visibleObjects.end(); ++itObject )
         (*itObject)->sandboxRender( flags, mActiveCamera, visibilityData, gridPlane );
     for ( itObject = visibleLights.begin(); itObject != visibleLights.end(); ++itObject )
@@ -4150,21 +4410,8 @@ bool cgScene::deleteObjectNode( cgObjectNode * node )
     if ( itNode != nodes.end() )
         nodes.erase( itNode );
 
-    // Remove the object from the appropriate update bucket if it is not locked.
-    cgObjectNodeList * bucketNodes = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-    for ( cgObjectNodeList::iterator itBucketNode = bucketNodes->begin(); itBucketNode != bucketNodes->end(); ++itBucketNode )
-    {
-        if ( *itBucketNode == node )
-        {
-            if ( mUpdateBuckets[ node->mUpdateRate ].locked )
-                *itBucketNode = CG_NULL;
-            else
-                bucketNodes->erase( itBucketNode );
-            break;
-        
-        } // End if matches
-
-    } // Next Node
+    // Remove the object from the appropriate update bucket.
+    removeFromUpdateBucket( node );
 
     // If this node exists at the root level in the hierarchy,
     // remove it from the root node list first of all.
@@ -4319,21 +4566,8 @@ bool cgScene::deleteObjectNodes( cgObjectNodeMap & nodes )
 
         } // End if sandbox
 
-        // Remove the object from the appropriate update bucket if it is not locked.
-        cgObjectNodeList * bucketNodes = &mUpdateBuckets[ node->mUpdateRate ].nodes;
-        for ( cgObjectNodeList::iterator itBucketNode = bucketNodes->begin(); itBucketNode != bucketNodes->end(); ++itBucketNode )
-        {
-            if ( *itBucketNode == node )
-            {
-                if ( mUpdateBuckets[ node->mUpdateRate ].locked )
-                    *itBucketNode = CG_NULL;
-                else
-                    bucketNodes->erase( itBucketNode );
-                break;
-            
-            } // End if matches
-
-        } // Next Node
+        // Remove the object from the appropriate update bucket.
+        removeFromUpdateBucket( node );
 
         // If this node exists at the root level in the hierarchy,
         // remove it from the root node list first of all.
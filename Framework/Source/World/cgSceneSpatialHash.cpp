@@ -0,0 +1,800 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : cgSceneSpatialHash.cpp                                             //
+//                                                                           //
+// Desc : Provides a maintained, hashed uniform grid used to accelerate      //
+//        spatial queries (sphere, box, frustum and k-nearest) against the   //
+//        object nodes that exist within a scene.                            //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Precompiled Header
+//-----------------------------------------------------------------------------
+#include <cgPrecompiled.h>
+
+//-----------------------------------------------------------------------------
+// cgSceneSpatialHash Module Includes
+//-----------------------------------------------------------------------------
+#include <World/cgSceneSpatialHash.h>
+#include <World/cgObjectNode.h>
+#include <Math/cgFrustum.h>
+#include <System/cgJobSystem.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace SceneSpatialHash
+{
+    // Grid coordinates are packed into 21 bits per axis.
+    const cgInt32 MaxGridCoordinate = (1 << 20) - 1;
+    
+    // Minimum permitted cell size.
+    const cgFloat MinCellSize = 0.01f;
+
+    // Data passed to the batch query jobs.
+    struct BatchData
+    {
+        const cgSceneSpatialHash  * hash;
+        cgSpatialQuery            * queries;
+    };
+
+    // Candidate list entry used during nearest neighbor searches.
+    typedef std::pair<cgFloat,cgObjectNode*> NearestCandidate;
+    CGE_VECTOR_DECLARE(NearestCandidate, NearestCandidateArray)
+
+    // Context passed to the per-cell query visitors.
+    struct VisitData
+    {
+        cgVector3               center;
+        cgFloat                 radiusSq;
+        const cgBoundingBox   * bounds;
+        const cgFrustum       * frustum;
+        cgObjectNodeArray     * nodesOut;
+    };
+
+} // End Namespace : SceneSpatialHash
+
+///////////////////////////////////////////////////////////////////////////////
+// cgSceneSpatialHash Member Functions
+///////////////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------
+//  Name : cgSceneSpatialHash () (Constructor)
+/// <summary>
+/// Constructor for this class.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgSceneSpatialHash::cgSceneSpatialHash( cgFloat cellSize )
+{
+    // Initialize variables to sensible defaults
+    mCellSize    = max( SceneSpatialHash::MinCellSize, cellSize );
+    mInvCellSize = 1.0f / mCellSize;
+    memset( &mOccupied, 0, sizeof(CellRange) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : ~cgSceneSpatialHash () (Destructor)
+/// <summary>
+/// Destructor for this class.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgSceneSpatialHash::~cgSceneSpatialHash( )
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : clear ()
+/// <summary>
+/// Remove all nodes from the spatial hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::clear( )
+{
+    mCells.clear();
+    mFreeCells.clear();
+    mCellLUT.clear();
+    mNodeLUT.clear();
+    memset( &mOccupied, 0, sizeof(CellRange) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : update ()
+/// <summary>
+/// Insert the specified node into the spatial hash at the supplied world
+/// space position, or move it there if it already exists.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::update( cgObjectNode * node, const cgVector3 & position )
+{
+    const cgInt32 x = getGridCoordinate( position.x );
+    const cgInt32 y = getGridCoordinate( position.y );
+    const cgInt32 z = getGridCoordinate( position.z );
+
+    // Is the node already in the grid?
+    NodeLUT::iterator itNode = mNodeLUT.find( node );
+    if ( itNode != mNodeLUT.end() )
+    {
+        // If it remains in the same cell, just record the new position.
+        const Location & location = itNode->second;
+        Cell & currentCell = mCells[location.cell];
+        if ( currentCell.x == x && currentCell.y == y && currentCell.z == z )
+        {
+            currentCell.entries[location.entry].position = position;
+            return;
+        
+        } // End if same cell
+
+        // Otherwise remove it from its current cell.
+        removeEntry( location.cell, location.entry );
+    
+    } // End if exists
+
+    // Find the cell at the new location, creating it if necessary.
+    cgUInt32 cellIndex;
+    const cgUInt64 key = makeCellKey( x, y, z );
+    CellLUT::const_iterator itCell = mCellLUT.find( key );
+    if ( itCell == mCellLUT.end() )
+    {
+        // Reuse a previously released cell where possible.
+        if ( !mFreeCells.empty() )
+        {
+            cellIndex = mFreeCells.back();
+            mFreeCells.pop_back();
+        
+        } // End if reuse
+        else
+        {
+            cellIndex = (cgUInt32)mCells.size();
+            mCells.push_back( Cell() );
+        
+        } // End if allocate
+        Cell & newCell = mCells[cellIndex];
+        newCell.x = x;
+        newCell.y = y;
+        newCell.z = z;
+        mCellLUT[key] = cellIndex;
+
+        // Grow the occupied grid range.
+        if ( mCellLUT.size() == 1 )
+        {
+            mOccupied.minX = mOccupied.maxX = x;
+            mOccupied.minY = mOccupied.maxY = y;
+            mOccupied.minZ = mOccupied.maxZ = z;
+        
+        } // End if first
+        else
+        {
+            mOccupied.minX = min( mOccupied.minX, x ); mOccupied.maxX = max( mOccupied.maxX, x );
+            mOccupied.minY = min( mOccupied.minY, y ); mOccupied.maxY = max( mOccupied.maxY, y );
+            mOccupied.minZ = min( mOccupied.minZ, z ); mOccupied.maxZ = max( mOccupied.maxZ, z );
+        
+        } // End if expand
+
+    } // End if new cell
+    else
+    {
+        cellIndex = itCell->second;
+    
+    } // End if existing cell
+
+    // Add the entry.
+    Cell & cell = mCells[cellIndex];
+    Entry entry;
+    entry.position = position;
+    entry.node     = node;
+    Location & location = mNodeLUT[node];
+    location.cell  = cellIndex;
+    location.entry = (cgUInt32)cell.entries.size();
+    cell.entries.push_back( entry );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : remove ()
+/// <summary>
+/// Remove the specified node from the spatial hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::remove( cgObjectNode * node )
+{
+    NodeLUT::iterator itNode = mNodeLUT.find( node );
+    if ( itNode == mNodeLUT.end() )
+        return;
+    removeEntry( itNode->second.cell, itNode->second.entry );
+    mNodeLUT.erase( itNode );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : removeEntry () (Protected)
+/// <summary>
+/// Remove the specified entry from its cell, moving the last entry in the
+/// cell into the vacated slot. Empty cells are returned to the free list.
+/// The caller is responsible for updating the removed node's location.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::removeEntry( cgUInt32 cellIndex, cgUInt32 entryIndex )
+{
+    Cell & cell = mCells[cellIndex];
+    const cgUInt32 lastIndex = (cgUInt32)cell.entries.size() - 1;
+    if ( entryIndex != lastIndex )
+    {
+        cell.entries[entryIndex] = cell.entries[lastIndex];
+        mNodeLUT[cell.entries[entryIndex].node].entry = entryIndex;
+    
+    } // End if swap
+    cell.entries.pop_back();
+
+    // Release the cell if it is now empty. Note: The occupied range is
+    // conservative and is only reset once the grid is entirely empty.
+    if ( cell.entries.empty() )
+    {
+        mCellLUT.erase( makeCellKey( cell.x, cell.y, cell.z ) );
+        mFreeCells.push_back( cellIndex );
+        if ( mCellLUT.empty() )
+            memset( &mOccupied, 0, sizeof(CellRange) );
+    
+    } // End if empty
+}
+
+//-----------------------------------------------------------------------------
+//  Name : contains ()
+/// <summary>
+/// Determine if the specified node currently exists in the spatial hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgSceneSpatialHash::contains( cgObjectNode * node ) const
+{
+    return (mNodeLUT.find( node ) != mNodeLUT.end());
+}
+
+//-----------------------------------------------------------------------------
+//  Name : setCellSize ()
+/// <summary>
+/// Set the world space dimensions of each grid cell. Any nodes that
+/// currently exist in the grid will be redistributed.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::setCellSize( cgFloat cellSize )
+{
+    cellSize = max( SceneSpatialHash::MinCellSize, cellSize );
+    if ( cellSize == mCellSize )
+        return;
+
+    // Record all existing entries.
+    EntryArray entries;
+    entries.reserve( mNodeLUT.size() );
+    for ( size_t i = 0; i < mCells.size(); ++i )
+    {
+        const EntryArray & cellEntries = mCells[i].entries;
+        for ( size_t j = 0; j < cellEntries.size(); ++j )
+            entries.push_back( cellEntries[j] );
+    
+    } // Next cell
+
+    // Rebuild the grid at the new resolution.
+    clear();
+    mCellSize    = cellSize;
+    mInvCellSize = 1.0f / cellSize;
+    for ( size_t i = 0; i < entries.size(); ++i )
+        update( entries[i].node, entries[i].position );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCellSize ()
+/// <summary>
+/// Retrieve the world space dimensions of each grid cell.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgFloat cgSceneSpatialHash::getCellSize( ) const
+{
+    return mCellSize;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getNodeCount ()
+/// <summary>
+/// Retrieve the total number of nodes that exist in the spatial hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgSceneSpatialHash::getNodeCount( ) const
+{
+    return (cgUInt32)mNodeLUT.size();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCellCount ()
+/// <summary>
+/// Retrieve the total number of occupied cells in the spatial hash.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgSceneSpatialHash::getCellCount( ) const
+{
+    return (cgUInt32)mCellLUT.size();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : querySphere ()
+/// <summary>
+/// Populate the specified container with all nodes whose recorded position
+/// falls within the specified bounding sphere.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::querySphere( const cgVector3 & center, cgFloat radius, cgObjectNodeArray & nodesOut ) const
+{
+    nodesOut.clear();
+    if ( radius < 0 )
+        return;
+
+    // Compute the range of cells overlapped by the sphere.
+    CellRange range;
+    const cgVector3 extents( radius, radius, radius );
+    if ( !getCellRange( cgBoundingBox( center - extents, center + extents ), range ) )
+        return;
+
+    // Test the contents of each overlapped cell.
+    SceneSpatialHash::VisitData data;
+    data.center   = center;
+    data.radiusSq = radius * radius;
+    data.nodesOut = &nodesOut;
+    visitCells( range, sphereVisitor, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : queryBox ()
+/// <summary>
+/// Populate the specified container with all nodes whose recorded position
+/// falls within the specified bounding box.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::queryBox( const cgBoundingBox & bounds, cgObjectNodeArray & nodesOut ) const
+{
+    nodesOut.clear();
+
+    // Compute the range of cells overlapped by the box.
+    CellRange range;
+    if ( !getCellRange( bounds, range ) )
+        return;
+
+    // Test the contents of each overlapped cell.
+    SceneSpatialHash::VisitData data;
+    data.bounds   = &bounds;
+    data.nodesOut = &nodesOut;
+    visitCells( range, boxVisitor, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : queryFrustum ()
+/// <summary>
+/// Populate the specified container with all nodes whose recorded position
+/// falls within the specified frustum.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::queryFrustum( const cgFrustum & frustum, cgObjectNodeArray & nodesOut ) const
+{
+    nodesOut.clear();
+
+    // Compute the range of cells overlapped by the frustum's bounding box.
+    CellRange range;
+    cgBoundingBox bounds( frustum.points[0], frustum.points[0] );
+    for ( cgInt i = 1; i < 8; ++i )
+        bounds.addPoint( frustum.points[i] );
+    if ( !getCellRange( bounds, range ) )
+        return;
+
+    // Classify and test the contents of each overlapped cell.
+    SceneSpatialHash::VisitData data;
+    data.frustum  = &frustum;
+    data.nodesOut = &nodesOut;
+    visitCells( range, frustumVisitor, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : queryNearest ()
+/// <summary>
+/// Populate the specified container with (at most) the 'count' nodes whose
+/// recorded position is closest to the specified point, sorted by ascending
+/// distance. Nodes further away than the specified maximum distance are
+/// ignored unless this value is 0.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::queryNearest( const cgVector3 & center, cgUInt32 count, cgFloat maximumDistance, cgObjectNodeArray & nodesOut ) const
+{
+    using namespace SceneSpatialHash;
+    nodesOut.clear();
+    if ( !count || mCellLUT.empty() )
+        return;
+
+    // Candidates are maintained in a max-heap keyed on squared distance
+    // such that the furthest of the current best set is at the front.
+    NearestCandidateArray candidates;
+    candidates.reserve( count + 1 );
+    const cgFloat maximumDistanceSq = (maximumDistance > 0) ? maximumDistance * maximumDistance : FLT_MAX;
+
+    // Determine the number of rings required to cover the occupied area.
+    const cgInt32 cx = getGridCoordinate( center.x );
+    const cgInt32 cy = getGridCoordinate( center.y );
+    const cgInt32 cz = getGridCoordinate( center.z );
+    cgInt32 maxRing = max( max( abs( cx - mOccupied.minX ), abs( mOccupied.maxX - cx ) ),
+                      max( max( abs( cy - mOccupied.minY ), abs( mOccupied.maxY - cy ) ),
+                           max( abs( cz - mOccupied.minZ ), abs( mOccupied.maxZ - cz ) ) ) );
+    if ( maximumDistance > 0 )
+        maxRing = min( maxRing, (cgInt32)ceilf( maximumDistance * mInvCellSize ) );
+
+    // Search outwards in progressively larger shells of cells.
+    cgUInt32 cellsVisited  = 0;
+    bool     scanRemaining = false;
+    cgInt32  ring;
+    for ( ring = 0; ring <= maxRing; ++ring )
+    {
+        // Every point in this (or any subsequent) shell is at least 'ring - 1' 
+        // whole cells from the search center. Stop once nothing closer can exist.
+        if ( ring > 1 )
+        {
+            const cgFloat minimumDistance   = (cgFloat)(ring - 1) * mCellSize;
+            const cgFloat minimumDistanceSq = minimumDistance * minimumDistance;
+            if ( minimumDistanceSq > maximumDistanceSq )
+                break;
+            if ( candidates.size() == count && candidates.front().first <= minimumDistanceSq )
+                break;
+        
+        } // End if outer ring
+
+        // Once the number of cell lookups exceeds the number of occupied cells, 
+        // it is cheaper to scan the remaining cells directly.
+        if ( cellsVisited > mCellLUT.size() )
+        {
+            scanRemaining = true;
+            break;
+        
+        } // End if too many lookups
+
+        // Visit each cell on the surface of this shell.
+        const cgInt32 minX = max( cx - ring, mOccupied.minX ), maxX = min( cx + ring, mOccupied.maxX );
+        const cgInt32 minY = max( cy - ring, mOccupied.minY ), maxY = min( cy + ring, mOccupied.maxY );
+        const cgInt32 minZ = max( cz - ring, mOccupied.minZ ), maxZ = min( cz + ring, mOccupied.maxZ );
+        for ( cgInt32 x = minX; x <= maxX; ++x )
+        {
+            for ( cgInt32 y = minY; y <= maxY; ++y )
+            {
+                // Cells on the X or Y faces of the shell are visited along the 
+                // entire Z range. Interior columns only visit the Z caps.
+                const bool faceColumn = (abs( x - cx ) == ring || abs( y - cy ) == ring);
+                const cgInt32 stepZ = faceColumn ? 1 : ring * 2;
+                for ( cgInt32 z = faceColumn ? minZ : cz - ring; z <= (faceColumn ? maxZ : cz + ring); z += stepZ )
+                {
+                    if ( z < minZ || z > maxZ )
+                        continue;
+                    ++cellsVisited;
+                    const Cell * cell = findCell( x, y, z );
+                    if ( cell )
+                        gatherNearest( *cell, center, count, maximumDistanceSq, &candidates );
+                
+                } // Next Z
+            
+            } // Next Y
+        
+        } // Next X
+
+    } // Next ring
+
+    // If the shell search was abandoned early, process all cells that 
+    // were not yet visited.
+    if ( scanRemaining )
+    {
+        const cgInt32 visitedRing = ring - 1;
+        for ( size_t i = 0; i < mCells.size(); ++i )
+        {
+            const Cell & cell = mCells[i];
+            if ( cell.entries.empty() )
+                continue;
+            if ( abs( cell.x - cx ) <= visitedRing && abs( cell.y - cy ) <= visitedRing && abs( cell.z - cz ) <= visitedRing )
+                continue;
+            gatherNearest( cell, center, count, maximumDistanceSq, &candidates );
+        
+        } // Next cell
+
+    } // End if fallback
+
+    // Output the results in order of increasing distance.
+    std::sort_heap( candidates.begin(), candidates.end() );
+    nodesOut.reserve( candidates.size() );
+    for ( size_t i = 0; i < candidates.size(); ++i )
+        nodesOut.push_back( candidates[i].second );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : queryBatch ()
+/// <summary>
+/// Execute a batch of queries at once. Queries are distributed across any
+/// available job system worker threads. The spatial hash must not be
+/// modified while a batch is executing.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::queryBatch( cgSpatialQuery queries[], cgUInt32 queryCount ) const
+{
+    SceneSpatialHash::BatchData data;
+    data.hash    = this;
+    data.queries = queries;
+    cgJobSystem::parallelFor( queryCount, 0, executeQueries, &data );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : executeQueries () (Protected, Static)
+/// <summary>
+/// Job system callback that executes the specified range of batch queries.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::executeQueries( cgUInt32 first, cgUInt32 last, void * context )
+{
+    SceneSpatialHash::BatchData * data = (SceneSpatialHash::BatchData*)context;
+    for ( cgUInt32 i = first; i < last; ++i )
+    {
+        cgSpatialQuery & query = data->queries[i];
+        if ( !query.results )
+            continue;
+        switch ( query.type )
+        {
+            case cgSpatialQueryType::Sphere:
+                data->hash->querySphere( query.center, query.radius, *query.results );
+                break;
+            case cgSpatialQueryType::Box:
+                data->hash->queryBox( query.bounds, *query.results );
+                break;
+            case cgSpatialQueryType::Frustum:
+                if ( query.frustum )
+                    data->hash->queryFrustum( *query.frustum, *query.results );
+                else
+                    query.results->clear();
+                break;
+            case cgSpatialQueryType::Nearest:
+                data->hash->queryNearest( query.center, query.maximumResults, query.radius, *query.results );
+                break;
+        
+        } // End switch type
+    
+    } // Next query
+}
+
+//-----------------------------------------------------------------------------
+//  Name : visitCells () (Protected)
+/// <summary>
+/// Call the specified visitor for each occupied cell in the supplied range.
+/// Depending on the size of the range, the cells are either looked up
+/// individually or found by scanning the list of occupied cells.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::visitCells( const CellRange & range, CellVisitor visitor, void * context ) const
+{
+    const cgUInt64 rangeCells = (cgUInt64)(range.maxX - range.minX + 1) * 
+                                (cgUInt64)(range.maxY - range.minY + 1) * 
+                                (cgUInt64)(range.maxZ - range.minZ + 1);
+    if ( rangeCells > (cgUInt64)mCellLUT.size() )
+    {
+        // Cheaper to scan all occupied cells.
+        for ( size_t i = 0; i < mCells.size(); ++i )
+        {
+            const Cell & cell = mCells[i];
+            if ( cell.entries.empty() )
+                continue;
+            if ( cell.x < range.minX || cell.x > range.maxX ||
+                 cell.y < range.minY || cell.y > range.maxY ||
+                 cell.z < range.minZ || cell.z > range.maxZ )
+                continue;
+            visitor( this, cell, context );
+        
+        } // Next cell
+    
+    } // End if scan
+    else
+    {
+        // Look up each cell in the range.
+        for ( cgInt32 x = range.minX; x <= range.maxX; ++x )
+        {
+            for ( cgInt32 y = range.minY; y <= range.maxY; ++y )
+            {
+                for ( cgInt32 z = range.minZ; z <= range.maxZ; ++z )
+                {
+                    const Cell * cell = findCell( x, y, z );
+                    if ( cell )
+                        visitor( this, *cell, context );
+                
+                } // Next Z
+            
+            } // Next Y
+        
+        } // Next X
+    
+    } // End if lookup
+}
+
+//-----------------------------------------------------------------------------
+//  Name : sphereVisitor () (Protected, Static)
+/// <summary>
+/// Cell visitor that collects nodes within a sphere.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::sphereVisitor( const cgSceneSpatialHash * hash, const Cell & cell, void * context )
+{
+    SceneSpatialHash::VisitData * data = (SceneSpatialHash::VisitData*)context;
+    const EntryArray & entries = cell.entries;
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        if ( cgVector3::lengthSq( entries[i].position - data->center ) <= data->radiusSq )
+            data->nodesOut->push_back( entries[i].node );
+    
+    } // Next entry
+}
+
+//-----------------------------------------------------------------------------
+//  Name : boxVisitor () (Protected, Static)
+/// <summary>
+/// Cell visitor that collects nodes within an axis aligned box.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::boxVisitor( const cgSceneSpatialHash * hash, const Cell & cell, void * context )
+{
+    SceneSpatialHash::VisitData * data = (SceneSpatialHash::VisitData*)context;
+    const EntryArray & entries = cell.entries;
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        if ( data->bounds->containsPoint( entries[i].position ) )
+            data->nodesOut->push_back( entries[i].node );
+    
+    } // Next entry
+}
+
+//-----------------------------------------------------------------------------
+//  Name : frustumVisitor () (Protected, Static)
+/// <summary>
+/// Cell visitor that collects nodes within a frustum. Cells that are 
+/// entirely contained are accepted without testing individual nodes.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::frustumVisitor( const cgSceneSpatialHash * hash, const Cell & cell, void * context )
+{
+    SceneSpatialHash::VisitData * data = (SceneSpatialHash::VisitData*)context;
+    const EntryArray & entries = cell.entries;
+    switch ( data->frustum->classifyAABB( hash->getCellBounds( cell ) ) )
+    {
+        case cgVolumeQuery::Inside:
+            for ( size_t i = 0; i < entries.size(); ++i )
+                data->nodesOut->push_back( entries[i].node );
+            break;
+
+        case cgVolumeQuery::Intersect:
+            for ( size_t i = 0; i < entries.size(); ++i )
+            {
+                if ( data->frustum->testPoint( entries[i].position ) )
+                    data->nodesOut->push_back( entries[i].node );
+            
+            } // Next entry
+            break;
+
+        default:
+            break;
+    
+    } // End switch classify
+}
+
+//-----------------------------------------------------------------------------
+//  Name : gatherNearest () (Protected, Static)
+/// <summary>
+/// Merge the nodes in the specified cell into the nearest neighbor candidate
+/// heap (a SceneSpatialHash::NearestCandidateArray).
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSceneSpatialHash::gatherNearest( const Cell & cell, const cgVector3 & center, cgUInt32 count, cgFloat maximumDistanceSq, void * candidateHeap )
+{
+    using namespace SceneSpatialHash;
+    NearestCandidateArray & candidates = *(NearestCandidateArray*)candidateHeap;
+    const EntryArray & entries = cell.entries;
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        const cgFloat distanceSq = cgVector3::lengthSq( entries[i].position - center );
+        if ( distanceSq > maximumDistanceSq )
+            continue;
+        if ( candidates.size() < count )
+        {
+            candidates.push_back( NearestCandidate( distanceSq, entries[i].node ) );
+            std::push_heap( candidates.begin(), candidates.end() );
+        
+        } // End if filling
+        else if ( distanceSq < candidates.front().first )
+        {
+            std::pop_heap( candidates.begin(), candidates.end() );
+            candidates.back() = NearestCandidate( distanceSq, entries[i].node );
+            std::push_heap( candidates.begin(), candidates.end() );
+        
+        } // End if closer
+    
+    } // Next entry
+}
+
+//-----------------------------------------------------------------------------
+//  Name : findCell () (Protected)
+/// <summary>
+/// Retrieve the occupied cell at the specified grid location (if any).
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgSceneSpatialHash::Cell * cgSceneSpatialHash::findCell( cgInt32 x, cgInt32 y, cgInt32 z ) const
+{
+    CellLUT::const_iterator itCell = mCellLUT.find( makeCellKey( x, y, z ) );
+    if ( itCell == mCellLUT.end() )
+        return CG_NULL;
+    return &mCells[itCell->second];
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCellRange () (Protected)
+/// <summary>
+/// Compute the range of grid cells overlapped by the specified bounding box,
+/// clamped to the currently occupied area. Returns false if the box does not
+/// overlap any occupied area.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgSceneSpatialHash::getCellRange( const cgBoundingBox & bounds, CellRange & range ) const
+{
+    if ( mCellLUT.empty() )
+        return false;
+    range.minX = max( getGridCoordinate( bounds.min.x ), mOccupied.minX );
+    range.minY = max( getGridCoordinate( bounds.min.y ), mOccupied.minY );
+    range.minZ = max( getGridCoordinate( bounds.min.z ), mOccupied.minZ );
+    range.maxX = min( getGridCoordinate( bounds.max.x ), mOccupied.maxX );
+    range.maxY = min( getGridCoordinate( bounds.max.y ), mOccupied.maxY );
+    range.maxZ = min( getGridCoordinate( bounds.max.z ), mOccupied.maxZ );
+    return ( range.minX <= range.maxX && range.minY <= range.maxY && range.minZ <= range.maxZ );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getCellBounds () (Protected)
+/// <summary>
+/// Retrieve the world space bounding box of the specified cell.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgBoundingBox cgSceneSpatialHash::getCellBounds( const Cell & cell ) const
+{
+    const cgVector3 minimum( (cgFloat)cell.x * mCellSize, (cgFloat)cell.y * mCellSize, (cgFloat)cell.z * mCellSize );
+    return cgBoundingBox( minimum, minimum + cgVector3( mCellSize, mCellSize, mCellSize ) );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getGridCoordinate () (Protected)
+/// <summary>
+/// Convert the specified world space value into an integer grid coordinate.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgInt32 cgSceneSpatialHash::getGridCoordinate( cgFloat value ) const
+{
+    const cgFloat coordinate = floorf( value * mInvCellSize );
+    if ( coordinate != coordinate )
+        return 0;
+    if ( coordinate >= (cgFloat)SceneSpatialHash::MaxGridCoordinate )
+        return SceneSpatialHash::MaxGridCoordinate;
+    if ( coordinate <= (cgFloat)-SceneSpatialHash::MaxGridCoordinate )
+        return -SceneSpatialHash::MaxGridCoordinate;
+    return (cgInt32)coordinate;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : makeCellKey () (Protected, Static)
+/// <summary>
+/// Pack the specified grid location into a single hash key.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt64 cgSceneSpatialHash::makeCellKey( cgInt32 x, cgInt32 y, cgInt32 z )
+{
+    return ((cgUInt64)(x & 0x1FFFFF)) | 
+           ((cgUInt64)(y & 0x1FFFFF) << 21) | 
+           ((cgUInt64)(z & 0x1FFFFF) << 42);
+}
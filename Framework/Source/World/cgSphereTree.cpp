@@ -29,6 +29,146 @@
 #include <World/cgSphereTree.h>
 #include <World/cgBSPVisTree.h>
 #include <Math/cgFrustum.h>
+#include <World/Objects/cgPointLight.h>
+#include <System/cgJobSystem.h>
+#if defined(CGE_MATH_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CGE_MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace SphereTree
+{
+    // Number of child spheres classified together during traversal. The
+    // flattened layout arrays are padded by this amount so that batches
+    // can always be loaded in full.
+    const cgUInt32 ClassifyBatchSize = 8;
+
+    // Capacity of the smallest child block allocated in the flattened layout,
+    // and the number of available block size classes (each doubling the last).
+    const cgUInt32 MinBlockSize     = 4;
+    const cgUInt32 BlockClassCount  = 24;
+
+    // Released layout blocks are recycled, but once they account for more
+    // entries than this (and outnumber the live entries) the layout is
+    // compacted by rebuilding it in full.
+    const cgUInt32 CompactThreshold = 4096;
+
+    // Invalid layout entry / block index.
+    const cgUInt32 InvalidIndex     = 0xFFFFFFFF;
+
+    // Number of traversal chunks generated per available thread when
+    // computing visibility for multiple views at once.
+    const cgUInt32 ChunksPerThread = 4;
+
+    //-------------------------------------------------------------------------
+    // Name : setObjectVisibility()
+    // Desc : Add the object to, or remove it from the specified visibility
+    //        set. When a change list is supplied, the change is recorded for
+    //        later application instead.
+    //-------------------------------------------------------------------------
+    inline void setObjectVisibility( cgObjectNode * object, cgVisibilitySet * visibilityData, bool visible, cgSphereTree::VisibilityChangeArray * deferredChanges )
+    {
+        if ( deferredChanges )
+        {
+            cgSphereTree::VisibilityChange change;
+            change.object         = object;
+            change.visibilityData = visibilityData;
+            change.visible        = visible;
+            deferredChanges->push_back( change );
+        
+        } // End if deferred
+        else if ( visible )
+            object->registerVisibility( visibilityData );
+        else
+            object->unregisterVisibility( visibilityData );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : resolveState()
+    // Desc : Convert the per-sphere 'outside' and 'spanning' results into the
+    //        matching volume query classification.
+    //-------------------------------------------------------------------------
+    inline cgByte resolveState( bool outside, bool spanning )
+    {
+        if ( outside )
+            return (cgByte)cgVolumeQuery::Outside;
+        return (cgByte)(spanning ? cgVolumeQuery::Intersect : cgVolumeQuery::Inside);
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : classifySpheres()
+    // Desc : Classify a batch of (up to 'ClassifyBatchSize') consecutive
+    //        spheres against the six frustum planes. Produces results that
+    //        are identical to cgFrustum::classifySphere().
+    //-------------------------------------------------------------------------
+    inline void classifySpheres( const cgFloat planes[6][4], const cgFloat * x, const cgFloat * y, const cgFloat * z, const cgFloat * r, cgUInt32 count, cgByte * states )
+    {
+#if defined(CGE_MATH_SIMD_AVX)
+        const __m256 cx = _mm256_loadu_ps( x ), cy = _mm256_loadu_ps( y ), cz = _mm256_loadu_ps( z );
+        const __m256 radius = _mm256_loadu_ps( r );
+        const __m256 negRadius = _mm256_sub_ps( _mm256_setzero_ps(), radius );
+        __m256 outside = _mm256_setzero_ps(), spanning = _mm256_setzero_ps();
+        for ( cgInt i = 0; i < 6; ++i )
+        {
+            __m256 dot = _mm256_mul_ps( cx, _mm256_broadcast_ss( &planes[i][0] ) );
+            dot = _mm256_add_ps( dot, _mm256_mul_ps( cy, _mm256_broadcast_ss( &planes[i][1] ) ) );
+            dot = _mm256_add_ps( dot, _mm256_mul_ps( cz, _mm256_broadcast_ss( &planes[i][2] ) ) );
+            dot = _mm256_add_ps( dot, _mm256_broadcast_ss( &planes[i][3] ) );
+            outside  = _mm256_or_ps( outside, _mm256_cmp_ps( dot, radius, _CMP_GE_OQ ) );
+            spanning = _mm256_or_ps( spanning, _mm256_cmp_ps( dot, negRadius, _CMP_GE_OQ ) );
+        
+        } // Next plane
+        const cgInt outsideMask = _mm256_movemask_ps( outside ), spanningMask = _mm256_movemask_ps( spanning );
+        for ( cgUInt32 i = 0; i < count; ++i )
+            states[i] = resolveState( (outsideMask & (1 << i)) != 0, (spanningMask & (1 << i)) != 0 );
+
+#elif defined(CGE_MATH_SIMD_SSE2)
+        for ( cgUInt32 base = 0; base < count; base += 4 )
+        {
+            const __m128 cx = _mm_loadu_ps( x + base ), cy = _mm_loadu_ps( y + base ), cz = _mm_loadu_ps( z + base );
+            const __m128 radius = _mm_loadu_ps( r + base );
+            const __m128 negRadius = _mm_sub_ps( _mm_setzero_ps(), radius );
+            __m128 outside = _mm_setzero_ps(), spanning = _mm_setzero_ps();
+            for ( cgInt i = 0; i < 6; ++i )
+            {
+                __m128 dot = _mm_mul_ps( cx, _mm_set1_ps( planes[i][0] ) );
+                dot = _mm_add_ps( dot, _mm_mul_ps( cy, _mm_set1_ps( planes[i][1] ) ) );
+                dot = _mm_add_ps( dot, _mm_mul_ps( cz, _mm_set1_ps( planes[i][2] ) ) );
+                dot = _mm_add_ps( dot, _mm_set1_ps( planes[i][3] ) );
+                outside  = _mm_or_ps( outside, _mm_cmpge_ps( dot, radius ) );
+                spanning = _mm_or_ps( spanning, _mm_cmpge_ps( dot, negRadius ) );
+            
+            } // Next plane
+            const cgInt outsideMask = _mm_movemask_ps( outside ), spanningMask = _mm_movemask_ps( spanning );
+            const cgUInt32 laneCount = (count - base < 4) ? count - base : 4;
+            for ( cgUInt32 i = 0; i < laneCount; ++i )
+                states[base+i] = resolveState( (outsideMask & (1 << i)) != 0, (spanningMask & (1 << i)) != 0 );
+        
+        } // Next block
+
+#else // CGE_MATH_SIMD_SCALAR
+        for ( cgUInt32 n = 0; n < count; ++n )
+        {
+            bool outside = false, spanning = false;
+            for ( cgInt i = 0; i < 6 && !outside; ++i )
+            {
+                const cgFloat dot = planes[i][0] * x[n] + planes[i][1] * y[n] + planes[i][2] * z[n] + planes[i][3];
+                outside  = (dot >= r[n]);
+                spanning = spanning || (dot >= -r[n]);
+            
+            } // Next plane
+            states[n] = resolveState( outside, spanning );
+        
+        } // Next sphere
+
+#endif // CGE_MATH_SIMD_SCALAR
+    }
+
+}; // End Namespace : SphereTree
 
 ///////////////////////////////////////////////////////////////////////////////
 // cgSphereTree Member Definitions
@@ -47,6 +187,7 @@ cgSphereTree::cgSphereTree( cgUInt32 maxSpheres, cgFloat leafSize, cgFloat paddi
     mStaticVisTree      = staticVisTree;
     mMaximumLeafSize    = leafSize;
     mPadding            = padding;
+    mLayoutDirty        = true;
 
     // Initialize the root entry of the node tree.
     mRoot = mNodePool.getFreeElement();
@@ -77,9 +218,12 @@ void cgSphereTree::dispose( bool disposeBase )
     mNodePool.clear();
     mIntegrationFIFO.clear();
     mRecomputeFIFO.clear();
+    mLayout = Layout();
+    mBatchChanges.clear();
 
     // Clear variables.
-    mRoot   = CG_NULL;
+    mRoot           = CG_NULL;
+    mLayoutDirty    = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -140,6 +284,11 @@ void cgSphereTree::removeSphere( cgSphereTreeSubNode * node )
     // Unlink the node from its lists.
     node->unlink();
 
+    // Recycle any layout block that may still be assigned to the node.
+    if ( !mLayoutDirty && node->mLayoutBlock != SphereTree::InvalidIndex )
+        releaseLayoutBlock( node->mLayoutBlock, node->mLayoutBlockClass );
+    node->mLayoutBlock = SphereTree::InvalidIndex;
+
     // Return the node back to the pool.
     node->getVisibilityFlags().clear();
     mNodePool.releaseElement( node );
@@ -194,6 +343,135 @@ void cgSphereTree::addRecompute( cgSphereTreeSubNode * node )
 /// </summary>
 //-----------------------------------------------------------------------------
 void cgSphereTree::computeVisibility( const cgFrustum & frustum, cgVisibilitySet * visibilityData, cgUInt32 flags )
+{
+    // Gather the data shared by every node visited. This will fail if
+    // the specified set is not one that we manage.
+    TraversalData data;
+    if ( !prepareTraversal( frustum, visibilityData, data ) )
+        return;
+
+    // Bring the flattened layout up to date if the hierarchy has
+    // changed since it was last built.
+    if ( mLayoutDirty )
+        rebuildLayout();
+
+    // Traverse!
+    cgVolumeQuery::Class state = frustum.classifySphere( mRoot->position, mRoot->radius );
+    state = mRoot->updateVisibility( visibilityData, data.setIndex, state, data.sourceLeafVis );
+    computeChildVisibility( data, 0, state );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeVisibility()
+/// <summary>
+/// Populate several visibility sets at once, each based on the objects that
+/// fall within its matching frustum. Up to 'MaxBatchViews' views are tested
+/// during a single shared walk of the hierarchy, which is distributed across
+/// the job system. Changes to set membership are applied once the walk
+/// completes, in the same order that computing each view in turn would
+/// have applied them.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::computeVisibility( const cgFrustum ** frustums, cgVisibilitySet ** visibilityData, cgUInt32 count )
+{
+    // Bring the flattened layout up to date if the hierarchy has
+    // changed since it was last built.
+    if ( mLayoutDirty )
+        rebuildLayout();
+
+    BatchData data;
+    data.tree = this;
+    for ( cgUInt32 next = 0; next < count; )
+    {
+        // Gather the next group of views that we manage.
+        data.viewCount      = 0;
+        data.rootTestMask   = 0;
+        data.rootInsideMask = 0;
+        for ( ; next < count && data.viewCount < MaxBatchViews; ++next )
+        {
+            TraversalData & view = data.views[data.viewCount];
+            if ( !prepareTraversal( *frustums[next], visibilityData[next], view ) )
+                continue;
+
+            // Process the root immediately.
+            cgVolumeQuery::Class state = frustums[next]->classifySphere( mRoot->position, mRoot->radius );
+            state = mRoot->updateVisibility( view.visibilityData, view.setIndex, state, view.sourceLeafVis );
+            if ( state == cgVolumeQuery::Intersect )
+                data.rootTestMask |= (1u << data.viewCount);
+            else if ( state == cgVolumeQuery::Inside )
+                data.rootInsideMask |= (1u << data.viewCount);
+            ++data.viewCount;
+        
+        } // Next view
+        if ( !data.viewCount )
+            continue;
+
+        // Split the children of the root into chunks that can be traversed
+        // independently. Each node is only ever visited by one chunk.
+        const cgUInt32 rootChildCount = mLayout.childCount[0];
+        data.chunkCount = (cgJobSystem::getWorkerCount() + 1) * SphereTree::ChunksPerThread;
+        if ( data.chunkCount > rootChildCount )
+            data.chunkCount = rootChildCount;
+        if ( mBatchChanges.size() < data.chunkCount * MaxBatchViews )
+            mBatchChanges.resize( data.chunkCount * MaxBatchViews );
+        cgJobSystem::parallelFor( data.chunkCount, 1, computeBatchChunks, &data );
+
+        // Apply recorded visibility set changes in the same order that
+        // computing each view serially would have produced them: view by
+        // view, and in traversal order (chunk by chunk) within each view.
+        for ( cgUInt32 v = 0; v < data.viewCount; ++v )
+        {
+            for ( cgUInt32 i = 0; i < data.chunkCount; ++i )
+            {
+                VisibilityChangeArray & changes = mBatchChanges[ i * MaxBatchViews + v ];
+                for ( size_t j = 0; j < changes.size(); ++j )
+                {
+                    const VisibilityChange & change = changes[j];
+                    if ( change.visible )
+                        change.object->registerVisibility( change.visibilityData );
+                    else
+                        change.object->unregisterVisibility( change.visibilityData );
+                
+                } // Next change
+                changes.clear();
+            
+            } // Next chunk
+        
+        } // Next view
+    
+    } // Next group
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeBatchChunks() (Protected, Static)
+/// <summary>
+/// Job system callback that traverses the specified range of chunks during
+/// a batched, multi-view visibility computation.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::computeBatchChunks( cgUInt32 first, cgUInt32 last, void * context )
+{
+    BatchData * data = (BatchData*)context;
+    cgSphereTree * tree = data->tree;
+    const cgUInt32 rootFirst = tree->mLayout.firstChild[0];
+    const cgUInt32 rootCount = tree->mLayout.childCount[0];
+    for ( cgUInt32 i = first; i < last; ++i )
+    {
+        const cgUInt32 chunkFirst = rootFirst + (cgUInt32)(((cgUInt64)rootCount * i) / data->chunkCount);
+        const cgUInt32 chunkLast  = rootFirst + (cgUInt32)(((cgUInt64)rootCount * (i + 1)) / data->chunkCount);
+        tree->computeChildVisibility( *data, chunkFirst, chunkLast, data->rootTestMask, data->rootInsideMask, &tree->mBatchChanges[ i * MaxBatchViews ] );
+    
+    } // Next chunk
+}
+
+//-----------------------------------------------------------------------------
+//  Name : prepareTraversal() (Protected)
+/// <summary>
+/// Populate the per-view data required to traverse the hierarchy for the
+/// specified frustum. Returns false if the set is not managed by this tree.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgSphereTree::prepareTraversal( const cgFrustum & frustum, cgVisibilitySet * visibilityData, TraversalData & data )
 {
     // Find the index of the set in the list.
     size_t setIndex;
@@ -204,27 +482,33 @@ void cgSphereTree::computeVisibility( const cgFrustum & frustum, cgVisibilitySet
     
     } // Next set
 
-    // Traverse the hierarchy if it was a set we manage.
-    if ( setIndex != mSets.size() )
-    {
-        static std::map<const cgFrustum*,cgVector3> lastFrustumPosition;
-        lastFrustumPosition[&frustum] = frustum.position;
-
-        // If a static PVS tree is available, find the source leaf in which the
-        // frustum is currently positioned (for the purposes of visibility flow).
-        cgUInt32 sourceLeaf = cgBSPTree::InvalidLeaf;
-        if ( mStaticVisTree )
-            sourceLeaf = mStaticVisTree->findLeaf( frustum.position );
+    // Skip if it is not a set we manage.
+    if ( setIndex == mSets.size() )
+        return false;
 
-        const cgByte * sourceLeafVis = CG_NULL;
-        if ( sourceLeaf != cgBSPTree::InvalidLeaf && sourceLeaf != cgBSPTree::SolidLeaf )
-            sourceLeafVis = &mStaticVisTree->getPVSData()[mStaticVisTree->getLeaves()[sourceLeaf].visibilityOffset];
+    // If a static PVS tree is available, find the source leaf in which the
+    // frustum is currently positioned (for the purposes of visibility flow).
+    cgUInt32 sourceLeaf = cgBSPTree::InvalidLeaf;
+    if ( mStaticVisTree )
+        sourceLeaf = mStaticVisTree->findLeaf( frustum.position );
 
+    const cgByte * sourceLeafVis = CG_NULL;
+    if ( sourceLeaf != cgBSPTree::InvalidLeaf && sourceLeaf != cgBSPTree::SolidLeaf )
+        sourceLeafVis = &mStaticVisTree->getPVSData()[mStaticVisTree->getLeaves()[sourceLeaf].visibilityOffset];
 
-        // Traverse!
-        mRoot->computeVisibility( frustum, visibilityData, setIndex, flags, cgVolumeQuery::Intersect,
-                                  mStaticVisTree, sourceLeaf, sourceLeafVis );
-    } // End if we manage
+    // Populate traversal data.
+    for ( cgInt i = 0; i < 6; ++i )
+    {
+        data.planes[i][0] = frustum.planes[i].a;
+        data.planes[i][1] = frustum.planes[i].b;
+        data.planes[i][2] = frustum.planes[i].c;
+        data.planes[i][3] = frustum.planes[i].d;
+    
+    } // Next plane
+    data.visibilityData = visibilityData;
+    data.setIndex       = (cgUInt32)setIndex;
+    data.sourceLeafVis  = sourceLeafVis;
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -262,6 +546,390 @@ void cgSphereTree::process( )
         integrate( node, mRoot, mMaximumLeafSize );
     
     } // Next test
+
+    // Refresh the flattened traversal layout if the hierarchy changed.
+    if ( mLayoutDirty )
+        rebuildLayout();
+}
+
+//-----------------------------------------------------------------------------
+//  Name : rebuildLayout() (Protected)
+/// <summary>
+/// Rebuild (and compact) the flattened mirror of the hierarchy that is used
+/// to accelerate visibility traversal. This is only required when the layout
+/// is first constructed, or when it has become heavily fragmented; all other
+/// structural changes are patched in place by 'linkLayoutChild()' and
+/// 'unlinkLayoutChild()'.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::rebuildLayout( )
+{
+    Layout & l = mLayout;
+    l.nodes.clear();
+    l.centerX.clear();
+    l.centerY.clear();
+    l.centerZ.clear();
+    l.radius.clear();
+    l.firstChild.clear();
+    l.childCount.clear();
+    for ( cgUInt32 i = 0; i < SphereTree::BlockClassCount; ++i )
+        l.freeBlocks[i].clear();
+    l.entryCount = 0;
+    l.slotCount  = 0;
+    l.freeSlots  = 0;
+    if ( !mRoot )
+        return;
+
+    // The root always occupies the first entry.
+    allocateLayoutBlock( 0 );
+    mRoot->mLayoutBlock      = SphereTree::InvalidIndex;
+    mRoot->mLayoutChildCount = 0;
+    writeLayoutEntry( 0, mRoot );
+    l.entryCount = 1;
+
+    // Assign child blocks in breadth first order. Each node's children are
+    // written as a single run, making them contiguous in the final arrays.
+    SubNodeArray queue;
+    queue.push_back( mRoot );
+    for ( size_t i = 0; i < queue.size(); ++i )
+    {
+        cgSphereTreeSubNode * node = queue[i];
+        const cgUInt32 childCount = node->getChildCount();
+        node->mLayoutBlock      = SphereTree::InvalidIndex;
+        node->mLayoutChildCount = 0;
+        if ( childCount )
+        {
+            // Select the smallest block class that can hold every child.
+            cgUInt32 sizeClass = 0;
+            while ( (SphereTree::MinBlockSize << sizeClass) < childCount && sizeClass + 1 < SphereTree::BlockClassCount )
+                ++sizeClass;
+            node->mLayoutBlock      = allocateLayoutBlock( sizeClass );
+            node->mLayoutBlockClass = sizeClass;
+
+            // Populate the block.
+            for ( cgSphereTreeSubNode * child = node->getChildren(); child; child = child->getNextSibling() )
+            {
+                child->mLayoutBlock      = SphereTree::InvalidIndex;
+                child->mLayoutChildCount = 0;
+                writeLayoutEntry( node->mLayoutBlock + node->mLayoutChildCount++, child );
+                queue.push_back( child );
+            
+            } // Next child
+            l.entryCount += node->mLayoutChildCount;
+
+        } // End if has children
+
+        // Now that the node's block is known, update its own entry.
+        l.firstChild[node->mLayoutIndex] = (childCount) ? node->mLayoutBlock : 0;
+        l.childCount[node->mLayoutIndex] = node->mLayoutChildCount;
+    
+    } // Next node
+
+    // Layout is now up to date.
+    mLayoutDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : allocateLayoutBlock() (Protected)
+/// <summary>
+/// Allocate a block of contiguous layout entries of the specified size class,
+/// returning the index of its first entry. Previously released blocks are
+/// recycled where possible. Arrays are kept padded so that any classification
+/// batch can be loaded in full without reading beyond the allocation.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgUInt32 cgSphereTree::allocateLayoutBlock( cgUInt32 sizeClass )
+{
+    Layout & l = mLayout;
+    const cgUInt32 capacity = SphereTree::MinBlockSize << sizeClass;
+    
+    // Reuse a released block if one is available.
+    cgUInt32Array & freeList = l.freeBlocks[sizeClass];
+    if ( !freeList.empty() )
+    {
+        const cgUInt32 first = freeList.back();
+        freeList.pop_back();
+        l.freeSlots -= capacity;
+        return first;
+    
+    } // End if recycle
+
+    // Otherwise grow the arrays.
+    const cgUInt32 first = l.slotCount;
+    l.slotCount += capacity;
+    const size_t size = l.slotCount + SphereTree::ClassifyBatchSize;
+    l.nodes.resize( size, CG_NULL );
+    l.centerX.resize( size, 0 );
+    l.centerY.resize( size, 0 );
+    l.centerZ.resize( size, 0 );
+    l.radius.resize( size, 0 );
+    l.firstChild.resize( size, 0 );
+    l.childCount.resize( size, 0 );
+    return first;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : releaseLayoutBlock() (Protected)
+/// <summary>
+/// Return the specified block of layout entries for later reuse. If released
+/// blocks come to dominate the layout, it is flagged for compaction.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::releaseLayoutBlock( cgUInt32 first, cgUInt32 sizeClass )
+{
+    Layout & l = mLayout;
+    l.freeBlocks[sizeClass].push_back( first );
+    l.freeSlots += SphereTree::MinBlockSize << sizeClass;
+    if ( l.freeSlots > SphereTree::CompactThreshold && l.freeSlots > l.entryCount )
+        mLayoutDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : writeLayoutEntry() (Protected)
+/// <summary>
+/// Store the specified node (its sphere and child block) in the given entry
+/// of the flattened layout.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::writeLayoutEntry( cgUInt32 index, cgSphereTreeSubNode * node )
+{
+    Layout & l = mLayout;
+    l.nodes[index]      = node;
+    l.centerX[index]    = node->position.x;
+    l.centerY[index]    = node->position.y;
+    l.centerZ[index]    = node->position.z;
+    l.radius[index]     = node->radius;
+    l.firstChild[index] = (node->mLayoutBlock != SphereTree::InvalidIndex) ? node->mLayoutBlock : 0;
+    l.childCount[index] = node->mLayoutChildCount;
+    node->mLayoutIndex  = index;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : linkLayoutChild()
+/// <summary>
+/// Patch the flattened layout to reflect the fact that the specified node has
+/// been attached to the parent. The child is appended to the parent's block,
+/// which is relocated to a block of twice the size when full. The parent need
+/// not itself be present in the layout yet (i.e. a new supersphere).
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::linkLayoutChild( cgSphereTreeSubNode * parent, cgSphereTreeSubNode * child )
+{
+    // Nothing to patch if a full rebuild is already pending.
+    if ( mLayoutDirty )
+        return;
+
+    // Grow the parent's child block if it is full.
+    Layout & l = mLayout;
+    const bool hasBlock = (parent->mLayoutBlock != SphereTree::InvalidIndex);
+    if ( !hasBlock || parent->mLayoutChildCount == (SphereTree::MinBlockSize << parent->mLayoutBlockClass) )
+    {
+        const cgUInt32 sizeClass = (hasBlock) ? parent->mLayoutBlockClass + 1 : 0;
+        if ( sizeClass >= SphereTree::BlockClassCount )
+        {
+            mLayoutDirty = true;
+            return;
+        
+        } // End if too large
+
+        // Move existing children to the new block.
+        const cgUInt32 first = allocateLayoutBlock( sizeClass );
+        for ( cgUInt32 i = 0; i < parent->mLayoutChildCount; ++i )
+        {
+            writeLayoutEntry( first + i, l.nodes[parent->mLayoutBlock + i] );
+            l.nodes[parent->mLayoutBlock + i] = CG_NULL;
+        
+        } // Next child
+        if ( hasBlock )
+            releaseLayoutBlock( parent->mLayoutBlock, parent->mLayoutBlockClass );
+        parent->mLayoutBlock      = first;
+        parent->mLayoutBlockClass = sizeClass;
+
+        // Releasing the old block may have triggered compaction.
+        if ( mLayoutDirty )
+            return;
+    
+    } // End if grow
+
+    // Append the child.
+    writeLayoutEntry( parent->mLayoutBlock + parent->mLayoutChildCount++, child );
+    ++l.entryCount;
+
+    // Update the parent's own entry if it has one.
+    const cgUInt32 parentIndex = parent->mLayoutIndex;
+    if ( parentIndex < l.slotCount && l.nodes[parentIndex] == parent )
+    {
+        l.firstChild[parentIndex] = parent->mLayoutBlock;
+        l.childCount[parentIndex] = parent->mLayoutChildCount;
+    
+    } // End if in layout
+}
+
+//-----------------------------------------------------------------------------
+//  Name : unlinkLayoutChild()
+/// <summary>
+/// Patch the flattened layout to reflect the fact that the specified node has
+/// been detached from the parent. The final child in the parent's block is
+/// moved into the vacated entry to keep the block contiguous. The detached
+/// node retains its own child block so that it may later be re-attached.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::unlinkLayoutChild( cgSphereTreeSubNode * parent, cgSphereTreeSubNode * child )
+{
+    // Nothing to patch if a full rebuild is already pending.
+    if ( mLayoutDirty )
+        return;
+
+    // Validate that the child is where we expect it to be.
+    Layout & l = mLayout;
+    const cgUInt32 index = child->mLayoutIndex;
+    const cgUInt32 first = parent->mLayoutBlock;
+    if ( first == SphereTree::InvalidIndex || index < first || index >= first + parent->mLayoutChildCount || l.nodes[index] != child )
+    {
+        mLayoutDirty = true;
+        return;
+    
+    } // End if mismatch
+
+    // Fill the hole with the final child in the block.
+    const cgUInt32 last = first + --parent->mLayoutChildCount;
+    if ( index != last )
+        writeLayoutEntry( index, l.nodes[last] );
+    l.nodes[last] = CG_NULL;
+    child->mLayoutIndex = SphereTree::InvalidIndex;
+    --l.entryCount;
+
+    // Release the block once it is empty.
+    if ( !parent->mLayoutChildCount )
+    {
+        releaseLayoutBlock( first, parent->mLayoutBlockClass );
+        parent->mLayoutBlock = SphereTree::InvalidIndex;
+    
+    } // End if empty
+
+    // Update the parent's own entry if it has one.
+    const cgUInt32 parentIndex = parent->mLayoutIndex;
+    if ( parentIndex < l.slotCount && l.nodes[parentIndex] == parent )
+    {
+        l.firstChild[parentIndex] = (parent->mLayoutChildCount) ? parent->mLayoutBlock : 0;
+        l.childCount[parentIndex] = parent->mLayoutChildCount;
+    
+    } // End if in layout
+}
+
+//-----------------------------------------------------------------------------
+//  Name : updateLayoutSphere()
+/// <summary>
+/// Write the current position and radius of the specified node through to
+/// its entry in the flattened layout.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::updateLayoutSphere( const cgSphereTreeSubNode * node )
+{
+    const cgUInt32 index = node->getLayoutIndex();
+    if ( mLayoutDirty || index >= mLayout.slotCount || mLayout.nodes[index] != node )
+        return;
+    mLayout.centerX[index] = node->position.x;
+    mLayout.centerY[index] = node->position.y;
+    mLayout.centerZ[index] = node->position.z;
+    mLayout.radius[index]  = node->radius;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeChildVisibility() (Protected)
+/// <summary>
+/// Recursively update the visibility of the children of the specified layout
+/// entry. When the parent intersects the frustum, its children are classified
+/// in batches directly from the flattened layout arrays.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::computeChildVisibility( const TraversalData & data, cgUInt32 parentIndex, cgVolumeQuery::Class parentState )
+{
+    const Layout & l = mLayout;
+    const cgUInt32 first = l.firstChild[parentIndex];
+    const cgUInt32 last  = first + l.childCount[parentIndex];
+    for ( cgUInt32 base = first; base < last; base += SphereTree::ClassifyBatchSize )
+    {
+        const cgUInt32 count = (last - base < SphereTree::ClassifyBatchSize) ? last - base : SphereTree::ClassifyBatchSize;
+
+        // Classify this batch of children (only necessary if the parent
+        // was not entirely inside or outside).
+        cgByte states[SphereTree::ClassifyBatchSize];
+        if ( parentState == cgVolumeQuery::Intersect )
+            SphereTree::classifySpheres( data.planes, &l.centerX[base], &l.centerY[base], &l.centerZ[base], &l.radius[base], count, states );
+        else
+            memset( states, parentState, count );
+
+        // Update visibility for each child and descend.
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            cgSphereTreeSubNode * node = l.nodes[base+i];
+            cgVolumeQuery::Class state = node->updateVisibility( data.visibilityData, data.setIndex, (cgVolumeQuery::Class)states[i], data.sourceLeafVis );
+            if ( l.childCount[base+i] )
+                computeChildVisibility( data, base + i, state );
+        
+        } // Next child
+    
+    } // Next batch
+}
+
+//-----------------------------------------------------------------------------
+//  Name : computeChildVisibility() (Protected)
+/// <summary>
+/// Recursively update the visibility of the specified range of layout entries
+/// for every view in the batch. Views whose bit is set in 'testMask' require
+/// each sphere to be classified, those in 'insideMask' inherit the inside
+/// state, and all others inherit the outside state. Set membership changes
+/// are recorded in the supplied per-view lists rather than applied directly.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgSphereTree::computeChildVisibility( const BatchData & data, cgUInt32 first, cgUInt32 last, cgUInt32 testMask, cgUInt32 insideMask, VisibilityChangeArray * changes )
+{
+    const Layout & l = mLayout;
+    for ( cgUInt32 base = first; base < last; base += SphereTree::ClassifyBatchSize )
+    {
+        const cgUInt32 count = (last - base < SphereTree::ClassifyBatchSize) ? last - base : SphereTree::ClassifyBatchSize;
+
+        // Classify this batch of spheres for each view.
+        cgByte states[MaxBatchViews][SphereTree::ClassifyBatchSize];
+        for ( cgUInt32 v = 0; v < data.viewCount; ++v )
+        {
+            const cgUInt32 bit = (1u << v);
+            if ( testMask & bit )
+                SphereTree::classifySpheres( data.views[v].planes, &l.centerX[base], &l.centerY[base], &l.centerZ[base], &l.radius[base], count, states[v] );
+            else
+                memset( states[v], (insideMask & bit) ? cgVolumeQuery::Inside : cgVolumeQuery::Outside, count );
+        
+        } // Next view
+
+        // Update visibility for each sphere and descend.
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            cgSphereTreeSubNode * node = l.nodes[base+i];
+            cgUInt32 childTestMask = 0, childInsideMask = 0;
+            for ( cgUInt32 v = 0; v < data.viewCount; ++v )
+            {
+                const TraversalData & view = data.views[v];
+                cgVolumeQuery::Class state = node->updateVisibility( view.visibilityData, view.setIndex, (cgVolumeQuery::Class)states[v][i], view.sourceLeafVis, &changes[v] );
+                if ( state == cgVolumeQuery::Intersect )
+                    childTestMask |= (1u << v);
+                else if ( state == cgVolumeQuery::Inside )
+                    childInsideMask |= (1u << v);
+            
+            } // Next view
+
+            // Process children.
+            const cgUInt32 childCount = l.childCount[base+i];
+            if ( childCount )
+            {
+                const cgUInt32 childFirst = l.firstChild[base+i];
+                computeChildVisibility( data, childFirst, childFirst + childCount, childTestMask, childInsideMask, changes );
+            
+            } // End if has children
+        
+        } // Next sphere
+    
+    } // Next batch
 }
 
 //-----------------------------------------------------------------------------
@@ -341,6 +1009,7 @@ void cgSphereTree::integrate( cgSphereTreeSubNode * node, cgSphereTreeSubNode *
             {
                 node->unlink();
                 nearest2->radius = newSize;
+                updateLayoutSphere( nearest2 );
                 nearest2->addChild(node);
                 nearest2->recompute(mPadding);
                 node->computeBindingDistance(nearest2);
@@ -484,6 +1153,7 @@ bool cgSphereTreeSubNode::recompute( cgFloat padding )
         // Update our final enclosing radius
         maximumRadius += padding;
         this->radius = maximumRadius;
+        mTree->updateLayoutSphere( this );
 
         // All children now have to recompute their binding distance.
         node = mChildren;
@@ -551,13 +1221,41 @@ void cgSphereTreeSubNode::invalidateVisibility( )
 /// supplied frustum.
 /// </summary>
 //-----------------------------------------------------------------------------
-#include <World/Objects/cgPointLight.h>
 void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibilitySet * visibilityData, cgUInt32 setIndex, cgUInt32 flags, cgVolumeQuery::Class state, cgBSPTree * staticVisTree, cgUInt32 sourceLeaf, const cgByte * sourceLeafVis )
 {
     // Further refine frustum based visibility state as necessary.
     if ( state == cgVolumeQuery::Intersect )
         state = frustum.classifySphere( this->position, this->radius );
 
+    // Update our own visibility state.
+    state = updateVisibility( visibilityData, setIndex, state, sourceLeafVis );
+
+    // Process children
+    if ( isFlagSet( cgSphereTree::SuperSphere ) )
+    {
+        cgSphereTreeSubNode * child = mChildren;
+        while ( child )
+        {
+            child->computeVisibility( frustum, visibilityData, setIndex, flags, state, staticVisTree, sourceLeaf, sourceLeafVis );
+            child = child->getNextSibling();
+        
+        } // Next child
+
+    } // End if supersphere
+}
+
+//-----------------------------------------------------------------------------
+//  Name : updateVisibility()
+/// <summary>
+/// Update the frame coherent visibility flags (and visibility set membership
+/// for terminal nodes) of this node given its frustum classification. Returns
+/// the final state after any PVS refinement, to be inherited by children.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgVolumeQuery::Class cgSphereTreeSubNode::updateVisibility( cgVisibilitySet * visibilityData, cgUInt32 setIndex, cgVolumeQuery::Class state, const cgByte * sourceLeafVis, cgSphereTree::VisibilityChangeArray * deferredChanges /* = CG_NULL */ )
+{
+    cgBSPTree * staticVisTree = mTree->getStaticVisTree();
+
     // If the sphere passes the frustum check, test against the PVS if one is available.
     if ( state != cgVolumeQuery::Outside && sourceLeafVis && isFlagSet( cgSphereTree::Terminal ) )
     {
@@ -632,15 +1330,6 @@ void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibi
         
         } // End if !outside
 
-        // Process children
-        cgSphereTreeSubNode * child = mChildren;
-        while ( child )
-        {
-            child->computeVisibility( frustum, visibilityData, setIndex, flags, state, staticVisTree, sourceLeaf, sourceLeafVis );
-            child = child->getNextSibling();
-        
-        } // Next child
-
     } // End if supersphere
     else
     {
@@ -663,7 +1352,7 @@ void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibi
                         if ( isFlagSet( cgSphereTree::Terminal ) )
                         {
                             // Add to visibility set.
-                            ((cgObjectNode*)mUserData)->registerVisibility( visibilityData );
+                            SphereTree::setObjectVisibility( (cgObjectNode*)mUserData, visibilityData, true, deferredChanges );
                         
                         } // End if leaf
 
@@ -681,7 +1370,7 @@ void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibi
                     if ( isFlagSet( cgSphereTree::Terminal ) )
                     {
                         // Remove from visibility set.
-                        ((cgObjectNode*)mUserData)->unregisterVisibility( visibilityData );
+                        SphereTree::setObjectVisibility( (cgObjectNode*)mUserData, visibilityData, false, deferredChanges );
                     
                     } // End if leaf
                 
@@ -705,7 +1394,7 @@ void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibi
                         if ( isFlagSet( cgSphereTree::Terminal ) )
                         {
                             // Add to visibility set.
-                            ((cgObjectNode*)mUserData)->registerVisibility( visibilityData );
+                            SphereTree::setObjectVisibility( (cgObjectNode*)mUserData, visibilityData, true, deferredChanges );
                         
                         } // End if leaf
 
@@ -717,4 +1406,7 @@ void cgSphereTreeSubNode::computeVisibility( const cgFrustum & frustum, cgVisibi
         } // End switch state
 
     } // End if !supersphere
+
+    // Return final state for children to inherit.
+    return state;
 }
\ No newline at end of file
@@ -21,8 +21,6 @@
 // TODO: Object needs to remove itself from the visibility set if its shadow caster / renderable status changes
 // TODO: cgLightNode::registerVisibility did a narrow phase test that is now disabled (will not function with frame coherence -- think about this further).
 // TODO: cgScene::sandboxRender will not currently collect ALL objects as it did before.
-// TODO: Render class combined bounding box needs to be recomputed when removing.
-// TODO: Material batch combined bounding box needs to be recomputed when removing.
 
 //-----------------------------------------------------------------------------
 // Precompiled Header
@@ -35,8 +33,10 @@
 #include <World/cgVisibilitySet.h>
 #include <World/cgScene.h>
 #include <World/cgSphereTree.h>
+#include <World/cgSpatialTree.h>
 #include <World/Objects/cgLightObject.h>
 #include <System/cgTimer.h>
+#include <algorithm>
 
 //-----------------------------------------------------------------------------
 // Static Member Variable Definitions
@@ -60,6 +60,16 @@ cgVisibilitySet::cgVisibilitySet( cgScene * scene )
     mLastComputedFrame    = 0;
     mLastModifiedFrame    = 0;
     mSearchFlags          = cgVisibilitySearchFlags::MustRender;
+    mGeneration           = 1;
+    mMembershipEpoch      = 0;
+    mMaterialCompactSize  = 1024;
+    mRenderClassesDirty   = false;
+    mRevision             = 1;
+    mLegacyObjectsRevision        = 0;
+    mLegacyLightsRevision         = 0;
+    mLegacyLeavesRevision         = 0;
+    mLegacyGroupsRevision         = 0;
+    mLegacyRenderClassesRevision  = 0;
 
     // Register with the scene tree.
     if ( scene && scene->getSceneTree() )
@@ -122,6 +132,75 @@ void cgVisibilitySet::compute( const cgFrustum & Frustum )
     mLastFrustum          = mFrustum;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : compute () (Static)
+/// <summary>
+/// Compute the visibility for several sets at once, each based on its
+/// matching frustum. Sets belonging to the same scene are populated during a
+/// single shared traversal of the scene's broadphase data. Sets that have
+/// already been computed this frame for the same frustum are skipped.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::compute( cgVisibilitySet ** sets, const cgFrustum ** frustums, cgUInt32 count )
+{
+    // Collect the sets that really need to be recomputed in this frame.
+    const cgUInt32 frame = cgTimer::getInstance()->getFrameCounter();
+    cgArray<cgVisibilitySet*> pendingSets;
+    pendingSets.reserve( count );
+    for ( cgUInt32 i = 0; i < count; ++i )
+    {
+        cgVisibilitySet * set = sets[i];
+        if ( !set || (set->mLastComputedFrame == frame && set->mLastFrustum == *frustums[i]) )
+            continue;
+        if ( std::find( pendingSets.begin(), pendingSets.end(), set ) != pendingSets.end() )
+            continue;
+
+        // Store the frustum used for visibility computation so that other
+        // parts of the system can query for the visibility volume later.
+        set->mFrustum = *frustums[i];
+        pendingSets.push_back( set );
+    
+    } // Next set
+
+    // Compute visibility for each scene referenced by the pending sets.
+    cgArray<cgVisibilitySet*> sceneSets;
+    cgArray<const cgFrustum*> sceneFrustums;
+    while ( !pendingSets.empty() )
+    {
+        // Extract all sets that share the scene of the first entry.
+        cgScene * scene = pendingSets.front()->mScene;
+        sceneSets.clear();
+        sceneFrustums.clear();
+        for ( size_t i = 0; i < pendingSets.size(); )
+        {
+            cgVisibilitySet * set = pendingSets[i];
+            if ( set->mScene == scene )
+            {
+                sceneSets.push_back( set );
+                sceneFrustums.push_back( &set->mFrustum );
+                pendingSets.erase( pendingSets.begin() + i );
+            
+            } // End if matching scene
+            else
+                ++i;
+        
+        } // Next set
+
+        // Ask the scene to register all visible objects for each set.
+        scene->computeVisibility( &sceneFrustums.front(), &sceneSets.front(), (cgUInt32)sceneSets.size() );
+
+        // Record information about this computation in order to prevent
+        // it from being accidentally recomputed a second time in any given frame.
+        for ( size_t i = 0; i < sceneSets.size(); ++i )
+        {
+            sceneSets[i]->mLastComputedFrame = frame;
+            sceneSets[i]->mLastFrustum       = sceneSets[i]->mFrustum;
+        
+        } // Next set
+    
+    } // Next scene
+}
+
 //-----------------------------------------------------------------------------
 //  Name : query ()
 /// <summary>
@@ -136,9 +215,9 @@ bool cgVisibilitySet::query( cgObjectNode * pObject ) const
 
     // Test the correct set.
     if ( pObject->queryReferenceType( RTID_LightNode ) )
-        return (mLightLUT.find( pObject ) != mLightLUT.end());
+        return isMember( mLightMembership, mLights, pObject, mGeneration );
     else 
-        return (mObjectNodeLUT.find( pObject ) != mObjectNodeLUT.end());
+        return isMember( mObjectMembership, mObjectNodes, pObject, mGeneration );
 }
 
 //-----------------------------------------------------------------------------
@@ -149,14 +228,65 @@ bool cgVisibilitySet::query( cgObjectNode * pObject ) const
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::clear( )
 {
-    // Clear out tree visibility data
-    mTreeLeaves.clear();
-    mAssociatedGroups.clear();
+    // Clear out tree visibility data. The entries for each tree / context
+    // (and their storage) are retained for reuse, and existing membership
+    // stamps are invalidated simply by advancing each entry's generation.
+    for ( size_t i = 0; i < mTreeLeaves.size(); ++i )
+    {
+        TreeLeaves & entry = mTreeLeaves[i];
+        entry.leaves.clear();
+        if ( ++entry.generation == 0 )
+        {
+            entry.leafStamps.assign( entry.leafStamps.size(), 0 );
+            entry.generation = 1;
+        
+        } // End if wrapped
+    
+    } // Next tree
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        AssociatedGroups & entry = mAssociatedGroups[i];
+        entry.groups.clear();
+        if ( ++entry.generation == 0 )
+        {
+            entry.groupStamps.assign( entry.groupStamps.size(), 0 );
+            entry.generation = 1;
+        
+        } // End if wrapped
+    
+    } // Next context
+
+    // Clear out object visibility data in the same way. Membership stamps
+    // only need to be reset if the generation counter wraps around.
     mObjectNodes.clear();
-    mObjectNodeLUT.clear();
     mLights.clear();
-    mLightLUT.clear();
+    mMaterials.clear();
+    mMaterialSlots.clear();
+    mMaterialEntries.clear();
+    mMaterialCompactSize = 1024;
+    if ( ++mGeneration == 0 )
+    {
+        Membership empty = { 0, 0, 0 };
+        mObjectMembership.assign( mObjectMembership.size(), empty );
+        mLightMembership.assign( mLightMembership.size(), empty );
+        mGeneration = 1;
+
+    } // End if wrapped
+
+    // Release render class data.
     mRenderClasses.clear();
+    mMaterialBatches.clear();
+    mClassObjects.clear();
+    mBatchObjects.clear();
+    mRenderClassesDirty = false;
+
+    // Release any compatibility copies.
+    mLegacyObjects.clear();
+    mLegacyLights.clear();
+    mLegacyLeaves.clear();
+    mLegacyGroups.clear();
+    mLegacyRenderClasses.clear();
+    ++mRevision;
 
     // Select the next unique visibility result identifier
     mResultId = mNextResultId++;
@@ -194,6 +324,78 @@ bool cgVisibilitySet::isSetModifiedSince( cgUInt32 frame ) const
     return (mLastModifiedFrame >= frame);
 }
 
+//-----------------------------------------------------------------------------
+//  Name : addMember () (Private, Static)
+/// <summary>
+/// Append the node to the specified array if it is not already a member in
+/// the current generation, stamping its membership entry as we go.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgVisibilitySet::addMember( MembershipArray & membership, cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation, cgUInt32 epoch )
+{
+    // Skip node if it already exists.
+    if ( isMember( membership, nodes, node, generation ) )
+        return false;
+
+    // Grow the membership array to cover this node's index if necessary.
+    const cgUInt32 index = node->getVisibilityIndex();
+    if ( index >= membership.size() )
+    {
+        Membership empty = { 0, 0, 0 };
+        membership.resize( index + 1, empty );
+    
+    } // End if grow
+
+    // Stamp and store.
+    Membership & entry = membership[index];
+    entry.generation = generation;
+    entry.position   = (cgUInt32)nodes.size();
+    entry.epoch      = epoch;
+    nodes.push_back( node );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : removeMember () (Private, Static)
+/// <summary>
+/// Remove the node from the specified array if it is a member in the current
+/// generation. The last node in the array is moved into the vacated slot.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgVisibilitySet::removeMember( MembershipArray & membership, cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation )
+{
+    if ( !isMember( membership, nodes, node, generation ) )
+        return false;
+
+    // Move the last node into the vacated slot.
+    Membership & entry = membership[node->getVisibilityIndex()];
+    cgObjectNode * lastNode = nodes.back();
+    nodes[entry.position] = lastNode;
+    membership[lastNode->getVisibilityIndex()].position = entry.position;
+    nodes.pop_back();
+
+    // Node is no longer a member.
+    entry.generation = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : isMember () (Private, Static)
+/// <summary>
+/// Determine if the node is a member of the specified array in the current
+/// generation. The stored position is also validated so that a stale stamp
+/// left behind by a node whose index has since been reissued is ignored.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgVisibilitySet::isMember( const MembershipArray & membership, const cgObjectNodeArray & nodes, cgObjectNode * node, cgUInt32 generation )
+{
+    const cgUInt32 index = node->getVisibilityIndex();
+    if ( index >= membership.size() )
+        return false;
+    const Membership & entry = membership[index];
+    return ( entry.generation == generation && entry.position < nodes.size() && nodes[entry.position] == node );
+}
+
 //-----------------------------------------------------------------------------
 //  Name : addVisibleObject ()
 /// <summary>
@@ -207,35 +409,24 @@ bool cgVisibilitySet::addVisibleObject( cgObjectNode * pObject )
     /*if ( !pObject || !pObject->getReferenceId() )
         return;*/
     
-    // Skip object if it already exists (user lower bound for existence test, which will also 
-    // act as the insert point if no precise match was found).
-    EntryLUT::iterator itLB = mObjectNodeLUT.lower_bound( pObject );
-    if ( itLB == mObjectNodeLUT.end() || mObjectNodeLUT.key_comp()(pObject,itLB->first) )
-    {
-        // Store in the list.
-        mObjectNodes.push_back( pObject );
-        mObjectNodeLUT.insert( itLB, EntryLUT::value_type( pObject, --mObjectNodes.end() ) );
-
-        // Also store in render class list.
-        RenderClass & Class = mRenderClasses[pObject->getRenderClassId()];
-        Class.objectNodes.push_back( pObject );
-        Class.objectNodeLUT[ pObject ] = --Class.objectNodes.end();
-
-        // Add to the combined bounding box for the entire render class.
-        const cgBoundingBox & Bounds = pObject->getBoundingBox();
-        Class.combinedBounds.addPoint( Bounds.min );
-        Class.combinedBounds.addPoint( Bounds.max );
-
-        // Update last modified frame timer
-        mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
+    // Skip object if it already exists. Each membership period receives a
+    // new epoch (never 0) so that material entries registered while the
+    // object was previously visible are not resurrected.
+    if ( isMember( mObjectMembership, mObjectNodes, pObject, mGeneration ) )
+        return false;
+    if ( ++mMembershipEpoch == 0 )
+        mMembershipEpoch = 1;
+    addMember( mObjectMembership, mObjectNodes, pObject, mGeneration, mMembershipEpoch );
 
-        // Added
-        return true;
+    // Render classes will need to be rebuilt.
+    mRenderClassesDirty = true;
+    ++mRevision;
 
-    } // End if does not exist.
+    // Update last modified frame timer
+    mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
 
-    // Nothing added
-    return false;
+    // Added
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -247,54 +438,13 @@ bool cgVisibilitySet::addVisibleObject( cgObjectNode * pObject )
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::removeVisibleObject( cgObjectNode * pObject )
 {
-    EntryLUT::iterator itObject = mObjectNodeLUT.find( pObject );
-    if ( itObject != mObjectNodeLUT.end() )
+    // Material entries registered during this membership become stale (see
+    // 'isCurrentEntry()') and are discarded when entries are next compacted.
+    if ( removeMember( mObjectMembership, mObjectNodes, pObject, mGeneration ) )
     {
-        // Remove from the main object node list.
-        mObjectNodes.erase( itObject->second );
-        mObjectNodeLUT.erase( itObject );
-
-        // Remove from the render class list.
-        RenderClassMap::iterator itClass = mRenderClasses.find( pObject->getRenderClassId() );
-        if ( itClass != mRenderClasses.end() )
-        {
-            RenderClass & renderClass = itClass->second;
-            EntryLUT::iterator itClassObject = renderClass.objectNodeLUT.find( pObject );
-            if ( itClassObject != renderClass.objectNodeLUT.end() )
-            {
-                renderClass.objectNodes.erase( itClassObject->second );
-                renderClass.objectNodeLUT.erase( itClassObject );
-
-                // Remove object from all materials. TODO: This is temporary.
-                MaterialBatchMap::iterator itMaterial;
-                for ( itMaterial = renderClass.materials.begin(); itMaterial != renderClass.materials.end();  )
-                {
-                    MaterialBatch & batch = itMaterial->second;
-                    EntryLUT::iterator itMaterialObject = batch.objectNodeLUT.find( pObject );
-                    if ( itMaterialObject != batch.objectNodeLUT.end() )
-                    {
-                        batch.objectNodes.erase( itMaterialObject->second );
-                        batch.objectNodeLUT.erase( itMaterialObject );
-
-                        // Remove material batch if it is now empty.
-                        if ( batch.objectNodes.empty() )
-                            itMaterial = renderClass.materials.erase( itMaterial );
-                        else
-                            ++itMaterial;
-
-                    } // End if found object
-                    else
-                        ++itMaterial;
-
-                } // Next material
-
-                // Remove render class if it is now empty.
-                if ( renderClass.objectNodes.empty() && renderClass.materials.empty() )
-                    mRenderClasses.erase( itClass );
-            
-            } // End if found object
-
-        } // End if found class
+        // Render classes will need to be rebuilt.
+        mRenderClassesDirty = true;
+        ++mRevision;
 
         // Update last modified frame timer
         mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
@@ -315,25 +465,16 @@ bool cgVisibilitySet::addVisibleLight( cgObjectNode * pLight )
     if ( !pLight || !pLight->GetReferenceId() )
         return;*/
     
-    // Skip object if it already exists (user lower bound for existence test, which will also 
-    // act as the insert point if no precise match was found).
-    EntryLUT::iterator itLB = mLightLUT.lower_bound( pLight );
-    if ( itLB == mLightLUT.end() || mLightLUT.key_comp()(pLight,itLB->first) )
-    {
-        // Store in the list (will automatically overwrite if already exists).
-        mLights.push_back( pLight );
-        mLightLUT.insert( itLB, EntryLUT::value_type( pLight, --mLights.end() ) );
-
-        // Update last modified frame timer
-        mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
-
-        // Added
-        return true;
+    // Skip light if it already exists.
+    if ( !addMember( mLightMembership, mLights, pLight, mGeneration, 0 ) )
+        return false;
+    ++mRevision;
 
-    } // End if does not exist.
+    // Update last modified frame timer
+    mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
 
-    // Nothing added
-    return false;
+    // Added
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -344,12 +485,9 @@ bool cgVisibilitySet::addVisibleLight( cgObjectNode * pLight )
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::removeVisibleLight( cgObjectNode * pLight )
 {
-    EntryLUT::iterator itLight = mLightLUT.find( pLight );
-    if ( itLight != mLightLUT.end() )
+    if ( removeMember( mLightMembership, mLights, pLight, mGeneration ) )
     {
-        // Remove from the main light list.
-        mLights.erase( itLight->second );
-        mLightLUT.erase( itLight );
+        ++mRevision;
 
         // Update last modified frame timer
         mLastModifiedFrame = cgTimer::getInstance()->getFrameCounter();
@@ -367,28 +505,51 @@ void cgVisibilitySet::removeVisibleLight( cgObjectNode * pLight )
 //-----------------------------------------------------------------------------
 bool cgVisibilitySet::addVisibleMaterial( const cgMaterialHandle & hMaterial, cgObjectNode * pObject )
 {
-    MaterialBatch & Material = mRenderClasses[pObject->getRenderClassId()].materials[ hMaterial ];
+    // Materials can only be registered against visible objects.
+    if ( !isMember( mObjectMembership, mObjectNodes, pObject, mGeneration ) )
+        return false;
+    const cgUInt32 epoch = mObjectMembership[pObject->getVisibilityIndex()].epoch;
 
-    // Skip material if it already exists (user lower bound for existence test, which will also 
-    // act as the insert point if no precise match was found).
-    EntryLUT::iterator itLB = Material.objectNodeLUT.lower_bound( pObject );
-    if ( itLB == Material.objectNodeLUT.end() || Material.objectNodeLUT.key_comp()(pObject,itLB->first) )
+    // Find (or assign) the entry for this material in the material table.
+    cgUInt32 material;
+    void * key = (void*)hMaterial.getResourceSilent();
+    MaterialSlotMap::iterator itSlot = mMaterialSlots.find( key );
+    if ( itSlot == mMaterialSlots.end() )
+    {
+        material = (cgUInt32)mMaterials.size();
+        mMaterials.push_back( hMaterial );
+        mMaterialSlots[key] = material;
+    
+    } // End if new material
+    else
     {
-        Material.objectNodes.push_back( pObject );
-        Material.objectNodeLUT.insert( itLB, EntryLUT::value_type( pObject, --Material.objectNodes.end() ) );
+        material = itSlot->second;
 
-        // Add to the combined bounding box for the entire material match.
-        const cgBoundingBox & Bounds = pObject->getBoundingBox();
-        Material.combinedBounds.addPoint( Bounds.min );
-        Material.combinedBounds.addPoint( Bounds.max );
+        // Materials for an object are registered immediately after the object
+        // itself, so the most recent entries are sufficient to reject duplicates.
+        for ( size_t i = mMaterialEntries.size(); i > 0 && mMaterialEntries[i-1].node == pObject && mMaterialEntries[i-1].epoch == epoch; --i )
+        {
+            if ( mMaterialEntries[i-1].material == material )
+                return false;
+        
+        } // Next entry
 
-        // Added
-        return true;
-    
-    } // End if not existing
+    } // End if existing material
 
-    // Nothing added
-    return false;
+    // Record the entry. Entries are batched by render class and material
+    // in a single sorting pass when the render classes are next requested.
+    MaterialEntry entry = { material, pObject, epoch };
+    mMaterialEntries.push_back( entry );
+    mRenderClassesDirty = true;
+    ++mRevision;
+
+    // Discard entries for objects that are no longer visible if we have
+    // accumulated a large number since the last time this was done.
+    if ( mMaterialEntries.size() >= mMaterialCompactSize )
+        compactMaterialEntries();
+
+    // Added
+    return true;
 
     /*// Objects must have a valid reference identifier in order to be considered.
     if ( pObject == CG_NULL || pObject->GetReferenceId() == 0 || hMaterial.IsValid() == false )
@@ -398,6 +559,177 @@ bool cgVisibilitySet::addVisibleMaterial( const cgMaterialHandle & hMaterial, cg
     mRenderClasses[pObject->getRenderClassId()].materials[hMaterial].insert( pObject );*/
 }
 
+//-----------------------------------------------------------------------------
+//  Name : isCurrentEntry () (Private)
+/// <summary>
+/// Determine if the material entry was registered during the current
+/// membership of its object. Entries left behind by an object that has since
+/// been removed (and possibly added again) are stale.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgVisibilitySet::isCurrentEntry( const MaterialEntry & entry ) const
+{
+    if ( !isMember( mObjectMembership, mObjectNodes, entry.node, mGeneration ) )
+        return false;
+    return ( mObjectMembership[entry.node->getVisibilityIndex()].epoch == entry.epoch );
+}
+
+//-----------------------------------------------------------------------------
+//  Name : compactMaterialEntries () (Private)
+/// <summary>
+/// Discard material entries that are stale (see 'isCurrentEntry()'), along
+/// with any material table entries that are no longer in use.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::compactMaterialEntries( )
+{
+    // Remove stale entries, remapping
+    // the surviving entries onto a new material table as we go.
+    cgUInt32Array remap( mMaterials.size(), 0xFFFFFFFF );
+    cgMaterialHandleArray materials;
+    size_t kept = 0;
+    for ( size_t i = 0; i < mMaterialEntries.size(); ++i )
+    {
+        MaterialEntry entry = mMaterialEntries[i];
+        if ( !isCurrentEntry( entry ) )
+            continue;
+
+        cgUInt32 & newMaterial = remap[entry.material];
+        if ( newMaterial == 0xFFFFFFFF )
+        {
+            newMaterial = (cgUInt32)materials.size();
+            materials.push_back( mMaterials[entry.material] );
+        
+        } // End if first use
+        entry.material = newMaterial;
+        mMaterialEntries[kept++] = entry;
+    
+    } // Next entry
+    mMaterialEntries.resize( kept );
+
+    // Update the material look up table to match.
+    for ( size_t i = 0; i < mMaterials.size(); ++i )
+    {
+        void * key = (void*)mMaterials[i].getResourceSilent();
+        if ( remap[i] == 0xFFFFFFFF )
+            mMaterialSlots.erase( key );
+        else
+            mMaterialSlots[key] = remap[i];
+    
+    } // Next material
+    mMaterials.swap( materials );
+
+    // Compact again once the number of entries has doubled.
+    mMaterialCompactSize = std::max<size_t>( kept * 2, 1024 );
+    mRenderClassesDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildRenderClasses () (Private)
+/// <summary>
+/// Build the render class and material batch index from the current set of
+/// visible objects and their registered materials.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildRenderClasses( ) const
+{
+    mRenderClasses.clear();
+    mMaterialBatches.clear();
+    mClassObjects.clear();
+    mBatchObjects.clear();
+    mRenderClassesDirty = false;
+    if ( mObjectNodes.empty() )
+        return;
+
+    // Sort the visible objects by render class. The key retains the position
+    // of each object in the visible array (in its low bits) so that the order
+    // of objects within each class is preserved.
+    mClassKeys.resize( mObjectNodes.size() );
+    for ( size_t i = 0; i < mObjectNodes.size(); ++i )
+        mClassKeys[i] = ((cgUInt64)mObjectNodes[i]->getRenderClassId() << 32) | (cgUInt64)i;
+    std::sort( mClassKeys.begin(), mClassKeys.end() );
+
+    // Collect the material entries that are still current and
+    // sort them into render class / material order, discarding duplicates.
+    mBatchKeys.clear();
+    mBatchKeys.reserve( mMaterialEntries.size() );
+    for ( size_t i = 0; i < mMaterialEntries.size(); ++i )
+    {
+        const MaterialEntry & entry = mMaterialEntries[i];
+        if ( !isCurrentEntry( entry ) )
+            continue;
+        BatchKey key = { entry.node->getRenderClassId(), entry.material, entry.node->getVisibilityIndex(), (cgUInt32)i };
+        mBatchKeys.push_back( key );
+    
+    } // Next entry
+    std::sort( mBatchKeys.begin(), mBatchKeys.end() );
+    mBatchKeys.erase( std::unique( mBatchKeys.begin(), mBatchKeys.end() ), mBatchKeys.end() );
+
+    // Populate the flat object arrays first so that the pointers assigned
+    // to each class and batch below remain valid.
+    mClassObjects.resize( mClassKeys.size() );
+    for ( size_t i = 0; i < mClassKeys.size(); ++i )
+        mClassObjects[i] = mObjectNodes[(size_t)(mClassKeys[i] & 0xFFFFFFFF)];
+    mBatchObjects.resize( mBatchKeys.size() );
+    for ( size_t i = 0; i < mBatchKeys.size(); ++i )
+        mBatchObjects[i] = mMaterialEntries[mBatchKeys[i].entry].node;
+
+    // Build material batches from each run of matching keys.
+    for ( size_t i = 0; i < mBatchKeys.size(); )
+    {
+        const BatchKey & first = mBatchKeys[i];
+        MaterialRange batch;
+        batch.renderClassId = first.renderClassId;
+        batch.material      = mMaterials[first.material];
+        batch.objectNodes   = &mBatchObjects[i];
+
+        // Add to the combined bounding box for the entire material match.
+        size_t j = i;
+        for ( ; j < mBatchKeys.size() && mBatchKeys[j].renderClassId == first.renderClassId && mBatchKeys[j].material == first.material; ++j )
+        {
+            const cgBoundingBox & bounds = mBatchObjects[j]->getBoundingBox();
+            batch.combinedBounds.addPoint( bounds.min );
+            batch.combinedBounds.addPoint( bounds.max );
+        
+        } // Next object
+        batch.objectCount = (cgUInt32)(j - i);
+        mMaterialBatches.push_back( batch );
+        i = j;
+
+    } // Next run
+
+    // Build render classes in the same way, attaching the material batches
+    // that share each class (both arrays are sorted by class identifier).
+    size_t nextBatch = 0;
+    for ( size_t i = 0; i < mClassKeys.size(); )
+    {
+        RenderClassRange renderClass;
+        renderClass.renderClassId = (cgUInt32)(mClassKeys[i] >> 32);
+        renderClass.objectNodes   = &mClassObjects[i];
+
+        // Add to the combined bounding box for the entire render class.
+        size_t j = i;
+        for ( ; j < mClassKeys.size() && (cgUInt32)(mClassKeys[j] >> 32) == renderClass.renderClassId; ++j )
+        {
+            const cgBoundingBox & bounds = mClassObjects[j]->getBoundingBox();
+            renderClass.combinedBounds.addPoint( bounds.min );
+            renderClass.combinedBounds.addPoint( bounds.max );
+        
+        } // Next object
+        renderClass.objectCount = (cgUInt32)(j - i);
+        i = j;
+
+        // Attach material batches.
+        size_t firstBatch = nextBatch;
+        while ( nextBatch < mMaterialBatches.size() && mMaterialBatches[nextBatch].renderClassId == renderClass.renderClassId )
+            ++nextBatch;
+        renderClass.materials     = (nextBatch > firstBatch) ? &mMaterialBatches[firstBatch] : CG_NULL;
+        renderClass.materialCount = (cgUInt32)(nextBatch - firstBatch);
+        mRenderClasses.push_back( renderClass );
+
+    } // Next run
+}
+
 //-----------------------------------------------------------------------------
 //  Name : addVisibleLeaf ()
 /// <summary>
@@ -407,8 +739,34 @@ bool cgVisibilitySet::addVisibleMaterial( const cgMaterialHandle & hMaterial, cg
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::addVisibleLeaf( cgSpatialTreeInstance * pTree, cgSpatialTreeLeaf * pLeaf )
 {
-    // Store in the list (will automatically overwrite if already exists)
-    (mTreeLeaves[pTree]).insert( pLeaf );
+    // Find the entry for the specified tree (there are rarely more than a few).
+    TreeLeaves * pEntry = CG_NULL;
+    for ( size_t i = 0; i < mTreeLeaves.size() && !pEntry; ++i )
+    {
+        if ( mTreeLeaves[i].tree == pTree )
+            pEntry = &mTreeLeaves[i];
+    
+    } // Next tree
+    if ( !pEntry )
+    {
+        mTreeLeaves.resize( mTreeLeaves.size() + 1 );
+        pEntry = &mTreeLeaves.back();
+        pEntry->tree       = pTree;
+        pEntry->generation = 1;
+    
+    } // End if new tree
+
+    // Skip leaf if it already exists.
+    const cgUInt32 leafIndex = pLeaf->getLeafIndex();
+    if ( leafIndex >= pEntry->leafStamps.size() )
+        pEntry->leafStamps.resize( leafIndex + 1, 0 );
+    if ( pEntry->leafStamps[leafIndex] == pEntry->generation )
+        return;
+
+    // Stamp and store.
+    pEntry->leafStamps[leafIndex] = pEntry->generation;
+    pEntry->leaves.push_back( pLeaf );
+    ++mRevision;
 }
 
 //-----------------------------------------------------------------------------
@@ -421,8 +779,44 @@ void cgVisibilitySet::addVisibleLeaf( cgSpatialTreeInstance * pTree, cgSpatialTr
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::addVisibleGroup( void * pContext, cgInt32 nDataGroupId )
 {
-    // Store in the list (will automatically overwrite if already exists)
-    (mAssociatedGroups[pContext]).insert( nDataGroupId );
+    // Find the entry for the specified context (there are rarely more than a few).
+    AssociatedGroups * pEntry = CG_NULL;
+    for ( size_t i = 0; i < mAssociatedGroups.size() && !pEntry; ++i )
+    {
+        if ( mAssociatedGroups[i].context == pContext )
+            pEntry = &mAssociatedGroups[i];
+    
+    } // Next context
+    if ( !pEntry )
+    {
+        mAssociatedGroups.resize( mAssociatedGroups.size() + 1 );
+        pEntry = &mAssociatedGroups.back();
+        pEntry->context    = pContext;
+        pEntry->generation = 1;
+    
+    } // End if new context
+
+    // Skip group if it already exists. Group identifiers are typically dense
+    // indices, but fall back to a search for any that cannot be stamped.
+    if ( nDataGroupId < 0 )
+    {
+        if ( std::find( pEntry->groups.begin(), pEntry->groups.end(), nDataGroupId ) != pEntry->groups.end() )
+            return;
+
+    } // End if not stampable
+    else
+    {
+        if ( (size_t)nDataGroupId >= pEntry->groupStamps.size() )
+            pEntry->groupStamps.resize( nDataGroupId + 1, 0 );
+        if ( pEntry->groupStamps[nDataGroupId] == pEntry->generation )
+            return;
+        pEntry->groupStamps[nDataGroupId] = pEntry->generation;
+    
+    } // End if stampable
+
+    // Store.
+    pEntry->groups.push_back( nDataGroupId );
+    ++mRevision;
 }
 
 //-----------------------------------------------------------------------------
@@ -433,20 +827,168 @@ void cgVisibilitySet::addVisibleGroup( void * pContext, cgInt32 nDataGroupId )
 //-----------------------------------------------------------------------------
 void cgVisibilitySet::clearVisibleGroups( void * pContext )
 {
-    mAssociatedGroups.erase( pContext );
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        AssociatedGroups & entry = mAssociatedGroups[i];
+        if ( entry.context != pContext )
+            continue;
+
+        // Invalidate existing stamps by advancing the generation.
+        entry.groups.clear();
+        ++mRevision;
+        if ( ++entry.generation == 0 )
+        {
+            entry.groupStamps.assign( entry.groupStamps.size(), 0 );
+            entry.generation = 1;
+        
+        } // End if wrapped
+        return;
+
+    } // Next context
 }
 
 //-----------------------------------------------------------------------------
-//  Name : getVisibleObjects ()
+//  Name : isGroupVisible ()
+/// <summary>
+/// Determine if the specified data group (associated with a given context
+/// object) is contained in this visibility set.
+/// </summary>
+//-----------------------------------------------------------------------------
+bool cgVisibilitySet::isGroupVisible( void * pContext, cgInt32 nDataGroupId ) const
+{
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        const AssociatedGroups & entry = mAssociatedGroups[i];
+        if ( entry.context != pContext )
+            continue;
+
+        // Test the stamp where possible.
+        if ( nDataGroupId < 0 )
+            return ( std::find( entry.groups.begin(), entry.groups.end(), nDataGroupId ) != entry.groups.end() );
+        else
+            return ( (size_t)nDataGroupId < entry.groupStamps.size() && entry.groupStamps[nDataGroupId] == entry.generation );
+
+    } // Next context
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleObjectArray ()
 /// <summary>
 /// Retrieve the list of visible objects.
 /// </summary>
 //-----------------------------------------------------------------------------
-cgObjectNodeList & cgVisibilitySet::getVisibleObjects()
+const cgObjectNodeArray & cgVisibilitySet::getVisibleObjectArray() const
 {
     return mObjectNodes;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : getVisibleRenderClassArray ()
+/// <summary>
+/// Retrieve the list of visible object render classes (and their associated 
+/// objects batched by material), sorted by render class identifier.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgVisibilitySet::RenderClassRangeArray & cgVisibilitySet::getVisibleRenderClassArray() const
+{
+    if ( mRenderClassesDirty )
+        buildRenderClasses();
+    return mRenderClasses;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleRenderClass ()
+/// <summary>
+/// Retrieve the visible objects (batched by material) for the specified
+/// render class, or CG_NULL if no objects with that class are visible.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgVisibilitySet::RenderClassRange * cgVisibilitySet::getVisibleRenderClass( cgUInt32 renderClassId ) const
+{
+    const RenderClassRangeArray & renderClasses = getVisibleRenderClassArray();
+
+    // Binary search the sorted class list.
+    size_t low = 0, high = renderClasses.size();
+    while ( low < high )
+    {
+        size_t middle = (low + high) / 2;
+        if ( renderClasses[middle].renderClassId < renderClassId )
+            low = middle + 1;
+        else
+            high = middle;
+    
+    } // Next iteration
+    if ( low < renderClasses.size() && renderClasses[low].renderClassId == renderClassId )
+        return &renderClasses[low];
+    return CG_NULL;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleLightArray ()
+/// <summary>
+/// Retrieve the list of visible lights.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgObjectNodeArray & cgVisibilitySet::getVisibleLightArray() const
+{
+    return mLights;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleLeafArray ()
+/// <summary>
+/// Retrieve the list of visible leaves associated with the specified
+/// spatial tree.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgSceneLeafArray & cgVisibilitySet::getVisibleLeafArray( cgSpatialTreeInstance * pTree ) const
+{
+    static const cgSceneLeafArray emptyArray;
+    for ( size_t i = 0; i < mTreeLeaves.size(); ++i )
+    {
+        if ( mTreeLeaves[i].tree == pTree )
+            return mTreeLeaves[i].leaves;
+    
+    } // Next tree
+    return emptyArray;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleGroupArray ()
+/// <summary>
+/// Retrieve the list of visible data groups associated with the specified
+/// context.
+/// </summary>
+//-----------------------------------------------------------------------------
+const cgInt32Array & cgVisibilitySet::getVisibleGroupArray( void * pContext ) const
+{
+    static const cgInt32Array emptyArray;
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        if ( mAssociatedGroups[i].context == pContext )
+            return mAssociatedGroups[i].groups;
+    
+    } // Next context
+    return emptyArray;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : getVisibleObjects ()
+/// <summary>
+/// Retrieve the list of visible objects. Note: This is a copy of the visible
+/// object array that is rebuilt on demand whenever the set has changed since
+/// it was last requested; modifications made to it are not reflected in the
+/// set. Prefer getVisibleObjectArray() in performance sensitive code.
+/// </summary>
+//-----------------------------------------------------------------------------
+cgObjectNodeList & cgVisibilitySet::getVisibleObjects()
+{
+    if ( mLegacyObjectsRevision != mRevision )
+        buildLegacyObjects();
+    return mLegacyObjects;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : getVisibleObjects () (const overload)
 /// <summary>
@@ -455,19 +997,25 @@ cgObjectNodeList & cgVisibilitySet::getVisibleObjects()
 //-----------------------------------------------------------------------------
 const cgObjectNodeList & cgVisibilitySet::getVisibleObjects() const
 {
-    return mObjectNodes;
+    if ( mLegacyObjectsRevision != mRevision )
+        buildLegacyObjects();
+    return mLegacyObjects;
 }
 
 //-----------------------------------------------------------------------------
 //  Name : getVisibleRenderClasses ()
 /// <summary>
 /// Retrieve the list of visible object render classes (and their associated 
-/// objects batched by material).
+/// objects batched by material). Note: This is a copy rebuilt on demand from
+/// the render class ranges; prefer getVisibleRenderClassArray() in 
+/// performance sensitive code.
 /// </summary>
 //-----------------------------------------------------------------------------
 cgVisibilitySet::RenderClassMap & cgVisibilitySet::getVisibleRenderClasses()
 {
-    return mRenderClasses;
+    if ( mLegacyRenderClassesRevision != mRevision )
+        buildLegacyRenderClasses();
+    return mLegacyRenderClasses;
 }
 
 //-----------------------------------------------------------------------------
@@ -479,18 +1027,23 @@ cgVisibilitySet::RenderClassMap & cgVisibilitySet::getVisibleRenderClasses()
 //-----------------------------------------------------------------------------
 const cgVisibilitySet::RenderClassMap & cgVisibilitySet::getVisibleRenderClasses() const
 {
-    return mRenderClasses;
+    if ( mLegacyRenderClassesRevision != mRevision )
+        buildLegacyRenderClasses();
+    return mLegacyRenderClasses;
 }
 
 //-----------------------------------------------------------------------------
 //  Name : getVisibleLights ()
 /// <summary>
-/// Retrieve the list of visible lights.
+/// Retrieve the list of visible lights. Note: This is a copy rebuilt on 
+/// demand; prefer getVisibleLightArray() in performance sensitive code.
 /// </summary>
 //-----------------------------------------------------------------------------
 cgObjectNodeList & cgVisibilitySet::getVisibleLights()
 {
-    return mLights;
+    if ( mLegacyLightsRevision != mRevision )
+        buildLegacyLights();
+    return mLegacyLights;
 }
 
 //-----------------------------------------------------------------------------
@@ -501,19 +1054,24 @@ cgObjectNodeList & cgVisibilitySet::getVisibleLights()
 //-----------------------------------------------------------------------------
 const cgObjectNodeList & cgVisibilitySet::getVisibleLights() const
 {
-    return mLights;
+    if ( mLegacyLightsRevision != mRevision )
+        buildLegacyLights();
+    return mLegacyLights;
 }
 
 //-----------------------------------------------------------------------------
 //  Name : getVisibleLeaves ()
 /// <summary>
 /// Retrieve the list of visible leaves associated with the specified
-/// spatial tree.
+/// spatial tree. Note: This is a copy rebuilt on demand; prefer
+/// getVisibleLeafArray() in performance sensitive code.
 /// </summary>
 //-----------------------------------------------------------------------------
 cgSceneLeafSet & cgVisibilitySet::getVisibleLeaves( cgSpatialTreeInstance * pTree )
 {
-    return mTreeLeaves[pTree];
+    if ( mLegacyLeavesRevision != mRevision )
+        buildLegacyLeaves();
+    return mLegacyLeaves[pTree];
 }
 
 //-----------------------------------------------------------------------------
@@ -526,8 +1084,10 @@ cgSceneLeafSet & cgVisibilitySet::getVisibleLeaves( cgSpatialTreeInstance * pTre
 const cgSceneLeafSet & cgVisibilitySet::getVisibleLeaves( cgSpatialTreeInstance * pTree ) const
 {
     static cgSceneLeafSet emptySet;
-    TreeLeafMap::const_iterator itLeaf = mTreeLeaves.find( pTree );
-    if ( itLeaf == mTreeLeaves.end() )
+    if ( mLegacyLeavesRevision != mRevision )
+        buildLegacyLeaves();
+    TreeLeafMap::const_iterator itLeaf = mLegacyLeaves.find( pTree );
+    if ( itLeaf == mLegacyLeaves.end() )
         return emptySet;
     return itLeaf->second;
 }
@@ -536,12 +1096,15 @@ const cgSceneLeafSet & cgVisibilitySet::getVisibleLeaves( cgSpatialTreeInstance
 //  Name : getVisibleGroups ()
 /// <summary>
 /// Retrieve the list of visible data groups associated with the specified
-/// context.
+/// context. Note: This is a copy rebuilt on demand; prefer
+/// getVisibleGroupArray() in performance sensitive code.
 /// </summary>
 //-----------------------------------------------------------------------------
 cgInt32Set & cgVisibilitySet::getVisibleGroups( void * pContext )
 {
-    return mAssociatedGroups[pContext];
+    if ( mLegacyGroupsRevision != mRevision )
+        buildLegacyGroups();
+    return mLegacyGroups[pContext];
 }
 
 //-----------------------------------------------------------------------------
@@ -554,12 +1117,120 @@ cgInt32Set & cgVisibilitySet::getVisibleGroups( void * pContext )
 const cgInt32Set & cgVisibilitySet::getVisibleGroups( void * pContext ) const
 {
     static cgInt32Set emptySet;
-    AssociatedGroupMap::const_iterator itGroupList = mAssociatedGroups.find( pContext );
-    if ( itGroupList == mAssociatedGroups.end() )
+    if ( mLegacyGroupsRevision != mRevision )
+        buildLegacyGroups();
+    AssociatedGroupMap::const_iterator itGroupList = mLegacyGroups.find( pContext );
+    if ( itGroupList == mLegacyGroups.end() )
         return emptySet;
     return itGroupList->second;
 }
 
+//-----------------------------------------------------------------------------
+//  Name : buildLegacyObjects () (Private)
+/// <summary>
+/// Rebuild the compatibility copy of the visible object list.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildLegacyObjects( ) const
+{
+    mLegacyObjects.assign( mObjectNodes.begin(), mObjectNodes.end() );
+    mLegacyObjectsRevision = mRevision;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildLegacyLights () (Private)
+/// <summary>
+/// Rebuild the compatibility copy of the visible light list.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildLegacyLights( ) const
+{
+    mLegacyLights.assign( mLights.begin(), mLights.end() );
+    mLegacyLightsRevision = mRevision;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildLegacyLeaves () (Private)
+/// <summary>
+/// Rebuild the compatibility copy of the visible leaf sets.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildLegacyLeaves( ) const
+{
+    mLegacyLeaves.clear();
+    for ( size_t i = 0; i < mTreeLeaves.size(); ++i )
+    {
+        const TreeLeaves & entry = mTreeLeaves[i];
+        if ( entry.leaves.empty() )
+            continue;
+        mLegacyLeaves[entry.tree].insert( entry.leaves.begin(), entry.leaves.end() );
+    
+    } // Next tree
+    mLegacyLeavesRevision = mRevision;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildLegacyGroups () (Private)
+/// <summary>
+/// Rebuild the compatibility copy of the visible data group sets.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildLegacyGroups( ) const
+{
+    mLegacyGroups.clear();
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        const AssociatedGroups & entry = mAssociatedGroups[i];
+        if ( entry.groups.empty() )
+            continue;
+        mLegacyGroups[entry.context].insert( entry.groups.begin(), entry.groups.end() );
+    
+    } // Next context
+    mLegacyGroupsRevision = mRevision;
+}
+
+//-----------------------------------------------------------------------------
+//  Name : buildLegacyRenderClasses () (Private)
+/// <summary>
+/// Rebuild the compatibility copy of the visible render class map from the
+/// flat render class ranges.
+/// </summary>
+//-----------------------------------------------------------------------------
+void cgVisibilitySet::buildLegacyRenderClasses( ) const
+{
+    mLegacyRenderClasses.clear();
+    const RenderClassRangeArray & renderClasses = getVisibleRenderClassArray();
+    for ( size_t i = 0; i < renderClasses.size(); ++i )
+    {
+        const RenderClassRange & range = renderClasses[i];
+        RenderClass & renderClass = mLegacyRenderClasses[range.renderClassId];
+        renderClass.combinedBounds = range.combinedBounds;
+        for ( cgUInt32 j = 0; j < range.objectCount; ++j )
+        {
+            cgObjectNode * node = range.objectNodes[j];
+            renderClass.objectNodeLUT[node] = renderClass.objectNodes.insert( renderClass.objectNodes.end(), node );
+        
+        } // Next object
+
+        // Populate material batches.
+        for ( cgUInt32 j = 0; j < range.materialCount; ++j )
+        {
+            const MaterialRange & materialRange = range.materials[j];
+            MaterialBatch & batch = renderClass.materials[materialRange.material];
+            batch.combinedBounds = materialRange.combinedBounds;
+            for ( cgUInt32 k = 0; k < materialRange.objectCount; ++k )
+            {
+                cgObjectNode * node = materialRange.objectNodes[k];
+                batch.objectNodeLUT[node] = batch.objectNodes.insert( batch.objectNodes.end(), node );
+            
+            } // Next object
+
+        } // Next material
+    
+    } // Next render class
+    mLegacyRenderClassesRevision = mRevision;
+}
+
 //-----------------------------------------------------------------------------
 //  Name : getVolume ()
 /// <summary>
@@ -590,9 +1261,21 @@ const cgFrustum & cgVisibilitySet::getVolume( ) const
 //-----------------------------------------------------------------------------
 bool cgVisibilitySet::isEmpty( ) const
 {
-    return ( mObjectNodes.empty() && mLights.empty() 
-             && mTreeLeaves.empty() && mAssociatedGroups.empty() 
-             && mRenderClasses.empty() );
+    if ( !mObjectNodes.empty() || !mLights.empty() )
+        return false;
+    for ( size_t i = 0; i < mTreeLeaves.size(); ++i )
+    {
+        if ( !mTreeLeaves[i].leaves.empty() )
+            return false;
+    
+    } // Next tree
+    for ( size_t i = 0; i < mAssociatedGroups.size(); ++i )
+    {
+        if ( !mAssociatedGroups[i].groups.empty() )
+            return false;
+    
+    } // Next context
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -603,7 +1286,7 @@ bool cgVisibilitySet::isEmpty( ) const
 //-----------------------------------------------------------------------------
 bool cgVisibilitySet::isObjectVisible( cgObjectNode * object ) const
 {
-    return (mObjectNodeLUT.find( object ) != mObjectNodeLUT.end());
+    return isMember( mObjectMembership, mObjectNodes, object, mGeneration );
 }
 
 //-----------------------------------------------------------------------------
@@ -614,7 +1297,7 @@ bool cgVisibilitySet::isObjectVisible( cgObjectNode * object ) const
 //-----------------------------------------------------------------------------
 bool cgVisibilitySet::isLightVisible( cgObjectNode * light ) const
 {
-    return (mLightLUT.find( light ) != mLightLUT.end());
+    return isMember( mLightMembership, mLights, light, mGeneration );
 }
 
 //-----------------------------------------------------------------------------
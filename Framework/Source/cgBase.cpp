@@ -56,6 +56,7 @@
 #include <System/cgTimer.h>
 #include <System/cgProfiler.h>
 #include <System/cgThreading.h>
+#include <System/cgJobSystem.h>
 
 // Object types
 #include <World/Objects/cgParticleEmitterObject.h>
@@ -252,6 +253,10 @@ bool cgEngineInit( const CGEConfig & Config, cgLogOutput * pOutput /* = CG_NULL
     // Write debug info
     cgAppLog::write( cgAppLog::Info, _T("cgEngineInit()\n") );
 
+    // Start the job system worker threads.
+    if ( !cgJobSystem::initialize( EngineConfig.workerThreads ) )
+        cgAppLog::write( cgAppLog::Warning, _T("Failed to start job system worker threads. Jobs will be executed on the calling thread.\n") );
+
     // Create application singletons
     cgTimer::createSingleton();
     cgProfiler::createSingleton();
@@ -350,6 +355,9 @@ void cgEngineCleanup()
     cgScriptEngine    * pScriptEngine    = cgScriptEngine::getInstance();
     cgAppStateManager * pAppStates       = cgAppStateManager::getInstance();
 
+    // Stop the job system worker threads (outstanding jobs are completed first).
+    cgJobSystem::shutdown( );
+
     // Shutdown any pooled threads (trigger their completion events)
     cgThreadPool::shutdown( true );
 
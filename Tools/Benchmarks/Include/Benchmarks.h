@@ -0,0 +1,68 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : Benchmarks.h                                                       //
+//                                                                           //
+// Desc : Common declarations shared by the engine micro-benchmarks. Each    //
+//        benchmark times an optimized engine path against a reference       //
+//        implementation of the original algorithm and validates that both  //
+//        produce the same results.                                          //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+#pragma once
+#if !defined( _BENCHMARKS_H_ )
+#define _BENCHMARKS_H_
+
+//-----------------------------------------------------------------------------
+// Benchmarks Header Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+
+//-----------------------------------------------------------------------------
+// Global Typedefs
+//-----------------------------------------------------------------------------
+// Returns false if the optimized path disagreed with the reference.
+typedef bool (*BenchmarkFunc)( );
+
+//-----------------------------------------------------------------------------
+// Global Structures
+//-----------------------------------------------------------------------------
+struct BenchmarkDesc
+{
+    const cgTChar * name;
+    BenchmarkFunc   function;
+    const cgTChar * description;
+};
+
+//-----------------------------------------------------------------------------
+// Global Functions
+//-----------------------------------------------------------------------------
+// Utilities (Main.cpp)
+cgDouble    getBenchmarkTime    ( );
+void        seedBenchmarkRandom ( cgUInt32 seed );
+cgFloat     benchmarkRandom     ( cgFloat minimum, cgFloat maximum );
+void        reportBenchmark     ( const cgTChar * label, cgDouble seconds, cgDouble items, const cgTChar * unit );
+void        reportSpeedup       ( const cgTChar * label, cgDouble referenceSeconds, cgDouble optimizedSeconds );
+
+// Benchmarks
+bool        benchmarkMath       ( );
+bool        benchmarkPicking    ( );
+bool        benchmarkSphereTree ( );
+bool        benchmarkLandscapeRay( );
+bool        benchmarkParticles  ( );
+bool        benchmarkSpline     ( );
+bool        benchmarkBillboardSort( );
+bool        benchmarkAnimationBinding( );
+bool        benchmarkAnimationSampling( );
+
+#endif // !_BENCHMARKS_H_
@@ -0,0 +1,385 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchAnimationBinding.cpp                                          //
+//                                                                           //
+// Desc : Measures the per-frame cost of cgAnimationController::advanceTime()//
+//        for a crowd of actors blending two animation sets. Targets bound   //
+//        to integer slots are compared against the original update, which   //
+//        looked up every animated target by identifier each frame, and the  //
+//        resulting transforms are validated against it. The one-off cost of //
+//        resolving the bindings is reported separately.                     //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchAnimationBinding Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <Animation/cgAnimationController.h>
+#include <Animation/cgAnimationTarget.h>
+#include <Resources/cgAnimationSet.h>
+#include <Resources/cgResourceManager.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  BoneCount       = 60;
+    const cgInt32   KeyCount        = 60;       // Keys per channel (one per frame).
+    const cgFloat   FrameRate       = 30.0f;
+    const cgUInt32  ActorCount      = 256;
+    const cgUInt32  FrameCount      = 60;
+    const cgDouble  TimeStep        = 1.0 / 60.0;
+    const cgFloat   MatrixTolerance = 1e-5f;
+
+    //-------------------------------------------------------------------------
+    // Name : BenchTarget (Class)
+    // Desc : Animation target that simply records the last transform applied.
+    //-------------------------------------------------------------------------
+    class BenchTarget : public cgAnimationTarget
+    {
+    public:
+        BenchTarget( ) :
+            cgAnimationTarget( cgReferenceManager::generateInternalRefId() ) {}
+
+        virtual void onAnimationTransformUpdated( const cgTransform & t )
+        {
+            transform = t;
+        }
+        virtual void getAnimationTransform( cgTransform & t ) const
+        {
+            t = transform;
+        }
+
+        cgTransform transform;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : ReferenceController (Class)
+    // Desc : Reproduces the original update, in which the animated target
+    //        identifiers were collected when sets were applied and every
+    //        target was then looked up by identifier (in both the supplied
+    //        target map and each animation set) during every update.
+    //-------------------------------------------------------------------------
+    class ReferenceController : public cgAnimationController
+    {
+    public:
+        // Collect the identifiers of all targets animated by the applied sets.
+        void collectTargetIds( )
+        {
+            mValidTargetIds.clear();
+            for ( size_t i = 0; i < mTracks.size(); ++i )
+            {
+                cgAnimationSet * set = mTracks[i].set.getResource( true );
+                if ( !set )
+                    continue;
+                const cgAnimationSet::TargetDataMap & data = set->getTargetData();
+                cgAnimationSet::TargetDataMap::const_iterator itTarget;
+                for ( itTarget = data.begin(); itTarget != data.end(); ++itTarget )
+                    mValidTargetIds.insert( itTarget->first );
+
+            } // Next track
+        }
+
+        // Original 'advanceTime()' and 'updateTargets()'.
+        void advanceReference( cgDouble timeDelta, const TargetMap & targets )
+        {
+            mPosition += timeDelta;
+            for ( size_t i = 0; i < mTracks.size(); ++i )
+            {
+                if ( mTracks[i].set.isValid() && mTracks[i].desc.enabled )
+                    mTracks[i].desc.position += timeDelta * mTracks[i].desc.speed;
+
+            } // Next track
+
+            struct AnimationData
+            {
+                cgVector3 scale, translation;
+                cgQuaternion rotation;
+            };
+            cgArray<AnimationData> trackTransforms( mTracks.size() );
+            cgArray<cgFloat> trackWeights( mTracks.size(), 0.0f );
+            for ( cgStringSet::iterator itTargetId = mValidTargetIds.begin(); itTargetId != mValidTargetIds.end(); ++itTargetId )
+            {
+                TargetMap::const_iterator itTarget = targets.find( *itTargetId );
+                if ( itTarget == targets.end() )
+                    continue;
+                cgAnimationTarget * target = itTarget->second;
+
+                // Sample each track.
+                cgFloat weightTheta = 0.0f;
+                for ( size_t i = 0; i < mTracks.size(); ++i )
+                {
+                    Track & item = mTracks[i];
+                    trackWeights[i] = 0.0f;
+                    if ( !item.desc.enabled || !item.desc.weight || !item.set.isValid() )
+                        continue;
+                    AnimationData & data = trackTransforms[i];
+                    cgAnimationSet * set = item.set.getResource( true );
+                    if ( set->getSRT( item.desc.position * (cgDouble)set->getFrameRate(), item.desc.playbackMode, *itTargetId,
+                                      item.desc.firstFrame, item.desc.lastFrame, target, data.scale, data.rotation, data.translation ) )
+                    {
+                        weightTheta    += item.desc.weight;
+                        trackWeights[i] = item.desc.weight;
+
+                    } // End if sampled
+
+                } // Next track
+                if ( weightTheta <= CGE_EPSILON )
+                    continue;
+
+                // Blend.
+                weightTheta = 1.0f / weightTheta;
+                cgVector3 scale( 0, 0, 0 ), translation( 0, 0, 0 );
+                cgQuaternion rotation( 0, 0, 0, 0 );
+                bool firstRotation = true;
+                for ( size_t i = 0; i < mTracks.size(); ++i )
+                {
+                    const cgFloat weight = trackWeights[i];
+                    if ( weight <= CGE_EPSILON )
+                        continue;
+                    if ( firstRotation )
+                        rotation = trackTransforms[i].rotation;
+                    else
+                        cgQuaternion::slerp( rotation, rotation, trackTransforms[i].rotation, (weight * weightTheta) );
+                    firstRotation = false;
+                    translation += trackTransforms[i].translation * (weight * weightTheta);
+                    scale += trackTransforms[i].scale * (weight * weightTheta);
+
+                } // Next track
+                cgTransform t;
+                t.compose( scale, cgVector3( 0, 0, 0 ), rotation, translation );
+                target->onAnimationTransformUpdated( t );
+
+            } // Next target
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : Actor (Struct)
+    // Desc : A pair of identically configured controllers, one updated with
+    //        the original method and one through 'advanceTime()', each with
+    //        its own set of targets.
+    //-------------------------------------------------------------------------
+    struct Actor
+    {
+        ReferenceController                 reference;
+        cgAnimationController               bound;
+        cgAnimationController::TargetMap    referenceTargets;
+        cgAnimationController::TargetMap    boundTargets;
+    };
+    CGE_ARRAY_DECLARE(Actor*, ActorArray)
+
+    //-------------------------------------------------------------------------
+    // Name : boneName ()
+    // Desc : Instance identifier of the specified bone.
+    //-------------------------------------------------------------------------
+    cgString boneName( cgUInt32 bone )
+    {
+        return cgString::format( _T("Bip01_Bone%02u"), bone );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : buildSet ()
+    // Desc : Create an animation set with a key on every frame for every
+    //        bone, and register it with the resource manager. Serialization
+    //        is suspended while keys are added so that the key stream is
+    //        built only once.
+    //-------------------------------------------------------------------------
+    void buildSet( cgAnimationSetHandle & handle, cgUInt32 variation )
+    {
+        cgAnimationSet * set = new cgAnimationSet( cgReferenceManager::generateInternalRefId(), CG_NULL, FrameRate );
+        const cgFloat phase = (cgFloat)variation * 1.3f;
+        set->suspendSerialization();
+        for ( cgUInt32 bone = 0; bone < BoneCount; ++bone )
+        {
+            const cgString id = boneName( bone );
+            const cgVector3 axis( (cgFloat)(bone % 3 == 0), (cgFloat)(bone % 3 == 1), (cgFloat)(bone % 3 == 2) );
+            for ( cgInt32 key = 0; key < KeyCount; ++key )
+            {
+                const cgFloat angle = phase + (cgFloat)key * 0.1f + (cgFloat)bone * 0.05f;
+                cgQuaternion rotation;
+                cgQuaternion::rotationAxis( rotation, axis, sinf( angle ) );
+                const cgVector3 scale( 1.0f + 0.1f * sinf( angle ), 1.0f, 1.0f + 0.1f * cosf( angle ) );
+                const cgVector3 translation( (cgFloat)bone * 0.1f, sinf( angle ) * 0.5f, cosf( angle * 0.5f ) );
+                set->addSRTKey( key, id, scale, rotation, translation );
+
+            } // Next key
+
+        } // Next bone
+        set->resumeSerialization();
+        cgResourceManager::getInstance()->addAnimationSet( &handle, set, cgResourceFlags::ForceNew, cgString::Empty, cgDebugSource() );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : createActor ()
+    // Desc : Build an actor with both controllers playing the two sets at
+    //        the same randomized positions and speeds.
+    //-------------------------------------------------------------------------
+    Actor * createActor( const cgAnimationSetHandle * sets )
+    {
+        Actor * actor = new Actor();
+        for ( cgUInt32 bone = 0; bone < BoneCount; ++bone )
+        {
+            actor->referenceTargets[ boneName( bone ) ] = new BenchTarget();
+            actor->boundTargets[ boneName( bone ) ] = new BenchTarget();
+
+        } // Next bone
+
+        const cgFloat speed = benchmarkRandom( 0.8f, 1.2f );
+        const cgDouble position = benchmarkRandom( 0, 2.0f );
+        cgAnimationController * controllers[2] = { &actor->reference, &actor->bound };
+        for ( cgUInt32 i = 0; i < 2; ++i )
+        {
+            cgAnimationController * controller = controllers[i];
+            controller->setTrackLimit( 2 );
+            for ( cgUInt16 track = 0; track < 2; ++track )
+            {
+                controller->setTrackAnimationSet( track, sets[track] );
+                controller->setTrackWeight( track, (track == 0) ? 0.7f : 0.3f );
+                controller->setTrackSpeed( track, (track == 0) ? speed : speed * 1.1f );
+                controller->setTrackPosition( track, position );
+
+            } // Next track
+
+        } // Next controller
+        actor->reference.collectTargetIds();
+        return actor;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : destroyActor ()
+    // Desc : Release an actor and its targets.
+    //-------------------------------------------------------------------------
+    void destroyActor( Actor * actor )
+    {
+        cgAnimationController::TargetMap::iterator itTarget;
+        for ( itTarget = actor->referenceTargets.begin(); itTarget != actor->referenceTargets.end(); ++itTarget )
+            itTarget->second->scriptSafeDispose();
+        for ( itTarget = actor->boundTargets.begin(); itTarget != actor->boundTargets.end(); ++itTarget )
+            itTarget->second->scriptSafeDispose();
+        delete actor;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : compareTargets ()
+    // Desc : Count the targets whose transforms differ between the two
+    //        controllers of an actor.
+    //-------------------------------------------------------------------------
+    cgUInt32 compareTargets( const Actor & actor )
+    {
+        cgUInt32 errors = 0;
+        cgAnimationController::TargetMap::const_iterator itReference, itBound;
+        for ( itReference = actor.referenceTargets.begin(); itReference != actor.referenceTargets.end(); ++itReference )
+        {
+            itBound = actor.boundTargets.find( itReference->first );
+            const cgMatrix & a = ((BenchTarget*)itReference->second)->transform;
+            const cgMatrix & b = ((BenchTarget*)itBound->second)->transform;
+            const cgFloat * pa = &a._11, * pb = &b._11;
+            for ( cgUInt32 i = 0; i < 16; ++i )
+            {
+                if ( fabsf( pa[i] - pb[i] ) > MatrixTolerance )
+                {
+                    ++errors;
+                    break;
+
+                } // End if differs
+
+            } // Next element
+
+        } // Next target
+        return errors;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkAnimationBinding ()
+// Desc : Animation target binding benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkAnimationBinding( )
+{
+    _tprintf( _T("   Actors: %u, %u bones, 2 blended tracks of %d keys\n"), ActorCount, BoneCount, KeyCount );
+
+    // Build the shared animation sets and the actors.
+    cgAnimationSetHandle sets[2];
+    buildSet( sets[0], 0 );
+    buildSet( sets[1], 1 );
+    ActorArray actors( ActorCount );
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+        actors[i] = createActor( sets );
+
+    // Original update, identifier lookups on every frame.
+    cgDouble start = getBenchmarkTime();
+    for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+    {
+        for ( cgUInt32 i = 0; i < ActorCount; ++i )
+            actors[i]->reference.advanceReference( TimeStep, actors[i]->referenceTargets );
+
+    } // Next frame
+    const cgDouble referenceTime = getBenchmarkTime() - start;
+
+    // Resolve bindings for every actor (performed automatically by the
+    // first update).
+    start = getBenchmarkTime();
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+        actors[i]->bound.advanceTime( 0, actors[i]->boundTargets );
+    const cgDouble bindTime = getBenchmarkTime() - start;
+
+    // Bound update.
+    start = getBenchmarkTime();
+    for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+    {
+        for ( cgUInt32 i = 0; i < ActorCount; ++i )
+            actors[i]->bound.advanceTime( TimeStep, actors[i]->boundTargets );
+
+    } // Next frame
+    const cgDouble boundTime = getBenchmarkTime() - start;
+
+    // Both controllers have now reached the same position.
+    cgUInt32 errors = 0;
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+        errors += compareTargets( *actors[i] );
+
+    // Bindings are resolved again after the target map is invalidated.
+    start = getBenchmarkTime();
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+    {
+        actors[i]->bound.invalidateTargets();
+        actors[i]->bound.advanceTime( 0, actors[i]->boundTargets );
+
+    } // Next actor
+    const cgDouble rebindTime = getBenchmarkTime() - start;
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+        errors += compareTargets( *actors[i] );
+
+    const cgDouble updates = (cgDouble)ActorCount * FrameCount;
+    reportBenchmark( _T("Lookup by identifier (original)"), referenceTime, updates, _T("actor") );
+    reportBenchmark( _T("advanceTime(), bound slots"), boundTime, updates, _T("actor") );
+    reportBenchmark( _T("First update, binding resolved"), bindTime, ActorCount, _T("actor") );
+    reportBenchmark( _T("Update after invalidateTargets()"), rebindTime, ActorCount, _T("actor") );
+    reportSpeedup( _T("Speedup"), referenceTime, boundTime );
+    _tprintf( _T("   Targets differing from original: %u\n"), errors );
+
+    // Clean up.
+    for ( cgUInt32 i = 0; i < ActorCount; ++i )
+        destroyActor( actors[i] );
+    sets[0].close();
+    sets[1].close();
+    return ( errors == 0 );
+}
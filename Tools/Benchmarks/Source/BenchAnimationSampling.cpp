@@ -0,0 +1,269 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchAnimationSampling.cpp                                         //
+//                                                                           //
+// Desc : Measures the cost of sampling thousands of playing instances of a  //
+//        small number of shared animation sets, searching for the keys of   //
+//        every channel on each sample (the original behavior) against       //
+//        advancing per-instance key cursors through each set's key stream.  //
+//        Cursor sampling is also run from the job system worker threads     //
+//        against the shared sets, straight after they were built, and is    //
+//        validated against serial searching on every frame.                 //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchAnimationSampling Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <Resources/cgAnimationSet.h>
+#include <Resources/cgResourceManager.h>
+#include <System/cgJobSystem.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  SetCount        = 16;
+    const cgUInt32  BoneCount       = 40;
+    const cgInt32   KeyCount        = 300;      // Keys per channel (one per frame).
+    const cgFloat   FrameRate       = 30.0f;
+    const cgUInt32  InstanceCount   = 2048;
+    const cgUInt32  InstanceGrain   = 16;       // Instances per job system task.
+    const cgUInt32  FrameCount      = 10;
+    const cgDouble  TimeStep        = 1.0 / 60.0;
+
+    //-------------------------------------------------------------------------
+    // Name : Instance (Struct)
+    // Desc : A single playing instance of one of the shared animation sets.
+    //-------------------------------------------------------------------------
+    struct Instance
+    {
+        cgAnimationSet                * set;
+        cgDouble                        position;   // Playhead position in seconds.
+        cgDouble                        speed;
+        cgAnimationSet::SampleCursor    cursor;
+    };
+    CGE_ARRAY_DECLARE(Instance, InstanceArray)
+    CGE_ARRAY_DECLARE(cgVector3, VectorArray)
+    CGE_ARRAY_DECLARE(cgQuaternion, QuaternionArray)
+
+    //-------------------------------------------------------------------------
+    // Name : Pose (Struct)
+    // Desc : Sampled output for every instance, 'BoneCount' entries each,
+    //        indexed by 'cgAnimationSet::TargetData::index'.
+    //-------------------------------------------------------------------------
+    struct Pose
+    {
+        VectorArray     scale;
+        QuaternionArray rotation;
+        VectorArray     translation;
+
+        Pose( ) :
+            scale( InstanceCount * BoneCount ), rotation( InstanceCount * BoneCount ),
+            translation( InstanceCount * BoneCount ) {}
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : SampleData (Struct)
+    // Desc : Context for a single frame of sampling.
+    //-------------------------------------------------------------------------
+    struct SampleData
+    {
+        Instance  * instances;
+        Pose      * pose;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : buildSet ()
+    // Desc : Create an animation set with a key on every frame for every
+    //        bone. Serialization is suspended while keys are added so that
+    //        the key stream is built only once.
+    //-------------------------------------------------------------------------
+    void buildSet( cgAnimationSetHandle & handle, cgUInt32 variation )
+    {
+        cgAnimationSet * set = new cgAnimationSet( cgReferenceManager::generateInternalRefId(), CG_NULL, FrameRate );
+        const cgFloat phase = (cgFloat)variation * 0.7f;
+        set->suspendSerialization();
+        for ( cgUInt32 bone = 0; bone < BoneCount; ++bone )
+        {
+            const cgString id = cgString::format( _T("Bip01_Bone%02u"), bone );
+            const cgVector3 axis( (cgFloat)(bone % 3 == 0), (cgFloat)(bone % 3 == 1), (cgFloat)(bone % 3 == 2) );
+            for ( cgInt32 key = 0; key < KeyCount; ++key )
+            {
+                const cgFloat angle = phase + (cgFloat)key * 0.1f + (cgFloat)bone * 0.05f;
+                cgQuaternion rotation;
+                cgQuaternion::rotationAxis( rotation, axis, sinf( angle ) );
+                const cgVector3 scale( 1.0f + 0.1f * sinf( angle ), 1.0f, 1.0f + 0.1f * cosf( angle ) );
+                const cgVector3 translation( benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ) );
+                set->addSRTKey( key, id, scale, rotation, translation );
+
+            } // Next key
+
+        } // Next bone
+        set->resumeSerialization();
+        cgResourceManager::getInstance()->addAnimationSet( &handle, set, cgResourceFlags::ForceNew, cgString::Empty, cgDebugSource() );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : executeSearch ()
+    // Desc : Advance and sample a range of instances, searching for the keys
+    //        of every channel (no cursors).
+    //-------------------------------------------------------------------------
+    void executeSearch( cgUInt32 first, cgUInt32 last, void * context )
+    {
+        SampleData * data = (SampleData*)context;
+        for ( cgUInt32 i = first; i < last; ++i )
+        {
+            Instance & instance = data->instances[i];
+            instance.position += TimeStep * instance.speed;
+            const cgDouble framePosition = instance.position * (cgDouble)FrameRate;
+            const cgAnimationSet::TargetDataMap & targets = instance.set->getTargetData();
+            cgAnimationSet::TargetDataMap::const_iterator itTarget;
+            for ( itTarget = targets.begin(); itTarget != targets.end(); ++itTarget )
+            {
+                const cgUInt32 index = i * BoneCount + itTarget->second.index;
+                instance.set->getSRT( framePosition, cgAnimationPlaybackMode::Loop, itTarget->second, 0x7FFFFFFF, 0x7FFFFFFF, CG_NULL,
+                                      data->pose->scale[index], data->pose->rotation[index], data->pose->translation[index] );
+
+            } // Next target
+
+        } // Next instance
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : executeCursor ()
+    // Desc : Advance and sample a range of instances through their cursors.
+    //-------------------------------------------------------------------------
+    void executeCursor( cgUInt32 first, cgUInt32 last, void * context )
+    {
+        SampleData * data = (SampleData*)context;
+        for ( cgUInt32 i = first; i < last; ++i )
+        {
+            Instance & instance = data->instances[i];
+            instance.position += TimeStep * instance.speed;
+            const cgUInt32 index = i * BoneCount;
+            instance.set->evaluate( instance.position * (cgDouble)FrameRate, cgAnimationPlaybackMode::Loop, 0x7FFFFFFF, 0x7FFFFFFF, instance.cursor,
+                                    &data->pose->scale[index], &data->pose->rotation[index], &data->pose->translation[index] );
+
+        } // Next instance
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runFrames ()
+    // Desc : Sample every instance for a number of frames, serially or on
+    //        the job system, returning the total time taken.
+    //-------------------------------------------------------------------------
+    cgDouble runFrames( InstanceArray instances, cgParallelForFunc function, bool parallel, Pose & pose )
+    {
+        SampleData data;
+        data.instances = &instances[0];
+        data.pose      = &pose;
+        const cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+        {
+            if ( parallel )
+                cgJobSystem::parallelFor( InstanceCount, InstanceGrain, function, &data );
+            else
+                function( 0, InstanceCount, &data );
+
+        } // Next frame
+        return getBenchmarkTime() - start;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : comparePoses ()
+    // Desc : Count the samples that differ between two poses.
+    //-------------------------------------------------------------------------
+    cgUInt32 comparePoses( const Pose & a, const Pose & b )
+    {
+        cgUInt32 errors = 0;
+        for ( cgUInt32 i = 0; i < InstanceCount * BoneCount; ++i )
+        {
+            const cgQuaternion & qa = a.rotation[i], & qb = b.rotation[i];
+            if ( a.scale[i] != b.scale[i] || a.translation[i] != b.translation[i] ||
+                 qa.x != qb.x || qa.y != qb.y || qa.z != qb.z || qa.w != qb.w )
+                ++errors;
+
+        } // Next sample
+        return errors;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkAnimationSampling ()
+// Desc : Concurrent animation set sampling benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkAnimationSampling( )
+{
+    _tprintf( _T("   Instances: %u of %u sets, %u bones, %d keys per channel\n"), InstanceCount, SetCount, BoneCount, KeyCount );
+
+    // Build the shared sets and start each instance at a random position
+    // (some will wrap around the end of the loop during the run).
+    cgAnimationSetHandle sets[SetCount];
+    for ( cgUInt32 i = 0; i < SetCount; ++i )
+        buildSet( sets[i], i );
+    InstanceArray instances( InstanceCount );
+    const cgFloat length = (cgFloat)(KeyCount - 1) / FrameRate;
+    for ( cgUInt32 i = 0; i < InstanceCount; ++i )
+    {
+        instances[i].set      = sets[ i % SetCount ].getResource( true );
+        instances[i].position = benchmarkRandom( 0, length );
+        instances[i].speed    = benchmarkRandom( 0.8f, 1.2f );
+
+    } // Next instance
+
+    // Time each method. The parallel run is first so that the worker
+    // threads are the first to sample the newly built sets.
+    Pose pose;
+    const cgDouble parallelTime = runFrames( instances, executeCursor, true, pose );
+    const cgDouble searchTime = runFrames( instances, executeSearch, false, pose );
+    const cgDouble cursorTime = runFrames( instances, executeCursor, false, pose );
+
+    // Validate concurrent cursor sampling against serial searching on
+    // every frame.
+    Pose reference;
+    InstanceArray searched = instances, cursors = instances;
+    SampleData searchData, cursorData;
+    searchData.instances = &searched[0];
+    searchData.pose      = &reference;
+    cursorData.instances = &cursors[0];
+    cursorData.pose      = &pose;
+    cgUInt32 errors = 0;
+    for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+    {
+        executeSearch( 0, InstanceCount, &searchData );
+        cgJobSystem::parallelFor( InstanceCount, InstanceGrain, executeCursor, &cursorData );
+        errors += comparePoses( reference, pose );
+
+    } // Next frame
+
+    const cgDouble samples = (cgDouble)InstanceCount * BoneCount * FrameCount;
+    reportBenchmark( _T("getSRT(), key search (original)"), searchTime, samples, _T("sample") );
+    reportBenchmark( _T("evaluate(), key cursors"), cursorTime, samples, _T("sample") );
+    reportBenchmark( _T("evaluate(), key cursors, job system"), parallelTime, samples, _T("sample") );
+    reportSpeedup( _T("Speedup (serial)"), searchTime, cursorTime );
+    reportSpeedup( _T("Speedup (job system)"), searchTime, parallelTime );
+    _tprintf( _T("   Samples differing from search: %u\n"), errors );
+
+    // Clean up.
+    for ( cgUInt32 i = 0; i < SetCount; ++i )
+        sets[i].close();
+    return ( errors == 0 );
+}
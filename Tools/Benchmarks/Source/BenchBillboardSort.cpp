@@ -0,0 +1,342 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchBillboardSort.cpp                                             //
+//                                                                           //
+// Desc : Measures the cost of sorting 10k, 100k and 1M billboards back to   //
+//        front. The original qsort of float depths is compared against the  //
+//        radix sort used by cgBillboardBuffer, both from scratch and when   //
+//        reusing the previous frame's order under a range of camera motion. //
+//        Every sorted list is validated against the billboards it orders.   //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchBillboardSort Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <Rendering/cgBillboardBuffer.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Name : BillboardSortProbe (Class)
+// Desc : Runs the private depth sort of a cgBillboardBuffer (which names this
+//        class as a friend) without a render driver, and checks the order
+//        it produces against the billboards it sorts.
+//-----------------------------------------------------------------------------
+class BillboardSortProbe
+{
+public:
+    // Billboards are owned by the benchmark, not the buffer.
+    ~BillboardSortProbe( )
+    {
+        mBuffer.mBillboards.clear();
+    }
+
+    void add( cgBillboard * billboard )
+    {
+        mBuffer.mBillboards.push_back( billboard );
+    }
+
+    cgInt32 sort( const cgVector3 & origin )
+    {
+        return mBuffer.sortBillboards( origin, 0, (cgInt32)mBuffer.mBillboards.size() );
+    }
+
+    // Discard the previous order, forcing the next sort to start cold.
+    void forget( )
+    {
+        mBuffer.mDepthOrderCount = 0;
+    }
+
+    // Returns the number of inconsistencies found.
+    cgUInt32 validate( const cgVector3 & origin, cgInt32 count ) const
+    {
+        const cgBillboardBuffer::BillboardArray & billboards = mBuffer.mBillboards;
+        const cgBillboardBuffer::DepthSortArray & order = mBuffer.mDepthOrder;
+        cgInt32 visible = 0;
+        for ( size_t i = 0; i < billboards.size(); ++i )
+        {
+            if ( billboards[i]->getVisible() )
+                ++visible;
+
+        } // Next billboard
+        if ( count != visible || (cgInt32)order.size() != count )
+            return 1;
+
+        // Every visible billboard must appear exactly once, furthest first.
+        cgByteArray seen( billboards.size(), 0 );
+        cgFloat previous = FLT_MAX;
+        cgUInt32 errors = 0;
+        for ( cgInt32 i = 0; i < count; ++i )
+        {
+            const cgInt32 id = order[i].billboardId;
+            if ( id < 0 || id >= (cgInt32)billboards.size() || seen[id] || !billboards[id]->getVisible() )
+            {
+                ++errors;
+                continue;
+
+            } // End if invalid
+            seen[id] = 1;
+            const cgFloat depth = cgVector3::lengthSq( billboards[id]->getPosition() - origin );
+            if ( depth > previous )
+                ++errors;
+            previous = depth;
+
+        } // Next entry
+        return errors;
+    }
+
+private:
+    cgBillboardBuffer   mBuffer;
+};
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  SizeCount       = 3;
+    const cgUInt32  BillboardCounts[SizeCount] = { 10000, 100000, 1000000 };
+    const cgUInt32  FrameCount      = 16;
+    const cgFloat   WorldExtent     = 100.0f;
+    const cgFloat   VisibleFraction = 0.9f;
+    const cgFloat   ChurnFraction   = 0.001f;   // Billboards that change visibility each frame.
+    const cgFloat   JitterFraction  = 0.01f;    // Billboards that move each frame.
+    const cgFloat   JitterDistance  = 0.05f;    // Maximum distance moved along each axis.
+
+    //-------------------------------------------------------------------------
+    // Name : Motion (Enum)
+    // Desc : Camera motion applied between frames.
+    //-------------------------------------------------------------------------
+    enum Motion
+    {
+        ColdSort = 0,   // Previous order discarded before every sort.
+        Static,
+        Drift,          // 1cm per frame.
+        Walk,           // 10cm per frame.
+        CameraCut,      // New random position every frame.
+        MotionCount
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : ReferenceDepth (Struct)
+    // Desc : Depth information sorted by the original implementation.
+    //-------------------------------------------------------------------------
+    struct ReferenceDepth
+    {
+        cgFloat depth;
+        cgInt32 billboardId;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : compareReferenceDepth ()
+    // Desc : qsort comparison used by the original implementation (furthest
+    //        billboards first).
+    //-------------------------------------------------------------------------
+    int compareReferenceDepth( const void * arg1, const void * arg2 )
+    {
+        if ( ((ReferenceDepth*)arg1)->depth > ((ReferenceDepth*)arg2)->depth )
+            return -1;
+        if ( ((ReferenceDepth*)arg1)->depth < ((ReferenceDepth*)arg2)->depth )
+            return 1;
+        return 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : sortReference ()
+    // Desc : Reproduces the original renderSorted() depth sort: allocate the
+    //        depth list, fill it from the visible billboards and qsort it.
+    //        Returns the number of billboards sorted.
+    //-------------------------------------------------------------------------
+    cgInt32 sortReference( cgBillboard3D * billboards, cgUInt32 count, const cgVector3 & origin )
+    {
+        ReferenceDepth * depthInfo = new ReferenceDepth[count];
+        cgInt32 finalCount = 0;
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            if ( !billboards[i].getVisible() )
+                continue;
+            depthInfo[finalCount].billboardId = (cgInt32)i;
+            depthInfo[finalCount].depth = cgVector3::lengthSq( billboards[i].getPosition() - origin );
+            ++finalCount;
+
+        } // Next billboard
+        qsort( depthInfo, (size_t)finalCount, sizeof(ReferenceDepth), compareReferenceDepth );
+        delete []depthInfo;
+        return finalCount;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : randomPosition ()
+    // Desc : Random position within the test world.
+    //-------------------------------------------------------------------------
+    cgVector3 randomPosition( )
+    {
+        return cgVector3( benchmarkRandom( -WorldExtent, WorldExtent ), benchmarkRandom( -WorldExtent * 0.1f, WorldExtent * 0.1f ), benchmarkRandom( -WorldExtent, WorldExtent ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : populate ()
+    // Desc : Scatter the billboards through the world, most of them visible.
+    //-------------------------------------------------------------------------
+    void populate( cgBillboard3D * billboards, cgUInt32 count )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            billboards[i].setPosition( randomPosition() );
+            billboards[i].setVisible( benchmarkRandom( 0, 1 ) < VisibleFraction );
+
+        } // Next billboard
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : advanceFrame ()
+    // Desc : Apply a frame's worth of billboard movement, visibility churn and
+    //        camera motion.
+    //-------------------------------------------------------------------------
+    void advanceFrame( cgBillboard3D * billboards, cgUInt32 count, Motion motion, cgVector3 & camera )
+    {
+        const cgUInt32 jitterCount = (cgUInt32)(count * JitterFraction);
+        for ( cgUInt32 i = 0; i < jitterCount; ++i )
+        {
+            cgBillboard3D & billboard = billboards[ (cgUInt32)benchmarkRandom( 0, (cgFloat)(count - 1) ) ];
+            const cgVector3 offset( benchmarkRandom( -JitterDistance, JitterDistance ), benchmarkRandom( -JitterDistance, JitterDistance ), benchmarkRandom( -JitterDistance, JitterDistance ) );
+            billboard.setPosition( billboard.getPosition() + offset );
+
+        } // Next moved billboard
+        const cgUInt32 churnCount = (cgUInt32)(count * ChurnFraction);
+        for ( cgUInt32 i = 0; i < churnCount; ++i )
+        {
+            cgBillboard3D & billboard = billboards[ (cgUInt32)benchmarkRandom( 0, (cgFloat)(count - 1) ) ];
+            billboard.setVisible( !billboard.getVisible() );
+
+        } // Next churned billboard
+
+        switch ( motion )
+        {
+            case Drift:
+                camera.x += 0.01f;
+                break;
+            case Walk:
+                camera.x += 0.1f;
+                break;
+            case CameraCut:
+                camera = randomPosition();
+                break;
+            default:
+                break;
+
+        } // End switch motion
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runReference ()
+    // Desc : Time the original sort over a number of frames of a static camera.
+    //-------------------------------------------------------------------------
+    cgDouble runReference( cgUInt32 count )
+    {
+        seedBenchmarkRandom( 99 );
+        cgBillboard3D * billboards = new cgBillboard3D[count];
+        populate( billboards, count );
+        cgVector3 camera( 0, 2, 0 );
+        cgDouble total = 0;
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+        {
+            advanceFrame( billboards, count, Static, camera );
+            const cgDouble start = getBenchmarkTime();
+            sortReference( billboards, count, camera );
+            total += getBenchmarkTime() - start;
+
+        } // Next frame
+        delete []billboards;
+        return total;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runSorted ()
+    // Desc : Time cgBillboardBuffer's depth sort over a number of frames with
+    //        the specified camera motion, validating every result.
+    //-------------------------------------------------------------------------
+    cgDouble runSorted( cgUInt32 count, Motion motion, cgUInt32 & errors )
+    {
+        seedBenchmarkRandom( 99 );
+        cgBillboard3D * billboards = new cgBillboard3D[count];
+        populate( billboards, count );
+        BillboardSortProbe buffer;
+        for ( cgUInt32 i = 0; i < count; ++i )
+            buffer.add( &billboards[i] );
+
+        // Establish an initial order (untimed) so that reuse starts warm.
+        cgVector3 camera( 0, 2, 0 );
+        buffer.sort( camera );
+
+        cgDouble total = 0;
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+        {
+            advanceFrame( billboards, count, motion, camera );
+            if ( motion == ColdSort )
+                buffer.forget();
+            const cgDouble start = getBenchmarkTime();
+            const cgInt32 sorted = buffer.sort( camera );
+            total += getBenchmarkTime() - start;
+            errors += buffer.validate( camera, sorted );
+
+        } // Next frame
+
+        delete []billboards;
+        return total;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkBillboardSort ()
+// Desc : Billboard depth sort benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkBillboardSort( )
+{
+    static const cgTChar * motionNames[MotionCount] =
+    {
+        _T("Radix sort, cold"),
+        _T("Reuse, static camera"),
+        _T("Reuse, 1cm drift"),
+        _T("Reuse, 10cm walk"),
+        _T("Reuse, camera cut")
+    };
+
+    cgUInt32 errors = 0;
+    for ( cgUInt32 size = 0; size < SizeCount; ++size )
+    {
+        const cgUInt32 count = BillboardCounts[size];
+        _tprintf( _T("   Billboards: %u, %.0f%% visible\n"), count, VisibleFraction * 100.0f );
+        const cgDouble referenceTime = runReference( count );
+        reportBenchmark( _T("qsort (original)"), referenceTime, FrameCount, _T("sort") );
+        cgDouble coldTime = 0;
+        for ( cgInt32 motion = 0; motion < MotionCount; ++motion )
+        {
+            const cgDouble time = runSorted( count, (Motion)motion, errors );
+            reportBenchmark( motionNames[motion], time, FrameCount, _T("sort") );
+            if ( motion == ColdSort )
+                coldTime = time;
+
+        } // Next motion
+        reportSpeedup( _T("Speedup (cold radix sort)"), referenceTime, coldTime );
+
+    } // Next size
+    _tprintf( _T("   Validation errors: %u\n"), errors );
+    return ( errors == 0 );
+}
@@ -0,0 +1,365 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchLandscapeRay.cpp                                              //
+//                                                                           //
+// Desc : Measures landscape ray intersection cost for the original per-     //
+//        block ray marcher employed by cgLandscape::getRayIntersect() and   //
+//        the min/max cgLandscapeHeightPyramid (single and batched queries). //
+//        Pyramid results are validated against an exact test of every       //
+//        terrain triangle.                                                  //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchLandscapeRay Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <World/cgLandscapeHeightPyramid.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgInt32   BlockSize       = 33;       // Vertices along each edge of a terrain block.
+    const cgUInt32  RayCount        = 4096;
+    const cgUInt32  ValidationRays  = 128;      // Exact reference is far too slow to run every ray.
+    const cgFloat   MarchAccuracy   = 1.0f;     // Default accuracy used by cgLandscape::getRayIntersect().
+
+    //-------------------------------------------------------------------------
+    // Name : TestLandscape (Struct)
+    // Desc : Heightmap and block layout shared by every intersection method.
+    //-------------------------------------------------------------------------
+    struct TestLandscape
+    {
+        cgInt32                 blocks;         // Terrain blocks along each axis.
+        cgSize                  mapSize;
+        cgArray<cgInt16>        heights;
+        cgByteArray             blockMask;
+        cgArray<cgBoundingBox>  blockBounds;
+        cgVector3               offset;
+        cgVector3               scale;
+
+        cgFloat height( cgInt32 x, cgInt32 z ) const
+        {
+            return (cgFloat)heights[ x + z * mapSize.width ] * scale.y;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : buildLandscape ()
+    // Desc : Generate a rolling heightmap with a few missing blocks.
+    //-------------------------------------------------------------------------
+    void buildLandscape( TestLandscape & land, cgInt32 blocks )
+    {
+        land.blocks  = blocks;
+        land.mapSize = cgSize( blocks * (BlockSize - 1) + 1, blocks * (BlockSize - 1) + 1 );
+        land.offset  = cgVector3( -500.0f, 0.0f, 500.0f );
+        land.scale   = cgVector3( 2.0f, 0.01f, 2.0f );
+        land.heights.resize( land.mapSize.width * land.mapSize.height );
+        for ( cgInt32 z = 0; z < land.mapSize.height; ++z )
+        {
+            for ( cgInt32 x = 0; x < land.mapSize.width; ++x )
+            {
+                const cgFloat h = 3000.0f * sinf( x * 0.05f ) * cosf( z * 0.037f ) + 800.0f * sinf( x * 0.31f + z * 0.17f ) + benchmarkRandom( -200, 200 );
+                land.heights[ x + z * land.mapSize.width ] = (cgInt16)h;
+
+            } // Next column
+
+        } // Next row
+
+        // Remove a couple of blocks and compute the bounds of the remainder
+        // in the same way as cgTerrainBlock.
+        land.blockMask.assign( blocks * blocks, 1 );
+        land.blockMask[3] = 0;
+        land.blockMask[ blocks + 4 ] = 0;
+        land.blockBounds.resize( blocks * blocks );
+        for ( cgInt32 i = 0; i < blocks * blocks; ++i )
+        {
+            const cgInt32 bx = (i % blocks) * (BlockSize - 1), bz = (i / blocks) * (BlockSize - 1);
+            cgFloat minimum = FLT_MAX, maximum = -FLT_MAX;
+            for ( cgInt32 z = bz; z < bz + BlockSize; ++z )
+            {
+                for ( cgInt32 x = bx; x < bx + BlockSize; ++x )
+                {
+                    const cgFloat h = land.height( x, z );
+                    if ( h < minimum ) minimum = h;
+                    if ( h > maximum ) maximum = h;
+
+                } // Next column
+
+            } // Next row
+            cgBoundingBox & bounds = land.blockBounds[i];
+            bounds.min = cgVector3( land.offset.x + bx * land.scale.x, minimum, land.offset.z - (bz + BlockSize - 1) * land.scale.z );
+            bounds.max = cgVector3( land.offset.x + (bx + BlockSize - 1) * land.scale.x, maximum, land.offset.z - bz * land.scale.z );
+
+        } // Next block
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : referenceHeight ()
+    // Desc : The original cgTerrainBlock::getTerrainHeight().
+    //-------------------------------------------------------------------------
+    cgFloat referenceHeight( const TestLandscape & land, cgInt32 block, cgFloat fX, cgFloat fZ )
+    {
+        fX =  (fX - land.offset.x) / land.scale.x;
+        fZ = -(fZ - land.offset.z) / land.scale.z;
+
+        // Make sure we are not out of bounds
+        const cgInt32 left = (block % land.blocks) * (BlockSize - 1), top = (block / land.blocks) * (BlockSize - 1);
+        if ( fX < left || fZ < top || fX >= left + BlockSize - 1 || fZ >= top + BlockSize - 1 )
+            return -1.0f;
+
+        const cgInt32 iX = (cgInt32)fX, iZ = (cgInt32)fZ;
+        const cgFloat fPercentX = fX - (cgFloat)iX;
+        const cgFloat fPercentZ = fZ - (cgFloat)iZ;
+        cgFloat fTopLeft = land.height( iX, iZ ), fBottomRight = land.height( iX + 1, iZ + 1 );
+        cgFloat fTopRight, fBottomLeft;
+        if ( fPercentX < fPercentZ )
+        {
+            fBottomLeft = land.height( iX, iZ + 1 );
+            fTopRight   = fTopLeft + (fBottomRight - fBottomLeft);
+
+        } // End if left Triangle
+        else
+        {
+            fTopRight   = land.height( iX + 1, iZ );
+            fBottomLeft = fTopLeft + (fBottomRight - fTopRight);
+
+        } // End if Right Triangle
+        const cgFloat fTopHeight    = fTopLeft    + ((fTopRight - fTopLeft) * fPercentX );
+        const cgFloat fBottomHeight = fBottomLeft + ((fBottomRight - fBottomLeft) * fPercentX );
+        return fTopHeight + ((fBottomHeight - fTopHeight) * fPercentZ );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : referenceMarch ()
+    // Desc : The original cgLandscape::getRayIntersect() block ray marcher.
+    //-------------------------------------------------------------------------
+    bool referenceMarch( const TestLandscape & land, const cgVector3 & origin, const cgVector3 & velocity, cgFloat & t )
+    {
+        cgFloat recipRayLength = cgVector3::length( velocity );
+        if ( recipRayLength < CGE_EPSILON )
+            return false;
+        recipRayLength = 1.0f / recipRayLength;
+        t = 1.0f;
+
+        for ( cgInt32 i = 0; i < land.blocks * land.blocks; ++i )
+        {
+            if ( !land.blockMask[i] )
+                continue;
+
+            // Add a tolerance to ensure that we don't miss the terrain.
+            cgBoundingBox bounds = land.blockBounds[i];
+            const cgFloat adjust = (1.0f / MarchAccuracy) * 2.0f;
+            bounds.min.y -= adjust;
+            bounds.max.y += adjust;
+            cgFloat delta;
+            if ( !bounds.intersect( origin, velocity, delta ) )
+                continue;
+
+            // Clip the ray to the block bounds.
+            cgVector3 rayStart = origin, rayEnd = origin + velocity;
+            if ( !bounds.containsPoint( rayStart ) )
+                rayStart = origin + (velocity * delta);
+            if ( !bounds.containsPoint( rayEnd ) )
+            {
+                if ( !bounds.intersect( rayEnd, (rayStart - rayEnd), delta ) )
+                    continue;
+                rayEnd = rayEnd + ((rayStart - rayEnd) * delta );
+
+            } // End if dest outside bounds
+
+            // March across the block.
+            cgVector3 position = rayStart;
+            const cgVector3 rayDir = rayEnd - rayStart;
+            const cgFloat stepOffset = 1.0f / ( cgVector3::length( rayDir ) * MarchAccuracy );
+            const cgVector3 step = rayDir * stepOffset;
+            const cgInt32 stepCount = (cgInt32)(1.0f / stepOffset);
+            for ( cgInt32 j = 0; j < stepCount; ++j )
+            {
+                if ( position.y < referenceHeight( land, i, position.x, position.z ) )
+                {
+                    delta = cgVector3::length( position - origin ) * recipRayLength;
+                    if ( delta < t )
+                        t = delta;
+                    break;
+
+                } // End if falls under terrain
+                position += step;
+
+            } // Next point along ray
+
+        } // Next block
+        return (t < 1.0f);
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : intersectTriangle ()
+    // Desc : Exact ray / triangle test used by the brute force reference.
+    //-------------------------------------------------------------------------
+    bool intersectTriangle( const cgVector3 & origin, const cgVector3 & velocity, const cgVector3 & v0, const cgVector3 & v1, const cgVector3 & v2, cgDouble & t )
+    {
+        cgVector3 e1 = v1 - v0, e2 = v2 - v0, p, q;
+        cgVector3::cross( p, velocity, e2 );
+        const cgDouble det = (cgDouble)cgVector3::dot( e1, p );
+        if ( fabs( det ) < 1e-12 )
+            return false;
+        const cgVector3 s = origin - v0;
+        const cgDouble u = cgVector3::dot( s, p ) / det;
+        if ( u < 0 || u > 1 )
+            return false;
+        cgVector3::cross( q, s, e1 );
+        const cgDouble v = cgVector3::dot( velocity, q ) / det;
+        if ( v < 0 || u + v > 1 )
+            return false;
+        t = cgVector3::dot( e2, q ) / det;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : referenceExact ()
+    // Desc : Test the ray against every triangle of every existing block.
+    //-------------------------------------------------------------------------
+    bool referenceExact( const TestLandscape & land, const cgVector3 & origin, const cgVector3 & velocity, cgFloat & tOut )
+    {
+        cgDouble closest = 1.0, t;
+        bool found = false;
+        for ( cgInt32 z = 0; z < land.mapSize.height - 1; ++z )
+        {
+            for ( cgInt32 x = 0; x < land.mapSize.width - 1; ++x )
+            {
+                if ( !land.blockMask[ x / (BlockSize - 1) + (z / (BlockSize - 1)) * land.blocks ] )
+                    continue;
+
+                // Corners: top left, top right, bottom left, bottom right.
+                const cgFloat wx = land.offset.x + x * land.scale.x, wz = land.offset.z - z * land.scale.z;
+                const cgVector3 c0( wx, land.height( x, z ), wz );
+                const cgVector3 c1( wx + land.scale.x, land.height( x + 1, z ), wz );
+                const cgVector3 c2( wx, land.height( x, z + 1 ), wz - land.scale.z );
+                const cgVector3 c3( wx + land.scale.x, land.height( x + 1, z + 1 ), wz - land.scale.z );
+                const cgVector3 * triangles[2][3] = { { &c0, &c1, &c3 }, { &c0, &c3, &c2 } };
+                for ( cgInt32 i = 0; i < 2; ++i )
+                {
+                    if ( intersectTriangle( origin, velocity, *triangles[i][0], *triangles[i][1], *triangles[i][2], t ) && t >= 0 && t <= closest )
+                    {
+                        closest = t;
+                        found   = true;
+
+                    } // End if closer
+
+                } // Next triangle
+
+            } // Next column
+
+        } // Next row
+        tOut = (cgFloat)closest;
+        return found;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runLandscape ()
+    // Desc : Measure and validate each method for the specified number of
+    //        terrain blocks along each axis.
+    //-------------------------------------------------------------------------
+    bool runLandscape( cgInt32 blocks )
+    {
+        bool valid = true;
+        TestLandscape land;
+        buildLandscape( land, blocks );
+        cgLandscapeHeightPyramid pyramid;
+        pyramid.build( &land.heights[0], land.mapSize, cgSize( BlockSize, BlockSize ), land.blockMask );
+        pyramid.setTransform( land.offset, land.scale );
+
+        // Random rays, most of which start above the terrain and end below it.
+        const cgFloat extent = (land.mapSize.width - 1) * land.scale.x;
+        cgArray<cgLandscapeRayQuery> queries( RayCount );
+        for ( cgUInt32 i = 0; i < RayCount; ++i )
+        {
+            cgLandscapeRayQuery & query = queries[i];
+            query.origin = cgVector3( land.offset.x + benchmarkRandom( -20, extent + 20 ), benchmarkRandom( -30, 80 ), land.offset.z - benchmarkRandom( -20, extent + 20 ) );
+            const cgVector3 target( land.offset.x + benchmarkRandom( 0, extent ), benchmarkRandom( -40, 60 ), land.offset.z - benchmarkRandom( 0, extent ) );
+            query.velocity = target - query.origin;
+
+        } // Next ray
+        _tprintf( _T("   %dx%d blocks (%dx%d heightmap), %u rays\n"), blocks, blocks, land.mapSize.width, land.mapSize.height, RayCount );
+
+        // Original marcher.
+        cgUInt32 marchHits = 0;
+        cgFloat t;
+        cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 i = 0; i < RayCount; ++i )
+            marchHits += referenceMarch( land, queries[i].origin, queries[i].velocity, t ) ? 1 : 0;
+        const cgDouble marchTime = getBenchmarkTime() - start;
+        reportBenchmark( _T("Block ray marcher (original)"), marchTime, RayCount, _T("ray") );
+
+        // Pyramid, single rays.
+        cgUInt32 pyramidHits = 0;
+        cgArray<cgFloat> distances( RayCount );
+        cgArray<cgUInt8> hits( RayCount );
+        start = getBenchmarkTime();
+        for ( cgUInt32 i = 0; i < RayCount; ++i )
+        {
+            hits[i] = pyramid.intersect( queries[i].origin, queries[i].velocity, distances[i] ) ? 1 : 0;
+            pyramidHits += hits[i];
+
+        } // Next ray
+        const cgDouble pyramidTime = getBenchmarkTime() - start;
+        reportBenchmark( _T("cgLandscapeHeightPyramid::intersect"), pyramidTime, RayCount, _T("ray") );
+
+        // Pyramid, batched across the job system.
+        start = getBenchmarkTime();
+        pyramid.intersectBatch( &queries[0], RayCount );
+        const cgDouble batchTime = getBenchmarkTime() - start;
+        reportBenchmark( _T("cgLandscapeHeightPyramid::intersectBatch"), batchTime, RayCount, _T("ray") );
+        for ( cgUInt32 i = 0; i < RayCount; ++i )
+        {
+            if ( queries[i].intersected != (hits[i] != 0) || (hits[i] && queries[i].hit.t != distances[i]) )
+                valid = false;
+
+        } // Next ray
+
+        // Validate a subset against the exact reference.
+        cgUInt32 mismatches = 0;
+        for ( cgUInt32 i = 0; i < ValidationRays; ++i )
+        {
+            const bool exact = referenceExact( land, queries[i].origin, queries[i].velocity, t );
+            if ( exact != (hits[i] != 0) || (exact && fabsf( t - distances[i] ) > 1e-4f) )
+                mismatches++;
+
+        } // Next ray
+        if ( mismatches )
+            valid = false;
+
+        _tprintf( _T("   Hits: marcher %u, pyramid %u (%u of %u validated rays differ from exact)\n"), marchHits, pyramidHits, mismatches, ValidationRays );
+        reportSpeedup( _T("Speedup, single ray"), marchTime, pyramidTime );
+        reportSpeedup( _T("Speedup, batched"), marchTime, batchTime );
+        return valid;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkLandscapeRay ()
+// Desc : Landscape ray intersection benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkLandscapeRay( )
+{
+    bool valid = runLandscape( 8 );
+    valid &= runLandscape( 32 );
+    return valid;
+}
@@ -0,0 +1,617 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchMath.cpp                                                      //
+//                                                                           //
+// Desc : Compares the batched transform routines of the native math backend //
+//        (SSE2 / AVX / scalar, as selected in cgConfig.h) against a plain   //
+//        scalar reference loop for batches of one million elements, then    //
+//        checks the accuracy of the core matrix and quaternion operations   //
+//        against D3DX (or double precision where D3DX is unavailable).      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchMath Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  ElementCount      = 1000000;
+    const cgUInt32  MatrixCount       = 250000;
+    const cgUInt32  Passes            = 5;
+    const cgUInt32  AccuracyCount     = 100000;
+    const cgDouble  AccuracyTolerance = 1e-4;
+    const cgDouble  InverseTolerance  = 1e-3;   // Poorly conditioned view * projection inverse.
+
+    //-------------------------------------------------------------------------
+    // Scalar reference implementations (row vector * matrix, D3DX layout).
+    //-------------------------------------------------------------------------
+    void referenceTransformCoord( cgVector3 * out, const cgVector3 * in, const cgMatrix & m, cgUInt32 count )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            const cgVector3 & v = in[i];
+            const cgFloat x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+            const cgFloat y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+            const cgFloat z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+            const cgFloat w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+            const cgFloat invW = (w != 0) ? 1.0f / w : 0.0f;
+            out[i].x = x * invW; out[i].y = y * invW; out[i].z = z * invW;
+        
+        } // Next element
+    }
+
+    void referenceTransformNormal( cgVector3 * out, const cgVector3 * in, const cgMatrix & m, cgUInt32 count )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            const cgVector3 & v = in[i];
+            out[i].x = v.x * m._11 + v.y * m._21 + v.z * m._31;
+            out[i].y = v.x * m._12 + v.y * m._22 + v.z * m._32;
+            out[i].z = v.x * m._13 + v.y * m._23 + v.z * m._33;
+        
+        } // Next element
+    }
+
+    void referenceTransform4( cgVector4 * out, const cgVector4 * in, const cgMatrix & m, cgUInt32 count )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            const cgVector4 & v = in[i];
+            out[i].x = v.x * m._11 + v.y * m._21 + v.z * m._31 + v.w * m._41;
+            out[i].y = v.x * m._12 + v.y * m._22 + v.z * m._32 + v.w * m._42;
+            out[i].z = v.x * m._13 + v.y * m._23 + v.z * m._33 + v.w * m._43;
+            out[i].w = v.x * m._14 + v.y * m._24 + v.z * m._34 + v.w * m._44;
+        
+        } // Next element
+    }
+
+    void referenceMultiply( cgMatrix * out, const cgMatrix * a, const cgMatrix * b, cgUInt32 count )
+    {
+        for ( cgUInt32 i = 0; i < count; ++i )
+        {
+            for ( cgInt r = 0; r < 4; ++r )
+                for ( cgInt c = 0; c < 4; ++c )
+                    out[i].m[r][c] = a[i].m[r][0] * b[i].m[0][c] + a[i].m[r][1] * b[i].m[1][c] +
+                                     a[i].m[r][2] * b[i].m[2][c] + a[i].m[r][3] * b[i].m[3][c];
+        
+        } // Next matrix
+    }
+
+    //-------------------------------------------------------------------------
+    // Validation helpers
+    //-------------------------------------------------------------------------
+    bool nearlyEqual( const cgFloat * a, const cgFloat * b, size_t count )
+    {
+        for ( size_t i = 0; i < count; ++i )
+        {
+            const cgFloat scale = max( 1.0f, max( fabsf(a[i]), fabsf(b[i]) ) );
+            if ( fabsf( a[i] - b[i] ) > 1e-4f * scale )
+                return false;
+        
+        } // Next value
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Accuracy references. When D3DX is available (CGE_NATIVE_MATH is not
+    // defined) the cgMatrix / cgQuaternion wrappers forward to it, so the
+    // native backend is checked directly against D3DX. Otherwise it is
+    // checked against double precision versions of the D3DX definitions.
+    //-------------------------------------------------------------------------
+#if !defined(CGE_NATIVE_MATH)
+    void accuracyInverse( cgMatrix & out, const cgMatrix & m )
+    {
+        cgMatrix::inverse( out, m );
+    }
+
+    void accuracyMultiply( cgMatrix & out, const cgMatrix & m1, const cgMatrix & m2 )
+    {
+        cgMatrix::multiply( out, m1, m2 );
+    }
+
+    void accuracyPerspectiveFov( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+    {
+        if ( rightHanded )
+            cgMatrix::perspectiveFovRH( out, fovY, aspect, nearClip, farClip );
+        else
+            cgMatrix::perspectiveFovLH( out, fovY, aspect, nearClip, farClip );
+    }
+
+    void accuracyLookAt( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up, bool rightHanded )
+    {
+        if ( rightHanded )
+            cgMatrix::lookAtRH( out, eye, at, up );
+        else
+            cgMatrix::lookAtLH( out, eye, at, up );
+    }
+
+    void accuracyRotationQuaternion( cgMatrix & out, const cgQuaternion & q )
+    {
+        cgMatrix::rotationQuaternion( out, q );
+    }
+
+    void accuracyQuaternionMultiply( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2 )
+    {
+        cgQuaternion::multiply( out, q1, q2 );
+    }
+
+    void accuracyQuaternionSlerp( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, cgFloat t )
+    {
+        cgQuaternion::slerp( out, q1, q2, t );
+    }
+
+    void accuracyQuaternionNormalize( cgQuaternion & out, const cgQuaternion & q )
+    {
+        cgQuaternion::normalize( out, q );
+    }
+
+    void accuracyQuaternionRotationAxis( cgQuaternion & out, const cgVector3 & axis, cgFloat radians )
+    {
+        cgQuaternion::rotationAxis( out, axis, radians );
+    }
+
+    void accuracyQuaternionRotationMatrix( cgQuaternion & out, const cgMatrix & m )
+    {
+        cgQuaternion::rotationMatrix( out, m );
+    }
+#else // CGE_NATIVE_MATH
+    void normalize3( cgDouble * v )
+    {
+        const cgDouble length = sqrt( v[0] * v[0] + v[1] * v[1] + v[2] * v[2] );
+        v[0] /= length; v[1] /= length; v[2] /= length;
+    }
+
+    void accuracyInverse( cgMatrix & out, const cgMatrix & m )
+    {
+        // Gauss-Jordan elimination with partial pivoting.
+        cgDouble a[4][8];
+        for ( cgInt r = 0; r < 4; ++r )
+        {
+            for ( cgInt c = 0; c < 4; ++c )
+            {
+                a[r][c]     = m.m[r][c];
+                a[r][c + 4] = (r == c) ? 1.0 : 0.0;
+            
+            } // Next column
+        
+        } // Next row
+        for ( cgInt c = 0; c < 4; ++c )
+        {
+            cgInt pivot = c;
+            for ( cgInt r = c + 1; r < 4; ++r )
+            {
+                if ( fabs( a[r][c] ) > fabs( a[pivot][c] ) )
+                    pivot = r;
+            
+            } // Next row
+            for ( cgInt k = 0; k < 8; ++k )
+            {
+                const cgDouble swap = a[c][k];
+                a[c][k] = a[pivot][k];
+                a[pivot][k] = swap;
+            
+            } // Next element
+            const cgDouble scale = 1.0 / a[c][c];
+            for ( cgInt k = 0; k < 8; ++k )
+                a[c][k] *= scale;
+            for ( cgInt r = 0; r < 4; ++r )
+            {
+                if ( r == c )
+                    continue;
+                const cgDouble factor = a[r][c];
+                for ( cgInt k = 0; k < 8; ++k )
+                    a[r][k] -= factor * a[c][k];
+            
+            } // Next row
+        
+        } // Next column
+        for ( cgInt r = 0; r < 4; ++r )
+            for ( cgInt c = 0; c < 4; ++c )
+                out.m[r][c] = (cgFloat)a[r][c + 4];
+    }
+
+    void accuracyMultiply( cgMatrix & out, const cgMatrix & m1, const cgMatrix & m2 )
+    {
+        for ( cgInt r = 0; r < 4; ++r )
+            for ( cgInt c = 0; c < 4; ++c )
+                out.m[r][c] = (cgFloat)((cgDouble)m1.m[r][0] * m2.m[0][c] + (cgDouble)m1.m[r][1] * m2.m[1][c] +
+                                        (cgDouble)m1.m[r][2] * m2.m[2][c] + (cgDouble)m1.m[r][3] * m2.m[3][c]);
+    }
+
+    void accuracyPerspectiveFov( cgMatrix & out, cgFloat fovY, cgFloat aspect, cgFloat nearClip, cgFloat farClip, bool rightHanded )
+    {
+        const cgDouble yScale = 1.0 / tan( (cgDouble)fovY * 0.5 ), xScale = yScale / aspect;
+        const cgDouble depth = (cgDouble)farClip / ((cgDouble)farClip - nearClip);
+        const cgDouble sign = rightHanded ? -1.0 : 1.0;
+        out = cgMatrix( (cgFloat)xScale, 0, 0, 0,
+                        0, (cgFloat)yScale, 0, 0,
+                        0, 0, (cgFloat)(depth * sign), (cgFloat)sign,
+                        0, 0, (cgFloat)(-depth * nearClip), 0 );
+    }
+
+    void accuracyLookAt( cgMatrix & out, const cgVector3 & eye, const cgVector3 & at, const cgVector3 & up, bool rightHanded )
+    {
+        const cgDouble sign = rightHanded ? -1.0 : 1.0;
+        cgDouble z[3] = { sign * ((cgDouble)at.x - eye.x), sign * ((cgDouble)at.y - eye.y), sign * ((cgDouble)at.z - eye.z) };
+        normalize3( z );
+        cgDouble x[3] = { up.y * z[2] - up.z * z[1], up.z * z[0] - up.x * z[2], up.x * z[1] - up.y * z[0] };
+        normalize3( x );
+        const cgDouble y[3] = { z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0] };
+        out = cgMatrix( (cgFloat)x[0], (cgFloat)y[0], (cgFloat)z[0], 0,
+                        (cgFloat)x[1], (cgFloat)y[1], (cgFloat)z[1], 0,
+                        (cgFloat)x[2], (cgFloat)y[2], (cgFloat)z[2], 0,
+                        (cgFloat)-(x[0] * eye.x + x[1] * eye.y + x[2] * eye.z),
+                        (cgFloat)-(y[0] * eye.x + y[1] * eye.y + y[2] * eye.z),
+                        (cgFloat)-(z[0] * eye.x + z[1] * eye.y + z[2] * eye.z), 1 );
+    }
+
+    void accuracyRotationQuaternion( cgMatrix & out, const cgQuaternion & q )
+    {
+        const cgDouble x = q.x, y = q.y, z = q.z, w = q.w;
+        out = cgMatrix( (cgFloat)(1 - 2 * (y * y + z * z)), (cgFloat)(2 * (x * y + z * w)), (cgFloat)(2 * (x * z - y * w)), 0,
+                        (cgFloat)(2 * (x * y - z * w)), (cgFloat)(1 - 2 * (x * x + z * z)), (cgFloat)(2 * (y * z + x * w)), 0,
+                        (cgFloat)(2 * (x * z + y * w)), (cgFloat)(2 * (y * z - x * w)), (cgFloat)(1 - 2 * (x * x + y * y)), 0,
+                        0, 0, 0, 1 );
+    }
+
+    void accuracyQuaternionMultiply( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2 )
+    {
+        // Rotation q1 followed by q2 (q2 * q1), as D3DXQuaternionMultiply.
+        const cgDouble ax = q2.x, ay = q2.y, az = q2.z, aw = q2.w;
+        const cgDouble bx = q1.x, by = q1.y, bz = q1.z, bw = q1.w;
+        out = cgQuaternion( (cgFloat)(aw * bx + ax * bw + ay * bz - az * by),
+                            (cgFloat)(aw * by - ax * bz + ay * bw + az * bx),
+                            (cgFloat)(aw * bz + ax * by - ay * bx + az * bw),
+                            (cgFloat)(aw * bw - ax * bx - ay * by - az * bz) );
+    }
+
+    void accuracyQuaternionSlerp( cgQuaternion & out, const cgQuaternion & q1, const cgQuaternion & q2, cgFloat t )
+    {
+        cgDouble cosTheta = (cgDouble)q1.x * q2.x + (cgDouble)q1.y * q2.y + (cgDouble)q1.z * q2.z + (cgDouble)q1.w * q2.w;
+        cgDouble sign = 1.0, s1 = 1.0 - t, s2 = t;
+        if ( cosTheta < 0.0 )
+        {
+            sign = -1.0;
+            cosTheta = -cosTheta;
+        
+        } // End if opposite hemisphere
+        if ( cosTheta < 1.0 )
+        {
+            const cgDouble theta = acos( cosTheta ), sinTheta = sin( theta );
+            s1 = sin( theta * (1.0 - t) ) / sinTheta;
+            s2 = sin( theta * t ) / sinTheta;
+        
+        } // End if not parallel
+        s2 *= sign;
+        out = cgQuaternion( (cgFloat)(s1 * q1.x + s2 * q2.x), (cgFloat)(s1 * q1.y + s2 * q2.y),
+                            (cgFloat)(s1 * q1.z + s2 * q2.z), (cgFloat)(s1 * q1.w + s2 * q2.w) );
+    }
+
+    void accuracyQuaternionNormalize( cgQuaternion & out, const cgQuaternion & q )
+    {
+        const cgDouble length = sqrt( (cgDouble)q.x * q.x + (cgDouble)q.y * q.y + (cgDouble)q.z * q.z + (cgDouble)q.w * q.w );
+        out = cgQuaternion( (cgFloat)(q.x / length), (cgFloat)(q.y / length), (cgFloat)(q.z / length), (cgFloat)(q.w / length) );
+    }
+
+    void accuracyQuaternionRotationAxis( cgQuaternion & out, const cgVector3 & axis, cgFloat radians )
+    {
+        cgDouble v[3] = { axis.x, axis.y, axis.z };
+        normalize3( v );
+        const cgDouble s = sin( radians * 0.5 );
+        out = cgQuaternion( (cgFloat)(s * v[0]), (cgFloat)(s * v[1]), (cgFloat)(s * v[2]), (cgFloat)cos( radians * 0.5 ) );
+    }
+
+    void accuracyQuaternionRotationMatrix( cgQuaternion & out, const cgMatrix & m )
+    {
+        // Select the largest of w, x, y and z for numerical stability.
+        const cgDouble trace = (cgDouble)m._11 + m._22 + m._33;
+        cgDouble q[4];
+        if ( trace > 0 )
+        {
+            const cgDouble s = 2.0 * sqrt( trace + 1.0 );
+            q[0] = (m._23 - m._32) / s; q[1] = (m._31 - m._13) / s; q[2] = (m._12 - m._21) / s; q[3] = 0.25 * s;
+        
+        } // End if positive trace
+        else if ( m._11 >= m._22 && m._11 >= m._33 )
+        {
+            const cgDouble s = 2.0 * sqrt( 1.0 + m._11 - m._22 - m._33 );
+            q[0] = 0.25 * s; q[1] = (m._12 + m._21) / s; q[2] = (m._13 + m._31) / s; q[3] = (m._23 - m._32) / s;
+        
+        } // End if x largest
+        else if ( m._22 >= m._33 )
+        {
+            const cgDouble s = 2.0 * sqrt( 1.0 + m._22 - m._11 - m._33 );
+            q[0] = (m._12 + m._21) / s; q[1] = 0.25 * s; q[2] = (m._23 + m._32) / s; q[3] = (m._31 - m._13) / s;
+        
+        } // End if y largest
+        else
+        {
+            const cgDouble s = 2.0 * sqrt( 1.0 + m._33 - m._11 - m._22 );
+            q[0] = (m._13 + m._31) / s; q[1] = (m._23 + m._32) / s; q[2] = 0.25 * s; q[3] = (m._12 - m._21) / s;
+        
+        } // End if z largest
+        out = cgQuaternion( (cgFloat)q[0], (cgFloat)q[1], (cgFloat)q[2], (cgFloat)q[3] );
+    }
+#endif // !CGE_NATIVE_MATH
+
+    //-------------------------------------------------------------------------
+    // Name : accuracyError ()
+    // Desc : Largest difference between two sets of values, relative to the
+    //        largest reference magnitude (and never less than one).
+    //-------------------------------------------------------------------------
+    cgDouble accuracyError( const cgFloat * values, const cgFloat * reference, size_t count )
+    {
+        cgDouble scale = 1.0, error = 0.0;
+        for ( size_t i = 0; i < count; ++i )
+            scale = max( scale, (cgDouble)fabsf( reference[i] ) );
+        for ( size_t i = 0; i < count; ++i )
+            error = max( error, fabs( (cgDouble)values[i] - reference[i] ) / scale );
+        return error;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : randomQuaternion ()
+    // Desc : Build a random unit quaternion.
+    //-------------------------------------------------------------------------
+    cgQuaternion randomQuaternion( )
+    {
+        cgQuaternion q( benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ) );
+        accuracyQuaternionNormalize( q, q );
+        return q;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : checkAccuracy ()
+    // Desc : Compare the non-batched native matrix and quaternion operations
+    //        against the accuracy references over a set of random inputs,
+    //        reporting the largest relative error of each.
+    //-------------------------------------------------------------------------
+    bool checkAccuracy( )
+    {
+        enum Operation
+        {
+            MatrixInverseAffine, MatrixInverseProjective, MatrixMultiply, MatrixPerspectiveFov, MatrixLookAt,
+            MatrixRotationQuaternion, QuaternionMultiply, QuaternionSlerp, QuaternionNormalize,
+            QuaternionRotationAxis, QuaternionRotationMatrix, OperationCount
+        };
+        static const cgTChar * Names[OperationCount] =
+        {
+            _T("matrixInverse (affine)"), _T("matrixInverse (projective)"), _T("matrixMultiply"),
+            _T("matrixPerspectiveFov (LH / RH)"), _T("matrixLookAt (LH / RH)"), _T("matrixRotationQuaternion"),
+            _T("quaternionMultiply"), _T("quaternionSlerp"), _T("quaternionNormalize"),
+            _T("quaternionRotationAxis"), _T("quaternionRotationMatrix")
+        };
+        cgDouble errors[OperationCount];
+        for ( cgInt i = 0; i < OperationCount; ++i )
+            errors[i] = 0;
+
+        cgMatrix m1, m2, native, reference, view, projection;
+        cgQuaternion q1, q2, nativeQ, referenceQ;
+        for ( cgUInt32 i = 0; i < AccuracyCount; ++i )
+        {
+            const bool rightHanded = (i & 1) != 0;
+            q1 = randomQuaternion();
+            q2 = randomQuaternion();
+
+            // Rotation from quaternion, and back again. Both q and -q describe
+            // the same rotation, so the extracted sign is not significant.
+            cgMathNative::matrixRotationQuaternion( native, q1 );
+            accuracyRotationQuaternion( reference, q1 );
+            errors[MatrixRotationQuaternion] = max( errors[MatrixRotationQuaternion], accuracyError( native, reference, 16 ) );
+            cgMathNative::quaternionRotationMatrix( nativeQ, reference );
+            accuracyQuaternionRotationMatrix( referenceQ, reference );
+            if ( nativeQ.x * referenceQ.x + nativeQ.y * referenceQ.y + nativeQ.z * referenceQ.z + nativeQ.w * referenceQ.w < 0 )
+                nativeQ = -nativeQ;
+            errors[QuaternionRotationMatrix] = max( errors[QuaternionRotationMatrix], accuracyError( nativeQ, referenceQ, 4 ) );
+
+            // Scaled, rotated and translated (affine) transforms.
+            accuracyRotationQuaternion( m1, q1 );
+            accuracyRotationQuaternion( m2, q2 );
+            for ( cgInt r = 0; r < 3; ++r )
+            {
+                const cgFloat scale = benchmarkRandom( 0.5f, 2.0f );
+                for ( cgInt c = 0; c < 3; ++c )
+                    m1.m[r][c] *= scale;
+                m1.m[3][r] = benchmarkRandom( -100, 100 );
+                m2.m[3][r] = benchmarkRandom( -100, 100 );
+            
+            } // Next row
+            cgMathNative::matrixInverse( native, CG_NULL, m1 );
+            accuracyInverse( reference, m1 );
+            errors[MatrixInverseAffine] = max( errors[MatrixInverseAffine], accuracyError( native, reference, 16 ) );
+            cgMathNative::matrixMultiply( native, m1, m2 );
+            accuracyMultiply( reference, m1, m2 );
+            errors[MatrixMultiply] = max( errors[MatrixMultiply], accuracyError( native, reference, 16 ) );
+
+            // Camera view and projection matrices.
+            const cgVector3 eye( benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ) );
+            const cgVector3 at( benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ) );
+            const cgVector3 up( benchmarkRandom( -0.2f, 0.2f ), 1, benchmarkRandom( -0.2f, 0.2f ) );
+            cgMathNative::matrixLookAt( native, eye, at, up, rightHanded );
+            accuracyLookAt( view, eye, at, up, rightHanded );
+            errors[MatrixLookAt] = max( errors[MatrixLookAt], accuracyError( native, view, 16 ) );
+            const cgFloat fovY = CGEToRadian( benchmarkRandom( 30, 120 ) ), aspect = benchmarkRandom( 0.5f, 2.0f );
+            const cgFloat nearClip = benchmarkRandom( 0.1f, 10 ), farClip = nearClip * benchmarkRandom( 10, 1000 );
+            cgMathNative::matrixPerspectiveFov( native, fovY, aspect, nearClip, farClip, rightHanded );
+            accuracyPerspectiveFov( projection, fovY, aspect, nearClip, farClip, rightHanded );
+            errors[MatrixPerspectiveFov] = max( errors[MatrixPerspectiveFov], accuracyError( native, projection, 16 ) );
+
+            // Full (projective) inverse of the combined camera transform.
+            accuracyMultiply( m1, view, projection );
+            cgMathNative::matrixInverse( native, CG_NULL, m1 );
+            accuracyInverse( reference, m1 );
+            errors[MatrixInverseProjective] = max( errors[MatrixInverseProjective], accuracyError( native, reference, 16 ) );
+
+            // Quaternion operations.
+            cgMathNative::quaternionMultiply( nativeQ, q1, q2 );
+            accuracyQuaternionMultiply( referenceQ, q1, q2 );
+            errors[QuaternionMultiply] = max( errors[QuaternionMultiply], accuracyError( nativeQ, referenceQ, 4 ) );
+            const cgFloat t = benchmarkRandom( 0, 1 );
+            cgMathNative::quaternionSlerp( nativeQ, q1, q2, t );
+            accuracyQuaternionSlerp( referenceQ, q1, q2, t );
+            errors[QuaternionSlerp] = max( errors[QuaternionSlerp], accuracyError( nativeQ, referenceQ, 4 ) );
+            const cgQuaternion unnormalized = q1 * benchmarkRandom( 0.1f, 10 );
+            cgMathNative::quaternionNormalize( nativeQ, unnormalized );
+            accuracyQuaternionNormalize( referenceQ, unnormalized );
+            errors[QuaternionNormalize] = max( errors[QuaternionNormalize], accuracyError( nativeQ, referenceQ, 4 ) );
+            const cgVector3 axis( benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ) );
+            const cgFloat angle = benchmarkRandom( -CGE_PI, CGE_PI );
+            cgMathNative::quaternionRotationAxis( nativeQ, axis, angle );
+            accuracyQuaternionRotationAxis( referenceQ, axis, angle );
+            errors[QuaternionRotationAxis] = max( errors[QuaternionRotationAxis], accuracyError( nativeQ, referenceQ, 4 ) );
+        
+        } // Next case
+
+        // Report.
+        bool valid = true;
+        for ( cgInt i = 0; i < OperationCount; ++i )
+        {
+            const cgDouble tolerance = (i == MatrixInverseProjective) ? InverseTolerance : AccuracyTolerance;
+            const bool passed = (errors[i] <= tolerance);
+            _tprintf( _T("   %-40s %10.2e max error%s\n"), Names[i], errors[i], passed ? _T("") : _T(" (FAILED)") );
+            valid &= passed;
+        
+        } // Next operation
+        return valid;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkMath ()
+// Desc : Batched vector / matrix transform benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkMath( )
+{
+    _tprintf( _T("   Native backend instruction set: %hs\n"), cgMathNative::getInstructionSet() );
+
+    // Build the input data.
+    cgArray<cgVector3> points( ElementCount ), results3( ElementCount ), reference3( ElementCount );
+    cgArray<cgVector4> points4( ElementCount ), results4( ElementCount ), reference4( ElementCount );
+    for ( cgUInt32 i = 0; i < ElementCount; ++i )
+    {
+        points[i]  = cgVector3( benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ), benchmarkRandom( -100, 100 ) );
+        points4[i] = cgVector4( points[i].x, points[i].y, points[i].z, 1.0f );
+    
+    } // Next element
+    cgArray<cgMatrix> left( MatrixCount ), right( MatrixCount ), product( MatrixCount ), referenceProduct( MatrixCount );
+    for ( cgUInt32 i = 0; i < MatrixCount; ++i )
+    {
+        cgMatrix::rotationYawPitchRoll( left[i], benchmarkRandom( -3, 3 ), benchmarkRandom( -3, 3 ), benchmarkRandom( -3, 3 ) );
+        left[i]._41 = benchmarkRandom( -10, 10 ); left[i]._42 = benchmarkRandom( -10, 10 ); left[i]._43 = benchmarkRandom( -10, 10 );
+        cgMatrix::rotationAxis( right[i], cgVector3( 0, 1, 0 ), benchmarkRandom( -3, 3 ) );
+    
+    } // Next matrix
+
+    // A general (projective) transform so that the w divide is exercised. The
+    // camera sits well outside the point cloud so that 'w' never approaches
+    // zero (where differences in summation order would dominate the error).
+    cgMatrix view, projection, transform;
+    cgMatrix::lookAtLH( view, cgVector3( 10, 20, -300 ), cgVector3( 0, 0, 0 ), cgVector3( 0, 1, 0 ) );
+    cgMatrix::perspectiveFovLH( projection, CGEToRadian(60.0f), 1.333f, 1.0f, 1000.0f );
+    transform = view * projection;
+
+    // Time each routine, keeping the best of several passes.
+    bool valid = true;
+    cgDouble referenceTime, nativeTime, start;
+    cgDouble referenceTotal = 0, nativeTotal = 0;
+
+    // transformCoordArray
+    referenceTime = nativeTime = 1e10;
+    for ( cgUInt32 pass = 0; pass < Passes; ++pass )
+    {
+        start = getBenchmarkTime();
+        referenceTransformCoord( &reference3[0], &points[0], transform, ElementCount );
+        referenceTime = min( referenceTime, getBenchmarkTime() - start );
+        start = getBenchmarkTime();
+        cgMathNative::vec3TransformCoordArray( &results3[0], sizeof(cgVector3), &points[0], sizeof(cgVector3), transform, ElementCount );
+        nativeTime = min( nativeTime, getBenchmarkTime() - start );
+    
+    } // Next pass
+    valid &= nearlyEqual( (cgFloat*)&results3[0], (cgFloat*)&reference3[0], ElementCount * 3 );
+    reportBenchmark( _T("vec3TransformCoordArray (reference)"), referenceTime, ElementCount, _T("vec") );
+    reportBenchmark( _T("vec3TransformCoordArray (native)"), nativeTime, ElementCount, _T("vec") );
+    referenceTotal += referenceTime; nativeTotal += nativeTime;
+
+    // transformNormalArray
+    referenceTime = nativeTime = 1e10;
+    for ( cgUInt32 pass = 0; pass < Passes; ++pass )
+    {
+        start = getBenchmarkTime();
+        referenceTransformNormal( &reference3[0], &points[0], left[0], ElementCount );
+        referenceTime = min( referenceTime, getBenchmarkTime() - start );
+        start = getBenchmarkTime();
+        cgMathNative::vec3TransformNormalArray( &results3[0], sizeof(cgVector3), &points[0], sizeof(cgVector3), left[0], ElementCount );
+        nativeTime = min( nativeTime, getBenchmarkTime() - start );
+    
+    } // Next pass
+    valid &= nearlyEqual( (cgFloat*)&results3[0], (cgFloat*)&reference3[0], ElementCount * 3 );
+    reportBenchmark( _T("vec3TransformNormalArray (reference)"), referenceTime, ElementCount, _T("vec") );
+    reportBenchmark( _T("vec3TransformNormalArray (native)"), nativeTime, ElementCount, _T("vec") );
+    referenceTotal += referenceTime; nativeTotal += nativeTime;
+
+    // vec4TransformArray
+    referenceTime = nativeTime = 1e10;
+    for ( cgUInt32 pass = 0; pass < Passes; ++pass )
+    {
+        start = getBenchmarkTime();
+        referenceTransform4( &reference4[0], &points4[0], transform, ElementCount );
+        referenceTime = min( referenceTime, getBenchmarkTime() - start );
+        start = getBenchmarkTime();
+        cgMathNative::vec4TransformArray( &results4[0], sizeof(cgVector4), &points4[0], sizeof(cgVector4), transform, ElementCount );
+        nativeTime = min( nativeTime, getBenchmarkTime() - start );
+    
+    } // Next pass
+    valid &= nearlyEqual( (cgFloat*)&results4[0], (cgFloat*)&reference4[0], ElementCount * 4 );
+    reportBenchmark( _T("vec4TransformArray (reference)"), referenceTime, ElementCount, _T("vec") );
+    reportBenchmark( _T("vec4TransformArray (native)"), nativeTime, ElementCount, _T("vec") );
+    referenceTotal += referenceTime; nativeTotal += nativeTime;
+
+    // matrixMultiplyArray
+    referenceTime = nativeTime = 1e10;
+    for ( cgUInt32 pass = 0; pass < Passes; ++pass )
+    {
+        start = getBenchmarkTime();
+        referenceMultiply( &referenceProduct[0], &left[0], &right[0], MatrixCount );
+        referenceTime = min( referenceTime, getBenchmarkTime() - start );
+        start = getBenchmarkTime();
+        cgMathNative::matrixMultiplyArray( &product[0], &left[0], &right[0], MatrixCount );
+        nativeTime = min( nativeTime, getBenchmarkTime() - start );
+    
+    } // Next pass
+    valid &= nearlyEqual( (cgFloat*)&product[0], (cgFloat*)&referenceProduct[0], MatrixCount * 16 );
+    reportBenchmark( _T("matrixMultiplyArray (reference)"), referenceTime, MatrixCount, _T("mtx") );
+    reportBenchmark( _T("matrixMultiplyArray (native)"), nativeTime, MatrixCount, _T("mtx") );
+    referenceTotal += referenceTime; nativeTotal += nativeTime;
+
+    // Summary
+    reportSpeedup( _T("Overall speedup"), referenceTotal, nativeTotal );
+
+    // Accuracy of the non-batched operations.
+#if !defined(CGE_NATIVE_MATH)
+    _tprintf( _T("   Accuracy against D3DX (%u random cases):\n"), AccuracyCount );
+#else // CGE_NATIVE_MATH
+    _tprintf( _T("   Accuracy against double precision (%u random cases):\n"), AccuracyCount );
+#endif // !CGE_NATIVE_MATH
+    valid &= checkAccuracy();
+    return valid;
+}
@@ -0,0 +1,439 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchParticles.cpp                                                 //
+//                                                                           //
+// Desc : Measures the per-frame simulation cost of one million particles    //
+//        with continual death and rebirth. The cgParticleStore SoA kernel   //
+//        is compared against the original per-particle loop (pointer list   //
+//        compaction by memmove and spline evaluation for every particle)    //
+//        and validated against it over a long run without deaths.           //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchParticles Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <Rendering/cgParticleStore.h>
+#include <Math/cgBezierSpline.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  ParticleCount       = 1000000;
+    const cgUInt32  FrameCount          = 30;
+    const cgUInt32  ReferenceFrames     = 3;        // Original loop takes seconds per frame at this count.
+    const cgUInt32  ValidationCount     = 4099;     // Deliberately not a multiple of four (exercises the scalar tail).
+    const cgUInt32  ValidationSteps     = 240;
+    const cgFloat   TimeStep            = 1.0f / 60.0f;
+    const cgFloat   PositionTolerance   = 1e-4f;    // Relative.
+    const cgFloat   ScaleTolerance      = 1e-3f;    // Relative, baked tables vs. exact spline evaluation.
+    const cgInt32   ColorTolerance      = 1;        // Per channel, out of 255.
+
+    //-------------------------------------------------------------------------
+    // Name : LegacyParticle (Struct)
+    // Desc : Simulation state held by each cgParticle prior to the SoA store.
+    //-------------------------------------------------------------------------
+    struct LegacyParticle
+    {
+        cgFloat     mass;
+        cgVector3   velocity;
+        cgVector3   position;
+        cgVector3   direction;
+        cgFloat     angularVelocity;
+        cgFloat     rotation;
+        cgFloat     age;
+        cgFloat     maximumAge;
+        cgVector2   scale;
+        cgUInt32    color;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : SpawnState (Struct)
+    // Desc : Randomized birth properties shared by both simulation paths.
+    //-------------------------------------------------------------------------
+    struct SpawnState
+    {
+        cgVector3   position;
+        cgVector3   velocity;
+        cgFloat     mass;
+        cgFloat     angularVelocity;
+        cgFloat     lifetime;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : TestEmitter (Struct)
+    // Desc : Property curves and simulation parameters shared by both paths.
+    //-------------------------------------------------------------------------
+    struct TestEmitter
+    {
+        cgBezierSpline2                     curves[cgParticleStore::CurveCount];
+        cgParticleStore::SimulationParams   params;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : makeCurve ()
+    // Desc : Build a four point property curve over the particle lifetime.
+    //-------------------------------------------------------------------------
+    void makeCurve( cgBezierSpline2 & spline, cgFloat y0, cgFloat y1, cgFloat y2, cgFloat y3 )
+    {
+        const cgFloat x[4] = { 0.0f, 0.3f, 0.7f, 1.0f };
+        const cgFloat y[4] = { y0, y1, y2, y3 };
+        for ( cgInt32 i = 0; i < 4; ++i )
+        {
+            spline.addPoint( cgBezierSpline2::SplinePoint( cgVector2( x[i] - 0.1f, y[i] ),
+                                                           cgVector2( x[i], y[i] ),
+                                                           cgVector2( x[i] + 0.1f, y[i] ) ) );
+
+        } // Next point
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : initEmitter ()
+    // Desc : Populate the shared property curves and simulation parameters.
+    //-------------------------------------------------------------------------
+    void initEmitter( TestEmitter & emitter )
+    {
+        makeCurve( emitter.curves[cgParticleStore::ScaleXCurve], 0.2f, 1.0f, 1.5f, 0.5f );
+        makeCurve( emitter.curves[cgParticleStore::ScaleYCurve], 0.5f, 1.0f, 2.0f, 0.1f );
+        makeCurve( emitter.curves[cgParticleStore::ColorRCurve], 1.0f, 0.8f, 0.4f, 0.0f );
+        makeCurve( emitter.curves[cgParticleStore::ColorGCurve], 0.3f, 1.0f, 0.2f, 0.5f );
+        makeCurve( emitter.curves[cgParticleStore::ColorBCurve], 0.0f, 0.5f, 1.0f, 1.0f );
+        makeCurve( emitter.curves[cgParticleStore::ColorACurve], 0.0f, 1.0f, 1.0f, 0.0f );
+
+        cgParticleStore::SimulationParams & params = emitter.params;
+        params.timeDelta             = TimeStep;
+        params.gravity               = cgVector3( 0, -9.8f, 0 );
+        params.globalForce           = cgVector3( 1.0f, 0, 0.5f );
+        params.worldVelocity         = cgVector3( 0, 0, 0 );
+        params.airResistance         = 0.05f;
+        params.velocityScale         = true;
+        params.velocityScaleStrength = 0.1f;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : randomSpawn ()
+    // Desc : Generate a new set of randomized birth properties. Roughly one
+    //        in five particles is massless (unaffected by forces).
+    //-------------------------------------------------------------------------
+    SpawnState randomSpawn( )
+    {
+        SpawnState spawn;
+        spawn.position        = cgVector3( benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ), benchmarkRandom( -1, 1 ) );
+        spawn.velocity        = cgVector3( benchmarkRandom( -5, 5 ), benchmarkRandom( 0, 10 ), benchmarkRandom( -5, 5 ) );
+        spawn.mass            = ( benchmarkRandom( 0, 1 ) < 0.2f ) ? 0.0f : benchmarkRandom( 0.5f, 2.0f );
+        spawn.angularVelocity = benchmarkRandom( -90, 90 );
+        spawn.lifetime        = benchmarkRandom( 1, 3 );
+        return spawn;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : spawnLegacy ()
+    // Desc : Initialize an original style particle from the birth properties.
+    //-------------------------------------------------------------------------
+    void spawnLegacy( LegacyParticle & particle, const SpawnState & spawn, cgFloat age )
+    {
+        memset( &particle, 0, sizeof(LegacyParticle) );
+        particle.position        = spawn.position;
+        particle.velocity        = spawn.velocity;
+        particle.mass            = spawn.mass;
+        particle.angularVelocity = spawn.angularVelocity;
+        particle.maximumAge      = spawn.lifetime;
+        particle.age             = age;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : spawnStore ()
+    // Desc : Add a particle to the SoA store from the birth properties.
+    //-------------------------------------------------------------------------
+    void spawnStore( cgParticleStore & store, cgUInt32 tag, const SpawnState & spawn, cgFloat age )
+    {
+        const cgUInt32 index = store.add( tag );
+        store.getValue( cgParticleStore::PositionX, index )       = spawn.position.x;
+        store.getValue( cgParticleStore::PositionY, index )       = spawn.position.y;
+        store.getValue( cgParticleStore::PositionZ, index )       = spawn.position.z;
+        store.getValue( cgParticleStore::VelocityX, index )       = spawn.velocity.x;
+        store.getValue( cgParticleStore::VelocityY, index )       = spawn.velocity.y;
+        store.getValue( cgParticleStore::VelocityZ, index )       = spawn.velocity.z;
+        store.getValue( cgParticleStore::InverseMass, index )     = ( spawn.mass > 0 ) ? 1.0f / spawn.mass : 0.0f;
+        store.getValue( cgParticleStore::AngularVelocity, index ) = spawn.angularVelocity;
+        store.getValue( cgParticleStore::MaximumAge, index )      = spawn.lifetime;
+        store.getValue( cgParticleStore::Age, index )             = age;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : stepLegacy ()
+    // Desc : Reproduces the original cgParticleEmitter::update() simulation
+    //        loop (excluding billboard write-back). Dead particles are removed
+    //        from the active list by memmove and appended to the dead list.
+    //-------------------------------------------------------------------------
+    void stepLegacy( TestEmitter & emitter, LegacyParticle ** active, LegacyParticle ** dead, cgUInt32 & activeCount, cgUInt32 maxParticles )
+    {
+        const cgParticleStore::SimulationParams & params = emitter.params;
+        const cgFloat timeDelta = params.timeDelta;
+        for ( cgInt32 i = 0; i < (cgInt32)activeCount; ++i )
+        {
+            LegacyParticle * particle = active[i];
+            particle->age += timeDelta;
+            const cgFloat age = particle->age / particle->maximumAge;
+
+            // Past its lifespan?
+            if ( particle->age > particle->maximumAge )
+            {
+                if ( i < (cgInt32)activeCount - 1 )
+                    memmove( &active[i], &active[i+1], ((activeCount - 1) - i) * sizeof(LegacyParticle*) );
+                activeCount--;
+                dead[ (maxParticles - 1) - activeCount ] = particle;
+                i--;
+                continue;
+
+            } // End if kill particle
+
+            // Update velocity if particle has a mass
+            if ( particle->mass > 0.0f )
+            {
+                const cgFloat   speed    = cgVector3::length( particle->velocity );
+                const cgVector3 tractive = params.globalForce + (params.gravity * particle->mass);
+                const cgVector3 drag     = (particle->velocity * speed) * -params.airResistance;
+                particle->velocity += ((tractive + drag) / particle->mass) * timeDelta;
+
+            } // End if has mass
+
+            // Update angles, positions and direction.
+            particle->position += particle->velocity * timeDelta;
+            particle->rotation += particle->angularVelocity * timeDelta;
+            cgVector3 axis = particle->velocity - params.worldVelocity;
+            const cgFloat velocity = cgVector3::length( axis );
+            if ( velocity > 0 )
+            {
+                axis /= velocity;
+                particle->direction = axis;
+
+            } // End if
+
+            // Evaluate color and scale curves.
+            cgColorValue color;
+            color.r = emitter.curves[cgParticleStore::ColorRCurve].evaluateForX( age, true );
+            color.g = emitter.curves[cgParticleStore::ColorGCurve].evaluateForX( age, true );
+            color.b = emitter.curves[cgParticleStore::ColorBCurve].evaluateForX( age, true );
+            color.a = emitter.curves[cgParticleStore::ColorACurve].evaluateForX( age, true );
+            particle->color = color;
+            particle->scale.x = emitter.curves[cgParticleStore::ScaleXCurve].evaluateForX( age, true );
+            particle->scale.y = emitter.curves[cgParticleStore::ScaleYCurve].evaluateForX( age, true );
+            if ( params.velocityScale )
+                particle->scale.y *= 1.0f + (velocity - 1.0f) * params.velocityScaleStrength;
+
+        } // Next particle
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : createStore ()
+    // Desc : Size the store and bake the emitter property curves into it.
+    //-------------------------------------------------------------------------
+    void createStore( cgParticleStore & store, TestEmitter & emitter, cgUInt32 capacity )
+    {
+        store.setCapacity( capacity );
+        for ( cgInt32 i = 0; i < cgParticleStore::CurveCount; ++i )
+            store.bakeCurve( (cgParticleStore::Curve)i, emitter.curves[i] );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : validate ()
+    // Desc : Simulate the same particles through both paths for a number of
+    //        steps (long lifetimes, so nothing dies and the indices stay in
+    //        step) and return the number of particles that disagree. Motion
+    //        is compared against the original loop. The baked curves are
+    //        compared against exact spline evaluation instead, since the
+    //        original approximate evaluation is itself up to ~2% out.
+    //-------------------------------------------------------------------------
+    cgUInt32 validate( TestEmitter & emitter )
+    {
+        seedBenchmarkRandom( 1 );
+        cgParticleStore store;
+        createStore( store, emitter, ValidationCount );
+        cgArray<LegacyParticle> particles( ValidationCount );
+        cgArray<LegacyParticle*> active( ValidationCount ), dead( ValidationCount );
+        for ( cgUInt32 i = 0; i < ValidationCount; ++i )
+        {
+            SpawnState spawn = randomSpawn();
+            spawn.lifetime = 10.0f;
+            spawnStore( store, i, spawn, 0 );
+            spawnLegacy( particles[i], spawn, 0 );
+            active[i] = &particles[i];
+
+        } // Next particle
+
+        cgUInt32 activeCount = ValidationCount;
+        for ( cgUInt32 step = 0; step < ValidationSteps; ++step )
+        {
+            store.simulate( emitter.params );
+            stepLegacy( emitter, &active[0], &dead[0], activeCount, ValidationCount );
+
+        } // Next step
+        if ( store.getCount() != ValidationCount || activeCount != ValidationCount )
+            return ValidationCount;
+
+        cgUInt32 errors = 0;
+        for ( cgUInt32 i = 0; i < ValidationCount; ++i )
+        {
+            const LegacyParticle & particle = particles[ store.getTag(i) ];
+            const cgFloat position[3] = { particle.position.x, particle.position.y, particle.position.z };
+            bool match = true;
+            for ( cgInt32 axis = 0; axis < 3; ++axis )
+            {
+                const cgFloat value = store.getValue( (cgParticleStore::Stream)(cgParticleStore::PositionX + axis), i );
+                const cgFloat magnitude = ( fabsf( position[axis] ) > 1.0f ) ? fabsf( position[axis] ) : 1.0f;
+                if ( fabsf( value - position[axis] ) > PositionTolerance * magnitude )
+                    match = false;
+
+            } // Next axis
+
+            // Exact curve values at the particle's current age.
+            const cgFloat age = particle.age / particle.maximumAge;
+            const cgFloat velocity = cgVector3::length( particle.velocity - emitter.params.worldVelocity );
+            cgFloat scale[2];
+            scale[0] = emitter.curves[cgParticleStore::ScaleXCurve].evaluateForX( age );
+            scale[1] = emitter.curves[cgParticleStore::ScaleYCurve].evaluateForX( age ) * (1.0f + (velocity - 1.0f) * emitter.params.velocityScaleStrength);
+            for ( cgInt32 axis = 0; axis < 2; ++axis )
+            {
+                const cgFloat value = store.getValue( (cgParticleStore::Stream)(cgParticleStore::ScaleX + axis), i );
+                const cgFloat magnitude = ( fabsf( scale[axis] ) > 1.0f ) ? fabsf( scale[axis] ) : 1.0f;
+                if ( fabsf( value - scale[axis] ) > ScaleTolerance * magnitude )
+                    match = false;
+
+            } // Next axis
+            cgColorValue exactColor;
+            exactColor.r = emitter.curves[cgParticleStore::ColorRCurve].evaluateForX( age );
+            exactColor.g = emitter.curves[cgParticleStore::ColorGCurve].evaluateForX( age );
+            exactColor.b = emitter.curves[cgParticleStore::ColorBCurve].evaluateForX( age );
+            exactColor.a = emitter.curves[cgParticleStore::ColorACurve].evaluateForX( age );
+            const cgUInt32 color = exactColor;
+            for ( cgInt32 shift = 0; shift < 32; shift += 8 )
+            {
+                const cgInt32 difference = (cgInt32)((store.getColor(i) >> shift) & 0xFF) - (cgInt32)((color >> shift) & 0xFF);
+                if ( difference > ColorTolerance || difference < -ColorTolerance )
+                    match = false;
+
+            } // Next channel
+            if ( !match )
+                ++errors;
+
+        } // Next particle
+        return errors;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runStore ()
+    // Desc : Simulate a full store for a number of frames, respawning expired
+    //        particles immediately. Returns the time spent simulating and
+    //        retiring particles (births are excluded, as for the reference).
+    //-------------------------------------------------------------------------
+    cgDouble runStore( TestEmitter & emitter, cgUInt32 & deathsOut )
+    {
+        seedBenchmarkRandom( 7 );
+        cgParticleStore store;
+        createStore( store, emitter, ParticleCount );
+        for ( cgUInt32 i = 0; i < ParticleCount; ++i )
+        {
+            const SpawnState spawn = randomSpawn();
+            spawnStore( store, i, spawn, benchmarkRandom( 0, spawn.lifetime ) );
+
+        } // Next particle
+
+        cgUInt32Array expired;
+        cgDouble total = 0;
+        deathsOut = 0;
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+        {
+            const cgDouble start = getBenchmarkTime();
+            store.simulate( emitter.params );
+            expired.clear();
+            store.removeExpired( expired );
+            total += getBenchmarkTime() - start;
+
+            deathsOut += (cgUInt32)expired.size();
+            for ( size_t i = 0; i < expired.size(); ++i )
+                spawnStore( store, expired[i], randomSpawn(), 0 );
+
+        } // Next frame
+        return total;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runLegacy ()
+    // Desc : Simulate the same population through the original loop.
+    //-------------------------------------------------------------------------
+    cgDouble runLegacy( TestEmitter & emitter )
+    {
+        seedBenchmarkRandom( 7 );
+        cgArray<LegacyParticle> particles( ParticleCount );
+        cgArray<LegacyParticle*> active( ParticleCount ), dead( ParticleCount );
+        for ( cgUInt32 i = 0; i < ParticleCount; ++i )
+        {
+            const SpawnState spawn = randomSpawn();
+            spawnLegacy( particles[i], spawn, benchmarkRandom( 0, spawn.lifetime ) );
+            active[i] = &particles[i];
+
+        } // Next particle
+
+        cgUInt32 activeCount = ParticleCount;
+        cgDouble total = 0;
+        for ( cgUInt32 frame = 0; frame < ReferenceFrames; ++frame )
+        {
+            const cgDouble start = getBenchmarkTime();
+            stepLegacy( emitter, &active[0], &dead[0], activeCount, ParticleCount );
+            total += getBenchmarkTime() - start;
+
+            // Respawn from the dead list.
+            while ( activeCount < ParticleCount )
+            {
+                LegacyParticle * particle = dead[ (ParticleCount - 1) - activeCount ];
+                spawnLegacy( *particle, randomSpawn(), 0 );
+                active[ activeCount++ ] = particle;
+
+            } // Next dead particle
+
+        } // Next frame
+        return total;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkParticles ()
+// Desc : Particle simulation benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkParticles( )
+{
+    TestEmitter emitter;
+    initEmitter( emitter );
+
+    const cgUInt32 errors = validate( emitter );
+    _tprintf( _T("   Validation: %u of %u particles differ after %u steps\n"), errors, ValidationCount, ValidationSteps );
+
+    cgUInt32 deaths;
+    const cgDouble storeTime = runStore( emitter, deaths );
+    _tprintf( _T("   Particles: %u, %u deaths per frame\n"), ParticleCount, deaths / FrameCount );
+    const cgDouble referenceTime = runLegacy( emitter );
+    reportBenchmark( _T("Per-particle loop (original)"), referenceTime, (cgDouble)ReferenceFrames * ParticleCount, _T("particle") );
+    reportBenchmark( _T("cgParticleStore::simulate()"), storeTime, (cgDouble)FrameCount * ParticleCount, _T("particle") );
+    reportSpeedup( _T("Speedup"), referenceTime / ReferenceFrames, storeTime / FrameCount );
+    return ( errors == 0 );
+}
@@ -0,0 +1,188 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchPicking.cpp                                                   //
+//                                                                           //
+// Desc : Measures mesh picking throughput (rays per second) for a 200k      //
+//        triangle mesh using the original per-triangle loop employed by     //
+//        cgMesh::pickMeshSubset() and the cached cgTriangleBVH (single ray  //
+//        and 8-ray packet queries).                                         //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchPicking Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  GridSize        = 317;      // 316 x 316 quads = 199,712 triangles.
+    const cgFloat   GridSpacing     = 0.25f;
+    const cgUInt32  RayCount        = 8192;
+    const cgUInt32  LinearRayCount  = 256;      // The original loop is far too slow to run every ray.
+
+    //-------------------------------------------------------------------------
+    // Name : referencePick ()
+    // Desc : The original cgMesh::pickMeshSubset() solid picking loop.
+    //-------------------------------------------------------------------------
+    bool referencePick( const cgArray<cgVector3> & vertices, const cgArray<cgUInt32> & indices, const cgVector3 & origin, const cgVector3 & direction, cgFloat & distanceOut, cgUInt32 & faceOut )
+    {
+        bool     intersected = false;
+        cgFloat  closest     = FLT_MAX, t;
+        const cgUInt32 faceCount = (cgUInt32)indices.size() / 3;
+        
+        // Test every triangle for intersection
+        for ( cgUInt32 i = 0; i < faceCount; ++i )
+        {
+            const cgVector3 & v1 = vertices[ indices[i*3] ];
+            const cgVector3 & v2 = vertices[ indices[i*3+1] ];
+            const cgVector3 & v3 = vertices[ indices[i*3+2] ];
+            if ( !cgCollision::rayIntersectTriangle( origin, direction, v1, v2, v3, t, CGE_EPSILON_1MM, false, false ) )
+                continue;
+            if ( t < closest )
+            {
+                closest     = t;
+                faceOut     = i;
+                intersected = true;
+            
+            } // End if closer
+        
+        } // Next triangle
+        distanceOut = closest;
+        return intersected;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkPicking ()
+// Desc : Mesh picking benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkPicking( )
+{
+    // Build a rolling height field mesh.
+    cgArray<cgVector3> vertices( GridSize * GridSize );
+    for ( cgUInt32 z = 0; z < GridSize; ++z )
+    {
+        for ( cgUInt32 x = 0; x < GridSize; ++x )
+        {
+            const cgFloat fx = x * GridSpacing, fz = z * GridSpacing;
+            vertices[ z * GridSize + x ] = cgVector3( fx, sinf( fx * 0.7f ) * cosf( fz * 0.5f ) * 4.0f + benchmarkRandom( -0.1f, 0.1f ), fz );
+        
+        } // Next column
+    
+    } // Next row
+    cgArray<cgUInt32> indices;
+    indices.reserve( (GridSize - 1) * (GridSize - 1) * 6 );
+    for ( cgUInt32 z = 0; z < GridSize - 1; ++z )
+    {
+        for ( cgUInt32 x = 0; x < GridSize - 1; ++x )
+        {
+            const cgUInt32 i = z * GridSize + x;
+            indices.push_back( i ); indices.push_back( i + GridSize ); indices.push_back( i + 1 );
+            indices.push_back( i + 1 ); indices.push_back( i + GridSize ); indices.push_back( i + GridSize + 1 );
+        
+        } // Next column
+    
+    } // Next row
+    const cgUInt32 faceCount = (cgUInt32)indices.size() / 3;
+    _tprintf( _T("   Mesh: %u triangles\n"), faceCount );
+
+    // Rays fired down onto the surface from random points above it at
+    // random angles. Each consecutive group of eight rays forms a small
+    // coherent bundle, as produced by a cursor pick or a fan of gameplay
+    // ray casts, so that the packet query has something to share.
+    const cgFloat extent = (GridSize - 1) * GridSpacing;
+    cgArray<cgVector3> origins( RayCount ), directions( RayCount );
+    cgVector3 bundleOrigin, bundleDirection;
+    for ( cgUInt32 i = 0; i < RayCount; ++i )
+    {
+        if ( (i % cgTriangleBVH::MaxPacketSize) == 0 )
+        {
+            bundleOrigin    = cgVector3( benchmarkRandom( 0, extent ), 20.0f, benchmarkRandom( 0, extent ) );
+            bundleDirection = cgVector3( benchmarkRandom( -0.5f, 0.5f ), -1.0f, benchmarkRandom( -0.5f, 0.5f ) );
+        
+        } // End if new bundle
+        origins[i]    = bundleOrigin;
+        directions[i] = bundleDirection + cgVector3( benchmarkRandom( -0.02f, 0.02f ), 0, benchmarkRandom( -0.02f, 0.02f ) );
+        cgVector3::normalize( directions[i], directions[i] );
+    
+    } // Next ray
+
+    // Build the hierarchy (this is what cgMesh caches on first pick).
+    cgTriangleBVH bvh;
+    cgDouble start = getBenchmarkTime();
+    bvh.build( (const cgByte*)&vertices[0], sizeof(cgVector3), 0, &indices[0], faceCount, CGE_EPSILON_1MM );
+    reportBenchmark( _T("cgTriangleBVH::build"), getBenchmarkTime() - start, faceCount, _T("tri") );
+
+    // Original linear loop (subset of the rays).
+    bool valid = true;
+    cgArray<cgFloat> referenceDistances( LinearRayCount );
+    cgArray<bool>    referenceHits( LinearRayCount );
+    cgUInt32 face;
+    start = getBenchmarkTime();
+    for ( cgUInt32 i = 0; i < LinearRayCount; ++i )
+        referenceHits[i] = referencePick( vertices, indices, origins[i], directions[i], referenceDistances[i], face );
+    const cgDouble linearTime = getBenchmarkTime() - start;
+    reportBenchmark( _T("Per-triangle loop (original)"), linearTime, LinearRayCount, _T("ray") );
+
+    // Single ray BVH queries.
+    cgArray<cgFloat>  distances( RayCount );
+    cgArray<cgUInt32> hits( RayCount );
+    start = getBenchmarkTime();
+    for ( cgUInt32 i = 0; i < RayCount; ++i )
+        hits[i] = bvh.intersect( origins[i], directions[i], distances[i], face ) ? 1 : 0;
+    const cgDouble singleTime = getBenchmarkTime() - start;
+    reportBenchmark( _T("cgTriangleBVH::intersect"), singleTime, RayCount, _T("ray") );
+
+    // Validate against the original loop.
+    for ( cgUInt32 i = 0; i < LinearRayCount; ++i )
+    {
+        if ( (hits[i] != 0) != referenceHits[i] )
+            valid = false;
+        else if ( referenceHits[i] && fabsf( distances[i] - referenceDistances[i] ) > 1e-4f )
+            valid = false;
+    
+    } // Next ray
+
+    // Packet queries.
+    cgFloat  packetDistances[ cgTriangleBVH::MaxPacketSize ];
+    cgUInt32 packetFaces[ cgTriangleBVH::MaxPacketSize ];
+    start = getBenchmarkTime();
+    for ( cgUInt32 i = 0; i < RayCount; i += cgTriangleBVH::MaxPacketSize )
+    {
+        const cgUInt32 mask = bvh.intersectPacket( cgTriangleBVH::MaxPacketSize, &origins[i], &directions[i], packetDistances, packetFaces );
+        for ( cgUInt32 j = 0; j < cgTriangleBVH::MaxPacketSize; ++j )
+        {
+            const bool hit = ((mask >> j) & 1) != 0;
+            if ( hit != (hits[i+j] != 0) || (hit && packetDistances[j] != distances[i+j]) )
+                valid = false;
+        
+        } // Next ray in packet
+    
+    } // Next packet
+    const cgDouble packetTime = getBenchmarkTime() - start;
+    reportBenchmark( _T("cgTriangleBVH::intersectPacket (8 rays)"), packetTime, RayCount, _T("ray") );
+
+    // Summary (per ray rates).
+    reportSpeedup( _T("Speedup, single ray BVH"), linearTime / LinearRayCount, singleTime / RayCount );
+    reportSpeedup( _T("Speedup, packet BVH"), linearTime / LinearRayCount, packetTime / RayCount );
+    return valid;
+}
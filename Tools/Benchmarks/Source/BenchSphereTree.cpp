@@ -0,0 +1,317 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchSphereTree.cpp                                                //
+//                                                                           //
+// Desc : Measures the per-frame cost of cgSphereTree::process() for a scene //
+//        in which objects are continually moving between, added to and      //
+//        removed from the hierarchy. The incrementally patched traversal    //
+//        layout is compared against a full layout rebuild on every change   //
+//        (the original behavior) and validated against the hierarchy.       //
+//        The cost of computeVisibility() is then measured for a much larger //
+//        tree, comparing the batch classified walk of the flattened layout  //
+//        against the original recursive walk of the linked hierarchy, and   //
+//        the visibility state produced by each is compared.                 //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchSphereTree Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <World/cgSphereTree.h>
+#include <World/cgBSPVisTree.h>
+#include <Math/cgFrustum.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <algorithm>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  ObjectCount     = 5000;
+    const cgUInt32  FrameCount      = 60;
+    const cgUInt32  MovesPerFrame   = ObjectCount / 100;    // Objects that leave their parent each frame.
+    const cgUInt32  ChurnPerFrame   = ObjectCount / 400;    // Objects removed and re-added each frame.
+    const cgFloat   WorldExtent     = 100.0f;
+
+    // Visibility traversal
+    const cgUInt32  VisibilityObjectCount   = 50000;
+    const cgUInt32  ViewCount               = 32;
+    const cgUInt32  VisibilityPassCount     = 10;       // Passes over every view.
+    const cgFloat   VisibilityExtent        = 250.0f;
+
+    //-------------------------------------------------------------------------
+    // Name : LayoutProbe (Class)
+    // Desc : Exposes the protected traversal layout so that it can be checked
+    //        against the linked hierarchy it mirrors.
+    //-------------------------------------------------------------------------
+    class LayoutProbe : public cgSphereTree
+    {
+    public:
+        LayoutProbe( cgUInt32 maxSpheres ) :
+            cgSphereTree( maxSpheres, 5, 0.6f, CG_NULL ) {}
+
+        // Force a full rebuild of the traversal layout.
+        void rebuild( )
+        {
+            rebuildLayout();
+        }
+
+        // Returns the number of inconsistencies found.
+        cgUInt32 validate( )
+        {
+            if ( mLayoutDirty )
+                return 1;
+            cgUInt32 entries = 0;
+            cgUInt32 errors = validateNode( mRoot, entries );
+            if ( entries != mLayout.entryCount )
+                ++errors;
+            return errors;
+        }
+
+        // Update visibility by recursively walking the linked hierarchy,
+        // reproducing the original behavior.
+        void computePointerVisibility( const cgFrustum & frustum, cgVisibilitySet * visibilityData, cgUInt32 setIndex )
+        {
+            mRoot->computeVisibility( frustum, visibilityData, setIndex, 0, cgVolumeQuery::Intersect, CG_NULL, cgBSPTree::InvalidLeaf, CG_NULL );
+        }
+
+        // Returns the number of nodes whose visibility state differs
+        // between the two specified sets.
+        cgUInt32 compareVisibility( cgUInt32 setA, cgUInt32 setB )
+        {
+            const cgUInt32 mask = Hidden | Partial | Inside;
+            cgUInt32 errors = 0;
+            for ( cgSphereTreeSubNode * node = mNodePool.begin(); node; node = mNodePool.next() )
+            {
+                const cgUInt32Array & flags = node->getVisibilityFlags();
+                if ( (flags[setA] & mask) != (flags[setB] & mask) )
+                    ++errors;
+            
+            } // Next node
+            return errors;
+        }
+
+        // Returns the total number of nodes in the hierarchy.
+        cgUInt32 getNodeCount( )
+        {
+            cgUInt32 count = 0;
+            for ( cgSphereTreeSubNode * node = mNodePool.begin(); node; node = mNodePool.next() )
+                ++count;
+            return count;
+        }
+
+    private:
+        cgUInt32 validateNode( cgSphereTreeSubNode * node, cgUInt32 & entries )
+        {
+            ++entries;
+            const cgUInt32 index = node->getLayoutIndex();
+            if ( index >= mLayout.slotCount || mLayout.nodes[index] != node )
+                return 1;
+            if ( mLayout.centerX[index] != node->position.x || mLayout.centerY[index] != node->position.y ||
+                 mLayout.centerZ[index] != node->position.z || mLayout.radius[index] != node->radius )
+                return 1;
+            if ( mLayout.childCount[index] != node->getChildCount() )
+                return 1;
+
+            // The layout block must hold exactly the linked children.
+            cgArray<cgSphereTreeSubNode*> linked, stored;
+            for ( cgSphereTreeSubNode * child = node->getChildren(); child; child = child->getNextSibling() )
+                linked.push_back( child );
+            for ( cgUInt32 i = 0; i < mLayout.childCount[index]; ++i )
+                stored.push_back( mLayout.nodes[ mLayout.firstChild[index] + i ] );
+            std::sort( linked.begin(), linked.end() );
+            std::sort( stored.begin(), stored.end() );
+            if ( linked != stored )
+                return 1;
+
+            cgUInt32 errors = 0;
+            for ( size_t i = 0; i < linked.size(); ++i )
+                errors += validateNode( linked[i], entries );
+            return errors;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : runFrames ()
+    // Desc : Populate a tree and then simulate a number of frames of object
+    //        movement and churn, returning the total time spent in process().
+    //        When 'fullRebuild' is set, the layout is rebuilt in its entirety
+    //        each frame, reproducing the original behavior.
+    //-------------------------------------------------------------------------
+    cgDouble runFrames( bool fullRebuild, cgUInt32 & errors, cgDouble & rebuildTime )
+    {
+        seedBenchmarkRandom( 1234 );
+        LayoutProbe tree( ObjectCount * 2 );
+
+        // Populate.
+        cgArray<cgSphereTreeSubNode*> nodes( ObjectCount );
+        for ( cgUInt32 i = 0; i < ObjectCount; ++i )
+        {
+            const cgVector3 position( benchmarkRandom( -WorldExtent, WorldExtent ), benchmarkRandom( -10, 10 ), benchmarkRandom( -WorldExtent, WorldExtent ) );
+            nodes[i] = tree.addSphere( cgBoundingSphere( position, benchmarkRandom( 0.5f, 2.0f ) ), CG_NULL );
+
+        } // Next object
+        tree.process();
+
+        // Simulate.
+        cgDouble total = 0;
+        errors = 0;
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+        {
+            for ( cgUInt32 i = 0; i < MovesPerFrame; ++i )
+            {
+                cgSphereTreeSubNode * node = nodes[ (cgUInt32)benchmarkRandom( 0, ObjectCount - 1 ) ];
+                node->updateSphere( cgVector3( benchmarkRandom( -WorldExtent, WorldExtent ), benchmarkRandom( -10, 10 ), benchmarkRandom( -WorldExtent, WorldExtent ) ) );
+
+            } // Next move
+            for ( cgUInt32 i = 0; i < ChurnPerFrame; ++i )
+            {
+                const cgUInt32 index = (cgUInt32)benchmarkRandom( 0, ObjectCount - 1 );
+                const cgBoundingSphere bounds( nodes[index]->position, nodes[index]->radius );
+                tree.removeSphere( nodes[index] );
+                nodes[index] = tree.addSphere( bounds, CG_NULL );
+
+            } // Next churn
+            if ( fullRebuild )
+                tree.invalidateLayout();
+
+            const cgDouble start = getBenchmarkTime();
+            tree.process();
+            total += getBenchmarkTime() - start;
+
+            // Check the layout periodically.
+            if ( (frame % 10) == 9 )
+                errors += tree.validate();
+
+        } // Next frame
+
+        // Time the layout rebuild in isolation for reference.
+        const cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 frame = 0; frame < FrameCount; ++frame )
+            tree.rebuild();
+        rebuildTime = getBenchmarkTime() - start;
+        errors += tree.validate();
+        return total;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : runVisibility ()
+    // Desc : Populate a large tree and time visibility computation for a set
+    //        of random views using both traversals, then compare the state
+    //        that each produces for every view. The objects are added as
+    //        non-terminal spheres so that no scene objects are required; all
+    //        of the classification and flag maintenance work is still done,
+    //        only visibility set registration is skipped.
+    //-------------------------------------------------------------------------
+    void runVisibility( cgDouble & pointerTime, cgDouble & flatTime, cgUInt32 & nodeCount, cgUInt32 & errors )
+    {
+        seedBenchmarkRandom( 4321 );
+        LayoutProbe tree( VisibilityObjectCount * 2 );
+
+        // The sets are only used to identify the per-set visibility flags here
+        // (nothing is ever registered with them), so stand-ins will suffice.
+        cgByte sets[2];
+        cgVisibilitySet * pointerSet = (cgVisibilitySet*)&sets[0];
+        cgVisibilitySet * flatSet    = (cgVisibilitySet*)&sets[1];
+        tree.addVisibilitySet( pointerSet );
+        tree.addVisibilitySet( flatSet );
+
+        // Populate.
+        for ( cgUInt32 i = 0; i < VisibilityObjectCount; ++i )
+        {
+            const cgVector3 position( benchmarkRandom( -VisibilityExtent, VisibilityExtent ), benchmarkRandom( -10, 10 ), benchmarkRandom( -VisibilityExtent, VisibilityExtent ) );
+            tree.addSphere( cgBoundingSphere( position, benchmarkRandom( 0.5f, 2.0f ) ), CG_NULL, cgSphereTree::NodeFlags(0) );
+
+        } // Next object
+        tree.process();
+        nodeCount = tree.getNodeCount();
+
+        // Generate views looking in random directions from within the world.
+        cgArray<cgFrustum> views( ViewCount );
+        cgMatrix projection;
+        cgMatrix::perspectiveFovLH( projection, CGEToRadian(60.0f), 16.0f / 9.0f, 1.0f, 300.0f );
+        for ( cgUInt32 i = 0; i < ViewCount; ++i )
+        {
+            const cgVector3 eye( benchmarkRandom( -VisibilityExtent, VisibilityExtent ), benchmarkRandom( 2, 40 ), benchmarkRandom( -VisibilityExtent, VisibilityExtent ) );
+            const cgVector3 at( benchmarkRandom( -VisibilityExtent, VisibilityExtent ), 0, benchmarkRandom( -VisibilityExtent, VisibilityExtent ) );
+            cgMatrix view;
+            cgMatrix::lookAtLH( view, eye, at, cgVector3( 0, 1, 0 ) );
+            views[i].update( view, projection );
+
+        } // Next view
+
+        // Time each traversal. The flattened layout is built by the first
+        // call to process() above, so neither includes any layout work.
+        cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 pass = 0; pass < VisibilityPassCount; ++pass )
+        {
+            for ( cgUInt32 i = 0; i < ViewCount; ++i )
+                tree.computePointerVisibility( views[i], pointerSet, 0 );
+        
+        } // Next pass
+        pointerTime = getBenchmarkTime() - start;
+        start = getBenchmarkTime();
+        for ( cgUInt32 pass = 0; pass < VisibilityPassCount; ++pass )
+        {
+            for ( cgUInt32 i = 0; i < ViewCount; ++i )
+                tree.computeVisibility( views[i], flatSet, 0 );
+        
+        } // Next pass
+        flatTime = getBenchmarkTime() - start;
+
+        // Both traversals visit every node, so their results must match
+        // exactly for each view.
+        errors = 0;
+        for ( cgUInt32 i = 0; i < ViewCount; ++i )
+        {
+            tree.computePointerVisibility( views[i], pointerSet, 0 );
+            tree.computeVisibility( views[i], flatSet, 0 );
+            errors += tree.compareVisibility( 0, 1 );
+
+        } // Next view
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkSphereTree ()
+// Desc : Sphere tree layout maintenance benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkSphereTree( )
+{
+    _tprintf( _T("   Objects: %u, %u moved and %u re-added per frame\n"), ObjectCount, MovesPerFrame, ChurnPerFrame );
+
+    cgUInt32 referenceErrors, errors;
+    cgDouble rebuildTime;
+    const cgDouble referenceTime = runFrames( true, referenceErrors, rebuildTime );
+    reportBenchmark( _T("process(), full layout rebuild (original)"), referenceTime, FrameCount, _T("frame") );
+    const cgDouble patchedTime = runFrames( false, errors, rebuildTime );
+    reportBenchmark( _T("process(), incremental layout"), patchedTime, FrameCount, _T("frame") );
+    reportBenchmark( _T("Layout rebuild alone"), rebuildTime, FrameCount, _T("rebuild") );
+    reportSpeedup( _T("Speedup"), referenceTime, patchedTime );
+
+    cgUInt32 nodeCount, visibilityErrors;
+    cgDouble pointerTime, flatTime;
+    runVisibility( pointerTime, flatTime, nodeCount, visibilityErrors );
+    _tprintf( _T("   Visibility: %u objects (%u nodes), %u views\n"), VisibilityObjectCount, nodeCount, ViewCount );
+    const cgDouble viewCount = (cgDouble)ViewCount * VisibilityPassCount;
+    reportBenchmark( _T("computeVisibility(), pointer (original)"), pointerTime, viewCount, _T("view") );
+    reportBenchmark( _T("computeVisibility(), flattened layout"), flatTime, viewCount, _T("view") );
+    reportSpeedup( _T("Speedup"), pointerTime, flatTime );
+    _tprintf( _T("   Nodes with differing visibility state: %u\n"), visibilityErrors );
+    return ( !referenceErrors && !errors && !visibilityErrors );
+}
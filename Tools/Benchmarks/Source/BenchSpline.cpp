@@ -0,0 +1,243 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : BenchSpline.cpp                                                    //
+//                                                                           //
+// Desc : Measures cgBezierSpline2 evaluation cost for exact, approximate,   //
+//        uniform lookup table and adaptive lookup table sampling, both one  //
+//        sample at a time and through the batch entry point. Table results  //
+//        are validated against exact evaluation and the reported error, and //
+//        a shared spline is sampled from the job system worker threads to   //
+//        confirm that concurrent evaluation matches serial evaluation.      //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// BenchSpline Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <Math/cgBezierSpline.h>
+#include <System/cgJobSystem.h>
+#include <tchar.h>
+#include <stdio.h>
+#include <math.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    const cgUInt32  SampleCount     = 65536;
+    const cgUInt32  Repetitions     = 16;
+    const cgFloat   TableError      = 0.001f;   // Requested maximum lookup table error.
+    const cgUInt32  TableEntries    = 1024;     // Lookup table entry cap.
+    const cgFloat   ErrorSlack      = 1e-5f;    // Allowance for float rounding when checking reported error.
+
+    //-------------------------------------------------------------------------
+    // Name : ParallelData (Struct)
+    // Desc : Context for concurrent evaluation of a shared spline.
+    //-------------------------------------------------------------------------
+    struct ParallelData
+    {
+        cgBezierSpline2   * spline;
+        const cgFloat     * xs;
+        cgFloat           * ys;
+    };
+
+    //-------------------------------------------------------------------------
+    // Name : makePoint ()
+    // Desc : Build a spline point with control points relative to the point.
+    //-------------------------------------------------------------------------
+    cgBezierSpline2::SplinePoint makePoint( cgFloat x, cgFloat y, cgFloat inX, cgFloat inY, cgFloat outX, cgFloat outY )
+    {
+        return cgBezierSpline2::SplinePoint( cgVector2( x + inX, y + inY ), cgVector2( x, y ), cgVector2( x + outX, y + outY ) );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : buildCurve ()
+    // Desc : Populate one of the test curves: a two point ease in / out, or
+    //        a four point curve with a sharp peak and trough.
+    //-------------------------------------------------------------------------
+    void buildCurve( cgBezierSpline2 & spline, cgInt32 curve )
+    {
+        spline.clear();
+        if ( curve == 0 )
+        {
+            spline.addPoint( makePoint( 0, 0, 0, 0, 0.4f, 0 ) );
+            spline.addPoint( makePoint( 1, 1, -0.4f, 0, 0, 0 ) );
+
+        } // End if ease
+        else
+        {
+            spline.addPoint( makePoint( 0.0f, 0.2f, 0, 0, 0.1f, 0.5f ) );
+            spline.addPoint( makePoint( 0.3f, 0.9f, -0.1f, 0, 0.05f, 0 ) );
+            spline.addPoint( makePoint( 0.35f, 0.1f, -0.02f, 0, 0.2f, 0 ) );
+            spline.addPoint( makePoint( 1.0f, 0.6f, -0.3f, 0.4f, 0, 0 ) );
+
+        } // End if peaks
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : timeSingle ()
+    // Desc : Time evaluateForX() for every sample, one call per sample.
+    //-------------------------------------------------------------------------
+    cgDouble timeSingle( cgBezierSpline2 & spline, const cgFloatArray & xs, cgFloatArray & ys, bool approximate )
+    {
+        const cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 r = 0; r < Repetitions; ++r )
+        {
+            for ( cgUInt32 i = 0; i < SampleCount; ++i )
+                ys[i] = spline.evaluateForX( xs[i], approximate );
+
+        } // Next repetition
+        return getBenchmarkTime() - start;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : timeBatch ()
+    // Desc : Time the batch evaluate() entry point over all samples.
+    //-------------------------------------------------------------------------
+    cgDouble timeBatch( cgBezierSpline2 & spline, const cgFloatArray & xs, cgFloatArray & ys, bool approximate )
+    {
+        const cgDouble start = getBenchmarkTime();
+        for ( cgUInt32 r = 0; r < Repetitions; ++r )
+            spline.evaluate( &xs[0], &ys[0], SampleCount, approximate );
+        return getBenchmarkTime() - start;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : maximumError ()
+    // Desc : Largest absolute difference between two sets of samples.
+    //-------------------------------------------------------------------------
+    cgFloat maximumError( const cgFloatArray & ys, const cgFloatArray & reference )
+    {
+        cgFloat error = 0;
+        for ( cgUInt32 i = 0; i < SampleCount; ++i )
+        {
+            const cgFloat difference = fabsf( ys[i] - reference[i] );
+            if ( difference > error )
+                error = difference;
+
+        } // Next sample
+        return error;
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : executeParallel ()
+    // Desc : Job system callback; evaluates a range of samples.
+    //-------------------------------------------------------------------------
+    void executeParallel( cgUInt32 first, cgUInt32 last, void * context )
+    {
+        ParallelData * data = (ParallelData*)context;
+        for ( cgUInt32 i = first; i < last; ++i )
+            data->ys[i] = data->spline->evaluateForX( data->xs[i] );
+    }
+
+    //-------------------------------------------------------------------------
+    // Name : checkParallel ()
+    // Desc : Sample a prepared spline from all worker threads at once, in a
+    //        scrambled order, and return the number of samples that differ
+    //        from serial evaluation of the same spline.
+    //-------------------------------------------------------------------------
+    cgUInt32 checkParallel( cgBezierSpline2 & spline, const cgFloatArray & xs )
+    {
+        cgFloatArray scrambled( SampleCount ), serial( SampleCount ), parallel( SampleCount );
+        for ( cgUInt32 i = 0; i < SampleCount; ++i )
+            scrambled[i] = xs[ (i * 7919) % SampleCount ];
+        spline.prepare();
+        for ( cgUInt32 i = 0; i < SampleCount; ++i )
+            serial[i] = spline.evaluateForX( scrambled[i] );
+
+        ParallelData data;
+        data.spline = &spline;
+        data.xs     = &scrambled[0];
+        data.ys     = &parallel[0];
+        cgUInt32 mismatches = 0;
+        for ( cgUInt32 r = 0; r < Repetitions; ++r )
+        {
+            cgJobSystem::parallelFor( SampleCount, 256, executeParallel, &data );
+            for ( cgUInt32 i = 0; i < SampleCount; ++i )
+            {
+                if ( parallel[i] != serial[i] )
+                    ++mismatches;
+
+            } // Next sample
+
+        } // Next repetition
+        return mismatches;
+    }
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkSpline ()
+// Desc : Spline evaluation benchmark entry point.
+//-----------------------------------------------------------------------------
+bool benchmarkSpline( )
+{
+    static const cgTChar * curveNames[2] = { _T("ease in / out"), _T("peak and trough") };
+
+    // Ascending samples across the full curve.
+    cgFloatArray xs( SampleCount ), ys( SampleCount ), reference( SampleCount );
+    for ( cgUInt32 i = 0; i < SampleCount; ++i )
+        xs[i] = (cgFloat)i / (cgFloat)(SampleCount - 1);
+
+    const cgDouble samples = (cgDouble)SampleCount * Repetitions;
+    cgUInt32 failures = 0;
+    for ( cgInt32 curve = 0; curve < 2; ++curve )
+    {
+        cgBezierSpline2 spline;
+        buildCurve( spline, curve );
+        _tprintf( _T("   Curve: %s, %d points\n"), curveNames[curve], spline.getPointCount() );
+
+        // Exact and approximate evaluation (no table).
+        const cgDouble exactTime = timeSingle( spline, xs, reference, false );
+        reportBenchmark( _T("evaluateForX(), exact (original)"), exactTime, samples, _T("sample") );
+        const cgDouble approximateTime = timeSingle( spline, xs, ys, true );
+        reportBenchmark( _T("evaluateForX(), approximate"), approximateTime, samples, _T("sample") );
+        _tprintf( _T("   %-40s %10.5f\n"), _T("Approximate max error"), maximumError( ys, reference ) );
+
+        // Lookup tables.
+        for ( cgInt32 type = cgBezierSpline2::UniformLookupTable; type <= cgBezierSpline2::AdaptiveLookupTable; ++type )
+        {
+            const bool uniform = (type == cgBezierSpline2::UniformLookupTable);
+            spline.setLookupTable( (cgBezierSpline2::LookupTableType)type, TableError, TableEntries );
+            spline.prepare();
+
+            const cgDouble singleTime = timeSingle( spline, xs, ys, false );
+            const cgFloat singleError = maximumError( ys, reference );
+            const cgDouble batchTime = timeBatch( spline, xs, ys, false );
+            const cgFloat batchError = maximumError( ys, reference );
+            reportBenchmark( uniform ? _T("evaluateForX(), uniform table") : _T("evaluateForX(), adaptive table"), singleTime, samples, _T("sample") );
+            reportBenchmark( uniform ? _T("evaluate() batch, uniform table") : _T("evaluate() batch, adaptive table"), batchTime, samples, _T("sample") );
+            _tprintf( _T("   %-40s %10u entries, error %.5f (reported %.5f)\n"), uniform ? _T("Uniform table") : _T("Adaptive table"),
+                      spline.getLookupTableSize(), (singleError > batchError) ? singleError : batchError, spline.getLookupTableError() );
+            reportSpeedup( _T("Speedup vs. exact (batch)"), exactTime, batchTime );
+
+            // The measured error must not exceed the error the table reports.
+            if ( singleError > spline.getLookupTableError() + ErrorSlack || batchError > spline.getLookupTableError() + ErrorSlack )
+                ++failures;
+
+        } // Next table type
+
+        // Concurrent evaluation of one shared spline, with and without a table.
+        cgUInt32 mismatches = checkParallel( spline, xs );
+        spline.setLookupTable( cgBezierSpline2::NoLookupTable );
+        mismatches += checkParallel( spline, xs );
+        _tprintf( _T("   Concurrent samples differing from serial: %u\n"), mismatches );
+        if ( mismatches )
+            ++failures;
+
+    } // Next curve
+    return ( failures == 0 );
+}
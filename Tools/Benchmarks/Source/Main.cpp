@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------------//
+//              ____           _                         _                   //
+//             / ___|__ _ _ __| |__   ___  _ __   __   _/ | __  __           //
+//            | |   / _` | '__| '_ \ / _ \| '_ \  \ \ / / | \ \/ /           //
+//            | |__| (_| | |  | |_) | (_) | | | |  \ V /| |_ >  <            //
+//             \____\__,_|_|  |_.__/ \___/|_| |_|   \_/ |_(_)_/\_\           //
+//                    Game Institute - Carbon Game Development Toolkit       //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//                                                                           //
+// Name : Main.cpp                                                           //
+//                                                                           //
+// Desc : Benchmark application entry point. Runs either every registered    //
+//        benchmark, or only those named on the command line, e.g.           //
+//        "Benchmarks.exe math billboards".                                  //
+//                                                                           //
+//---------------------------------------------------------------------------//
+//      Copyright (c) 1997 - 2013 Game Institute. All Rights Reserved.       //
+//---------------------------------------------------------------------------//
+
+//-----------------------------------------------------------------------------
+// Main Module Includes
+//-----------------------------------------------------------------------------
+#include <Carbon.h>
+#include <windows.h>
+#include <tchar.h>
+#include <stdio.h>
+#include "Benchmarks.h"
+
+//-----------------------------------------------------------------------------
+// Local Module Level Namespaces.
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Registered benchmarks, in the order they run by default.
+    const BenchmarkDesc Benchmarks[] =
+    {
+        { _T("math"), benchmarkMath, _T("Batched 1M vector transforms, native math backend vs. scalar reference.") },
+        { _T("picking"), benchmarkPicking, _T("Mesh picking rays/sec, per-triangle loop vs. cgTriangleBVH.") },
+        { _T("spheretree"), benchmarkSphereTree, _T("Sphere tree process() under object churn, full vs. incremental layout.") },
+        { _T("landscaperay"), benchmarkLandscapeRay, _T("Landscape ray casts, block ray marcher vs. min/max height pyramid.") },
+        { _T("particles"), benchmarkParticles, _T("1M particle simulation frame, per-particle loop vs. SoA cgParticleStore.") },
+        { _T("spline"), benchmarkSpline, _T("Bezier spline sampling, exact evaluation vs. uniform and adaptive lookup tables.") },
+        { _T("billboardsort"), benchmarkBillboardSort, _T("10k/100k/1M billboard depth sorts, qsort vs. radix sort with order reuse.") },
+        { _T("animbinding"), benchmarkAnimationBinding, _T("Animation controller update for 256 actors, target lookup by name vs. bound slots.") },
+        { _T("animsampling"), benchmarkAnimationSampling, _T("Animation set sampling for 2048 instances of 16 shared sets, key search vs. key cursors, serial and concurrent.") },
+    };
+    const cgUInt32 BenchmarkCount = sizeof(Benchmarks) / sizeof(Benchmarks[0]);
+
+    // Deterministic generator state so that every run (and every backend)
+    // is measured against identical input data.
+    cgUInt32 RandomState = 1;
+
+} // End Unnamed Namespace
+
+//-----------------------------------------------------------------------------
+// Name : _tmain() (Application Entry Point)
+// Desc : Entry point for program, application flow starts here.
+//-----------------------------------------------------------------------------
+int _tmain( int argc, _TCHAR * argv[] )
+{
+    // Share the common system directory with the samples.
+    cgFileSystem::addPathProtocol( _T("sys"), cgFileSystem::getAppDirectory() + _T("../../System/") );
+
+    // Debug information goes to the log file so it does not interleave
+    // with the benchmark results written to the console.
+    cgAppLog::registerOutput( new cgLogOutputFile( _T("./BenchmarkLog.html") ) );
+
+    // Configure the framework. Nothing is rendered, but the job system
+    // and timer are required by several of the benchmarks.
+    CGEConfig config;
+    config.highPriority  = true;
+    config.multiThreaded = true;
+    config.platform      = cgPlatform::Windows;
+    config.audioAPI      = cgAudioAPI::DirectX;
+    config.inputAPI      = cgInputAPI::DirectX;
+    config.networkAPI    = cgNetworkAPI::Winsock;
+    config.renderAPI     = cgRenderAPI::Null;
+    if ( cgEngineInit( config ) == false )
+    {
+        _tprintf( _T("Unable to initialize the engine. See 'BenchmarkLog.html' for more information.\n") );
+        cgEngineCleanup();
+        return -1;
+
+    } // End if failed
+
+    // Run the requested benchmarks.
+    cgUInt32 run = 0, failed = 0;
+    for ( cgUInt32 i = 0; i < BenchmarkCount; ++i )
+    {
+        // Was this benchmark requested?
+        bool selected = (argc <= 1);
+        for ( int j = 1; j < argc && !selected; ++j )
+            selected = (_tcsicmp( argv[j], Benchmarks[i].name ) == 0);
+        if ( !selected )
+            continue;
+
+        _tprintf( _T("== %s : %s\n"), Benchmarks[i].name, Benchmarks[i].description );
+        seedBenchmarkRandom( 1 );
+        if ( !Benchmarks[i].function() )
+        {
+            _tprintf( _T("   FAILED: optimized results differ from the reference.\n") );
+            failed++;
+        
+        } // End if failed
+        _tprintf( _T("\n") );
+        run++;
+
+    } // Next benchmark
+
+    // Unknown names?
+    if ( !run )
+    {
+        _tprintf( _T("No matching benchmark. Available benchmarks:\n") );
+        for ( cgUInt32 i = 0; i < BenchmarkCount; ++i )
+            _tprintf( _T("   %-12s %s\n"), Benchmarks[i].name, Benchmarks[i].description );
+    
+    } // End if none
+    else
+        _tprintf( _T("%u benchmark(s) run, %u failed.\n"), run, failed );
+
+    // Shut down the engine and exit
+    cgEngineCleanup();
+    return (failed || !run) ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : getBenchmarkTime ()
+// Desc : Retrieve the current high resolution time in seconds.
+//-----------------------------------------------------------------------------
+cgDouble getBenchmarkTime( )
+{
+    return cgTimer::getInstance()->getTime( true );
+}
+
+//-----------------------------------------------------------------------------
+// Name : seedBenchmarkRandom ()
+// Desc : Reset the deterministic random number generator.
+//-----------------------------------------------------------------------------
+void seedBenchmarkRandom( cgUInt32 seed )
+{
+    RandomState = (seed) ? seed : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : benchmarkRandom ()
+// Desc : Generate a repeatable pseudo random value in the specified range.
+//-----------------------------------------------------------------------------
+cgFloat benchmarkRandom( cgFloat minimum, cgFloat maximum )
+{
+    RandomState = RandomState * 1664525 + 1013904223;
+    return minimum + (maximum - minimum) * ((cgFloat)(RandomState >> 8) / (cgFloat)0x00FFFFFF);
+}
+
+//-----------------------------------------------------------------------------
+// Name : reportBenchmark ()
+// Desc : Print the timing and throughput for a single measured pass.
+//-----------------------------------------------------------------------------
+void reportBenchmark( const cgTChar * label, cgDouble seconds, cgDouble items, const cgTChar * unit )
+{
+    const cgDouble rate = (seconds > 0) ? items / seconds : 0;
+    _tprintf( _T("   %-40s %10.3f ms  %14.0f %s/sec\n"), label, seconds * 1000.0, rate, unit );
+}
+
+//-----------------------------------------------------------------------------
+// Name : reportSpeedup ()
+// Desc : Print the ratio between a reference and an optimized measurement.
+//-----------------------------------------------------------------------------
+void reportSpeedup( const cgTChar * label, cgDouble referenceSeconds, cgDouble optimizedSeconds )
+{
+    _tprintf( _T("   %-40s %10.2fx\n"), label, (optimizedSeconds > 0) ? referenceSeconds / optimizedSeconds : 0.0 );
+}